@@ -33,10 +33,36 @@ XdsKeyValueStoreStats KeyValueStoreXdsDelegate::generateStats(Stats::Scope& scop
   return {ALL_XDS_KV_STORE_STATS(POOL_COUNTER(scope))};
 }
 
-KeyValueStoreXdsDelegate::KeyValueStoreXdsDelegate(KeyValueStorePtr&& xds_config_store,
-                                                   Stats::Scope& root_scope)
+KeyValueStoreXdsDelegate::KeyValueStoreXdsDelegate(
+    KeyValueStorePtr&& xds_config_store, Stats::Scope& root_scope, Event::Dispatcher& dispatcher,
+    bool load_on_startup, absl::optional<std::chrono::seconds> max_resource_age)
     : xds_config_store_(std::move(xds_config_store)),
-      scope_(root_scope.createScope("xds.kv_store.")), stats_(generateStats(*scope_)) {}
+      scope_(root_scope.createScope("xds.kv_store.")), stats_(generateStats(*scope_)),
+      load_on_startup_(load_on_startup), max_resource_age_(max_resource_age) {
+  if (max_resource_age_.has_value()) {
+    refresh_timer_ = dispatcher.createTimer([this]() { refreshCurrentResources(); });
+    refresh_timer_->enableTimer(refreshInterval());
+  }
+}
+
+void KeyValueStoreXdsDelegate::refreshCurrentResources() {
+  // xDS management servers don't send resources again as long as they don't change, so the
+  // resources in use are refreshed here rather than only when they are updated.
+  for (const auto& [source_key, resource_keys] : current_resource_keys_) {
+    for (const std::string& resource_key : resource_keys) {
+      if (const auto existing_resource = xds_config_store_->get(resource_key)) {
+        xds_config_store_->addOrUpdate(resource_key, std::string(*existing_resource),
+                                       max_resource_age_);
+      }
+    }
+  }
+  refresh_timer_->enableTimer(refreshInterval());
+}
+
+std::chrono::milliseconds KeyValueStoreXdsDelegate::refreshInterval() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(*max_resource_age_) /
+         RefreshIntervalDivisor;
+}
 
 std::vector<envoy::service::discovery::v3::Resource> KeyValueStoreXdsDelegate::getResources(
     const XdsSourceId& source_id, const absl::flat_hash_set<std::string>& resource_names) const {
@@ -69,6 +95,7 @@ std::vector<envoy::service::discovery::v3::Resource> KeyValueStoreXdsDelegate::g
     stats_.resources_not_found_.inc();
   } else {
     stats_.load_success_.inc();
+    stats_.resources_loaded_.add(resources.size());
   }
 
   return resources;
@@ -95,6 +122,7 @@ KeyValueStoreXdsDelegate::getAllResources(const XdsSourceId& source_id) const {
 
 void KeyValueStoreXdsDelegate::onConfigUpdated(
     const XdsSourceId& source_id, const std::vector<Envoy::Config::DecodedResourceRef>& resources) {
+  std::vector<std::string> current_resource_keys;
   for (const auto& resource_ref : resources) {
     const auto& decoded_resource = resource_ref.get();
     if (decoded_resource.hasResource()) {
@@ -109,10 +137,21 @@ void KeyValueStoreXdsDelegate::onConfigUpdated(
             Protobuf::util::TimeUtil::MillisecondsToDuration(decoded_resource.ttl()->count()));
         ttl = std::chrono::duration_cast<std::chrono::seconds>(decoded_resource.ttl().value());
       }
+      const bool expires_with_max_age =
+          max_resource_age_.has_value() && (!ttl.has_value() || *ttl > *max_resource_age_);
+      if (expires_with_max_age) {
+        // The KV store expires the resource, also across restarts, unless it is refreshed or
+        // updated again.
+        ttl = max_resource_age_;
+      }
       std::string serialized_resource;
       if (r.SerializeToString(&serialized_resource)) {
-        xds_config_store_->addOrUpdate(constructKey(source_id, r.name()),
-                                       std::move(serialized_resource), ttl);
+        const std::string resource_key = constructKey(source_id, r.name());
+        xds_config_store_->addOrUpdate(resource_key, std::move(serialized_resource), ttl);
+        stats_.resources_persisted_.inc();
+        if (expires_with_max_age) {
+          current_resource_keys.push_back(resource_key);
+        }
       } else {
         stats_.serialization_failed_.inc();
         ENVOY_LOG_MISC(
@@ -126,6 +165,10 @@ void KeyValueStoreXdsDelegate::onConfigUpdated(
                      decoded_resource.name());
     }
   }
+  if (max_resource_age_.has_value()) {
+    // The resources missing from the update are no longer current, and expire.
+    current_resource_keys_[source_id.toKey()] = std::move(current_resource_keys);
+  }
 }
 
 void KeyValueStoreXdsDelegate::onResourceLoadFailed(
@@ -157,7 +200,14 @@ Envoy::Config::XdsResourcesDelegatePtr KeyValueStoreXdsDelegateFactory::createXd
       validator_config.key_value_store_config().config());
   KeyValueStorePtr xds_config_store = kv_store_factory.createStore(
       validator_config.key_value_store_config(), validation_visitor, dispatcher, api.fileSystem());
-  return std::make_unique<KeyValueStoreXdsDelegate>(std::move(xds_config_store), api.rootScope());
+  absl::optional<std::chrono::seconds> max_resource_age;
+  if (validator_config.has_max_resource_age()) {
+    max_resource_age =
+        std::chrono::seconds(DurationUtil::durationToSeconds(validator_config.max_resource_age()));
+  }
+  return std::make_unique<KeyValueStoreXdsDelegate>(std::move(xds_config_store), api.rootScope(),
+                                                    dispatcher, validator_config.load_on_startup(),
+                                                    max_resource_age);
 }
 
 REGISTER_FACTORY(KeyValueStoreXdsDelegateFactory, Envoy::Config::XdsResourcesDelegateFactory);
@@ -1,11 +1,17 @@
 #pragma once
 
+#include <chrono>
+
 #include "envoy/common/key_value_store.h"
 #include "envoy/config/xds_resources_delegate.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/types/optional.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -24,7 +30,11 @@ namespace Config {
   /* Number of times a persisted resource failed to parse into a xDS proto. */                     \
   COUNTER(parse_failed)                                                                            \
   /* Number of times a resource was requested but not found from the KV store. */                  \
-  COUNTER(resource_missing)
+  COUNTER(resource_missing)                                                                        \
+  /* Number of resources persisted in the KV store. */                                             \
+  COUNTER(resources_persisted)                                                                     \
+  /* Number of persisted resources returned to be loaded from the KV store. */                     \
+  COUNTER(resources_loaded)
 
 // Struct definition for all KV store xDS delegate stats. @see stats_macros.h
 struct XdsKeyValueStoreStats {
@@ -42,7 +52,12 @@ struct XdsKeyValueStoreStats {
 // not currently advised to use this feature for large and complicated configurations.
 class KeyValueStoreXdsDelegate : public Envoy::Config::XdsResourcesDelegate {
 public:
-  KeyValueStoreXdsDelegate(KeyValueStorePtr&& xds_config_store, Stats::Scope& root_scope);
+  // Resources are persisted for at most max_resource_age since they were last known to be current,
+  // if set. The resources of the last update of each source are current for as long as this
+  // delegate lives, so their age is refreshed every RefreshIntervalDivisor-th of max_resource_age.
+  KeyValueStoreXdsDelegate(KeyValueStorePtr&& xds_config_store, Stats::Scope& root_scope,
+                           Event::Dispatcher& dispatcher, bool load_on_startup = false,
+                           absl::optional<std::chrono::seconds> max_resource_age = absl::nullopt);
 
   std::vector<envoy::service::discovery::v3::Resource>
   getResources(const Envoy::Config::XdsSourceId& source_id,
@@ -55,6 +70,10 @@ public:
                             const std::string& resource_name,
                             const absl::optional<EnvoyException>& exception) override;
 
+  bool loadOnStartup() const override { return load_on_startup_; }
+
+  static constexpr int RefreshIntervalDivisor = 10;
+
 private:
   // Gets all the resources present in the KeyValueStore for the given source_id. This is the
   // equivalent of wildcard xDS requests.
@@ -63,9 +82,19 @@ private:
 
   static XdsKeyValueStoreStats generateStats(Stats::Scope& scope);
 
+  // Persists the current resources for another max_resource_age.
+  void refreshCurrentResources();
+  std::chrono::milliseconds refreshInterval() const;
+
   KeyValueStorePtr xds_config_store_;
   Stats::ScopeSharedPtr scope_;
   XdsKeyValueStoreStats stats_;
+  const bool load_on_startup_;
+  const absl::optional<std::chrono::seconds> max_resource_age_;
+  // The keys of the resources of the last update of each source, by source key, that expire after
+  // max_resource_age rather than after their own TTL.
+  absl::flat_hash_map<std::string, std::vector<std::string>> current_resource_keys_;
+  Event::TimerPtr refresh_timer_;
 };
 
 // A factory for creating instances of KeyValueStoreXdsDelegate from the typed_config field of a
@@ -10,6 +10,7 @@
 
 #include "test/common/stats/stat_test_utility.h"
 #include "test/mocks/api/mocks.h"
+#include "test/mocks/common.h"
 #include "test/mocks/event/mocks.h"
 #include "test/mocks/protobuf/mocks.h"
 #include "test/test_common/environment.h"
@@ -26,8 +27,12 @@ namespace {
 using ::Envoy::Config::DecodedResourceRef;
 using ::Envoy::Config::XdsConfigSourceId;
 using ::Envoy::Config::XdsSourceId;
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Return;
 
-envoy::config::core::v3::TypedExtensionConfig kvStoreDelegateConfig() {
+envoy::config::core::v3::TypedExtensionConfig
+kvStoreDelegateConfig(const std::string& delegate_options = "") {
   const std::string filename = TestEnvironment::temporaryPath("xds_kv_store.txt");
   Api::OsSysCallsSingleton().get().unlink(filename.c_str());
 
@@ -41,8 +46,9 @@ envoy::config::core::v3::TypedExtensionConfig kvStoreDelegateConfig() {
           typed_config:
             "@type": type.googleapis.com/envoy.extensions.key_value.file_based.v3.FileBasedKeyValueStoreConfig
             filename: {}
+      {}
     )EOF",
-                                             filename);
+                                             filename, delegate_options);
 
   envoy::config::core::v3::TypedExtensionConfig config;
   TestUtility::loadFromYaml(config_str, config);
@@ -51,14 +57,16 @@ envoy::config::core::v3::TypedExtensionConfig kvStoreDelegateConfig() {
 
 class KeyValueStoreXdsDelegateTest : public testing::Test {
 public:
-  KeyValueStoreXdsDelegateTest() : api_(Api::createApiForTest(store_)) {
-    auto config = kvStoreDelegateConfig();
+  KeyValueStoreXdsDelegateTest() : api_(Api::createApiForTest(store_)) { createDelegate(); }
+
+protected:
+  void createDelegate(const std::string& delegate_options = "") {
+    auto config = kvStoreDelegateConfig(delegate_options);
     Extensions::Config::KeyValueStoreXdsDelegateFactory delegate_factory;
     xds_delegate_ = delegate_factory.createXdsResourcesDelegate(
         config.typed_config(), ProtobufMessage::getStrictValidationVisitor(), *api_, dispatcher_);
   }
 
-protected:
   envoy::service::runtime::v3::Runtime parseYamlIntoRuntimeResource(const std::string& yaml) {
     envoy::service::runtime::v3::Runtime runtime;
     TestUtility::loadFromYaml(yaml, runtime);
@@ -119,6 +127,14 @@ TEST_F(KeyValueStoreXdsDelegateTest, SaveAndRetrieve) {
   EXPECT_EQ(0, store_.counter("xds.kv_store.resources_not_found").value());
   EXPECT_EQ(0, store_.counter("xds.kv_store.resource_missing").value());
   EXPECT_EQ(0, store_.counter("xds.kv_store.parse_failed").value());
+  EXPECT_EQ(2, store_.counter("xds.kv_store.resources_persisted").value());
+  EXPECT_EQ(2, store_.counter("xds.kv_store.resources_loaded").value());
+  EXPECT_FALSE(xds_delegate_->loadOnStartup());
+}
+
+TEST_F(KeyValueStoreXdsDelegateTest, LoadOnStartup) {
+  createDelegate("load_on_startup: true");
+  EXPECT_TRUE(xds_delegate_->loadOnStartup());
 }
 
 TEST_F(KeyValueStoreXdsDelegateTest, MultipleAuthoritiesAndTypes) {
@@ -335,5 +351,116 @@ TEST_F(KeyValueStoreXdsDelegateTest, ResourcesWithTTL) {
       source_id, /*resource_names=*/{"some_resource_1"}, decoded_resources.refvec_);
 }
 
+// Resources are persisted for at most the max resource age since they were last updated, unless
+// their TTL is shorter.
+TEST_F(KeyValueStoreXdsDelegateTest, MaxResourceAge) {
+  createDelegate("max_resource_age: 60s");
+  const std::string authority_1 = "rtds_cluster";
+  auto runtime_resource_1 = parseYamlIntoRuntimeResource(R"EOF(
+    name: some_resource_1
+    layer:
+      foo: bar
+  )EOF");
+  auto runtime_resource_2 = parseYamlIntoRuntimeResource(R"EOF(
+    name: some_resource_2
+    layer:
+      abc: xyz
+  )EOF");
+  auto runtime_resource_3 = parseYamlIntoRuntimeResource(R"EOF(
+    name: some_resource_3
+    layer:
+      boo: yikes
+  )EOF");
+
+  // some_resource_2 has a TTL of 30 seconds, and some_resource_3 has a TTL of 120 seconds.
+  Protobuf::RepeatedPtrField<envoy::service::discovery::v3::Resource> resources;
+  auto* resource = resources.Add();
+  resource->set_name("some_resource_1");
+  resource->mutable_resource()->PackFrom(runtime_resource_1);
+  resource = resources.Add();
+  resource->set_name("some_resource_2");
+  resource->mutable_resource()->PackFrom(runtime_resource_2);
+  resource->mutable_ttl()->set_seconds(30);
+  resource = resources.Add();
+  resource->set_name("some_resource_3");
+  resource->mutable_resource()->PackFrom(runtime_resource_3);
+  resource->mutable_ttl()->set_seconds(120);
+  auto decoded_resources = TestUtility::decodeResources<envoy::service::runtime::v3::Runtime>(
+      resources, /*version=*/"1");
+
+  const XdsConfigSourceId source_id{authority_1, Config::TypeUrl::get().Runtime};
+  xds_delegate_->onConfigUpdated(source_id, decoded_resources.refvec_);
+  EXPECT_EQ(3, store_.counter("xds.kv_store.resources_persisted").value());
+
+  // The TTL of some_resource_2 expired.
+  time_source_.advanceTimeWait(std::chrono::seconds(45));
+  decoded_resources.refvec_.erase(std::next(decoded_resources.refvec_.begin()));
+  checkSavedResources<envoy::service::runtime::v3::Runtime>(
+      source_id, /*resource_names=*/{"some_resource_1", "some_resource_3"},
+      decoded_resources.refvec_);
+
+  // some_resource_1 is updated, which makes it persist for another 60 seconds.
+  const auto updated_resources = TestUtility::decodeResources({runtime_resource_1});
+  xds_delegate_->onConfigUpdated(source_id, updated_resources.refvec_);
+
+  // some_resource_3 reached the max resource age, before its TTL expired.
+  time_source_.advanceTimeWait(std::chrono::seconds(45));
+  checkSavedResources<envoy::service::runtime::v3::Runtime>(
+      source_id, /*resource_names=*/{"some_resource_1", "some_resource_3"},
+      updated_resources.refvec_);
+  EXPECT_EQ(1, store_.counter("xds.kv_store.resource_missing").value());
+}
+
+// Resources that the xDS management server doesn't send again are refreshed as long as they are the
+// last update of their source.
+TEST(KeyValueStoreXdsDelegateRefreshTest, RefreshesCurrentResources) {
+  Stats::TestUtil::TestStore store;
+  NiceMock<Event::MockDispatcher> dispatcher;
+  auto* refresh_timer = new NiceMock<Event::MockTimer>(&dispatcher);
+  EXPECT_CALL(*refresh_timer, enableTimer(std::chrono::milliseconds(6000), _));
+  auto kv_store = std::make_unique<NiceMock<MockKeyValueStore>>();
+  MockKeyValueStore& kv_store_ref = *kv_store;
+  Extensions::Config::KeyValueStoreXdsDelegate xds_delegate(
+      std::move(kv_store), *store.rootScope(), dispatcher, false, std::chrono::seconds(60));
+
+  envoy::service::runtime::v3::Runtime runtime_resource_1;
+  runtime_resource_1.set_name("some_resource_1");
+  envoy::service::runtime::v3::Runtime runtime_resource_2;
+  runtime_resource_2.set_name("some_resource_2");
+  Protobuf::RepeatedPtrField<envoy::service::discovery::v3::Resource> resources;
+  auto* resource = resources.Add();
+  resource->set_name("some_resource_1");
+  resource->mutable_resource()->PackFrom(runtime_resource_1);
+  resource = resources.Add();
+  resource->set_name("some_resource_2");
+  resource->mutable_resource()->PackFrom(runtime_resource_2);
+  resource->mutable_ttl()->set_seconds(30);
+  auto decoded_resources = TestUtility::decodeResources<envoy::service::runtime::v3::Runtime>(
+      resources, /*version=*/"1");
+
+  const XdsConfigSourceId source_id{"rtds_cluster", Config::TypeUrl::get().Runtime};
+  const std::string key_1 = absl::StrCat(source_id.toKey(), "+some_resource_1");
+  const std::string key_2 = absl::StrCat(source_id.toKey(), "+some_resource_2");
+  EXPECT_CALL(kv_store_ref, addOrUpdate(key_1, _, absl::make_optional(std::chrono::seconds(60))));
+  EXPECT_CALL(kv_store_ref, addOrUpdate(key_2, _, absl::make_optional(std::chrono::seconds(30))));
+  xds_delegate.onConfigUpdated(source_id, decoded_resources.refvec_);
+
+  // Only some_resource_1 expires with the max resource age, so only it is refreshed.
+  EXPECT_CALL(kv_store_ref, get(absl::string_view(key_1))).WillOnce(Return("serialized"));
+  EXPECT_CALL(kv_store_ref,
+              addOrUpdate(absl::string_view(key_1), absl::string_view("serialized"),
+                          absl::make_optional(std::chrono::seconds(60))));
+  EXPECT_CALL(*refresh_timer, enableTimer(std::chrono::milliseconds(6000), _));
+  refresh_timer->invokeCallback();
+
+  // some_resource_1 is no longer current once an update doesn't have it.
+  decoded_resources.refvec_.erase(decoded_resources.refvec_.begin());
+  EXPECT_CALL(kv_store_ref, addOrUpdate(key_2, _, absl::make_optional(std::chrono::seconds(30))));
+  xds_delegate.onConfigUpdated(source_id, decoded_resources.refvec_);
+  EXPECT_CALL(kv_store_ref, get(_)).Times(0);
+  EXPECT_CALL(*refresh_timer, enableTimer(std::chrono::milliseconds(6000), _));
+  refresh_timer->invokeCallback();
+}
+
 } // namespace
 } // namespace Envoy
@@ -74,12 +74,28 @@ KafkaBrokerFilter::KafkaBrokerFilter(Stats::Scope& scope, TimeSource& time_sourc
     : KafkaBrokerFilter{filter_config, std::make_shared<KafkaMetricsFacadeImpl>(
                                            scope, time_source, filter_config.stat_prefix())} {};
 
+// Only the responses that carry broker addresses need to be deserialized, and only if they are
+// going to be rewritten. Other responses are kept as raw data when rewriting (as they need to be
+// encoded again), and are skipped entirely otherwise, as metrics only need response metadata.
+static const ResponseParserResolver& responseParserResolver(const BrokerFilterConfig& config) {
+  if (config.needsResponseRewrite()) {
+    return ResponseRewriterImpl::parserResolver();
+  } else {
+    return HeaderOnlyResponseParserResolver::getInstance();
+  }
+}
+
+// Request data is never needed, as both the forwarder and metrics only use request headers.
 KafkaBrokerFilter::KafkaBrokerFilter(const BrokerFilterConfig& filter_config,
                                      const KafkaMetricsFacadeSharedPtr& metrics)
     : metrics_{metrics}, response_rewriter_{createRewriter(filter_config)},
-      response_decoder_{new ResponseDecoder({metrics, response_rewriter_})},
-      request_decoder_{
-          new RequestDecoder({std::make_shared<Forwarder>(*response_decoder_), metrics})} {};
+      response_decoder_{new ResponseDecoder(ResponseInitialParserFactory::getDefaultInstance(),
+                                            responseParserResolver(filter_config),
+                                            {metrics, response_rewriter_})},
+      request_decoder_{new RequestDecoder(InitialParserFactory::getDefaultInstance(),
+                                          HeaderOnlyRequestParserResolver::getInstance(),
+                                          {std::make_shared<Forwarder>(*response_decoder_),
+                                           metrics})} {};
 
 KafkaBrokerFilter::KafkaBrokerFilter(KafkaMetricsFacadeSharedPtr metrics,
                                      ResponseRewriterSharedPtr response_rewriter,
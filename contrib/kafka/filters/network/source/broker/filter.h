@@ -113,6 +113,9 @@ private:
 /**
  * Implementation of Kafka broker-level filter.
  * Uses two decoders - request and response ones, that are connected using Forwarder instance.
+ * Request data is skipped rather than deserialized, as only request headers are needed. Response
+ * data is deserialized only for the responses that are rewritten (Metadata, FindCoordinator and
+ * DescribeCluster), other responses are re-encoded from their raw data.
  * KafkaMetricsFacade is listening for both request/response events to keep metrics.
  * ResponseRewriter is listening for response events to capture and rewrite them if needed.
  *
@@ -20,6 +20,12 @@ constexpr int16_t METADATA_API_KEY = 3;
 constexpr int16_t FIND_COORDINATOR_API_KEY = 10;
 constexpr int16_t DESCRIBE_CLUSTER_API_KEY = 60;
 
+const ResponseParserResolver& ResponseRewriterImpl::parserResolver() {
+  CONSTRUCT_ON_FIRST_USE(SelectiveResponseParserResolver,
+                         std::vector<int16_t>{METADATA_API_KEY, FIND_COORDINATOR_API_KEY,
+                                              DESCRIBE_CLUSTER_API_KEY});
+}
+
 template <typename T> static T& extractResponseData(AbstractResponseSharedPtr& arg) {
   using TSharedPtr = std::shared_ptr<Response<T>>;
   TSharedPtr cast = std::dynamic_pointer_cast<typename TSharedPtr::element_type>(arg);
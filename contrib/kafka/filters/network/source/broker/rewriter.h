@@ -64,6 +64,12 @@ public:
 
   size_t getStoredResponseCountForTest() const;
 
+  /**
+   * Return resolver that deserializes only the responses this rewriter changes, and keeps the
+   * others as raw data.
+   */
+  static const ResponseParserResolver& parserResolver();
+
 private:
   // Helper function to update various response structures.
   // Pointer-to-member used to handle varying field names across the structs.
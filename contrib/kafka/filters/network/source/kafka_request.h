@@ -2,6 +2,8 @@
 
 #include "envoy/common/exception.h"
 
+#include "source/common/common/assert.h"
+
 #include "contrib/kafka/filters/network/source/external/serialization_composite.h"
 #include "contrib/kafka/filters/network/source/serialization.h"
 #include "contrib/kafka/filters/network/source/tagged_fields.h"
@@ -20,6 +22,15 @@ namespace Kafka {
  */
 bool requestUsesTaggedFieldsInHeader(const uint16_t api_key, const uint16_t api_version);
 
+/**
+ * Decides if request with given api key & version can be deserialized (there is a generated parser
+ * for it). This method gets implemented in generated code through 'kafka_request_resolver_cc.j2'.
+ * @param api_key Kafka request key.
+ * @param api_version Kafka request's version.
+ * @return Whether the request is supported.
+ */
+bool requestHasParser(const uint16_t api_key, const uint16_t api_version);
+
 /**
  * Represents fields that are present in every Kafka request message.
  * @see http://kafka.apache.org/protocol.html#protocol_messages
@@ -166,6 +177,34 @@ public:
   const Data data_;
 };
 
+/**
+ * Request whose data has been skipped instead of being deserialized, because only its header was
+ * needed (e.g. to update metrics). Such a request cannot be encoded.
+ */
+class HeaderOnlyRequest : public AbstractRequest {
+public:
+  /**
+   * @param request_header request's header.
+   * @param data_size size of the skipped request-specific data.
+   */
+  HeaderOnlyRequest(const RequestHeader& request_header, const uint32_t data_size)
+      : AbstractRequest{request_header}, data_size_{data_size} {};
+
+  uint32_t computeSize() const override {
+    const EncodingContext context{request_header_.api_version_};
+    return context.computeSize(request_header_) + data_size_;
+  }
+
+  uint32_t encode(Buffer::Instance&) const override {
+    PANIC("request data has not been deserialized, the request cannot be encoded");
+  }
+
+  /**
+   * Size of the skipped request-specific data.
+   */
+  const uint32_t data_size_;
+};
+
 } // namespace Kafka
 } // namespace NetworkFilters
 } // namespace Extensions
@@ -67,6 +67,34 @@ RequestParseResponse RequestHeaderParser::parse(absl::string_view& data) {
   }
 }
 
+RequestParseResponse HeaderOnlyRequestParser::parse(absl::string_view& data) {
+  const uint32_t min = std::min<uint32_t>(context_->remaining_request_size_, data.size());
+  data = {data.data() + min, data.size() - min};
+  context_->remaining_request_size_ -= min;
+  if (0 == context_->remaining_request_size_) {
+    AbstractRequestSharedPtr msg =
+        std::make_shared<HeaderOnlyRequest>(context_->request_header_, data_size_);
+    return RequestParseResponse::parsedMessage(msg);
+  } else {
+    return RequestParseResponse::stillWaiting();
+  }
+}
+
+RequestParserSharedPtr
+HeaderOnlyRequestParserResolver::createParser(int16_t api_key, int16_t api_version,
+                                              RequestContextSharedPtr context) const {
+  // Requests without a parser are reported as parse failures, as with the default resolver.
+  if (requestHasParser(api_key, api_version)) {
+    return std::make_shared<HeaderOnlyRequestParser>(context);
+  } else {
+    return std::make_shared<SentinelParser>(context);
+  }
+}
+
+const RequestParserResolver& HeaderOnlyRequestParserResolver::getInstance() {
+  CONSTRUCT_ON_FIRST_USE(HeaderOnlyRequestParserResolver);
+}
+
 } // namespace Kafka
 } // namespace NetworkFilters
 } // namespace Extensions
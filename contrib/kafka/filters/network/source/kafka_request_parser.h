@@ -176,6 +176,41 @@ public:
   }
 };
 
+/**
+ * Parser that consumes the request-specific data without deserializing it, and returns a request
+ * that carries only the header.
+ */
+class HeaderOnlyRequestParser : public RequestParser {
+public:
+  HeaderOnlyRequestParser(RequestContextSharedPtr context)
+      : context_{context}, data_size_{context->remaining_request_size_} {};
+
+  RequestParseResponse parse(absl::string_view& data) override;
+
+  const RequestContextSharedPtr contextForTest() const { return context_; }
+
+private:
+  const RequestContextSharedPtr context_;
+  const uint32_t data_size_;
+};
+
+/**
+ * Resolver that skips the data of supported requests instead of deserializing it, for users that
+ * only need request headers. This avoids materializing large requests like Produce requests with
+ * their record batches. Unsupported requests are still consumed by a sentinel parser.
+ */
+class HeaderOnlyRequestParserResolver : public RequestParserResolver {
+public:
+  // RequestParserResolver
+  RequestParserSharedPtr createParser(int16_t api_key, int16_t api_version,
+                                      RequestContextSharedPtr context) const override;
+
+  /**
+   * Return shared resolver instance.
+   */
+  static const RequestParserResolver& getInstance();
+};
+
 /**
  * Request parser uses a single deserializer to construct a request object.
  * This parser is responsible for consuming request-specific data (e.g. topic names) and always
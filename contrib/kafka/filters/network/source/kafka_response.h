@@ -1,5 +1,7 @@
 #pragma once
 
+#include "source/common/common/assert.h"
+
 #include "contrib/kafka/filters/network/source/external/serialization_composite.h"
 #include "contrib/kafka/filters/network/source/serialization.h"
 #include "contrib/kafka/filters/network/source/tagged_fields.h"
@@ -22,6 +24,16 @@ namespace Kafka {
  */
 bool responseUsesTaggedFieldsInHeader(const uint16_t api_key, const uint16_t api_version);
 
+/**
+ * Decides if response with given api key & version can be deserialized (there is a generated
+ * parser for it). This method gets implemented in generated code through
+ * 'kafka_response_resolver_cc.j2'.
+ * @param api_key Kafka request key.
+ * @param api_version Kafka request's version.
+ * @return Whether the response is supported.
+ */
+bool responseHasParser(const uint16_t api_key, const uint16_t api_version);
+
 /**
  * Represents Kafka response metadata: expected api key, version and correlation id.
  * @see http://kafka.apache.org/protocol.html#protocol_messages
@@ -149,6 +161,69 @@ public:
   Data data_;
 };
 
+/**
+ * Response whose data has been skipped instead of being deserialized, because only its metadata
+ * was needed (e.g. to update metrics). Such a response cannot be encoded.
+ */
+class HeaderOnlyResponse : public AbstractResponse {
+public:
+  /**
+   * @param metadata response metadata.
+   * @param data_size size of the skipped response-specific data.
+   */
+  HeaderOnlyResponse(const ResponseMetadata& metadata, const uint32_t data_size)
+      : AbstractResponse{metadata}, data_size_{data_size} {};
+
+  uint32_t computeSize() const override {
+    const EncodingContext context{metadata_.api_version_};
+    return context.computeSize(metadata_) + data_size_;
+  }
+
+  uint32_t encode(Buffer::Instance&) const override {
+    PANIC("response data has not been deserialized, the response cannot be encoded");
+  }
+
+  /**
+   * Size of the skipped response-specific data.
+   */
+  const uint32_t data_size_;
+};
+
+/**
+ * Response whose data has not been deserialized, because it is passed on unchanged. The data is
+ * kept as raw bytes, and written back as they were when the response is encoded.
+ */
+class RawResponse : public AbstractResponse {
+public:
+  /**
+   * @param metadata response metadata.
+   * @param data raw response-specific data.
+   */
+  RawResponse(const ResponseMetadata& metadata, std::string data)
+      : AbstractResponse{metadata}, data_{std::move(data)} {};
+
+  uint32_t computeSize() const override {
+    const EncodingContext context{metadata_.api_version_};
+    return context.computeSize(metadata_) + data_.size();
+  }
+
+  uint32_t encode(Buffer::Instance& dst) const override {
+    EncodingContext context{metadata_.api_version_};
+    uint32_t written{0};
+    // Encode response header.
+    written += context.encode(metadata_, dst);
+    // Copy raw response-specific data.
+    dst.add(data_);
+    written += data_.size();
+    return written;
+  }
+
+  /**
+   * Raw response-specific data.
+   */
+  const std::string data_;
+};
+
 } // namespace Kafka
 } // namespace NetworkFilters
 } // namespace Extensions
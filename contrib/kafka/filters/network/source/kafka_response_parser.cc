@@ -1,5 +1,7 @@
 #include "contrib/kafka/filters/network/source/kafka_response_parser.h"
 
+#include <algorithm>
+
 #include "absl/strings/str_cat.h"
 
 namespace Envoy {
@@ -66,6 +68,64 @@ ExpectedResponseSpec ResponseHeaderParser::getResponseSpec(const int32_t correla
   }
 };
 
+ResponseParseResponse HeaderOnlyResponseParser::parse(absl::string_view& data) {
+  const uint32_t min = std::min<uint32_t>(context_->remaining_response_size_, data.size());
+  data = {data.data() + min, data.size() - min};
+  context_->remaining_response_size_ -= min;
+  if (0 == context_->remaining_response_size_) {
+    const ResponseMetadata metadata = {context_->api_key_, context_->api_version_,
+                                       context_->correlation_id_, context_->tagged_fields_};
+    const AbstractResponseSharedPtr response =
+        std::make_shared<HeaderOnlyResponse>(metadata, data_size_);
+    return ResponseParseResponse::parsedMessage(response);
+  } else {
+    return ResponseParseResponse::stillWaiting();
+  }
+}
+
+ResponseParseResponse RawResponseParser::parse(absl::string_view& data) {
+  const uint32_t min = std::min<uint32_t>(context_->remaining_response_size_, data.size());
+  data_.append(data.data(), min);
+  data = {data.data() + min, data.size() - min};
+  context_->remaining_response_size_ -= min;
+  if (0 == context_->remaining_response_size_) {
+    const ResponseMetadata metadata = {context_->api_key_, context_->api_version_,
+                                       context_->correlation_id_, context_->tagged_fields_};
+    const AbstractResponseSharedPtr response =
+        std::make_shared<RawResponse>(metadata, std::move(data_));
+    return ResponseParseResponse::parsedMessage(response);
+  } else {
+    return ResponseParseResponse::stillWaiting();
+  }
+}
+
+ResponseParserSharedPtr
+HeaderOnlyResponseParserResolver::createParser(ResponseContextSharedPtr context) const {
+  // Responses without a parser are reported as parse failures, as with the default resolver.
+  if (responseHasParser(context->api_key_, context->api_version_)) {
+    return std::make_shared<HeaderOnlyResponseParser>(context);
+  } else {
+    return std::make_shared<SentinelResponseParser>(context);
+  }
+}
+
+const ResponseParserResolver& HeaderOnlyResponseParserResolver::getInstance() {
+  CONSTRUCT_ON_FIRST_USE(HeaderOnlyResponseParserResolver);
+}
+
+ResponseParserSharedPtr
+SelectiveResponseParserResolver::createParser(ResponseContextSharedPtr context) const {
+  if (std::find(api_keys_.begin(), api_keys_.end(), context->api_key_) != api_keys_.end()) {
+    return ResponseParserResolver::getDefaultInstance().createParser(context);
+  }
+  // Responses without a parser are reported as parse failures, as with the default resolver.
+  if (responseHasParser(context->api_key_, context->api_version_)) {
+    return std::make_shared<RawResponseParser>(context);
+  } else {
+    return std::make_shared<SentinelResponseParser>(context);
+  }
+}
+
 } // namespace Kafka
 } // namespace NetworkFilters
 } // namespace Extensions
@@ -2,6 +2,7 @@
 
 #include <map>
 #include <memory>
+#include <vector>
 
 #include "contrib/kafka/filters/network/source/kafka_response.h"
 #include "contrib/kafka/filters/network/source/parser.h"
@@ -151,6 +152,75 @@ public:
   }
 };
 
+/**
+ * Parser that consumes the response-specific data without deserializing it, and returns a response
+ * that carries only the metadata.
+ */
+class HeaderOnlyResponseParser : public ResponseParser {
+public:
+  HeaderOnlyResponseParser(ResponseContextSharedPtr context)
+      : context_{context}, data_size_{context->remaining_response_size_} {};
+
+  ResponseParseResponse parse(absl::string_view& data) override;
+
+  const ResponseContextSharedPtr contextForTest() const { return context_; }
+
+private:
+  const ResponseContextSharedPtr context_;
+  const uint32_t data_size_;
+};
+
+/**
+ * Parser that consumes the response-specific data without deserializing it, and returns a response
+ * that carries the metadata and the raw data.
+ */
+class RawResponseParser : public ResponseParser {
+public:
+  RawResponseParser(ResponseContextSharedPtr context) : context_{context} {};
+
+  ResponseParseResponse parse(absl::string_view& data) override;
+
+  const ResponseContextSharedPtr contextForTest() const { return context_; }
+
+private:
+  const ResponseContextSharedPtr context_;
+  std::string data_;
+};
+
+/**
+ * Resolver that skips the data of supported responses instead of deserializing it, for users that
+ * only need response metadata. This avoids materializing large responses like Fetch responses with
+ * their record batches. Unsupported responses are still consumed by a sentinel parser.
+ */
+class HeaderOnlyResponseParserResolver : public ResponseParserResolver {
+public:
+  // ResponseParserResolver
+  ResponseParserSharedPtr createParser(ResponseContextSharedPtr context) const override;
+
+  /**
+   * Return shared resolver instance.
+   */
+  static const ResponseParserResolver& getInstance();
+};
+
+/**
+ * Resolver that deserializes only the responses with given api keys, and keeps the other supported
+ * responses as raw data, for users that modify only some kinds of responses.
+ */
+class SelectiveResponseParserResolver : public ResponseParserResolver {
+public:
+  /**
+   * @param api_keys keys of the responses that are deserialized.
+   */
+  SelectiveResponseParserResolver(const std::vector<int16_t>& api_keys) : api_keys_{api_keys} {};
+
+  // ResponseParserResolver
+  ResponseParserSharedPtr createParser(ResponseContextSharedPtr context) const override;
+
+private:
+  const std::vector<int16_t> api_keys_;
+};
+
 /**
  * Response parser uses a single deserializer to construct a response object.
  * This parser is responsible for consuming response-specific data (e.g. topic names) and always
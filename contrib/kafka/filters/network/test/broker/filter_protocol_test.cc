@@ -91,14 +91,34 @@ TEST_F(KafkaBrokerFilterProtocolTest, ShouldHandleBrokenRequestPayload) {
   ASSERT_EQ(testee_.getRequestDecoderForTest()->getCurrentParserForTest(), nullptr);
 }
 
-TEST_F(KafkaBrokerFilterProtocolTest, ShouldHandleBrokenResponsePayload) {
+TEST_F(KafkaBrokerFilterProtocolTest, ShouldSkipRequestPayload) {
+  // given
+
+  // Produce request v0 starts with a nullable string (transactional id), whose invalid length
+  // (< -1) would break the parser if the request data were deserialized.
+  RequestB::putIntoBuffer(static_cast<int32_t>(2 + 2 + 4 + 2 + 2));
+  RequestB::putIntoBuffer(static_cast<int16_t>(0));  // Api key.
+  RequestB::putIntoBuffer(static_cast<int16_t>(0));  // Api version.
+  RequestB::putIntoBuffer(static_cast<int32_t>(0));  // Correlation-id.
+  RequestB::putIntoBuffer(static_cast<int16_t>(-1)); // Client-id.
+  RequestB::putIntoBuffer(static_cast<int16_t>(std::numeric_limits<int16_t>::min())); // Txn id.
+
+  // when
+  const Network::FilterStatus result = consumeRequestFromBuffer();
+
+  // then
+  ASSERT_EQ(result, Network::FilterStatus::Continue);
+  ASSERT_EQ(testee_.getRequestDecoderForTest()->getCurrentParserForTest(), nullptr);
+  ASSERT_EQ(store_.counter(MessageUtilities::requestMetric(0)).value(), 1);
+}
+
+TEST_F(KafkaBrokerFilterProtocolTest, ShouldSkipResponsePayloadIfNotRewriting) {
   // given
 
   const int32_t correlation_id = 42;
-  // Encode broken response into buffer.
   // Produce response v0 is a nullable array of TopicProduceResponses.
-  // Encoding invalid length (< -1) of this nullable array is going to break the parser.
-  ResponseB::putIntoBuffer(BROKEN_MESSAGE_SIZE);
+  // Invalid length (< -1) of this nullable array is not noticed, as the data is skipped.
+  ResponseB::putIntoBuffer(static_cast<int32_t>(4 + 4));
   ResponseB::putIntoBuffer(correlation_id); // Correlation-id.
   ResponseB::putIntoBuffer(static_cast<int32_t>(std::numeric_limits<int32_t>::min())); // Array.
 
@@ -108,8 +128,58 @@ TEST_F(KafkaBrokerFilterProtocolTest, ShouldHandleBrokenResponsePayload) {
   const Network::FilterStatus result = consumeResponseFromBuffer();
 
   // then
-  ASSERT_EQ(result, Network::FilterStatus::StopIteration);
+  ASSERT_EQ(result, Network::FilterStatus::Continue);
   ASSERT_EQ(testee_.getResponseDecoderForTest()->getCurrentParserForTest(), nullptr);
+  ASSERT_EQ(store_.counter(MessageUtilities::responseMetric(0)).value(), 1);
+}
+
+TEST_F(KafkaBrokerFilterProtocolTest, ShouldHandleBrokenResponsePayload) {
+  // given
+
+  // Responses are deserialized only if they are going to be rewritten.
+  KafkaBrokerFilter testee{scope_, time_source_, BrokerFilterConfig{"prefix", true, {}}};
+
+  const int32_t correlation_id = 42;
+  // Encode broken response into buffer.
+  // Metadata response v0 starts with an array of brokers.
+  // Encoding invalid length (< 0) of this array is going to break the parser.
+  ResponseB::putIntoBuffer(BROKEN_MESSAGE_SIZE);
+  ResponseB::putIntoBuffer(correlation_id); // Correlation-id.
+  ResponseB::putIntoBuffer(static_cast<int32_t>(std::numeric_limits<int32_t>::min())); // Array.
+
+  testee.getResponseDecoderForTest()->expectResponse(correlation_id, 3, 0);
+
+  // when
+  const Network::FilterStatus result = testee.onWrite(ResponseB::buffer_, false);
+
+  // then
+  ASSERT_EQ(result, Network::FilterStatus::StopIteration);
+  ASSERT_EQ(testee.getResponseDecoderForTest()->getCurrentParserForTest(), nullptr);
+}
+
+TEST_F(KafkaBrokerFilterProtocolTest, ShouldPassOnResponsesThatAreNotRewritten) {
+  // given
+
+  KafkaBrokerFilter testee{scope_, time_source_, BrokerFilterConfig{"prefix", true, {}}};
+
+  const int32_t correlation_id = 42;
+  // Produce response v0 is a nullable array of TopicProduceResponses.
+  // Invalid length (< -1) of this nullable array is not noticed, as the data is not deserialized
+  // but passed on as it was received.
+  ResponseB::putIntoBuffer(static_cast<int32_t>(4 + 4));
+  ResponseB::putIntoBuffer(correlation_id); // Correlation-id.
+  ResponseB::putIntoBuffer(static_cast<int32_t>(std::numeric_limits<int32_t>::min())); // Array.
+  const std::string original = ResponseB::buffer_.toString();
+
+  testee.getResponseDecoderForTest()->expectResponse(correlation_id, 0, 0);
+
+  // when
+  const Network::FilterStatus result = testee.onWrite(ResponseB::buffer_, false);
+
+  // then
+  ASSERT_EQ(result, Network::FilterStatus::Continue);
+  ASSERT_EQ(ResponseB::buffer_.toString(), original);
+  ASSERT_EQ(store_.counter(MessageUtilities::responseMetric(0)).value(), 1);
 }
 
 TEST_F(KafkaBrokerFilterProtocolTest, ShouldAbortOnUnregisteredResponse) {
@@ -190,6 +190,59 @@ TEST_F(KafkaRequestParserTest, SentinelParserShouldConsumeDataUntilEndOfRequest)
   assertStringViewIncrement(data, orig_data, request_len);
 }
 
+TEST_F(KafkaRequestParserTest, HeaderOnlyParserShouldSkipDataUntilEndOfRequest) {
+  // given
+  const int32_t request_len = 1000;
+  const RequestHeader header{0, 0, 42, "client-id"};
+  RequestContextSharedPtr context{new RequestContext()};
+  context->remaining_request_size_ = request_len;
+  context->request_header_ = header;
+  HeaderOnlyRequestParser testee{context};
+
+  const absl::string_view orig_data = putGarbageIntoBuffer(request_len * 2);
+  absl::string_view data = orig_data;
+
+  // when
+  const RequestParseResponse result = testee.parse(data);
+
+  // then
+  ASSERT_EQ(result.hasData(), true);
+  ASSERT_EQ(result.next_parser_, nullptr);
+  ASSERT_EQ(result.failure_data_, nullptr);
+  const auto message = std::dynamic_pointer_cast<HeaderOnlyRequest>(result.message_);
+  ASSERT_NE(message, nullptr);
+  ASSERT_EQ(message->request_header_, header);
+  ASSERT_EQ(message->data_size_, request_len);
+
+  ASSERT_EQ(testee.contextForTest()->remaining_request_size_, 0);
+
+  assertStringViewIncrement(data, orig_data, request_len);
+}
+
+TEST_F(KafkaRequestParserTest, HeaderOnlyRequestShouldNotBeEncoded) {
+  // given
+  const HeaderOnlyRequest testee{{0, 0, 42, "client-id"}, 1000};
+
+  // when, then - request data is not available.
+  Buffer::OwnedImpl encoded;
+  EXPECT_DEATH(testee.encode(encoded), "the request cannot be encoded");
+}
+
+TEST_F(KafkaRequestParserTest, HeaderOnlyParserResolverShouldReturnSentinelForUnknownRequest) {
+  // given
+  const RequestParserResolver& testee = HeaderOnlyRequestParserResolver::getInstance();
+  RequestContextSharedPtr context{new RequestContext()};
+
+  // when
+  const RequestParserSharedPtr known = testee.createParser(0, 0, context);
+  const RequestParserSharedPtr unknown =
+      testee.createParser(std::numeric_limits<int16_t>::max(), 0, context);
+
+  // then
+  ASSERT_NE(std::dynamic_pointer_cast<HeaderOnlyRequestParser>(known), nullptr);
+  ASSERT_NE(std::dynamic_pointer_cast<SentinelParser>(unknown), nullptr);
+}
+
 } // namespace KafkaRequestParserTest
 } // namespace Kafka
 } // namespace NetworkFilters
@@ -1,5 +1,6 @@
 #include "test/test_common/utility.h"
 
+#include "contrib/kafka/filters/network/source/external/responses.h"
 #include "contrib/kafka/filters/network/source/kafka_response_parser.h"
 #include "contrib/kafka/filters/network/test/buffer_based_test.h"
 #include "contrib/kafka/filters/network/test/serialization_utilities.h"
@@ -188,6 +189,140 @@ TEST_F(KafkaResponseParserTest, SentinelResponseParserShouldConsumeDataUntilEndO
   assertStringViewIncrement(data, orig_data, response_len);
 }
 
+TEST_F(KafkaResponseParserTest, HeaderOnlyResponseParserShouldSkipDataUntilEndOfMessage) {
+  // given
+  const int32_t response_len = 1000;
+  ResponseContextSharedPtr context = std::make_shared<ResponseContext>();
+  context->remaining_response_size_ = response_len;
+  context->api_key_ = 0;
+  context->api_version_ = 0;
+  context->correlation_id_ = 42;
+  HeaderOnlyResponseParser testee{context};
+
+  const absl::string_view orig_data = putGarbageIntoBuffer(response_len * 2);
+  absl::string_view data = orig_data;
+
+  // when
+  const ResponseParseResponse result = testee.parse(data);
+
+  // then
+  ASSERT_EQ(result.hasData(), true);
+  ASSERT_EQ(result.next_parser_, nullptr);
+  ASSERT_EQ(result.failure_data_, nullptr);
+  const auto message = std::dynamic_pointer_cast<HeaderOnlyResponse>(result.message_);
+  ASSERT_NE(message, nullptr);
+  ASSERT_EQ(message->metadata_.correlation_id_, 42);
+  ASSERT_EQ(message->data_size_, response_len);
+
+  ASSERT_EQ(testee.contextForTest()->remaining_response_size_, 0);
+
+  assertStringViewIncrement(data, orig_data, response_len);
+}
+
+TEST_F(KafkaResponseParserTest, HeaderOnlyResponseShouldNotBeEncoded) {
+  // given
+  const HeaderOnlyResponse testee{{0, 0, 42}, 1000};
+
+  // when, then - response data is not available.
+  Buffer::OwnedImpl encoded;
+  EXPECT_DEATH(testee.encode(encoded), "the response cannot be encoded");
+}
+
+TEST_F(KafkaResponseParserTest, RawResponseParserShouldKeepDataUntilEndOfMessage) {
+  // given
+  const int32_t response_len = 1000;
+  ResponseContextSharedPtr context = std::make_shared<ResponseContext>();
+  context->remaining_response_size_ = response_len;
+  context->api_key_ = 0;
+  context->api_version_ = 0;
+  context->correlation_id_ = 42;
+  RawResponseParser testee{context};
+
+  const absl::string_view orig_data = putGarbageIntoBuffer(response_len * 2);
+  absl::string_view data = orig_data;
+
+  // when
+  const ResponseParseResponse result = testee.parse(data);
+
+  // then
+  ASSERT_EQ(result.hasData(), true);
+  ASSERT_EQ(result.next_parser_, nullptr);
+  ASSERT_EQ(result.failure_data_, nullptr);
+  const auto message = std::dynamic_pointer_cast<RawResponse>(result.message_);
+  ASSERT_NE(message, nullptr);
+  ASSERT_EQ(message->metadata_.correlation_id_, 42);
+  ASSERT_EQ(message->data_, orig_data.substr(0, response_len));
+
+  ASSERT_EQ(testee.contextForTest()->remaining_response_size_, 0);
+
+  assertStringViewIncrement(data, orig_data, response_len);
+}
+
+TEST_F(KafkaResponseParserTest, RawResponseShouldEncodeRawData) {
+  // given
+  const ResponseMetadata metadata = {0, 0, 42};
+  const Response<ProduceResponse> response = {metadata, ProduceResponse{{}}};
+  Buffer::OwnedImpl data;
+  EncodingContext context{0};
+  context.encode(response.data_, data);
+  const RawResponse testee{metadata, data.toString()};
+
+  // when
+  Buffer::OwnedImpl encoded;
+  const uint32_t written = testee.encode(encoded);
+
+  // then
+  Buffer::OwnedImpl expected;
+  response.encode(expected);
+  ASSERT_EQ(written, response.computeSize());
+  ASSERT_EQ(testee.computeSize(), response.computeSize());
+  ASSERT_EQ(encoded.toString(), expected.toString());
+}
+
+TEST_F(KafkaResponseParserTest, SelectiveParserResolverShouldDeserializeOnlyGivenResponses) {
+  // given
+  const SelectiveResponseParserResolver testee{{3}};
+  ResponseContextSharedPtr selected_context = std::make_shared<ResponseContext>();
+  selected_context->api_key_ = 3;
+  selected_context->api_version_ = 0;
+  ResponseContextSharedPtr other_context = std::make_shared<ResponseContext>();
+  other_context->api_key_ = 0;
+  other_context->api_version_ = 0;
+  ResponseContextSharedPtr unknown_context = std::make_shared<ResponseContext>();
+  unknown_context->api_key_ = std::numeric_limits<int16_t>::max();
+  unknown_context->api_version_ = 0;
+
+  // when
+  const ResponseParserSharedPtr selected = testee.createParser(selected_context);
+  const ResponseParserSharedPtr other = testee.createParser(other_context);
+  const ResponseParserSharedPtr unknown = testee.createParser(unknown_context);
+
+  // then
+  ASSERT_EQ(std::dynamic_pointer_cast<RawResponseParser>(selected), nullptr);
+  ASSERT_EQ(std::dynamic_pointer_cast<SentinelResponseParser>(selected), nullptr);
+  ASSERT_NE(std::dynamic_pointer_cast<RawResponseParser>(other), nullptr);
+  ASSERT_NE(std::dynamic_pointer_cast<SentinelResponseParser>(unknown), nullptr);
+}
+
+TEST_F(KafkaResponseParserTest, HeaderOnlyParserResolverShouldReturnSentinelForUnknownResponse) {
+  // given
+  const ResponseParserResolver& testee = HeaderOnlyResponseParserResolver::getInstance();
+  ResponseContextSharedPtr known_context = std::make_shared<ResponseContext>();
+  known_context->api_key_ = 0;
+  known_context->api_version_ = 0;
+  ResponseContextSharedPtr unknown_context = std::make_shared<ResponseContext>();
+  unknown_context->api_key_ = std::numeric_limits<int16_t>::max();
+  unknown_context->api_version_ = 0;
+
+  // when
+  const ResponseParserSharedPtr known = testee.createParser(known_context);
+  const ResponseParserSharedPtr unknown = testee.createParser(unknown_context);
+
+  // then
+  ASSERT_NE(std::dynamic_pointer_cast<HeaderOnlyResponseParser>(known), nullptr);
+  ASSERT_NE(std::dynamic_pointer_cast<SentinelResponseParser>(unknown), nullptr);
+}
+
 } // namespace KafkaResponseParserTest
 } // namespace Kafka
 } // namespace NetworkFilters
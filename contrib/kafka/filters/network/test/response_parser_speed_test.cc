@@ -0,0 +1,89 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from
+// a quiescent system with disabled cstate power management.
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/common/assert.h"
+
+#include "benchmark/benchmark.h"
+#include "contrib/kafka/filters/network/source/response_codec.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace Kafka {
+namespace {
+
+constexpr int16_t FETCH_API_KEY = 1;
+constexpr int16_t FETCH_API_VERSION = 0;
+constexpr int32_t RESPONSE_COUNT = 16;
+
+// Callback that only counts the responses, so that the decoding dominates the measurements.
+class CountingCallback : public ResponseCallback {
+public:
+  void onMessage(AbstractResponseSharedPtr) override { ++messages_; }
+  void onFailedParse(ResponseMetadataSharedPtr) override { ++failures_; }
+
+  uint64_t messages_{0};
+  uint64_t failures_{0};
+};
+
+// Fetch responses carrying a single record batch of given size, like the ones received by a
+// consumer.
+void putFetchResponses(Buffer::Instance& buffer, const uint32_t batch_size) {
+  ResponseEncoder encoder{buffer};
+  for (int32_t i = 0; i < RESPONSE_COUNT; ++i) {
+    const ResponseMetadata metadata = {FETCH_API_KEY, FETCH_API_VERSION, i};
+    const FetchResponseResponsePartitionData partition = {0, 0, 0, Bytes(batch_size, 'x')};
+    const FetchableTopicResponse topic = {"topic", {partition}};
+    const FetchResponse data = {std::vector<FetchableTopicResponse>{topic}};
+    encoder.encode(Response<FetchResponse>{metadata, data});
+  }
+}
+
+void decodeFetchResponses(benchmark::State& state, const ResponseParserResolver& resolver) {
+  Buffer::OwnedImpl buffer;
+  putFetchResponses(buffer, static_cast<uint32_t>(state.range(0)));
+  const auto callback = std::make_shared<CountingCallback>();
+  for (auto _ : state) { // NOLINT
+    ResponseDecoder decoder{ResponseInitialParserFactory::getDefaultInstance(), resolver,
+                            {callback}};
+    for (int32_t i = 0; i < RESPONSE_COUNT; ++i) {
+      decoder.expectResponse(i, FETCH_API_KEY, FETCH_API_VERSION);
+    }
+    decoder.onData(buffer);
+  }
+  RELEASE_ASSERT(callback->messages_ == static_cast<uint64_t>(state.iterations()) * RESPONSE_COUNT,
+                 "");
+  RELEASE_ASSERT(callback->failures_ == 0, "");
+  state.SetBytesProcessed(state.iterations() * buffer.length());
+}
+
+} // namespace
+
+// Responses deserialized into generated message types, as done before the broker filter started
+// skipping response data.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_FullResponseParsing(benchmark::State& state) {
+  decodeFetchResponses(state, ResponseParserResolver::getDefaultInstance());
+}
+BENCHMARK(BM_FullResponseParsing)->Range(1024, 1024 * 1024);
+
+// Responses kept as raw data, as done by the broker filter that rewrites responses.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_RawResponseParsing(benchmark::State& state) {
+  const SelectiveResponseParserResolver resolver{std::vector<int16_t>{}};
+  decodeFetchResponses(state, resolver);
+}
+BENCHMARK(BM_RawResponseParsing)->Range(1024, 1024 * 1024);
+
+// Responses skipped, as done by the broker filter that does not rewrite responses.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_HeaderOnlyResponseParsing(benchmark::State& state) {
+  decodeFetchResponses(state, HeaderOnlyResponseParserResolver::getInstance());
+}
+BENCHMARK(BM_HeaderOnlyResponseParsing)->Range(1024, 1024 * 1024);
+
+} // namespace Kafka
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,99 @@
+#include "contrib/mysql_proxy/filters/network/source/mysql_auth.h"
+
+#include <cstdint>
+
+#include "source/common/common/assert.h"
+
+#include "absl/strings/str_cat.h"
+#include "openssl/bio.h"
+#include "openssl/mem.h"
+#include "openssl/pem.h"
+#include "openssl/rsa.h"
+#include "openssl/sha.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace MySQLProxy {
+
+namespace {
+
+std::string sha1(absl::string_view data) {
+  std::string out(SHA_DIGEST_LENGTH, '\0');
+  SHA1(reinterpret_cast<const uint8_t*>(data.data()), data.size(),
+       reinterpret_cast<uint8_t*>(out.data()));
+  return out;
+}
+
+std::string sha256(absl::string_view data) {
+  std::string out(SHA256_DIGEST_LENGTH, '\0');
+  SHA256(reinterpret_cast<const uint8_t*>(data.data()), data.size(),
+         reinterpret_cast<uint8_t*>(out.data()));
+  return out;
+}
+
+// XORs data with key, repeating the key as needed.
+std::string xorWith(absl::string_view data, absl::string_view key) {
+  ASSERT(!key.empty());
+  std::string out(data);
+  for (size_t i = 0; i < out.size(); i++) {
+    out[i] ^= key[i % key.size()];
+  }
+  return out;
+}
+
+} // namespace
+
+std::string Auth::nativePassword(absl::string_view password, absl::string_view scramble) {
+  if (password.empty()) {
+    return "";
+  }
+  const std::string stage1 = sha1(password);
+  return xorWith(stage1, sha1(absl::StrCat(scramble, sha1(stage1))));
+}
+
+std::string Auth::cachingSha2Password(absl::string_view password, absl::string_view scramble) {
+  if (password.empty()) {
+    return "";
+  }
+  const std::string stage1 = sha256(password);
+  return xorWith(stage1, sha256(absl::StrCat(sha256(stage1), scramble)));
+}
+
+bool Auth::verifyNativePassword(absl::string_view password, absl::string_view scramble,
+                                absl::string_view response) {
+  const std::string expected = nativePassword(password, scramble);
+  return expected.size() == response.size() &&
+         CRYPTO_memcmp(expected.data(), response.data(), expected.size()) == 0;
+}
+
+absl::optional<std::string> Auth::rsaEncryptPassword(absl::string_view password,
+                                                     absl::string_view scramble,
+                                                     absl::string_view public_key) {
+  bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(public_key.data(), public_key.size()));
+  if (bio == nullptr) {
+    return absl::nullopt;
+  }
+  bssl::UniquePtr<RSA> rsa(PEM_read_bio_RSA_PUBKEY(bio.get(), nullptr, nullptr, nullptr));
+  if (rsa == nullptr) {
+    return absl::nullopt;
+  }
+
+  const std::string plaintext =
+      xorWith(absl::StrCat(password, absl::string_view("\0", 1)), scramble);
+  std::string out(RSA_size(rsa.get()), '\0');
+  const int size = RSA_public_encrypt(plaintext.size(),
+                                      reinterpret_cast<const uint8_t*>(plaintext.data()),
+                                      reinterpret_cast<uint8_t*>(out.data()), rsa.get(),
+                                      RSA_PKCS1_OAEP_PADDING);
+  if (size < 0) {
+    return absl::nullopt;
+  }
+  out.resize(size);
+  return out;
+}
+
+} // namespace MySQLProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace MySQLProxy {
+
+/**
+ * Helpers used in connection pooling mode to authenticate clients at the proxy and to answer the
+ * password challenges of a MySQL server.
+ * See https://dev.mysql.com/doc/dev/mysql-server/latest/page_protocol_connection_phase.html.
+ */
+class Auth {
+public:
+  static constexpr absl::string_view NativePassword = "mysql_native_password";
+  static constexpr absl::string_view CachingSha2Password = "caching_sha2_password";
+
+  // The length of the scramble sent in the initial handshake.
+  static constexpr size_t ScrambleLength = 20;
+
+  /**
+   * @return the mysql_native_password response to a scramble:
+   *         SHA1(password) XOR SHA1(scramble + SHA1(SHA1(password))), or an empty response for an
+   *         empty password.
+   */
+  static std::string nativePassword(absl::string_view password, absl::string_view scramble);
+
+  /**
+   * @return the caching_sha2_password response to a scramble:
+   *         SHA256(password) XOR SHA256(SHA256(SHA256(password)) + scramble), or an empty
+   *         response for an empty password.
+   */
+  static std::string cachingSha2Password(absl::string_view password, absl::string_view scramble);
+
+  /**
+   * @return whether a mysql_native_password response proves the knowledge of the password. The
+   *         comparison takes constant time.
+   */
+  static bool verifyNativePassword(absl::string_view password, absl::string_view scramble,
+                                   absl::string_view response);
+
+  /**
+   * @return the password, null terminated and XORed with the scramble, encrypted with the RSA
+   *         public key of the server for the full caching_sha2_password authentication over an
+   *         insecure connection, or absl::nullopt if the key cannot be read.
+   * @param public_key supplies the PEM encoded public key sent by the server.
+   */
+  static absl::optional<std::string> rsaEncryptPassword(absl::string_view password,
+                                                        absl::string_view scramble,
+                                                        absl::string_view public_key);
+};
+
+} // namespace MySQLProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -87,11 +87,21 @@ constexpr uint32_t CLIENT_PLUGIN_AUTH_LENENC_CLIENT_DATA = 0x00200000;
 constexpr uint32_t CLIENT_CONNECT_WITH_DB = 0x00000008;
 constexpr uint32_t CLIENT_CONNECT_ATTRS = 0x00100000;
 constexpr uint32_t CLIENT_SSL = 0x00000800;
+constexpr uint32_t CLIENT_MULTI_RESULTS = 0x00020000;
+constexpr uint32_t CLIENT_PS_MULTI_RESULTS = 0x00040000;
+constexpr uint32_t CLIENT_DEPRECATE_EOF = 0x01000000;
 constexpr uint16_t MYSQL_EXT_CL_PLUGIN_AUTH = 0x8;
 constexpr uint32_t MYSQL_MAX_PACKET = 0x00000001;
 constexpr uint8_t MYSQL_CHARSET = 0x21;
 constexpr uint8_t DEFAULT_MYSQL_CHARSET = 45; // utf8mb4
 constexpr uint16_t DEFALUT_MYSQL_SERVER_STATUS = 2;
+
+// server status flags, sent in OK and EOF packets
+constexpr uint16_t SERVER_STATUS_IN_TRANS = 0x0001;
+constexpr uint16_t SERVER_STATUS_AUTOCOMMIT = 0x0002;
+constexpr uint16_t SERVER_MORE_RESULTS_EXISTS = 0x0008;
+constexpr uint16_t SERVER_STATUS_CURSOR_EXISTS = 0x0040;
+
 constexpr uint8_t MYSQL_SQL_STATE_LEN = 5;
 constexpr int NATIVE_PSSWORD_HASH_LENGTH = 20;
 constexpr int OLD_PASSWORD_HASH_LENGTH = 8;
@@ -115,6 +125,10 @@ constexpr uint16_t ER_NET_PACKETS_OUT_OF_ORDER = 1156;
 constexpr uint16_t ER_PASSWD_LENGTH = 1372;
 constexpr uint16_t ER_ACCESS_DENIED_ERROR = 1045;
 constexpr uint16_t ER_ER_BAD_DB_ERROR = 1049;
+constexpr uint16_t ER_HANDSHAKE_ERROR = 1043;
+constexpr uint16_t ER_DBACCESS_DENIED_ERROR = 1044;
+constexpr uint16_t ER_UNKNOWN_COM_ERROR = 1047;
+constexpr uint16_t ER_UNKNOWN_ERROR = 1105;
 constexpr uint8_t MYSQL_SQL_STATE_MARKER = '#';
 
 enum DecodeStatus : uint8_t {
@@ -1,10 +1,16 @@
 #include "contrib/mysql_proxy/filters/network/source/mysql_codec_command.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "envoy/buffer/buffer.h"
 
+#include "source/common/common/assert.h"
 #include "source/common/common/logger.h"
 #include "source/common/common/macros.h"
 
+#include "absl/strings/ascii.h"
+
 #include "contrib/mysql_proxy/filters/network/source/mysql_codec.h"
 #include "contrib/mysql_proxy/filters/network/source/mysql_utils.h"
 
@@ -13,6 +19,114 @@ namespace Extensions {
 namespace NetworkFilters {
 namespace MySQLProxy {
 
+namespace {
+
+// The longest prefix of a response packet that is needed to find the end of the response: an OK
+// packet with two 9 byte length encoded integers before the status flags.
+constexpr uint32_t MaxResponseHead = 32;
+
+// Splits the text of a query into upper case words, skipping literals, quoted identifiers and
+// comments. Statement separators are returned as ";", and user variables as "@".
+std::vector<std::string> scanQuery(absl::string_view query) {
+  std::vector<std::string> words;
+  size_t i = 0;
+  while (i < query.size()) {
+    const char c = query[i];
+    if (c == '\'' || c == '"' || c == '`') {
+      // Quotes are escaped by a backslash or by doubling them, which reads as two literals.
+      for (i++; i < query.size() && query[i] != c; i++) {
+        if (query[i] == '\\' && c != '`') {
+          i++;
+        }
+      }
+      i++;
+    } else if (c == '#' || (c == '-' && query.substr(i, 2) == "--" &&
+                            (i + 2 == query.size() || absl::ascii_isspace(query[i + 2])))) {
+      const size_t end = query.find('\n', i);
+      i = end == absl::string_view::npos ? query.size() : end + 1;
+    } else if (c == '/' && query.substr(i, 3) == "/*!") {
+      // Executable comments hold statements for the server, optionally after a version number.
+      for (i += 3; i < query.size() && absl::ascii_isdigit(query[i]); i++) {
+      }
+    } else if (c == '/' && query.substr(i, 2) == "/*") {
+      const size_t end = query.find("*/", i + 2);
+      i = end == absl::string_view::npos ? query.size() : end + 2;
+    } else if (c == ';') {
+      words.emplace_back(";");
+      i++;
+    } else if (c == '@') {
+      if (query.substr(i, 2) == "@@") {
+        // System variables can only be changed with SET, which is classified on its own.
+        i += 2;
+      } else {
+        words.emplace_back("@");
+        i++;
+      }
+    } else if (absl::ascii_isalnum(c) || c == '_' || c == '$') {
+      const size_t start = i;
+      while (i < query.size() &&
+             (absl::ascii_isalnum(query[i]) || query[i] == '_' || query[i] == '$')) {
+        i++;
+      }
+      words.push_back(absl::AsciiStrToUpper(query.substr(start, i - start)));
+    } else {
+      i++;
+    }
+  }
+  return words;
+}
+
+// Reads a length encoded integer at the front of data and removes it.
+bool readLengthEncodedInteger(absl::string_view& data, uint64_t& value) {
+  if (data.empty()) {
+    return false;
+  }
+  const uint8_t first = data[0];
+  if (first < LENENCODINT_1BYTE) {
+    value = first;
+    data.remove_prefix(1);
+    return true;
+  }
+  size_t size = 0;
+  switch (first) {
+  case LENENCODINT_2BYTES:
+    size = 2;
+    break;
+  case LENENCODINT_3BYTES:
+    size = 3;
+    break;
+  case LENENCODINT_8BYTES:
+    size = 8;
+    break;
+  default:
+    return false;
+  }
+  if (data.size() < 1 + size) {
+    return false;
+  }
+  value = 0;
+  for (size_t i = 0; i < size; i++) {
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(data[1 + i])) << (8 * i);
+  }
+  data.remove_prefix(1 + size);
+  return true;
+}
+
+// Reads a little endian integer of the given size at an offset of data, or returns 0 if data is
+// too short.
+uint32_t readInteger(absl::string_view data, size_t offset, size_t size) {
+  if (data.size() < offset + size) {
+    return 0;
+  }
+  uint32_t value = 0;
+  for (size_t i = 0; i < size; i++) {
+    value |= static_cast<uint32_t>(static_cast<uint8_t>(data[offset + i])) << (8 * i);
+  }
+  return value;
+}
+
+} // namespace
+
 Command::Cmd Command::parseCmd(Buffer::Instance& data) {
   uint8_t cmd;
   if (BufferHelper::readUint8(data, cmd) != DecodeStatus::Success) {
@@ -53,6 +167,49 @@ DecodeStatus Command::parseMessage(Buffer::Instance& buffer, uint32_t len) {
 
 void Command::setData(const std::string& data) { data_.assign(data); }
 
+uint32_t Command::getPinReasons() const {
+  switch (cmd_) {
+  case Command::Cmd::InitDb:
+  case Command::Cmd::SetOption:
+    return MySQLSession::Variables;
+  case Command::Cmd::Query:
+    break;
+  default:
+    return 0;
+  }
+
+  uint32_t reasons = 0;
+  const std::vector<std::string> words = scanQuery(data_);
+  bool statement_start = true;
+  for (size_t i = 0; i < words.size(); i++) {
+    const std::string& word = words[i];
+    if (word == ";") {
+      statement_start = true;
+      continue;
+    }
+    if (word == "@" || word == "SQL_CALC_FOUND_ROWS") {
+      // User variables, and the row count read by a later FOUND_ROWS().
+      reasons |= MySQLSession::Variables;
+    } else if (word == "GET_LOCK") {
+      reasons |= MySQLSession::Locks;
+    }
+    if (!statement_start) {
+      continue;
+    }
+    statement_start = false;
+    if (word == "SET" || word == "USE") {
+      reasons |= MySQLSession::Variables;
+    } else if (word == "PREPARE" || word == "EXECUTE" || word == "DEALLOCATE") {
+      reasons |= MySQLSession::PreparedStatements;
+    } else if (word == "LOCK" || word == "HANDLER" || word == "XA") {
+      reasons |= MySQLSession::Locks;
+    } else if (word == "CREATE" && i + 1 < words.size() && words[i + 1] == "TEMPORARY") {
+      reasons |= MySQLSession::TemporaryTables;
+    }
+  }
+  return reasons;
+}
+
 void Command::encode(Buffer::Instance& out) const {
   BufferHelper::addUint8(out, static_cast<int>(cmd_));
   switch (cmd_) {
@@ -78,6 +235,161 @@ DecodeStatus CommandResponse::parseMessage(Buffer::Instance& buffer, uint32_t le
 
 void CommandResponse::encode(Buffer::Instance& out) const { BufferHelper::addString(out, data_); }
 
+bool CommandResponseTracker::expectsResponse(Command::Cmd cmd) {
+  switch (cmd) {
+  case Command::Cmd::Quit:
+  case Command::Cmd::StmtSendLongData:
+  case Command::Cmd::StmtClose:
+    return false;
+  default:
+    return true;
+  }
+}
+
+bool CommandResponseTracker::onPacket(const Buffer::Instance& packet, uint32_t length) {
+  ASSERT(state_ != State::Done);
+  char head_data[MaxResponseHead];
+  const uint32_t head_length = std::min(length, MaxResponseHead);
+  packet.copyOut(MYSQL_HDR_SIZE, head_length, head_data);
+  const absl::string_view head(head_data, head_length);
+  const uint8_t first = head.empty() ? 0 : head[0];
+  // Rows may start with 0xfe too, but are at least 9 bytes long then.
+  const bool eof = first == EOF_MARKER && length < 9;
+
+  switch (state_) {
+  case State::First:
+    return onFirstPacket(head, eof);
+  case State::ColumnDefinitions:
+    if (!eof) {
+      return false;
+    }
+    readEofStatus(head);
+    if (server_status_.value_or(0) & SERVER_STATUS_CURSOR_EXISTS) {
+      // The rows are read with COM_STMT_FETCH.
+      return done();
+    }
+    state_ = State::Rows;
+    return false;
+  case State::Rows:
+    if (first == ERR_MARKER) {
+      error_ = true;
+      return done();
+    }
+    if (!eof) {
+      return false;
+    }
+    readEofStatus(head);
+    return endOfResultSet();
+  case State::Params:
+    if (!eof) {
+      return false;
+    }
+    if (statement_columns_) {
+      state_ = State::UntilEof;
+      return false;
+    }
+    return done();
+  case State::UntilEof:
+    if (first == ERR_MARKER) {
+      error_ = true;
+      return done();
+    }
+    if (!eof) {
+      return false;
+    }
+    readEofStatus(head);
+    return done();
+  case State::Done:
+    break;
+  }
+  return true;
+}
+
+bool CommandResponseTracker::onFirstPacket(absl::string_view head, bool eof) {
+  const uint8_t first = head.empty() ? 0 : head[0];
+  if (first == ERR_MARKER) {
+    error_ = true;
+    return done();
+  }
+
+  switch (cmd_) {
+  case Command::Cmd::Query:
+  case Command::Cmd::StmtExecute:
+  case Command::Cmd::ProcessInfo:
+    if (first == MYSQL_RESP_OK) {
+      readOkStatus(head);
+      return endOfResultSet();
+    }
+    // The column count of a result set.
+    state_ = State::ColumnDefinitions;
+    return false;
+  case Command::Cmd::StmtPrepare: {
+    // OK, statement ID, column count, parameter count, filler and warning count.
+    statement_id_ = readInteger(head, 1, 4);
+    const uint32_t columns = readInteger(head, 5, 2);
+    const uint32_t params = readInteger(head, 7, 2);
+    statement_columns_ = columns > 0;
+    if (params > 0) {
+      state_ = State::Params;
+      return false;
+    }
+    if (columns > 0) {
+      state_ = State::UntilEof;
+      return false;
+    }
+    return done();
+  }
+  case Command::Cmd::FieldList:
+  case Command::Cmd::StmtFetch:
+    if (eof) {
+      readEofStatus(head);
+      return done();
+    }
+    state_ = State::UntilEof;
+    return false;
+  case Command::Cmd::Statistics:
+    // A human readable string.
+    return done();
+  default:
+    if (first == MYSQL_RESP_OK) {
+      readOkStatus(head);
+    } else if (eof) {
+      readEofStatus(head);
+    }
+    return done();
+  }
+}
+
+bool CommandResponseTracker::endOfResultSet() {
+  if (server_status_.value_or(0) & SERVER_MORE_RESULTS_EXISTS) {
+    state_ = State::First;
+    return false;
+  }
+  return done();
+}
+
+bool CommandResponseTracker::done() {
+  state_ = State::Done;
+  return true;
+}
+
+void CommandResponseTracker::readOkStatus(absl::string_view head) {
+  // Header, affected rows, last insert ID and the status flags.
+  head.remove_prefix(1);
+  uint64_t value;
+  if (readLengthEncodedInteger(head, value) && readLengthEncodedInteger(head, value) &&
+      head.size() >= 2) {
+    server_status_ = readInteger(head, 0, 2);
+  }
+}
+
+void CommandResponseTracker::readEofStatus(absl::string_view head) {
+  // Header, warning count and the status flags.
+  if (head.size() >= 5) {
+    server_status_ = readInteger(head, 3, 2);
+  }
+}
+
 } // namespace MySQLProxy
 } // namespace NetworkFilters
 } // namespace Extensions
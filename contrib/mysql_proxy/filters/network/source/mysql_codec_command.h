@@ -3,7 +3,10 @@
 
 #include "source/common/buffer/buffer_impl.h"
 
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "contrib/mysql_proxy/filters/network/source/mysql_codec.h"
+#include "contrib/mysql_proxy/filters/network/source/mysql_session.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -32,7 +35,19 @@ public:
     Time = 15,
     DelayedInsert = 16,
     ChangeUser = 17,
+    BinlogDump = 18,
+    TableDump = 19,
+    ConnectOut = 20,
+    RegisterSlave = 21,
+    StmtPrepare = 22,
+    StmtExecute = 23,
+    StmtSendLongData = 24,
+    StmtClose = 25,
+    StmtReset = 26,
+    SetOption = 27,
+    StmtFetch = 28,
     Daemon = 29,
+    BinlogDumpGtid = 30,
     ResetConnection = 31,
   };
 
@@ -50,6 +65,13 @@ public:
   void setIsQuery(bool is_query) { is_query_ = is_query; }
   bool isQuery() { return is_query_; }
 
+  /**
+   * @return the session state the command may create on the server connection it runs on, as a
+   *         combination of MySQLSession::PinReason. The statements of COM_QUERY are classified by
+   *         their leading keywords, and conservatively pin the session when in doubt.
+   */
+  uint32_t getPinReasons() const;
+
 private:
   Cmd cmd_;
   std::string data_;
@@ -72,6 +94,66 @@ private:
   std::string data_;
 };
 
+/**
+ * Finds the end of the response to a command in the packets sent by a server connection that did
+ * not negotiate CLIENT_DEPRECATE_EOF, so that result sets end with an EOF packet.
+ * See https://dev.mysql.com/doc/dev/mysql-server/latest/page_protocol_command_phase.html.
+ */
+class CommandResponseTracker {
+public:
+  CommandResponseTracker(Command::Cmd cmd) : cmd_(cmd) {}
+
+  /**
+   * @return whether the server answers the command. COM_STMT_CLOSE, COM_STMT_SEND_LONG_DATA and
+   *         COM_QUIT have no response.
+   */
+  static bool expectsResponse(Command::Cmd cmd);
+
+  /**
+   * Processes the next packet of the response. Continuation packets of a payload larger than
+   * 16MB must not be passed.
+   * @param packet supplies the packet, starting with its header. It is not modified.
+   * @param length supplies the length of the packet payload.
+   * @return whether the packet completes the response.
+   */
+  bool onPacket(const Buffer::Instance& packet, uint32_t length);
+
+  bool error() const { return error_; }
+  // The server status flags of the last OK or EOF packet, if the response had any.
+  absl::optional<uint16_t> serverStatus() const { return server_status_; }
+  // The ID of the statement created by a successful COM_STMT_PREPARE.
+  uint32_t statementId() const { return statement_id_; }
+
+private:
+  enum class State {
+    // Expecting the first packet of a response or of the next result set.
+    First,
+    // Column definitions, followed by an EOF packet and the rows of a result set.
+    ColumnDefinitions,
+    // Rows of a result set, followed by an EOF or ERR packet.
+    Rows,
+    // Parameter definitions of a prepared statement, followed by an EOF packet.
+    Params,
+    // Packets up to an EOF or ERR packet that ends the response.
+    UntilEof,
+    Done,
+  };
+
+  bool onFirstPacket(absl::string_view head, bool eof);
+  bool endOfResultSet();
+  bool done();
+  void readOkStatus(absl::string_view head);
+  void readEofStatus(absl::string_view head);
+
+  const Command::Cmd cmd_;
+  State state_{State::First};
+  // Whether a prepared statement has column definitions after its parameter definitions.
+  bool statement_columns_{false};
+  bool error_{false};
+  absl::optional<uint16_t> server_status_;
+  uint32_t statement_id_{0};
+};
+
 } // namespace MySQLProxy
 } // namespace NetworkFilters
 } // namespace Extensions
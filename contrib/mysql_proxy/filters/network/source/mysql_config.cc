@@ -6,6 +6,7 @@
 #include "envoy/server/filter_config.h"
 
 #include "source/common/common/logger.h"
+#include "source/common/config/datasource.h"
 
 #include "contrib/envoy/extensions/filters/network/mysql_proxy/v3/mysql_proxy.pb.h"
 #include "contrib/envoy/extensions/filters/network/mysql_proxy/v3/mysql_proxy.pb.validate.h"
@@ -30,8 +31,29 @@ NetworkFilters::MySQLProxy::MySQLConfigFactory::createFilterFactoryFromProtoType
 
   MySQLFilterConfigSharedPtr filter_config(
       std::make_shared<MySQLFilterConfig>(stat_prefix, context.scope()));
+
+  if (proto_config.has_connection_pooling()) {
+    const auto& pooling = proto_config.connection_pooling();
+    auto& server_context = context.serverFactoryContext();
+    auto settings = std::make_shared<ConnPool::PoolSettings>(
+        pooling.cluster(), pooling.username(),
+        Config::DataSource::read(pooling.password(), true, server_context.api()),
+        pooling.database(), PROTOBUF_GET_WRAPPED_OR_DEFAULT(pooling, max_server_connections, 100),
+        pooling.server_version().empty() ? "8.0.0" : pooling.server_version(), context.scope(),
+        Envoy::statPrefixJoin(stat_prefix, "pool"));
+
+    filter_config->pools_ =
+        ThreadLocal::TypedSlot<ConnPool::InstanceImpl>::makeUnique(server_context.threadLocal());
+    filter_config->pools_->set([settings, &cluster_manager = server_context.clusterManager(),
+                                &random = server_context.api().randomGenerator()](
+                                   Event::Dispatcher& dispatcher) {
+      return std::make_shared<ConnPool::InstanceImpl>(settings, cluster_manager, dispatcher,
+                                                      random);
+    });
+  }
+
   return [filter_config](Network::FilterManager& filter_manager) -> void {
-    filter_manager.addFilter(std::make_shared<MySQLFilter>(filter_config));
+    filter_manager.addFilter(std::make_shared<MySQLFilter>(filter_config, filter_config->pool()));
   };
 }
 
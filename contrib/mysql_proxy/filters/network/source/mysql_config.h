@@ -21,6 +21,12 @@ public:
   MySQLConfigFactory() : FactoryBase(NetworkFilterNames::get().MySQLProxy) {}
 
 private:
+  bool isTerminalFilterByProtoTyped(
+      const envoy::extensions::filters::network::mysql_proxy::v3::MySQLProxy& proto_config,
+      Server::Configuration::ServerFactoryContext&) override {
+    return proto_config.has_connection_pooling();
+  }
+
   Network::FilterFactoryCb createFilterFactoryFromProtoTyped(
       const envoy::extensions::filters::network::mysql_proxy::v3::MySQLProxy& proto_config,
       Server::Configuration::FactoryContext& context) override;
@@ -0,0 +1,451 @@
+#include "contrib/mysql_proxy/filters/network/source/mysql_conn_pool.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "source/common/common/assert.h"
+
+#include "contrib/mysql_proxy/filters/network/source/mysql_auth.h"
+#include "contrib/mysql_proxy/filters/network/source/mysql_codec_clogin.h"
+#include "contrib/mysql_proxy/filters/network/source/mysql_codec_clogin_resp.h"
+#include "contrib/mysql_proxy/filters/network/source/mysql_utils.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace MySQLProxy {
+namespace ConnPool {
+
+namespace {
+
+// Data of the AuthMoreData packets of caching_sha2_password, and the request for the public key
+// of the server.
+constexpr char CachingSha2RequestPublicKey = 0x02;
+constexpr char CachingSha2FastAuthSuccess = 0x03;
+constexpr char CachingSha2PerformFullAuth = 0x04;
+
+std::string scrambleFrom(const std::vector<uint8_t>& data) {
+  // The scramble is usually followed by a null terminator.
+  return {data.begin(), data.begin() + std::min(data.size(), Auth::ScrambleLength)};
+}
+
+} // namespace
+
+PoolSettings::PoolSettings(std::string cluster, std::string username, std::string password,
+                           std::string database, uint32_t max_server_connections,
+                           std::string server_version, Stats::Scope& scope,
+                           const std::string& stats_prefix)
+    : cluster_(std::move(cluster)), username_(std::move(username)), password_(std::move(password)),
+      database_(std::move(database)), max_server_connections_(max_server_connections),
+      server_version_(std::move(server_version)),
+      stats_{ALL_MYSQL_POOL_STATS(POOL_COUNTER_PREFIX(scope, stats_prefix),
+                                  POOL_GAUGE_PREFIX(scope, stats_prefix))} {}
+
+ServerConnectionImpl::ServerConnectionImpl(InstanceImpl& parent,
+                                           Network::ClientConnectionPtr&& connection)
+    : parent_(parent), connection_(std::move(connection)) {
+  connection_->addConnectionCallbacks(*this);
+  connection_->addReadFilter(std::make_shared<UpstreamReadFilter>(*this));
+  connection_->noDelay(true);
+  connection_->connect();
+}
+
+ServerConnectionImpl::~ServerConnectionImpl() {
+  if (state_ != State::Closed) {
+    // The pool is going away and does not need to be told.
+    state_ = State::Closed;
+    connection_->close(Network::ConnectionCloseType::NoFlush);
+  }
+}
+
+void ServerConnectionImpl::close() {
+  if (state_ != State::Closed) {
+    connection_->close(Network::ConnectionCloseType::NoFlush);
+  }
+}
+
+void ServerConnectionImpl::write(Buffer::Instance& data, Command::Cmd cmd) {
+  ASSERT(state_ == State::Ready);
+  ASSERT(!response_.has_value());
+  if (CommandResponseTracker::expectsResponse(cmd)) {
+    response_.emplace(cmd);
+  }
+  continuation_ = false;
+  connection_->write(data, false);
+}
+
+void ServerConnectionImpl::onEvent(Network::ConnectionEvent event) {
+  if (event == Network::ConnectionEvent::Connected) {
+    ENVOY_CONN_LOG(debug, "mysql_proxy: server connection established, logging in", *connection_);
+    state_ = State::LoggingIn;
+    return;
+  }
+
+  if ((event != Network::ConnectionEvent::RemoteClose &&
+       event != Network::ConnectionEvent::LocalClose) ||
+      state_ == State::Closed) {
+    return;
+  }
+
+  if (state_ == State::Connecting) {
+    parent_.settings_->stats_.server_connect_failures_.inc();
+  }
+  const bool was_ready = state_ == State::Ready;
+  state_ = State::Closed;
+  parent_.onServerClose(*this, was_ready);
+}
+
+void ServerConnectionImpl::onData(Buffer::Instance& data) {
+  buffer_.move(data);
+
+  // The packets of a response are forwarded to the client in one batch.
+  Buffer::OwnedImpl packets;
+  while (state_ != State::Closed && buffer_.length() >= MYSQL_HDR_SIZE) {
+    const uint32_t header = buffer_.peekLEInt<uint32_t>(0);
+    const uint32_t length = header & MYSQL_HDR_PKT_SIZE_MASK;
+    const uint8_t seq = header >> 24;
+    if (buffer_.length() < MYSQL_HDR_SIZE + length) {
+      break;
+    }
+
+    if (state_ == State::LoggingIn) {
+      Buffer::OwnedImpl packet;
+      packet.move(buffer_, MYSQL_HDR_SIZE + length);
+      packet.drain(MYSQL_HDR_SIZE);
+      if (!onLoginPacket(seq, packet, length)) {
+        return;
+      }
+      continue;
+    }
+
+    if (!response_.has_value() || callbacks_ == nullptr) {
+      // Like the error a server sends before it closes a connection that was idle for too long.
+      ENVOY_CONN_LOG(trace, "mysql_proxy: dropping packet received without a command in flight",
+                     *connection_);
+      buffer_.drain(MYSQL_HDR_SIZE + length);
+      continue;
+    }
+
+    const bool continuation = continuation_;
+    continuation_ = length == MYSQL_HDR_PKT_SIZE_MASK;
+    const bool complete = !continuation && response_->onPacket(buffer_, length);
+    packets.move(buffer_, MYSQL_HDR_SIZE + length);
+    if (complete) {
+      const CommandResponseTracker response = response_.value();
+      response_.reset();
+      callbacks_->onServerData(packets);
+      // This may release the connection, attaching it to another client or returning it to the
+      // pool.
+      callbacks_->onServerResponse(response);
+    }
+  }
+
+  if (packets.length() > 0 && callbacks_ != nullptr) {
+    callbacks_->onServerData(packets);
+  }
+}
+
+bool ServerConnectionImpl::onLoginPacket(uint8_t seq, Buffer::Instance& packet, uint32_t length) {
+  if (!greeting_received_) {
+    return onGreeting(seq, packet, length);
+  }
+  if (length == 0) {
+    onLoginFailure();
+    return false;
+  }
+
+  switch (packet.peekLEInt<uint8_t>(0)) {
+  case MYSQL_RESP_OK:
+    ENVOY_CONN_LOG(debug, "mysql_proxy: server connection logged in", *connection_);
+    state_ = State::Ready;
+    parent_.onServerReady(*this);
+    return true;
+  case MYSQL_RESP_ERR: {
+    ErrMessage error;
+    error.decode(packet, seq, length);
+    ENVOY_CONN_LOG(info, "mysql_proxy: server rejected login: {} {}", *connection_,
+                   error.getErrorCode(), error.getErrorMessage());
+    onLoginFailure();
+    return false;
+  }
+  case MYSQL_RESP_AUTH_SWITCH: {
+    AuthSwitchMessage auth_switch;
+    if (auth_switch.decode(packet, seq, length) != DecodeStatus::Success ||
+        auth_switch.isOldAuthSwitch()) {
+      break;
+    }
+    auth_plugin_ = auth_switch.getAuthPluginName();
+    scramble_ = scrambleFrom(auth_switch.getAuthPluginData());
+    const absl::optional<std::string> response = authResponse();
+    if (!response.has_value()) {
+      break;
+    }
+    Buffer::OwnedImpl payload(response.value());
+    sendPacket(seq + 1, payload);
+    return true;
+  }
+  case MYSQL_RESP_MORE:
+    if (onAuthMoreData(seq, packet)) {
+      return true;
+    }
+    break;
+  default:
+    break;
+  }
+
+  ENVOY_CONN_LOG(info, "mysql_proxy: unsupported or failed server authentication (plugin '{}')",
+                 *connection_, auth_plugin_);
+  onLoginFailure();
+  return false;
+}
+
+bool ServerConnectionImpl::onGreeting(uint8_t seq, Buffer::Instance& packet, uint32_t length) {
+  greeting_received_ = true;
+  ServerGreeting greeting;
+  if (greeting.decode(packet, seq, length) != DecodeStatus::Success ||
+      greeting.getProtocol() != MYSQL_PROTOCOL_10 ||
+      !(greeting.getServerCap() & CLIENT_PROTOCOL_41)) {
+    // Also the error a server sends instead of the greeting, like when it has too many
+    // connections.
+    ENVOY_CONN_LOG(info, "mysql_proxy: unsupported server greeting", *connection_);
+    onLoginFailure();
+    return false;
+  }
+
+  scramble_ = scrambleFrom(greeting.getAuthPluginData());
+  auth_plugin_ = greeting.getAuthPluginName().empty() ? std::string(Auth::NativePassword)
+                                                      : greeting.getAuthPluginName();
+  // An unsupported plugin is answered with an empty response, which the server may follow with a
+  // switch to a supported one.
+  const std::string response = authResponse().value_or("");
+
+  const PoolSettings& settings = *parent_.settings_;
+  uint32_t capabilities = (PoolCapabilities & greeting.getServerCap()) | CLIENT_PROTOCOL_41;
+  if (settings.database_.empty()) {
+    capabilities &= ~CLIENT_CONNECT_WITH_DB;
+  }
+  ClientLogin login;
+  login.setClientCap(capabilities);
+  login.setMaxPacket(DEFAULT_MAX_PACKET_SIZE);
+  login.setCharset(DEFAULT_MYSQL_CHARSET);
+  login.setUsername(settings.username_);
+  login.setAuthResp(std::vector<uint8_t>(response.begin(), response.end()));
+  login.setDb(settings.database_);
+  login.setAuthPluginName(auth_plugin_);
+  Buffer::OwnedImpl payload;
+  login.encode(payload);
+  sendPacket(seq + 1, payload);
+  return true;
+}
+
+bool ServerConnectionImpl::onAuthMoreData(uint8_t seq, Buffer::Instance& packet) {
+  if (auth_plugin_ != Auth::CachingSha2Password) {
+    return false;
+  }
+  packet.drain(1);
+  const std::string data = packet.toString();
+  if (data.size() == 1 && data[0] == CachingSha2FastAuthSuccess) {
+    // The server has the password cached. An OK packet follows.
+    return true;
+  }
+
+  Buffer::OwnedImpl payload;
+  if (data.size() == 1 && data[0] == CachingSha2PerformFullAuth) {
+    // Without TLS the password is sent encrypted with the public key of the server, which is
+    // requested first.
+    BufferHelper::addUint8(payload, CachingSha2RequestPublicKey);
+    sendPacket(seq + 1, payload);
+    return true;
+  }
+
+  // The public key of the server.
+  const absl::optional<std::string> encrypted =
+      Auth::rsaEncryptPassword(parent_.settings_->password_, scramble_, data);
+  if (!encrypted.has_value()) {
+    return false;
+  }
+  payload.add(encrypted.value());
+  sendPacket(seq + 1, payload);
+  return true;
+}
+
+absl::optional<std::string> ServerConnectionImpl::authResponse() const {
+  const std::string& password = parent_.settings_->password_;
+  if (auth_plugin_ == Auth::NativePassword) {
+    return Auth::nativePassword(password, scramble_);
+  }
+  if (auth_plugin_ == Auth::CachingSha2Password) {
+    return Auth::cachingSha2Password(password, scramble_);
+  }
+  return absl::nullopt;
+}
+
+void ServerConnectionImpl::sendPacket(uint8_t seq, Buffer::Instance& payload) {
+  BufferHelper::encodeHdr(payload, seq);
+  connection_->write(payload, false);
+}
+
+void ServerConnectionImpl::onLoginFailure() {
+  parent_.settings_->stats_.server_login_failures_.inc();
+  close();
+}
+
+InstanceImpl::InstanceImpl(PoolSettingsSharedPtr settings,
+                           Upstream::ClusterManager& cluster_manager,
+                           Event::Dispatcher& dispatcher, Random::RandomGenerator& random)
+    : settings_(std::move(settings)), cluster_manager_(cluster_manager), dispatcher_(dispatcher),
+      random_(random) {}
+
+InstanceImpl::~InstanceImpl() {
+  PoolStats& stats = settings_->stats_;
+  stats.server_connections_active_.sub(serverConnections());
+  stats.server_connections_idle_.sub(idle_.size());
+  stats.leases_pending_.sub(pending_.size());
+}
+
+void InstanceImpl::acquire(PoolCallbacks& callbacks) {
+  PoolStats& stats = settings_->stats_;
+  stats.leases_.inc();
+  pending_.push_back(&callbacks);
+  stats.leases_pending_.inc();
+
+  if (!idle_.empty()) {
+    stats.server_connections_idle_.dec();
+    lease(*idle_.front(), idle_);
+    return;
+  }
+
+  stats.lease_waits_.inc();
+  maybeConnect();
+}
+
+void InstanceImpl::cancel(PoolCallbacks& callbacks) {
+  const auto it = std::find(pending_.begin(), pending_.end(), &callbacks);
+  if (it != pending_.end()) {
+    pending_.erase(it);
+    settings_->stats_.leases_pending_.dec();
+  }
+}
+
+void InstanceImpl::release(ServerConnection& connection, bool reusable) {
+  auto& server = static_cast<ServerConnectionImpl&>(connection);
+  ASSERT(server.leased_);
+  server.callbacks_ = nullptr;
+
+  if (!reusable || !server.ready() || server.busy()) {
+    // Closing the connection removes it from the pool.
+    server.close();
+    return;
+  }
+
+  if (!pending_.empty()) {
+    PoolCallbacks* callbacks = pending_.front();
+    pending_.pop_front();
+    settings_->stats_.leases_pending_.dec();
+    callbacks->onPoolReady(server);
+    return;
+  }
+
+  server.leased_ = false;
+  server.moveBetweenLists(busy_, idle_);
+  settings_->stats_.server_connections_idle_.inc();
+}
+
+std::string InstanceImpl::scramble() {
+  // Printable ASCII characters, so that the scramble never contains a null terminator.
+  std::string scramble(Auth::ScrambleLength, '\0');
+  for (char& c : scramble) {
+    c = static_cast<char>('!' + random_.random() % ('~' - '!' + 1));
+  }
+  return scramble;
+}
+
+void InstanceImpl::onServerReady(ServerConnectionImpl& connection) {
+  if (!pending_.empty()) {
+    lease(connection, connecting_);
+    return;
+  }
+  connection.moveBetweenLists(connecting_, idle_);
+  settings_->stats_.server_connections_idle_.inc();
+}
+
+void InstanceImpl::onServerClose(ServerConnectionImpl& connection, bool was_ready) {
+  PoolStats& stats = settings_->stats_;
+  std::list<ServerConnectionImplPtr>& list =
+      !was_ready ? connecting_ : (connection.leased_ ? busy_ : idle_);
+  if (was_ready && !connection.leased_) {
+    stats.server_connections_idle_.dec();
+  }
+  stats.server_connections_active_.dec();
+  dispatcher_.deferredDelete(connection.removeFromList(list));
+
+  if (connection.leased_ && connection.callbacks_ != nullptr) {
+    ServerConnectionCallbacks* callbacks = connection.callbacks_;
+    connection.callbacks_ = nullptr;
+    callbacks->onServerClose();
+  }
+
+  if (was_ready) {
+    // A slot was freed for the clients that are waiting.
+    maybeConnect();
+  } else {
+    failPendingIfUnserved();
+  }
+}
+
+void InstanceImpl::lease(ServerConnectionImpl& connection,
+                         std::list<ServerConnectionImplPtr>& from) {
+  ASSERT(!pending_.empty());
+  connection.leased_ = true;
+  connection.moveBetweenLists(from, busy_);
+  PoolCallbacks* callbacks = pending_.front();
+  pending_.pop_front();
+  settings_->stats_.leases_pending_.dec();
+  callbacks->onPoolReady(connection);
+}
+
+void InstanceImpl::maybeConnect() {
+  PoolStats& stats = settings_->stats_;
+  while (pending_.size() > connecting_.size() &&
+         serverConnections() < settings_->max_server_connections_) {
+    Upstream::ThreadLocalCluster* cluster =
+        cluster_manager_.getThreadLocalCluster(settings_->cluster_);
+    if (cluster == nullptr) {
+      ENVOY_LOG(debug, "mysql_proxy: unknown cluster '{}'", settings_->cluster_);
+      failPendingIfUnserved();
+      return;
+    }
+    Upstream::Host::CreateConnectionData data = cluster->tcpConn(nullptr);
+    if (data.connection_ == nullptr) {
+      ENVOY_LOG(debug, "mysql_proxy: no healthy host in cluster '{}'", settings_->cluster_);
+      stats.server_connect_failures_.inc();
+      failPendingIfUnserved();
+      return;
+    }
+    stats.server_connections_.inc();
+    stats.server_connections_active_.inc();
+    LinkedList::moveIntoListBack(
+        std::make_unique<ServerConnectionImpl>(*this, std::move(data.connection_)), connecting_);
+  }
+}
+
+void InstanceImpl::failPendingIfUnserved() {
+  // Waiting clients are served by connections that are logging in or returned by other clients.
+  // Without any, they would wait forever.
+  if (serverConnections() > 0) {
+    return;
+  }
+  while (!pending_.empty()) {
+    PoolCallbacks* callbacks = pending_.front();
+    pending_.pop_front();
+    settings_->stats_.leases_pending_.dec();
+    settings_->stats_.lease_failures_.inc();
+    callbacks->onPoolFailure();
+  }
+}
+
+} // namespace ConnPool
+} // namespace MySQLProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "envoy/common/random_generator.h"
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/network/connection.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local_object.h"
+#include "envoy/upstream/cluster_manager.h"
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/common/linked_object.h"
+#include "source/common/common/logger.h"
+#include "source/common/network/filter_impl.h"
+
+#include "absl/types/optional.h"
+#include "contrib/mysql_proxy/filters/network/source/mysql_codec.h"
+#include "contrib/mysql_proxy/filters/network/source/mysql_codec_command.h"
+#include "contrib/mysql_proxy/filters/network/source/mysql_codec_greeting.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace MySQLProxy {
+namespace ConnPool {
+
+/**
+ * The capabilities the proxy offers to clients and asks server connections for in connection
+ * pooling mode. CLIENT_DEPRECATE_EOF is left out so that result sets end with an EOF packet, and
+ * CLIENT_SESSION_TRACK so that session state changes are classified from the commands instead.
+ */
+constexpr uint32_t PoolCapabilities =
+    CLIENT_LONG_PASSWORD | CLIENT_LONG_FLAG | CLIENT_CONNECT_WITH_DB | CLIENT_PROTOCOL_41 |
+    CLIENT_TRANSACTIONS | CLIENT_SECURE_CONNECTION | CLIENT_MULTI_STATEMENTS |
+    CLIENT_MULTI_RESULTS | CLIENT_PS_MULTI_RESULTS | CLIENT_PLUGIN_AUTH;
+
+/**
+ * All MySQL connection pool stats. @see stats_macros.h
+ */
+#define ALL_MYSQL_POOL_STATS(COUNTER, GAUGE)                                                       \
+  COUNTER(server_connections)                                                                      \
+  COUNTER(server_connect_failures)                                                                 \
+  COUNTER(server_login_failures)                                                                   \
+  COUNTER(leases)                                                                                  \
+  COUNTER(lease_waits)                                                                             \
+  COUNTER(lease_failures)                                                                          \
+  COUNTER(sessions_pinned)                                                                         \
+  GAUGE(server_connections_active, Accumulate)                                                     \
+  GAUGE(server_connections_idle, Accumulate)                                                       \
+  GAUGE(leases_pending, Accumulate)
+
+/**
+ * Struct definition for all MySQL connection pool stats. @see stats_macros.h
+ */
+struct PoolStats {
+  ALL_MYSQL_POOL_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * Connection pool settings, shared by the pools of all workers.
+ */
+struct PoolSettings {
+  PoolSettings(std::string cluster, std::string username, std::string password,
+               std::string database, uint32_t max_server_connections, std::string server_version,
+               Stats::Scope& scope, const std::string& stats_prefix);
+
+  const std::string cluster_;
+  const std::string username_;
+  const std::string password_;
+  const std::string database_;
+  const uint32_t max_server_connections_;
+  const std::string server_version_;
+  PoolStats stats_;
+};
+
+using PoolSettingsSharedPtr = std::shared_ptr<PoolSettings>;
+
+/**
+ * Callbacks of the client that leased a server connection.
+ */
+class ServerConnectionCallbacks {
+public:
+  virtual ~ServerConnectionCallbacks() = default;
+
+  /**
+   * Called with complete server packets to be forwarded to the client.
+   */
+  virtual void onServerData(Buffer::Instance& data) PURE;
+
+  /**
+   * Called after the last packet of the response to a command was passed to onServerData(). The
+   * callbacks may release the connection.
+   * @param response supplies the outcome of the command.
+   */
+  virtual void onServerResponse(const CommandResponseTracker& response) PURE;
+
+  /**
+   * Called if the server connection is lost while leased. The connection must not be used or
+   * released afterwards.
+   */
+  virtual void onServerClose() PURE;
+};
+
+/**
+ * A logged in connection to a MySQL server.
+ */
+class ServerConnection {
+public:
+  virtual ~ServerConnection() = default;
+
+  /**
+   * Sets the callbacks of the client that leased the connection.
+   */
+  virtual void attach(ServerConnectionCallbacks& callbacks) PURE;
+
+  /**
+   * Sends the packets of a client command to the server. The response is tracked until
+   * ServerConnectionCallbacks::onServerResponse(), unless the command has none.
+   * @param data supplies the packets of the command, with their headers.
+   * @param cmd supplies the command.
+   */
+  virtual void write(Buffer::Instance& data, Command::Cmd cmd) PURE;
+};
+
+/**
+ * Callbacks for a lease request.
+ */
+class PoolCallbacks {
+public:
+  virtual ~PoolCallbacks() = default;
+
+  /**
+   * Called when a server connection has been leased to the client.
+   */
+  virtual void onPoolReady(ServerConnection& connection) PURE;
+
+  /**
+   * Called when no server connection could be leased.
+   */
+  virtual void onPoolFailure() PURE;
+};
+
+/**
+ * A per worker pool of server connections that clients lease for the duration of a command, or
+ * for longer while they have session state on the connection.
+ */
+class Instance {
+public:
+  virtual ~Instance() = default;
+
+  /**
+   * Leases a server connection. The callbacks may be invoked before the call returns.
+   */
+  virtual void acquire(PoolCallbacks& callbacks) PURE;
+
+  /**
+   * Cancels a lease request that has not completed yet.
+   */
+  virtual void cancel(PoolCallbacks& callbacks) PURE;
+
+  /**
+   * Returns a leased connection.
+   * @param reusable supplies whether the connection may be leased again. A connection returned
+   *        with session state or a command in flight must be closed.
+   */
+  virtual void release(ServerConnection& connection, bool reusable) PURE;
+
+  /**
+   * @return a random printable scramble for the initial handshake of a client.
+   */
+  virtual std::string scramble() PURE;
+
+  /**
+   * @return the settings of the pool.
+   */
+  virtual const PoolSettings& settings() const PURE;
+};
+
+class InstanceImpl;
+
+/**
+ * A server connection owned by InstanceImpl. It logs in with the configured credentials before it
+ * is leased for the first time.
+ */
+class ServerConnectionImpl : public ServerConnection,
+                             public Network::ConnectionCallbacks,
+                             public Event::DeferredDeletable,
+                             public LinkedObject<ServerConnectionImpl>,
+                             Logger::Loggable<Logger::Id::filter> {
+public:
+  ServerConnectionImpl(InstanceImpl& parent, Network::ClientConnectionPtr&& connection);
+  ~ServerConnectionImpl() override;
+
+  void close();
+  bool ready() const { return state_ == State::Ready; }
+  // Whether a command was sent to the server and its response has not been read completely.
+  bool busy() const { return response_.has_value(); }
+
+  // ServerConnection
+  void attach(ServerConnectionCallbacks& callbacks) override { callbacks_ = &callbacks; }
+  void write(Buffer::Instance& data, Command::Cmd cmd) override;
+
+  // Network::ConnectionCallbacks
+  void onEvent(Network::ConnectionEvent event) override;
+  void onAboveWriteBufferHighWatermark() override {}
+  void onBelowWriteBufferLowWatermark() override {}
+
+private:
+  friend class InstanceImpl;
+
+  struct UpstreamReadFilter : public Network::ReadFilterBaseImpl {
+    UpstreamReadFilter(ServerConnectionImpl& parent) : parent_(parent) {}
+
+    // Network::ReadFilter
+    Network::FilterStatus onData(Buffer::Instance& data, bool) override {
+      parent_.onData(data);
+      return Network::FilterStatus::StopIteration;
+    }
+
+    ServerConnectionImpl& parent_;
+  };
+
+  enum class State { Connecting, LoggingIn, Ready, Closed };
+
+  void onData(Buffer::Instance& data);
+  bool onLoginPacket(uint8_t seq, Buffer::Instance& packet, uint32_t length);
+  bool onGreeting(uint8_t seq, Buffer::Instance& packet, uint32_t length);
+  bool onAuthMoreData(uint8_t seq, Buffer::Instance& packet);
+  absl::optional<std::string> authResponse() const;
+  void sendPacket(uint8_t seq, Buffer::Instance& payload);
+  void onLoginFailure();
+
+  InstanceImpl& parent_;
+  Network::ClientConnectionPtr connection_;
+  Buffer::OwnedImpl buffer_;
+  ServerConnectionCallbacks* callbacks_{};
+  State state_{State::Connecting};
+  // Set while the connection is in the busy list of the pool.
+  bool leased_{};
+  bool greeting_received_{};
+  std::string auth_plugin_;
+  std::string scramble_;
+  // The response to the command in flight.
+  absl::optional<CommandResponseTracker> response_;
+  // Whether the next packet continues a payload of 16MB or more.
+  bool continuation_{};
+};
+
+using ServerConnectionImplPtr = std::unique_ptr<ServerConnectionImpl>;
+
+class InstanceImpl : public Instance,
+                     public ThreadLocal::ThreadLocalObject,
+                     Logger::Loggable<Logger::Id::filter> {
+public:
+  InstanceImpl(PoolSettingsSharedPtr settings, Upstream::ClusterManager& cluster_manager,
+               Event::Dispatcher& dispatcher, Random::RandomGenerator& random);
+  ~InstanceImpl() override;
+
+  // ConnPool::Instance
+  void acquire(PoolCallbacks& callbacks) override;
+  void cancel(PoolCallbacks& callbacks) override;
+  void release(ServerConnection& connection, bool reusable) override;
+  std::string scramble() override;
+  const PoolSettings& settings() const override { return *settings_; }
+
+  uint64_t serverConnections() const { return connecting_.size() + idle_.size() + busy_.size(); }
+
+private:
+  friend class ServerConnectionImpl;
+
+  void onServerReady(ServerConnectionImpl& connection);
+  void onServerClose(ServerConnectionImpl& connection, bool was_ready);
+  void lease(ServerConnectionImpl& connection, std::list<ServerConnectionImplPtr>& from);
+  void maybeConnect();
+  void failPendingIfUnserved();
+
+  const PoolSettingsSharedPtr settings_;
+  Upstream::ClusterManager& cluster_manager_;
+  Event::Dispatcher& dispatcher_;
+  Random::RandomGenerator& random_;
+  // Connections that are logging in, idle in the pool and leased to a client.
+  std::list<ServerConnectionImplPtr> connecting_;
+  std::list<ServerConnectionImplPtr> idle_;
+  std::list<ServerConnectionImplPtr> busy_;
+  std::list<PoolCallbacks*> pending_;
+};
+
+} // namespace ConnPool
+} // namespace MySQLProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -7,9 +7,11 @@
 #include "source/common/common/logger.h"
 #include "source/extensions/filters/network/well_known_names.h"
 
+#include "contrib/mysql_proxy/filters/network/source/mysql_auth.h"
 #include "contrib/mysql_proxy/filters/network/source/mysql_codec.h"
 #include "contrib/mysql_proxy/filters/network/source/mysql_codec_clogin_resp.h"
 #include "contrib/mysql_proxy/filters/network/source/mysql_decoder_impl.h"
+#include "contrib/mysql_proxy/filters/network/source/mysql_utils.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -19,13 +21,29 @@ namespace MySQLProxy {
 MySQLFilterConfig::MySQLFilterConfig(const std::string& stat_prefix, Stats::Scope& scope)
     : scope_(scope), stats_(generateStats(stat_prefix, scope)) {}
 
-MySQLFilter::MySQLFilter(MySQLFilterConfigSharedPtr config) : config_(std::move(config)) {}
+MySQLFilter::MySQLFilter(MySQLFilterConfigSharedPtr config, ConnPool::Instance* pool)
+    : config_(std::move(config)), pool_(pool) {
+  if (pool_ != nullptr) {
+    // Only used for the session state and the attributes of parsed queries.
+    decoder_ = createDecoder(*this);
+  }
+}
 
 void MySQLFilter::initializeReadFilterCallbacks(Network::ReadFilterCallbacks& callbacks) {
   read_callbacks_ = &callbacks;
+  if (pool_ != nullptr) {
+    read_callbacks_->connection().addConnectionCallbacks(*this);
+  }
 }
 
 Network::FilterStatus MySQLFilter::onData(Buffer::Instance& data, bool) {
+  if (pool_ != nullptr) {
+    // In connection pooling mode the filter is terminal and consumes all data.
+    client_buffer_.move(data);
+    onClientData();
+    return Network::FilterStatus::StopIteration;
+  }
+
   // Safety measure just to make sure that if we have a decoding error we keep going and lose stats.
   // This can be removed once we are more confident of this code.
   if (sniffing_) {
@@ -38,20 +56,23 @@ Network::FilterStatus MySQLFilter::onData(Buffer::Instance& data, bool) {
 Network::FilterStatus MySQLFilter::onWrite(Buffer::Instance& data, bool) {
   // Safety measure just to make sure that if we have a decoding error we keep going and lose stats.
   // This can be removed once we are more confident of this code.
-  if (sniffing_) {
+  if (sniffing_ && pool_ == nullptr) {
     write_buffer_.add(data);
     doDecode(write_buffer_);
   }
   return Network::FilterStatus::Continue;
 }
 
-void MySQLFilter::doDecode(Buffer::Instance& buffer) {
-  // Clear dynamic metadata.
+void MySQLFilter::clearDynamicMetadata() {
   envoy::config::core::v3::Metadata& dynamic_metadata =
       read_callbacks_->connection().streamInfo().dynamicMetadata();
   auto& metadata =
       (*dynamic_metadata.mutable_filter_metadata())[NetworkFilterNames::get().MySQLProxy];
   metadata.mutable_fields()->clear();
+}
+
+void MySQLFilter::doDecode(Buffer::Instance& buffer) {
+  clearDynamicMetadata();
 
   if (!decoder_) {
     decoder_ = createDecoder(*this);
@@ -130,9 +151,362 @@ void MySQLFilter::onCommand(Command& command) {
 
 Network::FilterStatus MySQLFilter::onNewConnection() {
   config_->stats_.sessions_.inc();
+  if (pool_ == nullptr) {
+    return Network::FilterStatus::Continue;
+  }
+
+  // The client logs in at the proxy, with the credentials server connections are opened with.
+  scramble_ = pool_->scramble();
+  ServerGreeting greeting;
+  greeting.setProtocol(MYSQL_PROTOCOL_10);
+  greeting.setVersion(pool_->settings().server_version_);
+  greeting.setThreadId(static_cast<uint32_t>(read_callbacks_->connection().id()));
+  greeting.setServerCap(ConnPool::PoolCapabilities);
+  greeting.setServerCharset(DEFAULT_MYSQL_CHARSET);
+  greeting.setServerStatus(server_status_);
+  greeting.setAuthPluginName(std::string(Auth::NativePassword));
+  greeting.setAuthPluginData(std::vector<uint8_t>(scramble_.begin(), scramble_.end()));
+  Buffer::OwnedImpl payload;
+  greeting.encode(payload);
+  sendClientPacket(GREETING_SEQ_NUM, payload);
   return Network::FilterStatus::Continue;
 }
 
+uint64_t MySQLFilter::clientMessageLength() const {
+  // A payload of 16MB or more continues in the following packets, up to one shorter than that.
+  uint64_t length = 0;
+  while (client_buffer_.length() >= length + MYSQL_HDR_SIZE) {
+    const uint32_t packet_length =
+        client_buffer_.peekLEInt<uint32_t>(length) & MYSQL_HDR_PKT_SIZE_MASK;
+    length += MYSQL_HDR_SIZE + packet_length;
+    if (client_buffer_.length() < length) {
+      return 0;
+    }
+    if (packet_length < MYSQL_HDR_PKT_SIZE_MASK) {
+      return length;
+    }
+  }
+  return 0;
+}
+
+void MySQLFilter::onClientData() {
+  // Leasing a server connection or sending a command may complete synchronously and come back
+  // here. The outer loop picks up the next message.
+  if (processing_client_data_) {
+    return;
+  }
+  processing_client_data_ = true;
+  while (pooling_state_ != PoolingState::Closed && !command_in_progress_) {
+    const uint64_t length = clientMessageLength();
+    if (length == 0) {
+      break;
+    }
+    Buffer::OwnedImpl message;
+    message.move(client_buffer_, length);
+    switch (pooling_state_) {
+    case PoolingState::Handshake:
+      onClientLogin(message);
+      break;
+    case PoolingState::AuthSwitch:
+      onClientAuthSwitchResponse(message);
+      break;
+    case PoolingState::Ready:
+      onClientCommand(message);
+      break;
+    case PoolingState::Closed:
+      break;
+    }
+  }
+  processing_client_data_ = false;
+}
+
+void MySQLFilter::onClientLogin(Buffer::Instance& message) {
+  const uint32_t header = message.peekLEInt<uint32_t>(0);
+  const uint8_t seq = header >> 24;
+  message.drain(MYSQL_HDR_SIZE);
+  config_->stats_.login_attempts_.inc();
+
+  ClientLogin login;
+  if (login.decode(message, seq, header & MYSQL_HDR_PKT_SIZE_MASK) != DecodeStatus::Success ||
+      login.isSSLRequest() || !login.isResponse41()) {
+    // SSL is not offered, and clients older than 4.1 are not supported.
+    config_->stats_.login_failures_.inc();
+    closeClient(seq + 1, ER_HANDSHAKE_ERROR, "08S01", "Bad handshake");
+    return;
+  }
+
+  const ConnPool::PoolSettings& settings = pool_->settings();
+  if (login.getUsername() != settings.username_) {
+    config_->stats_.login_failures_.inc();
+    closeClient(seq + 1, ER_ACCESS_DENIED_ERROR, "28000",
+                fmt::format("Access denied for user '{}'", login.getUsername()));
+    return;
+  }
+  if (login.isConnectWithDb() && !login.getDb().empty() && login.getDb() != settings.database_) {
+    config_->stats_.login_failures_.inc();
+    closeClient(seq + 1, ER_DBACCESS_DENIED_ERROR, "42000",
+                fmt::format("Access denied for user '{}' to database '{}'", login.getUsername(),
+                            login.getDb()));
+    return;
+  }
+
+  if (login.getAuthPluginName().empty() || login.getAuthPluginName() == Auth::NativePassword) {
+    const std::vector<uint8_t>& response = login.getAuthResp();
+    verifyClientPassword(seq + 1, absl::string_view(reinterpret_cast<const char*>(response.data()),
+                                                    response.size()));
+    return;
+  }
+
+  // Other plugins like caching_sha2_password need TLS or RSA keys. The client is asked to switch.
+  config_->stats_.auth_switch_request_.inc();
+  AuthSwitchMessage auth_switch;
+  auth_switch.setAuthPluginName(std::string(Auth::NativePassword));
+  std::vector<uint8_t> data(scramble_.begin(), scramble_.end());
+  data.push_back(0);
+  auth_switch.setAuthPluginData(data);
+  Buffer::OwnedImpl payload;
+  auth_switch.encode(payload);
+  sendClientPacket(seq + 1, payload);
+  pooling_state_ = PoolingState::AuthSwitch;
+}
+
+void MySQLFilter::onClientAuthSwitchResponse(Buffer::Instance& message) {
+  const uint8_t seq = message.peekLEInt<uint32_t>(0) >> 24;
+  message.drain(MYSQL_HDR_SIZE);
+  verifyClientPassword(seq + 1, message.toString());
+}
+
+void MySQLFilter::verifyClientPassword(uint8_t seq, absl::string_view response) {
+  const ConnPool::PoolSettings& settings = pool_->settings();
+  if (!Auth::verifyNativePassword(settings.password_, scramble_, response)) {
+    config_->stats_.login_failures_.inc();
+    closeClient(seq, ER_ACCESS_DENIED_ERROR, "28000",
+                fmt::format("Access denied for user '{}'", settings.username_));
+    return;
+  }
+
+  OkMessage ok;
+  ok.setServerStatus(server_status_);
+  Buffer::OwnedImpl payload;
+  ok.encode(payload);
+  sendClientPacket(seq, payload);
+  pooling_state_ = PoolingState::Ready;
+}
+
+void MySQLFilter::onClientCommand(Buffer::Instance& message) {
+  const uint32_t header = message.peekLEInt<uint32_t>(0);
+  const uint32_t length = header & MYSQL_HDR_PKT_SIZE_MASK;
+  const uint8_t seq = header >> 24;
+  if (length == 0) {
+    config_->stats_.protocol_errors_.inc();
+    closeClient(seq + 1, ER_UNKNOWN_COM_ERROR, "08S01", "Unknown command");
+    return;
+  }
+
+  // Only the first packet is decoded. A query that continues in further packets is classified by
+  // its first 16MB.
+  std::string first_packet(length, '\0');
+  message.copyOut(MYSQL_HDR_SIZE, length, first_packet.data());
+  Buffer::OwnedImpl payload(first_packet);
+  Command command{};
+  command.decode(payload, seq, length);
+
+  switch (command.getCmd()) {
+  case Command::Cmd::Quit:
+    // COM_QUIT is not passed on, the server connection outlives the client.
+    pooling_state_ = PoolingState::Closed;
+    read_callbacks_->connection().close(Network::ConnectionCloseType::FlushWrite);
+    return;
+  case Command::Cmd::Ping: {
+    OkMessage ok;
+    ok.setServerStatus(server_status_);
+    Buffer::OwnedImpl reply;
+    ok.encode(reply);
+    sendClientPacket(seq + 1, reply);
+    return;
+  }
+  case Command::Cmd::Sleep:
+  case Command::Cmd::Connect:
+  case Command::Cmd::Time:
+  case Command::Cmd::DelayedInsert:
+  case Command::Cmd::Shutdown:
+  case Command::Cmd::ChangeUser:
+  case Command::Cmd::BinlogDump:
+  case Command::Cmd::TableDump:
+  case Command::Cmd::ConnectOut:
+  case Command::Cmd::RegisterSlave:
+  case Command::Cmd::Daemon:
+  case Command::Cmd::BinlogDumpGtid:
+    // Commands that change the user or take over the server connection.
+    sendClientError(seq + 1, ER_UNKNOWN_COM_ERROR, "08S01", "Unknown command");
+    return;
+  default:
+    break;
+  }
+
+  if (command.isQuery()) {
+    clearDynamicMetadata();
+    onCommand(command);
+  }
+  getSession().pin(command.getPinReasons());
+  if (command.getCmd() == Command::Cmd::StmtClose && command.getData().size() >= 4) {
+    Buffer::OwnedImpl statement(command.getData());
+    closed_statement_ = statement.peekLEInt<uint32_t>(0);
+  }
+
+  command_in_progress_ = true;
+  command_cmd_ = command.getCmd();
+  command_seq_ = seq;
+  command_.move(message);
+  if (server_ != nullptr) {
+    sendCommand();
+  } else if (!lease_requested_) {
+    lease_requested_ = true;
+    pool_->acquire(*this);
+  }
+}
+
+void MySQLFilter::sendCommand() {
+  ASSERT(server_ != nullptr && command_in_progress_);
+  server_->write(command_, command_cmd_);
+  if (CommandResponseTracker::expectsResponse(command_cmd_)) {
+    return;
+  }
+  if (command_cmd_ == Command::Cmd::StmtClose) {
+    getSession().removeStatement(closed_statement_);
+  }
+  onCommandComplete();
+}
+
+void MySQLFilter::onCommandComplete() {
+  command_in_progress_ = false;
+  onSessionStateChanged();
+  const MySQLSession& session = getSession();
+  if (server_ != nullptr && !session.pinned() && !session.inTransaction()) {
+    ENVOY_CONN_LOG(trace, "mysql_proxy: returning server connection",
+                   read_callbacks_->connection());
+    releaseServer(true);
+  }
+}
+
+void MySQLFilter::onSessionStateChanged() {
+  const bool pinned = getSession().pinned();
+  if (pinned && !pinned_) {
+    ENVOY_CONN_LOG(debug, "mysql_proxy: session pinned to its server connection",
+                   read_callbacks_->connection());
+    pool_->settings().stats_.sessions_pinned_.inc();
+  }
+  pinned_ = pinned;
+}
+
+void MySQLFilter::sendClientPacket(uint8_t seq, Buffer::Instance& payload) {
+  BufferHelper::encodeHdr(payload, seq);
+  read_callbacks_->connection().write(payload, false);
+}
+
+void MySQLFilter::sendClientError(uint8_t seq, uint16_t code, absl::string_view sql_state,
+                                  absl::string_view message) {
+  ErrMessage error;
+  error.setErrorCode(code);
+  error.setSqlStateMarker(MYSQL_SQL_STATE_MARKER);
+  error.setSqlState(std::string(sql_state));
+  error.setErrorMessage(std::string(message));
+  Buffer::OwnedImpl payload;
+  error.encode(payload);
+  sendClientPacket(seq, payload);
+}
+
+void MySQLFilter::closeClient(uint8_t seq, uint16_t code, absl::string_view sql_state,
+                              absl::string_view message) {
+  ENVOY_CONN_LOG(debug, "mysql_proxy: closing client connection: {}",
+                 read_callbacks_->connection(), message);
+  pooling_state_ = PoolingState::Closed;
+  sendClientError(seq, code, sql_state, message);
+  read_callbacks_->connection().close(Network::ConnectionCloseType::FlushWrite);
+}
+
+void MySQLFilter::releaseServer(bool reusable) {
+  ASSERT(server_ != nullptr);
+  ConnPool::ServerConnection* server = server_;
+  server_ = nullptr;
+  pool_->release(*server, reusable);
+}
+
+void MySQLFilter::onEvent(Network::ConnectionEvent event) {
+  if (event != Network::ConnectionEvent::RemoteClose &&
+      event != Network::ConnectionEvent::LocalClose) {
+    return;
+  }
+  pooling_state_ = PoolingState::Closed;
+  if (lease_requested_) {
+    lease_requested_ = false;
+    pool_->cancel(*this);
+  }
+  if (server_ != nullptr) {
+    // Session state cannot be handed to another client. Such connections are closed by the pool.
+    const MySQLSession& session = getSession();
+    releaseServer(!session.pinned() && !session.inTransaction() && !command_in_progress_);
+  }
+}
+
+void MySQLFilter::onPoolReady(ConnPool::ServerConnection& connection) {
+  lease_requested_ = false;
+  server_ = &connection;
+  server_->attach(*this);
+  ENVOY_CONN_LOG(trace, "mysql_proxy: leased server connection", read_callbacks_->connection());
+  sendCommand();
+  // Commands the client sent without waiting for a response.
+  onClientData();
+}
+
+void MySQLFilter::onPoolFailure() {
+  lease_requested_ = false;
+  closeClient(command_seq_ + 1, ER_UNKNOWN_ERROR, "HY000", "no server connection available");
+}
+
+void MySQLFilter::onServerData(Buffer::Instance& data) {
+  read_callbacks_->connection().write(data, false);
+}
+
+void MySQLFilter::onServerResponse(const CommandResponseTracker& response) {
+  MySQLSession& session = getSession();
+  if (!response.error()) {
+    switch (command_cmd_) {
+    case Command::Cmd::StmtPrepare:
+      session.addStatement(response.statementId());
+      break;
+    case Command::Cmd::ResetConnection:
+      session.resetPins();
+      break;
+    default:
+      break;
+    }
+  }
+  if (response.serverStatus().has_value()) {
+    server_status_ = response.serverStatus().value();
+    // An error may end a multi statement query after a result set that began a transaction.
+    if (server_status_ & SERVER_STATUS_IN_TRANS) {
+      session.setInTransaction(true);
+    } else if (!response.error()) {
+      session.setInTransaction(false);
+    }
+    if (!(server_status_ & SERVER_STATUS_AUTOCOMMIT)) {
+      // Every statement runs in a transaction until autocommit is turned back on.
+      session.pin(MySQLSession::Variables);
+    }
+  }
+  onCommandComplete();
+  onClientData();
+}
+
+void MySQLFilter::onServerClose() {
+  server_ = nullptr;
+  if (pooling_state_ != PoolingState::Closed) {
+    pooling_state_ = PoolingState::Closed;
+    read_callbacks_->connection().close(Network::ConnectionCloseType::FlushWrite);
+  }
+}
+
 } // namespace MySQLProxy
 } // namespace NetworkFilters
 } // namespace Extensions
@@ -6,6 +6,7 @@
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats.h"
 #include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
 
 #include "source/common/common/logger.h"
 
@@ -15,6 +16,7 @@
 #include "contrib/mysql_proxy/filters/network/source/mysql_codec_command.h"
 #include "contrib/mysql_proxy/filters/network/source/mysql_codec_greeting.h"
 #include "contrib/mysql_proxy/filters/network/source/mysql_codec_switch_resp.h"
+#include "contrib/mysql_proxy/filters/network/source/mysql_conn_pool.h"
 #include "contrib/mysql_proxy/filters/network/source/mysql_decoder.h"
 #include "contrib/mysql_proxy/filters/network/source/mysql_session.h"
 
@@ -55,6 +57,14 @@ public:
 
   Stats::Scope& scope_;
   MySQLProxyStats stats_;
+  // Per worker server connection pools. Only set in connection pooling mode.
+  ThreadLocal::TypedSlotPtr<ConnPool::InstanceImpl> pools_;
+
+  /**
+   * @return the server connection pool of the current worker, or nullptr if connection pooling
+   *         is not enabled.
+   */
+  ConnPool::Instance* pool() { return pools_ != nullptr ? &**pools_ : nullptr; }
 
 private:
   MySQLProxyStats generateStats(const std::string& prefix, Stats::Scope& scope) {
@@ -65,11 +75,20 @@ private:
 using MySQLFilterConfigSharedPtr = std::shared_ptr<MySQLFilterConfig>;
 
 /**
- * Implementation of MySQL proxy filter.
+ * Implementation of MySQL proxy filter. By default it only decodes the traffic that passes through
+ * it on its way to a terminal filter like tcp_proxy. If a server connection pool is given, the
+ * filter terminates the protocol instead: it authenticates the client itself and runs each command
+ * on a server connection leased from the pool, which is returned to the pool once the command
+ * completes unless the client has session state on it.
  */
-class MySQLFilter : public Network::Filter, DecoderCallbacks, Logger::Loggable<Logger::Id::filter> {
+class MySQLFilter : public Network::Filter,
+                    DecoderCallbacks,
+                    public Network::ConnectionCallbacks,
+                    public ConnPool::PoolCallbacks,
+                    public ConnPool::ServerConnectionCallbacks,
+                    Logger::Loggable<Logger::Id::filter> {
 public:
-  MySQLFilter(MySQLFilterConfigSharedPtr config);
+  MySQLFilter(MySQLFilterConfigSharedPtr config, ConnPool::Instance* pool = nullptr);
   ~MySQLFilter() override = default;
 
   // Network::ReadFilter
@@ -91,17 +110,71 @@ public:
   void onCommand(Command& message) override;
   void onCommandResponse(CommandResponse&) override{};
 
+  // Network::ConnectionCallbacks
+  void onEvent(Network::ConnectionEvent event) override;
+  void onAboveWriteBufferHighWatermark() override {}
+  void onBelowWriteBufferLowWatermark() override {}
+
+  // ConnPool::PoolCallbacks
+  void onPoolReady(ConnPool::ServerConnection& connection) override;
+  void onPoolFailure() override;
+
+  // ConnPool::ServerConnectionCallbacks
+  void onServerData(Buffer::Instance& data) override;
+  void onServerResponse(const CommandResponseTracker& response) override;
+  void onServerClose() override;
+
   void doDecode(Buffer::Instance& buffer);
   DecoderPtr createDecoder(DecoderCallbacks& callbacks);
   MySQLSession& getSession() { return decoder_->getSession(); }
 
 private:
+  // Progress of a client in connection pooling mode.
+  enum class PoolingState { Handshake, AuthSwitch, Ready, Closed };
+
+  void clearDynamicMetadata();
+  uint64_t clientMessageLength() const;
+  void onClientData();
+  void onClientLogin(Buffer::Instance& message);
+  void onClientAuthSwitchResponse(Buffer::Instance& message);
+  void onClientCommand(Buffer::Instance& message);
+  void verifyClientPassword(uint8_t seq, absl::string_view response);
+  void sendCommand();
+  void onCommandComplete();
+  void onSessionStateChanged();
+  void sendClientPacket(uint8_t seq, Buffer::Instance& payload);
+  void sendClientError(uint8_t seq, uint16_t code, absl::string_view sql_state,
+                       absl::string_view message);
+  void closeClient(uint8_t seq, uint16_t code, absl::string_view sql_state,
+                   absl::string_view message);
+  void releaseServer(bool reusable);
+
   Network::ReadFilterCallbacks* read_callbacks_{};
   MySQLFilterConfigSharedPtr config_;
   Buffer::OwnedImpl read_buffer_;
   Buffer::OwnedImpl write_buffer_;
   std::unique_ptr<Decoder> decoder_;
   bool sniffing_{true};
+
+  ConnPool::Instance* pool_{};
+  PoolingState pooling_state_{PoolingState::Handshake};
+  std::string scramble_;
+  // Client bytes that do not form a complete message yet.
+  Buffer::OwnedImpl client_buffer_;
+  bool processing_client_data_{};
+  // The packets of the command in progress until they are sent to the server. Further commands
+  // wait in client_buffer_ until the command completes.
+  Buffer::OwnedImpl command_;
+  bool command_in_progress_{};
+  Command::Cmd command_cmd_{Command::Cmd::Null};
+  uint8_t command_seq_{};
+  // The statement closed by a COM_STMT_CLOSE in progress.
+  uint32_t closed_statement_{};
+  ConnPool::ServerConnection* server_{};
+  bool lease_requested_{};
+  // The server status flags of the last OK or EOF packet, reported in local replies.
+  uint16_t server_status_{SERVER_STATUS_AUTOCOMMIT};
+  bool pinned_{};
 };
 
 } // namespace MySQLProxy
@@ -1,6 +1,10 @@
 #pragma once
+#include <cstdint>
+
 #include "source/common/common/logger.h"
 
+#include "absl/container/flat_hash_set.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace NetworkFilters {
@@ -25,14 +29,53 @@ public:
     Error = 13,
   };
 
+  // Session state that ties a client to the server connection it was created on, in connection
+  // pooling mode. A client with any of this state is pinned to its server connection.
+  enum PinReason : uint32_t {
+    // Session and user variables, the default database and the character set.
+    Variables = 0x1,
+    TemporaryTables = 0x2,
+    // Prepared statements created with the PREPARE statement. The ones created with
+    // COM_STMT_PREPARE are tracked by statement ID.
+    PreparedStatements = 0x4,
+    // Table locks, named locks and other state that outlives a statement.
+    Locks = 0x8,
+  };
+
   void setState(MySQLSession::State state) { state_ = state; }
   MySQLSession::State getState() { return state_; }
   uint8_t getExpectedSeq() { return expected_seq_; }
   void setExpectedSeq(uint8_t seq) { expected_seq_ = seq; }
 
+  void pin(uint32_t reasons) { pin_reasons_ |= reasons; }
+  uint32_t getPinReasons() const { return pin_reasons_; }
+  void addStatement(uint32_t statement_id) { statements_.insert(statement_id); }
+  void removeStatement(uint32_t statement_id) { statements_.erase(statement_id); }
+  void setInTransaction(bool in_transaction) { in_transaction_ = in_transaction; }
+  bool inTransaction() const { return in_transaction_; }
+
+  /**
+   * @return whether the session has state on its server connection that other clients must not
+   *         see or lose, not counting an open transaction.
+   */
+  bool pinned() const { return pin_reasons_ != 0 || !statements_.empty(); }
+
+  /**
+   * Forgets all session state, after the server connection was reset with COM_RESET_CONNECTION.
+   */
+  void resetPins() {
+    pin_reasons_ = 0;
+    statements_.clear();
+    in_transaction_ = false;
+  }
+
 private:
   MySQLSession::State state_{State::Init};
   uint8_t expected_seq_{0};
+  uint32_t pin_reasons_{0};
+  // Prepared statements created with COM_STMT_PREPARE and not closed yet.
+  absl::flat_hash_set<uint32_t> statements_;
+  bool in_transaction_{false};
 };
 
 } // namespace MySQLProxy
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include "source/common/common/hex.h"
+
+#include "contrib/mysql_proxy/filters/network/source/mysql_auth.h"
+#include "openssl/bio.h"
+#include "openssl/bn.h"
+#include "openssl/pem.h"
+#include "openssl/rsa.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace MySQLProxy {
+
+constexpr absl::string_view Scramble = "\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d"
+                                       "\x0e\x0f\x10\x11\x12\x13\x14";
+
+std::string hex(const std::string& data) {
+  return Hex::encode(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+}
+
+TEST(MySQLAuthTest, NativePassword) {
+  EXPECT_EQ("b32bb3a583e1340c0a1108d58b1be49781ad8c2f",
+            hex(Auth::nativePassword("secret", Scramble)));
+  EXPECT_EQ("", Auth::nativePassword("", Scramble));
+}
+
+TEST(MySQLAuthTest, CachingSha2Password) {
+  EXPECT_EQ("746ebe205d56a0707acb3e796e834e0dd7b1d61743b26bd5202c7a623230c7c9",
+            hex(Auth::cachingSha2Password("secret", Scramble)));
+  EXPECT_EQ("", Auth::cachingSha2Password("", Scramble));
+}
+
+TEST(MySQLAuthTest, VerifyNativePassword) {
+  const std::string response = Auth::nativePassword("secret", Scramble);
+  EXPECT_TRUE(Auth::verifyNativePassword("secret", Scramble, response));
+  EXPECT_FALSE(Auth::verifyNativePassword("other", Scramble, response));
+  EXPECT_FALSE(Auth::verifyNativePassword("secret", Scramble, response.substr(1)));
+  EXPECT_FALSE(Auth::verifyNativePassword("secret", Scramble, ""));
+  // An empty password is answered with an empty response.
+  EXPECT_TRUE(Auth::verifyNativePassword("", Scramble, ""));
+  EXPECT_FALSE(Auth::verifyNativePassword("", Scramble, response));
+}
+
+TEST(MySQLAuthTest, RsaEncryptPassword) {
+  bssl::UniquePtr<RSA> rsa(RSA_new());
+  bssl::UniquePtr<BIGNUM> exponent(BN_new());
+  ASSERT_TRUE(BN_set_word(exponent.get(), RSA_F4));
+  ASSERT_TRUE(RSA_generate_key_ex(rsa.get(), 2048, exponent.get(), nullptr));
+  bssl::UniquePtr<BIO> bio(BIO_new(BIO_s_mem()));
+  ASSERT_TRUE(PEM_write_bio_RSA_PUBKEY(bio.get(), rsa.get()));
+  const uint8_t* pem;
+  size_t pem_length;
+  ASSERT_TRUE(BIO_mem_contents(bio.get(), &pem, &pem_length));
+
+  const absl::optional<std::string> encrypted = Auth::rsaEncryptPassword(
+      "secret", Scramble, absl::string_view(reinterpret_cast<const char*>(pem), pem_length));
+  ASSERT_TRUE(encrypted.has_value());
+  std::string decrypted(RSA_size(rsa.get()), '\0');
+  const int size = RSA_private_decrypt(
+      encrypted->size(), reinterpret_cast<const uint8_t*>(encrypted->data()),
+      reinterpret_cast<uint8_t*>(decrypted.data()), rsa.get(), RSA_PKCS1_OAEP_PADDING);
+  ASSERT_EQ(7, size);
+  // The null terminated password, XORed with the scramble.
+  EXPECT_EQ(std::string("\x72\x67\x60\x76\x60\x72\x07", 7), decrypted.substr(0, size));
+
+  EXPECT_FALSE(Auth::rsaEncryptPassword("secret", Scramble, "not a key").has_value());
+}
+
+} // namespace MySQLProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -1,5 +1,6 @@
 #include "source/common/buffer/buffer_impl.h"
 
+#include "contrib/mysql_proxy/filters/network/source/mysql_codec_clogin_resp.h"
 #include "contrib/mysql_proxy/filters/network/source/mysql_codec_command.h"
 #include "contrib/mysql_proxy/filters/network/source/mysql_utils.h"
 #include "gtest/gtest.h"
@@ -98,6 +99,139 @@ TEST(MySQLCodecTest, MySQLCommandRespIncompleteData) {
   EXPECT_EQ(mysql_cmd_resp_decode.getData(), "");
 }
 
+uint32_t queryPinReasons(const std::string& query) {
+  Command command{};
+  command.setCmd(Command::Cmd::Query);
+  command.setData(query);
+  return command.getPinReasons();
+}
+
+TEST(MySQLCodecTest, CommandPinReasons) {
+  EXPECT_EQ(0, queryPinReasons("SELECT * FROM t WHERE a = 'SET @x'"));
+  EXPECT_EQ(0, queryPinReasons("BEGIN; INSERT INTO t VALUES (1); COMMIT"));
+  EXPECT_EQ(0, queryPinReasons("SELECT @@version /* SET */ -- LOCK"));
+  EXPECT_EQ(0, queryPinReasons("SELECT `@x`, \"it\\\"s @x\" # @y"));
+  EXPECT_EQ(MySQLSession::Variables, queryPinReasons("set names utf8mb4"));
+  EXPECT_EQ(MySQLSession::Variables, queryPinReasons("SELECT 1; USE db"));
+  EXPECT_EQ(MySQLSession::Variables, queryPinReasons("SELECT a INTO @a FROM t"));
+  EXPECT_EQ(MySQLSession::Variables, queryPinReasons("SELECT SQL_CALC_FOUND_ROWS * FROM t"));
+  EXPECT_EQ(MySQLSession::Variables, queryPinReasons("/*!40101 SET NAMES utf8 */"));
+  EXPECT_EQ(MySQLSession::TemporaryTables,
+            queryPinReasons("  CREATE TEMPORARY TABLE t (a INT)"));
+  EXPECT_EQ(0, queryPinReasons("CREATE TABLE t (a INT)"));
+  EXPECT_EQ(MySQLSession::PreparedStatements, queryPinReasons("PREPARE s FROM 'SELECT 1'"));
+  EXPECT_EQ(MySQLSession::Locks, queryPinReasons("LOCK TABLES t READ"));
+  EXPECT_EQ(MySQLSession::Locks, queryPinReasons("SELECT GET_LOCK('l', 10)"));
+  EXPECT_EQ(MySQLSession::Variables | MySQLSession::Locks,
+            queryPinReasons("SET @a = 1; LOCK TABLES t WRITE"));
+
+  Command command{};
+  command.setCmd(Command::Cmd::InitDb);
+  EXPECT_EQ(MySQLSession::Variables, command.getPinReasons());
+  command.setCmd(Command::Cmd::StmtExecute);
+  EXPECT_EQ(0, command.getPinReasons());
+}
+
+// Feeds the response packets to a tracker and returns the index of the packet that completed
+// the response, or -1.
+int trackResponse(CommandResponseTracker& tracker, const std::vector<std::string>& payloads) {
+  for (size_t i = 0; i < payloads.size(); i++) {
+    Buffer::OwnedImpl packet(payloads[i]);
+    BufferHelper::encodeHdr(packet, i + 1);
+    if (tracker.onPacket(packet, payloads[i].size())) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+std::string okPacket(uint16_t status) {
+  OkMessage ok;
+  ok.setServerStatus(status);
+  Buffer::OwnedImpl payload;
+  ok.encode(payload);
+  return payload.toString();
+}
+
+std::string eofPacket(uint16_t status) {
+  Buffer::OwnedImpl payload;
+  BufferHelper::addUint8(payload, EOF_MARKER);
+  BufferHelper::addUint16(payload, 0);
+  BufferHelper::addUint16(payload, status);
+  return payload.toString();
+}
+
+// Catalog, schema, table, original table, name and original name of a column.
+const std::string ColumnDefinition = "\x03" "def\x02" "db\x01t\x01t\x01" "a\x01" "a";
+
+TEST(MySQLCodecTest, CommandResponseTrackerOk) {
+  CommandResponseTracker tracker(Command::Cmd::Query);
+  EXPECT_EQ(0, trackResponse(tracker, {okPacket(SERVER_STATUS_IN_TRANS)}));
+  EXPECT_FALSE(tracker.error());
+  EXPECT_EQ(SERVER_STATUS_IN_TRANS, tracker.serverStatus());
+}
+
+TEST(MySQLCodecTest, CommandResponseTrackerError) {
+  CommandResponseTracker tracker(Command::Cmd::Query);
+  EXPECT_EQ(0, trackResponse(tracker, {"\xff\x7a\x04#42000error"}));
+  EXPECT_TRUE(tracker.error());
+  EXPECT_FALSE(tracker.serverStatus().has_value());
+}
+
+TEST(MySQLCodecTest, CommandResponseTrackerResultSets) {
+  // Two result sets, the second with a row that starts like an EOF packet but is too long.
+  CommandResponseTracker tracker(Command::Cmd::Query);
+  EXPECT_EQ(10, trackResponse(tracker, {"\x01", ColumnDefinition,
+                                        eofPacket(SERVER_STATUS_AUTOCOMMIT), "\x01" "1",
+                                        eofPacket(SERVER_MORE_RESULTS_EXISTS), "\x01",
+                                        ColumnDefinition, eofPacket(0),
+                                        "\xfe" + std::string(8, 'a'), "\x01" "2",
+                                        eofPacket(SERVER_STATUS_AUTOCOMMIT)}));
+  EXPECT_EQ(SERVER_STATUS_AUTOCOMMIT, tracker.serverStatus());
+}
+
+TEST(MySQLCodecTest, CommandResponseTrackerRowError) {
+  CommandResponseTracker tracker(Command::Cmd::Query);
+  EXPECT_EQ(4, trackResponse(tracker, {"\x01", ColumnDefinition, eofPacket(0), "\x01" "1",
+                                       "\xff\x7a\x04#42000error"}));
+  EXPECT_TRUE(tracker.error());
+}
+
+TEST(MySQLCodecTest, CommandResponseTrackerCursor) {
+  CommandResponseTracker tracker(Command::Cmd::StmtExecute);
+  EXPECT_EQ(2, trackResponse(tracker, {"\x01", ColumnDefinition,
+                                       eofPacket(SERVER_STATUS_CURSOR_EXISTS)}));
+}
+
+TEST(MySQLCodecTest, CommandResponseTrackerStmtPrepare) {
+  // Statement 7 with one column and two parameters.
+  CommandResponseTracker tracker(Command::Cmd::StmtPrepare);
+  const std::string ok("\x00\x07\x00\x00\x00\x01\x00\x02\x00\x00\x00\x00", 12);
+  EXPECT_EQ(5, trackResponse(tracker, {ok, ColumnDefinition, ColumnDefinition, eofPacket(0),
+                                       ColumnDefinition, eofPacket(0)}));
+  EXPECT_EQ(7, tracker.statementId());
+
+  CommandResponseTracker no_params(Command::Cmd::StmtPrepare);
+  EXPECT_EQ(0, trackResponse(no_params, {std::string(12, '\0')}));
+}
+
+TEST(MySQLCodecTest, CommandResponseTrackerFieldList) {
+  CommandResponseTracker tracker(Command::Cmd::FieldList);
+  EXPECT_EQ(2, trackResponse(tracker, {ColumnDefinition, ColumnDefinition, eofPacket(0)}));
+}
+
+TEST(MySQLCodecTest, CommandResponseTrackerStatistics) {
+  CommandResponseTracker tracker(Command::Cmd::Statistics);
+  EXPECT_EQ(0, trackResponse(tracker, {"Uptime: 1"}));
+  EXPECT_FALSE(tracker.serverStatus().has_value());
+}
+
+TEST(MySQLCodecTest, CommandResponseTrackerExpectsResponse) {
+  EXPECT_TRUE(CommandResponseTracker::expectsResponse(Command::Cmd::Query));
+  EXPECT_FALSE(CommandResponseTracker::expectsResponse(Command::Cmd::StmtClose));
+  EXPECT_FALSE(CommandResponseTracker::expectsResponse(Command::Cmd::StmtSendLongData));
+}
+
 } // namespace MySQLProxy
 } // namespace NetworkFilters
 } // namespace Extensions
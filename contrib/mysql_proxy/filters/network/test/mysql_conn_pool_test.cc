@@ -0,0 +1,466 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "source/common/stats/isolated_store_impl.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/upstream/cluster_manager.h"
+
+#include "contrib/mysql_proxy/filters/network/source/mysql_auth.h"
+#include "contrib/mysql_proxy/filters/network/source/mysql_codec_clogin.h"
+#include "contrib/mysql_proxy/filters/network/source/mysql_codec_clogin_resp.h"
+#include "contrib/mysql_proxy/filters/network/source/mysql_conn_pool.h"
+#include "contrib/mysql_proxy/filters/network/source/mysql_utils.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace MySQLProxy {
+namespace ConnPool {
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::SaveArg;
+
+class MockPoolCallbacks : public PoolCallbacks {
+public:
+  MOCK_METHOD(void, onPoolReady, (ServerConnection & connection));
+  MOCK_METHOD(void, onPoolFailure, ());
+};
+
+class MockServerConnectionCallbacks : public ServerConnectionCallbacks {
+public:
+  void onServerData(Buffer::Instance& data) override {
+    onServerData_(data.toString());
+    data.drain(data.length());
+  }
+
+  MOCK_METHOD(void, onServerData_, (std::string data));
+  MOCK_METHOD(void, onServerResponse, (const CommandResponseTracker& response));
+  MOCK_METHOD(void, onServerClose, ());
+};
+
+constexpr absl::string_view Scramble = "abcdefghijklmnopqrst";
+
+// Builds a packet with its header.
+std::string packet(uint8_t seq, absl::string_view payload) {
+  Buffer::OwnedImpl data(payload);
+  BufferHelper::encodeHdr(data, seq);
+  return data.toString();
+}
+
+std::string greeting(const std::string& auth_plugin) {
+  ServerGreeting greeting;
+  greeting.setProtocol(MYSQL_PROTOCOL_10);
+  greeting.setVersion("8.0.36");
+  greeting.setServerCap(PoolCapabilities | CLIENT_SSL | CLIENT_DEPRECATE_EOF);
+  greeting.setServerCharset(DEFAULT_MYSQL_CHARSET);
+  greeting.setServerStatus(SERVER_STATUS_AUTOCOMMIT);
+  greeting.setAuthPluginName(auth_plugin);
+  greeting.setAuthPluginData(std::vector<uint8_t>(Scramble.begin(), Scramble.end()));
+  Buffer::OwnedImpl payload;
+  greeting.encode(payload);
+  return packet(0, payload.toString());
+}
+
+std::string ok(uint8_t seq, uint16_t status = SERVER_STATUS_AUTOCOMMIT) {
+  OkMessage ok;
+  ok.setServerStatus(status);
+  Buffer::OwnedImpl payload;
+  ok.encode(payload);
+  return packet(seq, payload.toString());
+}
+
+std::string eof(uint8_t seq, uint16_t status = SERVER_STATUS_AUTOCOMMIT) {
+  Buffer::OwnedImpl payload;
+  BufferHelper::addUint8(payload, EOF_MARKER);
+  BufferHelper::addUint16(payload, 0);
+  BufferHelper::addUint16(payload, status);
+  return packet(seq, payload.toString());
+}
+
+std::string error(uint8_t seq) {
+  return packet(seq, "\xff\x15\x04#28000Access denied");
+}
+
+class MySQLConnPoolTest : public testing::Test {
+public:
+  void setup(uint32_t max_server_connections = 2) {
+    cm_.initializeThreadLocalClusters({"mysql_cluster"});
+    settings_ = std::make_shared<PoolSettings>("mysql_cluster", "app", "secret", "db",
+                                               max_server_connections, "8.0.0",
+                                               *store_.rootScope(), "pool");
+    pool_ = std::make_unique<InstanceImpl>(settings_, cm_, dispatcher_, random_);
+  }
+
+  Network::MockClientConnection* expectConnection() {
+    auto* connection = new NiceMock<Network::MockClientConnection>();
+    EXPECT_CALL(cm_.thread_local_cluster_, tcpConn_(_))
+        .WillOnce(Return(Upstream::MockHost::MockCreateConnectionData{connection, nullptr}));
+    EXPECT_CALL(*connection, addReadFilter(_)).WillOnce(SaveArg<0>(&read_filter_));
+    EXPECT_CALL(*connection, connect());
+    return connection;
+  }
+
+  void serverSends(const std::string& data) {
+    Buffer::OwnedImpl buffer(data);
+    read_filter_->onData(buffer, false);
+  }
+
+  // Captures the next packet written to the server connection.
+  void expectWrite(Network::MockClientConnection& connection, std::string& written) {
+    EXPECT_CALL(connection, write(_, false))
+        .WillOnce(Invoke([&written](Buffer::Instance& data, bool) {
+          written = data.toString();
+          data.drain(data.length());
+        }));
+  }
+
+  // Connects a server connection and logs it in with mysql_native_password.
+  void login(Network::MockClientConnection& connection) {
+    connection.raiseEvent(Network::ConnectionEvent::Connected);
+    serverSends(greeting("mysql_native_password"));
+    serverSends(ok(2));
+  }
+
+  uint64_t counter(const std::string& name) {
+    return store_.counterFromString("pool." + name).value();
+  }
+  uint64_t gauge(const std::string& name) {
+    return store_.gaugeFromString("pool." + name, Stats::Gauge::ImportMode::Accumulate).value();
+  }
+
+  Stats::IsolatedStoreImpl store_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  NiceMock<Upstream::MockClusterManager> cm_;
+  NiceMock<Random::MockRandomGenerator> random_{0};
+  PoolSettingsSharedPtr settings_;
+  std::unique_ptr<InstanceImpl> pool_;
+  Network::ReadFilterSharedPtr read_filter_;
+};
+
+TEST_F(MySQLConnPoolTest, LoginLeaseAndRelease) {
+  setup();
+  MockPoolCallbacks callbacks;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks);
+  EXPECT_EQ(1, gauge("leases_pending"));
+  EXPECT_EQ(1, gauge("server_connections_active"));
+  connection->raiseEvent(Network::ConnectionEvent::Connected);
+
+  // The handshake response carries the configured credentials, without SSL or
+  // CLIENT_DEPRECATE_EOF.
+  std::string handshake;
+  expectWrite(*connection, handshake);
+  serverSends(greeting("mysql_native_password"));
+  ASSERT_GT(handshake.size(), 4);
+  EXPECT_EQ(1, handshake[3]);
+  Buffer::OwnedImpl handshake_payload(handshake.substr(4));
+  ClientLogin login;
+  ASSERT_EQ(DecodeStatus::Success, login.decode(handshake_payload, 1, handshake.size() - 4));
+  EXPECT_EQ("app", login.getUsername());
+  EXPECT_EQ("db", login.getDb());
+  EXPECT_EQ("mysql_native_password", login.getAuthPluginName());
+  const std::string response = Auth::nativePassword("secret", Scramble);
+  EXPECT_EQ(std::vector<uint8_t>(response.begin(), response.end()), login.getAuthResp());
+  EXPECT_EQ(0, login.getClientCap() & (CLIENT_SSL | CLIENT_DEPRECATE_EOF));
+  EXPECT_EQ(DEFAULT_MYSQL_CHARSET, login.getCharset());
+
+  ServerConnection* server{};
+  EXPECT_CALL(callbacks, onPoolReady(_)).WillOnce(Invoke([&](ServerConnection& connection) {
+    server = &connection;
+  }));
+  serverSends(ok(2));
+  ASSERT_NE(nullptr, server);
+  EXPECT_EQ(0, gauge("leases_pending"));
+
+  // Complete packets are forwarded as they arrive, up to the end of the response.
+  MockServerConnectionCallbacks server_callbacks;
+  server->attach(server_callbacks);
+  EXPECT_CALL(*connection, write(_, false));
+  Buffer::OwnedImpl query(packet(0, "\x03SELECT 1"));
+  server->write(query, Command::Cmd::Query);
+
+  const std::string results = packet(1, "\x01") + packet(2, "\x03" "def") + eof(3) +
+                              packet(4, "\x01" "1") + eof(5);
+  testing::InSequence s;
+  EXPECT_CALL(server_callbacks, onServerData_(results.substr(0, 5)));
+  EXPECT_CALL(server_callbacks, onServerData_(results.substr(5)));
+  EXPECT_CALL(server_callbacks, onServerResponse(_))
+      .WillOnce(Invoke([&](const CommandResponseTracker& response) {
+        EXPECT_FALSE(response.error());
+        ASSERT_TRUE(response.serverStatus().has_value());
+        EXPECT_EQ(SERVER_STATUS_AUTOCOMMIT, response.serverStatus().value());
+        pool_->release(*server, true);
+      }));
+  serverSends(results.substr(0, 7));
+  serverSends(results.substr(7));
+  EXPECT_EQ(1, gauge("server_connections_idle"));
+
+  // Packets received while the connection is idle are dropped.
+  serverSends(error(0));
+
+  // The idle connection is leased again without connecting.
+  EXPECT_CALL(callbacks, onPoolReady(_));
+  pool_->acquire(callbacks);
+  EXPECT_EQ(0, gauge("server_connections_idle"));
+  EXPECT_EQ(2, counter("leases"));
+  EXPECT_EQ(1, counter("lease_waits"));
+  EXPECT_EQ(1, counter("server_connections"));
+}
+
+// Commands without a response complete when they are sent.
+TEST_F(MySQLConnPoolTest, CommandWithoutResponse) {
+  setup();
+  MockPoolCallbacks callbacks;
+  Network::MockClientConnection* connection = expectConnection();
+  ServerConnection* server{};
+  EXPECT_CALL(callbacks, onPoolReady(_)).WillOnce(Invoke([&](ServerConnection& connection) {
+    server = &connection;
+  }));
+  pool_->acquire(callbacks);
+  login(*connection);
+  ASSERT_NE(nullptr, server);
+
+  MockServerConnectionCallbacks server_callbacks;
+  server->attach(server_callbacks);
+  Buffer::OwnedImpl close_statement(packet(0, std::string("\x19\x01\x00\x00\x00", 5)));
+  server->write(close_statement, Command::Cmd::StmtClose);
+
+  EXPECT_CALL(server_callbacks, onServerData_(_)).Times(0);
+  serverSends(ok(1));
+  pool_->release(*server, true);
+  EXPECT_EQ(1, gauge("server_connections_idle"));
+}
+
+// A connection returned with a command in flight is closed.
+TEST_F(MySQLConnPoolTest, ReleaseWithCommandInFlight) {
+  setup();
+  MockPoolCallbacks callbacks;
+  Network::MockClientConnection* connection = expectConnection();
+  ServerConnection* server{};
+  EXPECT_CALL(callbacks, onPoolReady(_)).WillOnce(Invoke([&](ServerConnection& connection) {
+    server = &connection;
+  }));
+  pool_->acquire(callbacks);
+  login(*connection);
+  ASSERT_NE(nullptr, server);
+
+  Buffer::OwnedImpl query(packet(0, "\x03SELECT SLEEP(10)"));
+  server->write(query, Command::Cmd::Query);
+  EXPECT_CALL(*connection, close(_));
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  pool_->release(*server, true);
+  EXPECT_EQ(0, gauge("server_connections_active"));
+}
+
+TEST_F(MySQLConnPoolTest, AuthSwitch) {
+  setup();
+  MockPoolCallbacks callbacks;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks);
+  connection->raiseEvent(Network::ConnectionEvent::Connected);
+  serverSends(greeting("mysql_native_password"));
+
+  const std::string scramble = "ABCDEFGHIJKLMNOPQRST";
+  std::string response;
+  expectWrite(*connection, response);
+  serverSends(packet(2, absl::StrCat("\xfe" "caching_sha2_password", absl::string_view("\0", 1),
+                                     scramble, absl::string_view("\0", 1))));
+  EXPECT_EQ(packet(3, Auth::cachingSha2Password("secret", scramble)), response);
+
+  // Fast authentication succeeded.
+  serverSends(packet(4, "\x01\x03"));
+  EXPECT_CALL(callbacks, onPoolReady(_));
+  serverSends(ok(5));
+  EXPECT_EQ(0, counter("server_login_failures"));
+}
+
+TEST_F(MySQLConnPoolTest, CachingSha2FullAuthentication) {
+  setup();
+  MockPoolCallbacks callbacks;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks);
+  connection->raiseEvent(Network::ConnectionEvent::Connected);
+
+  std::string handshake;
+  expectWrite(*connection, handshake);
+  serverSends(greeting("caching_sha2_password"));
+  const std::string response = Auth::cachingSha2Password("secret", Scramble);
+  EXPECT_NE(std::string::npos, handshake.find(response));
+
+  // Full authentication requests the public key of the server.
+  std::string request;
+  expectWrite(*connection, request);
+  serverSends(packet(2, "\x01\x04"));
+  EXPECT_EQ(packet(3, "\x02"), request);
+
+  // A key that cannot be read fails the login.
+  EXPECT_CALL(callbacks, onPoolFailure());
+  serverSends(packet(4, "\x01not a key"));
+  EXPECT_EQ(1, counter("server_login_failures"));
+}
+
+TEST_F(MySQLConnPoolTest, LoginRejected) {
+  setup();
+  MockPoolCallbacks callbacks;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks);
+  connection->raiseEvent(Network::ConnectionEvent::Connected);
+  serverSends(greeting("mysql_native_password"));
+
+  EXPECT_CALL(callbacks, onPoolFailure());
+  serverSends(error(2));
+  EXPECT_EQ(1, counter("server_login_failures"));
+  EXPECT_EQ(1, counter("lease_failures"));
+  EXPECT_EQ(0, gauge("server_connections_active"));
+}
+
+// Like the error a server sends when it has too many connections.
+TEST_F(MySQLConnPoolTest, ErrorInsteadOfGreeting) {
+  setup();
+  MockPoolCallbacks callbacks;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks);
+  connection->raiseEvent(Network::ConnectionEvent::Connected);
+
+  EXPECT_CALL(callbacks, onPoolFailure());
+  serverSends(error(0));
+  EXPECT_EQ(1, counter("server_login_failures"));
+}
+
+TEST_F(MySQLConnPoolTest, UnsupportedAuthentication) {
+  setup();
+  MockPoolCallbacks callbacks;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks);
+  connection->raiseEvent(Network::ConnectionEvent::Connected);
+  serverSends(greeting("mysql_native_password"));
+
+  EXPECT_CALL(callbacks, onPoolFailure());
+  serverSends(packet(2, absl::StrCat("\xfe" "mysql_clear_password", absl::string_view("\0", 1))));
+  EXPECT_EQ(1, counter("server_login_failures"));
+}
+
+TEST_F(MySQLConnPoolTest, ConnectFailure) {
+  setup();
+  MockPoolCallbacks callbacks;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks);
+
+  EXPECT_CALL(callbacks, onPoolFailure());
+  connection->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_EQ(1, counter("server_connect_failures"));
+  EXPECT_EQ(0, gauge("leases_pending"));
+}
+
+TEST_F(MySQLConnPoolTest, UnknownCluster) {
+  setup();
+  MockPoolCallbacks callbacks;
+  EXPECT_CALL(cm_, getThreadLocalCluster(_)).WillOnce(Return(nullptr));
+  EXPECT_CALL(callbacks, onPoolFailure());
+  pool_->acquire(callbacks);
+  EXPECT_EQ(1, counter("lease_failures"));
+}
+
+TEST_F(MySQLConnPoolTest, NoHealthyHost) {
+  setup();
+  MockPoolCallbacks callbacks;
+  EXPECT_CALL(cm_.thread_local_cluster_, tcpConn_(_))
+      .WillOnce(Return(Upstream::MockHost::MockCreateConnectionData{nullptr, nullptr}));
+  EXPECT_CALL(callbacks, onPoolFailure());
+  pool_->acquire(callbacks);
+  EXPECT_EQ(1, counter("server_connect_failures"));
+}
+
+// Clients wait for a connection to be returned once the pool is full.
+TEST_F(MySQLConnPoolTest, WaitForRelease) {
+  setup(1);
+  MockPoolCallbacks callbacks1;
+  MockPoolCallbacks callbacks2;
+  MockPoolCallbacks callbacks3;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks1);
+  pool_->acquire(callbacks2);
+  pool_->acquire(callbacks3);
+  EXPECT_EQ(3, gauge("leases_pending"));
+
+  ServerConnection* server{};
+  EXPECT_CALL(callbacks1, onPoolReady(_)).WillOnce(Invoke([&](ServerConnection& connection) {
+    server = &connection;
+  }));
+  login(*connection);
+  ASSERT_NE(nullptr, server);
+
+  pool_->cancel(callbacks2);
+  EXPECT_EQ(1, gauge("leases_pending"));
+
+  EXPECT_CALL(callbacks3, onPoolReady(_));
+  pool_->release(*server, true);
+  EXPECT_EQ(0, gauge("leases_pending"));
+  EXPECT_EQ(0, gauge("server_connections_idle"));
+  EXPECT_EQ(1, counter("server_connections"));
+}
+
+// A connection returned with session state is closed and replaced.
+TEST_F(MySQLConnPoolTest, ReleaseNotReusable) {
+  setup(1);
+  MockPoolCallbacks callbacks1;
+  MockPoolCallbacks callbacks2;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks1);
+  pool_->acquire(callbacks2);
+
+  ServerConnection* server{};
+  EXPECT_CALL(callbacks1, onPoolReady(_)).WillOnce(Invoke([&](ServerConnection& connection) {
+    server = &connection;
+  }));
+  login(*connection);
+  ASSERT_NE(nullptr, server);
+
+  Network::MockClientConnection* connection2 = expectConnection();
+  EXPECT_CALL(*connection, close(_));
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  pool_->release(*server, false);
+  EXPECT_EQ(1, gauge("server_connections_active"));
+
+  EXPECT_CALL(callbacks2, onPoolReady(_));
+  login(*connection2);
+  EXPECT_EQ(2, counter("server_connections"));
+}
+
+TEST_F(MySQLConnPoolTest, ServerCloseWhileLeased) {
+  setup();
+  MockPoolCallbacks callbacks;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks);
+
+  ServerConnection* server{};
+  EXPECT_CALL(callbacks, onPoolReady(_)).WillOnce(Invoke([&](ServerConnection& connection) {
+    server = &connection;
+  }));
+  login(*connection);
+  ASSERT_NE(nullptr, server);
+
+  MockServerConnectionCallbacks server_callbacks;
+  server->attach(server_callbacks);
+  EXPECT_CALL(server_callbacks, onServerClose());
+  connection->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_EQ(0, gauge("server_connections_active"));
+}
+
+TEST_F(MySQLConnPoolTest, Scramble) {
+  setup();
+  // The random generator always returns 0.
+  EXPECT_EQ(std::string(Auth::ScrambleLength, '!'), pool_->scramble());
+}
+
+} // namespace ConnPool
+} // namespace MySQLProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
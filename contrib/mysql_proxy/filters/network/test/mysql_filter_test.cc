@@ -2,6 +2,7 @@
 
 #include "test/mocks/network/mocks.h"
 
+#include "contrib/mysql_proxy/filters/network/source/mysql_auth.h"
 #include "contrib/mysql_proxy/filters/network/source/mysql_codec.h"
 #include "contrib/mysql_proxy/filters/network/source/mysql_filter.h"
 #include "contrib/mysql_proxy/filters/network/source/mysql_utils.h"
@@ -9,7 +10,11 @@
 #include "gtest/gtest.h"
 #include "mysql_test_utils.h"
 
+using testing::_;
+using testing::Invoke;
 using testing::NiceMock;
+using testing::Ref;
+using testing::Return;
 
 namespace Envoy {
 namespace Extensions {
@@ -1068,6 +1073,368 @@ TEST_F(MySQLFilterTest, MySqlLoginAndQueryTest) {
   EXPECT_EQ(MySQLSession::State::ReqResp, filter_->getSession().getState());
 }
 
+class MockPool : public ConnPool::Instance {
+public:
+  MOCK_METHOD(void, acquire, (ConnPool::PoolCallbacks & callbacks));
+  MOCK_METHOD(void, cancel, (ConnPool::PoolCallbacks & callbacks));
+  MOCK_METHOD(void, release, (ConnPool::ServerConnection & connection, bool reusable));
+  MOCK_METHOD(std::string, scramble, ());
+  MOCK_METHOD(const ConnPool::PoolSettings&, settings, (), (const));
+};
+
+class MockServerConnection : public ConnPool::ServerConnection {
+public:
+  void write(Buffer::Instance& data, Command::Cmd cmd) override {
+    write_(data.toString(), cmd);
+    data.drain(data.length());
+  }
+
+  MOCK_METHOD(void, attach, (ConnPool::ServerConnectionCallbacks & callbacks));
+  MOCK_METHOD(void, write_, (std::string data, Command::Cmd cmd));
+};
+
+constexpr absl::string_view PoolScramble = "abcdefghijklmnopqrst";
+
+// Builds a packet with its header.
+std::string packet(uint8_t seq, absl::string_view payload) {
+  Buffer::OwnedImpl data(payload);
+  BufferHelper::encodeHdr(data, seq);
+  return data.toString();
+}
+
+std::string okPacket(uint8_t seq, uint16_t status) {
+  OkMessage ok;
+  ok.setServerStatus(status);
+  Buffer::OwnedImpl payload;
+  ok.encode(payload);
+  return packet(seq, payload.toString());
+}
+
+// Fixture for the connection pooling mode.
+class MySQLFilterPoolingTest : public testing::Test {
+public:
+  MySQLFilterPoolingTest() {
+    config_ = std::make_shared<MySQLFilterConfig>(stat_prefix_, scope_);
+    filter_ = std::make_unique<MySQLFilter>(config_, &pool_);
+
+    ON_CALL(pool_, settings()).WillByDefault(Invoke([this]() -> const ConnPool::PoolSettings& {
+      return settings_;
+    }));
+    ON_CALL(pool_, scramble()).WillByDefault(Return(std::string(PoolScramble)));
+    ON_CALL(read_callbacks_.connection_, write(_, _))
+        .WillByDefault(Invoke([this](Buffer::Instance& data, bool) {
+          client_received_.append(data.toString());
+          data.drain(data.length());
+        }));
+
+    EXPECT_CALL(read_callbacks_.connection_, addConnectionCallbacks(_));
+    filter_->initializeReadFilterCallbacks(read_callbacks_);
+  }
+
+  void clientSends(const std::string& data) {
+    Buffer::OwnedImpl buffer(data);
+    EXPECT_EQ(Network::FilterStatus::StopIteration, filter_->onData(buffer, false));
+    EXPECT_EQ(0, buffer.length());
+  }
+
+  std::string handshakeResponse(const std::string& username, const std::string& auth_plugin,
+                                const std::string& auth_response, const std::string& db = "db") {
+    ClientLogin login;
+    login.setClientCap(CLIENT_PROTOCOL_41 | CLIENT_SECURE_CONNECTION | CLIENT_PLUGIN_AUTH |
+                       CLIENT_CONNECT_WITH_DB);
+    login.setMaxPacket(DEFAULT_MAX_PACKET_SIZE);
+    login.setCharset(DEFAULT_MYSQL_CHARSET);
+    login.setUsername(username);
+    login.setAuthResp(std::vector<uint8_t>(auth_response.begin(), auth_response.end()));
+    login.setDb(db);
+    login.setAuthPluginName(auth_plugin);
+    Buffer::OwnedImpl payload;
+    login.encode(payload);
+    return packet(1, payload.toString());
+  }
+
+  // Logs the client in with mysql_native_password.
+  void login() {
+    EXPECT_EQ(Network::FilterStatus::Continue, filter_->onNewConnection());
+    client_received_.clear();
+    clientSends(handshakeResponse("app", "mysql_native_password",
+                                  Auth::nativePassword("secret", PoolScramble)));
+    EXPECT_EQ(okPacket(2, SERVER_STATUS_AUTOCOMMIT), client_received_);
+    client_received_.clear();
+  }
+
+  // Expects a lease for the next command.
+  void expectLease() {
+    EXPECT_CALL(pool_, acquire(_)).WillOnce(Invoke([this](ConnPool::PoolCallbacks& callbacks) {
+      callbacks.onPoolReady(server_);
+    }));
+    EXPECT_CALL(server_, attach(_));
+  }
+
+  // Delivers a response that consists of a single packet.
+  void serverResponds(Command::Cmd cmd, const std::string& response) {
+    CommandResponseTracker tracker(cmd);
+    Buffer::OwnedImpl data(response);
+    EXPECT_TRUE(tracker.onPacket(data, data.length() - MYSQL_HDR_SIZE));
+    filter_->onServerData(data);
+    filter_->onServerResponse(tracker);
+  }
+
+  Stats::IsolatedStoreImpl store_;
+  Stats::Scope& scope_{*store_.rootScope()};
+  std::string stat_prefix_{"test."};
+  ConnPool::PoolSettings settings_{"cluster", "app", "secret", "db", 10, "8.0.0", scope_, "pool"};
+  NiceMock<MockPool> pool_;
+  NiceMock<MockServerConnection> server_;
+  MySQLFilterConfigSharedPtr config_;
+  std::unique_ptr<MySQLFilter> filter_;
+  NiceMock<Network::MockReadFilterCallbacks> read_callbacks_;
+  std::string client_received_;
+};
+
+TEST_F(MySQLFilterPoolingTest, Greeting) {
+  EXPECT_EQ(Network::FilterStatus::Continue, filter_->onNewConnection());
+  EXPECT_EQ(1UL, config_->stats().sessions_.value());
+
+  ASSERT_GT(client_received_.size(), MYSQL_HDR_SIZE);
+  Buffer::OwnedImpl payload(client_received_.substr(MYSQL_HDR_SIZE));
+  ServerGreeting greeting;
+  ASSERT_EQ(DecodeStatus::Success, greeting.decode(payload, 0, payload.length()));
+  EXPECT_EQ(MYSQL_PROTOCOL_10, greeting.getProtocol());
+  EXPECT_EQ("8.0.0", greeting.getVersion());
+  EXPECT_EQ("mysql_native_password", greeting.getAuthPluginName());
+  EXPECT_EQ(0, greeting.getServerCap() & CLIENT_SSL);
+  const std::vector<uint8_t> scramble = greeting.getAuthPluginData();
+  EXPECT_EQ(PoolScramble, std::string(scramble.begin(), scramble.end()));
+}
+
+TEST_F(MySQLFilterPoolingTest, Login) {
+  login();
+  EXPECT_EQ(1UL, config_->stats().login_attempts_.value());
+  EXPECT_EQ(0UL, config_->stats().login_failures_.value());
+}
+
+TEST_F(MySQLFilterPoolingTest, WrongPassword) {
+  EXPECT_EQ(Network::FilterStatus::Continue, filter_->onNewConnection());
+  client_received_.clear();
+
+  EXPECT_CALL(read_callbacks_.connection_, close(Network::ConnectionCloseType::FlushWrite));
+  clientSends(handshakeResponse("app", "mysql_native_password",
+                                Auth::nativePassword("wrong", PoolScramble)));
+  EXPECT_EQ(ERR_MARKER, static_cast<uint8_t>(client_received_[MYSQL_HDR_SIZE]));
+  EXPECT_THAT(client_received_, testing::HasSubstr("28000"));
+  EXPECT_EQ(1UL, config_->stats().login_failures_.value());
+}
+
+TEST_F(MySQLFilterPoolingTest, UnknownUser) {
+  EXPECT_EQ(Network::FilterStatus::Continue, filter_->onNewConnection());
+  client_received_.clear();
+
+  EXPECT_CALL(read_callbacks_.connection_, close(Network::ConnectionCloseType::FlushWrite));
+  clientSends(handshakeResponse("root", "mysql_native_password",
+                                Auth::nativePassword("secret", PoolScramble)));
+  EXPECT_THAT(client_received_, testing::HasSubstr("Access denied for user 'root'"));
+}
+
+TEST_F(MySQLFilterPoolingTest, UnknownDatabase) {
+  EXPECT_EQ(Network::FilterStatus::Continue, filter_->onNewConnection());
+  client_received_.clear();
+
+  EXPECT_CALL(read_callbacks_.connection_, close(Network::ConnectionCloseType::FlushWrite));
+  clientSends(handshakeResponse("app", "mysql_native_password",
+                                Auth::nativePassword("secret", PoolScramble), "other"));
+  EXPECT_THAT(client_received_, testing::HasSubstr("42000"));
+}
+
+// Clients that start with another authentication plugin are asked to switch.
+TEST_F(MySQLFilterPoolingTest, AuthSwitch) {
+  EXPECT_EQ(Network::FilterStatus::Continue, filter_->onNewConnection());
+  client_received_.clear();
+
+  clientSends(handshakeResponse("app", "caching_sha2_password",
+                                Auth::cachingSha2Password("secret", PoolScramble)));
+  EXPECT_EQ(packet(2, absl::StrCat("\xfe"
+                                   "mysql_native_password",
+                                   absl::string_view("\0", 1), PoolScramble,
+                                   absl::string_view("\0", 1))),
+            client_received_);
+  EXPECT_EQ(1UL, config_->stats().auth_switch_request_.value());
+  client_received_.clear();
+
+  clientSends(packet(3, Auth::nativePassword("secret", PoolScramble)));
+  EXPECT_EQ(okPacket(4, SERVER_STATUS_AUTOCOMMIT), client_received_);
+}
+
+// The server connection is leased for the duration of a command.
+TEST_F(MySQLFilterPoolingTest, Query) {
+  login();
+
+  const std::string query = packet(0, "\x03SELECT * FROM t");
+  expectLease();
+  EXPECT_CALL(server_, write_(query, Command::Cmd::Query));
+  clientSends(query);
+  EXPECT_EQ(1UL, config_->stats().queries_parsed_.value());
+
+  EXPECT_CALL(pool_, release(Ref(server_), true));
+  serverResponds(Command::Cmd::Query, okPacket(1, SERVER_STATUS_AUTOCOMMIT));
+  EXPECT_EQ(okPacket(1, SERVER_STATUS_AUTOCOMMIT), client_received_);
+}
+
+// Commands sent without waiting for a response are sent one at a time.
+TEST_F(MySQLFilterPoolingTest, PipelinedQueries) {
+  login();
+
+  const std::string query1 = packet(0, "\x03SELECT 1");
+  const std::string query2 = packet(0, "\x03SELECT 2");
+  expectLease();
+  EXPECT_CALL(server_, write_(query1, Command::Cmd::Query));
+  clientSends(query1 + query2.substr(0, 6));
+  clientSends(query2.substr(6));
+
+  EXPECT_CALL(pool_, release(Ref(server_), true));
+  expectLease();
+  EXPECT_CALL(server_, write_(query2, Command::Cmd::Query));
+  serverResponds(Command::Cmd::Query, okPacket(1, SERVER_STATUS_AUTOCOMMIT));
+}
+
+// Transactions keep the lease until they end.
+TEST_F(MySQLFilterPoolingTest, Transaction) {
+  login();
+
+  expectLease();
+  clientSends(packet(0, "\x03"
+                        "BEGIN"));
+  EXPECT_CALL(pool_, release(_, _)).Times(0);
+  serverResponds(Command::Cmd::Query,
+                 okPacket(1, SERVER_STATUS_AUTOCOMMIT | SERVER_STATUS_IN_TRANS));
+  EXPECT_TRUE(filter_->getSession().inTransaction());
+
+  // Still leased, the next statement goes straight to the server.
+  EXPECT_CALL(pool_, acquire(_)).Times(0);
+  const std::string commit = packet(0, "\x03"
+                                       "COMMIT");
+  EXPECT_CALL(server_, write_(commit, Command::Cmd::Query));
+  clientSends(commit);
+
+  EXPECT_CALL(pool_, release(Ref(server_), true));
+  serverResponds(Command::Cmd::Query, okPacket(1, SERVER_STATUS_AUTOCOMMIT));
+  EXPECT_FALSE(filter_->getSession().inTransaction());
+}
+
+// Session state pins the client to its server connection, which is not reused after the client
+// goes away.
+TEST_F(MySQLFilterPoolingTest, SessionVariable) {
+  login();
+
+  expectLease();
+  clientSends(packet(0, "\x03SET @id = 1"));
+  EXPECT_CALL(pool_, release(_, _)).Times(0);
+  serverResponds(Command::Cmd::Query, okPacket(1, SERVER_STATUS_AUTOCOMMIT));
+  EXPECT_EQ(MySQLSession::Variables, filter_->getSession().getPinReasons());
+  EXPECT_EQ(1UL, settings_.stats_.sessions_pinned_.value());
+
+  EXPECT_CALL(pool_, release(Ref(server_), false));
+  filter_->onEvent(Network::ConnectionEvent::RemoteClose);
+}
+
+TEST_F(MySQLFilterPoolingTest, AutocommitOff) {
+  login();
+
+  expectLease();
+  clientSends(packet(0, "\x03"
+                        "DO 1"));
+  EXPECT_CALL(pool_, release(_, _)).Times(0);
+  serverResponds(Command::Cmd::Query, okPacket(1, 0));
+  EXPECT_EQ(MySQLSession::Variables, filter_->getSession().getPinReasons());
+}
+
+// Prepared statements pin the session until they are closed.
+TEST_F(MySQLFilterPoolingTest, PreparedStatement) {
+  login();
+
+  expectLease();
+  clientSends(packet(0, "\x16SELECT 1"));
+  EXPECT_CALL(pool_, release(_, _)).Times(0);
+  serverResponds(Command::Cmd::StmtPrepare,
+                 packet(1, absl::string_view("\x00\x07\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00",
+                                             12)));
+  EXPECT_EQ(MySQLSession::PreparedStatements, filter_->getSession().getPinReasons());
+
+  // COM_STMT_CLOSE has no response.
+  const std::string close = packet(0, absl::string_view("\x19\x07\x00\x00\x00", 5));
+  EXPECT_CALL(server_, write_(close, Command::Cmd::StmtClose));
+  EXPECT_CALL(pool_, release(Ref(server_), true));
+  clientSends(close);
+  EXPECT_EQ(0, filter_->getSession().getPinReasons());
+}
+
+TEST_F(MySQLFilterPoolingTest, CloseWhileWaiting) {
+  login();
+
+  EXPECT_CALL(pool_, acquire(_));
+  clientSends(packet(0, "\x03SELECT 1"));
+
+  EXPECT_CALL(pool_, cancel(_));
+  filter_->onEvent(Network::ConnectionEvent::RemoteClose);
+}
+
+// A client that goes away with a command in flight gives back an unusable connection.
+TEST_F(MySQLFilterPoolingTest, CloseWithCommandInFlight) {
+  login();
+
+  expectLease();
+  clientSends(packet(0, "\x03SELECT SLEEP(10)"));
+
+  EXPECT_CALL(pool_, release(Ref(server_), false));
+  filter_->onEvent(Network::ConnectionEvent::RemoteClose);
+}
+
+TEST_F(MySQLFilterPoolingTest, Ping) {
+  login();
+
+  EXPECT_CALL(pool_, acquire(_)).Times(0);
+  clientSends(packet(0, "\x0e"));
+  EXPECT_EQ(okPacket(1, SERVER_STATUS_AUTOCOMMIT), client_received_);
+}
+
+TEST_F(MySQLFilterPoolingTest, Quit) {
+  login();
+
+  EXPECT_CALL(pool_, acquire(_)).Times(0);
+  EXPECT_CALL(read_callbacks_.connection_, close(Network::ConnectionCloseType::FlushWrite));
+  clientSends(packet(0, "\x01"));
+}
+
+TEST_F(MySQLFilterPoolingTest, ChangeUser) {
+  login();
+
+  EXPECT_CALL(pool_, acquire(_)).Times(0);
+  clientSends(packet(0, "\x11root"));
+  EXPECT_EQ(ERR_MARKER, static_cast<uint8_t>(client_received_[MYSQL_HDR_SIZE]));
+  EXPECT_THAT(client_received_, testing::HasSubstr("08S01"));
+}
+
+TEST_F(MySQLFilterPoolingTest, ServerClose) {
+  login();
+
+  expectLease();
+  clientSends(packet(0, "\x03SELECT SLEEP(10)"));
+
+  EXPECT_CALL(read_callbacks_.connection_, close(Network::ConnectionCloseType::FlushWrite));
+  filter_->onServerClose();
+}
+
+TEST_F(MySQLFilterPoolingTest, PoolFailure) {
+  login();
+
+  EXPECT_CALL(pool_, acquire(_)).WillOnce(Invoke([](ConnPool::PoolCallbacks& callbacks) {
+    callbacks.onPoolFailure();
+  }));
+  EXPECT_CALL(read_callbacks_.connection_, close(Network::ConnectionCloseType::FlushWrite));
+  clientSends(packet(0, "\x03SELECT 1"));
+  EXPECT_THAT(client_received_, testing::HasSubstr("HY000"));
+}
+
 } // namespace MySQLProxy
 } // namespace NetworkFilters
 } // namespace Extensions
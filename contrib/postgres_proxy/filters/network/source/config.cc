@@ -1,5 +1,7 @@
 #include "contrib/postgres_proxy/filters/network/source/config.h"
 
+#include "source/common/config/datasource.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace NetworkFilters {
@@ -23,8 +25,35 @@ NetworkFilters::PostgresProxy::PostgresConfigFactory::createFilterFactoryFromPro
 
   PostgresFilterConfigSharedPtr filter_config(
       std::make_shared<PostgresFilterConfig>(config_options, context.scope()));
+
+  if (proto_config.has_transaction_pooling()) {
+    if (config_options.upstream_ssl_ ==
+        envoy::extensions::filters::network::postgres_proxy::v3alpha::PostgresProxy::REQUIRE) {
+      throw EnvoyException("postgres_proxy: upstream_ssl cannot be required with "
+                           "transaction_pooling");
+    }
+    const auto& pooling = proto_config.transaction_pooling();
+    auto& server_context = context.serverFactoryContext();
+    auto settings = std::make_shared<ConnPool::PoolSettings>(
+        pooling.cluster(), pooling.username(),
+        Config::DataSource::read(pooling.password(), true, server_context.api()),
+        pooling.database().empty() ? pooling.username() : pooling.database(),
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(pooling, max_server_connections, 100), context.scope(),
+        Envoy::statPrefixJoin(config_options.stats_prefix_, "pool"));
+
+    filter_config->pools_ =
+        ThreadLocal::TypedSlot<ConnPool::InstanceImpl>::makeUnique(server_context.threadLocal());
+    filter_config->pools_->set([settings, &cluster_manager = server_context.clusterManager(),
+                                &random = server_context.api().randomGenerator()](
+                                   Event::Dispatcher& dispatcher) {
+      return std::make_shared<ConnPool::InstanceImpl>(settings, cluster_manager, dispatcher,
+                                                      random);
+    });
+  }
+
   return [filter_config](Network::FilterManager& filter_manager) -> void {
-    filter_manager.addFilter(std::make_shared<PostgresFilter>(filter_config));
+    filter_manager.addFilter(
+        std::make_shared<PostgresFilter>(filter_config, filter_config->pool()));
   };
 }
 
@@ -22,6 +22,13 @@ public:
   PostgresConfigFactory() : FactoryBase{NetworkFilterNames::get().PostgresProxy} {}
 
 private:
+  bool isTerminalFilterByProtoTyped(
+      const envoy::extensions::filters::network::postgres_proxy::v3alpha::PostgresProxy&
+          proto_config,
+      Server::Configuration::ServerFactoryContext&) override {
+    return proto_config.has_transaction_pooling();
+  }
+
   Network::FilterFactoryCb createFilterFactoryFromProtoTyped(
       const envoy::extensions::filters::network::postgres_proxy::v3alpha::PostgresProxy&
           proto_config,
@@ -0,0 +1,138 @@
+#include "contrib/postgres_proxy/filters/network/source/postgres_auth.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "source/common/common/assert.h"
+#include "source/common/common/base64.h"
+#include "source/common/common/hex.h"
+
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
+#include "absl/strings/str_split.h"
+#include "openssl/evp.h"
+#include "openssl/hmac.h"
+#include "openssl/md5.h"
+#include "openssl/mem.h"
+#include "openssl/sha.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace PostgresProxy {
+
+namespace {
+
+std::string md5Hex(absl::string_view input) {
+  uint8_t digest[MD5_DIGEST_LENGTH];
+  MD5(reinterpret_cast<const uint8_t*>(input.data()), input.size(), digest);
+  return Hex::encode(digest, sizeof(digest));
+}
+
+std::string hmacSha256(absl::string_view key, absl::string_view data) {
+  std::string out(SHA256_DIGEST_LENGTH, '\0');
+  unsigned int out_len = 0;
+  HMAC(EVP_sha256(), key.data(), key.size(), reinterpret_cast<const uint8_t*>(data.data()),
+       data.size(), reinterpret_cast<uint8_t*>(out.data()), &out_len);
+  ASSERT(out_len == SHA256_DIGEST_LENGTH);
+  return out;
+}
+
+std::string sha256(absl::string_view data) {
+  std::string out(SHA256_DIGEST_LENGTH, '\0');
+  SHA256(reinterpret_cast<const uint8_t*>(data.data()), data.size(),
+         reinterpret_cast<uint8_t*>(out.data()));
+  return out;
+}
+
+std::string base64(absl::string_view data) { return Base64::encode(data.data(), data.size()); }
+
+} // namespace
+
+std::string Auth::md5Password(absl::string_view username, absl::string_view password,
+                              absl::string_view salt) {
+  return absl::StrCat("md5", md5Hex(absl::StrCat(md5Hex(absl::StrCat(password, username)), salt)));
+}
+
+bool Auth::verifyMd5Password(absl::string_view username, absl::string_view password,
+                             absl::string_view salt, absl::string_view response) {
+  const std::string expected = md5Password(username, password, salt);
+  return expected.size() == response.size() &&
+         CRYPTO_memcmp(expected.data(), response.data(), expected.size()) == 0;
+}
+
+ScramSha256Client::ScramSha256Client(absl::string_view username, absl::string_view password,
+                                     absl::string_view nonce)
+    : client_first_bare_(absl::StrCat(
+          "n=", absl::StrReplaceAll(username, {{"=", "=3D"}, {",", "=2C"}}), ",r=", nonce)),
+      password_(password), nonce_(nonce) {}
+
+std::string ScramSha256Client::clientFirstMessage() const {
+  // No channel binding, no authorization identity.
+  return absl::StrCat("n,,", client_first_bare_);
+}
+
+absl::optional<std::string> ScramSha256Client::clientFinalMessage(absl::string_view server_first) {
+  absl::string_view server_nonce;
+  std::string salt;
+  uint32_t iterations = 0;
+  for (absl::string_view attribute : absl::StrSplit(server_first, ',')) {
+    if (absl::StartsWith(attribute, "r=")) {
+      server_nonce = attribute.substr(2);
+    } else if (absl::StartsWith(attribute, "s=")) {
+      salt = Base64::decode(attribute.substr(2));
+    } else if (absl::StartsWith(attribute, "i=")) {
+      if (!absl::SimpleAtoi(attribute.substr(2), &iterations)) {
+        return absl::nullopt;
+      }
+    }
+  }
+  if (server_nonce.size() <= nonce_.size() || !absl::StartsWith(server_nonce, nonce_) ||
+      salt.empty() || iterations == 0) {
+    return absl::nullopt;
+  }
+
+  std::string salted_password(SHA256_DIGEST_LENGTH, '\0');
+  if (!PKCS5_PBKDF2_HMAC(password_.data(), password_.size(),
+                         reinterpret_cast<const uint8_t*>(salt.data()), salt.size(), iterations,
+                         EVP_sha256(), salted_password.size(),
+                         reinterpret_cast<uint8_t*>(salted_password.data()))) {
+    return absl::nullopt;
+  }
+
+  // "biws" is the base64 encoding of the GS2 header "n,,".
+  const std::string final_without_proof = absl::StrCat("c=biws,r=", server_nonce);
+  const std::string auth_message =
+      absl::StrCat(client_first_bare_, ",", server_first, ",", final_without_proof);
+
+  const std::string client_key = hmacSha256(salted_password, "Client Key");
+  const std::string client_signature = hmacSha256(sha256(client_key), auth_message);
+  std::string proof(client_key);
+  for (size_t i = 0; i < proof.size(); i++) {
+    proof[i] ^= client_signature[i];
+  }
+
+  const std::string server_key = hmacSha256(salted_password, "Server Key");
+  expected_server_signature_ = base64(hmacSha256(server_key, auth_message));
+
+  return absl::StrCat(final_without_proof, ",p=", base64(proof));
+}
+
+bool ScramSha256Client::verifyServerFinal(absl::string_view server_final) const {
+  if (expected_server_signature_.empty()) {
+    return false;
+  }
+  for (absl::string_view attribute : absl::StrSplit(server_final, ',')) {
+    if (absl::StartsWith(attribute, "v=")) {
+      return attribute.substr(2) == expected_server_signature_;
+    }
+  }
+  return false;
+}
+
+} // namespace PostgresProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
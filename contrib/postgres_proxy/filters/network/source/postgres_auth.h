@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace PostgresProxy {
+
+/**
+ * Helpers used in transaction pooling mode to authenticate clients at the proxy and to answer the
+ * password challenges of a Postgres server.
+ * See https://www.postgresql.org/docs/current/auth-password.html.
+ */
+class Auth {
+public:
+  // The length of the salt of an AuthenticationMD5Password challenge.
+  static constexpr size_t Md5SaltLength = 4;
+
+  /**
+   * @return the response to an AuthenticationMD5Password challenge:
+   *         "md5" + md5hex(md5hex(password + username) + salt).
+   */
+  static std::string md5Password(absl::string_view username, absl::string_view password,
+                                 absl::string_view salt);
+
+  /**
+   * @return whether the response to an AuthenticationMD5Password challenge proves the knowledge of
+   *         the password. The comparison takes constant time.
+   */
+  static bool verifyMd5Password(absl::string_view username, absl::string_view password,
+                                absl::string_view salt, absl::string_view response);
+};
+
+/**
+ * Client side of the SCRAM-SHA-256 SASL exchange (RFC 5802, RFC 7677) as used by Postgres.
+ * Channel binding is not supported.
+ */
+class ScramSha256Client {
+public:
+  static constexpr absl::string_view Mechanism = "SCRAM-SHA-256";
+
+  /**
+   * @param username supplies the user name sent in the first message. Postgres ignores it in favor
+   *        of the user of the startup message, so it is usually empty.
+   * @param password supplies the password.
+   * @param nonce supplies the printable client nonce.
+   */
+  ScramSha256Client(absl::string_view username, absl::string_view password,
+                    absl::string_view nonce);
+
+  /**
+   * @return the client-first-message.
+   */
+  std::string clientFirstMessage() const;
+
+  /**
+   * @param server_first supplies the server-first-message.
+   * @return the client-final-message, or absl::nullopt if the server message is malformed or
+   *         does not extend the client nonce.
+   */
+  absl::optional<std::string> clientFinalMessage(absl::string_view server_first);
+
+  /**
+   * @param server_final supplies the server-final-message.
+   * @return whether the server proved that it knows the password.
+   */
+  bool verifyServerFinal(absl::string_view server_final) const;
+
+private:
+  std::string client_first_bare_;
+  const std::string password_;
+  const std::string nonce_;
+  std::string expected_server_signature_;
+};
+
+} // namespace PostgresProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
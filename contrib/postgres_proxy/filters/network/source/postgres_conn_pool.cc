@@ -0,0 +1,454 @@
+#include "contrib/postgres_proxy/filters/network/source/postgres_conn_pool.h"
+
+#include "source/common/common/assert.h"
+#include "source/common/common/base64.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace PostgresProxy {
+namespace ConnPool {
+
+namespace {
+
+// Protocol version 3.0, sent in the startup message.
+constexpr uint32_t ProtocolVersion = 0x00030000;
+
+// Codes of the Authentication messages the server sends while a connection logs in.
+constexpr uint32_t AuthenticationOk = 0;
+constexpr uint32_t AuthenticationCleartextPassword = 3;
+constexpr uint32_t AuthenticationMD5Password = 5;
+constexpr uint32_t AuthenticationSASL = 10;
+constexpr uint32_t AuthenticationSASLContinue = 11;
+constexpr uint32_t AuthenticationSASLFinal = 12;
+
+// Reads a null terminated string at the front of the buffer and drains it, including the null
+// terminator. Returns an empty string if the buffer has no null terminator.
+std::string readString(Buffer::Instance& data) {
+  const ssize_t end = data.search("\0", 1, 0);
+  if (end < 0) {
+    data.drain(data.length());
+    return "";
+  }
+  std::string value = data.toString().substr(0, end);
+  data.drain(end + 1);
+  return value;
+}
+
+} // namespace
+
+PoolSettings::PoolSettings(std::string cluster, std::string username, std::string password,
+                           std::string database, uint32_t max_server_connections,
+                           Stats::Scope& scope, const std::string& stats_prefix)
+    : cluster_(std::move(cluster)), username_(std::move(username)), password_(std::move(password)),
+      database_(std::move(database)), max_server_connections_(max_server_connections),
+      stats_{ALL_POSTGRES_POOL_STATS(POOL_COUNTER_PREFIX(scope, stats_prefix),
+                                     POOL_GAUGE_PREFIX(scope, stats_prefix))} {}
+
+ServerConnectionImpl::ServerConnectionImpl(InstanceImpl& parent,
+                                           Network::ClientConnectionPtr&& connection)
+    : parent_(parent), connection_(std::move(connection)) {
+  connection_->addConnectionCallbacks(*this);
+  connection_->addReadFilter(std::make_shared<UpstreamReadFilter>(*this));
+  connection_->noDelay(true);
+  connection_->connect();
+}
+
+ServerConnectionImpl::~ServerConnectionImpl() {
+  if (state_ != State::Closed) {
+    // The pool is going away and does not need to be told.
+    state_ = State::Closed;
+    connection_->close(Network::ConnectionCloseType::NoFlush);
+  }
+}
+
+void ServerConnectionImpl::close() {
+  if (state_ != State::Closed) {
+    connection_->close(Network::ConnectionCloseType::NoFlush);
+  }
+}
+
+void ServerConnectionImpl::write(Buffer::Instance& data) {
+  ASSERT(state_ == State::Ready);
+  connection_->write(data, false);
+}
+
+void ServerConnectionImpl::onEvent(Network::ConnectionEvent event) {
+  if (event == Network::ConnectionEvent::Connected) {
+    ENVOY_CONN_LOG(debug, "postgres_proxy: server connection established, logging in",
+                   *connection_);
+    state_ = State::LoggingIn;
+    sendStartupMessage();
+    return;
+  }
+
+  if ((event != Network::ConnectionEvent::RemoteClose &&
+       event != Network::ConnectionEvent::LocalClose) ||
+      state_ == State::Closed) {
+    return;
+  }
+
+  if (state_ == State::Connecting) {
+    parent_.settings_->stats_.server_connect_failures_.inc();
+  }
+  const bool was_ready = state_ == State::Ready;
+  state_ = State::Closed;
+  parent_.onServerClose(*this, was_ready);
+}
+
+void ServerConnectionImpl::onData(Buffer::Instance& data) {
+  buffer_.move(data);
+
+  // Messages before a ReadyForQuery message are forwarded to the client in one batch.
+  Buffer::OwnedImpl messages;
+  while (state_ != State::Closed && buffer_.length() >= 5) {
+    const char type = buffer_.peekInt<char>(0);
+    const uint32_t length = buffer_.peekBEInt<uint32_t>(1);
+    if (length < 4) {
+      ENVOY_CONN_LOG(debug, "postgres_proxy: invalid message length {} from server", *connection_,
+                     length);
+      close();
+      return;
+    }
+    if (buffer_.length() < length + 1) {
+      break;
+    }
+
+    if (state_ == State::LoggingIn) {
+      Buffer::OwnedImpl message;
+      message.move(buffer_, length + 1);
+      message.drain(5);
+      if (!onLoginMessage(type, message)) {
+        return;
+      }
+      continue;
+    }
+
+    if (callbacks_ == nullptr) {
+      // Asynchronous messages like notices sent while the connection is idle in the pool have no
+      // client to go to.
+      ENVOY_CONN_LOG(trace, "postgres_proxy: dropping message {} received while idle", *connection_,
+                     type);
+      buffer_.drain(length + 1);
+      continue;
+    }
+
+    if (type == 'Z') {
+      if (messages.length() > 0) {
+        callbacks_->onServerData(messages);
+      }
+      Buffer::OwnedImpl ready_for_query;
+      ready_for_query.move(buffer_, length + 1);
+      const char status = length > 4 ? ready_for_query.peekInt<char>(5) : 'I';
+      // This may release the connection, attaching it to another client or returning it to the
+      // pool.
+      callbacks_->onServerReadyForQuery(ready_for_query, status);
+      continue;
+    }
+
+    messages.move(buffer_, length + 1);
+  }
+
+  if (messages.length() > 0 && callbacks_ != nullptr) {
+    callbacks_->onServerData(messages);
+  }
+}
+
+bool ServerConnectionImpl::onLoginMessage(char type, Buffer::Instance& message) {
+  switch (type) {
+  case 'R':
+    return onAuthenticationRequest(message);
+  case 'S': {
+    std::string name = readString(message);
+    std::string value = readString(message);
+    parameters_.emplace_back(std::move(name), std::move(value));
+    return true;
+  }
+  case 'E':
+    ENVOY_CONN_LOG(info, "postgres_proxy: server rejected login: {}", *connection_,
+                   message.toString());
+    onLoginFailure();
+    return false;
+  case 'Z':
+    ENVOY_CONN_LOG(debug, "postgres_proxy: server connection logged in", *connection_);
+    state_ = State::Ready;
+    scram_.reset();
+    parent_.onServerReady(*this);
+    return true;
+  default:
+    // BackendKeyData, NoticeResponse and NegotiateProtocolVersion carry nothing the pool needs.
+    return true;
+  }
+}
+
+bool ServerConnectionImpl::onAuthenticationRequest(Buffer::Instance& message) {
+  if (message.length() < 4) {
+    onLoginFailure();
+    return false;
+  }
+  const uint32_t code = message.peekBEInt<uint32_t>(0);
+  message.drain(4);
+
+  const PoolSettings& settings = *parent_.settings_;
+  switch (code) {
+  case AuthenticationOk:
+    return true;
+  case AuthenticationCleartextPassword:
+    sendMessage('p', absl::StrCat(settings.password_, absl::string_view("\0", 1)));
+    return true;
+  case AuthenticationMD5Password: {
+    if (message.length() < 4) {
+      break;
+    }
+    const std::string salt = message.toString().substr(0, 4);
+    sendMessage('p', absl::StrCat(Auth::md5Password(settings.username_, settings.password_, salt),
+                                  absl::string_view("\0", 1)));
+    return true;
+  }
+  case AuthenticationSASL: {
+    bool scram_offered = false;
+    while (message.length() > 0) {
+      const std::string mechanism = readString(message);
+      if (mechanism == ScramSha256Client::Mechanism) {
+        scram_offered = true;
+      }
+    }
+    if (!scram_offered) {
+      break;
+    }
+    // Postgres takes the user name from the startup message.
+    scram_ = std::make_unique<ScramSha256Client>("", settings.password_, parent_.nonce());
+    const std::string first = scram_->clientFirstMessage();
+    Buffer::OwnedImpl payload;
+    payload.add(ScramSha256Client::Mechanism);
+    payload.writeBEInt<uint8_t>(0);
+    payload.writeBEInt<uint32_t>(first.size());
+    payload.add(first);
+    sendMessage('p', payload.toString());
+    return true;
+  }
+  case AuthenticationSASLContinue: {
+    if (scram_ == nullptr) {
+      break;
+    }
+    const absl::optional<std::string> final_message =
+        scram_->clientFinalMessage(message.toString());
+    if (!final_message.has_value()) {
+      break;
+    }
+    sendMessage('p', final_message.value());
+    return true;
+  }
+  case AuthenticationSASLFinal:
+    if (scram_ == nullptr || !scram_->verifyServerFinal(message.toString())) {
+      break;
+    }
+    return true;
+  default:
+    break;
+  }
+
+  ENVOY_CONN_LOG(info, "postgres_proxy: unsupported or failed server authentication (code {})",
+                 *connection_, code);
+  onLoginFailure();
+  return false;
+}
+
+void ServerConnectionImpl::sendStartupMessage() {
+  const PoolSettings& settings = *parent_.settings_;
+  Buffer::OwnedImpl parameters;
+  const auto add_parameter = [&parameters](absl::string_view name, absl::string_view value) {
+    parameters.add(name);
+    parameters.writeBEInt<uint8_t>(0);
+    parameters.add(value);
+    parameters.writeBEInt<uint8_t>(0);
+  };
+  add_parameter("user", settings.username_);
+  add_parameter("database", settings.database_);
+  parameters.writeBEInt<uint8_t>(0);
+
+  Buffer::OwnedImpl startup;
+  startup.writeBEInt<uint32_t>(8 + parameters.length());
+  startup.writeBEInt<uint32_t>(ProtocolVersion);
+  startup.move(parameters);
+  connection_->write(startup, false);
+}
+
+void ServerConnectionImpl::sendMessage(char type, absl::string_view payload) {
+  Buffer::OwnedImpl message;
+  message.writeBEInt<char>(type);
+  message.writeBEInt<uint32_t>(4 + payload.size());
+  message.add(payload);
+  connection_->write(message, false);
+}
+
+void ServerConnectionImpl::onLoginFailure() {
+  parent_.settings_->stats_.server_login_failures_.inc();
+  close();
+}
+
+InstanceImpl::InstanceImpl(PoolSettingsSharedPtr settings,
+                           Upstream::ClusterManager& cluster_manager,
+                           Event::Dispatcher& dispatcher, Random::RandomGenerator& random)
+    : settings_(std::move(settings)), cluster_manager_(cluster_manager), dispatcher_(dispatcher),
+      random_(random) {}
+
+InstanceImpl::~InstanceImpl() {
+  PoolStats& stats = settings_->stats_;
+  stats.server_connections_active_.sub(serverConnections());
+  stats.server_connections_idle_.sub(idle_.size());
+  stats.leases_pending_.sub(pending_.size());
+}
+
+void InstanceImpl::acquire(PoolCallbacks& callbacks) {
+  PoolStats& stats = settings_->stats_;
+  stats.leases_.inc();
+  pending_.push_back(&callbacks);
+  stats.leases_pending_.inc();
+
+  if (!idle_.empty()) {
+    stats.server_connections_idle_.dec();
+    lease(*idle_.front(), idle_);
+    return;
+  }
+
+  stats.lease_waits_.inc();
+  maybeConnect();
+}
+
+void InstanceImpl::cancel(PoolCallbacks& callbacks) {
+  const auto it = std::find(pending_.begin(), pending_.end(), &callbacks);
+  if (it != pending_.end()) {
+    pending_.erase(it);
+    settings_->stats_.leases_pending_.dec();
+  }
+}
+
+void InstanceImpl::release(ServerConnection& connection, bool reusable) {
+  auto& server = static_cast<ServerConnectionImpl&>(connection);
+  ASSERT(server.leased_);
+  server.callbacks_ = nullptr;
+
+  if (!reusable || !server.ready()) {
+    // Closing the connection removes it from the pool.
+    server.close();
+    return;
+  }
+
+  if (!pending_.empty()) {
+    PoolCallbacks* callbacks = pending_.front();
+    pending_.pop_front();
+    settings_->stats_.leases_pending_.dec();
+    callbacks->onPoolReady(server);
+    return;
+  }
+
+  server.leased_ = false;
+  server.moveBetweenLists(busy_, idle_);
+  settings_->stats_.server_connections_idle_.inc();
+}
+
+void InstanceImpl::onServerReady(ServerConnectionImpl& connection) {
+  if (!pending_.empty()) {
+    lease(connection, connecting_);
+    return;
+  }
+  connection.moveBetweenLists(connecting_, idle_);
+  settings_->stats_.server_connections_idle_.inc();
+}
+
+void InstanceImpl::onServerClose(ServerConnectionImpl& connection, bool was_ready) {
+  PoolStats& stats = settings_->stats_;
+  std::list<ServerConnectionImplPtr>& list =
+      !was_ready ? connecting_ : (connection.leased_ ? busy_ : idle_);
+  if (was_ready && !connection.leased_) {
+    stats.server_connections_idle_.dec();
+  }
+  stats.server_connections_active_.dec();
+  dispatcher_.deferredDelete(connection.removeFromList(list));
+
+  if (connection.leased_ && connection.callbacks_ != nullptr) {
+    ServerConnectionCallbacks* callbacks = connection.callbacks_;
+    connection.callbacks_ = nullptr;
+    callbacks->onServerClose();
+  }
+
+  if (was_ready) {
+    // A slot was freed for the clients that are waiting.
+    maybeConnect();
+  } else {
+    failPendingIfUnserved();
+  }
+}
+
+void InstanceImpl::lease(ServerConnectionImpl& connection,
+                         std::list<ServerConnectionImplPtr>& from) {
+  ASSERT(!pending_.empty());
+  connection.leased_ = true;
+  connection.moveBetweenLists(from, busy_);
+  PoolCallbacks* callbacks = pending_.front();
+  pending_.pop_front();
+  settings_->stats_.leases_pending_.dec();
+  callbacks->onPoolReady(connection);
+}
+
+void InstanceImpl::maybeConnect() {
+  PoolStats& stats = settings_->stats_;
+  while (pending_.size() > connecting_.size() &&
+         serverConnections() < settings_->max_server_connections_) {
+    Upstream::ThreadLocalCluster* cluster =
+        cluster_manager_.getThreadLocalCluster(settings_->cluster_);
+    if (cluster == nullptr) {
+      ENVOY_LOG(debug, "postgres_proxy: unknown cluster '{}'", settings_->cluster_);
+      failPendingIfUnserved();
+      return;
+    }
+    Upstream::Host::CreateConnectionData data = cluster->tcpConn(nullptr);
+    if (data.connection_ == nullptr) {
+      ENVOY_LOG(debug, "postgres_proxy: no healthy host in cluster '{}'", settings_->cluster_);
+      stats.server_connect_failures_.inc();
+      failPendingIfUnserved();
+      return;
+    }
+    stats.server_connections_.inc();
+    stats.server_connections_active_.inc();
+    LinkedList::moveIntoListBack(
+        std::make_unique<ServerConnectionImpl>(*this, std::move(data.connection_)), connecting_);
+  }
+}
+
+void InstanceImpl::failPendingIfUnserved() {
+  // Waiting clients are served by connections that are logging in or returned by other clients.
+  // Without any, they would wait forever.
+  if (serverConnections() > 0) {
+    return;
+  }
+  while (!pending_.empty()) {
+    PoolCallbacks* callbacks = pending_.front();
+    pending_.pop_front();
+    settings_->stats_.leases_pending_.dec();
+    settings_->stats_.lease_failures_.inc();
+    callbacks->onPoolFailure();
+  }
+}
+
+std::string InstanceImpl::salt() {
+  const uint32_t value = random_.random();
+  return std::string(reinterpret_cast<const char*>(&value), Auth::Md5SaltLength);
+}
+
+std::string InstanceImpl::nonce() {
+  uint64_t random[3];
+  for (uint64_t& value : random) {
+    value = random_.random();
+  }
+  return Base64::encode(reinterpret_cast<const char*>(random), sizeof(random));
+}
+
+} // namespace ConnPool
+} // namespace PostgresProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "envoy/common/random_generator.h"
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/network/connection.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local_object.h"
+#include "envoy/upstream/cluster_manager.h"
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/common/linked_object.h"
+#include "source/common/common/logger.h"
+#include "source/common/network/filter_impl.h"
+
+#include "absl/types/optional.h"
+#include "contrib/postgres_proxy/filters/network/source/postgres_auth.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace PostgresProxy {
+namespace ConnPool {
+
+/**
+ * All Postgres transaction pool stats. @see stats_macros.h
+ */
+#define ALL_POSTGRES_POOL_STATS(COUNTER, GAUGE)                                                    \
+  COUNTER(server_connections)                                                                      \
+  COUNTER(server_connect_failures)                                                                 \
+  COUNTER(server_login_failures)                                                                   \
+  COUNTER(leases)                                                                                  \
+  COUNTER(lease_waits)                                                                             \
+  COUNTER(lease_failures)                                                                          \
+  GAUGE(server_connections_active, Accumulate)                                                     \
+  GAUGE(server_connections_idle, Accumulate)                                                       \
+  GAUGE(leases_pending, Accumulate)
+
+/**
+ * Struct definition for all Postgres transaction pool stats. @see stats_macros.h
+ */
+struct PoolStats {
+  ALL_POSTGRES_POOL_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * Transaction pool settings, shared by the pools of all workers.
+ */
+struct PoolSettings {
+  PoolSettings(std::string cluster, std::string username, std::string password,
+               std::string database, uint32_t max_server_connections, Stats::Scope& scope,
+               const std::string& stats_prefix);
+
+  const std::string cluster_;
+  const std::string username_;
+  const std::string password_;
+  const std::string database_;
+  const uint32_t max_server_connections_;
+  PoolStats stats_;
+};
+
+using PoolSettingsSharedPtr = std::shared_ptr<PoolSettings>;
+
+/**
+ * A run time parameter reported by the server in a ParameterStatus message.
+ */
+using ServerParameters = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * Callbacks of the client that leased a server connection.
+ */
+class ServerConnectionCallbacks {
+public:
+  virtual ~ServerConnectionCallbacks() = default;
+
+  /**
+   * Called with complete server messages to be forwarded to the client.
+   */
+  virtual void onServerData(Buffer::Instance& data) PURE;
+
+  /**
+   * Called after the messages preceding a ReadyForQuery message were passed to onServerData(),
+   * with the ReadyForQuery message itself. The callbacks may release the connection.
+   * @param data supplies the ReadyForQuery message.
+   * @param status supplies the transaction status: 'I' (idle), 'T' (in a transaction) or 'E'
+   *        (in a failed transaction).
+   */
+  virtual void onServerReadyForQuery(Buffer::Instance& data, char status) PURE;
+
+  /**
+   * Called if the server connection is lost while leased. The connection must not be used or
+   * released afterwards.
+   */
+  virtual void onServerClose() PURE;
+};
+
+/**
+ * A logged in connection to a Postgres server.
+ */
+class ServerConnection {
+public:
+  virtual ~ServerConnection() = default;
+
+  /**
+   * Sets the callbacks of the client that leased the connection.
+   */
+  virtual void attach(ServerConnectionCallbacks& callbacks) PURE;
+
+  /**
+   * Sends client messages to the server.
+   */
+  virtual void write(Buffer::Instance& data) PURE;
+
+  /**
+   * @return the parameters reported by the server while logging in.
+   */
+  virtual const ServerParameters& parameters() const PURE;
+};
+
+/**
+ * Callbacks for a lease request.
+ */
+class PoolCallbacks {
+public:
+  virtual ~PoolCallbacks() = default;
+
+  /**
+   * Called when a server connection has been leased to the client.
+   */
+  virtual void onPoolReady(ServerConnection& connection) PURE;
+
+  /**
+   * Called when no server connection could be leased.
+   */
+  virtual void onPoolFailure() PURE;
+};
+
+/**
+ * A per worker pool of server connections that clients lease for the duration of a transaction.
+ */
+class Instance {
+public:
+  virtual ~Instance() = default;
+
+  /**
+   * Leases a server connection. The callbacks may be invoked before the call returns.
+   */
+  virtual void acquire(PoolCallbacks& callbacks) PURE;
+
+  /**
+   * Cancels a lease request that has not completed yet.
+   */
+  virtual void cancel(PoolCallbacks& callbacks) PURE;
+
+  /**
+   * Returns a leased connection.
+   * @param reusable supplies whether the connection may be leased again. A connection returned
+   *        in the middle of a transaction must be closed.
+   */
+  virtual void release(ServerConnection& connection, bool reusable) PURE;
+
+  /**
+   * @return a random salt for the MD5 password challenge of a client.
+   */
+  virtual std::string salt() PURE;
+
+  /**
+   * @return the settings of the pool.
+   */
+  virtual const PoolSettings& settings() const PURE;
+};
+
+class InstanceImpl;
+
+/**
+ * A server connection owned by InstanceImpl. It logs in with the configured credentials before it
+ * is leased for the first time.
+ */
+class ServerConnectionImpl : public ServerConnection,
+                             public Network::ConnectionCallbacks,
+                             public Event::DeferredDeletable,
+                             public LinkedObject<ServerConnectionImpl>,
+                             Logger::Loggable<Logger::Id::filter> {
+public:
+  ServerConnectionImpl(InstanceImpl& parent, Network::ClientConnectionPtr&& connection);
+  ~ServerConnectionImpl() override;
+
+  void close();
+  bool ready() const { return state_ == State::Ready; }
+
+  // ServerConnection
+  void attach(ServerConnectionCallbacks& callbacks) override { callbacks_ = &callbacks; }
+  void write(Buffer::Instance& data) override;
+  const ServerParameters& parameters() const override { return parameters_; }
+
+  // Network::ConnectionCallbacks
+  void onEvent(Network::ConnectionEvent event) override;
+  void onAboveWriteBufferHighWatermark() override {}
+  void onBelowWriteBufferLowWatermark() override {}
+
+private:
+  friend class InstanceImpl;
+
+  struct UpstreamReadFilter : public Network::ReadFilterBaseImpl {
+    UpstreamReadFilter(ServerConnectionImpl& parent) : parent_(parent) {}
+
+    // Network::ReadFilter
+    Network::FilterStatus onData(Buffer::Instance& data, bool) override {
+      parent_.onData(data);
+      return Network::FilterStatus::StopIteration;
+    }
+
+    ServerConnectionImpl& parent_;
+  };
+
+  enum class State { Connecting, LoggingIn, Ready, Closed };
+
+  void onData(Buffer::Instance& data);
+  bool onLoginMessage(char type, Buffer::Instance& message);
+  bool onAuthenticationRequest(Buffer::Instance& message);
+  void sendStartupMessage();
+  void sendMessage(char type, absl::string_view payload);
+  void onLoginFailure();
+
+  InstanceImpl& parent_;
+  Network::ClientConnectionPtr connection_;
+  Buffer::OwnedImpl buffer_;
+  ServerConnectionCallbacks* callbacks_{};
+  State state_{State::Connecting};
+  // Set while the connection is in the busy list of the pool.
+  bool leased_{};
+  ServerParameters parameters_;
+  std::unique_ptr<ScramSha256Client> scram_;
+};
+
+using ServerConnectionImplPtr = std::unique_ptr<ServerConnectionImpl>;
+
+class InstanceImpl : public Instance,
+                     public ThreadLocal::ThreadLocalObject,
+                     Logger::Loggable<Logger::Id::filter> {
+public:
+  InstanceImpl(PoolSettingsSharedPtr settings, Upstream::ClusterManager& cluster_manager,
+               Event::Dispatcher& dispatcher, Random::RandomGenerator& random);
+  ~InstanceImpl() override;
+
+  // ConnPool::Instance
+  void acquire(PoolCallbacks& callbacks) override;
+  void cancel(PoolCallbacks& callbacks) override;
+  void release(ServerConnection& connection, bool reusable) override;
+  std::string salt() override;
+  const PoolSettings& settings() const override { return *settings_; }
+
+  uint64_t serverConnections() const { return connecting_.size() + idle_.size() + busy_.size(); }
+
+private:
+  friend class ServerConnectionImpl;
+
+  void onServerReady(ServerConnectionImpl& connection);
+  void onServerClose(ServerConnectionImpl& connection, bool was_ready);
+  void lease(ServerConnectionImpl& connection, std::list<ServerConnectionImplPtr>& from);
+  void maybeConnect();
+  void failPendingIfUnserved();
+  std::string nonce();
+
+  const PoolSettingsSharedPtr settings_;
+  Upstream::ClusterManager& cluster_manager_;
+  Event::Dispatcher& dispatcher_;
+  Random::RandomGenerator& random_;
+  // Connections that are logging in, idle in the pool and leased to a client.
+  std::list<ServerConnectionImplPtr> connecting_;
+  std::list<ServerConnectionImplPtr> idle_;
+  std::list<ServerConnectionImplPtr> busy_;
+  std::list<PoolCallbacks*> pending_;
+};
+
+} // namespace ConnPool
+} // namespace PostgresProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
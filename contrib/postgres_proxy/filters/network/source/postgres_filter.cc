@@ -6,6 +6,7 @@
 #include "source/common/common/assert.h"
 #include "source/extensions/filters/network/well_known_names.h"
 
+#include "contrib/postgres_proxy/filters/network/source/postgres_auth.h"
 #include "contrib/postgres_proxy/filters/network/source/postgres_decoder.h"
 
 namespace Envoy {
@@ -13,13 +14,38 @@ namespace Extensions {
 namespace NetworkFilters {
 namespace PostgresProxy {
 
+namespace {
+
+// Codes carried by the untyped messages a client may open a connection with.
+constexpr uint32_t ProtocolVersion = 0x00030000;
+constexpr uint32_t CancelRequestCode = 80877102;
+constexpr uint32_t SSLRequestCode = 80877103;
+constexpr uint32_t GSSENCRequestCode = 80877104;
+
+// Same limit as MAX_STARTUP_PACKET_LENGTH in the Postgres sources.
+constexpr uint32_t MaxStartupPacketLength = 10000;
+
+void addMessage(Buffer::Instance& data, char type, const Buffer::Instance& payload) {
+  data.writeBEInt<char>(type);
+  data.writeBEInt<uint32_t>(4 + payload.length());
+  data.add(payload);
+}
+
+void addString(Buffer::Instance& data, absl::string_view value) {
+  data.add(value);
+  data.writeBEInt<uint8_t>(0);
+}
+
+} // namespace
+
 PostgresFilterConfig::PostgresFilterConfig(const PostgresFilterConfigOptions& config_options,
                                            Stats::Scope& scope)
     : enable_sql_parsing_(config_options.enable_sql_parsing_),
       terminate_ssl_(config_options.terminate_ssl_), upstream_ssl_(config_options.upstream_ssl_),
       scope_{scope}, stats_{generateStats(config_options.stats_prefix_, scope)} {}
 
-PostgresFilter::PostgresFilter(PostgresFilterConfigSharedPtr config) : config_{config} {
+PostgresFilter::PostgresFilter(PostgresFilterConfigSharedPtr config, ConnPool::Instance* pool)
+    : config_{config}, pool_{pool} {
   if (!decoder_) {
     decoder_ = createDecoder(this);
   }
@@ -37,6 +63,16 @@ Network::FilterStatus PostgresFilter::onData(Buffer::Instance& data, bool) {
     ASSERT(frontend_buffer_.length() == 0);
     data.drain(data.length());
   }
+
+  if (pool_ != nullptr) {
+    // In transaction pooling mode the filter is terminal and consumes all data.
+    if (result == Network::FilterStatus::Continue) {
+      client_buffer_.move(data);
+      onClientData();
+    }
+    data.drain(data.length());
+    return Network::FilterStatus::StopIteration;
+  }
   return result;
 }
 
@@ -44,6 +80,9 @@ Network::FilterStatus PostgresFilter::onNewConnection() { return Network::Filter
 
 void PostgresFilter::initializeReadFilterCallbacks(Network::ReadFilterCallbacks& callbacks) {
   read_callbacks_ = &callbacks;
+  if (pool_ != nullptr) {
+    read_callbacks_->connection().addConnectionCallbacks(*this);
+  }
 }
 
 void PostgresFilter::initializeWriteFilterCallbacks(Network::WriteFilterCallbacks& callbacks) {
@@ -201,14 +240,17 @@ void PostgresFilter::processQuery(const std::string& sql) {
 
 bool PostgresFilter::onSSLRequest() {
   if (!config_->terminate_ssl_) {
+    if (pool_ != nullptr) {
+      // There is no server to pass the request to. Tell the client to continue in clear-text.
+      sendClientByte('N');
+      return false;
+    }
     // Signal to the decoder to continue.
     return true;
   }
   // Send single bytes 'S' to indicate switch to TLS.
   // Refer to official documentation for protocol details:
   // https://www.postgresql.org/docs/current/protocol-flow.html
-  Buffer::OwnedImpl buf;
-  buf.add("S");
   // Add callback to be notified when the reply message has been
   // transmitted.
   read_callbacks_->connection().addBytesSentCallback([=](uint64_t bytes) -> bool {
@@ -233,7 +275,7 @@ bool PostgresFilter::onSSLRequest() {
     }
     return true;
   });
-  write_callbacks_->injectWriteDataToFilterChain(buf, false);
+  sendClientByte('S');
 
   return false;
 }
@@ -281,6 +323,305 @@ bool PostgresFilter::encryptUpstream(bool upstream_agreed, Buffer::Instance& dat
   return encrypted;
 }
 
+void PostgresFilter::onClientData() {
+  while (pooling_state_ == PoolingState::Startup ||
+         pooling_state_ == PoolingState::Authenticating || pooling_state_ == PoolingState::Ready) {
+    if (pooling_state_ == PoolingState::Startup) {
+      // Untyped messages: Int32 length, Int32 code and the payload.
+      if (client_buffer_.length() < 8) {
+        return;
+      }
+      const uint32_t length = client_buffer_.peekBEInt<uint32_t>(0);
+      if (length < 8 || length > MaxStartupPacketLength) {
+        closeClient("08P01", "invalid startup packet length");
+        return;
+      }
+      if (client_buffer_.length() < length) {
+        return;
+      }
+      const uint32_t code = client_buffer_.peekBEInt<uint32_t>(4);
+      Buffer::OwnedImpl message;
+      message.move(client_buffer_, length);
+      message.drain(8);
+      onClientStartup(code, message);
+      continue;
+    }
+
+    if (client_buffer_.length() < 5) {
+      break;
+    }
+    const char type = client_buffer_.peekInt<char>(0);
+    const uint32_t length = client_buffer_.peekBEInt<uint32_t>(1);
+    if (length < 4) {
+      closeClient("08P01", "invalid message length");
+      return;
+    }
+    if (client_buffer_.length() < length + 1) {
+      break;
+    }
+
+    if (pooling_state_ == PoolingState::Authenticating) {
+      Buffer::OwnedImpl message;
+      message.move(client_buffer_, length + 1);
+      message.drain(5);
+      onClientPassword(type, message);
+      continue;
+    }
+
+    if (type == 'X') {
+      // Terminate is not passed on, the server connection outlives the client.
+      client_buffer_.drain(length + 1);
+      pooling_state_ = PoolingState::Closed;
+      read_callbacks_->connection().close(Network::ConnectionCloseType::FlushWrite);
+      return;
+    }
+
+    switch (type) {
+    case 'Q': // Query
+    case 'F': // FunctionCall
+    case 'S': // Sync
+      outstanding_++;
+      unsynced_ = false;
+      break;
+    case 'd': // CopyData
+    case 'c': // CopyDone
+    case 'f': // CopyFail
+      // Part of the command that started the copy.
+      break;
+    default:
+      unsynced_ = true;
+      break;
+    }
+    pending_messages_.move(client_buffer_, length + 1);
+  }
+
+  if (pooling_state_ != PoolingState::Ready || pending_messages_.length() == 0) {
+    return;
+  }
+  if (server_ != nullptr) {
+    server_->write(pending_messages_);
+  } else if (!lease_requested_) {
+    lease_requested_ = true;
+    pool_->acquire(*this);
+  }
+}
+
+void PostgresFilter::onClientStartup(uint32_t code, Buffer::Instance& message) {
+  switch (code) {
+  case SSLRequestCode:
+  case GSSENCRequestCode:
+    // Only reached if SSL is not terminated. Encryption is declined, and the client continues
+    // in clear-text.
+    sendClientByte('N');
+    return;
+  case CancelRequestCode:
+    // Server processes are shared between clients. A cancel request could hit another client.
+    ENVOY_CONN_LOG(debug, "postgres_proxy: ignoring cancel request", read_callbacks_->connection());
+    pooling_state_ = PoolingState::Closed;
+    read_callbacks_->connection().close(Network::ConnectionCloseType::NoFlush);
+    return;
+  case ProtocolVersion:
+    break;
+  default:
+    closeClient("0A000", fmt::format("unsupported frontend protocol {}.{}", code >> 16,
+                                     code & 0xFFFF));
+    return;
+  }
+
+  // The payload is a list of null terminated names and values, ending with an empty name.
+  std::string parameters = message.toString();
+  std::string user;
+  std::string database;
+  for (size_t pos = 0; pos < parameters.size();) {
+    const size_t name_end = parameters.find('\0', pos);
+    if (name_end == std::string::npos || name_end == pos) {
+      break;
+    }
+    const size_t value_end = parameters.find('\0', name_end + 1);
+    if (value_end == std::string::npos) {
+      break;
+    }
+    const absl::string_view name(parameters.data() + pos, name_end - pos);
+    const absl::string_view value(parameters.data() + name_end + 1, value_end - name_end - 1);
+    if (name == "user") {
+      user = std::string(value);
+    } else if (name == "database") {
+      database = std::string(value);
+    }
+    pos = value_end + 1;
+  }
+  if (database.empty()) {
+    database = user;
+  }
+
+  const ConnPool::PoolSettings& settings = pool_->settings();
+  if (user != settings.username_) {
+    closeClient("28000", fmt::format("user \"{}\" is not served by this proxy", user));
+    return;
+  }
+  if (database != settings.database_) {
+    closeClient("3D000", fmt::format("database \"{}\" is not served by this proxy", database));
+    return;
+  }
+
+  // Clients are challenged with the password that server connections log in with, like the
+  // server would do with an md5 pg_hba.conf entry.
+  salt_ = pool_->salt();
+  Buffer::OwnedImpl payload;
+  // AuthenticationMD5Password.
+  payload.writeBEInt<uint32_t>(5);
+  payload.add(salt_);
+  Buffer::OwnedImpl request;
+  addMessage(request, 'R', payload);
+  pooling_state_ = PoolingState::Authenticating;
+  read_callbacks_->connection().write(request, false);
+}
+
+void PostgresFilter::onClientPassword(char type, Buffer::Instance& message) {
+  const ConnPool::PoolSettings& settings = pool_->settings();
+  if (type != 'p') {
+    closeClient("08P01", fmt::format("expected password response, got message type {}", type));
+    return;
+  }
+  // The PasswordMessage carries a null terminated string.
+  std::string response = message.toString();
+  if (response.empty() || response.back() != '\0') {
+    closeClient("08P01", "invalid password packet");
+    return;
+  }
+  response.pop_back();
+  if (!Auth::verifyMd5Password(settings.username_, settings.password_, salt_, response)) {
+    closeClient("28P01",
+                fmt::format("password authentication failed for user \"{}\"", settings.username_));
+    return;
+  }
+
+  // A server connection is leased once to learn the server parameters the client expects to be
+  // told about, like server_version and client_encoding.
+  pooling_state_ = PoolingState::LoggingIn;
+  lease_requested_ = true;
+  pool_->acquire(*this);
+}
+
+void PostgresFilter::sendClientByte(char byte) {
+  Buffer::OwnedImpl buf;
+  buf.writeBEInt<char>(byte);
+  write_callbacks_->injectWriteDataToFilterChain(buf, false);
+}
+
+void PostgresFilter::closeClient(absl::string_view code, absl::string_view message) {
+  ENVOY_CONN_LOG(debug, "postgres_proxy: closing client connection: {}",
+                 read_callbacks_->connection(), message);
+  Buffer::OwnedImpl fields;
+  fields.writeBEInt<char>('S');
+  addString(fields, "FATAL");
+  fields.writeBEInt<char>('V');
+  addString(fields, "FATAL");
+  fields.writeBEInt<char>('C');
+  addString(fields, code);
+  fields.writeBEInt<char>('M');
+  addString(fields, message);
+  fields.writeBEInt<uint8_t>(0);
+
+  Buffer::OwnedImpl error;
+  addMessage(error, 'E', fields);
+  pooling_state_ = PoolingState::Closed;
+  read_callbacks_->connection().write(error, false);
+  read_callbacks_->connection().close(Network::ConnectionCloseType::FlushWrite);
+}
+
+void PostgresFilter::releaseServer() {
+  ASSERT(server_ != nullptr);
+  ConnPool::ServerConnection* server = server_;
+  server_ = nullptr;
+  pool_->release(*server, serverIdle());
+}
+
+void PostgresFilter::onEvent(Network::ConnectionEvent event) {
+  if (event != Network::ConnectionEvent::RemoteClose &&
+      event != Network::ConnectionEvent::LocalClose) {
+    return;
+  }
+  pooling_state_ = PoolingState::Closed;
+  if (lease_requested_) {
+    lease_requested_ = false;
+    pool_->cancel(*this);
+  }
+  if (server_ != nullptr) {
+    // A server connection that is still leased is in the middle of a transaction or has results
+    // in flight, and is closed by the pool.
+    releaseServer();
+  }
+}
+
+void PostgresFilter::onPoolReady(ConnPool::ServerConnection& connection) {
+  lease_requested_ = false;
+  server_ = &connection;
+  server_->attach(*this);
+
+  if (pooling_state_ == PoolingState::LoggingIn) {
+    Buffer::OwnedImpl reply;
+    Buffer::OwnedImpl payload;
+    // AuthenticationOk.
+    payload.writeBEInt<uint32_t>(0);
+    addMessage(reply, 'R', payload);
+    for (const auto& [name, value] : server_->parameters()) {
+      payload.drain(payload.length());
+      addString(payload, name);
+      addString(payload, value);
+      addMessage(reply, 'S', payload);
+    }
+    // BackendKeyData. Cancel requests are not supported, the key only has to be present.
+    payload.drain(payload.length());
+    payload.writeBEInt<uint32_t>(static_cast<uint32_t>(read_callbacks_->connection().id()));
+    payload.writeBEInt<uint32_t>(0);
+    addMessage(reply, 'K', payload);
+    payload.drain(payload.length());
+    payload.writeBEInt<char>('I');
+    addMessage(reply, 'Z', payload);
+
+    releaseServer();
+    pooling_state_ = PoolingState::Ready;
+    read_callbacks_->connection().write(reply, false);
+    // Messages the client sent without waiting for ReadyForQuery.
+    onClientData();
+    return;
+  }
+
+  ENVOY_CONN_LOG(trace, "postgres_proxy: leased server connection", read_callbacks_->connection());
+  server_->write(pending_messages_);
+}
+
+void PostgresFilter::onPoolFailure() {
+  lease_requested_ = false;
+  closeClient("08006", "no server connection available");
+}
+
+void PostgresFilter::onServerData(Buffer::Instance& data) {
+  read_callbacks_->connection().write(data, false);
+}
+
+void PostgresFilter::onServerReadyForQuery(Buffer::Instance& data, char status) {
+  transaction_status_ = status;
+  if (outstanding_ > 0) {
+    outstanding_--;
+  }
+  read_callbacks_->connection().write(data, false);
+  if (server_ != nullptr && serverIdle()) {
+    ENVOY_CONN_LOG(trace, "postgres_proxy: returning server connection",
+                   read_callbacks_->connection());
+    releaseServer();
+  }
+}
+
+void PostgresFilter::onServerClose() {
+  server_ = nullptr;
+  if (pooling_state_ != PoolingState::Closed) {
+    pooling_state_ = PoolingState::Closed;
+    read_callbacks_->connection().close(Network::ConnectionCloseType::FlushWrite);
+  }
+}
+
 Network::FilterStatus PostgresFilter::doDecode(Buffer::Instance& data, bool frontend) {
   // Keep processing data until buffer is empty or decoder says
   // that it cannot process data in the buffer.
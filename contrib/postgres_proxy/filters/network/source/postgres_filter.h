@@ -4,11 +4,13 @@
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats.h"
 #include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
 
 #include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/logger.h"
 
 #include "contrib/envoy/extensions/filters/network/postgres_proxy/v3alpha/postgres_proxy.pb.h"
+#include "contrib/postgres_proxy/filters/network/source/postgres_conn_pool.h"
 #include "contrib/postgres_proxy/filters/network/source/postgres_decoder.h"
 
 namespace Envoy {
@@ -82,6 +84,14 @@ public:
           envoy::extensions::filters::network::postgres_proxy::v3alpha::PostgresProxy::DISABLE};
   Stats::Scope& scope_;
   PostgresProxyStats stats_;
+  // Per worker server connection pools. Only set in transaction pooling mode.
+  ThreadLocal::TypedSlotPtr<ConnPool::InstanceImpl> pools_;
+
+  /**
+   * @return the server connection pool of the current worker, or nullptr if transaction pooling
+   *         is not enabled.
+   */
+  ConnPool::Instance* pool() { return pools_ != nullptr ? &**pools_ : nullptr; }
 
 private:
   PostgresProxyStats generateStats(const std::string& prefix, Stats::Scope& scope) {
@@ -91,11 +101,21 @@ private:
 
 using PostgresFilterConfigSharedPtr = std::shared_ptr<PostgresFilterConfig>;
 
+/**
+ * Postgres proxy filter. By default it only decodes the traffic that passes through it on its way
+ * to a terminal filter like tcp_proxy. If a server connection pool is given, the filter terminates
+ * the protocol instead: it answers the startup of the client and sends the messages of each
+ * transaction over a server connection leased from the pool, which is returned to the pool once
+ * the server reports that no transaction is in progress.
+ */
 class PostgresFilter : public Network::Filter,
                        DecoderCallbacks,
+                       public Network::ConnectionCallbacks,
+                       public ConnPool::PoolCallbacks,
+                       public ConnPool::ServerConnectionCallbacks,
                        Logger::Loggable<Logger::Id::filter> {
 public:
-  PostgresFilter(PostgresFilterConfigSharedPtr config);
+  PostgresFilter(PostgresFilterConfigSharedPtr config, ConnPool::Instance* pool = nullptr);
   ~PostgresFilter() override = default;
 
   // Network::ReadFilter
@@ -125,6 +145,20 @@ public:
   void sendUpstream(Buffer::Instance&) override;
   bool encryptUpstream(bool, Buffer::Instance&) override;
 
+  // Network::ConnectionCallbacks
+  void onEvent(Network::ConnectionEvent event) override;
+  void onAboveWriteBufferHighWatermark() override {}
+  void onBelowWriteBufferLowWatermark() override {}
+
+  // ConnPool::PoolCallbacks
+  void onPoolReady(ConnPool::ServerConnection& connection) override;
+  void onPoolFailure() override;
+
+  // ConnPool::ServerConnectionCallbacks
+  void onServerData(Buffer::Instance& data) override;
+  void onServerReadyForQuery(Buffer::Instance& data, char status) override;
+  void onServerClose() override;
+
   Network::FilterStatus doDecode(Buffer::Instance& data, bool);
   DecoderPtr createDecoder(DecoderCallbacks* callbacks);
   void setDecoder(std::unique_ptr<Decoder> decoder) { decoder_ = std::move(decoder); }
@@ -138,12 +172,40 @@ public:
   const PostgresFilterConfigSharedPtr& getConfig() const { return config_; }
 
 private:
+  // Progress of a client in transaction pooling mode.
+  enum class PoolingState { Startup, Authenticating, LoggingIn, Ready, Closed };
+
+  void onClientData();
+  void onClientStartup(uint32_t code, Buffer::Instance& message);
+  void onClientPassword(char type, Buffer::Instance& message);
+  void sendClientByte(char byte);
+  void closeClient(absl::string_view code, absl::string_view message);
+  void releaseServer();
+  bool serverIdle() const { return outstanding_ == 0 && !unsynced_ && transaction_status_ == 'I'; }
+
   Network::ReadFilterCallbacks* read_callbacks_{};
   Network::WriteFilterCallbacks* write_callbacks_{};
   PostgresFilterConfigSharedPtr config_;
   Buffer::OwnedImpl frontend_buffer_;
   Buffer::OwnedImpl backend_buffer_;
   std::unique_ptr<Decoder> decoder_;
+
+  ConnPool::Instance* pool_{};
+  PoolingState pooling_state_{PoolingState::Startup};
+  // Salt of the MD5 password challenge sent to the client.
+  std::string salt_;
+  // Client bytes that do not form a complete message yet.
+  Buffer::OwnedImpl client_buffer_;
+  // Client messages waiting for a server connection to be leased.
+  Buffer::OwnedImpl pending_messages_;
+  ConnPool::ServerConnection* server_{};
+  bool lease_requested_{};
+  // Number of messages sent to the server that are answered by ReadyForQuery (Query, Sync and
+  // FunctionCall) and whose ReadyForQuery has not arrived yet.
+  uint32_t outstanding_{};
+  // Whether extended query messages were sent to the server after the last Sync.
+  bool unsynced_{};
+  char transaction_status_{'I'};
 };
 
 } // namespace PostgresProxy
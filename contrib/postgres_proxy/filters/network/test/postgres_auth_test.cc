@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include "contrib/postgres_proxy/filters/network/source/postgres_auth.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace PostgresProxy {
+
+TEST(PostgresAuthTest, Md5Password) {
+  EXPECT_EQ("md5bb41a296aab6baccb36ff243a562abff",
+            Auth::md5Password("postgres", "secret", absl::string_view("\x01\x02\x03\x04", 4)));
+}
+
+TEST(PostgresAuthTest, VerifyMd5Password) {
+  const absl::string_view salt("\x01\x02\x03\x04", 4);
+  EXPECT_TRUE(
+      Auth::verifyMd5Password("postgres", "secret", salt, "md5bb41a296aab6baccb36ff243a562abff"));
+  EXPECT_FALSE(
+      Auth::verifyMd5Password("postgres", "other", salt, "md5bb41a296aab6baccb36ff243a562abff"));
+  EXPECT_FALSE(Auth::verifyMd5Password("postgres", "secret", salt, "md5bb41a296aab6"));
+  EXPECT_FALSE(Auth::verifyMd5Password("postgres", "secret", salt, ""));
+}
+
+// Test vector from RFC 7677, section 3.
+TEST(PostgresAuthTest, ScramSha256) {
+  ScramSha256Client client("user", "pencil", "rOprNGfwEbeRWgbNEkqO");
+  EXPECT_EQ("n,,n=user,r=rOprNGfwEbeRWgbNEkqO", client.clientFirstMessage());
+  EXPECT_FALSE(client.verifyServerFinal("v=6rriTRBi23WpRR/wtup+mMhUZUn/dB5nLTJRsjl95G4="));
+
+  const auto final_message = client.clientFinalMessage(
+      "r=rOprNGfwEbeRWgbNEkqO%hvYDpWUa2RaTCAfuxFIlj)hNlF$k0,s=W22ZaJ0SNY7soEsUEjb6gQ==,i=4096");
+  ASSERT_TRUE(final_message.has_value());
+  EXPECT_EQ("c=biws,r=rOprNGfwEbeRWgbNEkqO%hvYDpWUa2RaTCAfuxFIlj)hNlF$k0,"
+            "p=dHzbZapWIk4jUhN+Ute9ytag9zjfMHgsqmmiz7AndVQ=",
+            final_message.value());
+
+  EXPECT_TRUE(client.verifyServerFinal("v=6rriTRBi23WpRR/wtup+mMhUZUn/dB5nLTJRsjl95G4="));
+  EXPECT_FALSE(client.verifyServerFinal("v=AAAATRBi23WpRR/wtup+mMhUZUn/dB5nLTJRsjl95G4="));
+  EXPECT_FALSE(client.verifyServerFinal("e=invalid-proof"));
+}
+
+TEST(PostgresAuthTest, ScramSha256InvalidServerFirst) {
+  ScramSha256Client client("", "pencil", "rOprNGfwEbeRWgbNEkqO");
+  // The server nonce must extend the client nonce.
+  EXPECT_FALSE(client.clientFinalMessage("r=other,s=W22ZaJ0SNY7soEsUEjb6gQ==,i=4096").has_value());
+  EXPECT_FALSE(
+      client.clientFinalMessage("r=rOprNGfwEbeRWgbNEkqO,s=W22ZaJ0SNY7soEsUEjb6gQ==,i=4096")
+          .has_value());
+  // Missing salt and invalid iteration counts.
+  EXPECT_FALSE(client.clientFinalMessage("r=rOprNGfwEbeRWgbNEkqOabc,i=4096").has_value());
+  EXPECT_FALSE(
+      client.clientFinalMessage("r=rOprNGfwEbeRWgbNEkqOabc,s=W22ZaJ0SNY7soEsUEjb6gQ==,i=x")
+          .has_value());
+  EXPECT_FALSE(
+      client.clientFinalMessage("r=rOprNGfwEbeRWgbNEkqOabc,s=W22ZaJ0SNY7soEsUEjb6gQ==,i=0")
+          .has_value());
+}
+
+} // namespace PostgresProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,396 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "source/common/stats/isolated_store_impl.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/upstream/cluster_manager.h"
+
+#include "contrib/postgres_proxy/filters/network/source/postgres_conn_pool.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace PostgresProxy {
+namespace ConnPool {
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::SaveArg;
+
+class MockPoolCallbacks : public PoolCallbacks {
+public:
+  MOCK_METHOD(void, onPoolReady, (ServerConnection & connection));
+  MOCK_METHOD(void, onPoolFailure, ());
+};
+
+class MockServerConnectionCallbacks : public ServerConnectionCallbacks {
+public:
+  void onServerData(Buffer::Instance& data) override { onServerData_(data.toString()); }
+  void onServerReadyForQuery(Buffer::Instance& data, char status) override {
+    onServerReadyForQuery_(data.toString(), status);
+  }
+
+  MOCK_METHOD(void, onServerData_, (std::string data));
+  MOCK_METHOD(void, onServerReadyForQuery_, (std::string data, char status));
+  MOCK_METHOD(void, onServerClose, ());
+};
+
+// Builds a typed protocol message.
+std::string message(char type, absl::string_view payload = "") {
+  Buffer::OwnedImpl data;
+  data.writeBEInt<char>(type);
+  data.writeBEInt<uint32_t>(4 + payload.size());
+  data.add(payload);
+  return data.toString();
+}
+
+std::string authentication(uint32_t code, absl::string_view data = "") {
+  Buffer::OwnedImpl payload;
+  payload.writeBEInt<uint32_t>(code);
+  payload.add(data);
+  return message('R', payload.toString());
+}
+
+std::string readyForQuery(char status) { return message('Z', std::string(1, status)); }
+
+class PostgresConnPoolTest : public testing::Test {
+public:
+  void setup(uint32_t max_server_connections = 2) {
+    cm_.initializeThreadLocalClusters({"postgres_cluster"});
+    settings_ = std::make_shared<PoolSettings>("postgres_cluster", "postgres", "secret", "db",
+                                               max_server_connections, *store_.rootScope(),
+                                               "pool");
+    pool_ = std::make_unique<InstanceImpl>(settings_, cm_, dispatcher_, random_);
+  }
+
+  Network::MockClientConnection* expectConnection() {
+    auto* connection = new NiceMock<Network::MockClientConnection>();
+    EXPECT_CALL(cm_.thread_local_cluster_, tcpConn_(_))
+        .WillOnce(Return(Upstream::MockHost::MockCreateConnectionData{connection, nullptr}));
+    EXPECT_CALL(*connection, addReadFilter(_)).WillOnce(SaveArg<0>(&read_filter_));
+    EXPECT_CALL(*connection, connect());
+    return connection;
+  }
+
+  void serverSends(const std::string& data) {
+    Buffer::OwnedImpl buffer(data);
+    read_filter_->onData(buffer, false);
+  }
+
+  // Connects a server connection and logs it in without a password.
+  void login(Network::MockClientConnection& connection) {
+    connection.raiseEvent(Network::ConnectionEvent::Connected);
+    serverSends(authentication(0) + message('S', absl::string_view("server_version\0"
+                                                                   "16.1\0",
+                                                                   20)) +
+                readyForQuery('I'));
+  }
+
+  uint64_t counter(const std::string& name) {
+    return store_.counterFromString("pool." + name).value();
+  }
+  uint64_t gauge(const std::string& name) {
+    return store_.gaugeFromString("pool." + name, Stats::Gauge::ImportMode::Accumulate).value();
+  }
+
+  Stats::IsolatedStoreImpl store_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  NiceMock<Upstream::MockClusterManager> cm_;
+  NiceMock<Random::MockRandomGenerator> random_{0};
+  PoolSettingsSharedPtr settings_;
+  std::unique_ptr<InstanceImpl> pool_;
+  Network::ReadFilterSharedPtr read_filter_;
+};
+
+TEST_F(PostgresConnPoolTest, LoginLeaseAndRelease) {
+  setup();
+  MockPoolCallbacks callbacks;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks);
+  EXPECT_EQ(1, gauge("leases_pending"));
+  EXPECT_EQ(1, gauge("server_connections_active"));
+
+  // The startup message carries the configured user and database.
+  std::string startup;
+  EXPECT_CALL(*connection, write(_, false))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) { startup = data.toString(); }));
+  connection->raiseEvent(Network::ConnectionEvent::Connected);
+  EXPECT_EQ(std::string("\0\0\0\x23\0\x03\0\0user\0postgres\0database\0db\0\0", 35), startup);
+
+  // MD5 password challenge.
+  std::string password;
+  EXPECT_CALL(*connection, write(_, false))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) { password = data.toString(); }));
+  serverSends(authentication(5, absl::string_view("\x01\x02\x03\x04", 4)));
+  EXPECT_EQ(message('p', absl::string_view("md5bb41a296aab6baccb36ff243a562abff\0", 36)),
+            password);
+
+  ServerConnection* server{};
+  EXPECT_CALL(callbacks, onPoolReady(_)).WillOnce(Invoke([&](ServerConnection& connection) {
+    server = &connection;
+  }));
+  serverSends(authentication(0) +
+              message('S', absl::string_view("client_encoding\0UTF8\0", 21)) +
+              message('K', std::string(8, 'k')) + readyForQuery('I'));
+  ASSERT_NE(nullptr, server);
+  ASSERT_EQ(1, server->parameters().size());
+  EXPECT_EQ("client_encoding", server->parameters()[0].first);
+  EXPECT_EQ("UTF8", server->parameters()[0].second);
+  EXPECT_EQ(0, gauge("leases_pending"));
+
+  // Messages before ReadyForQuery are forwarded in one batch.
+  MockServerConnectionCallbacks server_callbacks;
+  server->attach(server_callbacks);
+  EXPECT_CALL(*connection, write(_, false));
+  Buffer::OwnedImpl query(message('Q', absl::string_view("SELECT 1\0", 9)));
+  server->write(query);
+
+  const std::string results = message('T', "t") + message('D', "d") + message('C', "c");
+  EXPECT_CALL(server_callbacks, onServerData_(results));
+  EXPECT_CALL(server_callbacks, onServerReadyForQuery_(readyForQuery('I'), 'I'))
+      .WillOnce(Invoke([&](std::string, char) { pool_->release(*server, true); }));
+  serverSends(results + readyForQuery('I'));
+  EXPECT_EQ(1, gauge("server_connections_idle"));
+
+  // Messages received while the connection is idle are dropped.
+  serverSends(message('N', "notice"));
+
+  // The idle connection is leased again without connecting.
+  EXPECT_CALL(callbacks, onPoolReady(_));
+  pool_->acquire(callbacks);
+  EXPECT_EQ(0, gauge("server_connections_idle"));
+  EXPECT_EQ(2, counter("leases"));
+  EXPECT_EQ(1, counter("lease_waits"));
+  EXPECT_EQ(1, counter("server_connections"));
+}
+
+TEST_F(PostgresConnPoolTest, ScramLogin) {
+  setup();
+  MockPoolCallbacks callbacks;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks);
+  connection->raiseEvent(Network::ConnectionEvent::Connected);
+
+  // The nonce is derived from the random generator, which always returns 0.
+  std::string first;
+  EXPECT_CALL(*connection, write(_, false))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) { first = data.toString(); }));
+  serverSends(authentication(10, absl::string_view("SCRAM-SHA-256-PLUS\0SCRAM-SHA-256\0\0", 34)));
+  const std::string client_first = "n,,n=,r=AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA";
+  Buffer::OwnedImpl initial_response;
+  initial_response.add(absl::string_view("SCRAM-SHA-256\0", 14));
+  initial_response.writeBEInt<uint32_t>(client_first.size());
+  initial_response.add(client_first);
+  EXPECT_EQ(message('p', initial_response.toString()), first);
+
+  std::string final_message;
+  EXPECT_CALL(*connection, write(_, false))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) { final_message = data.toString(); }));
+  serverSends(authentication(11, "r=AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAserver,"
+                                 "s=MDEyMzQ1Njc4OWFiY2RlZg==,i=4096"));
+  EXPECT_EQ(message('p', "c=biws,r=AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAserver,"
+                         "p=Pxjiegh0yFinYpgNkuFe+DTgR6UFZWR7UycAk1iLVsM="),
+            final_message);
+
+  EXPECT_CALL(callbacks, onPoolReady(_));
+  serverSends(authentication(12, "v=0O7SdQnAabMy0xJkOGBAA91HTXYZlX8dBvquyYI9XtE=") +
+              authentication(0) + readyForQuery('I'));
+  EXPECT_EQ(0, counter("server_login_failures"));
+}
+
+TEST_F(PostgresConnPoolTest, ScramInvalidServerSignature) {
+  setup();
+  MockPoolCallbacks callbacks;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks);
+  connection->raiseEvent(Network::ConnectionEvent::Connected);
+  serverSends(authentication(10, absl::string_view("SCRAM-SHA-256\0\0", 15)));
+  serverSends(authentication(11, "r=AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAserver,"
+                                 "s=MDEyMzQ1Njc4OWFiY2RlZg==,i=4096"));
+
+  EXPECT_CALL(callbacks, onPoolFailure());
+  serverSends(authentication(12, "v=AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA="));
+  EXPECT_EQ(1, counter("server_login_failures"));
+  EXPECT_EQ(1, counter("lease_failures"));
+  EXPECT_EQ(0, gauge("server_connections_active"));
+}
+
+TEST_F(PostgresConnPoolTest, UnsupportedAuthentication) {
+  setup();
+  MockPoolCallbacks callbacks;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks);
+  connection->raiseEvent(Network::ConnectionEvent::Connected);
+
+  // Kerberos V5.
+  EXPECT_CALL(callbacks, onPoolFailure());
+  serverSends(authentication(2));
+  EXPECT_EQ(1, counter("server_login_failures"));
+}
+
+TEST_F(PostgresConnPoolTest, LoginRejected) {
+  setup();
+  MockPoolCallbacks callbacks;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks);
+  connection->raiseEvent(Network::ConnectionEvent::Connected);
+
+  EXPECT_CALL(callbacks, onPoolFailure());
+  serverSends(authentication(3) + message('E', "SFATAL"));
+  EXPECT_EQ(1, counter("server_login_failures"));
+}
+
+TEST_F(PostgresConnPoolTest, ConnectFailure) {
+  setup();
+  MockPoolCallbacks callbacks;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks);
+
+  EXPECT_CALL(callbacks, onPoolFailure());
+  connection->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_EQ(1, counter("server_connect_failures"));
+  EXPECT_EQ(0, gauge("leases_pending"));
+}
+
+TEST_F(PostgresConnPoolTest, UnknownCluster) {
+  setup();
+  MockPoolCallbacks callbacks;
+  EXPECT_CALL(cm_, getThreadLocalCluster(_)).WillOnce(Return(nullptr));
+  EXPECT_CALL(callbacks, onPoolFailure());
+  pool_->acquire(callbacks);
+  EXPECT_EQ(1, counter("lease_failures"));
+}
+
+TEST_F(PostgresConnPoolTest, NoHealthyHost) {
+  setup();
+  MockPoolCallbacks callbacks;
+  EXPECT_CALL(cm_.thread_local_cluster_, tcpConn_(_))
+      .WillOnce(Return(Upstream::MockHost::MockCreateConnectionData{nullptr, nullptr}));
+  EXPECT_CALL(callbacks, onPoolFailure());
+  pool_->acquire(callbacks);
+  EXPECT_EQ(1, counter("server_connect_failures"));
+}
+
+// Clients wait for a connection to be returned once the pool is full.
+TEST_F(PostgresConnPoolTest, WaitForRelease) {
+  setup(1);
+  MockPoolCallbacks callbacks1;
+  MockPoolCallbacks callbacks2;
+  MockPoolCallbacks callbacks3;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks1);
+  pool_->acquire(callbacks2);
+  pool_->acquire(callbacks3);
+  EXPECT_EQ(3, gauge("leases_pending"));
+
+  ServerConnection* server{};
+  EXPECT_CALL(callbacks1, onPoolReady(_)).WillOnce(Invoke([&](ServerConnection& connection) {
+    server = &connection;
+  }));
+  login(*connection);
+  ASSERT_NE(nullptr, server);
+
+  pool_->cancel(callbacks2);
+  EXPECT_EQ(1, gauge("leases_pending"));
+
+  EXPECT_CALL(callbacks3, onPoolReady(_));
+  pool_->release(*server, true);
+  EXPECT_EQ(0, gauge("leases_pending"));
+  EXPECT_EQ(0, gauge("server_connections_idle"));
+  EXPECT_EQ(1, counter("server_connections"));
+}
+
+// A connection returned in the middle of a transaction is closed and replaced.
+TEST_F(PostgresConnPoolTest, ReleaseNotReusable) {
+  setup(1);
+  MockPoolCallbacks callbacks1;
+  MockPoolCallbacks callbacks2;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks1);
+  pool_->acquire(callbacks2);
+
+  ServerConnection* server{};
+  EXPECT_CALL(callbacks1, onPoolReady(_)).WillOnce(Invoke([&](ServerConnection& connection) {
+    server = &connection;
+  }));
+  login(*connection);
+  ASSERT_NE(nullptr, server);
+
+  Network::MockClientConnection* connection2 = expectConnection();
+  EXPECT_CALL(*connection, close(_));
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  pool_->release(*server, false);
+  EXPECT_EQ(1, gauge("server_connections_active"));
+
+  EXPECT_CALL(callbacks2, onPoolReady(_));
+  login(*connection2);
+  EXPECT_EQ(2, counter("server_connections"));
+}
+
+TEST_F(PostgresConnPoolTest, ServerCloseWhileLeased) {
+  setup();
+  MockPoolCallbacks callbacks;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks);
+
+  ServerConnection* server{};
+  EXPECT_CALL(callbacks, onPoolReady(_)).WillOnce(Invoke([&](ServerConnection& connection) {
+    server = &connection;
+  }));
+  login(*connection);
+  ASSERT_NE(nullptr, server);
+
+  MockServerConnectionCallbacks server_callbacks;
+  server->attach(server_callbacks);
+  EXPECT_CALL(server_callbacks, onServerClose());
+  connection->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_EQ(0, gauge("server_connections_active"));
+}
+
+TEST_F(PostgresConnPoolTest, ServerCloseWhileIdle) {
+  setup();
+  MockPoolCallbacks callbacks;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks);
+
+  ServerConnection* server{};
+  EXPECT_CALL(callbacks, onPoolReady(_)).WillOnce(Invoke([&](ServerConnection& connection) {
+    server = &connection;
+  }));
+  login(*connection);
+  pool_->release(*server, true);
+  EXPECT_EQ(1, gauge("server_connections_idle"));
+
+  connection->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_EQ(0, gauge("server_connections_idle"));
+  EXPECT_EQ(0, gauge("server_connections_active"));
+}
+
+// A server that sends an invalid message length is disconnected.
+TEST_F(PostgresConnPoolTest, InvalidMessageLength) {
+  setup();
+  MockPoolCallbacks callbacks;
+  Network::MockClientConnection* connection = expectConnection();
+  pool_->acquire(callbacks);
+  connection->raiseEvent(Network::ConnectionEvent::Connected);
+
+  EXPECT_CALL(callbacks, onPoolFailure());
+  serverSends(std::string("R\0\0\0\x01", 5));
+}
+
+TEST_F(PostgresConnPoolTest, Salt) {
+  setup();
+  // The random generator always returns 0.
+  EXPECT_EQ(std::string(Auth::Md5SaltLength, '\0'), pool_->salt());
+}
+
+} // namespace ConnPool
+} // namespace PostgresProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -7,6 +7,7 @@
 
 #include "test/mocks/network/mocks.h"
 
+#include "contrib/postgres_proxy/filters/network/source/postgres_auth.h"
 #include "contrib/postgres_proxy/filters/network/source/postgres_filter.h"
 #include "contrib/postgres_proxy/filters/network/test/postgres_test_utils.h"
 
@@ -15,6 +16,8 @@ namespace Extensions {
 namespace NetworkFilters {
 namespace PostgresProxy {
 
+using testing::Ref;
+using testing::Return;
 using testing::ReturnRef;
 using ::testing::WithArgs;
 
@@ -459,6 +462,299 @@ TEST_F(PostgresFilterTest, UpstreamSSLStats) {
   ASSERT_THAT(filter_->getStats().transactions_rollback_.value(), 0);
 }
 
+class MockPool : public ConnPool::Instance {
+public:
+  MOCK_METHOD(void, acquire, (ConnPool::PoolCallbacks & callbacks));
+  MOCK_METHOD(void, cancel, (ConnPool::PoolCallbacks & callbacks));
+  MOCK_METHOD(void, release, (ConnPool::ServerConnection & connection, bool reusable));
+  MOCK_METHOD(std::string, salt, ());
+  MOCK_METHOD(const ConnPool::PoolSettings&, settings, (), (const));
+};
+
+class MockServerConnection : public ConnPool::ServerConnection {
+public:
+  void write(Buffer::Instance& data) override {
+    write_(data.toString());
+    data.drain(data.length());
+  }
+
+  MOCK_METHOD(void, attach, (ConnPool::ServerConnectionCallbacks & callbacks));
+  MOCK_METHOD(void, write_, (std::string data));
+  MOCK_METHOD(const ConnPool::ServerParameters&, parameters, (), (const));
+};
+
+// Builds a typed protocol message.
+std::string message(char type, absl::string_view payload = "") {
+  Buffer::OwnedImpl data;
+  data.writeBEInt<char>(type);
+  data.writeBEInt<uint32_t>(4 + payload.size());
+  data.add(payload);
+  return data.toString();
+}
+
+// Fixture for the transaction pooling mode.
+class PostgresFilterPoolingTest : public ::testing::Test {
+public:
+  PostgresFilterPoolingTest() {
+    PostgresFilterConfig::PostgresFilterConfigOptions config_options{
+        stat_prefix_, true, false,
+        envoy::extensions::filters::network::postgres_proxy::v3alpha::
+            PostgresProxy_SSLMode_DISABLE};
+    config_ = std::make_shared<PostgresFilterConfig>(config_options, scope_);
+    filter_ = std::make_unique<PostgresFilter>(config_, &pool_);
+
+    ON_CALL(pool_, settings()).WillByDefault(Invoke([this]() -> const ConnPool::PoolSettings& {
+      return *settings_;
+    }));
+    ON_CALL(pool_, salt()).WillByDefault(Return(salt_));
+    ON_CALL(server_, parameters()).WillByDefault(ReturnRef(parameters_));
+    ON_CALL(read_callbacks_.connection_, write(_, _))
+        .WillByDefault(Invoke([this](Buffer::Instance& data, bool) {
+          client_received_.append(data.toString());
+          data.drain(data.length());
+        }));
+
+    EXPECT_CALL(read_callbacks_.connection_, addConnectionCallbacks(_));
+    filter_->initializeReadFilterCallbacks(read_callbacks_);
+    filter_->initializeWriteFilterCallbacks(write_callbacks_);
+  }
+
+  void clientSends(const std::string& data) {
+    Buffer::OwnedImpl buffer(data);
+    EXPECT_EQ(Network::FilterStatus::StopIteration, filter_->onData(buffer, false));
+    EXPECT_EQ(0, buffer.length());
+  }
+
+  // Sends the startup message and expects the MD5 password challenge.
+  void sendStartupMessage() {
+    EXPECT_CALL(pool_, acquire(_)).Times(0);
+    Buffer::OwnedImpl data;
+    createInitialPostgresRequest(data);
+    clientSends(data.toString());
+
+    Buffer::OwnedImpl challenge;
+    challenge.writeBEInt<uint32_t>(5);
+    challenge.add(salt_);
+    EXPECT_EQ(message('R', challenge.toString()), client_received_);
+    client_received_.clear();
+    testing::Mock::VerifyAndClearExpectations(&pool_);
+  }
+
+  // Answers the password challenge.
+  void sendPassword(absl::string_view password) {
+    clientSends(message('p', absl::StrCat(Auth::md5Password(settings_->username_, password, salt_),
+                                          absl::string_view("\0", 1))));
+  }
+
+  // Authenticates the client and leases a server connection to learn its parameters.
+  void startup() {
+    sendStartupMessage();
+
+    EXPECT_CALL(pool_, acquire(_)).WillOnce(Invoke([this](ConnPool::PoolCallbacks& callbacks) {
+      callbacks.onPoolReady(server_);
+    }));
+    EXPECT_CALL(server_, attach(_));
+    EXPECT_CALL(pool_, release(Ref(server_), true));
+    sendPassword("secret");
+
+    Buffer::OwnedImpl key;
+    key.writeBEInt<uint32_t>(read_callbacks_.connection_.id());
+    key.writeBEInt<uint32_t>(0);
+    const std::string expected = message('R', std::string(4, '\0')) +
+                                 message('S', absl::string_view("server_version\0"
+                                                                "16.1\0",
+                                                                20)) +
+                                 message('K', key.toString()) + message('Z', "I");
+    EXPECT_EQ(expected, client_received_);
+    client_received_.clear();
+  }
+
+  // Expects a lease for the next transaction.
+  void expectLease() {
+    EXPECT_CALL(pool_, acquire(_)).WillOnce(Invoke([this](ConnPool::PoolCallbacks& callbacks) {
+      callbacks.onPoolReady(server_);
+    }));
+    EXPECT_CALL(server_, attach(_));
+  }
+
+  void serverReadyForQuery(char status) {
+    Buffer::OwnedImpl data(message('Z', std::string(1, status)));
+    filter_->onServerReadyForQuery(data, status);
+  }
+
+  Stats::IsolatedStoreImpl store_;
+  Stats::Scope& scope_{*store_.rootScope()};
+  std::string stat_prefix_{"test."};
+  std::unique_ptr<ConnPool::PoolSettings> settings_{std::make_unique<ConnPool::PoolSettings>(
+      "cluster", "postgres", "secret", "postgres", 10, scope_, "pool")};
+  const std::string salt_{"\x01\x02\x03\x04"};
+  ConnPool::ServerParameters parameters_{{"server_version", "16.1"}};
+  NiceMock<MockPool> pool_;
+  NiceMock<MockServerConnection> server_;
+  PostgresFilterConfigSharedPtr config_;
+  std::unique_ptr<PostgresFilter> filter_;
+  NiceMock<Network::MockReadFilterCallbacks> read_callbacks_;
+  NiceMock<Network::MockWriteFilterCallbacks> write_callbacks_;
+  std::string client_received_;
+};
+
+// The server connection is leased for the duration of a transaction.
+TEST_F(PostgresFilterPoolingTest, Transaction) {
+  startup();
+
+  expectLease();
+  EXPECT_CALL(server_, write_(message('Q', "BEGIN")));
+  clientSends(message('Q', "BEGIN"));
+
+  Buffer::OwnedImpl complete(message('C', "BEGIN"));
+  filter_->onServerData(complete);
+  serverReadyForQuery('T');
+
+  // Still leased, the next statement goes straight to the server.
+  EXPECT_CALL(pool_, acquire(_)).Times(0);
+  EXPECT_CALL(server_, write_(message('Q', "COMMIT")));
+  clientSends(message('Q', "COMMIT"));
+
+  EXPECT_CALL(pool_, release(Ref(server_), true));
+  serverReadyForQuery('I');
+  EXPECT_EQ(message('C', "BEGIN") + message('Z', "T") + message('Z', "I"), client_received_);
+}
+
+// Pipelined extended query batches keep the lease until the last ReadyForQuery.
+TEST_F(PostgresFilterPoolingTest, ExtendedQuery) {
+  startup();
+
+  const std::string batch = message('P') + message('B') + message('E') + message('S');
+  expectLease();
+  EXPECT_CALL(server_, write_(batch + batch));
+  clientSends(batch + batch);
+
+  EXPECT_CALL(pool_, release(_, _)).Times(0);
+  serverReadyForQuery('I');
+
+  // Messages without a Sync keep the lease as well.
+  EXPECT_CALL(server_, write_(message('P') + message('H')));
+  clientSends(message('P') + message('H'));
+  serverReadyForQuery('I');
+
+  EXPECT_CALL(server_, write_(message('S')));
+  clientSends(message('S'));
+  EXPECT_CALL(pool_, release(Ref(server_), true));
+  serverReadyForQuery('I');
+}
+
+// Messages split across reads are forwarded once complete.
+TEST_F(PostgresFilterPoolingTest, PartialMessage) {
+  startup();
+
+  const std::string query = message('Q', "SELECT 1");
+  clientSends(query.substr(0, 7));
+
+  expectLease();
+  EXPECT_CALL(server_, write_(query));
+  clientSends(query.substr(7));
+}
+
+// A client that goes away in the middle of a transaction gives back an unusable connection.
+TEST_F(PostgresFilterPoolingTest, CloseInTransaction) {
+  startup();
+
+  expectLease();
+  clientSends(message('Q', "BEGIN"));
+  serverReadyForQuery('T');
+
+  EXPECT_CALL(pool_, release(Ref(server_), false));
+  filter_->onEvent(Network::ConnectionEvent::RemoteClose);
+}
+
+TEST_F(PostgresFilterPoolingTest, CloseWhileWaiting) {
+  startup();
+
+  EXPECT_CALL(pool_, acquire(_));
+  clientSends(message('Q', "SELECT 1"));
+
+  EXPECT_CALL(pool_, cancel(_));
+  filter_->onEvent(Network::ConnectionEvent::RemoteClose);
+}
+
+TEST_F(PostgresFilterPoolingTest, Terminate) {
+  startup();
+
+  EXPECT_CALL(pool_, acquire(_)).Times(0);
+  EXPECT_CALL(read_callbacks_.connection_, close(Network::ConnectionCloseType::FlushWrite));
+  clientSends(message('X'));
+}
+
+TEST_F(PostgresFilterPoolingTest, ServerClose) {
+  startup();
+
+  expectLease();
+  clientSends(message('Q', "SELECT pg_sleep(10)"));
+
+  EXPECT_CALL(read_callbacks_.connection_, close(Network::ConnectionCloseType::FlushWrite));
+  filter_->onServerClose();
+}
+
+TEST_F(PostgresFilterPoolingTest, PoolFailure) {
+  startup();
+
+  EXPECT_CALL(pool_, acquire(_)).WillOnce(Invoke([](ConnPool::PoolCallbacks& callbacks) {
+    callbacks.onPoolFailure();
+  }));
+  EXPECT_CALL(read_callbacks_.connection_, close(Network::ConnectionCloseType::FlushWrite));
+  clientSends(message('Q', "SELECT 1"));
+  EXPECT_THAT(client_received_, testing::HasSubstr("08006"));
+}
+
+TEST_F(PostgresFilterPoolingTest, UnknownUser) {
+  settings_ =
+      std::make_unique<ConnPool::PoolSettings>("cluster", "admin", "", "admin", 10, scope_, "pool");
+
+  EXPECT_CALL(pool_, acquire(_)).Times(0);
+  EXPECT_CALL(read_callbacks_.connection_, close(Network::ConnectionCloseType::FlushWrite));
+  Buffer::OwnedImpl data;
+  createInitialPostgresRequest(data);
+  clientSends(data.toString());
+  EXPECT_EQ('E', client_received_[0]);
+  EXPECT_THAT(client_received_, testing::HasSubstr("28000"));
+}
+
+// Clients that do not know the password are turned away before a server connection is leased.
+TEST_F(PostgresFilterPoolingTest, WrongPassword) {
+  sendStartupMessage();
+
+  EXPECT_CALL(pool_, acquire(_)).Times(0);
+  EXPECT_CALL(read_callbacks_.connection_, close(Network::ConnectionCloseType::FlushWrite));
+  sendPassword("wrong");
+  EXPECT_EQ('E', client_received_[0]);
+  EXPECT_THAT(client_received_, testing::HasSubstr("28P01"));
+}
+
+// Anything but a password response to the challenge closes the client.
+TEST_F(PostgresFilterPoolingTest, QueryBeforePassword) {
+  sendStartupMessage();
+
+  EXPECT_CALL(pool_, acquire(_)).Times(0);
+  EXPECT_CALL(read_callbacks_.connection_, close(Network::ConnectionCloseType::FlushWrite));
+  clientSends(message('Q', "SELECT 1"));
+  EXPECT_THAT(client_received_, testing::HasSubstr("08P01"));
+}
+
+// Encryption is declined when SSL is not terminated by the filter.
+TEST_F(PostgresFilterPoolingTest, DeclineSSL) {
+  Buffer::OwnedImpl buf;
+  EXPECT_CALL(write_callbacks_, injectWriteDataToFilterChain(_, false))
+      .WillOnce(testing::SaveArg<0>(&buf));
+  Buffer::OwnedImpl data;
+  data.writeBEInt<uint32_t>(8);
+  data.writeBEInt<uint32_t>(80877103); // SSL code.
+  clientSends(data.toString());
+  ASSERT_THAT('N', buf.peekBEInt<char>(0));
+
+  // The client continues with the startup message.
+  startup();
+}
+
 } // namespace PostgresProxy
 } // namespace NetworkFilters
 } // namespace Extensions
@@ -107,6 +107,9 @@ public:
   virtual void requestOnDemandUpdate(const std::string& type_url,
                                      const absl::flat_hash_set<std::string>& for_update) PURE;
 
+  virtual void requestOnDemandRemoval(const std::string& type_url,
+                                      const absl::flat_hash_set<std::string>& for_removal) PURE;
+
   /**
    * Returns an EdsResourcesCache for this GrpcMux if there is one.
    * @return EdsResourcesCacheOptRef optional eds resources cache for the gRPC-mux.
@@ -232,6 +232,14 @@ public:
    * @param add_these_names resource ids for inclusion in the discovery request.
    */
   virtual void requestOnDemandUpdate(const absl::flat_hash_set<std::string>& add_these_names) PURE;
+
+  /**
+   * Withdraws the interest in resources previously requested with requestOnDemandUpdate(), so
+   * the management server stops sending updates for them.
+   * @param remove_these_names resource ids for removal from the subscription.
+   */
+  virtual void
+  requestOnDemandRemoval(const absl::flat_hash_set<std::string>& remove_these_names) PURE;
 };
 
 using SubscriptionPtr = std::unique_ptr<Subscription>;
@@ -116,8 +116,8 @@ public:
   virtual void shutdownAll() PURE;
   virtual std::shared_ptr<GrpcMux>
   create(std::unique_ptr<Grpc::RawAsyncClient>&& async_client, Event::Dispatcher& dispatcher,
-         Random::RandomGenerator& random, Stats::Scope& scope,
-         const envoy::config::core::v3::ApiConfigSource& ads_config,
+         Random::RandomGenerator& random, Thread::ThreadFactory& thread_factory,
+         Stats::Scope& scope, const envoy::config::core::v3::ApiConfigSource& ads_config,
          const LocalInfo::LocalInfo& local_info,
          std::unique_ptr<CustomConfigValidators>&& config_validators,
          BackOffStrategyPtr&& backoff_strategy, OptRef<XdsConfigTracker> xds_config_tracker,
@@ -83,6 +83,15 @@ public:
    */
   virtual void onResourceLoadFailed(const XdsSourceId& source_id, const std::string& resource_name,
                                     const absl::optional<EnvoyException>& exception) PURE;
+
+  /**
+   * Returns whether the resources returned by getResources() should be loaded as soon as they are
+   * watched, and used until the xDS authority responds. Otherwise, they are only loaded if the
+   * connection to the xDS authority fails.
+   *
+   * @return true if the resources should be loaded on startup.
+   */
+  virtual bool loadOnStartup() const PURE;
 };
 
 using XdsResourcesDelegatePtr = std::unique_ptr<XdsResourcesDelegate>;
@@ -187,6 +187,20 @@ public:
   virtual void initializeStats(Stats::Scope& scope,
                                const absl::optional<std::string>& prefix = absl::nullopt) PURE;
 
+  /**
+   * Starts tracking the lag of the event loop, which is reported by loopLag(). This must be called
+   * on the thread of the dispatcher, or before its event loop runs.
+   */
+  virtual void enableLoopLagTracking() PURE;
+
+  /**
+   * @return the lag of the event loop, i.e. the longest of the duration and of the poll delay of
+   *         its iterations, averaged over its recent iterations; or zero if the lag isn't tracked.
+   *         This is the data behind the loop_duration_us and poll_delay_us stats. This is thread
+   *         safe and lock free.
+   */
+  virtual std::chrono::microseconds loopLag() const PURE;
+
   /**
    * Clears any items in the deferred deletion queue.
    */
@@ -39,16 +39,20 @@ public:
   // Overload action to reset streams using excessive memory.
   const std::string ResetStreams = "envoy.overload_actions.reset_high_memory_stream";
 
+  // Overload action to close idle or heavily buffered TCP proxy connections.
+  const std::string ShedTcpProxyConnections = "envoy.overload_actions.shed_tcp_proxy_connections";
+
   // This should be kept current with the Overload actions available.
   // This is the last member of this class to duplicating the strings with
   // proper lifetime guarantees.
-  const std::array<absl::string_view, 7> WellKnownActions = {StopAcceptingRequests,
+  const std::array<absl::string_view, 8> WellKnownActions = {StopAcceptingRequests,
                                                              DisableHttpKeepAlive,
                                                              StopAcceptingConnections,
                                                              RejectIncomingConnections,
                                                              ShrinkHeap,
                                                              ReduceTimeouts,
-                                                             ResetStreams};
+                                                             ResetStreams,
+                                                             ShedTcpProxyConnections};
 };
 
 using OverloadActionNames = ConstSingleton<OverloadActionNameValues>;
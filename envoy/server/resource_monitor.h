@@ -4,6 +4,7 @@
 
 #include "envoy/common/exception.h"
 #include "envoy/common/pure.h"
+#include "envoy/event/dispatcher.h"
 
 #include "source/common/common/assert.h"
 
@@ -54,5 +55,31 @@ public:
 
 using ResourceMonitorPtr = std::unique_ptr<ResourceMonitor>;
 
+/**
+ * A resource monitor whose resource is evaluated separately by each thread, e.g. the lag of the
+ * thread's event loop. Overload actions and load shed points triggered by such a resource are
+ * evaluated per thread, so that a single loaded worker can shed load on its own.
+ */
+class WorkerResourceMonitor {
+public:
+  virtual ~WorkerResourceMonitor() = default;
+
+  /**
+   * Called on each thread of the overload manager, including the main thread, before
+   * workerPressure() is called on it.
+   * @param dispatcher the dispatcher of the thread.
+   */
+  virtual void initializeWorker(Event::Dispatcher& dispatcher) PURE;
+
+  /**
+   * Called periodically on each thread of the overload manager. This must be non-blocking.
+   * @param dispatcher the dispatcher of the thread.
+   * @return the fraction of (resource usage)/(resource limit) of the thread.
+   */
+  virtual double workerPressure(Event::Dispatcher& dispatcher) PURE;
+};
+
+using WorkerResourceMonitorPtr = std::unique_ptr<WorkerResourceMonitor>;
+
 } // namespace Server
 } // namespace Envoy
@@ -85,6 +85,26 @@ public:
   std::string category() const override { return "envoy.resource_monitors"; }
 };
 
+class WorkerResourceMonitorFactory : public Config::TypedFactory {
+public:
+  ~WorkerResourceMonitorFactory() override = default;
+
+  /**
+   * Create a particular worker resource monitor implementation.
+   * @param config const ProtoBuf::Message& supplies the config for the worker resource monitor
+   *        implementation.
+   * @param context ResourceMonitorFactoryContext& supplies the resource monitor's context.
+   * @return WorkerResourceMonitorPtr the resource monitor instance. Should not be nullptr.
+   * @throw EnvoyException if the implementation is unable to produce an instance with
+   *        the provided parameters.
+   */
+  virtual WorkerResourceMonitorPtr
+  createWorkerResourceMonitor(const Protobuf::Message& config,
+                              ResourceMonitorFactoryContext& context) PURE;
+
+  std::string category() const override { return "envoy.resource_monitors"; }
+};
+
 } // namespace Configuration
 } // namespace Server
 } // namespace Envoy
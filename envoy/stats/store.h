@@ -257,6 +257,15 @@ public:
    */
   virtual void mergeHistograms(PostMergeCb merge_complete_cb) PURE;
 
+  /**
+   * Selects how thread local histograms record values. When lock_free is true, each worker
+   * records into fixed log-linear buckets held in atomics, and mergeHistograms() drains them on
+   * the main thread without posting to the workers. Must be called before any histogram is
+   * created.
+   * @param lock_free whether to use lock-free thread local histograms.
+   */
+  virtual void setLockFreeHistograms(bool lock_free) PURE;
+
   /**
    * Set predicates for filtering stats to be flushed to sinks.
    * Note that if the sink predicates object is set, we do not send non-sink stats over to the
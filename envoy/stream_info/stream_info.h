@@ -231,6 +231,7 @@ struct LocalCloseReasonValues {
   const std::string TcpProxyInitializationFailure = "tcp_initializion_failure:";
   const std::string TcpSessionIdleTimeout = "tcp_session_idle_timeout";
   const std::string MaxConnectionDurationReached = "max_connection_duration_reached";
+  const std::string TcpSessionShedByOverloadManager = "tcp_session_shed_by_overload_manager";
   const std::string ClosingUpstreamTcpDueToDownstreamRemoteClose =
       "closing_upstream_tcp_connection_due_to_downstream_remote_close";
   const std::string ClosingUpstreamTcpDueToDownstreamLocalClose =
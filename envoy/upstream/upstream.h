@@ -393,6 +393,28 @@ using LocalityWeights = std::vector<uint32_t>;
 using LocalityWeightsSharedPtr = std::shared_ptr<LocalityWeights>;
 using LocalityWeightsConstSharedPtr = std::shared_ptr<const LocalityWeights>;
 
+/**
+ * The change of a host set's host lists between two consecutive updates. It is computed once on
+ * the main thread and sent to the workers with the update, so that consumers such as load
+ * balancers can refresh in time proportional to the change rather than to the host set size.
+ */
+struct HostSetDelta {
+  // The lists the delta was computed against. It only applies to a host set whose lists are still
+  // exactly these; weak references so that a delta never extends the lifetime of old lists.
+  std::weak_ptr<const HostVector> previous_hosts_;
+  std::weak_ptr<const HealthyHostVector> previous_healthy_hosts_;
+  std::weak_ptr<const DegradedHostVector> previous_degraded_hosts_;
+
+  HostVector hosts_added_;
+  HostVector hosts_removed_;
+  HostVector healthy_hosts_added_;
+  HostVector healthy_hosts_removed_;
+  HostVector degraded_hosts_added_;
+  HostVector degraded_hosts_removed_;
+};
+
+using HostSetDeltaConstSharedPtr = std::shared_ptr<const HostSetDelta>;
+
 /**
  * Base host set interface. This contains all of the endpoints for a given LocalityLbEndpoints
  * priority level.
@@ -520,6 +542,13 @@ public:
    * @return true to use host weights to calculate the health of a priority.
    */
   virtual bool weightedPriorityHealth() const PURE;
+
+  /**
+   * @return the delta from the previous host lists to the current ones while the update callbacks
+   *         of an update that carried a matching delta run, or nullptr otherwise. Consumers that
+   *         get nullptr must refresh from the full host lists.
+   */
+  virtual const HostSetDelta* updateDelta() const PURE;
 };
 
 using HostSetPtr = std::unique_ptr<HostSet>;
@@ -584,6 +613,8 @@ public:
     HostsPerLocalityConstSharedPtr healthy_hosts_per_locality;
     HostsPerLocalityConstSharedPtr degraded_hosts_per_locality;
     HostsPerLocalityConstSharedPtr excluded_hosts_per_locality;
+    // Optional delta from the host set's current lists to these ones.
+    HostSetDeltaConstSharedPtr delta;
   };
 
   /**
@@ -0,0 +1,87 @@
+#include "source/common/common/arena.h"
+
+#include <new>
+
+#include "source/common/common/assert.h"
+
+namespace Envoy {
+
+thread_local absl::InlinedVector<Arena::Block, Arena::MaxFreeBlocks> Arena::free_blocks_;
+
+Arena::~Arena() {
+  for (Block& block : blocks_) {
+    if (free_blocks_.size() >= MaxFreeBlocks) {
+      break;
+    }
+    free_blocks_.push_back(std::move(block));
+  }
+}
+
+void* Arena::allocate(size_t size, size_t alignment) {
+  ASSERT(alignment <= alignof(std::max_align_t) && (alignment & (alignment - 1)) == 0);
+  if (size > BlockSize / 2) {
+    // The rest of the current block stays available for smaller allocations.
+    large_allocations_.push_back(std::make_unique<char[]>(size));
+    return large_allocations_.back().get();
+  }
+  // Blocks are aligned to alignof(std::max_align_t), so aligning the offset in the block aligns
+  // the allocation.
+  const uintptr_t offset =
+      (reinterpret_cast<uintptr_t>(next_) + alignment - 1) & ~(uintptr_t(alignment) - 1);
+  char* allocation = reinterpret_cast<char*>(offset);
+  if (next_ == nullptr || allocation + size > end_) {
+    newBlock();
+    allocation = next_;
+  }
+  next_ = allocation + size;
+  return allocation;
+}
+
+void Arena::newBlock() {
+  if (free_blocks_.empty()) {
+    blocks_.push_back(std::make_unique<char[]>(BlockSize));
+  } else {
+    blocks_.push_back(std::move(free_blocks_.back()));
+    free_blocks_.pop_back();
+  }
+  next_ = blocks_.back().get();
+  end_ = next_ + BlockSize;
+}
+
+namespace {
+
+// Each object is preceded by the arena it was allocated from, or null if it was allocated from the
+// heap, padded to keep the object aligned.
+constexpr size_t HeaderSize = alignof(std::max_align_t);
+static_assert(HeaderSize >= sizeof(Arena*));
+
+void* withHeader(void* allocation, Arena* arena) {
+  *static_cast<Arena**>(allocation) = arena;
+  return static_cast<char*>(allocation) + HeaderSize;
+}
+
+void* header(void* ptr) { return static_cast<char*>(ptr) - HeaderSize; }
+
+} // namespace
+
+void* ArenaAllocated::operator new(size_t size) {
+  return withHeader(::operator new(size + HeaderSize), nullptr);
+}
+
+void* ArenaAllocated::operator new(size_t size, Arena& arena) {
+  return withHeader(arena.allocate(size + HeaderSize), &arena);
+}
+
+void ArenaAllocated::operator delete(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  void* allocation = header(ptr);
+  if (*static_cast<Arena**>(allocation) == nullptr) {
+    ::operator delete(allocation);
+  }
+}
+
+void ArenaAllocated::operator delete(void*, Arena&) {}
+
+} // namespace Envoy
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "source/common/common/non_copyable.h"
+
+#include "absl/container/inlined_vector.h"
+
+namespace Envoy {
+
+/**
+ * A monotonic allocator for objects that share a lifetime, such as the objects of an HTTP stream.
+ * Allocations are carved out of fixed size blocks in order, and are not freed individually: the
+ * blocks are released all at once when the arena is destroyed, to a bounded free list of the
+ * thread, so that the next arena on the same thread reuses them instead of allocating from the
+ * heap. Allocations larger than a block get their own heap allocation, which isn't recycled.
+ *
+ * Arenas are not thread safe, and must be destroyed on the thread they were used on. No memory is
+ * allocated until the first allocation.
+ */
+class Arena : NonCopyable {
+public:
+  static constexpr uint64_t BlockSize = 4096;
+  // The maximum number of free blocks kept by each thread.
+  static constexpr uint32_t MaxFreeBlocks = 256;
+
+  Arena() = default;
+  ~Arena();
+
+  /**
+   * @param size supplies the size of the allocation.
+   * @param alignment supplies the alignment of the allocation, which must be a power of two no
+   *        larger than alignof(std::max_align_t).
+   * @return memory that stays valid until the arena is destroyed.
+   */
+  void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+  /**
+   * @return the number of blocks and large allocations owned by the arena.
+   */
+  uint64_t blockCount() const { return blocks_.size() + large_allocations_.size(); }
+
+  /**
+   * @return the number of free blocks kept by the current thread.
+   */
+  static uint64_t freeBlockCount() { return free_blocks_.size(); }
+
+private:
+  using Block = std::unique_ptr<char[]>;
+
+  void newBlock();
+
+  absl::InlinedVector<Block, 2> blocks_;
+  absl::InlinedVector<Block, 1> large_allocations_;
+  char* next_{};
+  char* end_{};
+
+  static thread_local absl::InlinedVector<Block, MaxFreeBlocks> free_blocks_;
+};
+
+/**
+ * Base class of objects that can be allocated from an Arena, with `new (arena) T(...)`, while still
+ * being owned with the default deleter, e.g. by a std::unique_ptr<T>. Deleting an object that was
+ * allocated from an arena destroys it and leaves its memory to the arena, which must outlive it.
+ * Objects allocated with a plain new are freed as usual.
+ */
+class ArenaAllocated {
+public:
+  static void* operator new(size_t size);
+  static void* operator new(size_t size, Arena& arena);
+  static void operator delete(void* ptr);
+  // Only called if the constructor of an object allocated from an arena throws.
+  static void operator delete(void* ptr, Arena& arena);
+};
+
+} // namespace Envoy
@@ -26,6 +26,10 @@ public:
   void requestOnDemandUpdate(const std::string&, const absl::flat_hash_set<std::string>&) override {
     ENVOY_BUG(false, "unexpected request for on demand update");
   }
+  void requestOnDemandRemoval(const std::string&,
+                              const absl::flat_hash_set<std::string>&) override {
+    ENVOY_BUG(false, "unexpected request for on demand removal");
+  }
 
   EdsResourcesCacheOptRef edsResourcesCache() override { return absl::nullopt; }
 
@@ -62,6 +62,8 @@ public:
                         std::chrono::milliseconds min_touch_interval) override;
   TimeSource& timeSource() override { return time_source_; }
   void initializeStats(Stats::Scope& scope, const absl::optional<std::string>& prefix) override;
+  void enableLoopLagTracking() override { base_scheduler_.enableLoopLagTracking(); }
+  std::chrono::microseconds loopLag() const override { return base_scheduler_.loopLag(); }
   void clearDeferredDeleteList() override;
   Network::ServerConnectionPtr
   createServerConnection(Network::ConnectionSocketPtr&& socket,
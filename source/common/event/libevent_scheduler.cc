@@ -1,5 +1,7 @@
 #include "source/common/event/libevent_scheduler.h"
 
+#include <algorithm>
+
 #include "source/common/common/assert.h"
 #include "source/common/event/schedulable_cb_impl.h"
 #include "source/common/event/timer_impl.h"
@@ -10,9 +12,15 @@ namespace Envoy {
 namespace Event {
 
 namespace {
+int64_t toMicroseconds(const timeval& tv) { return tv.tv_sec * 1000000 + tv.tv_usec; }
+
 void recordTimeval(Stats::Histogram& histogram, const timeval& tv) {
-  histogram.recordValue(tv.tv_sec * 1000000 + tv.tv_usec);
+  histogram.recordValue(toMicroseconds(tv));
 }
+
+// The weight of the previous average in the loop lag average is (LagSmoothing - 1) / LagSmoothing,
+// so that a single slow iteration shows without a few fast ones hiding it right away.
+constexpr int64_t LagSmoothing = 8;
 } // namespace
 
 LibeventScheduler::LibeventScheduler() {
@@ -77,54 +85,95 @@ void LibeventScheduler::initializeStats(DispatcherStats* stats) {
   evwatch_check_new(libevent_.get(), &onCheckForStats, this);
 }
 
+void LibeventScheduler::enableLoopLagTracking() {
+  if (lag_tracked_) {
+    return;
+  }
+  lag_tracked_ = true;
+  evwatch_prepare_new(libevent_.get(), &onPrepareForLag, this);
+  evwatch_check_new(libevent_.get(), &onCheckForLag, this);
+}
+
 void LibeventScheduler::onPrepareForCallback(evwatch*, const evwatch_prepare_cb_info*, void* arg) {
   // `self` is `this`, passed in from evwatch_prepare_new.
   auto self = static_cast<LibeventScheduler*>(arg);
   self->callback_();
 }
 
-void LibeventScheduler::onPrepareForStats(evwatch*, const evwatch_prepare_cb_info* info,
-                                          void* arg) {
-  // `self` is `this`, passed in from evwatch_prepare_new.
-  auto self = static_cast<LibeventScheduler*>(arg);
-
+bool LibeventScheduler::IterationTimes::onPrepare(const evwatch_prepare_cb_info* info,
+                                                  timeval& duration) {
   // Record poll timeout and prepare time for this iteration of the event loop. The timeout is the
   // expected polling duration, whereas the actual polling duration will be the difference measured
   // between the prepare time and the check time immediately after polling. These are compared in
-  // onCheckForStats to compute the poll_delay stat.
-  self->timeout_set_ = evwatch_prepare_get_timeout(info, &self->timeout_);
-  evutil_gettimeofday(&self->prepare_time_, nullptr);
+  // onCheck to compute the poll delay.
+  timeout_set_ = evwatch_prepare_get_timeout(info, &timeout_);
+  evutil_gettimeofday(&prepare_time_, nullptr);
 
   // If we have a check time available from a previous iteration of the event loop (that is, all but
-  // the first), compute the loop_duration stat.
-  if (self->check_time_.tv_sec != 0) {
-    timeval delta;
-    evutil_timersub(&self->prepare_time_, &self->check_time_, &delta);
-    recordTimeval(self->stats_->loop_duration_us_, delta);
+  // the first), compute the loop duration.
+  if (check_time_.tv_sec == 0) {
+    return false;
+  }
+  evutil_timersub(&prepare_time_, &check_time_, &duration);
+  return true;
+}
+
+bool LibeventScheduler::IterationTimes::onCheck(timeval& delay) {
+  // Record check time for this iteration of the event loop. Use this together with prepare time
+  // from above to compute the actual polling duration, and store it for the next iteration of the
+  // event loop to compute the loop duration.
+  evutil_gettimeofday(&check_time_, nullptr);
+  if (!timeout_set_) {
+    return false;
+  }
+  timeval delta;
+  evutil_timersub(&check_time_, &prepare_time_, &delta);
+  evutil_timersub(&delta, &timeout_, &delay);
+
+  // Delay can be negative, meaning polling completed early. This happens in normal operation,
+  // either because I/O was ready before we hit the timeout, or just because the kernel was
+  // feeling saucy. Disregard negative delays, since they don't indicate anything particularly
+  // useful.
+  return delay.tv_sec >= 0;
+}
+
+void LibeventScheduler::onPrepareForStats(evwatch*, const evwatch_prepare_cb_info* info,
+                                          void* arg) {
+  // `self` is `this`, passed in from evwatch_prepare_new.
+  auto self = static_cast<LibeventScheduler*>(arg);
+  timeval duration;
+  if (self->stats_times_.onPrepare(info, duration)) {
+    recordTimeval(self->stats_->loop_duration_us_, duration);
   }
 }
 
 void LibeventScheduler::onCheckForStats(evwatch*, const evwatch_check_cb_info*, void* arg) {
   // `self` is `this`, passed in from evwatch_check_new.
   auto self = static_cast<LibeventScheduler*>(arg);
+  timeval delay;
+  if (self->stats_times_.onCheck(delay)) {
+    recordTimeval(self->stats_->poll_delay_us_, delay);
+  }
+}
 
-  // Record check time for this iteration of the event loop. Use this together with prepare time
-  // from above to compute the actual polling duration, and store it for the next iteration of the
-  // event loop to compute the loop duration.
-  evutil_gettimeofday(&self->check_time_, nullptr);
-  if (self->timeout_set_) {
-    timeval delta, delay;
-    evutil_timersub(&self->check_time_, &self->prepare_time_, &delta);
-    evutil_timersub(&delta, &self->timeout_, &delay);
-
-    // Delay can be negative, meaning polling completed early. This happens in normal operation,
-    // either because I/O was ready before we hit the timeout, or just because the kernel was
-    // feeling saucy. Disregard negative delays in stats, since they don't indicate anything
-    // particularly useful.
-    if (delay.tv_sec >= 0) {
-      recordTimeval(self->stats_->poll_delay_us_, delay);
-    }
+void LibeventScheduler::onPrepareForLag(evwatch*, const evwatch_prepare_cb_info* info, void* arg) {
+  // `self` is `this`, passed in from evwatch_prepare_new.
+  auto self = static_cast<LibeventScheduler*>(arg);
+  timeval duration;
+  if (!self->lag_times_.onPrepare(info, duration)) {
+    return;
   }
+  // The loop is lagging either when its iterations run for long, or when it wakes up late.
+  const int64_t sample = std::max(toMicroseconds(duration), self->poll_delay_us_);
+  const int64_t lag = self->loop_lag_us_.load(std::memory_order_relaxed);
+  self->loop_lag_us_.store(lag + (sample - lag) / LagSmoothing, std::memory_order_relaxed);
+}
+
+void LibeventScheduler::onCheckForLag(evwatch*, const evwatch_check_cb_info*, void* arg) {
+  // `self` is `this`, passed in from evwatch_check_new.
+  auto self = static_cast<LibeventScheduler*>(arg);
+  timeval delay;
+  self->poll_delay_us_ = self->lag_times_.onCheck(delay) ? toMicroseconds(delay) : 0;
 }
 
 } // namespace Event
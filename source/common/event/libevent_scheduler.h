@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <functional>
 
 #include "envoy/event/dispatcher.h"
@@ -99,10 +101,43 @@ public:
    */
   void initializeStats(DispatcherStats* stats);
 
+  /**
+   * Start tracking the lag of the event loop. Must be called on the thread running the event loop,
+   * or before it runs. Calling it again has no effect.
+   */
+  void enableLoopLagTracking();
+
+  /**
+   * @return the exponentially weighted moving average of the lag of the event loop iterations, the
+   *         lag of an iteration being the longest of its duration and of its poll delay. This is
+   *         thread safe.
+   */
+  std::chrono::microseconds loopLag() const {
+    return std::chrono::microseconds(loop_lag_us_.load(std::memory_order_relaxed));
+  }
+
 private:
+  // The timestamps of an event loop iteration, from which the loop duration and the poll delay are
+  // computed.
+  struct IterationTimes {
+    // Records the poll timeout and the prepare time of this iteration. Returns whether the
+    // duration of the previous iteration is known, in which case it is written to duration.
+    bool onPrepare(const evwatch_prepare_cb_info* info, timeval& duration);
+    // Records the check time of this iteration. Returns whether the poll of this iteration was
+    // delayed past its timeout, in which case the delay is written to delay.
+    bool onCheck(timeval& delay);
+
+    bool timeout_set_{};     // whether there is a poll timeout in the current event loop iteration
+    timeval timeout_{};      // the poll timeout for the current event loop iteration, if available
+    timeval prepare_time_{}; // timestamp immediately before polling
+    timeval check_time_{};   // timestamp immediately after polling
+  };
+
   static void onPrepareForCallback(evwatch*, const evwatch_prepare_cb_info* info, void* arg);
   static void onPrepareForStats(evwatch*, const evwatch_prepare_cb_info* info, void* arg);
   static void onCheckForStats(evwatch*, const evwatch_check_cb_info*, void* arg);
+  static void onPrepareForLag(evwatch*, const evwatch_prepare_cb_info* info, void* arg);
+  static void onCheckForLag(evwatch*, const evwatch_check_cb_info*, void* arg);
 
   static constexpr int flagsBasedOnEventType() {
     if constexpr (Event::PlatformDefaultTriggerType == FileTriggerType::Level) {
@@ -115,12 +150,13 @@ private:
   }
 
   Libevent::BasePtr libevent_;
-  DispatcherStats* stats_{}; // stats owned by the containing DispatcherImpl
-  bool timeout_set_{};       // whether there is a poll timeout in the current event loop iteration
-  timeval timeout_{};        // the poll timeout for the current event loop iteration, if available
-  timeval prepare_time_{};   // timestamp immediately before polling
-  timeval check_time_{};     // timestamp immediately after polling
-  OnPrepareCallback callback_; // callback to be called from onPrepareForCallback()
+  DispatcherStats* stats_{};          // stats owned by the containing DispatcherImpl
+  IterationTimes stats_times_;        // timestamps used by the stats watchers
+  IterationTimes lag_times_;          // timestamps used by the lag watchers
+  bool lag_tracked_{};                // whether the lag watchers are registered
+  int64_t poll_delay_us_{};           // the poll delay of the last iteration, for the lag tracking
+  std::atomic<int64_t> loop_lag_us_{}; // only written by the thread running the event loop
+  OnPrepareCallback callback_;        // callback to be called from onPrepareForCallback()
 };
 
 } // namespace Event
@@ -0,0 +1,137 @@
+#include "source/common/http/character_set_validation.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define ENVOY_CHARACTER_SET_VALIDATION_X86_64
+#include <immintrin.h>
+#endif
+
+namespace Envoy {
+namespace Http {
+
+namespace {
+
+#ifdef ENVOY_CHARACTER_SET_VALIDATION_X86_64
+
+// The kernels split each character into its high and low nibble. The low nibble selects a row of
+// the lookup table with a byte shuffle, and the bit of the high nibble in that row tells whether
+// the character is in the table. Rows for characters from 0x80 up are in a separate lookup table,
+// as a byte shuffle only indexes 16 bytes.
+
+// @return a mask with the bit of every character of the block that is not in the table set.
+__attribute__((target("ssse3"))) inline uint32_t invalidChars16(const __m128i chars,
+                                                                 const __m128i ascii_rows,
+                                                                 const __m128i extended_rows) {
+  const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+  const __m128i row_bits =
+      _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+  const __m128i low = _mm_and_si128(chars, nibble_mask);
+  const __m128i high = _mm_and_si128(_mm_srli_epi16(chars, 4), nibble_mask);
+  const __m128i extended = _mm_cmplt_epi8(chars, _mm_setzero_si128());
+  const __m128i rows =
+      _mm_or_si128(_mm_andnot_si128(extended, _mm_shuffle_epi8(ascii_rows, low)),
+                   _mm_and_si128(extended, _mm_shuffle_epi8(extended_rows, low)));
+  const __m128i in_table = _mm_and_si128(rows, _mm_shuffle_epi8(row_bits, high));
+  return static_cast<uint32_t>(
+      _mm_movemask_epi8(_mm_cmpeq_epi8(in_table, _mm_setzero_si128())));
+}
+
+__attribute__((target("avx2"))) inline uint32_t invalidChars32(const __m256i chars,
+                                                                const __m256i ascii_rows,
+                                                                const __m256i extended_rows) {
+  const __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+  const __m256i row_bits =
+      _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16,
+                       32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+  const __m256i low = _mm256_and_si256(chars, nibble_mask);
+  const __m256i high = _mm256_and_si256(_mm256_srli_epi16(chars, 4), nibble_mask);
+  const __m256i extended = _mm256_cmpgt_epi8(_mm256_setzero_si256(), chars);
+  const __m256i rows = _mm256_blendv_epi8(_mm256_shuffle_epi8(ascii_rows, low),
+                                          _mm256_shuffle_epi8(extended_rows, low), extended);
+  const __m256i in_table = _mm256_and_si256(rows, _mm256_shuffle_epi8(row_bits, high));
+  return static_cast<uint32_t>(
+      _mm256_movemask_epi8(_mm256_cmpeq_epi8(in_table, _mm256_setzero_si256())));
+}
+
+// The kernels return the index of the first character of `data` that is not in the table, or the
+// length of the prefix that they validated, which is left to the caller to complete.
+
+__attribute__((target("ssse3"))) size_t validateSsse3(const CharLookupTable& table,
+                                                       const char* data, size_t size) {
+  const __m128i ascii_rows =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(table.ascii_rows_.data()));
+  const __m128i extended_rows =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(table.extended_rows_.data()));
+  size_t index = 0;
+  for (; index + 16 <= size; index += 16) {
+    const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+    const uint32_t invalid = invalidChars16(chars, ascii_rows, extended_rows);
+    if (invalid != 0) {
+      return index + __builtin_ctz(invalid);
+    }
+  }
+  return index;
+}
+
+__attribute__((target("avx2"))) size_t validateAvx2(const CharLookupTable& table,
+                                                     const char* data, size_t size) {
+  const __m128i ascii_rows =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(table.ascii_rows_.data()));
+  const __m128i extended_rows =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(table.extended_rows_.data()));
+  // Byte shuffles index within each 128 bit lane, so both lanes hold the lookup tables.
+  const __m256i wide_ascii_rows = _mm256_broadcastsi128_si256(ascii_rows);
+  const __m256i wide_extended_rows = _mm256_broadcastsi128_si256(extended_rows);
+  size_t index = 0;
+  for (; index + 32 <= size; index += 32) {
+    const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + index));
+    const uint32_t invalid = invalidChars32(chars, wide_ascii_rows, wide_extended_rows);
+    if (invalid != 0) {
+      return index + __builtin_ctz(invalid);
+    }
+  }
+  if (index + 16 <= size) {
+    const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+    const uint32_t invalid = invalidChars16(chars, ascii_rows, extended_rows);
+    if (invalid != 0) {
+      return index + __builtin_ctz(invalid);
+    }
+    index += 16;
+  }
+  return index;
+}
+
+using ValidateKernel = size_t (*)(const CharLookupTable&, const char*, size_t);
+
+ValidateKernel selectValidateKernel() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return validateAvx2;
+  }
+  if (__builtin_cpu_supports("ssse3")) {
+    return validateSsse3;
+  }
+  return nullptr;
+}
+
+#endif
+
+} // namespace
+
+size_t findFirstCharNotInTable(const CharLookupTable& table, absl::string_view value) {
+  size_t index = 0;
+#ifdef ENVOY_CHARACTER_SET_VALIDATION_X86_64
+  static const ValidateKernel validate_kernel = selectValidateKernel();
+  if (validate_kernel != nullptr && value.size() >= 16) {
+    index = validate_kernel(table, value.data(), value.size());
+  }
+#endif
+  for (; index < value.size(); ++index) {
+    if (!testCharInTable(table.table_, value[index])) {
+      return index;
+    }
+  }
+  return absl::string_view::npos;
+}
+
+} // namespace Http
+} // namespace Envoy
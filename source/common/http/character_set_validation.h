@@ -1,8 +1,11 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 
+#include "absl/strings/string_view.h"
+
 // A set of tables for validating that a character is in a specific
 // character set. Used to validate RFC compliance for various HTTP protocol elements.
 
@@ -21,6 +24,50 @@ inline constexpr bool testCharInTable(const std::array<uint32_t, 8>& table, char
   return (table[tmp >> 5] & (0x80000000 >> (tmp & 0x1f))) != 0;
 }
 
+/**
+ * A character table along with the nibble lookup tables that are used to validate 16 or 32
+ * characters at a time. Building the lookup tables takes 256 steps, so instances should be
+ * constexpr.
+ */
+struct CharLookupTable {
+  constexpr explicit CharLookupTable(const std::array<uint32_t, 8>& table) : table_(table) {
+    for (unsigned c = 0; c < 256; ++c) {
+      if (testCharInTable(table, static_cast<char>(c))) {
+        const uint8_t row_bit = static_cast<uint8_t>(1 << ((c >> 4) & 0x7));
+        if (c < 0x80) {
+          ascii_rows_[c & 0xf] |= row_bit;
+        } else {
+          extended_rows_[c & 0xf] |= row_bit;
+        }
+      }
+    }
+  }
+
+  const std::array<uint32_t, 8> table_;
+  // Indexed by the low nibble of a character below 0x80, with the bit of its high nibble set if the
+  // character is in the table.
+  std::array<uint8_t, 16> ascii_rows_{};
+  // Same for the characters from 0x80 up.
+  std::array<uint8_t, 16> extended_rows_{};
+};
+
+/**
+ * Finds the first character of `value` that is not in the table. On x86-64 CPUs with AVX2 or SSSE3
+ * 32 or 16 characters are validated at a time, otherwise one at a time.
+ * @return the index of the character, or absl::string_view::npos if all characters are in the
+ *         table.
+ */
+size_t findFirstCharNotInTable(const CharLookupTable& table, absl::string_view value);
+
+/**
+ * Same as above, for a character table with static storage duration.
+ */
+template <const std::array<uint32_t, 8>& table>
+size_t findFirstCharNotInTable(absl::string_view value) {
+  static constexpr CharLookupTable lookup_table{table};
+  return findFirstCharNotInTable(lookup_table, value);
+}
+
 // Header name character table.
 // From RFC 9110, https://www.rfc-editor.org/rfc/rfc9110.html#section-5.1:
 //
@@ -49,6 +96,36 @@ inline constexpr std::array<uint32_t, 8> kGenericHeaderNameCharTable = {
     0b00000000000000000000000000000000,
 };
 
+// Header value character table.
+// From RFC 9110, https://www.rfc-editor.org/rfc/rfc9110.html#section-5.5:
+//
+// SPELLCHECKER(off)
+// header-field   = field-name ":" OWS field-value OWS
+// field-value    = *field-content
+// field-content  = field-vchar
+//                  [ 1*( SP / HTAB / field-vchar ) field-vchar ]
+// field-vchar    = VCHAR / obs-text
+// obs-text       = %x80-FF
+//
+// VCHAR          =  %x21-7E
+//                   ; visible (printing) characters
+// SPELLCHECKER(on)
+inline constexpr std::array<uint32_t, 8> kGenericHeaderValueCharTable = {
+    // control characters
+    0b00000000010000000000000000000000,
+    // !"#$%&'()*+,-./0123456789:;<=>?
+    0b11111111111111111111111111111111,
+    //@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\]^_
+    0b11111111111111111111111111111111,
+    //`abcdefghijklmnopqrstuvwxyz{|}~
+    0b11111111111111111111111111111110,
+    // extended ascii
+    0b11111111111111111111111111111111,
+    0b11111111111111111111111111111111,
+    0b11111111111111111111111111111111,
+    0b11111111111111111111111111111111,
+};
+
 // A URI query and fragment character table. From RFC 3986:
 // https://datatracker.ietf.org/doc/html/rfc3986#section-3.4
 //
@@ -36,6 +36,7 @@
 #include "envoy/upstream/upstream.h"
 
 #include "source/common/buffer/watermark_buffer.h"
+#include "source/common/common/arena.h"
 #include "source/common/common/dump_state_utils.h"
 #include "source/common/common/linked_object.h"
 #include "source/common/grpc/common.h"
@@ -446,6 +447,9 @@ private:
     ResponseHeaderMapSharedPtr response_headers_;
     ResponseTrailerMapSharedPtr response_trailers_;
 
+    // Backs the filter wrappers of the stream if the envoy.reloadable_features.http_stream_arena
+    // runtime guard is enabled, so it must outlive the FM.
+    Arena arena_;
     // Note: The FM must outlive the above headers, as they are possibly accessed during filter
     // destruction.
     DownstreamFilterManager filter_manager_;
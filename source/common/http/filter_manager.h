@@ -14,6 +14,7 @@
 #include "envoy/protobuf/message_validator.h"
 
 #include "source/common/buffer/watermark_buffer.h"
+#include "source/common/common/arena.h"
 #include "source/common/common/dump_state_utils.h"
 #include "source/common/common/linked_object.h"
 #include "source/common/common/logger.h"
@@ -63,6 +64,7 @@ private:
  * memory overhead of unused fields) should apply.
  */
 struct ActiveStreamFilterBase : public virtual StreamFilterCallbacks,
+                                public ArenaAllocated,
                                 Logger::Loggable<Logger::Id::http> {
   ActiveStreamFilterBase(FilterManager& parent, bool is_encoder_decoder_filter,
                          FilterContext filter_context)
@@ -687,6 +689,15 @@ public:
   }
   void addStreamFilterBase(StreamFilterBase* filter) { filters_.push_back(filter); }
 
+  /**
+   * Allocates the filter wrappers of the stream from the arena, which must outlive the filter
+   * manager. Must be called before the filter chain is created.
+   */
+  void setArena(Arena& arena) {
+    ASSERT(decoder_filters_.empty() && encoder_filters_.empty());
+    arena_ = &arena;
+  }
+
   // FilterChainManager
   void applyFilterFactoryCb(FilterContext context, FilterFactoryCb& factory) override;
 
@@ -908,13 +919,13 @@ private:
 
     void addStreamDecoderFilter(Http::StreamDecoderFilterSharedPtr filter) override {
       manager_.addStreamFilterBase(filter.get());
-      manager_.addStreamDecoderFilter(std::make_unique<ActiveStreamDecoderFilter>(
+      manager_.addStreamDecoderFilter(manager_.makeActiveFilter<ActiveStreamDecoderFilter>(
           manager_, std::move(filter), false, context_));
     }
 
     void addStreamEncoderFilter(Http::StreamEncoderFilterSharedPtr filter) override {
       manager_.addStreamFilterBase(filter.get());
-      manager_.addStreamEncoderFilter(std::make_unique<ActiveStreamEncoderFilter>(
+      manager_.addStreamEncoderFilter(manager_.makeActiveFilter<ActiveStreamEncoderFilter>(
           manager_, std::move(filter), false, context_));
     }
 
@@ -923,9 +934,9 @@ private:
       manager_.addStreamFilterBase(decoder_filter);
 
       manager_.addStreamDecoderFilter(
-          std::make_unique<ActiveStreamDecoderFilter>(manager_, filter, true, context_));
-      manager_.addStreamEncoderFilter(
-          std::make_unique<ActiveStreamEncoderFilter>(manager_, std::move(filter), true, context_));
+          manager_.makeActiveFilter<ActiveStreamDecoderFilter>(manager_, filter, true, context_));
+      manager_.addStreamEncoderFilter(manager_.makeActiveFilter<ActiveStreamEncoderFilter>(
+          manager_, std::move(filter), true, context_));
     }
 
     void addAccessLogHandler(AccessLog::InstanceSharedPtr handler) override {
@@ -1003,6 +1014,14 @@ private:
   bool handleDataIfStopAll(ActiveStreamFilterBase& filter, Buffer::Instance& data,
                            bool& filter_streaming);
 
+  // Allocates a filter wrapper from the arena of the stream, if it has one.
+  template <class T, class... Args> std::unique_ptr<T> makeActiveFilter(Args&&... args) {
+    if (arena_ != nullptr) {
+      return std::unique_ptr<T>(new (*arena_) T(std::forward<Args>(args)...));
+    }
+    return std::make_unique<T>(std::forward<Args>(args)...);
+  }
+
   MetadataMapVector* getRequestMetadataMapVector() {
     if (request_metadata_map_vector_ == nullptr) {
       request_metadata_map_vector_ = std::make_unique<MetadataMapVector>();
@@ -1038,6 +1057,7 @@ private:
   absl::optional<Upstream::LoadBalancerContext::OverrideHost> upstream_override_host_;
 
   const FilterChainFactory& filter_chain_factory_;
+  Arena* arena_{};
   // TODO(snowp): Once FM has been moved to its own file we'll make these private classes of FM,
   // at which point they no longer need to be friends.
   friend ActiveStreamFilterBase;
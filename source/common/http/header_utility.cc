@@ -196,8 +196,8 @@ bool HeaderUtility::matchHeaders(const HeaderMap& request_headers, const HeaderD
 }
 
 bool HeaderUtility::headerValueIsValid(const absl::string_view header_value) {
-  return http2::adapter::HeaderValidator::IsValidHeaderValue(header_value,
-                                                             http2::adapter::ObsTextOption::kAllow);
+  return findFirstCharNotInTable<kGenericHeaderValueCharTable>(header_value) ==
+         absl::string_view::npos;
 }
 
 bool HeaderUtility::headerNameIsValid(const absl::string_view header_key) {
@@ -212,11 +212,8 @@ bool HeaderUtility::headerNameIsValid(const absl::string_view header_key) {
   // However the HTTP/2 codec will NOT convert these to lowercase when serializing the
   // header map, thus producing an invalid request.
   // TODO(yanavlasov): make validation in HTTP/2 case stricter.
-  bool is_valid = true;
-  for (auto iter = header_key.begin(); iter != header_key.end() && is_valid; ++iter) {
-    is_valid &= testCharInTable(kGenericHeaderNameCharTable, *iter);
-  }
-  return is_valid;
+  return findFirstCharNotInTable<kGenericHeaderNameCharTable>(header_key) ==
+         absl::string_view::npos;
 }
 
 bool HeaderUtility::headerNameContainsUnderscore(const absl::string_view header_name) {
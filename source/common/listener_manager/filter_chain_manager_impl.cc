@@ -12,6 +12,7 @@
 #include "source/common/network/socket_interface.h"
 #include "source/common/network/utility.h"
 #include "source/common/protobuf/utility.h"
+#include "source/common/runtime/runtime_features.h"
 #include "source/server/configuration_impl.h"
 
 #include "absl/container/node_hash_map.h"
@@ -134,6 +135,8 @@ void FilterChainManagerImpl::addFilterChains(
       filter_chains;
   uint32_t new_filter_chain_size = 0;
   FilterChainsByName filter_chains_by_name;
+  std::vector<FilterChainMatchEntry> entries;
+  absl::flat_hash_map<ServerNameKey, std::vector<size_t>> server_name_entries;
 
   for (const auto& filter_chain : filter_chain_span) {
     const auto& filter_chain_match = filter_chain->filter_chain_match();
@@ -213,17 +216,31 @@ void FilterChainManagerImpl::addFilterChains(
         server_names.push_back(absl::AsciiStrToLower(server_name));
       }
 
-      addFilterChainForDestinationPorts(
-          destination_ports_map_,
-          PROTOBUF_GET_WRAPPED_OR_DEFAULT(filter_chain_match, destination_port, 0), destination_ips,
-          server_names, filter_chain_match.transport_protocol(),
-          filter_chain_match.application_protocols(), direct_source_ips,
-          filter_chain_match.source_type(), source_ips, filter_chain_match.source_ports(),
-          filter_chain_impl);
+      // The filter chains are added to the lookup tree once they are grouped by server name.
+      const uint16_t destination_port =
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(filter_chain_match, destination_port, 0);
+      if (destination_ips.empty()) {
+        destination_ips.push_back(EMPTY_STRING);
+      }
+      if (server_names.empty()) {
+        server_names.push_back(EMPTY_STRING);
+      }
+      for (const auto& destination_ip : destination_ips) {
+        for (const auto& server_name : server_names) {
+          // Add mapping for the wildcard domain, i.e. ".example.com" for "*.example.com".
+          server_name_entries[{destination_port, destination_ip,
+                               isWildcardServerName(server_name) ? server_name.substr(1)
+                                                                 : server_name}]
+              .push_back(entries.size());
+        }
+      }
+      entries.push_back({filter_chain_match, std::move(direct_source_ips), std::move(source_ips),
+                         filter_chain_impl});
     }
 
     fc_contexts_[*filter_chain] = filter_chain_impl;
   }
+  addServerNameSubtrees(server_name_entries, entries);
   convertIPsToTries();
   copyOrRebuildDefaultFilterChain(default_filter_chain, filter_chain_factory_builder,
                                   context_creator);
@@ -273,80 +290,53 @@ void FilterChainManagerImpl::copyOrRebuildDefaultFilterChain(
   }
 }
 
-void FilterChainManagerImpl::addFilterChainForDestinationPorts(
-    DestinationPortsMap& destination_ports_map, uint16_t destination_port,
-    const std::vector<std::string>& destination_ips,
-    const absl::Span<const std::string> server_names, const std::string& transport_protocol,
-    const absl::Span<const std::string* const> application_protocols,
-    const std::vector<std::string>& direct_source_ips,
-    const envoy::config::listener::v3::FilterChainMatch::ConnectionSourceType source_type,
-    const std::vector<std::string>& source_ips,
-    const absl::Span<const Protobuf::uint32> source_ports,
-    const Network::FilterChainSharedPtr& filter_chain) {
-  if (destination_ports_map.find(destination_port) == destination_ports_map.end()) {
-    destination_ports_map[destination_port] =
-        std::make_pair<DestinationIPsMap, DestinationIPsTriePtr>(DestinationIPsMap{}, nullptr);
-  }
-  addFilterChainForDestinationIPs(destination_ports_map[destination_port].first, destination_ips,
-                                  server_names, transport_protocol, application_protocols,
-                                  direct_source_ips, source_type, source_ips, source_ports,
-                                  filter_chain);
-}
-
-void FilterChainManagerImpl::addFilterChainForDestinationIPs(
-    DestinationIPsMap& destination_ips_map, const std::vector<std::string>& destination_ips,
-    const absl::Span<const std::string> server_names, const std::string& transport_protocol,
-    const absl::Span<const std::string* const> application_protocols,
-    const std::vector<std::string>& direct_source_ips,
-    const envoy::config::listener::v3::FilterChainMatch::ConnectionSourceType source_type,
-    const std::vector<std::string>& source_ips,
-    const absl::Span<const Protobuf::uint32> source_ports,
-    const Network::FilterChainSharedPtr& filter_chain) {
-  if (destination_ips.empty()) {
-    addFilterChainForServerNames(destination_ips_map[EMPTY_STRING], server_names,
-                                 transport_protocol, application_protocols, direct_source_ips,
-                                 source_type, source_ips, source_ports, filter_chain);
-  } else {
-    for (const auto& destination_ip : destination_ips) {
-      addFilterChainForServerNames(destination_ips_map[destination_ip], server_names,
-                                   transport_protocol, application_protocols, direct_source_ips,
-                                   source_type, source_ips, source_ports, filter_chain);
+void FilterChainManagerImpl::addServerNameSubtrees(
+    const absl::flat_hash_map<ServerNameKey, std::vector<size_t>>& server_name_entries,
+    const std::vector<FilterChainMatchEntry>& entries) {
+  const bool share_subtrees = Runtime::runtimeFeatureEnabled(
+      "envoy.reloadable_features.share_filter_chain_lookup_subtrees");
+  const auto* origin = share_subtrees ? getOriginFilterChainManager() : nullptr;
+  uint32_t shared_subtree_size = 0;
+  for (const auto& [key, entry_indexes] : server_name_entries) {
+    ServerNameSubtree subtree;
+    for (const size_t index : entry_indexes) {
+      subtree.filter_chains_.insert(entries[index].filter_chain_.get());
     }
-  }
-}
-
-void FilterChainManagerImpl::addFilterChainForServerNames(
-    ServerNamesMapSharedPtr& server_names_map_ptr, const absl::Span<const std::string> server_names,
-    const std::string& transport_protocol,
-    const absl::Span<const std::string* const> application_protocols,
-    const std::vector<std::string>& direct_source_ips,
-    const envoy::config::listener::v3::FilterChainMatch::ConnectionSourceType source_type,
-    const std::vector<std::string>& source_ips,
-    const absl::Span<const Protobuf::uint32> source_ports,
-    const Network::FilterChainSharedPtr& filter_chain) {
-  if (server_names_map_ptr == nullptr) {
-    server_names_map_ptr = std::make_shared<ServerNamesMap>();
-  }
-  auto& server_names_map = *server_names_map_ptr;
-
-  if (server_names.empty()) {
-    addFilterChainForApplicationProtocols(server_names_map[EMPTY_STRING][transport_protocol],
-                                          application_protocols, direct_source_ips, source_type,
-                                          source_ips, source_ports, filter_chain);
-  } else {
-    for (const auto& server_name : server_names) {
-      if (isWildcardServerName(server_name)) {
-        // Add mapping for the wildcard domain, i.e. ".example.com" for "*.example.com".
+    if (origin != nullptr) {
+      // The filter chains are shared with the origin if their messages are unchanged, so the same
+      // filter chains build the same subtree.
+      const auto origin_subtree = origin->server_name_subtrees_.find(key);
+      if (origin_subtree != origin->server_name_subtrees_.end() &&
+          origin_subtree->second.filter_chains_ == subtree.filter_chains_) {
+        subtree.transport_protocols_map_ = origin_subtree->second.transport_protocols_map_;
+        ++shared_subtree_size;
+      }
+    }
+    if (subtree.transport_protocols_map_ == nullptr) {
+      auto transport_protocols_map = std::make_shared<TransportProtocolsMap>();
+      for (const size_t index : entry_indexes) {
+        const FilterChainMatchEntry& entry = entries[index];
         addFilterChainForApplicationProtocols(
-            server_names_map[server_name.substr(1)][transport_protocol], application_protocols,
-            direct_source_ips, source_type, source_ips, source_ports, filter_chain);
-      } else {
-        addFilterChainForApplicationProtocols(server_names_map[server_name][transport_protocol],
-                                              application_protocols, direct_source_ips, source_type,
-                                              source_ips, source_ports, filter_chain);
+            (*transport_protocols_map)[entry.filter_chain_match_.transport_protocol()],
+            entry.filter_chain_match_.application_protocols(), entry.direct_source_ips_,
+            entry.filter_chain_match_.source_type(), entry.source_ips_,
+            entry.filter_chain_match_.source_ports(), entry.filter_chain_);
       }
+      convertIPsToTries(*transport_protocols_map);
+      subtree.transport_protocols_map_ = std::move(transport_protocols_map);
+    }
+
+    const auto& [destination_port, destination_ip, server_name] = key;
+    DestinationIPsMap& destination_ips_map = destination_ports_map_[destination_port].first;
+    ServerNamesMapSharedPtr& server_names_map_ptr = destination_ips_map[destination_ip];
+    if (server_names_map_ptr == nullptr) {
+      server_names_map_ptr = std::make_shared<ServerNamesMap>();
     }
+    server_names_map_ptr->emplace(server_name, subtree.transport_protocols_map_);
+    server_name_subtrees_.emplace(key, std::move(subtree));
   }
+  ENVOY_LOG(debug, "filter chain lookup tree has {} server name subtrees, including {} shared",
+            server_name_subtrees_.size(), shared_subtree_size);
 }
 
 void FilterChainManagerImpl::addFilterChainForApplicationProtocols(
@@ -540,7 +530,7 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForServerName
   // Match on exact server name, i.e. "www.example.com" for "www.example.com".
   const auto server_name_exact_match = server_names_map.find(server_name);
   if (server_name_exact_match != server_names_map.end()) {
-    return findFilterChainForTransportProtocol(server_name_exact_match->second, socket);
+    return findFilterChainForTransportProtocol(*server_name_exact_match->second, socket);
   }
 
   // Match on all wildcard domains, i.e. ".example.com" and ".com" for "www.example.com".
@@ -549,7 +539,7 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForServerName
     const std::string wildcard = server_name.substr(pos);
     const auto server_name_wildcard_match = server_names_map.find(wildcard);
     if (server_name_wildcard_match != server_names_map.end()) {
-      return findFilterChainForTransportProtocol(server_name_wildcard_match->second, socket);
+      return findFilterChainForTransportProtocol(*server_name_wildcard_match->second, socket);
     }
     pos = server_name.find('.', pos + 1);
   }
@@ -557,7 +547,7 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForServerName
   // Match on a filter chain without server name requirements.
   const auto server_name_catchall_match = server_names_map.find(EMPTY_STRING);
   if (server_name_catchall_match != server_names_map.end()) {
-    return findFilterChainForTransportProtocol(server_name_catchall_match->second, socket);
+    return findFilterChainForTransportProtocol(*server_name_catchall_match->second, socket);
   }
 
   return nullptr;
@@ -699,48 +689,43 @@ void FilterChainManagerImpl::convertIPsToTries() {
 
     for (const auto& [destination_ip, server_names_map_ptr] : destination_ips_map) {
       destination_ips_list.push_back(makeCidrListEntry(destination_ip, server_names_map_ptr));
+    }
 
-      // This hugely nested for loop greatly pains me, but I'm not sure how to make it better.
-      // We need to get access to all of the source IP strings so that we can convert them into
-      // a trie like we did for the destination IPs above.
-      for (auto& [server_name, transport_protocols_map] : *server_names_map_ptr) {
-        UNREFERENCED_PARAMETER(server_name);
-        for (auto& [transport_protocol, application_protocols_map] : transport_protocols_map) {
-          UNREFERENCED_PARAMETER(transport_protocol);
-          for (auto& [application_protocol, direct_source_ips_pair] : application_protocols_map) {
-            UNREFERENCED_PARAMETER(application_protocol);
-            auto& [direct_source_ips_map, direct_source_ips_trie] = direct_source_ips_pair;
-
-            std::vector<
-                std::pair<SourceTypesArraySharedPtr, std::vector<Network::Address::CidrRange>>>
-                direct_source_ips_list;
-            direct_source_ips_list.reserve(direct_source_ips_map.size());
-
-            for (auto& [direct_source_ip, source_arrays_ptr] : direct_source_ips_map) {
-              direct_source_ips_list.push_back(
-                  makeCidrListEntry(direct_source_ip, source_arrays_ptr));
-
-              for (auto& [source_ips_map, source_ips_trie] : *source_arrays_ptr) {
-                std::vector<
-                    std::pair<SourcePortsMapSharedPtr, std::vector<Network::Address::CidrRange>>>
-                    source_ips_list;
-                source_ips_list.reserve(source_ips_map.size());
-
-                for (auto& [source_ip, source_port_map_ptr] : source_ips_map) {
-                  source_ips_list.push_back(makeCidrListEntry(source_ip, source_port_map_ptr));
-                }
-
-                source_ips_trie = std::make_unique<SourceIPsTrie>(source_ips_list, true);
-              }
-            }
-            direct_source_ips_trie =
-                std::make_unique<DirectSourceIPsTrie>(direct_source_ips_list, true);
+    destination_ips_trie = std::make_unique<DestinationIPsTrie>(destination_ips_list, true);
+  }
+}
+
+void FilterChainManagerImpl::convertIPsToTries(TransportProtocolsMap& transport_protocols_map) {
+  // This hugely nested for loop greatly pains me, but I'm not sure how to make it better.
+  // We need to get access to all of the source IP strings so that we can convert them into
+  // a trie like we did for the destination IPs.
+  for (auto& [transport_protocol, application_protocols_map] : transport_protocols_map) {
+    UNREFERENCED_PARAMETER(transport_protocol);
+    for (auto& [application_protocol, direct_source_ips_pair] : application_protocols_map) {
+      UNREFERENCED_PARAMETER(application_protocol);
+      auto& [direct_source_ips_map, direct_source_ips_trie] = direct_source_ips_pair;
+
+      std::vector<std::pair<SourceTypesArraySharedPtr, std::vector<Network::Address::CidrRange>>>
+          direct_source_ips_list;
+      direct_source_ips_list.reserve(direct_source_ips_map.size());
+
+      for (auto& [direct_source_ip, source_arrays_ptr] : direct_source_ips_map) {
+        direct_source_ips_list.push_back(makeCidrListEntry(direct_source_ip, source_arrays_ptr));
+
+        for (auto& [source_ips_map, source_ips_trie] : *source_arrays_ptr) {
+          std::vector<std::pair<SourcePortsMapSharedPtr, std::vector<Network::Address::CidrRange>>>
+              source_ips_list;
+          source_ips_list.reserve(source_ips_map.size());
+
+          for (auto& [source_ip, source_port_map_ptr] : source_ips_map) {
+            source_ips_list.push_back(makeCidrListEntry(source_ip, source_port_map_ptr));
           }
+
+          source_ips_trie = std::make_unique<SourceIPsTrie>(source_ips_list, true);
         }
       }
+      direct_source_ips_trie = std::make_unique<DirectSourceIPsTrie>(direct_source_ips_list, true);
     }
-
-    destination_ips_trie = std::make_unique<DestinationIPsTrie>(destination_ips_list, true);
   }
 }
 
@@ -3,6 +3,7 @@
 #include <atomic>
 #include <cstdint>
 #include <memory>
+#include <tuple>
 
 #include "envoy/config/listener/v3/listener_components.pb.h"
 #include "envoy/config/typed_metadata.h"
@@ -24,6 +25,7 @@
 #include "source/server/factory_context_impl.h"
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 
 namespace Envoy {
 namespace Server {
@@ -170,6 +172,20 @@ public:
   }
 
 private:
+  // The parsed match of a filter chain, used to build the lookup tree.
+  struct FilterChainMatchEntry {
+    const envoy::config::listener::v3::FilterChainMatch& filter_chain_match_;
+    std::vector<std::string> direct_source_ips_;
+    std::vector<std::string> source_ips_;
+    Network::FilterChainSharedPtr filter_chain_;
+  };
+  // Identifies the lookup subtree of a server name of a destination IP and port. Wildcard server
+  // names are prefixed with "." like in ServerNamesMap.
+  using ServerNameKey = std::tuple<uint16_t, std::string, std::string>;
+
+  void addServerNameSubtrees(
+      const absl::flat_hash_map<ServerNameKey, std::vector<size_t>>& server_name_entries,
+      const std::vector<FilterChainMatchEntry>& entries);
   void convertIPsToTries();
   const Network::FilterChain* findFilterChainUsingMatcher(const Network::ConnectionSocket& socket,
                                                           const StreamInfo::StreamInfo& info) const;
@@ -203,10 +219,12 @@ private:
 
   using ApplicationProtocolsMap = absl::flat_hash_map<std::string, DirectSourceIPsPair>;
   using TransportProtocolsMap = absl::flat_hash_map<std::string, ApplicationProtocolsMap>;
+  // Immutable once built, so that it can be shared with the next generation of the manager.
+  using TransportProtocolsMapSharedPtr = std::shared_ptr<const TransportProtocolsMap>;
   // Both exact server names and wildcard domains are part of the same map, in which wildcard
   // domains are prefixed with "." (i.e. ".example.com" for "*.example.com") to differentiate
   // between exact and wildcard entries.
-  using ServerNamesMap = absl::flat_hash_map<std::string, TransportProtocolsMap>;
+  using ServerNamesMap = absl::flat_hash_map<std::string, TransportProtocolsMapSharedPtr>;
   using ServerNamesMapSharedPtr = std::shared_ptr<ServerNamesMap>;
   using DestinationIPsMap = absl::flat_hash_map<std::string, ServerNamesMapSharedPtr>;
   using DestinationIPsTrie = Network::LcTrie::LcTrie<ServerNamesMapSharedPtr>;
@@ -214,34 +232,6 @@ private:
   using DestinationPortsMap =
       absl::flat_hash_map<uint16_t, std::pair<DestinationIPsMap, DestinationIPsTriePtr>>;
 
-  void addFilterChainForDestinationPorts(
-      DestinationPortsMap& destination_ports_map, uint16_t destination_port,
-      const std::vector<std::string>& destination_ips,
-      const absl::Span<const std::string> server_names, const std::string& transport_protocol,
-      const absl::Span<const std::string* const> application_protocols,
-      const std::vector<std::string>& direct_source_ips,
-      const envoy::config::listener::v3::FilterChainMatch::ConnectionSourceType source_type,
-      const std::vector<std::string>& source_ips,
-      const absl::Span<const Protobuf::uint32> source_ports,
-      const Network::FilterChainSharedPtr& filter_chain);
-  void addFilterChainForDestinationIPs(
-      DestinationIPsMap& destination_ips_map, const std::vector<std::string>& destination_ips,
-      const absl::Span<const std::string> server_names, const std::string& transport_protocol,
-      const absl::Span<const std::string* const> application_protocols,
-      const std::vector<std::string>& direct_source_ips,
-      const envoy::config::listener::v3::FilterChainMatch::ConnectionSourceType source_type,
-      const std::vector<std::string>& source_ips,
-      const absl::Span<const Protobuf::uint32> source_ports,
-      const Network::FilterChainSharedPtr& filter_chain);
-  void addFilterChainForServerNames(
-      ServerNamesMapSharedPtr& server_names_map_ptr,
-      const absl::Span<const std::string> server_names, const std::string& transport_protocol,
-      const absl::Span<const std::string* const> application_protocols,
-      const std::vector<std::string>& direct_source_ips,
-      const envoy::config::listener::v3::FilterChainMatch::ConnectionSourceType source_type,
-      const std::vector<std::string>& source_ips,
-      const absl::Span<const Protobuf::uint32> source_ports,
-      const Network::FilterChainSharedPtr& filter_chain);
   void addFilterChainForApplicationProtocols(
       ApplicationProtocolsMap& application_protocol_map,
       const absl::Span<const std::string* const> application_protocols,
@@ -268,6 +258,7 @@ private:
   void addFilterChainForSourcePorts(SourcePortsMapSharedPtr& source_ports_map_ptr,
                                     uint32_t source_port,
                                     const Network::FilterChainSharedPtr& filter_chain);
+  static void convertIPsToTries(TransportProtocolsMap& transport_protocols_map);
 
   const Network::FilterChain*
   findFilterChainForDestinationIP(const DestinationIPsTrie& destination_ips_trie,
@@ -310,6 +301,15 @@ private:
   // and application protocols, using structures defined above.
   DestinationPortsMap destination_ports_map_;
 
+  // The lookup subtrees of the server names, and the filter chains they were built from. A subtree
+  // is shared with the next generation of the manager if its filter chains are unchanged, so that
+  // updating a listener only rebuilds the subtrees of the changed filter chains.
+  struct ServerNameSubtree {
+    absl::flat_hash_set<const Network::FilterChain*> filter_chains_;
+    TransportProtocolsMapSharedPtr transport_protocols_map_;
+  };
+  absl::flat_hash_map<ServerNameKey, ServerNameSubtree> server_name_subtrees_;
+
   const std::vector<Network::Address::InstanceConstSharedPtr>& addresses_;
   // This is the reference to a factory context which all the generations of listener share.
   Configuration::FactoryContext& parent_context_;
@@ -44,6 +44,7 @@ void WipCounterBase::onWorkInProgressCommon(absl::string_view description) {
 void WarningValidationVisitorImpl::setCounters(Stats::Counter& unknown_counter,
                                                Stats::Counter& wip_counter) {
   setWipCounter(wip_counter);
+  absl::MutexLock lock(&mutex_);
   ASSERT(unknown_counter_ == nullptr);
   unknown_counter_ = &unknown_counter;
   unknown_counter.add(prestats_unknown_count_);
@@ -51,6 +52,7 @@ void WarningValidationVisitorImpl::setCounters(Stats::Counter& unknown_counter,
 
 void WarningValidationVisitorImpl::onUnknownField(absl::string_view description) {
   const uint64_t hash = HashUtil::xxHash64(description);
+  absl::MutexLock lock(&mutex_);
   auto it = descriptions_.insert(hash);
   // If we've seen this before, skip.
   if (!it.second) {
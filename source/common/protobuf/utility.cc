@@ -50,8 +50,9 @@ void deprecatedFieldHelper(Runtime::Loader* runtime, bool proto_annotated_as_dep
 #else
   bool warn_only = true;
 #endif
-  if (runtime &&
-      runtime->snapshot().getBoolean("envoy.features.fail_on_any_deprecated_feature", false)) {
+  // The thread safe snapshot is used as resources may be validated off the main thread.
+  if (runtime && runtime->threadsafeSnapshot()->getBoolean(
+                     "envoy.features.fail_on_any_deprecated_feature", false)) {
     warn_only = false;
   }
   bool warn_default = warn_only;
@@ -64,7 +65,7 @@ void deprecatedFieldHelper(Runtime::Loader* runtime, bool proto_annotated_as_dep
     // based on ENVOY_DISABLE_DEPRECATED_FEATURES.
     warn_only &= !proto_annotated_as_disallowed;
     warn_default = warn_only;
-    warn_only = runtime->snapshot().deprecatedFeatureEnabled(feature_name, warn_only);
+    warn_only = runtime->threadsafeSnapshot()->deprecatedFeatureEnabled(feature_name, warn_only);
   }
   // Note this only checks if the runtime override has an actual effect. It
   // does not change the logged warning if someone "allows" a deprecated but not
@@ -1772,6 +1772,117 @@ const Envoy::Config::TypedMetadata& CommonVirtualHostImpl::typedMetadata() const
                               : DefaultRouteMetadataPack::get().typed_metadata_;
 }
 
+RouteDispatchTable::RouteDispatchTable(absl::Span<const RouteEntryImplBaseConstSharedPtr> routes,
+                                       bool ignore_path_parameters)
+    : ignore_path_parameters_(ignore_path_parameters) {
+  re2::RE2::Options options;
+  options.set_log_errors(false);
+  auto regexes = std::make_unique<re2::RE2::Set>(options, re2::RE2::ANCHOR_BOTH);
+  // The set only agrees with the route matchers if they are compiled by RE2 as well. Regexes of
+  // any other engine are evaluated one by one.
+  const bool index_regexes =
+      dynamic_cast<const Regex::GoogleReEngine*>(Regex::EngineSingleton::getExisting()) != nullptr;
+
+  for (uint32_t index = 0; index < routes.size(); ++index) {
+    const RouteEntryImplBase& route = *routes[index];
+    switch (route.matchType()) {
+    case PathMatchType::Prefix:
+    case PathMatchType::Exact:
+    case PathMatchType::PathSeparatedPrefix:
+      if (route.case_sensitive()) {
+        case_sensitive_.add(route.matchType(), route.matcher(), index);
+      } else {
+        case_insensitive_.add(route.matchType(), absl::AsciiStrToLower(route.matcher()), index);
+      }
+      break;
+    case PathMatchType::Regex:
+      if (index_regexes && regexes->Add(route.matcher(), nullptr) >= 0) {
+        regex_routes_.push_back(index);
+      } else {
+        unindexed_routes_.push_back(index);
+      }
+      break;
+    case PathMatchType::None:
+    case PathMatchType::Template:
+      unindexed_routes_.push_back(index);
+      break;
+    }
+  }
+
+  if (!regex_routes_.empty()) {
+    if (regexes->Compile()) {
+      regexes_ = std::move(regexes);
+    } else {
+      // The set does not fit into the RE2 memory budget, so the regexes are evaluated one by one.
+      unindexed_routes_.insert(unindexed_routes_.end(), regex_routes_.begin(), regex_routes_.end());
+      std::sort(unindexed_routes_.begin(), unindexed_routes_.end());
+      regex_routes_.clear();
+    }
+  }
+}
+
+void RouteDispatchTable::PathIndex::add(PathMatchType type, std::string path, uint32_t index) {
+  if (type == PathMatchType::Exact) {
+    exact_[std::move(path)].push_back(index);
+    return;
+  }
+  const uint32_t length = path.size();
+  prefixes_[length][std::move(path)].push_back(index);
+}
+
+void RouteDispatchTable::PathIndex::addCandidates(absl::string_view path,
+                                                  Candidates& candidates) const {
+  const auto exact = exact_.find(path);
+  if (exact != exact_.end()) {
+    candidates.insert(candidates.end(), exact->second.begin(), exact->second.end());
+  }
+  for (const auto& [length, prefixes] : prefixes_) {
+    if (length > path.size()) {
+      break;
+    }
+    const auto prefix = prefixes.find(path.substr(0, length));
+    if (prefix != prefixes.end()) {
+      candidates.insert(candidates.end(), prefix->second.begin(), prefix->second.end());
+    }
+  }
+}
+
+RouteDispatchTable::Candidates
+RouteDispatchTable::candidates(const Http::RequestHeaderMap& headers) const {
+  Candidates candidates(unindexed_routes_.begin(), unindexed_routes_.end());
+  if (!headers.Path()) {
+    // Only routes that are not indexed by path may match requests without a path.
+    return candidates;
+  }
+
+  // Same as the path that the route path matchers are applied to.
+  absl::string_view path = headers.getPathValue();
+  if (ignore_path_parameters_) {
+    path = path.substr(0, path.find(';'));
+  }
+  path = Http::PathUtil::removeQueryAndFragment(path);
+
+  case_sensitive_.addCandidates(path, candidates);
+  if (!case_insensitive_.empty()) {
+    case_insensitive_.addCandidates(absl::AsciiStrToLower(path), candidates);
+  }
+  if (regexes_ != nullptr) {
+    std::vector<int> matches;
+    re2::RE2::Set::ErrorInfo error_info;
+    if (regexes_->Match(path, &matches, &error_info)) {
+      for (const int match : matches) {
+        candidates.push_back(regex_routes_[match]);
+      }
+    } else if (error_info.kind != re2::RE2::Set::kNoError) {
+      // The regexes could not be matched in a single pass, e.g. the DFA ran out of memory.
+      candidates.insert(candidates.end(), regex_routes_.begin(), regex_routes_.end());
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end());
+  return candidates;
+}
+
 VirtualHostImpl::VirtualHostImpl(
     const envoy::config::route::v3::VirtualHost& virtual_host,
     const CommonConfigSharedPtr& global_route_config,
@@ -1814,6 +1925,10 @@ VirtualHostImpl::VirtualHostImpl(
       routes_.emplace_back(createAndValidateRoute(route, shared_virtual_host_, factory_context,
                                                   validator, validation_clusters));
     }
+    if (Runtime::runtimeFeatureEnabled("envoy.reloadable_features.route_dispatch_table")) {
+      dispatch_table_ = std::make_unique<RouteDispatchTable>(
+          routes_, global_route_config->ignorePathParametersInPathMatching());
+    }
   }
 }
 
@@ -1905,6 +2020,23 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const RouteCallback& cb
     return nullptr;
   }
 
+  // The route callback is told whether there are more routes to evaluate, so it is only used with
+  // the full route list.
+  if (dispatch_table_ != nullptr && cb == nullptr) {
+    for (const uint32_t index : dispatch_table_->candidates(headers)) {
+      const RouteEntryImplBase& route = *routes_[index];
+      if (!headers.Path() && !route.supportsPathlessHeaders()) {
+        continue;
+      }
+      RouteConstSharedPtr route_entry = route.matches(headers, stream_info, random_value);
+      if (route_entry != nullptr) {
+        return route_entry;
+      }
+    }
+    ENVOY_LOG(debug, "route was resolved but final route list did not match incoming request");
+    return nullptr;
+  }
+
   // Check for a route that matches the request.
   return getRouteFromRoutes(cb, headers, stream_info, random_value, routes_);
 }
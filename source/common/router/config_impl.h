@@ -35,8 +35,11 @@
 #include "source/common/router/tls_context_match_criteria_impl.h"
 #include "source/common/stats/symbol_table.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/container/node_hash_map.h"
 #include "absl/types/optional.h"
+#include "re2/set.h"
 
 namespace Envoy {
 namespace Router {
@@ -355,6 +358,52 @@ private:
 
 using CommonVirtualHostSharedPtr = std::shared_ptr<CommonVirtualHostImpl>;
 
+/**
+ * Index of the routes of a virtual host by their path match. It narrows the routes to evaluate for
+ * a request down to the ones whose path match can succeed, which are evaluated in configuration
+ * order just like the full route list so that the first matching route is still selected. Exact
+ * paths are looked up in a hash map, prefixes in hash maps bucketed by prefix length and regexes
+ * are matched in a single pass with a RE2::Set when the regex engine is RE2. Header, query
+ * parameter and other conditions are only evaluated for the candidate routes.
+ */
+class RouteDispatchTable {
+public:
+  using Candidates = absl::InlinedVector<uint32_t, 16>;
+
+  RouteDispatchTable(absl::Span<const RouteEntryImplBaseConstSharedPtr> routes,
+                     bool ignore_path_parameters);
+
+  /**
+   * @return the indices of the routes that may match the request, in ascending order.
+   */
+  Candidates candidates(const Http::RequestHeaderMap& headers) const;
+
+private:
+  using RouteIndices = absl::InlinedVector<uint32_t, 1>;
+
+  struct PathIndex {
+    void add(PathMatchType type, std::string path, uint32_t index);
+    void addCandidates(absl::string_view path, Candidates& candidates) const;
+    bool empty() const { return exact_.empty() && prefixes_.empty(); }
+
+    absl::flat_hash_map<std::string, RouteIndices> exact_;
+    // Prefixes by their length, shortest first.
+    std::map<uint32_t, absl::flat_hash_map<std::string, RouteIndices>> prefixes_;
+  };
+
+  const bool ignore_path_parameters_;
+  PathIndex case_sensitive_;
+  // Keyed by the lower cased path or prefix.
+  PathIndex case_insensitive_;
+  std::unique_ptr<re2::RE2::Set> regexes_;
+  // The route indices of the regexes in the set.
+  std::vector<uint32_t> regex_routes_;
+  // The routes that are not indexed by path, and are always candidates.
+  std::vector<uint32_t> unindexed_routes_;
+};
+
+using RouteDispatchTablePtr = std::unique_ptr<RouteDispatchTable>;
+
 /**
  * Virtual host that holds a collection of routes.
  */
@@ -387,6 +436,7 @@ private:
   SslRequirements ssl_requirements_;
 
   std::vector<RouteEntryImplBaseConstSharedPtr> routes_;
+  RouteDispatchTablePtr dispatch_table_;
   Matcher::MatchTreeSharedPtr<Http::HttpMatchingData> matcher_;
 };
 
@@ -633,6 +683,7 @@ public:
   bool matchRoute(const Http::RequestHeaderMap& headers, const StreamInfo::StreamInfo& stream_info,
                   uint64_t random_value) const;
   void validateClusters(const Upstream::ClusterManager::ClusterInfoMaps& cluster_info_maps) const;
+  bool case_sensitive() const { return case_sensitive_; }
 
   // Router::RouteEntry
   const std::string& clusterName() const override;
@@ -1059,7 +1110,6 @@ protected:
   const std::string host_rewrite_;
   std::unique_ptr<ConnectConfig> connect_config_;
 
-  bool case_sensitive() const { return case_sensitive_; }
   RouteConstSharedPtr clusterEntry(const Http::RequestHeaderMap& headers,
                                    uint64_t random_value) const;
 
@@ -0,0 +1,120 @@
+#include "source/common/stats/fixed_bucket_histogram.h"
+
+#include "source/common/common/assert.h"
+
+namespace Envoy {
+namespace Stats {
+
+namespace {
+
+constexpr std::array<uint64_t, 20> PowersOfTen = {1ULL,
+                                                  10ULL,
+                                                  100ULL,
+                                                  1000ULL,
+                                                  10000ULL,
+                                                  100000ULL,
+                                                  1000000ULL,
+                                                  10000000ULL,
+                                                  100000000ULL,
+                                                  1000000000ULL,
+                                                  10000000000ULL,
+                                                  100000000000ULL,
+                                                  1000000000000ULL,
+                                                  10000000000000ULL,
+                                                  100000000000000ULL,
+                                                  1000000000000000ULL,
+                                                  10000000000000000ULL,
+                                                  100000000000000000ULL,
+                                                  1000000000000000000ULL,
+                                                  10000000000000000000ULL};
+
+} // namespace
+
+FixedBucketHistogram::~FixedBucketHistogram() {
+  for (std::atomic<Counts*>& decade : decades_) {
+    delete[] decade.load(std::memory_order_acquire);
+  }
+}
+
+void FixedBucketHistogram::bucketFor(uint64_t value, uint32_t& decade, uint32_t& index) {
+  if (value < FirstDecadeBuckets) {
+    decade = 0;
+    index = value;
+    return;
+  }
+  // Find the scale e such that 10 <= value / 10^e <= 99.
+  uint32_t scale = 1;
+  while (scale + 2 < PowersOfTen.size() && value >= PowersOfTen[scale + 2]) {
+    ++scale;
+  }
+  decade = scale;
+  index = value / PowersOfTen[scale] - 10;
+  ASSERT(decade < NumDecades);
+  ASSERT(index < DecadeBuckets);
+}
+
+uint64_t FixedBucketHistogram::bucketLowerBound(uint32_t decade, uint32_t index) {
+  if (decade == 0) {
+    return index;
+  }
+  return (index + 10) * PowersOfTen[decade];
+}
+
+FixedBucketHistogram::Counts* FixedBucketHistogram::decadeCounts(uint32_t decade) {
+  // Only the recording thread allocates, so a plain load/store pair is sufficient. The
+  // release store publishes the zero-initialized counters to draining threads.
+  Counts* counts = decades_[decade].load(std::memory_order_relaxed);
+  if (counts == nullptr) {
+    counts = new Counts[bucketsInDecade(decade)]();
+    decades_[decade].store(counts, std::memory_order_release);
+  }
+  return counts;
+}
+
+void FixedBucketHistogram::recordValue(uint64_t value) {
+  uint32_t decade;
+  uint32_t index;
+  bucketFor(value, decade, index);
+  // fetch_add rather than load/store: a concurrent drain exchanges the counter to zero,
+  // and a non-atomic increment could resurrect counts that were already drained.
+  decadeCounts(decade)[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t FixedBucketHistogram::drainTo(histogram_t* target) {
+  uint64_t drained = 0;
+  for (uint32_t decade = 0; decade < NumDecades; ++decade) {
+    Counts* counts = decades_[decade].load(std::memory_order_acquire);
+    if (counts == nullptr) {
+      continue;
+    }
+    const uint32_t num_buckets = bucketsInDecade(decade);
+    for (uint32_t index = 0; index < num_buckets; ++index) {
+      const uint64_t count = counts[index].exchange(0, std::memory_order_relaxed);
+      if (count == 0) {
+        continue;
+      }
+      drained += count;
+      // Insert the mantissa with a decimal scale rather than the lower bound itself, so
+      // values above INT64_MAX do not overflow circllhist's signed input.
+      if (decade == 0) {
+        hist_insert_intscale(target, index, 0, count);
+      } else {
+        hist_insert_intscale(target, index + 10, decade, count);
+      }
+    }
+  }
+  return drained;
+}
+
+uint32_t FixedBucketHistogram::allocatedDecades() const {
+  uint32_t allocated = 0;
+  for (const std::atomic<Counts*>& decade : decades_) {
+    if (decade.load(std::memory_order_acquire) != nullptr) {
+      ++allocated;
+    }
+  }
+  return allocated;
+}
+
+} // namespace Stats
+} // namespace Envoy
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "source/common/common/non_copyable.h"
+
+#include "circllhist.h"
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * Single-writer histogram with a fixed log-linear bucket layout whose counts are
+ * kept in relaxed atomics. One thread records values while any other thread can
+ * concurrently drain the accumulated counts, so no cross-thread swap is needed
+ * before a merge.
+ *
+ * Buckets keep two significant decimal digits, which is the same resolution as
+ * circllhist for integer values: values below 100 are counted exactly, and every
+ * larger value is truncated to the form m * 10^e with 10 <= m <= 99. Draining into
+ * a circllhist therefore produces the same bins as inserting the values directly,
+ * so HistogramStatistics output is unchanged.
+ *
+ * Counters for each decade are allocated on first use, so histograms that only
+ * see a narrow range of values stay small.
+ */
+class FixedBucketHistogram : NonCopyable {
+public:
+  FixedBucketHistogram() = default;
+  ~FixedBucketHistogram();
+
+  // Values 0-99 are tracked exactly in decade 0; each following decade holds the 90
+  // mantissas 10-99 scaled by 10^decade. A uint64_t has at most 20 digits.
+  static constexpr uint32_t NumDecades = 19;
+  static constexpr uint32_t FirstDecadeBuckets = 100;
+  static constexpr uint32_t DecadeBuckets = 90;
+
+  /**
+   * Records a value. Must only be called from a single thread at a time.
+   */
+  void recordValue(uint64_t value);
+
+  /**
+   * Moves all counts recorded since the previous drain into target and resets them.
+   * Safe to call from a thread other than the recording thread.
+   * @param target the histogram to accumulate into.
+   * @return the number of samples moved.
+   */
+  uint64_t drainTo(histogram_t* target);
+
+  /**
+   * @return the number of decades that currently have counters allocated.
+   */
+  uint32_t allocatedDecades() const;
+
+  /**
+   * Maps a value to its (decade, index-in-decade) bucket.
+   */
+  static void bucketFor(uint64_t value, uint32_t& decade, uint32_t& index);
+
+  /**
+   * @return the smallest value that falls in the given bucket.
+   */
+  static uint64_t bucketLowerBound(uint32_t decade, uint32_t index);
+
+private:
+  using Counts = std::atomic<uint64_t>;
+
+  static uint32_t bucketsInDecade(uint32_t decade) {
+    return decade == 0 ? FirstDecadeBuckets : DecadeBuckets;
+  }
+  Counts* decadeCounts(uint32_t decade);
+
+  std::array<std::atomic<Counts*>, NumDecades> decades_{};
+};
+
+using FixedBucketHistogramPtr = std::unique_ptr<FixedBucketHistogram>;
+
+} // namespace Stats
+} // namespace Envoy
@@ -60,6 +60,16 @@ void ThreadLocalStoreImpl::setHistogramSettings(HistogramSettingsConstPtr&& hist
   histogram_settings_ = std::move(histogram_settings);
 }
 
+void ThreadLocalStoreImpl::setLockFreeHistograms(bool lock_free) {
+  // Existing TLS histograms keep their recording mode, so this must be set before any histogram
+  // is created, like the histogram settings.
+  iterateScopes([](const ScopeImplSharedPtr& scope) -> bool {
+    ASSERT(scope->centralCacheLockHeld()->histograms_.empty());
+    return true;
+  });
+  lock_free_histograms_ = lock_free;
+}
+
 void ThreadLocalStoreImpl::setStatsMatcher(StatsMatcherPtr&& stats_matcher) {
   stats_matcher_ = std::move(stats_matcher);
   if (stats_matcher_->acceptsAll()) {
@@ -230,6 +240,14 @@ void ThreadLocalStoreImpl::mergeHistograms(PostMergeCb merge_complete_cb) {
   if (!shutting_down_) {
     ASSERT(!merge_in_progress_);
     merge_in_progress_ = true;
+    if (lock_free_histograms_) {
+      // TLS histograms record into atomic buckets that can be drained from this thread, so
+      // there is no buffer swap to post to the workers. The merge is still posted, so that the
+      // callback runs after this method returns, as it does when the workers swap buffers.
+      main_thread_dispatcher_->post(
+          [this, merge_complete_cb]() -> void { mergeInternal(merge_complete_cb); });
+      return;
+    }
     tls_cache_->runOnAllThreads(
         [](OptRef<TlsCache> tls_cache) {
           for (const auto& id_hist : tls_cache->tls_histogram_cache_) {
@@ -787,7 +805,8 @@ Histogram& ThreadLocalStoreImpl::tlsHistogram(ParentHistogramImpl& parent, uint6
 
   TlsHistogramSharedPtr hist_tls_ptr(
       new ThreadLocalHistogramImpl(parent.statName(), parent.unit(), tag_helper.tagExtractedName(),
-                                   tag_helper.statNameTags(), symbolTable()));
+                                   tag_helper.statNameTags(), symbolTable(),
+                                   lock_free_histograms_));
 
   parent.addTlsHistogram(hist_tls_ptr);
 
@@ -801,26 +820,42 @@ Histogram& ThreadLocalStoreImpl::tlsHistogram(ParentHistogramImpl& parent, uint6
 ThreadLocalHistogramImpl::ThreadLocalHistogramImpl(StatName name, Histogram::Unit unit,
                                                    StatName tag_extracted_name,
                                                    const StatNameTagVector& stat_name_tags,
-                                                   SymbolTable& symbol_table)
+                                                   SymbolTable& symbol_table, bool lock_free)
     : HistogramImplHelper(name, tag_extracted_name, stat_name_tags, symbol_table), unit_(unit),
       used_(false), created_thread_id_(std::this_thread::get_id()), symbol_table_(symbol_table) {
-  histograms_[0] = hist_alloc();
-  histograms_[1] = hist_alloc();
+  if (lock_free) {
+    fixed_histogram_ = std::make_unique<FixedBucketHistogram>();
+  } else {
+    histograms_[0] = hist_alloc();
+    histograms_[1] = hist_alloc();
+  }
 }
 
 ThreadLocalHistogramImpl::~ThreadLocalHistogramImpl() {
   MetricImpl::clear(symbol_table_);
-  hist_free(histograms_[0]);
-  hist_free(histograms_[1]);
+  if (fixed_histogram_ == nullptr) {
+    hist_free(histograms_[0]);
+    hist_free(histograms_[1]);
+  }
 }
 
 void ThreadLocalHistogramImpl::recordValue(uint64_t value) {
   ASSERT(std::this_thread::get_id() == created_thread_id_);
-  hist_insert_intscale(histograms_[current_active_], value, 0, 1);
-  used_ = true;
+  if (fixed_histogram_ != nullptr) {
+    fixed_histogram_->recordValue(value);
+  } else {
+    hist_insert_intscale(histograms_[current_active_], value, 0, 1);
+  }
+  if (!used_.load(std::memory_order_relaxed)) {
+    used_ = true;
+  }
 }
 
 void ThreadLocalHistogramImpl::merge(histogram_t* target) {
+  if (fixed_histogram_ != nullptr) {
+    fixed_histogram_->drainTo(target);
+    return;
+  }
   histogram_t** other_histogram = &histograms_[otherHistogramIndex()];
   hist_accumulate(target, other_histogram, 1);
   hist_clear(*other_histogram);
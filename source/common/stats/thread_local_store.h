@@ -13,6 +13,7 @@
 #include "source/common/common/hash.h"
 #include "source/common/common/thread_synchronizer.h"
 #include "source/common/stats/allocator_impl.h"
+#include "source/common/stats/fixed_bucket_histogram.h"
 #include "source/common/stats/histogram_impl.h"
 #include "source/common/stats/null_counter.h"
 #include "source/common/stats/null_gauge.h"
@@ -30,11 +31,15 @@ namespace Stats {
  * A histogram that is stored in TLS and used to record values per thread. This holds two
  * histograms, one to collect the values and other as backup that is used for merge process. The
  * swap happens during the merge process.
+ *
+ * When created with lock_free set, values are instead recorded into a FixedBucketHistogram, which
+ * the main thread can drain directly without first swapping buffers on the recording thread.
  */
 class ThreadLocalHistogramImpl : public HistogramImplHelper {
 public:
   ThreadLocalHistogramImpl(StatName name, Histogram::Unit unit, StatName tag_extracted_name,
-                           const StatNameTagVector& stat_name_tags, SymbolTable& symbol_table);
+                           const StatNameTagVector& stat_name_tags, SymbolTable& symbol_table,
+                           bool lock_free = false);
   ~ThreadLocalHistogramImpl() override;
 
   void merge(histogram_t* target);
@@ -46,6 +51,7 @@ public:
   void beginMerge() {
     // This switches the current_active_ between 1 and 0.
     ASSERT(std::this_thread::get_id() == created_thread_id_);
+    ASSERT(fixed_histogram_ == nullptr);
     current_active_ = otherHistogramIndex();
   }
 
@@ -66,7 +72,8 @@ private:
   Histogram::Unit unit_;
   uint64_t otherHistogramIndex() const { return 1 - current_active_; }
   uint64_t current_active_{0};
-  histogram_t* histograms_[2];
+  histogram_t* histograms_[2]{};
+  FixedBucketHistogramPtr fixed_histogram_;
   std::atomic<bool> used_;
   std::thread::id created_thread_id_;
   SymbolTable& symbol_table_;
@@ -195,6 +202,7 @@ public:
                            ThreadLocal::Instance& tls) override;
   void shutdownThreading() override;
   void mergeHistograms(PostMergeCb merge_cb) override;
+  void setLockFreeHistograms(bool lock_free) override;
   void deliverHistogramToSinks(const Histogram& histogram, uint64_t value) override;
 
   Histogram& tlsHistogram(ParentHistogramImpl& parent, uint64_t id);
@@ -520,6 +528,7 @@ private:
   std::atomic<bool> threading_ever_initialized_{};
   std::atomic<bool> shutting_down_{};
   std::atomic<bool> merge_in_progress_{};
+  bool lock_free_histograms_{};
   OptRef<ThreadLocal::Instance> tls_;
 
   NullCounterImpl null_counter_;
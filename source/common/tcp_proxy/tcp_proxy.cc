@@ -1,5 +1,7 @@
 #include "source/common/tcp_proxy/tcp_proxy.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -32,6 +34,7 @@
 #include "source/common/network/transport_socket_options_impl.h"
 #include "source/common/network/upstream_server_name.h"
 #include "source/common/network/upstream_socket_options_filter_state.h"
+#include "source/common/protobuf/utility.h"
 #include "source/common/router/metadatamatchcriteria_impl.h"
 #include "source/common/stream_info/stream_id_provider_impl.h"
 
@@ -148,6 +151,17 @@ Config::Config(const envoy::extensions::filters::network::tcp_proxy::v3::TcpProx
     return drain_manager;
   });
 
+  if (config.has_connection_shedding()) {
+    connection_shedder_slot_ = context.serverFactoryContext().threadLocal().allocateSlot();
+    connection_shedder_slot_->set(
+        [shedding_config = config.connection_shedding(), shared_config = shared_config_,
+         &overload_manager = context.serverFactoryContext().overloadManager()](
+            Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+          return std::make_shared<ConnectionShedder>(shedding_config, shared_config,
+                                                     overload_manager, dispatcher);
+        });
+  }
+
   if (!config.cluster().empty()) {
     default_route_ = std::make_shared<const SimpleRouteImpl>(*this, config.cluster());
   }
@@ -213,6 +227,77 @@ UpstreamDrainManager& Config::drainManager() {
   return upstream_drain_manager_slot_->getTyped<UpstreamDrainManager>();
 }
 
+ConnectionShedder* Config::connectionShedder() {
+  if (connection_shedder_slot_ == nullptr) {
+    return nullptr;
+  }
+  return &connection_shedder_slot_->getTyped<ConnectionShedder>();
+}
+
+ConnectionShedder::ConnectionShedder(
+    const envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy::ConnectionShedding& config,
+    const Config::SharedConfigSharedPtr& shared_config, Server::OverloadManager& overload_manager,
+    Event::Dispatcher& dispatcher)
+    : order_(config.order()),
+      interval_(PROTOBUF_GET_MS_OR_DEFAULT(config, interval, 1000)),
+      max_connections_per_interval_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_connections_per_interval, 100)),
+      min_idle_time_(PROTOBUF_GET_MS_OR_DEFAULT(config, min_idle_time, 0)),
+      shared_config_(shared_config), overload_manager_(overload_manager), dispatcher_(dispatcher),
+      timer_(dispatcher.createTimer([this]() { onTimer(); })) {}
+
+void ConnectionShedder::add(Entry& entry) {
+  entries_.insert(&entry);
+  if (!timer_->enabled()) {
+    timer_->enableTimer(interval_);
+  }
+}
+
+void ConnectionShedder::remove(Entry& entry) {
+  entries_.erase(&entry);
+  if (entries_.empty()) {
+    timer_->disableTimer();
+  }
+}
+
+void ConnectionShedder::onTimer() {
+  // The action can only be registered for before the overload manager starts, so its state is
+  // read on each interval instead.
+  const Server::OverloadActionState& state =
+      overload_manager_.getThreadLocalOverloadState().getState(
+          Server::OverloadActionNames::get().ShedTcpProxyConnections);
+  const uint64_t count = static_cast<uint64_t>(
+      std::ceil(state.value().value() * static_cast<double>(max_connections_per_interval_)));
+  if (count > 0) {
+    const MonotonicTime now = dispatcher_.approximateMonotonicTime();
+    std::vector<Entry*> candidates;
+    for (Entry* entry : entries_) {
+      if (now - entry->lastActivityTime() >= min_idle_time_) {
+        candidates.push_back(entry);
+      }
+    }
+    const auto shed_first = [this](const Entry* lhs, const Entry* rhs) {
+      if (order_ == envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy::
+                        ConnectionShedding::LARGEST_BUFFERED) {
+        return lhs->bufferedBytes() > rhs->bufferedBytes();
+      }
+      return lhs->lastActivityTime() < rhs->lastActivityTime();
+    };
+    const size_t shed_count = std::min<size_t>(count, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + shed_count, candidates.end(),
+                      shed_first);
+    ENVOY_LOG(debug, "shedding {} of {} tcp proxy connections", shed_count, entries_.size());
+    for (size_t i = 0; i < shed_count; ++i) {
+      shared_config_->stats().downstream_cx_overload_shed_.inc();
+      // This removes the entry.
+      candidates[i]->shed();
+    }
+  }
+  if (!entries_.empty()) {
+    timer_->enableTimer(interval_);
+  }
+}
+
 Filter::Filter(ConfigSharedPtr config, Upstream::ClusterManager& cluster_manager)
     : config_(config), cluster_manager_(cluster_manager), downstream_callbacks_(*this),
       upstream_callbacks_(new UpstreamCallbacks(this)) {
@@ -220,6 +305,8 @@ Filter::Filter(ConfigSharedPtr config, Upstream::ClusterManager& cluster_manager
 }
 
 Filter::~Filter() {
+  removeFromConnectionShedder();
+
   // Disable access log flush timer if it is enabled.
   disableAccessLogFlushTimer();
 
@@ -744,6 +831,7 @@ void Filter::onDownstreamEvent(Network::ConnectionEvent event) {
     downstream_closed_ = true;
     // Cancel the potential odcds callback.
     cluster_discovery_handle_ = nullptr;
+    removeFromConnectionShedder();
   }
 
   ENVOY_CONN_LOG(trace, "on downstream event {}, has upstream = {}", read_callbacks_->connection(),
@@ -778,6 +866,9 @@ void Filter::onUpstreamData(Buffer::Instance& data, bool end_stream) {
                  read_callbacks_->connection(), data.length(), end_stream);
   getStreamInfo().getUpstreamBytesMeter()->addWireBytesReceived(data.length());
   getStreamInfo().getDownstreamBytesMeter()->addWireBytesSent(data.length());
+  if (connection_shedder_ != nullptr) {
+    downstream_buffered_bytes_ += data.length();
+  }
   read_callbacks_->connection().write(data, end_stream);
   ASSERT(0 == data.length());
   resetIdleTimer(); // TODO(ggreenway) PERF: do we need to reset timer on both send and receive?
@@ -835,9 +926,17 @@ void Filter::onUpstreamConnection() {
     // the call to either TcpProxy or to Drainer, depending on the current state.
     idle_timer_ = read_callbacks_->connection().dispatcher().createTimer(
         [upstream_callbacks = upstream_callbacks_]() { upstream_callbacks->onIdleTimeout(); });
+  }
+
+  connection_shedder_ = config_->connectionShedder();
+  if (connection_shedder_ != nullptr) {
+    connection_shedder_->add(*this);
+  }
+
+  if (idle_timer_ != nullptr || connection_shedder_ != nullptr) {
     resetIdleTimer();
-    read_callbacks_->connection().addBytesSentCallback([this](uint64_t) {
-      resetIdleTimer();
+    read_callbacks_->connection().addBytesSentCallback([this](uint64_t bytes) {
+      onDownstreamBytesSent(bytes);
       return true;
     });
     if (upstream_) {
@@ -862,6 +961,21 @@ void Filter::onIdleTimeout() {
                                       StreamInfo::LocalCloseReasons::get().TcpSessionIdleTimeout);
 }
 
+void Filter::onDownstreamBytesSent(uint64_t bytes) {
+  downstream_buffered_bytes_ -= std::min(bytes, downstream_buffered_bytes_);
+  resetIdleTimer();
+}
+
+void Filter::shed() {
+  ENVOY_CONN_LOG(debug, "shedding connection under overload", read_callbacks_->connection());
+  getStreamInfo().setResponseFlag(StreamInfo::ResponseFlag::OverloadManager);
+  // This results in also closing the upstream connection, and removing the connection from the
+  // shedder.
+  read_callbacks_->connection().close(
+      Network::ConnectionCloseType::NoFlush,
+      StreamInfo::LocalCloseReasons::get().TcpSessionShedByOverloadManager);
+}
+
 void Filter::onMaxDownstreamConnectionDuration() {
   ENVOY_CONN_LOG(debug, "max connection duration reached", read_callbacks_->connection());
   getStreamInfo().setResponseFlag(StreamInfo::ResponseFlag::DurationTimeout);
@@ -908,6 +1022,9 @@ void Filter::resetIdleTimer() {
     ASSERT(config_->idleTimeout());
     idle_timer_->enableTimer(config_->idleTimeout().value());
   }
+  if (connection_shedder_ != nullptr) {
+    last_activity_time_ = read_callbacks_->connection().dispatcher().approximateMonotonicTime();
+  }
 }
 
 void Filter::disableIdleTimer() {
@@ -917,6 +1034,13 @@ void Filter::disableIdleTimer() {
   }
 }
 
+void Filter::removeFromConnectionShedder() {
+  if (connection_shedder_ != nullptr) {
+    connection_shedder_->remove(*this);
+    connection_shedder_ = nullptr;
+  }
+}
+
 UpstreamDrainManager::~UpstreamDrainManager() {
   // If connections aren't closed before they are destructed an ASSERT fires,
   // so cancel all pending drains, which causes the connections to be closed.
@@ -15,6 +15,7 @@
 #include "envoy/network/filter.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/server/filter_config.h"
+#include "envoy/server/overload/overload_manager.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
 #include "envoy/stats/timespan.h"
@@ -33,6 +34,7 @@
 #include "source/common/tcp_proxy/upstream.h"
 #include "source/common/upstream/load_balancer_impl.h"
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/node_hash_map.h"
 
 namespace Envoy {
@@ -43,6 +45,7 @@ namespace TcpProxy {
  */
 #define ALL_TCP_PROXY_STATS(COUNTER, GAUGE)                                                        \
   COUNTER(downstream_cx_no_route)                                                                  \
+  COUNTER(downstream_cx_overload_shed)                                                             \
   COUNTER(downstream_cx_rx_bytes_total)                                                            \
   COUNTER(downstream_cx_total)                                                                     \
   COUNTER(downstream_cx_tx_bytes_total)                                                            \
@@ -82,6 +85,7 @@ struct OnDemandStats {
 
 class Drainer;
 class UpstreamDrainManager;
+class ConnectionShedder;
 
 /**
  * Route is an individual resolved route for a connection.
@@ -293,6 +297,8 @@ public:
     return shared_config_->tunnelingConfigHelper();
   }
   UpstreamDrainManager& drainManager();
+  // Return nullptr if connection shedding is not configured.
+  ConnectionShedder* connectionShedder();
   SharedConfigSharedPtr sharedConfig() { return shared_config_; }
   const Router::MetadataMatchCriteria* metadataMatchCriteria() const {
     return cluster_metadata_match_criteria_.get();
@@ -360,6 +366,8 @@ private:
   const uint32_t max_connect_attempts_;
   ThreadLocal::SlotPtr upstream_drain_manager_slot_;
   SharedConfigSharedPtr shared_config_;
+  // Only allocated if connection shedding is configured.
+  ThreadLocal::SlotPtr connection_shedder_slot_;
   std::unique_ptr<const Router::MetadataMatchCriteria> cluster_metadata_match_criteria_;
   Random::RandomGenerator& random_generator_;
   std::unique_ptr<const Network::HashPolicyImpl> hash_policy_;
@@ -367,6 +375,64 @@ private:
 
 using ConfigSharedPtr = std::shared_ptr<Config>;
 
+/**
+ * Closes the connections of a TCP proxy on a worker while the shed_tcp_proxy_connections overload
+ * action is active. Every interval, up to max_connections_per_interval connections, scaled by the
+ * value of the action, are closed in the configured order, so that memory is recovered gradually
+ * instead of by disconnecting every connection at once.
+ */
+class ConnectionShedder : public ThreadLocal::ThreadLocalObject,
+                          protected Logger::Loggable<Logger::Id::filter> {
+public:
+  /**
+   * A connection that can be shed.
+   */
+  class Entry {
+  public:
+    virtual ~Entry() = default;
+
+    /**
+     * @return the last time bytes were sent or received on the connection.
+     */
+    virtual MonotonicTime lastActivityTime() const PURE;
+
+    /**
+     * @return the number of bytes written to the downstream connection but not yet sent.
+     */
+    virtual uint64_t bufferedBytes() const PURE;
+
+    /**
+     * Closes the connection. The entry is removed from the shedder before this returns.
+     */
+    virtual void shed() PURE;
+  };
+
+  ConnectionShedder(
+      const envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy::ConnectionShedding&
+          config,
+      const Config::SharedConfigSharedPtr& shared_config,
+      Server::OverloadManager& overload_manager, Event::Dispatcher& dispatcher);
+
+  void add(Entry& entry);
+  void remove(Entry& entry);
+
+private:
+  void onTimer();
+
+  const envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy::ConnectionShedding::Order
+      order_;
+  const std::chrono::milliseconds interval_;
+  const uint32_t max_connections_per_interval_;
+  const std::chrono::milliseconds min_idle_time_;
+  // Held for the stats, as the config may be destroyed before the workers delete this.
+  const Config::SharedConfigSharedPtr shared_config_;
+  Server::OverloadManager& overload_manager_;
+  Event::Dispatcher& dispatcher_;
+  // Only enabled while there are connections to shed.
+  const Event::TimerPtr timer_;
+  absl::flat_hash_set<Entry*> entries_;
+};
+
 /**
  * Per-connection TCP Proxy Cluster configuration.
  */
@@ -389,7 +455,8 @@ private:
 class Filter : public Network::ReadFilter,
                public Upstream::LoadBalancerContextBase,
                protected Logger::Loggable<Logger::Id::filter>,
-               public GenericConnectionPoolCallbacks {
+               public GenericConnectionPoolCallbacks,
+               public ConnectionShedder::Entry {
 public:
   Filter(ConfigSharedPtr config, Upstream::ClusterManager& cluster_manager);
   ~Filter() override;
@@ -435,6 +502,11 @@ public:
     return upstream_options_;
   }
 
+  // ConnectionShedder::Entry
+  MonotonicTime lastActivityTime() const override { return last_activity_time_; }
+  uint64_t bufferedBytes() const override { return downstream_buffered_bytes_; }
+  void shed() override;
+
   // These two functions allow enabling/disabling reads on the upstream and downstream connections.
   // They are called by the Downstream/Upstream Watermark callbacks to limit buffering.
   void readDisableUpstream(bool disable);
@@ -510,8 +582,10 @@ protected:
   void onUpstreamEvent(Network::ConnectionEvent event);
   void onUpstreamConnection();
   void onIdleTimeout();
+  void onDownstreamBytesSent(uint64_t bytes);
   void resetIdleTimer();
   void disableIdleTimer();
+  void removeFromConnectionShedder();
   void onMaxDownstreamConnectionDuration();
   void onAccessLogFlushInterval();
   void resetAccessLogFlushTimer();
@@ -547,6 +621,11 @@ protected:
   Router::MetadataMatchCriteriaConstPtr metadata_match_criteria_;
   Network::TransportSocketOptionsConstSharedPtr transport_socket_options_;
   Network::Socket::OptionsSharedPtr upstream_options_;
+  // Set while the connection can be shed, from when the upstream connection is established until
+  // the downstream connection is closed.
+  ConnectionShedder* connection_shedder_{};
+  MonotonicTime last_activity_time_;
+  uint64_t downstream_buffered_bytes_{};
   uint32_t connect_attempts_{};
   bool connecting_{};
   bool downstream_closed_{};
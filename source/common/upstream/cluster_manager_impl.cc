@@ -302,7 +302,7 @@ ClusterManagerImpl::ClusterManagerImpl(
     Http::Context& http_context, Grpc::Context& grpc_context, Router::Context& router_context,
     const Server::Instance& server)
     : server_(server), factory_(factory), runtime_(runtime), stats_(stats), tls_(tls),
-      random_(api.randomGenerator()),
+      random_(api.randomGenerator()), thread_factory_(api.threadFactory()),
       deferred_cluster_creation_(bootstrap.cluster_manager().enable_deferred_cluster_creation()),
       bind_config_(bootstrap.cluster_manager().has_upstream_bind_config()
                        ? absl::make_optional(bootstrap.cluster_manager().upstream_bind_config())
@@ -323,6 +323,8 @@ ClusterManagerImpl::ClusterManagerImpl(
           std::make_shared<SharedPool::ObjectSharedPool<
               const envoy::config::cluster::v3::Cluster::CommonLbConfig, MessageUtil, MessageUtil>>(
               main_thread_dispatcher)),
+      on_demand_cluster_idle_timeout_(PROTOBUF_GET_OPTIONAL_MS(bootstrap.cluster_manager(),
+                                                               on_demand_cluster_idle_timeout)),
       shutdown_(false) {
   if (admin.has_value()) {
     config_tracker_entry_ = admin->getConfigTracker().add(
@@ -450,8 +452,8 @@ absl::Status ClusterManagerImpl::init(const envoy::config::bootstrap::v3::Bootst
           Config::Utility::factoryForGrpcApiConfigSource(
               *async_client_manager_, dyn_resources.ads_config(), *stats_.rootScope(), false)
               ->createUncachedRawAsyncClient(),
-          dispatcher_, random_, *stats_.rootScope(), dyn_resources.ads_config(), local_info_,
-          std::move(custom_config_validators), std::move(backoff_strategy),
+          dispatcher_, random_, thread_factory_, *stats_.rootScope(), dyn_resources.ads_config(),
+          local_info_, std::move(custom_config_validators), std::move(backoff_strategy),
           makeOptRefFromPtr(xds_config_tracker_.get()), {}, use_eds_cache);
     } else {
       absl::Status status = Config::Utility::checkTransportVersion(dyn_resources.ads_config());
@@ -472,8 +474,8 @@ absl::Status ClusterManagerImpl::init(const envoy::config::bootstrap::v3::Bootst
           Config::Utility::factoryForGrpcApiConfigSource(
               *async_client_manager_, dyn_resources.ads_config(), *stats_.rootScope(), false)
               ->createUncachedRawAsyncClient(),
-          dispatcher_, random_, *stats_.rootScope(), dyn_resources.ads_config(), local_info_,
-          std::move(custom_config_validators), std::move(backoff_strategy),
+          dispatcher_, random_, thread_factory_, *stats_.rootScope(), dyn_resources.ads_config(),
+          local_info_, std::move(custom_config_validators), std::move(backoff_strategy),
           makeOptRefFromPtr(xds_config_tracker_.get()), xds_delegate_opt_ref, use_eds_cache);
     }
   } else {
@@ -769,6 +771,9 @@ bool ClusterManagerImpl::addOrUpdateCluster(const envoy::config::cluster::v3::Cl
   const auto existing_active_cluster = active_clusters_.find(cluster_name);
   const auto existing_warming_cluster = warming_clusters_.find(cluster_name);
   const uint64_t new_hash = MessageUtil::hash(cluster);
+  // A cluster received by an on-demand CDS is only tracked as on-demand if this update goes
+  // ahead, so that a blocked or rejected update doesn't mark a later one as on-demand.
+  auto incoming_on_demand = incoming_on_demand_clusters_.extract(cluster_name);
   if (existing_warming_cluster != warming_clusters_.end()) {
     // If the cluster is the same as the warming cluster of the same name, block the update.
     if (existing_warming_cluster->second->blockUpdate(new_hash)) {
@@ -813,6 +818,9 @@ bool ClusterManagerImpl::addOrUpdateCluster(const envoy::config::cluster::v3::Cl
                                        /*required_for_ads=*/false, warming_clusters_);
   THROW_IF_STATUS_NOT_OK(status_or_cluster, throw);
   const ClusterDataPtr previous_cluster = std::move(status_or_cluster.value());
+  if (!incoming_on_demand.empty()) {
+    incoming_on_demand_clusters_.insert(std::move(incoming_on_demand));
+  }
   auto& cluster_entry = warming_clusters_.at(cluster_name);
   cluster_entry->cluster_->info()->configUpdateStats().warming_state_.set(1);
   if (!all_clusters_initialized) {
@@ -885,6 +893,10 @@ bool ClusterManagerImpl::removeCluster(const std::string& cluster_name) {
 
   if (removed) {
     cm_stats_.cluster_removed_.inc();
+    incoming_on_demand_clusters_.erase(cluster_name);
+    if (on_demand_clusters_.erase(cluster_name) > 0) {
+      cm_stats_.on_demand_clusters_.set(on_demand_clusters_.size());
+    }
     updateClusterCounts();
     // Cancel any pending merged updates.
     updates_map_.erase(cluster_name);
@@ -1217,6 +1229,14 @@ void ClusterManagerImpl::postThreadLocalClusterUpdate(ClusterManagerCluster& cm_
     const auto& host_set =
         cm_cluster.cluster().prioritySet().hostSetsPerPriority()[per_priority.priority_];
     per_priority.update_hosts_params_ = HostSetImpl::updateHostsParams(*host_set);
+    // Workers share the host lists, but would otherwise rebuild every structure derived from them.
+    // The delta lets them update those in proportion to the change instead.
+    std::vector<HostSetDeltaTracker>& posted_host_sets = cm_cluster.postedHostSets();
+    if (posted_host_sets.size() <= per_priority.priority_) {
+      posted_host_sets.resize(per_priority.priority_ + 1);
+    }
+    per_priority.update_hosts_params_.delta =
+        posted_host_sets[per_priority.priority_].update(per_priority.update_hosts_params_);
     per_priority.locality_weights_ = host_set->localityWeights();
     per_priority.weighted_priority_health_ = host_set->weightedPriorityHealth();
     per_priority.overprovisioning_factor_ = host_set->overprovisioningFactor();
@@ -1224,7 +1244,15 @@ void ClusterManagerImpl::postThreadLocalClusterUpdate(ClusterManagerCluster& cm_
 
   HostMapConstSharedPtr host_map = cm_cluster.cluster().prioritySet().crossPriorityHostMap();
 
-  pending_cluster_creations_.erase(cm_cluster.cluster().info()->name());
+  // Clusters pushed by the management server without being requested are tracked like the
+  // requested ones, so they are evicted too.
+  const std::string& cluster_name = cm_cluster.cluster().info()->name();
+  auto incoming = incoming_on_demand_clusters_.extract(cluster_name);
+  if (auto creation = pending_cluster_creations_.extract(cluster_name); !creation.empty()) {
+    trackOnDemandCluster(cm_cluster, creation.mapped().odcds_);
+  } else if (!incoming.empty()) {
+    trackOnDemandCluster(cm_cluster, std::move(incoming.mapped()));
+  }
 
   const UnitFloat drop_overload = cm_cluster.cluster().dropOverload();
   // Populate the cluster initialization object based on this update.
@@ -1664,11 +1692,82 @@ ClusterManagerImpl::requestOnDemandClusterDiscovery(OdCdsApiSharedPtr odcds, std
   return std::move(handle);
 }
 
+void ClusterManagerImpl::trackOnDemandCluster(ClusterManagerCluster& cm_cluster,
+                                              OdCdsApiWeakPtr odcds) {
+  if (!on_demand_cluster_idle_timeout_.has_value()) {
+    return;
+  }
+  const ClusterInfoConstSharedPtr info = cm_cluster.cluster().info();
+  auto& stats = info->trafficStats();
+  on_demand_clusters_.insert_or_assign(
+      info->name(),
+      OnDemandClusterActivity{stats->upstream_cx_total_.value(), stats->upstream_rq_total_.value(),
+                              time_source_.monotonicTime(), std::move(odcds)});
+  cm_stats_.on_demand_clusters_.set(on_demand_clusters_.size());
+
+  if (on_demand_cluster_idle_timer_ == nullptr) {
+    on_demand_cluster_idle_timer_ =
+        dispatcher_.createTimer([this] { evictIdleOnDemandClusters(); });
+  }
+  if (!on_demand_cluster_idle_timer_->enabled()) {
+    on_demand_cluster_idle_timer_->enableTimer(*on_demand_cluster_idle_timeout_);
+  }
+}
+
+void ClusterManagerImpl::evictIdleOnDemandClusters() {
+  const MonotonicTime now = time_source_.monotonicTime();
+  std::vector<std::pair<std::string, OdCdsApiWeakPtr>> idle_clusters;
+  for (auto& [name, activity] : on_demand_clusters_) {
+    auto cluster = active_clusters_.find(name);
+    if (cluster == active_clusters_.end()) {
+      continue;
+    }
+    // A cluster counts as active if anything is in flight or anything new was started since the
+    // previous scan, so short-lived connections opened and closed between scans are not missed.
+    auto& stats = cluster->second->cluster_->info()->trafficStats();
+    const uint64_t cx_total = stats->upstream_cx_total_.value();
+    const uint64_t rq_total = stats->upstream_rq_total_.value();
+    if (stats->upstream_cx_active_.value() > 0 || stats->upstream_rq_active_.value() > 0 ||
+        stats->upstream_rq_pending_active_.value() > 0 || cx_total != activity.cx_total_ ||
+        rq_total != activity.rq_total_) {
+      activity.cx_total_ = cx_total;
+      activity.rq_total_ = rq_total;
+      activity.last_active_ = now;
+    } else if (now - activity.last_active_ >= *on_demand_cluster_idle_timeout_) {
+      idle_clusters.emplace_back(name, activity.odcds_);
+    }
+  }
+
+  // The evicted clusters are removed from the on-demand CDS subscription too, so the management
+  // server does not push them back, and the next use goes through the regular on-demand discovery.
+  for (const auto& [name, odcds] : idle_clusters) {
+    ENVOY_LOG(debug, "cm odcds: evicting idle on-demand cluster {}", name);
+    if (!removeCluster(name)) {
+      continue;
+    }
+    cm_stats_.on_demand_cluster_evicted_.inc();
+    if (OdCdsApiSharedPtr locked = odcds.lock(); locked != nullptr) {
+      locked->removeOnDemand(name);
+    }
+  }
+
+  if (!on_demand_clusters_.empty()) {
+    on_demand_cluster_idle_timer_->enableTimer(*on_demand_cluster_idle_timeout_);
+  }
+}
+
 void ClusterManagerImpl::notifyMissingCluster(absl::string_view name) {
   ENVOY_LOG(debug, "cm odcds: cluster {} not found during on-demand discovery", name);
   notifyClusterDiscoveryStatus(name, ClusterDiscoveryStatus::Missing);
 }
 
+void ClusterManagerImpl::notifyOnDemandCluster(absl::string_view name, OdCdsApiWeakPtr odcds) {
+  if (!on_demand_cluster_idle_timeout_.has_value()) {
+    return;
+  }
+  incoming_on_demand_clusters_.insert_or_assign(std::string(name), std::move(odcds));
+}
+
 void ClusterManagerImpl::notifyExpiredDiscovery(absl::string_view name) {
   ENVOY_LOG(debug, "cm odcds: on-demand discovery for cluster {} timed out", name);
   notifyClusterDiscoveryStatus(name, ClusterDiscoveryStatus::Timeout);
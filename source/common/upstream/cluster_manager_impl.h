@@ -135,6 +135,10 @@ public:
   // Return true if the cluster must be ready-for-use before ADS (Aggregated Discovery Service) can
   // be initialized; will only occur if ADS is configured to use the cluster via EnvoyGrpc.
   virtual bool requiredForAds() const PURE;
+
+  // Return the per-priority record of the host lists last posted to the workers, used to send
+  // workers only the change of the next update.
+  virtual std::vector<HostSetDeltaTracker>& postedHostSets() PURE;
 };
 
 /**
@@ -214,9 +218,11 @@ private:
   COUNTER(cluster_removed)                                                                         \
   COUNTER(cluster_updated)                                                                         \
   COUNTER(cluster_updated_via_merge)                                                               \
+  COUNTER(on_demand_cluster_evicted)                                                               \
   COUNTER(update_merge_cancelled)                                                                  \
   COUNTER(update_out_of_merge_window)                                                              \
   GAUGE(active_clusters, NeverImport)                                                              \
+  GAUGE(on_demand_clusters, NeverImport)                                                           \
   GAUGE(warming_clusters, NeverImport)
 
 /**
@@ -307,6 +313,9 @@ public:
     ads_mux_.reset();
     active_clusters_.clear();
     warming_clusters_.clear();
+    on_demand_cluster_idle_timer_.reset();
+    on_demand_clusters_.clear();
+    incoming_on_demand_clusters_.clear();
     updateClusterCounts();
   }
 
@@ -368,6 +377,7 @@ public:
 
   // Upstream::MissingClusterNotifier
   void notifyMissingCluster(absl::string_view name) override;
+  void notifyOnDemandCluster(absl::string_view name, OdCdsApiWeakPtr odcds) override;
 
   /*
    * Return shared_ptr for common_lb_config which is stored in an ObjectSharedPool
@@ -760,6 +770,7 @@ private:
       added_or_updated_ = true;
     }
     bool requiredForAds() const override { return required_for_ads_; }
+    std::vector<HostSetDeltaTracker>& postedHostSets() override { return posted_host_sets_; }
 
     const envoy::config::cluster::v3::Cluster cluster_config_;
     const uint64_t config_hash_;
@@ -772,6 +783,7 @@ private:
     SystemTime last_updated_;
     Common::CallbackHandlePtr member_update_cb_;
     Common::CallbackHandlePtr priority_update_cb_;
+    std::vector<HostSetDeltaTracker> posted_host_sets_;
     // Keep smaller fields near the end to reduce padding
     const bool added_via_api_ : 1;
     bool added_or_updated_ : 1;
@@ -837,7 +849,20 @@ private:
 
   using ClusterCreationsMap = absl::flat_hash_map<std::string, ClusterCreation>;
 
+  /**
+   * Traffic seen on an on-demand cluster as of the last idle scan, and the on-demand CDS to
+   * unsubscribe from when the cluster is evicted.
+   */
+  struct OnDemandClusterActivity {
+    uint64_t cx_total_{};
+    uint64_t rq_total_{};
+    MonotonicTime last_active_;
+    OdCdsApiWeakPtr odcds_;
+  };
+
   void applyUpdates(ClusterManagerCluster& cluster, uint32_t priority, PendingUpdates& updates);
+  void trackOnDemandCluster(ClusterManagerCluster& cm_cluster, OdCdsApiWeakPtr odcds);
+  void evictIdleOnDemandClusters();
   bool scheduleUpdate(ClusterManagerCluster& cluster, uint32_t priority, bool mergeable,
                       const uint64_t timeout);
   ProtobufTypes::MessagePtr dumpClusterConfigs(const Matchers::StringMatcher& name_matcher);
@@ -893,6 +918,7 @@ private:
   // Contains information about ongoing on-demand cluster discoveries.
   ClusterCreationsMap pending_cluster_creations_;
   Random::RandomGenerator& random_;
+  Thread::ThreadFactory& thread_factory_;
   ClusterMap warming_clusters_;
   const bool deferred_cluster_creation_;
   absl::optional<envoy::config::core::v3::BindConfig> bind_config_;
@@ -926,6 +952,13 @@ private:
   std::shared_ptr<SharedPool::ObjectSharedPool<
       const envoy::config::cluster::v3::Cluster::CommonLbConfig, MessageUtil, MessageUtil>>
       common_lb_config_pool_;
+  // Idle timeout after which on-demand clusters are evicted, if configured.
+  const absl::optional<std::chrono::milliseconds> on_demand_cluster_idle_timeout_;
+  Event::TimerPtr on_demand_cluster_idle_timer_;
+  // On-demand clusters that are subject to idle eviction.
+  absl::flat_hash_map<std::string, OnDemandClusterActivity> on_demand_clusters_;
+  // Clusters received by an on-demand CDS that are not added or updated yet.
+  absl::flat_hash_map<std::string, OdCdsApiWeakPtr> incoming_on_demand_clusters_;
 
   std::unique_ptr<Config::SubscriptionFactoryImpl> subscription_factory_;
   ClusterSet primary_clusters_;
@@ -1023,10 +1023,9 @@ EdfLoadBalancerBase::EdfLoadBalancerBase(
                                                slow_start_config.value(), min_weight_percent, 10) /
                                                100.0
                                          : 0.1) {
-  // We fully recompute the schedulers for a given host set here on membership change, which is
-  // consistent with what other LB implementations do (e.g. thread aware).
-  // The downside of a full recompute is that time complexity is O(n * log n),
-  // so we will need to do better at delta tracking to scale (see
+  // On membership change the schedulers for a given host set are updated with the delta of the
+  // update when the host set provides one, and fully recomputed otherwise. A full recompute is
+  // O(n * log n), applying a delta is O(d * log n) in the number of changed hosts (see
   // https://github.com/envoyproxy/envoy/issues/2874).
   priority_update_cb_ = priority_set.addPriorityUpdateCb(
       [this](uint32_t priority, const HostVector&, const HostVector&) { refresh(priority); });
@@ -1068,69 +1067,158 @@ void EdfLoadBalancerBase::recalculateHostsInSlowStart(const HostVector& hosts) {
   }
 }
 
-void EdfLoadBalancerBase::refresh(uint32_t priority) {
-  const auto add_hosts_source = [this](HostsSource source, const HostVector& hosts) {
-    // Nuke existing scheduler if it exists.
-    auto& scheduler = scheduler_[source] = Scheduler{};
-    refreshHostSource(source);
-    if (isSlowStartEnabled()) {
-      recalculateHostsInSlowStart(hosts);
+void EdfLoadBalancerBase::refresh(uint32_t priority) { refreshSchedulers(priority, true); }
+
+void EdfLoadBalancerBase::buildScheduler(const HostsSource& source, const HostVector& hosts) {
+  // Nuke existing scheduler if it exists.
+  auto& scheduler = scheduler_[source] = Scheduler{};
+  refreshHostSource(source);
+  if (isSlowStartEnabled()) {
+    recalculateHostsInSlowStart(hosts);
+  }
+
+  // Check if the original host weights are equal and no hosts are in slow start mode, in that
+  // case EDF creation is skipped. When all original weights are equal and no hosts are in slow
+  // start mode we can rely on unweighted host pick to do optimal round robin and least-loaded
+  // host selection with lower memory and CPU overhead.
+  if (hostWeightsAreEqual(hosts) && noHostsAreInSlowStart()) {
+    // Skip edf creation.
+    scheduler.uniform_weight_ = hosts.empty() ? 0 : hosts[0]->weight();
+    return;
+  }
+  scheduler.edf_ = std::make_unique<EdfScheduler<const EdfEntry>>();
+  scheduler.entries_.reserve(hosts.size());
+
+  // Populate scheduler with host list.
+  // TODO(mattklein123): We must build the EDF schedule even if all of the hosts are currently
+  // weighted 1. This is because currently we don't refresh host sets if only weights change.
+  // We should probably change this to refresh at all times. See the comment in
+  // BaseDynamicClusterImpl::updateDynamicHostList about this.
+  for (const auto& host : hosts) {
+    // We use a fixed weight here. While the weight may change without
+    // notification, this will only be stale until this host is next picked,
+    // at which point it is reinserted into the EdfScheduler with its new
+    // weight in chooseHost().
+    auto entry = std::make_shared<const EdfEntry>(EdfEntry{host});
+    scheduler.edf_->add(hostWeight(*host), entry);
+    scheduler.entries_.emplace(host.get(), std::move(entry));
+  }
+
+  // Cycle through hosts to achieve the intended offset behavior.
+  // TODO(htuch): Consider how we can avoid biasing towards earlier hosts in the schedule across
+  // refreshes for the weighted case.
+  if (!hosts.empty()) {
+    for (uint32_t i = 0; i < seed_ % hosts.size(); ++i) {
+      auto entry = scheduler.edf_->pickAndAdd(
+          [this](const EdfEntry& entry) { return hostWeight(*entry.host_); });
     }
+  }
+}
 
-    // Check if the original host weights are equal and no hosts are in slow start mode, in that
-    // case EDF creation is skipped. When all original weights are equal and no hosts are in slow
-    // start mode we can rely on unweighted host pick to do optimal round robin and least-loaded
-    // host selection with lower memory and CPU overhead.
-    if (hostWeightsAreEqual(hosts) && noHostsAreInSlowStart()) {
-      // Skip edf creation.
-      return;
+bool EdfLoadBalancerBase::applyDelta(const HostsSource& source, const HostVector& hosts,
+                                     const HostVector& added, const HostVector& removed) {
+  auto it = scheduler_.find(source);
+  if (it == scheduler_.end() || it->second.stale_) {
+    return false;
+  }
+  Scheduler& scheduler = it->second;
+  if (scheduler.edf_ == nullptr) {
+    // Removing hosts keeps the remaining weights equal, adding hosts only does if they have the
+    // same weight.
+    for (const auto& host : added) {
+      if (host->weight() != scheduler.uniform_weight_) {
+        return false;
+      }
+    }
+    if (hosts.empty()) {
+      scheduler.uniform_weight_ = 0;
+    }
+  } else {
+    for (const auto& host : removed) {
+      // Releasing the entry lazily removes it from the schedule.
+      scheduler.entries_.erase(host.get());
     }
-    scheduler.edf_ = std::make_unique<EdfScheduler<const Host>>();
-
-    // Populate scheduler with host list.
-    // TODO(mattklein123): We must build the EDF schedule even if all of the hosts are currently
-    // weighted 1. This is because currently we don't refresh host sets if only weights change.
-    // We should probably change this to refresh at all times. See the comment in
-    // BaseDynamicClusterImpl::updateDynamicHostList about this.
-    for (const auto& host : hosts) {
-      // We use a fixed weight here. While the weight may change without
-      // notification, this will only be stale until this host is next picked,
-      // at which point it is reinserted into the EdfScheduler with its new
-      // weight in chooseHost().
-      scheduler.edf_->add(hostWeight(*host), host);
+    for (const auto& host : added) {
+      auto entry = std::make_shared<const EdfEntry>(EdfEntry{host});
+      scheduler.edf_->add(hostWeight(*host), entry);
+      scheduler.entries_.insert_or_assign(host.get(), std::move(entry));
     }
+  }
+  refreshHostSource(source);
+  return true;
+}
 
-    // Cycle through hosts to achieve the intended offset behavior.
-    // TODO(htuch): Consider how we can avoid biasing towards earlier hosts in the schedule across
-    // refreshes for the weighted case.
-    if (!hosts.empty()) {
-      for (uint32_t i = 0; i < seed_ % hosts.size(); ++i) {
-        auto host =
-            scheduler.edf_->pickAndAdd([this](const Host& host) { return hostWeight(host); });
-      }
+void EdfLoadBalancerBase::refreshSchedulers(uint32_t priority, bool allow_incremental) {
+  const auto& host_set = priority_set_.hostSetsPerPriority()[priority];
+  const HostsSource all_hosts(priority, HostsSource::SourceType::AllHosts);
+  const HostsSource healthy_hosts(priority, HostsSource::SourceType::HealthyHosts);
+  const HostsSource degraded_hosts(priority, HostsSource::SourceType::DegradedHosts);
+
+  // With a delta only the changed hosts are rescheduled, so that a small change of a large host
+  // set does not cost a rebuild of every scheduler. Slow start rescales weights over time, and
+  // needs the rebuild to pick up the current factors.
+  const HostSetDelta* delta = allow_incremental && !isSlowStartEnabled() ? host_set->updateDelta()
+                                                                         : nullptr;
+  if (delta != nullptr) {
+    if (!applyDelta(all_hosts, host_set->hosts(), delta->hosts_added_, delta->hosts_removed_)) {
+      buildScheduler(all_hosts, host_set->hosts());
     }
-  };
+    if (!applyDelta(healthy_hosts, host_set->healthyHosts(), delta->healthy_hosts_added_,
+                    delta->healthy_hosts_removed_)) {
+      buildScheduler(healthy_hosts, host_set->healthyHosts());
+    }
+    if (!applyDelta(degraded_hosts, host_set->degradedHosts(), delta->degraded_hosts_added_,
+                    delta->degraded_hosts_removed_)) {
+      buildScheduler(degraded_hosts, host_set->degradedHosts());
+    }
+    // The delta does not say which locality a host belongs to. Locality schedulers are only used
+    // with zone aware routing, so rather than rebuilding them all now, each is rebuilt when it is
+    // next used.
+    for (uint32_t locality_index = 0;
+         locality_index < host_set->healthyHostsPerLocality().get().size(); ++locality_index) {
+      scheduler_[HostsSource(priority, HostsSource::SourceType::LocalityHealthyHosts,
+                             locality_index)]
+          .stale_ = true;
+    }
+    for (uint32_t locality_index = 0;
+         locality_index < host_set->degradedHostsPerLocality().get().size(); ++locality_index) {
+      scheduler_[HostsSource(priority, HostsSource::SourceType::LocalityDegradedHosts,
+                             locality_index)]
+          .stale_ = true;
+    }
+    return;
+  }
+
   // Populate EdfSchedulers for each valid HostsSource value for the host set at this priority.
-  const auto& host_set = priority_set_.hostSetsPerPriority()[priority];
-  add_hosts_source(HostsSource(priority, HostsSource::SourceType::AllHosts), host_set->hosts());
-  add_hosts_source(HostsSource(priority, HostsSource::SourceType::HealthyHosts),
-                   host_set->healthyHosts());
-  add_hosts_source(HostsSource(priority, HostsSource::SourceType::DegradedHosts),
-                   host_set->degradedHosts());
+  buildScheduler(all_hosts, host_set->hosts());
+  buildScheduler(healthy_hosts, host_set->healthyHosts());
+  buildScheduler(degraded_hosts, host_set->degradedHosts());
   for (uint32_t locality_index = 0;
        locality_index < host_set->healthyHostsPerLocality().get().size(); ++locality_index) {
-    add_hosts_source(
+    buildScheduler(
         HostsSource(priority, HostsSource::SourceType::LocalityHealthyHosts, locality_index),
         host_set->healthyHostsPerLocality().get()[locality_index]);
   }
   for (uint32_t locality_index = 0;
        locality_index < host_set->degradedHostsPerLocality().get().size(); ++locality_index) {
-    add_hosts_source(
+    buildScheduler(
         HostsSource(priority, HostsSource::SourceType::LocalityDegradedHosts, locality_index),
         host_set->degradedHostsPerLocality().get()[locality_index]);
   }
 }
 
+EdfLoadBalancerBase::Scheduler& EdfLoadBalancerBase::schedulerForUse(const HostsSource& source) {
+  auto scheduler_it = scheduler_.find(source);
+  // We should always have a scheduler for any return value from
+  // hostSourceToUse() via the construction in refresh();
+  ASSERT(scheduler_it != scheduler_.end());
+  if (scheduler_it->second.stale_) {
+    buildScheduler(source, hostSourceToHosts(source));
+    scheduler_it = scheduler_.find(source);
+  }
+  return scheduler_it->second;
+}
+
 bool EdfLoadBalancerBase::isSlowStartEnabled() const {
   return slow_start_window_ > std::chrono::milliseconds(0);
 }
@@ -1157,18 +1245,16 @@ HostConstSharedPtr EdfLoadBalancerBase::peekAnotherHost(LoadBalancerContext* con
     return nullptr;
   }
 
-  auto scheduler_it = scheduler_.find(*hosts_source);
-  // We should always have a scheduler for any return value from
-  // hostSourceToUse() via the construction in refresh();
-  ASSERT(scheduler_it != scheduler_.end());
-  auto& scheduler = scheduler_it->second;
+  auto& scheduler = schedulerForUse(*hosts_source);
 
   // As has been commented in both EdfLoadBalancerBase::refresh and
   // BaseDynamicClusterImpl::updateDynamicHostList, we must do a runtime pivot here to determine
   // whether to use EDF or do unweighted (fast) selection. EDF is non-null iff the original
   // weights of 2 or more hosts differ.
   if (scheduler.edf_ != nullptr) {
-    return scheduler.edf_->peekAgain([this](const Host& host) { return hostWeight(host); });
+    auto entry = scheduler.edf_->peekAgain(
+        [this](const EdfEntry& entry) { return hostWeight(*entry.host_); });
+    return entry != nullptr ? entry->host_ : nullptr;
   } else {
     const HostVector& hosts_to_use = hostSourceToHosts(*hosts_source);
     if (hosts_to_use.empty()) {
@@ -1183,19 +1269,16 @@ HostConstSharedPtr EdfLoadBalancerBase::chooseHostOnce(LoadBalancerContext* cont
   if (!hosts_source) {
     return nullptr;
   }
-  auto scheduler_it = scheduler_.find(*hosts_source);
-  // We should always have a scheduler for any return value from
-  // hostSourceToUse() via the construction in refresh();
-  ASSERT(scheduler_it != scheduler_.end());
-  auto& scheduler = scheduler_it->second;
+  auto& scheduler = schedulerForUse(*hosts_source);
 
   // As has been commented in both EdfLoadBalancerBase::refresh and
   // BaseDynamicClusterImpl::updateDynamicHostList, we must do a runtime pivot here to determine
   // whether to use EDF or do unweighted (fast) selection. EDF is non-null iff the original
   // weights of 2 or more hosts differ.
   if (scheduler.edf_ != nullptr) {
-    auto host = scheduler.edf_->pickAndAdd([this](const Host& host) { return hostWeight(host); });
-    return host;
+    auto entry = scheduler.edf_->pickAndAdd(
+        [this](const EdfEntry& entry) { return hostWeight(*entry.host_); });
+    return entry != nullptr ? entry->host_ : nullptr;
   } else {
     const HostVector& hosts_to_use = hostSourceToHosts(*hosts_source);
     if (hosts_to_use.empty()) {
@@ -521,17 +521,39 @@ public:
   HostConstSharedPtr chooseHostOnce(LoadBalancerContext* context) override;
 
 protected:
+  // A host in an EdfScheduler. The schedule only holds weak references, so releasing the entry
+  // removes the host from the schedule even while the host itself is still alive.
+  struct EdfEntry {
+    HostConstSharedPtr host_;
+  };
+
   struct Scheduler {
     // EdfScheduler for weighted LB. The edf_ is only created when the original
     // host weights of 2 or more hosts differ. When not present, the
     // implementation of chooseHostOnce falls back to unweightedHostPick.
-    std::unique_ptr<EdfScheduler<const Host>> edf_;
+    std::unique_ptr<EdfScheduler<const EdfEntry>> edf_;
+    // Owners of the entries in edf_.
+    absl::flat_hash_map<const Host*, std::shared_ptr<const EdfEntry>> entries_;
+    // The weight of every host when edf_ is not present, or 0 if there are no hosts.
+    uint32_t uniform_weight_{};
+    // True if the hosts of the source changed since the scheduler was built. The scheduler is then
+    // rebuilt when it is next used.
+    bool stale_{};
   };
 
   void initialize();
 
   virtual void refresh(uint32_t priority);
 
+  /**
+   * Brings the schedulers of a priority up to date with its host set.
+   * @param priority supplies the priority to refresh.
+   * @param allow_incremental supplies whether host weights are known not to have changed for
+   *        reasons other than the update itself, so that the update delta of the host set, if
+   *        any, may be applied instead of rebuilding every scheduler.
+   */
+  void refreshSchedulers(uint32_t priority, bool allow_incremental);
+
   bool isSlowStartEnabled() const;
   bool noHostsAreInSlowStart() const;
 
@@ -548,6 +570,12 @@ protected:
 
 private:
   friend class EdfLoadBalancerBasePeer;
+
+  void buildScheduler(const HostsSource& source, const HostVector& hosts);
+  bool applyDelta(const HostsSource& source, const HostVector& hosts, const HostVector& added,
+                  const HostVector& removed);
+  Scheduler& schedulerForUse(const HostsSource& source);
+
   virtual void refreshHostSource(const HostsSource& source) PURE;
   virtual double hostWeight(const Host& host) const PURE;
   virtual HostConstSharedPtr unweightedHostPeek(const HostVector& hosts_to_use,
@@ -727,7 +755,10 @@ protected:
       active_request_bias_ = 1.0;
     }
 
-    EdfLoadBalancerBase::refresh(priority);
+    // Scheduled weights depend on the bias, so a change of the bias needs a full rebuild.
+    const bool bias_unchanged = active_request_bias_ == previous_active_request_bias_;
+    previous_active_request_bias_ = active_request_bias_;
+    EdfLoadBalancerBase::refreshSchedulers(priority, bias_unchanged);
   }
 
 private:
@@ -744,6 +775,8 @@ private:
   // performance reasons and refresh it in `LeastRequestLoadBalancer::refresh(uint32_t priority)`
   // whenever a `HostSet` is updated.
   double active_request_bias_{};
+  // The bias the schedulers were last refreshed with.
+  double previous_active_request_bias_{};
 
   const absl::optional<Runtime::Double> active_request_bias_runtime_;
 };
@@ -50,6 +50,11 @@ absl::Status
 OdCdsApiImpl::onConfigUpdate(const std::vector<Config::DecodedResourceRef>& added_resources,
                              const Protobuf::RepeatedPtrField<std::string>& removed_resources,
                              const std::string& system_version_info) {
+  // Warming may complete while the clusters are added, so the cluster manager has to learn where
+  // they come from first.
+  for (const auto& resource : added_resources) {
+    notifier_.notifyOnDemandCluster(resource.get().name(), weak_from_this());
+  }
   auto exception_msgs =
       helper_.onConfigUpdate(added_resources, removed_resources, system_version_info);
   sendAwaiting();
@@ -110,5 +115,23 @@ void OdCdsApiImpl::updateOnDemand(std::string cluster_name) {
   PANIC("corrupt enum");
 }
 
+void OdCdsApiImpl::removeOnDemand(std::string cluster_name) {
+  switch (status_) {
+  case StartStatus::NotStarted:
+    return;
+
+  case StartStatus::Started:
+    // Nothing was received yet, so just make sure the name is not requested later.
+    awaiting_names_.erase(cluster_name);
+    return;
+
+  case StartStatus::InitialFetchDone:
+    ENVOY_LOG(trace, "odcds: removing interest in cluster name {}", cluster_name);
+    subscription_->requestOnDemandRemoval({std::move(cluster_name)});
+    return;
+  }
+  PANIC("corrupt enum");
+}
+
 } // namespace Upstream
 } // namespace Envoy
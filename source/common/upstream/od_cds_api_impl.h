@@ -37,25 +37,35 @@ public:
   // Subscribe to a cluster with a given name. It's meant to eventually send a discovery request
   // with the cluster name to the management server.
   virtual void updateOnDemand(std::string cluster_name) PURE;
+
+  // Unsubscribe from a cluster with a given name, so the management server stops sending updates
+  // for it. Used when the cluster is evicted.
+  virtual void removeOnDemand(std::string cluster_name) PURE;
 };
 
 using OdCdsApiSharedPtr = std::shared_ptr<OdCdsApi>;
+using OdCdsApiWeakPtr = std::weak_ptr<OdCdsApi>;
 
 /**
  * An interface used by OdCdsApiImpl for sending notifications about the missing cluster that was
- * requested.
+ * requested, and about the clusters it receives.
  */
 class MissingClusterNotifier {
 public:
   virtual ~MissingClusterNotifier() = default;
 
   virtual void notifyMissingCluster(absl::string_view name) PURE;
+
+  // Called for every cluster received by the on-demand CDS, requested or pushed by the management
+  // server, before it is added or updated in the cluster manager.
+  virtual void notifyOnDemandCluster(absl::string_view name, OdCdsApiWeakPtr odcds) PURE;
 };
 
 /**
  * ODCDS API implementation that fetches via Subscription.
  */
 class OdCdsApiImpl : public OdCdsApi,
+                     public std::enable_shared_from_this<OdCdsApiImpl>,
                      Envoy::Config::SubscriptionBase<envoy::config::cluster::v3::Cluster>,
                      Logger::Loggable<Logger::Id::upstream> {
 public:
@@ -67,6 +77,7 @@ public:
 
   // Upstream::OdCdsApi
   void updateOnDemand(std::string cluster_name) override;
+  void removeOnDemand(std::string cluster_name) override;
 
 private:
   // Config::SubscriptionCallbacks
@@ -57,6 +57,7 @@
 #include "source/extensions/filters/network/http_connection_manager/config.h"
 #include "source/server/transport_socket_config_impl.h"
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/node_hash_set.h"
 #include "absl/strings/str_cat.h"
 
@@ -374,6 +375,38 @@ Envoy::Upstream::UpstreamLocalAddressSelectorConstSharedPtr createUpstreamLocalA
   return selector_or_error.value();
 }
 
+template <class T>
+bool isSameList(const std::weak_ptr<const T>& previous, const std::shared_ptr<const T>& current) {
+  return !previous.expired() && !previous.owner_before(current) && !current.owner_before(previous);
+}
+
+// Appends the hosts of current that are not in previous to added, and the hosts of previous that
+// are not in current to removed.
+void diffHosts(const HostVector& previous, const HostVector& current, HostVector& added,
+               HostVector& removed) {
+  if (&previous == &current) {
+    return;
+  }
+  absl::flat_hash_set<const Host*> remaining;
+  remaining.reserve(previous.size());
+  for (const HostSharedPtr& host : previous) {
+    remaining.insert(host.get());
+  }
+  for (const HostSharedPtr& host : current) {
+    if (remaining.erase(host.get()) == 0) {
+      added.push_back(host);
+    }
+  }
+  if (remaining.empty()) {
+    return;
+  }
+  for (const HostSharedPtr& host : previous) {
+    if (remaining.contains(host.get())) {
+      removed.push_back(host);
+    }
+  }
+}
+
 } // namespace
 
 // Allow disabling ALPN checks for transport sockets. See
@@ -575,6 +608,14 @@ void HostSetImpl::updateHosts(PrioritySet::UpdateHostsParams&& update_hosts_para
     ASSERT(overprovisioning_factor.value() > 0);
     overprovisioning_factor_ = overprovisioning_factor.value();
   }
+  // Only expose a delta that was computed against the lists it replaces. Anything else, for
+  // example the first update of a host set on a worker, needs a full refresh.
+  if (update_hosts_params.delta != nullptr &&
+      isSameList(update_hosts_params.delta->previous_hosts_, hosts_) &&
+      isSameList(update_hosts_params.delta->previous_healthy_hosts_, healthy_hosts_) &&
+      isSameList(update_hosts_params.delta->previous_degraded_hosts_, degraded_hosts_)) {
+    delta_ = std::move(update_hosts_params.delta);
+  }
   hosts_ = std::move(update_hosts_params.hosts);
   healthy_hosts_ = std::move(update_hosts_params.healthy_hosts);
   degraded_hosts_ = std::move(update_hosts_params.degraded_hosts);
@@ -596,6 +637,7 @@ void HostSetImpl::updateHosts(PrioritySet::UpdateHostsParams&& update_hosts_para
                            overprovisioning_factor_);
 
   runUpdateCallbacks(hosts_added, hosts_removed);
+  delta_ = nullptr;
 }
 
 void HostSetImpl::rebuildLocalityScheduler(
@@ -679,7 +721,8 @@ HostSetImpl::updateHostsParams(HostVectorConstSharedPtr hosts,
                                         std::move(hosts_per_locality),
                                         std::move(healthy_hosts_per_locality),
                                         std::move(degraded_hosts_per_locality),
-                                        std::move(excluded_hosts_per_locality)};
+                                        std::move(excluded_hosts_per_locality),
+                                        nullptr};
 }
 
 PrioritySet::UpdateHostsParams HostSetImpl::updateHostsParams(const HostSet& host_set) {
@@ -727,6 +770,50 @@ double HostSetImpl::effectiveLocalityWeight(uint32_t index,
   return weight * effective_locality_availability_ratio;
 }
 
+HostSetDeltaConstSharedPtr
+HostSetDeltaTracker::update(const PrioritySet::UpdateHostsParams& params) {
+  HostSetDeltaConstSharedPtr delta;
+  if (hosts_ != nullptr && weightsFingerprint(*hosts_) == weights_fingerprint_) {
+    auto new_delta = std::make_shared<HostSetDelta>();
+    new_delta->previous_hosts_ = hosts_;
+    new_delta->previous_healthy_hosts_ = healthy_hosts_;
+    new_delta->previous_degraded_hosts_ = degraded_hosts_;
+    diffHosts(*hosts_, *params.hosts, new_delta->hosts_added_, new_delta->hosts_removed_);
+    diffHosts(healthy_hosts_->get(), params.healthy_hosts->get(), new_delta->healthy_hosts_added_,
+              new_delta->healthy_hosts_removed_);
+    diffHosts(degraded_hosts_->get(), params.degraded_hosts->get(),
+              new_delta->degraded_hosts_added_, new_delta->degraded_hosts_removed_);
+
+    // Applying a delta costs about as much per host as a rebuild, so changes of more than half of
+    // the hosts are better handled by a rebuild.
+    const size_t changed =
+        new_delta->hosts_added_.size() + new_delta->hosts_removed_.size() +
+        new_delta->healthy_hosts_added_.size() + new_delta->healthy_hosts_removed_.size() +
+        new_delta->degraded_hosts_added_.size() + new_delta->degraded_hosts_removed_.size();
+    const size_t listed = hosts_->size() + params.hosts->size() + healthy_hosts_->get().size() +
+                          params.healthy_hosts->get().size() + degraded_hosts_->get().size() +
+                          params.degraded_hosts->get().size();
+    if (changed <= listed / 2) {
+      delta = std::move(new_delta);
+    }
+  }
+
+  hosts_ = params.hosts;
+  healthy_hosts_ = params.healthy_hosts;
+  degraded_hosts_ = params.degraded_hosts;
+  weights_fingerprint_ = weightsFingerprint(*hosts_);
+  return delta;
+}
+
+uint64_t HostSetDeltaTracker::weightsFingerprint(const HostVector& hosts) {
+  // An order independent sum, so that only the (host, weight) pairs matter.
+  uint64_t fingerprint = 0;
+  for (const HostSharedPtr& host : hosts) {
+    fingerprint += absl::HashOf(host.get(), host->weight());
+  }
+  return fingerprint;
+}
+
 const HostSet&
 PrioritySetImpl::getOrCreateHostSet(uint32_t priority,
                                     absl::optional<bool> weighted_priority_health,
@@ -584,6 +584,7 @@ public:
   uint32_t priority() const override { return priority_; }
   uint32_t overprovisioningFactor() const override { return overprovisioning_factor_; }
   bool weightedPriorityHealth() const override { return weighted_priority_health_; }
+  const HostSetDelta* updateDelta() const override { return delta_.get(); }
 
   static PrioritySet::UpdateHostsParams
   updateHostsParams(HostVectorConstSharedPtr hosts,
@@ -630,6 +631,8 @@ private:
   HostsPerLocalityConstSharedPtr healthy_hosts_per_locality_{HostsPerLocalityImpl::empty()};
   HostsPerLocalityConstSharedPtr degraded_hosts_per_locality_{HostsPerLocalityImpl::empty()};
   HostsPerLocalityConstSharedPtr excluded_hosts_per_locality_{HostsPerLocalityImpl::empty()};
+  // Set only while the update callbacks of an update with a matching delta run.
+  HostSetDeltaConstSharedPtr delta_;
   // TODO(mattklein123): Remove mutable.
   mutable Common::CallbackManager<uint32_t, const HostVector&, const HostVector&>
       member_update_cb_helper_;
@@ -674,6 +677,31 @@ private:
 
 using HostSetImplPtr = std::unique_ptr<HostSetImpl>;
 
+/**
+ * Remembers the host lists of one priority that were last sent to the workers, and computes the
+ * delta of the next update against them. Used on the main thread.
+ */
+class HostSetDeltaTracker {
+public:
+  /**
+   * Records the lists of an update.
+   * @param params supplies the lists that are about to be sent to the workers.
+   * @return the delta from the previously recorded lists to these ones, or nullptr if there are no
+   *         previous lists, a host weight changed in place, or the change is so large that a full
+   *         refresh is cheaper.
+   */
+  HostSetDeltaConstSharedPtr update(const PrioritySet::UpdateHostsParams& params);
+
+private:
+  static uint64_t weightsFingerprint(const HostVector& hosts);
+
+  HostVectorConstSharedPtr hosts_;
+  HealthyHostVectorConstSharedPtr healthy_hosts_;
+  DegradedHostVectorConstSharedPtr degraded_hosts_;
+  // Weights are updated in place on shared hosts, so they are not visible in a membership diff.
+  uint64_t weights_fingerprint_{};
+};
+
 /**
  * A class for management of the set of hosts in a given cluster.
  */
@@ -223,6 +223,7 @@ private:
     bool enableCommandStats() const override { return true; }
     bool connectionRateLimitEnabled() const override { return false; }
     uint32_t connectionRateLimitPerSec() const override { return 0; }
+    bool enableReplyPassthrough() const override { return false; }
     // For any readPolicy other than Primary, the RedisClientFactory will send a READONLY command
     // when establishing a new connection. Since we're only using this for making the "cluster
     // slots" commands, the READONLY command is not relevant in this context. We're setting it to
@@ -237,6 +238,7 @@ private:
     // Note: Below callback isn't used in topology updates
     void onRedirection(NetworkFilters::Common::Redis::RespValuePtr&&, const std::string&,
                        bool) override {}
+    bool acceptsRawResponse() const override { return false; }
     void onUnexpectedResponse(const NetworkFilters::Common::Redis::RespValuePtr&);
 
     Network::Address::InstanceConstSharedPtr
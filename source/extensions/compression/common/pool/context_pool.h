@@ -0,0 +1,202 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/compression/compressor/compressor.h"
+#include "envoy/compression/decompressor/decompressor.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Common {
+namespace Pool {
+
+/**
+ * All context pool stats. @see stats_macros.h
+ */
+#define ALL_CONTEXT_POOL_STATS(COUNTER)                                                            \
+  COUNTER(hits)                                                                                    \
+  COUNTER(misses)
+
+/**
+ * Struct definition for context pool stats. @see stats_macros.h
+ */
+struct ContextPoolStats {
+  ALL_CONTEXT_POOL_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * A bounded per-worker pool of compression contexts, so that streams reuse the contexts, and the
+ * memory the library allocated for them, of the streams that finished before them on the same
+ * worker instead of initializing new ones. Context must implement bool reset(), which makes it
+ * ready for a new stream as if it was newly initialized, and returns false if it can't be reused.
+ * Contexts are looked up by a key, for contexts that differ by more than the pool's config.
+ */
+template <class Context> class ContextPool {
+public:
+  using ContextPtr = std::unique_ptr<Context>;
+
+  /**
+   * The idle contexts of a worker.
+   */
+  class Contexts {
+  public:
+    explicit Contexts(uint32_t max_size) : max_size_(max_size) {}
+
+    ContextPtr take(const std::string& key) {
+      auto it = contexts_.find(key);
+      if (it == contexts_.end() || it->second.empty()) {
+        return nullptr;
+      }
+      ContextPtr context = std::move(it->second.back());
+      it->second.pop_back();
+      --size_;
+      return context;
+    }
+
+    void release(const std::string& key, ContextPtr context) {
+      if (size_ >= max_size_ || !context->reset()) {
+        return;
+      }
+      contexts_[key].push_back(std::move(context));
+      ++size_;
+    }
+
+    uint32_t size() const { return size_; }
+
+  private:
+    const uint32_t max_size_;
+    uint32_t size_{};
+    absl::flat_hash_map<std::string, std::vector<ContextPtr>> contexts_;
+  };
+
+  /**
+   * A context taken from the pool, which is returned to the pool of its worker when the lease is
+   * destroyed. Leases must be destroyed on the worker they were acquired on.
+   */
+  class Lease {
+  public:
+    Lease(ContextPtr context, std::weak_ptr<Contexts> contexts, const std::string& key)
+        : context_(std::move(context)), contexts_(std::move(contexts)), key_(key) {}
+    Lease(Lease&&) = default;
+    ~Lease() {
+      if (context_ == nullptr) {
+        return;
+      }
+      // The pool of the worker is gone if the pool was destroyed while the context was in use.
+      if (std::shared_ptr<Contexts> contexts = contexts_.lock()) {
+        contexts->release(key_, std::move(context_));
+      }
+    }
+
+    Context& operator*() { return *context_; }
+    Context* operator->() { return context_.get(); }
+
+  private:
+    ContextPtr context_;
+    std::weak_ptr<Contexts> contexts_;
+    std::string key_;
+  };
+
+  /**
+   * @param tls supplies the thread local slot allocator.
+   * @param scope supplies the scope of the pool stats.
+   * @param stats_prefix supplies the prefix of the pool stats.
+   * @param max_size supplies the maximum number of idle contexts pooled by each worker.
+   */
+  ContextPool(ThreadLocal::SlotAllocator& tls, Stats::Scope& scope,
+              const std::string& stats_prefix, uint32_t max_size)
+      : stats_{ALL_CONTEXT_POOL_STATS(POOL_COUNTER_PREFIX(scope, stats_prefix))}, tls_slot_(tls) {
+    tls_slot_.set([max_size](Event::Dispatcher&) {
+      return std::make_shared<ThreadLocalContexts>(max_size);
+    });
+  }
+
+  /**
+   * @param key supplies the key of the context.
+   * @param make_context supplies a function that initializes a new context, if the pool of the
+   *        worker has none for the key.
+   * @return Lease a context for the key.
+   */
+  template <class MakeContext> Lease acquire(const std::string& key, MakeContext make_context) {
+    std::shared_ptr<Contexts>& contexts = tls_slot_->contexts_;
+    ContextPtr context = contexts->take(key);
+    if (context != nullptr) {
+      stats_.hits_.inc();
+    } else {
+      stats_.misses_.inc();
+      context = make_context();
+    }
+    return {std::move(context), contexts, key};
+  }
+
+  /**
+   * @return the number of idle contexts pooled by the current worker.
+   */
+  uint32_t size() { return tls_slot_->contexts_->size(); }
+
+  const ContextPoolStats& stats() const { return stats_; }
+
+private:
+  struct ThreadLocalContexts : public ThreadLocal::ThreadLocalObject {
+    explicit ThreadLocalContexts(uint32_t max_size)
+        : contexts_(std::make_shared<Contexts>(max_size)) {}
+
+    // Shared with the leases, which may outlive the slot.
+    std::shared_ptr<Contexts> contexts_;
+  };
+
+  ContextPoolStats stats_;
+  ThreadLocal::TypedSlot<ThreadLocalContexts> tls_slot_;
+};
+
+template <class Context> using ContextPoolPtr = std::unique_ptr<ContextPool<Context>>;
+
+/**
+ * A compressor that compresses with a pooled context.
+ */
+template <class Context>
+class PooledCompressor : public Envoy::Compression::Compressor::Compressor {
+public:
+  explicit PooledCompressor(typename ContextPool<Context>::Lease lease)
+      : lease_(std::move(lease)) {}
+
+  // Compression::Compressor::Compressor
+  void compress(Buffer::Instance& buffer, Envoy::Compression::Compressor::State state) override {
+    lease_->compress(buffer, state);
+  }
+
+private:
+  typename ContextPool<Context>::Lease lease_;
+};
+
+/**
+ * A decompressor that decompresses with a pooled context.
+ */
+template <class Context>
+class PooledDecompressor : public Envoy::Compression::Decompressor::Decompressor {
+public:
+  explicit PooledDecompressor(typename ContextPool<Context>::Lease lease)
+      : lease_(std::move(lease)) {}
+
+  // Compression::Decompressor::Decompressor
+  void decompress(const Buffer::Instance& input_buffer, Buffer::Instance& output_buffer) override {
+    lease_->decompress(input_buffer, output_buffer);
+  }
+
+private:
+  typename ContextPool<Context>::Lease lease_;
+};
+
+} // namespace Pool
+} // namespace Common
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
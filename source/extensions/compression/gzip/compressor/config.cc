@@ -7,13 +7,21 @@ namespace Gzip {
 namespace Compressor {
 
 GzipCompressorFactory::GzipCompressorFactory(
-    const envoy::extensions::compression::gzip::compressor::v3::Gzip& gzip)
+    const envoy::extensions::compression::gzip::compressor::v3::Gzip& gzip,
+    ThreadLocal::SlotAllocator& tls, Stats::Scope& scope)
     : compression_level_(compressionLevelEnum(gzip.compression_level())),
       compression_strategy_(compressionStrategyEnum(gzip.compression_strategy())),
       memory_level_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, memory_level, DefaultMemoryLevel)),
       window_bits_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, window_bits, DefaultWindowBits) |
                    GzipHeaderValue),
-      chunk_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, chunk_size, DefaultChunkSize)) {}
+      chunk_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, chunk_size, DefaultChunkSize)) {
+  const uint32_t context_pool_size = PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, context_pool_size, 0);
+  if (context_pool_size > 0) {
+    context_pool_ = std::make_unique<Common::Pool::ContextPool<ZlibCompressorImpl>>(
+        tls, scope, absl::StrCat(gzipStatsPrefix(), "compressor_context_pool."),
+        context_pool_size);
+  }
+}
 
 ZlibCompressorImpl::CompressionLevel GzipCompressorFactory::compressionLevelEnum(
     envoy::extensions::compression::gzip::compressor::v3::Gzip::CompressionLevel
@@ -59,17 +67,27 @@ ZlibCompressorImpl::CompressionStrategy GzipCompressorFactory::compressionStrate
   }
 }
 
-Envoy::Compression::Compressor::CompressorPtr GzipCompressorFactory::createCompressor() {
+std::unique_ptr<ZlibCompressorImpl> GzipCompressorFactory::newCompressor() const {
   auto compressor = std::make_unique<ZlibCompressorImpl>(chunk_size_);
   compressor->init(compression_level_, compression_strategy_, window_bits_, memory_level_);
   return compressor;
 }
 
+Envoy::Compression::Compressor::CompressorPtr GzipCompressorFactory::createCompressor() {
+  if (context_pool_ == nullptr) {
+    return newCompressor();
+  }
+  // All the contexts of the pool share the factory's parameters.
+  return std::make_unique<Common::Pool::PooledCompressor<ZlibCompressorImpl>>(
+      context_pool_->acquire("", [this] { return newCompressor(); }));
+}
+
 Envoy::Compression::Compressor::CompressorFactoryPtr
 GzipCompressorLibraryFactory::createCompressorFactoryFromProtoTyped(
     const envoy::extensions::compression::gzip::compressor::v3::Gzip& proto_config,
-    Server::Configuration::FactoryContext&) {
-  return std::make_unique<GzipCompressorFactory>(proto_config);
+    Server::Configuration::FactoryContext& context) {
+  return std::make_unique<GzipCompressorFactory>(
+      proto_config, context.serverFactoryContext().threadLocal(), context.scope());
 }
 
 /**
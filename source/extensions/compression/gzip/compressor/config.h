@@ -6,6 +6,7 @@
 
 #include "source/common/http/headers.h"
 #include "source/extensions/compression/common/compressor/factory_base.h"
+#include "source/extensions/compression/common/pool/context_pool.h"
 #include "source/extensions/compression/gzip/compressor/zlib_compressor_impl.h"
 
 namespace Envoy {
@@ -38,7 +39,8 @@ const std::string& gzipExtensionName() {
 
 class GzipCompressorFactory : public Envoy::Compression::Compressor::CompressorFactory {
 public:
-  GzipCompressorFactory(const envoy::extensions::compression::gzip::compressor::v3::Gzip& gzip);
+  GzipCompressorFactory(const envoy::extensions::compression::gzip::compressor::v3::Gzip& gzip,
+                        ThreadLocal::SlotAllocator& tls, Stats::Scope& scope);
 
   // Envoy::Compression::Compressor::CompressorFactory
   Envoy::Compression::Compressor::CompressorPtr createCompressor() override;
@@ -55,11 +57,15 @@ private:
       envoy::extensions::compression::gzip::compressor::v3::Gzip::CompressionStrategy
           compression_strategy);
 
+  std::unique_ptr<ZlibCompressorImpl> newCompressor() const;
+
   ZlibCompressorImpl::CompressionLevel compression_level_;
   ZlibCompressorImpl::CompressionStrategy compression_strategy_;
   const int32_t memory_level_;
   const int32_t window_bits_;
   const uint32_t chunk_size_;
+  // Null unless the config enables context pooling.
+  Common::Pool::ContextPoolPtr<ZlibCompressorImpl> context_pool_;
 };
 
 class GzipCompressorLibraryFactory
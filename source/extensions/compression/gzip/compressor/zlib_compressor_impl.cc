@@ -37,6 +37,13 @@ void ZlibCompressorImpl::init(CompressionLevel comp_level, CompressionStrategy c
   initialized_ = true;
 }
 
+bool ZlibCompressorImpl::reset() {
+  ASSERT(initialized_);
+  zstream_ptr_->avail_out = chunk_size_;
+  zstream_ptr_->next_out = chunk_char_ptr_.get();
+  return deflateReset(zstream_ptr_.get()) == Z_OK;
+}
+
 void ZlibCompressorImpl::compress(Buffer::Instance& buffer,
                                   Envoy::Compression::Compressor::State state) {
   for (const Buffer::RawSlice& input_slice : buffer.getRawSlices()) {
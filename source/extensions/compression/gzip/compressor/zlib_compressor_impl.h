@@ -82,6 +82,13 @@ public:
   void init(CompressionLevel level, CompressionStrategy strategy, int64_t window_bits,
             uint64_t memory_level);
 
+  /**
+   * Resets the compressor, keeping its parameters and the memory it allocated, so that it can
+   * compress a new stream. Pending output is discarded.
+   * @return bool whether the compressor was reset.
+   */
+  bool reset();
+
   // Compression::Compressor::Compressor
   void compress(Buffer::Instance& buffer, Envoy::Compression::Compressor::State state) override;
 
@@ -16,27 +16,49 @@ const uint64_t DefaultMaxInflateRatio = 100;
 } // namespace
 
 GzipDecompressorFactory::GzipDecompressorFactory(
-    const envoy::extensions::compression::gzip::decompressor::v3::Gzip& gzip, Stats::Scope& scope)
+    const envoy::extensions::compression::gzip::decompressor::v3::Gzip& gzip, Stats::Scope& scope,
+    ThreadLocal::SlotAllocator& tls)
     : scope_(scope),
       window_bits_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, window_bits, DefaultWindowBits) |
                    GzipHeaderValue),
       chunk_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, chunk_size, DefaultChunkSize)),
       max_inflate_ratio_(
-          PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, max_inflate_ratio, DefaultMaxInflateRatio)) {}
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, max_inflate_ratio, DefaultMaxInflateRatio)) {
+  const uint32_t context_pool_size = PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, context_pool_size, 0);
+  if (context_pool_size > 0) {
+    context_pool_ = std::make_unique<Common::Pool::ContextPool<ZlibDecompressorImpl>>(
+        tls, scope, absl::StrCat(gzipStatsPrefix(), "decompressor_context_pool."),
+        context_pool_size);
+  }
+}
 
-Envoy::Compression::Decompressor::DecompressorPtr
-GzipDecompressorFactory::createDecompressor(const std::string& stats_prefix) {
+std::unique_ptr<ZlibDecompressorImpl>
+GzipDecompressorFactory::newDecompressor(const std::string& stats_prefix) const {
   auto decompressor =
       std::make_unique<ZlibDecompressorImpl>(scope_, stats_prefix, chunk_size_, max_inflate_ratio_);
   decompressor->init(window_bits_);
   return decompressor;
 }
 
+Envoy::Compression::Decompressor::DecompressorPtr
+GzipDecompressorFactory::createDecompressor(const std::string& stats_prefix) {
+  if (context_pool_ == nullptr) {
+    return newDecompressor(stats_prefix);
+  }
+  // The stats of a context are those of the prefix it was created with, so contexts are only
+  // reused for the same prefix.
+  return std::make_unique<Common::Pool::PooledDecompressor<ZlibDecompressorImpl>>(
+      context_pool_->acquire(stats_prefix, [this, &stats_prefix] {
+        return newDecompressor(stats_prefix);
+      }));
+}
+
 Envoy::Compression::Decompressor::DecompressorFactoryPtr
 GzipDecompressorLibraryFactory::createDecompressorFactoryFromProtoTyped(
     const envoy::extensions::compression::gzip::decompressor::v3::Gzip& proto_config,
     Server::Configuration::FactoryContext& context) {
-  return std::make_unique<GzipDecompressorFactory>(proto_config, context.scope());
+  return std::make_unique<GzipDecompressorFactory>(
+      proto_config, context.scope(), context.serverFactoryContext().threadLocal());
 }
 
 /**
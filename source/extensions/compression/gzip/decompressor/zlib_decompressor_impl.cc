@@ -39,6 +39,14 @@ void ZlibDecompressorImpl::init(int64_t window_bits) {
   initialized_ = true;
 }
 
+bool ZlibDecompressorImpl::reset() {
+  ASSERT(initialized_);
+  zstream_ptr_->avail_out = chunk_size_;
+  zstream_ptr_->next_out = chunk_char_ptr_.get();
+  decompression_error_ = 0;
+  return inflateReset(zstream_ptr_.get()) == Z_OK;
+}
+
 void ZlibDecompressorImpl::decompress(const Buffer::Instance& input_buffer,
                                       Buffer::Instance& output_buffer) {
   uint64_t limit = max_inflate_ratio_ * input_buffer.length();
@@ -59,6 +59,13 @@ public:
    */
   void init(int64_t window_bits);
 
+  /**
+   * Resets the decompressor, keeping its parameters and the memory it allocated, so that it can
+   * decompress a new stream. Pending output and the decompression error are discarded.
+   * @return bool whether the decompressor was reset.
+   */
+  bool reset();
+
   // Compression::Decompressor::Decompressor
   void decompress(const Buffer::Instance& input_buffer, Buffer::Instance& output_buffer) override;
 
@@ -39,6 +39,9 @@ public:
   void requestOnDemandUpdate(const absl::flat_hash_set<std::string>&) override {
     ENVOY_BUG(false, "unexpected request for on demand update");
   }
+  void requestOnDemandRemoval(const absl::flat_hash_set<std::string>&) override {
+    ENVOY_BUG(false, "unexpected request for on demand removal");
+  }
 
 protected:
   virtual std::string refreshInternal(ProtobufTypes::MessagePtr* config_update);
@@ -59,7 +59,8 @@ std::string convertToWildcard(const std::string& resource_name) {
 }
 } // namespace
 
-GrpcMuxImpl::GrpcMuxImpl(GrpcMuxContext& grpc_mux_context, bool skip_subsequent_node)
+GrpcMuxImpl::GrpcMuxImpl(GrpcMuxContext& grpc_mux_context, bool skip_subsequent_node,
+                         ResourceDecodePoolSharedPtr resource_decode_pool)
     : grpc_stream_(this, std::move(grpc_mux_context.async_client_),
                    grpc_mux_context.service_method_, grpc_mux_context.dispatcher_,
                    grpc_mux_context.scope_, std::move(grpc_mux_context.backoff_strategy_),
@@ -75,8 +76,13 @@ GrpcMuxImpl::GrpcMuxImpl(GrpcMuxContext& grpc_mux_context, bool skip_subsequent_
           grpc_mux_context.local_info_.contextProvider().addDynamicContextUpdateCallback(
               [this](absl::string_view resource_type_url) {
                 onDynamicContextUpdate(resource_type_url);
-              })) {
+              })),
+      resource_decode_pool_(std::move(resource_decode_pool)) {
   Config::Utility::checkLocalInfo("ads", local_info_);
+  if (xds_resources_delegate_.has_value() && xds_resources_delegate_->loadOnStartup()) {
+    load_from_delegate_cb_ =
+        dispatcher_.createSchedulableCallback([this]() { loadWatchedConfigFromDelegate(); });
+  }
   AllMuxes::get().insert(this);
 }
 
@@ -231,6 +237,12 @@ GrpcMuxWatchPtr GrpcMuxImpl::addWatch(const std::string& type_url,
   // only send a single RDS/EDS update after the CDS/LDS update.
   queueDiscoveryRequest(type_url);
 
+  if (load_from_delegate_cb_ != nullptr && !apiStateFor(type_url).previously_fetched_data_) {
+    // The persisted config is loaded once the subscription has started, and is used until the xDS
+    // server responds.
+    load_from_delegate_cb_->scheduleCallbackCurrentIteration();
+  }
+
   return watch;
 }
 
@@ -264,9 +276,50 @@ ScopedResume GrpcMuxImpl::pause(const std::vector<std::string> type_urls) {
 void GrpcMuxImpl::onDiscoveryResponse(
     std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse>&& message,
     ControlPlaneStats& control_plane_stats) {
-  const std::string type_url = message->type_url();
-  ENVOY_LOG(debug, "Received gRPC message for {} at version {}", type_url, message->version_info());
+  ENVOY_LOG(debug, "Received gRPC message for {} at version {}", message->type_url(),
+            message->version_info());
+  if (resource_decode_pool_ == nullptr) {
+    processDiscoveryResponse(*message, control_plane_stats, nullptr);
+    return;
+  }
+  // Responses are processed in the order they were received, so the response waits for the
+  // resources of the earlier ones to be decoded.
+  pending_responses_.push({std::move(message), control_plane_stats});
+  decodeNextResponse();
+}
+
+void GrpcMuxImpl::decodeNextResponse() {
+  while (decode_handle_ == nullptr && !pending_responses_.empty()) {
+    auto api_state = api_state_.find(pending_responses_.front().message_->type_url());
+    if (api_state == api_state_.end() || api_state->second->watches_.empty()) {
+      // The resources of the response are ignored, so there is nothing to decode.
+      PendingResponse response = std::move(pending_responses_.front());
+      pending_responses_.pop();
+      processDiscoveryResponse(*response.message_, response.control_plane_stats_, nullptr);
+      continue;
+    }
+    decode_handle_ = resource_decode_pool_->decode(
+        pending_responses_.front().message_, api_state->second->watches_.front()->resource_decoder_,
+        dispatcher_, [this](DecodedDiscoveryResponse&& decoded) {
+          decode_handle_.reset();
+          PendingResponse response = std::move(pending_responses_.front());
+          pending_responses_.pop();
+          processDiscoveryResponse(*response.message_, response.control_plane_stats_, &decoded);
+          decodeNextResponse();
+        });
+  }
+}
 
+void GrpcMuxImpl::clearPendingResponses() {
+  // The server sends the responses again on the next stream, if they are still current.
+  decode_handle_.reset();
+  pending_responses_ = {};
+}
+
+void GrpcMuxImpl::processDiscoveryResponse(
+    const envoy::service::discovery::v3::DiscoveryResponse& message,
+    ControlPlaneStats& control_plane_stats, DecodedDiscoveryResponse* decoded) {
+  const std::string& type_url = message.type_url();
   if (api_state_.count(type_url) == 0) {
     // TODO(yuval-k): This should never happen. consider dropping the stream as this is a
     // protocol violation
@@ -277,11 +330,11 @@ void GrpcMuxImpl::onDiscoveryResponse(
 
   ApiState& api_state = apiStateFor(type_url);
 
-  if (message->has_control_plane()) {
-    control_plane_stats.identifier_.set(message->control_plane().identifier());
+  if (message.has_control_plane()) {
+    control_plane_stats.identifier_.set(message.control_plane().identifier());
 
-    if (message->control_plane().identifier() != api_state.control_plane_identifier_) {
-      api_state.control_plane_identifier_ = message->control_plane().identifier();
+    if (message.control_plane().identifier() != api_state.control_plane_identifier_) {
+      api_state.control_plane_identifier_ = message.control_plane().identifier();
       ENVOY_LOG(debug, "Receiving gRPC updates for {} from {}", type_url,
                 api_state.control_plane_identifier_);
     }
@@ -289,14 +342,14 @@ void GrpcMuxImpl::onDiscoveryResponse(
 
   if (api_state.watches_.empty()) {
     // update the nonce as we are processing this response.
-    api_state.request_.set_response_nonce(message->nonce());
-    if (message->resources().empty()) {
+    api_state.request_.set_response_nonce(message.nonce());
+    if (message.resources().empty()) {
       // No watches and no resources. This can happen when envoy unregisters from a
       // resource that's removed from the server as well. For example, a deleted cluster
       // triggers un-watching the ClusterLoadAssignment watch, and at the same time the
       // xDS server sends an empty list of ClusterLoadAssignment resources. we'll accept
       // this update. no need to send a discovery request, as we don't watch for anything.
-      api_state.request_.set_version_info(message->version_info());
+      api_state.request_.set_version_info(message.version_info());
     } else {
       // No watches and we have resources - this should not happen. send a NACK (by not
       // updating the version).
@@ -313,26 +366,26 @@ void GrpcMuxImpl::onDiscoveryResponse(
   same_type_resume = pause(type_url);
   TRY_ASSERT_MAIN_THREAD {
     std::vector<DecodedResourcePtr> resources;
-    OpaqueResourceDecoder& resource_decoder = *api_state.watches_.front()->resource_decoder_;
-
-    for (const auto& resource : message->resources()) {
-      // TODO(snowp): Check the underlying type when the resource is a Resource.
-      if (!resource.Is<envoy::service::discovery::v3::Resource>() &&
-          type_url != resource.type_url()) {
-        throw EnvoyException(
-            fmt::format("{} does not match the message-wide type URL {} in DiscoveryResponse {}",
-                        resource.type_url(), type_url, message->DebugString()));
+    if (decoded != nullptr) {
+      if (decoded->error_.has_value()) {
+        throw EnvoyException(*decoded->error_);
       }
-
-      auto decoded_resource =
-          DecodedResourceImpl::fromResource(resource_decoder, resource, message->version_info());
-
-      if (!isHeartbeatResource(type_url, *decoded_resource)) {
-        resources.emplace_back(std::move(decoded_resource));
+      for (DecodedResourcePtr& decoded_resource : decoded->resources_) {
+        if (!isHeartbeatResource(type_url, *decoded_resource)) {
+          resources.emplace_back(std::move(decoded_resource));
+        }
+      }
+    } else {
+      OpaqueResourceDecoder& resource_decoder = *api_state.watches_.front()->resource_decoder_;
+      for (int i = 0; i < message.resources_size(); ++i) {
+        auto decoded_resource = ResourceDecodePool::decodeResource(message, i, resource_decoder);
+        if (!isHeartbeatResource(type_url, *decoded_resource)) {
+          resources.emplace_back(std::move(decoded_resource));
+        }
       }
     }
 
-    processDiscoveryResources(resources, api_state, type_url, message->version_info(),
+    processDiscoveryResources(resources, api_state, type_url, message.version_info(),
                               /*call_delegate=*/true);
 
     // Processing point when resources are successfully ingested.
@@ -352,15 +405,34 @@ void GrpcMuxImpl::onDiscoveryResponse(
 
     // Processing point when there is any exception during the parse and ingestion process.
     if (xds_config_tracker_.has_value()) {
-      xds_config_tracker_->onConfigRejected(*message, error_detail->message());
+      xds_config_tracker_->onConfigRejected(message, error_detail->message());
     }
   }
   api_state.previously_fetched_data_ = true;
-  api_state.request_.set_response_nonce(message->nonce());
+  api_state.request_.set_response_nonce(message.nonce());
   ASSERT(api_state.paused());
   queueDiscoveryRequest(type_url);
 }
 
+void GrpcMuxImpl::loadWatchedConfigFromDelegate() {
+  // Loading the config of a type may add watches on other types, so the types are collected first.
+  std::vector<std::string> type_urls;
+  for (const auto& [type_url, api_state] : api_state_) {
+    if (!api_state->previously_fetched_data_ && !api_state->watches_.empty()) {
+      type_urls.push_back(type_url);
+    }
+  }
+  for (const std::string& type_url : type_urls) {
+    ApiState& api_state = apiStateFor(type_url);
+    absl::flat_hash_set<std::string> resource_names;
+    for (const auto* watch : api_state.watches_) {
+      resource_names.insert(watch->resources_.begin(), watch->resources_.end());
+    }
+    loadConfigFromDelegate(type_url, resource_names);
+    api_state.previously_fetched_data_ = true;
+  }
+}
+
 void GrpcMuxImpl::processDiscoveryResources(const std::vector<DecodedResourcePtr>& resources,
                                             ApiState& api_state, const std::string& type_url,
                                             const std::string& version_info,
@@ -468,6 +540,7 @@ void GrpcMuxImpl::processDiscoveryResources(const std::vector<DecodedResourcePtr
 void GrpcMuxImpl::onWriteable() { drainRequests(); }
 
 void GrpcMuxImpl::onStreamEstablished() {
+  clearPendingResponses();
   first_stream_request_ = true;
   grpc_stream_.maybeUpdateQueueSizeStat(0);
   clearNonce();
@@ -478,6 +551,7 @@ void GrpcMuxImpl::onStreamEstablished() {
 }
 
 void GrpcMuxImpl::onEstablishmentFailure() {
+  clearPendingResponses();
   for (const auto& api_state : api_state_) {
     for (auto watch : api_state.second->watches_) {
       watch->callbacks_.onConfigUpdateFailed(
@@ -566,7 +640,7 @@ public:
   void shutdownAll() override { return GrpcMuxImpl::shutdownAll(); }
   std::shared_ptr<GrpcMux>
   create(Grpc::RawAsyncClientPtr&& async_client, Event::Dispatcher& dispatcher,
-         Random::RandomGenerator&, Stats::Scope& scope,
+         Random::RandomGenerator&, Thread::ThreadFactory& thread_factory, Stats::Scope& scope,
          const envoy::config::core::v3::ApiConfigSource& ads_config,
          const LocalInfo::LocalInfo& local_info, CustomConfigValidatorsPtr&& config_validators,
          BackOffStrategyPtr&& backoff_strategy, XdsConfigTrackerOptRef xds_config_tracker,
@@ -590,8 +664,9 @@ public:
          Runtime::runtimeFeatureEnabled("envoy.restart_features.use_eds_cache_for_ads"))
             ? std::make_unique<EdsResourcesCacheImpl>(dispatcher)
             : nullptr};
-    return std::make_shared<Config::GrpcMuxImpl>(grpc_mux_context,
-                                                 ads_config.set_node_on_first_message_only());
+    return std::make_shared<Config::GrpcMuxImpl>(
+        grpc_mux_context, ads_config.set_node_on_first_message_only(),
+        ResourceDecodePool::get(thread_factory, ads_config.resource_decoding_threads()));
   }
 };
 
@@ -28,6 +28,7 @@
 #include "source/common/config/xds_resource.h"
 #include "source/extensions/config_subscription/grpc/grpc_mux_context.h"
 #include "source/extensions/config_subscription/grpc/grpc_stream.h"
+#include "source/extensions/config_subscription/grpc/resource_decode_pool.h"
 
 #include "absl/container/node_hash_map.h"
 #include "xds/core/v3/resource_name.pb.h"
@@ -41,7 +42,10 @@ class GrpcMuxImpl : public GrpcMux,
                     public GrpcStreamCallbacks<envoy::service::discovery::v3::DiscoveryResponse>,
                     public Logger::Loggable<Logger::Id::config> {
 public:
-  GrpcMuxImpl(GrpcMuxContext& grpc_mux_context, bool skip_subsequent_node);
+  // If resource_decode_pool is set, the resources of the responses are decoded on it instead of on
+  // the main thread.
+  GrpcMuxImpl(GrpcMuxContext& grpc_mux_context, bool skip_subsequent_node,
+              ResourceDecodePoolSharedPtr resource_decode_pool = nullptr);
 
   ~GrpcMuxImpl() override;
 
@@ -68,6 +72,8 @@ public:
 
   void requestOnDemandUpdate(const std::string&, const absl::flat_hash_set<std::string>&) override {
   }
+  void requestOnDemandRemoval(const std::string&,
+                              const absl::flat_hash_set<std::string>&) override {}
 
   EdsResourcesCacheOptRef edsResourcesCache() override {
     return makeOptRefFromPtr(eds_resources_cache_.get());
@@ -240,6 +246,22 @@ private:
     bool previously_fetched_data_{false};
   };
 
+  // A response received while the resources of an earlier response are decoded.
+  struct PendingResponse {
+    std::shared_ptr<const envoy::service::discovery::v3::DiscoveryResponse> message_;
+    ControlPlaneStats& control_plane_stats_;
+  };
+
+  // Processes a response, with its resources decoded on the resource decode pool if decoded isn't
+  // null, or decoding them otherwise.
+  void processDiscoveryResponse(const envoy::service::discovery::v3::DiscoveryResponse& message,
+                                ControlPlaneStats& control_plane_stats,
+                                DecodedDiscoveryResponse* decoded);
+  // Decodes the resources of the oldest pending response on the resource decode pool, unless
+  // resources are being decoded already.
+  void decodeNextResponse();
+  // Drops the responses that are waiting to be decoded, when their stream is gone.
+  void clearPendingResponses();
   bool isHeartbeatResource(const std::string& type_url, const DecodedResource& resource) {
     return !resource.hasResource() &&
            resource.version() == apiStateFor(type_url).request_.version_info();
@@ -252,6 +274,8 @@ private:
   // Must be invoked from the main or test thread.
   void loadConfigFromDelegate(const std::string& type_url,
                               const absl::flat_hash_set<std::string>& resource_names);
+  // Loads the persisted config of the watched types that weren't fetched yet.
+  void loadWatchedConfigFromDelegate();
   // Must be invoked from the main or test thread.
   void processDiscoveryResources(const std::vector<DecodedResourcePtr>& resources,
                                  ApiState& api_state, const std::string& type_url,
@@ -290,6 +314,15 @@ private:
   // True iff Envoy is shutting down; no messages should be sent on the `grpc_stream_` when this is
   // true because it may contain dangling pointers.
   std::atomic<bool> shutdown_{false};
+
+  // Set if the resources of the responses are decoded off the main thread.
+  ResourceDecodePoolSharedPtr resource_decode_pool_;
+  // The responses whose resources are yet to be decoded, in the order they were received.
+  std::queue<PendingResponse> pending_responses_;
+  // Set while the resources of the front pending response are decoded.
+  ResourceDecodeHandlePtr decode_handle_;
+  // Set if the xDS resources delegate loads the persisted config on startup.
+  Event::SchedulableCallbackPtr load_from_delegate_cb_;
 };
 
 using GrpcMuxImplPtr = std::unique_ptr<GrpcMuxImpl>;
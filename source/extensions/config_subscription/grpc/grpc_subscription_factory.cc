@@ -46,8 +46,10 @@ GrpcConfigSubscriptionFactory::create(ConfigSubscriptionFactory::SubscriptionDat
     mux = std::make_shared<Config::XdsMux::GrpcMuxSotw>(
         grpc_mux_context, api_config_source.set_node_on_first_message_only());
   } else {
-    mux = std::make_shared<Config::GrpcMuxImpl>(grpc_mux_context,
-                                                api_config_source.set_node_on_first_message_only());
+    mux = std::make_shared<Config::GrpcMuxImpl>(
+        grpc_mux_context, api_config_source.set_node_on_first_message_only(),
+        ResourceDecodePool::get(data.api_.threadFactory(),
+                                api_config_source.resource_decoding_threads()));
   }
   return std::make_unique<GrpcSubscriptionImpl>(
       std::move(mux), data.callbacks_, data.resource_decoder_, data.stats_, data.type_url_,
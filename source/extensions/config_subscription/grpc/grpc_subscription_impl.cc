@@ -63,6 +63,12 @@ void GrpcSubscriptionImpl::requestOnDemandUpdate(
   stats_.update_attempt_.inc();
 }
 
+void GrpcSubscriptionImpl::requestOnDemandRemoval(
+    const absl::flat_hash_set<std::string>& for_removal) {
+  grpc_mux_->requestOnDemandRemoval(type_url_, for_removal);
+  stats_.update_attempt_.inc();
+}
+
 // Config::SubscriptionCallbacks
 absl::Status
 GrpcSubscriptionImpl::onConfigUpdate(const std::vector<Config::DecodedResourceRef>& resources,
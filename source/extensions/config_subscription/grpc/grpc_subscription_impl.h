@@ -32,6 +32,8 @@ public:
   void
   updateResourceInterest(const absl::flat_hash_set<std::string>& update_to_these_names) override;
   void requestOnDemandUpdate(const absl::flat_hash_set<std::string>& add_these_names) override;
+  void
+  requestOnDemandRemoval(const absl::flat_hash_set<std::string>& remove_these_names) override;
   // Config::SubscriptionCallbacks (all pass through to callbacks_!)
   absl::Status onConfigUpdate(const std::vector<Config::DecodedResourceRef>& resources,
                               const std::string& version_info) override;
@@ -55,6 +55,8 @@ public:
 
   void requestOnDemandUpdate(const std::string& type_url,
                              const absl::flat_hash_set<std::string>& for_update) override;
+  void requestOnDemandRemoval(const std::string& type_url,
+                              const absl::flat_hash_set<std::string>& for_removal) override;
 
   EdsResourcesCacheOptRef edsResourcesCache() override {
     return makeOptRefFromPtr(eds_resources_cache_.get());
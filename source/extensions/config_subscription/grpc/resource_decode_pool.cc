@@ -0,0 +1,203 @@
+#include "source/extensions/config_subscription/grpc/resource_decode_pool.h"
+
+#include <algorithm>
+
+#include "envoy/common/exception.h"
+
+#include "source/common/common/macros.h"
+#include "source/common/common/thread.h"
+#include "source/common/config/decoded_resource_impl.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Config {
+
+namespace {
+
+struct SharedPools {
+  absl::Mutex mutex_;
+  absl::flat_hash_map<uint32_t, std::weak_ptr<ResourceDecodePool>> pools_ ABSL_GUARDED_BY(mutex_);
+};
+
+SharedPools& sharedPools() { MUTABLE_CONSTRUCT_ON_FIRST_USE(SharedPools); }
+
+// The state of the decoding of a response, shared by the chunks of the response and its handle.
+struct DecodeState {
+  DecodeState(std::shared_ptr<const envoy::service::discovery::v3::DiscoveryResponse> response,
+              OpaqueResourceDecoderSharedPtr resource_decoder, Event::Dispatcher& dispatcher,
+              std::function<void(DecodedDiscoveryResponse&&)> on_decoded, int chunk_count)
+      : response_(std::move(response)), resource_decoder_(std::move(resource_decoder)),
+        dispatcher_(dispatcher), on_decoded_(std::move(on_decoded)),
+        resources_(response_->resources_size()), errors_(chunk_count),
+        remaining_chunks_(chunk_count) {}
+
+  const std::shared_ptr<const envoy::service::discovery::v3::DiscoveryResponse> response_;
+  const OpaqueResourceDecoderSharedPtr resource_decoder_;
+  Event::Dispatcher& dispatcher_;
+  const std::function<void(DecodedDiscoveryResponse&&)> on_decoded_;
+  // Each chunk only writes the slots of its resources, and its own error.
+  std::vector<DecodedResourcePtr> resources_;
+  std::vector<absl::optional<std::string>> errors_;
+  std::atomic<int> remaining_chunks_;
+  std::atomic<bool> cancelled_{false};
+  // Makes sure the result isn't posted to the dispatcher after the handle was destroyed, when the
+  // dispatcher may be gone.
+  absl::Mutex post_mutex_;
+};
+
+class ResourceDecodeHandleImpl : public ResourceDecodeHandle {
+public:
+  explicit ResourceDecodeHandleImpl(std::shared_ptr<DecodeState> state)
+      : state_(std::move(state)) {}
+  ~ResourceDecodeHandleImpl() override {
+    absl::MutexLock lock(&state_->post_mutex_);
+    state_->cancelled_ = true;
+  }
+
+private:
+  const std::shared_ptr<DecodeState> state_;
+};
+
+void postResult(const std::shared_ptr<DecodeState>& state) {
+  absl::MutexLock lock(&state->post_mutex_);
+  if (state->cancelled_) {
+    return;
+  }
+  state->dispatcher_.post([state]() {
+    // The handle is destroyed on this thread, so the decoding can't be cancelled meanwhile.
+    if (state->cancelled_) {
+      return;
+    }
+    DecodedDiscoveryResponse decoded;
+    for (absl::optional<std::string>& error : state->errors_) {
+      if (error.has_value()) {
+        decoded.error_ = std::move(error);
+        break;
+      }
+    }
+    if (!decoded.error_.has_value()) {
+      decoded.resources_ = std::move(state->resources_);
+    }
+    state->on_decoded_(std::move(decoded));
+  });
+}
+
+void decodeChunk(const std::shared_ptr<DecodeState>& state, int chunk) {
+  const int begin = chunk * ResourceDecodePool::ChunkSize;
+  const int end =
+      std::min(begin + ResourceDecodePool::ChunkSize, state->response_->resources_size());
+  for (int i = begin; i < end && !state->cancelled_; ++i) {
+    TRY_NEEDS_AUDIT {
+      state->resources_[i] =
+          ResourceDecodePool::decodeResource(*state->response_, i, *state->resource_decoder_);
+    }
+    END_TRY
+    catch (const EnvoyException& e) {
+      // Like on the main thread, the response is rejected with the error of its first invalid
+      // resource, so the rest of the chunk doesn't matter.
+      state->errors_[chunk] = e.what();
+      break;
+    }
+  }
+  if (state->remaining_chunks_.fetch_sub(1) == 1) {
+    postResult(state);
+  }
+}
+
+} // namespace
+
+ResourceDecodePool::ResourceDecodePool(Thread::ThreadFactory& thread_factory,
+                                       uint32_t thread_count) {
+  ENVOY_LOG(debug, "creating a resource decode pool with {} threads", thread_count);
+  threads_.reserve(thread_count);
+  while (threads_.size() < thread_count) {
+    threads_.push_back(thread_factory.createThread(
+        [this]() { worker(); }, Thread::Options{absl::StrCat("xds_decode:", threads_.size())}));
+  }
+}
+
+ResourceDecodePool::~ResourceDecodePool() {
+  {
+    absl::MutexLock lock(&queue_mutex_);
+    terminate_ = true;
+  }
+  for (Thread::ThreadPtr& thread : threads_) {
+    thread->join();
+  }
+}
+
+std::shared_ptr<ResourceDecodePool> ResourceDecodePool::get(Thread::ThreadFactory& thread_factory,
+                                                            uint32_t thread_count) {
+  if (thread_count == 0) {
+    return nullptr;
+  }
+  SharedPools& shared_pools = sharedPools();
+  absl::MutexLock lock(&shared_pools.mutex_);
+  std::weak_ptr<ResourceDecodePool>& weak_pool = shared_pools.pools_[thread_count];
+  std::shared_ptr<ResourceDecodePool> pool = weak_pool.lock();
+  if (pool == nullptr) {
+    pool = std::make_shared<ResourceDecodePool>(thread_factory, thread_count);
+    weak_pool = pool;
+  }
+  return pool;
+}
+
+ResourceDecodeHandlePtr ResourceDecodePool::decode(
+    std::shared_ptr<const envoy::service::discovery::v3::DiscoveryResponse> response,
+    OpaqueResourceDecoderSharedPtr resource_decoder, Event::Dispatcher& dispatcher,
+    std::function<void(DecodedDiscoveryResponse&&)> on_decoded) {
+  const int chunk_count = (response->resources_size() + ChunkSize - 1) / ChunkSize;
+  auto state = std::make_shared<DecodeState>(std::move(response), std::move(resource_decoder),
+                                             dispatcher, std::move(on_decoded), chunk_count);
+  if (chunk_count == 0) {
+    postResult(state);
+  }
+  for (int chunk = 0; chunk < chunk_count; ++chunk) {
+    post([state, chunk]() { decodeChunk(state, chunk); });
+  }
+  return std::make_unique<ResourceDecodeHandleImpl>(std::move(state));
+}
+
+DecodedResourcePtr
+ResourceDecodePool::decodeResource(const envoy::service::discovery::v3::DiscoveryResponse& response,
+                                   int index, OpaqueResourceDecoder& resource_decoder) {
+  const ProtobufWkt::Any& resource = response.resources(index);
+  // TODO(snowp): Check the underlying type when the resource is a Resource.
+  if (!resource.Is<envoy::service::discovery::v3::Resource>() &&
+      response.type_url() != resource.type_url()) {
+    throw EnvoyException(
+        fmt::format("{} does not match the message-wide type URL {} in DiscoveryResponse {}",
+                    resource.type_url(), response.type_url(), response.DebugString()));
+  }
+  return DecodedResourceImpl::fromResource(resource_decoder, resource, response.version_info());
+}
+
+void ResourceDecodePool::post(std::function<void()> work) {
+  absl::MutexLock lock(&queue_mutex_);
+  queue_.push(std::move(work));
+}
+
+void ResourceDecodePool::worker() {
+  while (true) {
+    const auto condition = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(queue_mutex_) {
+      return !queue_.empty() || terminate_;
+    };
+    std::function<void()> work;
+    {
+      absl::MutexLock lock(&queue_mutex_);
+      queue_mutex_.Await(absl::Condition(&condition));
+      if (terminate_) {
+        // The handles of the queued work were destroyed before the pool, so it can be dropped.
+        return;
+      }
+      work = std::move(queue_.front());
+      queue_.pop();
+    }
+    work();
+  }
+}
+
+} // namespace Config
+} // namespace Envoy
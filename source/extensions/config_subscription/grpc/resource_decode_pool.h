@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "envoy/config/subscription.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/service/discovery/v3/discovery.pb.h"
+#include "envoy/thread/thread.h"
+
+#include "source/common/common/logger.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Config {
+
+/**
+ * The resources of a DiscoveryResponse, decoded in the order of the response.
+ */
+struct DecodedDiscoveryResponse {
+  std::vector<DecodedResourcePtr> resources_;
+  // The error of the first resource that could not be decoded, if any. resources_ is empty if
+  // this is set.
+  absl::optional<std::string> error_;
+};
+
+/**
+ * Cancels the decoding of a response when destroyed.
+ */
+class ResourceDecodeHandle {
+public:
+  virtual ~ResourceDecodeHandle() = default;
+};
+
+using ResourceDecodeHandlePtr = std::unique_ptr<ResourceDecodeHandle>;
+
+/**
+ * A bounded pool of threads that unpack and validate the resources of xDS responses, so that large
+ * responses don't block the main thread. The resources of a response are split in chunks that are
+ * decoded in parallel, and the decoded response is posted back to the dispatcher of the caller.
+ */
+class ResourceDecodePool : Logger::Loggable<Logger::Id::config> {
+public:
+  ResourceDecodePool(Thread::ThreadFactory& thread_factory, uint32_t thread_count);
+  ~ResourceDecodePool() ABSL_LOCKS_EXCLUDED(queue_mutex_);
+
+  /**
+   * @return the pool with the given number of threads, or nullptr if thread_count is 0. The pool is
+   *         shared by the callers that ask for the same number of threads, and its threads are
+   *         joined once none holds it.
+   */
+  static std::shared_ptr<ResourceDecodePool> get(Thread::ThreadFactory& thread_factory,
+                                                 uint32_t thread_count);
+
+  /**
+   * Decodes the resources of a response, as decodeResource() does, on the pool threads.
+   * on_decoded is posted to the dispatcher once all resources are decoded, unless the returned
+   * handle was destroyed before. The handle must be destroyed on the dispatcher thread.
+   */
+  ResourceDecodeHandlePtr
+  decode(std::shared_ptr<const envoy::service::discovery::v3::DiscoveryResponse> response,
+         OpaqueResourceDecoderSharedPtr resource_decoder, Event::Dispatcher& dispatcher,
+         std::function<void(DecodedDiscoveryResponse&&)> on_decoded);
+
+  /**
+   * Decodes a resource of a response.
+   * @throw EnvoyException if the resource is not of the type of the response, or is invalid.
+   */
+  static DecodedResourcePtr
+  decodeResource(const envoy::service::discovery::v3::DiscoveryResponse& response, int index,
+                 OpaqueResourceDecoder& resource_decoder);
+
+  uint32_t threadCount() const { return threads_.size(); }
+
+  // Resources are handed to the pool threads in chunks of this many.
+  static constexpr int ChunkSize = 64;
+
+private:
+  void post(std::function<void()> work) ABSL_LOCKS_EXCLUDED(queue_mutex_);
+  void worker() ABSL_LOCKS_EXCLUDED(queue_mutex_);
+
+  absl::Mutex queue_mutex_;
+  std::queue<std::function<void()>> queue_ ABSL_GUARDED_BY(queue_mutex_);
+  bool terminate_ ABSL_GUARDED_BY(queue_mutex_) = false;
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+using ResourceDecodePoolSharedPtr = std::shared_ptr<ResourceDecodePool>;
+
+} // namespace Config
+} // namespace Envoy
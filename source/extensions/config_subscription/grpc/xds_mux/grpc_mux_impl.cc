@@ -392,6 +392,16 @@ void GrpcMuxDelta::requestOnDemandUpdate(const std::string& type_url,
   }
 }
 
+void GrpcMuxDelta::requestOnDemandRemoval(const std::string& type_url,
+                                          const absl::flat_hash_set<std::string>& for_removal) {
+  auto& sub = subscriptionStateFor(type_url);
+  sub.updateSubscriptionInterest({}, for_removal);
+  // Tell the server about our change in interest, if any.
+  if (sub.subscriptionUpdatePending()) {
+    trySendDiscoveryRequests();
+  }
+}
+
 GrpcMuxSotw::GrpcMuxSotw(GrpcMuxContext& grpc_mux_context, bool skip_subsequent_node)
     : GrpcMuxImpl(std::make_unique<SotwSubscriptionStateFactory>(grpc_mux_context.dispatcher_),
                   grpc_mux_context, skip_subsequent_node) {}
@@ -410,7 +420,7 @@ public:
   void shutdownAll() override { return GrpcMuxDelta::shutdownAll(); }
   std::shared_ptr<GrpcMux>
   create(Grpc::RawAsyncClientPtr&& async_client, Event::Dispatcher& dispatcher,
-         Random::RandomGenerator&, Stats::Scope& scope,
+         Random::RandomGenerator&, Thread::ThreadFactory&, Stats::Scope& scope,
          const envoy::config::core::v3::ApiConfigSource& ads_config,
          const LocalInfo::LocalInfo& local_info, CustomConfigValidatorsPtr&& config_validators,
          BackOffStrategyPtr&& backoff_strategy, XdsConfigTrackerOptRef xds_config_tracker,
@@ -445,7 +455,7 @@ public:
   void shutdownAll() override { return GrpcMuxSotw::shutdownAll(); }
   std::shared_ptr<GrpcMux>
   create(Grpc::RawAsyncClientPtr&& async_client, Event::Dispatcher& dispatcher,
-         Random::RandomGenerator&, Stats::Scope& scope,
+         Random::RandomGenerator&, Thread::ThreadFactory&, Stats::Scope& scope,
          const envoy::config::core::v3::ApiConfigSource& ads_config,
          const LocalInfo::LocalInfo& local_info, CustomConfigValidatorsPtr&& config_validators,
          BackOffStrategyPtr&& backoff_strategy, XdsConfigTrackerOptRef xds_config_tracker,
@@ -226,6 +226,8 @@ public:
   // GrpcStreamCallbacks
   void requestOnDemandUpdate(const std::string& type_url,
                              const absl::flat_hash_set<std::string>& for_update) override;
+  void requestOnDemandRemoval(const std::string& type_url,
+                              const absl::flat_hash_set<std::string>& for_removal) override;
 };
 
 class GrpcMuxSotw : public GrpcMuxImpl<SotwSubscriptionState, SotwSubscriptionStateFactory,
@@ -238,6 +240,10 @@ public:
   void requestOnDemandUpdate(const std::string&, const absl::flat_hash_set<std::string>&) override {
     ENVOY_BUG(false, "unexpected request for on demand update");
   }
+  void requestOnDemandRemoval(const std::string&,
+                              const absl::flat_hash_set<std::string>&) override {
+    ENVOY_BUG(false, "unexpected request for on demand removal");
+  }
 };
 
 class NullGrpcMuxImpl : public GrpcMux {
@@ -258,6 +264,10 @@ public:
   void requestOnDemandUpdate(const std::string&, const absl::flat_hash_set<std::string>&) override {
     ENVOY_BUG(false, "unexpected request for on demand update");
   }
+  void requestOnDemandRemoval(const std::string&,
+                              const absl::flat_hash_set<std::string>&) override {
+    ENVOY_BUG(false, "unexpected request for on demand removal");
+  }
 
   EdsResourcesCacheOptRef edsResourcesCache() override { return {}; }
 };
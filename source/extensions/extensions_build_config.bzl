@@ -60,6 +60,7 @@ EXTENSIONS = {
     # Health checkers
     #
 
+    "envoy.health_checkers.mongo":                      "//source/extensions/health_checkers/mongo:config",
     "envoy.health_checkers.redis":                      "//source/extensions/health_checkers/redis:config",
     "envoy.health_checkers.thrift":                     "//source/extensions/health_checkers/thrift:config",
     "envoy.health_checkers.tcp":                        "//source/extensions/health_checkers/tcp:health_checker_lib",
@@ -232,6 +233,9 @@ EXTENSIONS = {
     "envoy.resource_monitors.fixed_heap":               "//source/extensions/resource_monitors/fixed_heap:config",
     "envoy.resource_monitors.injected_resource":        "//source/extensions/resource_monitors/injected_resource:config",
     "envoy.resource_monitors.downstream_connections":   "//source/extensions/resource_monitors/downstream_connections:config",
+    "envoy.resource_monitors.cgroup_memory":            "//source/extensions/resource_monitors/cgroup_memory:config",
+    "envoy.resource_monitors.pressure_stall":           "//source/extensions/resource_monitors/pressure_stall:config",
+    "envoy.resource_monitors.event_loop_lag":           "//source/extensions/resource_monitors/event_loop_lag:config",
 
     #
     # Stat sinks
@@ -310,6 +314,7 @@ EXTENSIONS = {
     # CacheFilter plugins
     #
     "envoy.extensions.http.cache.file_system_http_cache": "//source/extensions/http/cache/file_system_http_cache:config",
+    "envoy.extensions.http.cache.in_memory_http_cache": "//source/extensions/http/cache/in_memory_http_cache:config",
     "envoy.extensions.http.cache.simple":               "//source/extensions/http/cache/simple_http_cache:config",
 
     #
@@ -435,6 +440,8 @@ EXTENSIONS = {
     "envoy.network.dns_resolver.apple":                "//source/extensions/network/dns_resolver/apple:config",
     # getaddrinfo DNS resolver extension can be used when the system resolver is desired (e.g., Android)
     "envoy.network.dns_resolver.getaddrinfo":          "//source/extensions/network/dns_resolver/getaddrinfo:config",
+    # caching DNS resolver extension wraps another resolver with a TTL-respecting cache.
+    "envoy.network.dns_resolver.caching":              "//source/extensions/network/dns_resolver/caching:config",
 
     #
     # Custom matchers
@@ -0,0 +1,184 @@
+#include "source/extensions/filters/http/cache/cache_fill.h"
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/http/header_map_impl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+CacheFill::CacheFill(std::shared_ptr<CacheFillRegistry> registry, const Key& key,
+                     uint64_t max_body_bytes)
+    : registry_(std::move(registry)), key_(key), max_body_bytes_(max_body_bytes) {}
+
+CacheFill::~CacheFill() { registry_->remove(key_, this); }
+
+void CacheFill::onHeaders(const Http::ResponseHeaderMap& headers, bool end_stream) {
+  std::shared_ptr<const Http::ResponseHeaderMap> headers_copy =
+      Http::createHeaderMap<Http::ResponseHeaderMapImpl>(headers);
+  std::vector<Waiter> waiters;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (complete_ || aborted_ || headers_ != nullptr) {
+      return;
+    }
+    headers_ = std::move(headers_copy);
+    complete_ = end_stream;
+    waiters = waitersToNotify();
+  }
+  notify(std::move(waiters), end_stream);
+}
+
+void CacheFill::onData(const Buffer::Instance& data, bool end_stream) {
+  std::shared_ptr<Buffer::Instance> chunk;
+  if (data.length() > 0) {
+    chunk = std::make_shared<Buffer::OwnedImpl>();
+    chunk->add(data);
+  }
+  std::vector<Waiter> waiters;
+  bool passed_max_body_bytes = false;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (complete_ || aborted_ || headers_ == nullptr) {
+      return;
+    }
+    if (chunk != nullptr && retain_body_) {
+      passed_max_body_bytes = body_bytes_ <= max_body_bytes_ &&
+                              body_bytes_ + chunk->length() > max_body_bytes_;
+      body_bytes_ += chunk->length();
+      body_.push_back(std::move(chunk));
+    }
+    complete_ = end_stream;
+    waiters = waitersToNotify();
+  }
+  if (passed_max_body_bytes && !end_stream) {
+    stopOffering();
+  }
+  notify(std::move(waiters), end_stream);
+}
+
+void CacheFill::onTrailers(const Http::ResponseTrailerMap& trailers) {
+  std::shared_ptr<const Http::ResponseTrailerMap> trailers_copy =
+      Http::createHeaderMap<Http::ResponseTrailerMapImpl>(trailers);
+  std::vector<Waiter> waiters;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (complete_ || aborted_ || headers_ == nullptr) {
+      return;
+    }
+    trailers_ = std::move(trailers_copy);
+    complete_ = true;
+    waiters = waitersToNotify();
+  }
+  notify(std::move(waiters), true);
+}
+
+void CacheFill::abort() {
+  std::vector<Waiter> waiters;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (complete_ || aborted_) {
+      return;
+    }
+    aborted_ = true;
+    waiters = waitersToNotify();
+  }
+  notify(std::move(waiters), true);
+}
+
+void CacheFill::addWaiter(Event::Dispatcher& dispatcher, std::function<void()> on_progress) {
+  absl::MutexLock lock(&mutex_);
+  if (complete_ || aborted_) {
+    // The waiter reads the whole fill when it catches up.
+    return;
+  }
+  waiters_.push_back({dispatcher, std::move(on_progress)});
+}
+
+CacheFill::Progress CacheFill::read(size_t first_chunk) const {
+  Progress progress;
+  absl::MutexLock lock(&mutex_);
+  progress.headers_ = headers_;
+  if (first_chunk < body_.size()) {
+    progress.body_.assign(body_.begin() + first_chunk, body_.end());
+  }
+  progress.trailers_ = trailers_;
+  progress.complete_ = complete_;
+  progress.aborted_ = aborted_;
+  return progress;
+}
+
+void CacheFill::onJoined() {
+  absl::MutexLock lock(&mutex_);
+  ++joined_;
+}
+
+void CacheFill::stopOffering() {
+  // Requests for the key from now on fetch the response themselves.
+  registry_->remove(key_, this);
+  // No request can join the fill once it is out of the registry, so the requests that joined it
+  // are the only ones that can read the body.
+  absl::MutexLock lock(&mutex_);
+  if (joined_ == 0) {
+    retain_body_ = false;
+    body_.clear();
+  }
+}
+
+std::vector<CacheFill::Waiter> CacheFill::waitersToNotify() {
+  if (complete_ || aborted_) {
+    // The waiters aren't notified again once the fill finished.
+    return std::move(waiters_);
+  }
+  return waiters_;
+}
+
+void CacheFill::notify(std::vector<Waiter> waiters, bool finished) {
+  for (Waiter& waiter : waiters) {
+    // The callback is posted to the dispatcher to make sure it is called on the waiter's worker
+    // thread.
+    waiter.dispatcher_.post(waiter.on_progress_);
+  }
+  if (finished) {
+    // Requests that miss the cache from now on fetch the response again, or find it in cache.
+    registry_->remove(key_, this);
+  }
+}
+
+CacheFillRegistry::CacheFillRegistry(uint64_t max_body_bytes) : max_body_bytes_(max_body_bytes) {}
+
+std::pair<CacheFillSharedPtr, bool> CacheFillRegistry::join(const Key& key, bool can_fill) {
+  absl::MutexLock lock(&mutex_);
+  auto it = fills_.find(key);
+  if (it != fills_.end()) {
+    if (CacheFillSharedPtr fill = it->second.fill_.lock()) {
+      fill->onJoined();
+      return {std::move(fill), false};
+    }
+  }
+  if (!can_fill) {
+    return {nullptr, false};
+  }
+  auto fill = std::make_shared<CacheFill>(shared_from_this(), key, max_body_bytes_);
+  fills_.insert_or_assign(key, Entry{fill.get(), fill});
+  return {std::move(fill), true};
+}
+
+void CacheFillRegistry::remove(const Key& key, const CacheFill* fill) {
+  absl::MutexLock lock(&mutex_);
+  auto it = fills_.find(key);
+  if (it != fills_.end() && it->second.raw_fill_ == fill) {
+    fills_.erase(it);
+  }
+}
+
+size_t CacheFillRegistry::size() const {
+  absl::MutexLock lock(&mutex_);
+  return fills_.size();
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
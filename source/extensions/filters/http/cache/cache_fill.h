@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "envoy/buffer/buffer.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/http/header_map.h"
+
+#include "source/common/protobuf/utility.h"
+#include "source/extensions/filters/http/cache/key.pb.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+class CacheFillRegistry;
+
+/**
+ * The response to a request that missed the cache or validates a stale cached response, as it is
+ * received from upstream, shared with the concurrent requests for the same key. The request that
+ * fetches the response (the filler) adds it to the fill on its worker thread; the waiting requests
+ * are notified on their own worker threads, and read what they haven't served yet.
+ *
+ * A fill whose body grows past max_body_bytes is no longer offered to new requests, and stops
+ * retaining its body if no request waits for it.
+ */
+class CacheFill {
+public:
+  /**
+   * What a waiting request can serve.
+   */
+  struct Progress {
+    // Null until the response headers arrive.
+    std::shared_ptr<const Http::ResponseHeaderMap> headers_;
+    // The body chunks from the chunk the waiting request asked for on.
+    std::vector<std::shared_ptr<const Buffer::Instance>> body_;
+    std::shared_ptr<const Http::ResponseTrailerMap> trailers_;
+    // True once the whole response has arrived.
+    bool complete_ = false;
+    // True if the response can't be served to waiting requests, or the filler was reset before the
+    // response completed.
+    bool aborted_ = false;
+  };
+
+  CacheFill(std::shared_ptr<CacheFillRegistry> registry, const Key& key, uint64_t max_body_bytes);
+  ~CacheFill();
+
+  // Called by the filler as the response arrives. Calls after the fill finished are ignored.
+  void onHeaders(const Http::ResponseHeaderMap& headers, bool end_stream);
+  void onData(const Buffer::Instance& data, bool end_stream);
+  void onTrailers(const Http::ResponseTrailerMap& trailers);
+  void abort();
+
+  /**
+   * Posts on_progress to the dispatcher whenever the fill makes progress, until it finishes. The
+   * waiting request is expected to read() once after adding itself, to catch up.
+   */
+  void addWaiter(Event::Dispatcher& dispatcher, std::function<void()> on_progress);
+
+  /**
+   * @return the state of the fill, with the body chunks from first_chunk on.
+   */
+  Progress read(size_t first_chunk) const;
+
+private:
+  friend class CacheFillRegistry;
+
+  struct Waiter {
+    Event::Dispatcher& dispatcher_;
+    std::function<void()> on_progress_;
+  };
+
+  // The waiters to notify of progress; all of them are released if the fill finished.
+  std::vector<Waiter> waitersToNotify() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Notifies the waiters of progress made while holding the lock, and removes the fill from the
+  // registry if it finished.
+  void notify(std::vector<Waiter> waiters, bool finished);
+  // Called by the registry, with its lock held, when a request joins the fill to wait for it.
+  void onJoined();
+  // Removes the fill from the registry once its body passed max_body_bytes_, and drops the body if
+  // no request joined the fill, as none can anymore.
+  void stopOffering();
+
+  const std::shared_ptr<CacheFillRegistry> registry_;
+  const Key key_;
+  const uint64_t max_body_bytes_;
+  mutable absl::Mutex mutex_;
+  std::vector<Waiter> waiters_ ABSL_GUARDED_BY(mutex_);
+  size_t joined_ ABSL_GUARDED_BY(mutex_) = 0;
+  uint64_t body_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool retain_body_ ABSL_GUARDED_BY(mutex_) = true;
+  std::shared_ptr<const Http::ResponseHeaderMap> headers_ ABSL_GUARDED_BY(mutex_);
+  std::vector<std::shared_ptr<const Buffer::Instance>> body_ ABSL_GUARDED_BY(mutex_);
+  std::shared_ptr<const Http::ResponseTrailerMap> trailers_ ABSL_GUARDED_BY(mutex_);
+  bool complete_ ABSL_GUARDED_BY(mutex_) = false;
+  bool aborted_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+using CacheFillSharedPtr = std::shared_ptr<CacheFill>;
+
+/**
+ * The fills in progress of a cache filter config, shared by all workers.
+ */
+class CacheFillRegistry : public std::enable_shared_from_this<CacheFillRegistry> {
+public:
+  // The body size past which fills are no longer offered, if the config doesn't set
+  // max_body_bytes.
+  static constexpr uint64_t DefaultMaxBodyBytes = 1024 * 1024;
+
+  explicit CacheFillRegistry(uint64_t max_body_bytes = DefaultMaxBodyBytes);
+
+  /**
+   * Joins the fill in progress for the key, or starts one if there is none and can_fill is true.
+   * @return the fill, and whether the caller is its filler. The fill is null if there is no fill
+   *         in progress for the key and can_fill is false.
+   */
+  std::pair<CacheFillSharedPtr, bool> join(const Key& key, bool can_fill);
+
+  /**
+   * Removes the fill of the key from the registry, if it is the given fill.
+   */
+  void remove(const Key& key, const CacheFill* fill);
+
+  // The number of fills in the registry, for tests.
+  size_t size() const;
+
+private:
+  struct Entry {
+    // Compared in remove() without locking fill_, which would destroy the fill in remove() if it
+    // was released meanwhile.
+    const CacheFill* raw_fill_;
+    std::weak_ptr<CacheFill> fill_;
+  };
+
+  const uint64_t max_body_bytes_;
+  mutable absl::Mutex mutex_;
+  // Fills are owned by the requests that fill and wait on them.
+  absl::flat_hash_map<Key, Entry, MessageUtil, MessageUtil> fills_ ABSL_GUARDED_BY(mutex_);
+};
+
+using CacheFillRegistrySharedPtr = std::shared_ptr<CacheFillRegistry>;
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
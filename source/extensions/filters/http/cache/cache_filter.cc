@@ -1,10 +1,15 @@
 #include "source/extensions/filters/http/cache/cache_filter.h"
 
+#include <tuple>
+
 #include "envoy/http/header_map.h"
 
+#include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/enum_to_int.h"
+#include "source/common/http/header_map_impl.h"
 #include "source/common/http/headers.h"
 #include "source/common/http/utility.h"
+#include "source/common/protobuf/utility.h"
 #include "source/extensions/filters/http/cache/cache_custom_headers.h"
 #include "source/extensions/filters/http/cache/cache_entry_utils.h"
 #include "source/extensions/filters/http/cache/cache_filter_logging_info.h"
@@ -33,12 +38,24 @@ using CacheResponseCodeDetails = ConstSingleton<CacheResponseCodeDetailValues>;
 
 CacheFilter::CacheFilter(const envoy::extensions::filters::http::cache::v3::CacheConfig& config,
                          const std::string&, Stats::Scope&, TimeSource& time_source,
-                         std::shared_ptr<HttpCache> http_cache)
-    : time_source_(time_source), cache_(http_cache),
+                         std::shared_ptr<HttpCache> http_cache,
+                         CacheFillRegistrySharedPtr fill_registry)
+    : time_source_(time_source), cache_(http_cache), fill_registry_(std::move(fill_registry)),
+      request_collapsing_timeout_(
+          PROTOBUF_GET_MS_OR_DEFAULT(config, request_collapsing_timeout, 0)),
       vary_allow_list_(config.allowed_vary_headers()) {}
 
 void CacheFilter::onDestroy() {
   filter_state_ = FilterState::Destroyed;
+  if (fill_timer_ != nullptr) {
+    fill_timer_->disableTimer();
+  }
+  if (is_filler_) {
+    // The requests waiting for the response are sent upstream, or reset if they are already
+    // serving it. This does nothing if the response was complete.
+    fill_->abort();
+  }
+  fill_.reset();
   if (lookup_ != nullptr) {
     lookup_->onDestroy();
   }
@@ -91,6 +108,9 @@ Http::FilterHeadersStatus CacheFilter::decodeHeaders(Http::RequestHeaderMap& hea
   LookupRequest lookup_request(headers, time_source_.systemTime(), vary_allow_list_);
   request_allows_inserts_ = !lookup_request.requestCacheControl().no_store_;
   is_head_request_ = headers.getMethodValue() == Http::Headers::get().MethodValues.Head;
+  if (fill_registry_ != nullptr) {
+    fill_key_ = lookup_request.key();
+  }
   lookup_ = cache_->makeLookupContext(std::move(lookup_request), *decoder_callbacks_);
 
   ASSERT(lookup_);
@@ -109,6 +129,13 @@ Http::FilterHeadersStatus CacheFilter::encodeHeaders(Http::ResponseHeaderMap& he
     return Http::FilterHeadersStatus::Continue;
   }
 
+  if (fill_ != nullptr && !is_filler_) {
+    // A response was injected into the filter chain while the request was waiting for a concurrent
+    // request's response, e.g. because the request stream timed out.
+    fill_timer_->disableTimer();
+    fill_.reset();
+  }
+
   // If lookup_ is null, the request wasn't cacheable, so the response isn't either.
   if (!lookup_) {
     return Http::FilterHeadersStatus::Continue;
@@ -139,8 +166,19 @@ Http::FilterHeadersStatus CacheFilter::encodeHeaders(Http::ResponseHeaderMap& he
 
   // Either a cache miss or a cache entry that is no longer valid.
   // Check if the new response can be cached.
-  if (request_allows_inserts_ && !is_head_request_ &&
-      CacheabilityUtils::isCacheableResponse(headers, vary_allow_list_)) {
+  const bool response_is_cacheable =
+      request_allows_inserts_ && !is_head_request_ &&
+      CacheabilityUtils::isCacheableResponse(headers, vary_allow_list_);
+  if (is_filler_) {
+    // Only responses that are cached, and that don't depend on request headers beyond the key, are
+    // served to the requests waiting for this one.
+    if (response_is_cacheable && !VaryHeaderUtils::hasVary(headers)) {
+      fill_->onHeaders(headers, end_stream);
+    } else {
+      fill_->abort();
+    }
+  }
+  if (response_is_cacheable) {
     ENVOY_STREAM_LOG(debug, "CacheFilter::encodeHeaders inserting headers", *encoder_callbacks_);
     auto insert_context = cache_->makeInsertContext(std::move(lookup_), *encoder_callbacks_);
     if (insert_context != nullptr) {
@@ -180,6 +218,9 @@ Http::FilterDataStatus CacheFilter::encodeData(Buffer::Instance& data, bool end_
     // Stop the encoding stream until the cached response is fetched & added to the encoding stream.
     return Http::FilterDataStatus::StopIterationAndBuffer;
   }
+  if (is_filler_) {
+    fill_->onData(data, end_stream);
+  }
   if (insert_queue_ != nullptr) {
     ENVOY_STREAM_LOG(debug, "CacheFilter::encodeData inserting body", *encoder_callbacks_);
     insert_queue_->insertBody(data, end_stream);
@@ -204,6 +245,9 @@ Http::FilterTrailersStatus CacheFilter::encodeTrailers(Http::ResponseTrailerMap&
     return Http::FilterTrailersStatus::StopIteration;
   }
   response_has_trailers_ = !trailers.empty();
+  if (is_filler_) {
+    fill_->onTrailers(trailers);
+  }
   if (insert_queue_ != nullptr) {
     ENVOY_STREAM_LOG(debug, "CacheFilter::encodeTrailers inserting trailers", *encoder_callbacks_);
     insert_queue_->insertTrailers(trailers);
@@ -381,6 +425,9 @@ void CacheFilter::onHeaders(LookupResult&& result, Http::RequestHeaderMap& reque
   case CacheEntryStatus::FoundNotModified:
     PANIC("unsupported code");
   case CacheEntryStatus::RequiresValidation:
+    if (fill_registry_ != nullptr && joinFill(request_headers)) {
+      return;
+    }
     // If a cache entry requires validation, inject validation headers in the
     // request and let it pass through as if no cache entry was found. If the
     // cache entry was valid, the response status should be 304 (unmodified)
@@ -395,6 +442,9 @@ void CacheFilter::onHeaders(LookupResult&& result, Http::RequestHeaderMap& reque
     handleCacheHit();
     return;
   case CacheEntryStatus::Unusable:
+    if (fill_registry_ != nullptr && joinFill(request_headers)) {
+      return;
+    }
     decoder_callbacks_->continueDecoding();
     return;
   case CacheEntryStatus::LookupError:
@@ -436,6 +486,9 @@ void CacheFilter::onBody(Buffer::InstancePtr&& body) {
 
   const bool end_stream = remaining_ranges_.empty() && !response_has_trailers_;
 
+  if (is_filler_) {
+    fill_->onData(*body, end_stream);
+  }
   filter_state_ == FilterState::DecodeServingFromCache
       ? decoder_callbacks_->encodeData(*body, end_stream)
       : encoder_callbacks_->addEncodedData(*body, !response_has_trailers_);
@@ -456,6 +509,9 @@ void CacheFilter::onTrailers(Http::ResponseTrailerMapPtr&& trailers) {
     // The filter is being destroyed, any callbacks should be ignored.
     return;
   }
+  if (is_filler_) {
+    fill_->onTrailers(*trailers);
+  }
   if (filter_state_ == FilterState::DecodeServingFromCache) {
     decoder_callbacks_->encodeTrailers(std::move(trailers));
   } else {
@@ -465,6 +521,113 @@ void CacheFilter::onTrailers(Http::ResponseTrailerMapPtr&& trailers) {
   finalizeEncodingCachedResponse();
 }
 
+bool CacheFilter::joinFill(Http::RequestHeaderMap& request_headers) {
+  if (is_head_request_) {
+    // Responses to HEAD requests aren't cached, so they neither fill nor wait.
+    return false;
+  }
+  // Requests with "Cache-Control: no-store" don't insert the response, so they can't fill.
+  std::tie(fill_, is_filler_) = fill_registry_->join(fill_key_, request_allows_inserts_);
+  if (fill_ == nullptr || is_filler_) {
+    return false;
+  }
+  fill_request_headers_ = &request_headers;
+  ENVOY_STREAM_LOG(debug, "CacheFilter waiting for the response of a concurrent request",
+                   *decoder_callbacks_);
+  // The fill can make progress after the filter is destroyed, so a weak_ptr to the CacheFilter is
+  // captured, as in getHeaders.
+  CacheFilterWeakPtr self = weak_from_this();
+  fill_->addWaiter(decoder_callbacks_->dispatcher(), [self]() {
+    if (CacheFilterSharedPtr cache_filter = self.lock()) {
+      cache_filter->onFillProgress();
+    }
+  });
+  fill_timer_ = decoder_callbacks_->dispatcher().createTimer([this]() {
+    ENVOY_STREAM_LOG(debug, "CacheFilter timed out waiting for a concurrent request's response",
+                     *decoder_callbacks_);
+    abandonFill();
+  });
+  fill_timer_->enableTimer(request_collapsing_timeout_);
+  // Catch up with the progress the fill made before the request started waiting.
+  onFillProgress();
+  return true;
+}
+
+void CacheFilter::onFillProgress() {
+  if (filter_state_ == FilterState::Destroyed || fill_ == nullptr) {
+    // The filter is being destroyed, or stopped waiting for the fill.
+    return;
+  }
+  const CacheFill::Progress progress = fill_->read(fill_chunks_served_);
+  if (filter_state_ != FilterState::DecodeServingFromCache) {
+    if (progress.aborted_) {
+      ENVOY_STREAM_LOG(debug, "CacheFilter can't serve the response of a concurrent request",
+                       *decoder_callbacks_);
+      abandonFill();
+      return;
+    }
+    if (progress.headers_ == nullptr) {
+      return;
+    }
+    fill_timer_->disableTimer();
+    filter_state_ = FilterState::DecodeServingFromCache;
+    served_from_fill_ = true;
+    insert_status_ = InsertStatus::NoInsertCacheHit;
+    decoder_callbacks_->streamInfo().setResponseFlag(
+        StreamInfo::ResponseFlag::ResponseFromCacheFilter);
+    decoder_callbacks_->streamInfo().setResponseCodeDetails(
+        CacheResponseCodeDetails::get().ResponseFromCacheFilter);
+    const bool end_stream =
+        progress.complete_ && progress.body_.empty() && progress.trailers_ == nullptr;
+    decoder_callbacks_->encodeHeaders(
+        Http::createHeaderMap<Http::ResponseHeaderMapImpl>(*progress.headers_), end_stream,
+        CacheResponseCodeDetails::get().ResponseFromCacheFilter);
+    if (end_stream) {
+      filter_state_ = FilterState::ResponseServedFromCache;
+      fill_.reset();
+      return;
+    }
+  } else if (progress.aborted_) {
+    // The request fetching the response was reset, so the response can't be completed.
+    fill_.reset();
+    decoder_callbacks_->resetStream();
+    return;
+  }
+
+  const bool body_ends_stream = progress.complete_ && progress.trailers_ == nullptr;
+  for (size_t i = 0; i < progress.body_.size(); ++i) {
+    // The chunks are shared with the other requests serving the fill, so each request encodes its
+    // own copy.
+    Buffer::OwnedImpl body;
+    body.add(*progress.body_[i]);
+    ++fill_chunks_served_;
+    decoder_callbacks_->encodeData(body, body_ends_stream && i + 1 == progress.body_.size());
+  }
+  if (!progress.complete_) {
+    return;
+  }
+  if (progress.trailers_ != nullptr) {
+    decoder_callbacks_->encodeTrailers(
+        Http::createHeaderMap<Http::ResponseTrailerMapImpl>(*progress.trailers_));
+  } else if (progress.body_.empty()) {
+    // The response ended with an empty body chunk after the last chunk was served.
+    Buffer::OwnedImpl empty;
+    decoder_callbacks_->encodeData(empty, true);
+  }
+  filter_state_ = FilterState::ResponseServedFromCache;
+  fill_.reset();
+}
+
+void CacheFilter::abandonFill() {
+  fill_timer_->disableTimer();
+  fill_.reset();
+  if (lookup_result_->cache_entry_status_ == CacheEntryStatus::RequiresValidation) {
+    handleCacheHitWithValidation(*fill_request_headers_);
+    return;
+  }
+  decoder_callbacks_->continueDecoding();
+}
+
 void CacheFilter::handleCacheHit() {
   filter_state_ = FilterState::DecodeServingFromCache;
   insert_status_ = InsertStatus::NoInsertCacheHit;
@@ -573,6 +736,17 @@ void CacheFilter::processSuccessfulValidation(Http::ResponseHeaderMap& response_
     insert_status_ = InsertStatus::HeaderUpdate;
   }
 
+  if (is_filler_) {
+    // The requests waiting for this validation are served the validated response, as they would be
+    // served a response that missed the cache.
+    if (VaryHeaderUtils::hasVary(response_headers)) {
+      fill_->abort();
+    } else {
+      fill_->onHeaders(response_headers,
+                       lookup_result_->content_length_ == 0 && !lookup_result_->has_trailers_);
+    }
+  }
+
   // A cache entry was successfully validated -> encode cached body and trailers.
   encodeCachedResponse();
 }
@@ -680,6 +854,12 @@ LookupStatus CacheFilter::lookupStatus() const {
     return LookupStatus::RequestIncomplete;
   }
 
+  if (served_from_fill_) {
+    return lookup_result_->cache_entry_status_ == CacheEntryStatus::RequiresValidation
+               ? LookupStatus::CollapsedValidation
+               : LookupStatus::CollapsedCacheMiss;
+  }
+
   if (lookup_result_ != nullptr) {
     return resolveLookupStatus(lookup_result_->cache_entry_status_, filter_state_);
   } else {
@@ -1,13 +1,16 @@
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "envoy/event/timer.h"
 #include "envoy/extensions/filters/http/cache/v3/cache.pb.h"
 
 #include "source/common/common/logger.h"
+#include "source/extensions/filters/http/cache/cache_fill.h"
 #include "source/extensions/filters/http/cache/cache_filter_logging_info.h"
 #include "source/extensions/filters/http/cache/cache_headers_utils.h"
 #include "source/extensions/filters/http/cache/cache_insert_queue.h"
@@ -55,7 +58,7 @@ class CacheFilter : public Http::PassThroughFilter,
 public:
   CacheFilter(const envoy::extensions::filters::http::cache::v3::CacheConfig& config,
               const std::string& stats_prefix, Stats::Scope& scope, TimeSource& time_source,
-              std::shared_ptr<HttpCache> http_cache);
+              std::shared_ptr<HttpCache> http_cache, CacheFillRegistrySharedPtr fill_registry);
   // Http::StreamFilterBase
   void onDestroy() override;
   void onStreamComplete() override;
@@ -82,6 +85,20 @@ private:
   void onBody(Buffer::InstancePtr&& body);
   void onTrailers(Http::ResponseTrailerMapPtr&& trailers);
 
+  // Joins the fill in progress for the key of a request that missed the cache or found a stale
+  // response, or starts one. Returns true if the request waits for the response of a concurrent
+  // request, in which case the request is either served from the fill or sent upstream by
+  // onFillProgress.
+  bool joinFill(Http::RequestHeaderMap& request_headers);
+
+  // Called when the fill the request waits for made progress. Serves what arrived since the last
+  // call, or sends the request upstream if the fill can't be served.
+  void onFillProgress();
+
+  // Stops waiting for the fill, and sends the request upstream, to validate the stale response if
+  // there is one.
+  void abandonFill();
+
   // Set required state in the CacheFilter for handling a cache hit.
   void handleCacheHit();
 
@@ -136,6 +153,22 @@ private:
   LookupContextPtr lookup_;
   LookupResultPtr lookup_result_;
 
+  // Request collapsing state; fill_registry_ is null if request collapsing is disabled.
+  const CacheFillRegistrySharedPtr fill_registry_;
+  const std::chrono::milliseconds request_collapsing_timeout_;
+  Key fill_key_;
+  // The fill this request fetches from upstream if is_filler_, or waits for otherwise.
+  CacheFillSharedPtr fill_;
+  bool is_filler_ = false;
+  // The headers of the waiting request, into which validation headers are injected if it stops
+  // waiting for the fill of a stale response.
+  Http::RequestHeaderMap* fill_request_headers_ = nullptr;
+  // True once the request serves the response of a concurrent request.
+  bool served_from_fill_ = false;
+  // The number of body chunks served from the fill.
+  size_t fill_chunks_served_ = 0;
+  Event::TimerPtr fill_timer_;
+
   // Tracks what body bytes still need to be read from the cache. This is
   // currently only one Range, but will expand when full range support is added. Initialized by
   // onHeaders for Range Responses, otherwise initialized by encodeCachedResponse.
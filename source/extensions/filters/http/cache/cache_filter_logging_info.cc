@@ -15,6 +15,10 @@ absl::string_view lookupStatusToString(LookupStatus status) {
     return "CacheHit";
   case LookupStatus::CacheMiss:
     return "CacheMiss";
+  case LookupStatus::CollapsedCacheMiss:
+    return "CollapsedCacheMiss";
+  case LookupStatus::CollapsedValidation:
+    return "CollapsedValidation";
   case LookupStatus::StaleHitWithSuccessfulValidation:
     return "StaleHitWithSuccessfulValidation";
   case LookupStatus::StaleHitWithFailedValidation:
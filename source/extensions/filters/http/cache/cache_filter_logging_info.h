@@ -17,6 +17,13 @@ enum class LookupStatus {
   CacheHit,
   // The CacheFilter didn't find a response in cache.
   CacheMiss,
+  // The CacheFilter didn't find a response in cache, and served the response
+  // that a concurrent request for the same key was fetching from the upstream.
+  CollapsedCacheMiss,
+  // The CacheFilter found a stale response, and served the response to the
+  // validation request that a concurrent request for the same key sent to the
+  // upstream.
+  CollapsedValidation,
   // The CacheFilter found a stale response, and sent a validation request to
   // the upstream; the upstream responded with a 304 Not Modified. This is
   // functionally a cache hit. It is differentiated for metrics reporting.
@@ -26,10 +26,19 @@ Http::FilterFactoryCb CacheFilterFactory::createFilterFactoryFromProtoTyped(
     cache = http_cache_factory->getCache(config, context);
   }
 
-  return [config, stats_prefix, &context,
-          cache](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+  // Requests collapse with concurrent requests of the same filter config, on any worker.
+  CacheFillRegistrySharedPtr fill_registry;
+  if (cache != nullptr && config.has_request_collapsing_timeout()) {
+    fill_registry = std::make_shared<CacheFillRegistry>(
+        config.max_body_bytes() > 0 ? config.max_body_bytes()
+                                    : CacheFillRegistry::DefaultMaxBodyBytes);
+  }
+
+  return [config, stats_prefix, &context, cache,
+          fill_registry](Http::FilterChainFactoryCallbacks& callbacks) -> void {
     callbacks.addStreamFilter(std::make_shared<CacheFilter>(
-        config, stats_prefix, context.scope(), context.serverFactoryContext().timeSource(), cache));
+        config, stats_prefix, context.scope(), context.serverFactoryContext().timeSource(), cache,
+        fill_registry));
   };
 }
 
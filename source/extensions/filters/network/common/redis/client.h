@@ -53,6 +53,13 @@ public:
    */
   virtual void onRedirection(RespValuePtr&& value, const std::string& host_address,
                              bool ask_redirection) PURE;
+
+  /**
+   * @return bool whether a successful response may be delivered as a RespType::Raw value holding
+   *         the still encoded reply. This is only consulted when Config::enableReplyPassthrough()
+   *         is true. Error responses are always decoded.
+   */
+  virtual bool acceptsRawResponse() const PURE;
 };
 
 /**
@@ -65,6 +72,7 @@ public:
   void onResponse(Common::Redis::RespValuePtr&&) override {}
   void onFailure() override {}
   void onRedirection(Common::Redis::RespValuePtr&&, const std::string&, bool) override {}
+  bool acceptsRawResponse() const override { return false; }
 };
 
 /**
@@ -184,6 +192,12 @@ public:
 
   virtual bool connectionRateLimitEnabled() const PURE;
   virtual uint32_t connectionRateLimitPerSec() const PURE;
+
+  /**
+   * @return when enabled, replies to requests whose callbacks accept raw responses are only
+   * scanned for their frame boundary and handed over in encoded form instead of being decoded.
+   */
+  virtual bool enableReplyPassthrough() const PURE;
 };
 
 using ConfigSharedPtr = std::shared_ptr<Config>;
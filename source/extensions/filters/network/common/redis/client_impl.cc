@@ -28,7 +28,8 @@ ConfigImpl::ConfigImpl(
                // as the buffer is flushed on each request immediately.
       max_upstream_unknown_connections_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_upstream_unknown_connections, 100)),
-      enable_command_stats_(config.enable_command_stats()) {
+      enable_command_stats_(config.enable_command_stats()),
+      enable_reply_passthrough_(config.enable_reply_passthrough()) {
   switch (config.read_policy()) {
     PANIC_ON_PROTO_ENUM_SENTINEL_VALUES;
   case envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::ConnPoolSettings::MASTER:
@@ -161,7 +162,13 @@ void ClientImpl::onConnectOrOpTimeout() {
 }
 
 void ClientImpl::onData(Buffer::Instance& data) {
-  TRY_NEEDS_AUDIT { decoder_->decode(data); }
+  TRY_NEEDS_AUDIT {
+    if (config_.enableReplyPassthrough()) {
+      onRawData(data);
+    } else {
+      decoder_->decode(data);
+    }
+  }
   END_TRY catch (ProtocolError&) {
     putOutlierEvent(Upstream::Outlier::Result::ExtOriginRequestFailed);
     host_->cluster().trafficStats()->upstream_cx_protocol_error_.inc();
@@ -170,6 +177,32 @@ void ClientImpl::onData(Buffer::Instance& data) {
   }
 }
 
+void ClientImpl::onRawData(Buffer::Instance& data) {
+  while (data.length() > 0 && connection_->state() == Network::Connection::State::Open) {
+    if (pending_requests_.empty()) {
+      throw ProtocolError("unexpected reply");
+    }
+    const uint64_t frame_length = frame_scanner_.scan(data);
+    if (frame_length == 0) {
+      // Leave the partial reply in the connection buffer until the rest of it arrives.
+      return;
+    }
+
+    if (pending_requests_.front().raw_ && data.peekInt<char>() != '-') {
+      // Moving the frame out of the connection buffer transfers whole slices where possible.
+      RespValuePtr value = std::make_unique<RespValue>();
+      value->type(RespType::Raw);
+      value->asRaw().move(data, frame_length);
+      onRespValue(std::move(value));
+    } else {
+      // Errors are decoded so that redirection and command stats keep working.
+      Buffer::OwnedImpl frame;
+      frame.move(data, frame_length);
+      decoder_->decode(frame);
+    }
+  }
+}
+
 void ClientImpl::putOutlierEvent(Upstream::Outlier::Result result) {
   if (!config_.disableOutlierEvents()) {
     host_->outlierDetector().putResult(result);
@@ -265,6 +298,7 @@ void ClientImpl::onRespValue(RespValuePtr&& value) {
 ClientImpl::PendingRequest::PendingRequest(ClientImpl& parent, ClientCallbacks& callbacks,
                                            Stats::StatName command)
     : parent_(parent), callbacks_(callbacks), command_{command},
+      raw_(parent.config_.enableReplyPassthrough() && callbacks.acceptsRawResponse()),
       aggregate_request_timer_(parent_.redis_command_stats_->createAggregateTimer(
           parent_.scope_, parent_.time_source_)) {
   if (parent_.config_.enableCommandStats()) {
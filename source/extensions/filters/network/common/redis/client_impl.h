@@ -56,6 +56,7 @@ public:
   ReadPolicy readPolicy() const override { return read_policy_; }
   bool connectionRateLimitEnabled() const override { return connection_rate_limit_enabled_; }
   uint32_t connectionRateLimitPerSec() const override { return connection_rate_limit_per_sec_; }
+  bool enableReplyPassthrough() const override { return enable_reply_passthrough_; }
 
 private:
   const std::chrono::milliseconds op_timeout_;
@@ -68,6 +69,7 @@ private:
   ReadPolicy read_policy_;
   bool connection_rate_limit_enabled_;
   uint32_t connection_rate_limit_per_sec_;
+  const bool enable_reply_passthrough_;
 };
 
 class ClientImpl : public Client, public DecoderCallbacks, public Network::ConnectionCallbacks {
@@ -119,6 +121,8 @@ private:
     ClientImpl& parent_;
     ClientCallbacks& callbacks_;
     Stats::StatName command_;
+    // Whether a successful reply is delivered without being decoded.
+    const bool raw_;
     bool canceled_{};
     Stats::TimespanPtr aggregate_request_timer_;
     Stats::TimespanPtr command_request_timer_;
@@ -126,6 +130,7 @@ private:
 
   void onConnectOrOpTimeout();
   void onData(Buffer::Instance& data);
+  void onRawData(Buffer::Instance& data);
   void putOutlierEvent(Upstream::Outlier::Result result);
 
   // DecoderCallbacks
@@ -141,6 +146,7 @@ private:
   EncoderPtr encoder_;
   Buffer::OwnedImpl encoder_buffer_;
   DecoderPtr decoder_;
+  RespFrameScanner frame_scanner_;
   const Config& config_;
   std::list<PendingRequest> pending_requests_;
   Event::TimerPtr connect_or_op_timer_;
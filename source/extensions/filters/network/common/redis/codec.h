@@ -18,11 +18,13 @@ namespace Redis {
 
 /**
  * All RESP types as defined here: https://redis.io/topics/protocol with the exception of
- * CompositeArray. CompositeArray is an internal type that behaves like an Array type. Its first
- * element is a SimpleString or BulkString and the rest of the elements are portion of another
- * Array. This is created for performance.
+ * CompositeArray and Raw. CompositeArray is an internal type that behaves like an Array type. Its
+ * first element is a SimpleString or BulkString and the rest of the elements are portion of another
+ * Array. This is created for performance. Raw is an internal type that holds a single complete
+ * RESP value in its encoded form, so that upstream replies can be forwarded without being decoded
+ * and encoded again.
  */
-enum class RespType { Null, SimpleString, BulkString, Integer, Error, Array, CompositeArray };
+enum class RespType { Null, SimpleString, BulkString, Integer, Error, Array, CompositeArray, Raw };
 
 /**
  * A variant implementation of a RESP value optimized for performance. A C++11 union is used for
@@ -125,6 +127,8 @@ public:
   int64_t asInteger() const;
   CompositeArray& asCompositeArray();
   const CompositeArray& asCompositeArray() const;
+  Buffer::Instance& asRaw();
+  const Buffer::Instance& asRaw() const;
 
   /**
    * Get/set the type of the RespValue. A RespValue can only be a single type at a time. Each time
@@ -139,6 +143,7 @@ private:
     std::string string_;
     int64_t integer_;
     CompositeArray composite_array_;
+    std::unique_ptr<Buffer::Instance> raw_;
   };
 
   void cleanup();
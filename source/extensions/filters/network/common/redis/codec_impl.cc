@@ -7,11 +7,13 @@
 
 #include "envoy/common/platform.h"
 
+#include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/assert.h"
 #include "source/common/common/fmt.h"
 #include "source/common/common/utility.h"
 
 #include "absl/container/fixed_array.h"
+#include "absl/strings/numbers.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -50,6 +52,8 @@ std::string RespValue::toString() const {
     return "null";
   case RespType::Integer:
     return std::to_string(asInteger());
+  case RespType::Raw:
+    return fmt::format("raw({} bytes)", asRaw().length());
   }
 
   return "";
@@ -97,6 +101,16 @@ const RespValue::CompositeArray& RespValue::asCompositeArray() const {
   return composite_array_;
 }
 
+Buffer::Instance& RespValue::asRaw() {
+  ASSERT(type_ == RespType::Raw);
+  return *raw_;
+}
+
+const Buffer::Instance& RespValue::asRaw() const {
+  ASSERT(type_ == RespType::Raw);
+  return *raw_;
+}
+
 void RespValue::cleanup() {
   // Need to manually delete because of the union.
   switch (type_) {
@@ -108,6 +122,10 @@ void RespValue::cleanup() {
     composite_array_.~CompositeArray();
     break;
   }
+  case RespType::Raw: {
+    raw_.~unique_ptr<Buffer::Instance>();
+    break;
+  }
   case RespType::SimpleString:
   case RespType::BulkString:
   case RespType::Error: {
@@ -135,6 +153,10 @@ void RespValue::type(RespType type) {
     new (&composite_array_) CompositeArray();
     break;
   }
+  case RespType::Raw: {
+    new (&raw_) std::unique_ptr<Buffer::Instance>(new Buffer::OwnedImpl());
+    break;
+  }
   case RespType::SimpleString:
   case RespType::BulkString:
   case RespType::Error: {
@@ -159,6 +181,10 @@ RespValue::RespValue(const RespValue& other) : type_(RespType::Null) {
     asCompositeArray() = other.asCompositeArray();
     break;
   }
+  case RespType::Raw: {
+    asRaw().add(other.asRaw());
+    break;
+  }
   case RespType::SimpleString:
   case RespType::BulkString:
   case RespType::Error: {
@@ -184,6 +210,10 @@ RespValue::RespValue(RespValue&& other) noexcept : type_(other.type_) {
     new (&composite_array_) CompositeArray(std::move(other.composite_array_));
     break;
   }
+  case RespType::Raw: {
+    new (&raw_) std::unique_ptr<Buffer::Instance>(std::move(other.raw_));
+    break;
+  }
   case RespType::SimpleString:
   case RespType::BulkString:
   case RespType::Error: {
@@ -213,6 +243,10 @@ RespValue& RespValue::operator=(const RespValue& other) {
     asCompositeArray() = other.asCompositeArray();
     break;
   }
+  case RespType::Raw: {
+    asRaw().add(other.asRaw());
+    break;
+  }
   case RespType::SimpleString:
   case RespType::BulkString:
   case RespType::Error: {
@@ -244,6 +278,10 @@ RespValue& RespValue::operator=(RespValue&& other) noexcept {
     composite_array_ = std::move(other.composite_array_);
     break;
   }
+  case RespType::Raw: {
+    raw_ = std::move(other.raw_);
+    break;
+  }
   case RespType::SimpleString:
   case RespType::BulkString:
   case RespType::Error: {
@@ -275,6 +313,11 @@ bool RespValue::operator==(const RespValue& other) const {
     result = (asCompositeArray() == other.asCompositeArray());
     break;
   }
+  case RespType::Raw: {
+    result = (asRaw().length() == other.asRaw().length() &&
+              asRaw().toString() == other.asRaw().toString());
+    break;
+  }
   case RespType::SimpleString:
   case RespType::BulkString:
   case RespType::Error: {
@@ -549,6 +592,80 @@ void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
   }
 }
 
+uint64_t RespFrameScanner::scan(const Buffer::Instance& data) {
+  const uint64_t length = data.length();
+  while (pending_values_ > 0) {
+    if (offset_ >= length) {
+      return 0;
+    }
+    const char value_type = data.peekInt<char>(offset_);
+    if (value_type != '+' && value_type != '-' && value_type != ':' && value_type != '$' &&
+        value_type != '*') {
+      throw ProtocolError("invalid value type");
+    }
+    const ssize_t line_end = data.search("\r\n", 2, offset_);
+    if (line_end < 0) {
+      return 0;
+    }
+
+    uint64_t next_offset = line_end + 2;
+    switch (value_type) {
+    case ':':
+      parseInteger(data, offset_ + 1, line_end);
+      break;
+    case '$': {
+      const int64_t string_length = parseInteger(data, offset_ + 1, line_end);
+      if (string_length >= 0) {
+        // A bulk string body may contain CRLF, so skip it by length rather than searching.
+        const uint64_t body_end = next_offset + string_length;
+        if (body_end + 2 > length) {
+          return 0;
+        }
+        if (data.peekInt<char>(body_end) != '\r' || data.peekInt<char>(body_end + 1) != '\n') {
+          throw ProtocolError("expected carriage return");
+        }
+        next_offset = body_end + 2;
+      }
+      break;
+    }
+    case '*': {
+      const int64_t elements = parseInteger(data, offset_ + 1, line_end);
+      if (elements > 0) {
+        // The array header itself is accounted for by the decrement below.
+        pending_values_ += elements;
+      }
+      break;
+    }
+    default:
+      // Simple strings and errors end at the line break.
+      break;
+    }
+
+    offset_ = next_offset;
+    pending_values_--;
+  }
+
+  const uint64_t frame_length = offset_;
+  offset_ = 0;
+  pending_values_ = 1;
+  return frame_length;
+}
+
+int64_t RespFrameScanner::parseInteger(const Buffer::Instance& data, uint64_t start,
+                                       uint64_t end) {
+  // Large enough for any 64 bit integer including the sign.
+  char buffer[20];
+  if (end <= start || end - start > sizeof(buffer)) {
+    throw ProtocolError("invalid integer character");
+  }
+  data.copyOut(start, end - start, buffer);
+  int64_t value;
+  if (!absl::SimpleAtoi(absl::string_view(buffer, end - start), &value)) {
+    throw ProtocolError("invalid integer character");
+  }
+  return value;
+}
+
 void EncoderImpl::encode(const RespValue& value, Buffer::Instance& out) {
   switch (value.type()) {
   case RespType::Array: {
@@ -559,6 +676,10 @@ void EncoderImpl::encode(const RespValue& value, Buffer::Instance& out) {
     encodeCompositeArray(value.asCompositeArray(), out);
     break;
   }
+  case RespType::Raw: {
+    out.add(value.asRaw());
+    break;
+  }
   case RespType::SimpleString: {
     encodeSimpleString(value.asString(), out);
     break;
@@ -75,6 +75,30 @@ public:
   }
 };
 
+/**
+ * Finds the boundary of the first complete RESP value in a buffer without decoding it. Scanning is
+ * resumable: if the buffer only holds part of a value, scan() returns 0 and a later call, after
+ * more data has been appended, continues from the last complete value header.
+ */
+class RespFrameScanner {
+public:
+  /**
+   * @param data supplies the buffer to scan. The buffer is not modified and must not be drained
+   *        between calls that return 0.
+   * @return the length of the complete RESP value at the front of data, or 0 if more data is
+   *         needed. A ProtocolError is thrown if the data is not valid RESP.
+   */
+  uint64_t scan(const Buffer::Instance& data);
+
+private:
+  int64_t parseInteger(const Buffer::Instance& data, uint64_t start, uint64_t end);
+
+  // Offset of the next value header that has not been scanned yet.
+  uint64_t offset_{};
+  // Number of values still needed to complete the frame at the front of the buffer.
+  uint64_t pending_values_{1};
+};
+
 /**
  * Encoder implementation of https://redis.io/topics/protocol
  */
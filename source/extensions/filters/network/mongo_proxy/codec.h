@@ -187,6 +187,43 @@ public:
 
 using CommandReplyMessagePtr = std::unique_ptr<CommandReplyMessage>;
 
+/**
+ * Mongo OP_MSG. Used for both requests and replies by all modern servers.
+ */
+class MsgMessage : public virtual Message {
+public:
+  struct Flags {
+    // clang-format off
+    static const int32_t ChecksumPresent = 0x1 << 0;
+    static const int32_t MoreToCome      = 0x1 << 1;
+    static const int32_t ExhaustAllowed  = 0x1 << 16;
+    // clang-format on
+  };
+
+  // Section kinds.
+  static constexpr uint8_t BodySection = 0;
+  static constexpr uint8_t DocumentSequenceSection = 1;
+
+  /**
+   * A kind 1 section: a named sequence of documents, e.g. the "documents" of an insert.
+   */
+  struct DocumentSequence {
+    std::string identifier_;
+    std::list<Bson::DocumentSharedPtr> documents_;
+  };
+
+  virtual bool operator==(const MsgMessage& rhs) const PURE;
+
+  virtual int32_t flags() const PURE;
+  virtual void flags(int32_t flags) PURE;
+  virtual const Bson::Document* body() const PURE;
+  virtual void body(Bson::DocumentSharedPtr&& body) PURE;
+  virtual const std::list<DocumentSequence>& documentSequences() const PURE;
+  virtual std::list<DocumentSequence>& documentSequences() PURE;
+};
+
+using MsgMessagePtr = std::unique_ptr<MsgMessage>;
+
 /**
  * General callbacks for dispatching decoded mongo messages to a sink.
  */
@@ -201,6 +238,7 @@ public:
   virtual void decodeReply(ReplyMessagePtr&& message) PURE;
   virtual void decodeCommand(CommandMessagePtr&& message) PURE;
   virtual void decodeCommandReply(CommandReplyMessagePtr&& message) PURE;
+  virtual void decodeMsg(MsgMessagePtr&& message) PURE;
 };
 
 /**
@@ -229,6 +267,7 @@ public:
   virtual void encodeReply(const ReplyMessage& message) PURE;
   virtual void encodeCommand(const CommandMessage& message) PURE;
   virtual void encodeCommandReply(const CommandReplyMessage& message) PURE;
+  virtual void encodeMsg(const MsgMessage& message) PURE;
 };
 
 } // namespace MongoProxy
@@ -341,6 +341,125 @@ bool CommandReplyMessageImpl::operator==(const CommandReplyMessage& rhs) const {
 
   return true;
 }
+
+// OP_MSG implementation.
+void MsgMessageImpl::fromBuffer(uint32_t message_length, Buffer::Instance& data) {
+  ENVOY_LOG(trace, "decoding MSG message");
+  const uint64_t original_data_length = data.length();
+  ASSERT(data.length() >= message_length); // See comment below about relationship.
+
+  if (message_length < Message::Int32Length) {
+    throw EnvoyException("invalid mongo msg message length");
+  }
+  flags_ = Bson::BufferHelper::removeInt32(data);
+  // The optional trailing CRC-32C is not part of any section.
+  const uint64_t checksum_length = (flags_ & Flags::ChecksumPresent) ? Message::Int32Length : 0;
+  if (message_length < Message::Int32Length + checksum_length) {
+    throw EnvoyException("invalid mongo msg message length");
+  }
+  const uint64_t end_of_sections = original_data_length - message_length + checksum_length;
+
+  while (data.length() > end_of_sections) {
+    const uint8_t kind = Bson::BufferHelper::removeByte(data);
+    switch (kind) {
+    case BodySection:
+      if (body_) {
+        throw EnvoyException("mongo msg message has more than one body section");
+      }
+      body_ = Bson::DocumentImpl::create(data);
+      break;
+
+    case DocumentSequenceSection: {
+      // The section size includes itself but not the kind byte.
+      const int32_t section_size = Bson::BufferHelper::removeInt32(data);
+      if (section_size < static_cast<int32_t>(Message::Int32Length) ||
+          static_cast<uint64_t>(section_size) - Message::Int32Length >
+              data.length() - end_of_sections) {
+        throw EnvoyException(fmt::format("invalid mongo msg section size {}", section_size));
+      }
+      const uint64_t end_of_section = data.length() - (section_size - Message::Int32Length);
+      DocumentSequence& sequence = document_sequences_.emplace_back();
+      sequence.identifier_ = Bson::BufferHelper::removeCString(data);
+      while (data.length() > end_of_section) {
+        sequence.documents_.emplace_back(Bson::DocumentImpl::create(data));
+      }
+      if (data.length() != end_of_section) {
+        throw EnvoyException("mongo msg document sequence overruns its section");
+      }
+      break;
+    }
+
+    default:
+      throw EnvoyException(fmt::format("invalid mongo msg section kind {}", kind));
+    }
+  }
+
+  if (data.length() != end_of_sections) {
+    throw EnvoyException("mongo msg sections overrun the message");
+  }
+  if (!body_) {
+    throw EnvoyException("mongo msg message has no body section");
+  }
+  if (checksum_length > 0) {
+    // The checksum is only meaningful to endpoints that validate it; the proxy does not.
+    Bson::BufferHelper::removeInt32(data);
+  }
+
+  ENVOY_LOG(trace, "{}", toString(true));
+}
+
+std::string MsgMessageImpl::toString(bool full) const {
+  std::string sequences;
+  if (full) {
+    std::stringstream out;
+    out << "[";
+    bool first = true;
+    for (const DocumentSequence& sequence : document_sequences_) {
+      if (!first) {
+        out << ", ";
+      }
+      out << fmt::format(R"EOF({{"identifier": "{}", "documents": {}}})EOF", sequence.identifier_,
+                         documentListToString(sequence.documents_));
+      first = false;
+    }
+    out << "]";
+    sequences = out.str();
+  } else {
+    sequences = std::to_string(document_sequences_.size());
+  }
+  return fmt::format(R"EOF({{"opcode": "OP_MSG", "id": {}, "response_to": {}, "flags": "{:#x}", )EOF"
+                     R"EOF("body": {}, "sequences": {}}})EOF",
+                     request_id_, response_to_, flags_, body_ ? body_->toString() : "{}",
+                     sequences);
+}
+
+bool MsgMessageImpl::operator==(const MsgMessage& rhs) const {
+  if (!(requestId() == rhs.requestId() && responseTo() == rhs.responseTo() &&
+        flags() == rhs.flags() && !body() == !rhs.body() &&
+        documentSequences().size() == rhs.documentSequences().size())) {
+    return false;
+  }
+
+  if (body() && !(*body() == *rhs.body())) {
+    return false;
+  }
+
+  for (auto i = documentSequences().begin(), j = rhs.documentSequences().begin();
+       i != documentSequences().end(); i++, j++) {
+    if (i->identifier_ != j->identifier_ || i->documents_.size() != j->documents_.size()) {
+      return false;
+    }
+    for (auto k = i->documents_.begin(), l = j->documents_.begin(); k != i->documents_.end();
+         k++, l++) {
+      if (!(**k == **l)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
 bool DecoderImpl::decode(Buffer::Instance& data) {
   // See if we have enough data for the message length.
   ENVOY_LOG(trace, "decoding {} bytes", data.length());
@@ -421,6 +540,13 @@ bool DecoderImpl::decode(Buffer::Instance& data) {
     break;
   }
 
+  case Message::OpCode::Msg: {
+    std::unique_ptr<MsgMessageImpl> message(new MsgMessageImpl(request_id, response_to));
+    message->fromBuffer(message_length, data);
+    callbacks_.decodeMsg(std::move(message));
+    break;
+  }
+
   default:
     throw EnvoyException(fmt::format("invalid mongo op {}", static_cast<int32_t>(op_code)));
   }
@@ -576,6 +702,42 @@ void EncoderImpl::encodeCommandReply(const CommandReplyMessage& message) {
     document->encode(output_);
   }
 }
+
+void EncoderImpl::encodeMsg(const MsgMessage& message) {
+  // Computing CRC-32C checksums is not supported, so they are never emitted.
+  if (!message.body() || (message.flags() & MsgMessage::Flags::ChecksumPresent)) {
+    throw EnvoyException("invalid msg message");
+  }
+
+  // https://www.mongodb.com/docs/manual/reference/mongodb-wire-protocol/#op_msg
+  int32_t total_size = Message::MessageHeaderSize + Message::Int32Length;
+  total_size += 1 + message.body()->byteSize();
+  for (const MsgMessage::DocumentSequence& sequence : message.documentSequences()) {
+    total_size += 1 + sequenceSize(sequence);
+  }
+
+  // Now encode.
+  encodeCommonHeader(total_size, message, Message::OpCode::Msg);
+  Bson::BufferHelper::writeInt32(output_, message.flags());
+  output_.writeByte(MsgMessage::BodySection);
+  message.body()->encode(output_);
+  for (const MsgMessage::DocumentSequence& sequence : message.documentSequences()) {
+    output_.writeByte(MsgMessage::DocumentSequenceSection);
+    Bson::BufferHelper::writeInt32(output_, sequenceSize(sequence));
+    Bson::BufferHelper::writeCString(output_, sequence.identifier_);
+    for (const Bson::DocumentSharedPtr& document : sequence.documents_) {
+      document->encode(output_);
+    }
+  }
+}
+
+int32_t EncoderImpl::sequenceSize(const MsgMessage::DocumentSequence& sequence) {
+  int32_t size = Message::Int32Length + sequence.identifier_.size() + Message::StringPaddingLength;
+  for (const Bson::DocumentSharedPtr& document : sequence.documents_) {
+    size += document->byteSize();
+  }
+  return size;
+}
 } // namespace MongoProxy
 } // namespace NetworkFilters
 } // namespace Extensions
@@ -269,6 +269,35 @@ private:
   std::list<Bson::DocumentSharedPtr> output_docs_;
 };
 
+// OP_MSG message.
+class MsgMessageImpl : public MessageImpl, public MsgMessage, Logger::Loggable<Logger::Id::mongo> {
+public:
+  using MessageImpl::MessageImpl;
+
+  // MessageImpl.
+  void fromBuffer(uint32_t message_length, Buffer::Instance& data) override;
+  std::string toString(bool full) const override;
+
+  // MsgMessage accessors.
+  bool operator==(const MsgMessage& rhs) const override;
+  bool operator==(const MsgMessageImpl& rhs) const {
+    return operator==(static_cast<const MsgMessage&>(rhs));
+  }
+  int32_t flags() const override { return flags_; }
+  void flags(int32_t flags) override { flags_ = flags; }
+  const Bson::Document* body() const override { return body_.get(); }
+  void body(Bson::DocumentSharedPtr&& body) override { body_ = std::move(body); }
+  const std::list<DocumentSequence>& documentSequences() const override {
+    return document_sequences_;
+  }
+  std::list<DocumentSequence>& documentSequences() override { return document_sequences_; }
+
+private:
+  int32_t flags_{};
+  Bson::DocumentSharedPtr body_;
+  std::list<DocumentSequence> document_sequences_;
+};
+
 class DecoderImpl : public Decoder, Logger::Loggable<Logger::Id::mongo> {
 public:
   DecoderImpl(DecoderCallbacks& callbacks) : callbacks_(callbacks) {}
@@ -294,9 +323,11 @@ public:
   void encodeReply(const ReplyMessage& message) override;
   void encodeCommand(const CommandMessage& message) override;
   void encodeCommandReply(const CommandReplyMessage& message) override;
+  void encodeMsg(const MsgMessage& message) override;
 
 private:
   void encodeCommonHeader(int32_t total_size, const Message& message, Message::OpCode op);
+  static int32_t sequenceSize(const MsgMessage::DocumentSequence& sequence);
 
   Buffer::Instance& output_;
 };
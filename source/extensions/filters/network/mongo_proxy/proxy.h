@@ -57,6 +57,7 @@ using MongoRuntimeConfig = ConstSingleton<MongoRuntimeConfigKeys>;
   COUNTER(op_get_more)                                                                             \
   COUNTER(op_insert)                                                                               \
   COUNTER(op_kill_cursors)                                                                         \
+  COUNTER(op_msg)                                                                                  \
   COUNTER(op_query)                                                                                \
   COUNTER(op_query_await_data)                                                                     \
   COUNTER(op_query_exhaust)                                                                        \
@@ -133,6 +134,7 @@ public:
   void decodeReply(ReplyMessagePtr&& message) override;
   void decodeCommand(CommandMessagePtr&& message) override;
   void decodeCommandReply(CommandReplyMessagePtr&& message) override;
+  void decodeMsg(MsgMessagePtr&& message) override;
 
   // Network::ConnectionCallbacks
   void onEvent(Network::ConnectionEvent event) override;
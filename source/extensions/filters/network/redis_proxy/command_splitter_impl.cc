@@ -163,6 +163,14 @@ SplitRequestPtr SimpleRequest::create(Router& router,
       new SimpleRequest(callbacks, command_stats, time_source, delay_command_latency)};
   const auto route = router.upstreamPool(incoming_request->asArray()[1].asString(), stream_info);
   if (route) {
+    // Transactions are handled by TransactionRequest, so a cached response can always be used.
+    Common::Redis::RespValuePtr cached =
+        route->upstream(incoming_request->asArray()[0].asString())
+            ->lookupCached(incoming_request->asArray()[1].asString(), *incoming_request);
+    if (cached != nullptr) {
+      request_ptr->onResponse(std::move(cached));
+      return nullptr;
+    }
     Common::Redis::RespValueSharedPtr base_request = std::move(incoming_request);
     request_ptr->handle_ = makeSingleServerRequest(
         route, base_request->asArray()[0].asString(), base_request->asArray()[1].asString(),
@@ -283,7 +291,8 @@ void MGETRequest::onChildResponse(Common::Redis::RespValuePtr&& value, uint32_t
   case Common::Redis::RespType::Array:
   case Common::Redis::RespType::Integer:
   case Common::Redis::RespType::SimpleString:
-  case Common::Redis::RespType::CompositeArray: {
+  case Common::Redis::RespType::CompositeArray:
+  case Common::Redis::RespType::Raw: {
     pending_response_->asArray()[index].type(Common::Redis::RespType::Error);
     pending_response_->asArray()[index].asString() = Response::get().UpstreamProtocolError;
     error_count_++;
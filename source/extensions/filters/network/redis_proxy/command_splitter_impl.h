@@ -100,6 +100,7 @@ public:
   void onResponse(Common::Redis::RespValuePtr&& response) override;
   void onFailure() override;
   void onFailure(std::string error_msg);
+  bool acceptsRawResponse() const override { return true; }
 
   // RedisProxy::CommandSplitter::SplitRequest
   void cancel() override;
@@ -247,6 +248,7 @@ protected:
       parent_.onChildResponse(std::move(value), index_);
     }
     void onFailure() override { parent_.onChildFailure(index_); }
+    bool acceptsRawResponse() const override { return false; }
 
     FragmentedRequest& parent_;
     const uint32_t index_;
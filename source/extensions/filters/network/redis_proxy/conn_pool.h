@@ -34,6 +34,12 @@ public:
    * Called when a network/protocol error occurs and there is no response.
    */
   virtual void onFailure() PURE;
+
+  /**
+   * @return bool whether a successful response may be delivered as a RespType::Raw value that is
+   *         still encoded. Callbacks that inspect or combine responses must return false.
+   */
+  virtual bool acceptsRawResponse() const PURE;
 };
 
 /**
@@ -64,6 +70,16 @@ public:
   virtual Common::Redis::Client::PoolRequest*
   makeRequest(const std::string& hash_key, RespVariant&& request, PoolCallbacks& callbacks,
               Common::Redis::Client::Transaction& transaction) PURE;
+
+  /**
+   * Looks up the response to a request in the near cache of the calling worker.
+   * @param key supplies the key of the request.
+   * @param request supplies the request.
+   * @return RespValuePtr a copy of the cached response, or nullptr if there is none or the near
+   *         cache is not enabled.
+   */
+  virtual Common::Redis::RespValuePtr lookupCached(const std::string& key,
+                                                   const Common::Redis::RespValue& request) PURE;
 };
 
 using InstanceSharedPtr = std::shared_ptr<Instance>;
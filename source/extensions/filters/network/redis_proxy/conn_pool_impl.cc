@@ -69,7 +69,14 @@ InstanceImpl::InstanceImpl(
       stats_scope_(std::move(stats_scope)),
       redis_command_stats_(redis_command_stats), redis_cluster_stats_{REDIS_CLUSTER_STATS(
                                                      POOL_COUNTER(*stats_scope_))},
-      refresh_manager_(std::move(refresh_manager)), dns_cache_(dns_cache) {}
+      refresh_manager_(std::move(refresh_manager)), dns_cache_(dns_cache) {
+  if (config.has_near_cache()) {
+    near_cache_config_ = std::make_shared<NearCacheConfig>(config.near_cache());
+    const std::string prefix = "near_cache.";
+    near_cache_stats_.emplace(NearCacheStats{ALL_REDIS_NEAR_CACHE_STATS(
+        POOL_COUNTER_PREFIX(*stats_scope_, prefix), POOL_GAUGE_PREFIX(*stats_scope_, prefix))});
+  }
+}
 
 void InstanceImpl::init() {
   // Note: `this` and `cluster_name` have a a lifetime of the filter.
@@ -95,6 +102,14 @@ InstanceImpl::makeRequest(const std::string& key, RespVariant&& request, PoolCal
                                                        transaction);
 }
 
+Common::Redis::RespValuePtr InstanceImpl::lookupCached(const std::string& key,
+                                                       const Common::Redis::RespValue& request) {
+  if (near_cache_config_ == nullptr || !near_cache_config_->cacheable(request)) {
+    return nullptr;
+  }
+  return tls_->getTyped<ThreadLocalPool>().lookupCached(key, request);
+}
+
 // This method is always called from a InstanceSharedPtr we don't have to worry about tls_->getTyped
 // failing due to InstanceImpl going away.
 Common::Redis::Client::PoolRequest*
@@ -113,7 +128,12 @@ InstanceImpl::ThreadLocalPool::ThreadLocalPool(
       client_factory_(parent->client_factory_), config_(parent->config_),
       stats_scope_(parent->stats_scope_), redis_command_stats_(parent->redis_command_stats_),
       redis_cluster_stats_(parent->redis_cluster_stats_),
-      refresh_manager_(parent->refresh_manager_) {
+      refresh_manager_(parent->refresh_manager_), near_cache_config_(parent->near_cache_config_),
+      near_cache_stats_(parent->near_cache_stats_) {
+  if (near_cache_config_ != nullptr) {
+    near_cache_ = std::make_unique<NearCache>(*near_cache_config_, *near_cache_stats_,
+                                              dispatcher.timeSource());
+  }
   cluster_update_handle_ = parent->cm_.addThreadLocalClusterUpdateCallbacks(*this);
   Upstream::ThreadLocalCluster* cluster = parent->cm_.getThreadLocalCluster(cluster_name_);
   if (cluster != nullptr) {
@@ -202,6 +222,10 @@ void InstanceImpl::ThreadLocalPool::onClusterRemoval(const std::string& cluster_
   cluster_ = nullptr;
   host_address_map_.clear();
   cx_rate_limiter_map_.clear();
+  invalidation_listeners_.clear();
+  if (near_cache_ != nullptr) {
+    near_cache_->clear();
+  }
 }
 
 void InstanceImpl::ThreadLocalPool::onHostsAdded(
@@ -228,6 +252,10 @@ void InstanceImpl::ThreadLocalPool::onHostsRemoved(
     if (token_bucket != cx_rate_limiter_map_.end()) {
       cx_rate_limiter_map_.erase(token_bucket);
     }
+    invalidation_listeners_.erase(host);
+    if (near_cache_ != nullptr) {
+      near_cache_->removeHost(host);
+    }
     auto it = client_map_.find(host);
     if (it != client_map_.end()) {
       if (it->second->redis_client_->active()) {
@@ -328,8 +356,16 @@ InstanceImpl::ThreadLocalPool::makeRequest(const std::string& key, RespVariant&&
       client_map_.erase(host);
       return nullptr;
     }
-    pending_request.request_handler_ = client->redis_client_->makeRequest(
-        getRequest(pending_request.incoming_request_), pending_request);
+    const Common::Redis::RespValue& incoming_request =
+        getRequest(pending_request.incoming_request_);
+    if (near_cache_ != nullptr && near_cache_config_->cacheable(incoming_request) &&
+        ensureTracking(*client)) {
+      pending_request.fill_ = true;
+      pending_request.fill_generation_ =
+          near_cache_->startFill(incoming_request.asArray()[1].asString(), host);
+    }
+    pending_request.request_handler_ =
+        client->redis_client_->makeRequest(incoming_request, pending_request);
   } else {
     pending_request.request_handler_ = transaction.clients_[client_idx]->makeRequest(
         getRequest(pending_request.incoming_request_), pending_request);
@@ -338,6 +374,7 @@ InstanceImpl::ThreadLocalPool::makeRequest(const std::string& key, RespVariant&&
   if (pending_request.request_handler_) {
     return &pending_request;
   } else {
+    pending_request.completeFill(nullptr);
     onRequestCompleted();
     return nullptr;
   }
@@ -416,6 +453,54 @@ Common::Redis::Client::PoolRequest* InstanceImpl::ThreadLocalPool::makeRequestTo
   return client->redis_client_->makeRequest(request, callbacks);
 }
 
+Common::Redis::RespValuePtr
+InstanceImpl::ThreadLocalPool::lookupCached(const std::string& key,
+                                            const Common::Redis::RespValue& request) {
+  if (near_cache_ == nullptr) {
+    return nullptr;
+  }
+  return near_cache_->lookup(key, request);
+}
+
+bool InstanceImpl::ThreadLocalPool::ensureTracking(ThreadLocalActiveClient& client) {
+  if (client.tracking_ || client.tracking_failed_) {
+    return client.tracking_;
+  }
+  // Tracking is only enabled once the listener that invalidation messages are redirected to is
+  // subscribed, as messages redirected to a client that is not subscribed are dropped.
+  InvalidationListenerPtr& listener = invalidation_listeners_[client.host_];
+  if (listener == nullptr) {
+    listener = std::make_unique<InvalidationListener>(client.host_, dispatcher_, *near_cache_,
+                                                      *this, auth_username_, auth_password_);
+  } else if (listener->clientId().has_value()) {
+    client.enableTracking(listener->clientId().value());
+  }
+  return client.tracking_;
+}
+
+void InstanceImpl::ThreadLocalPool::onListenerReady(const Upstream::HostConstSharedPtr& host,
+                                                    int64_t client_id) {
+  auto it = client_map_.find(host);
+  if (it != client_map_.end() && it->second != nullptr && !it->second->tracking_failed_) {
+    it->second->enableTracking(client_id);
+  }
+}
+
+void InstanceImpl::ThreadLocalPool::onListenerClosed(const Upstream::HostConstSharedPtr& host) {
+  // Invalidation messages may have been lost, so drop what was read from the host and track the
+  // data connection again once a new listener is subscribed.
+  near_cache_->flush(host);
+  auto it = client_map_.find(host);
+  if (it != client_map_.end() && it->second != nullptr) {
+    it->second->tracking_ = false;
+  }
+  for (auto& client : clients_to_drain_) {
+    if (client->host_ == host) {
+      client->tracking_ = false;
+    }
+  }
+}
+
 void InstanceImpl::ThreadLocalPool::onRequestCompleted() {
   ASSERT(!pending_requests_.empty());
 
@@ -429,6 +514,11 @@ void InstanceImpl::ThreadLocalPool::onRequestCompleted() {
 void InstanceImpl::ThreadLocalActiveClient::onEvent(Network::ConnectionEvent event) {
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
+    if (tracking_) {
+      // The server stops tracking the keys read on this connection.
+      tracking_ = false;
+      parent_.near_cache_->flush(host_);
+    }
     auto client_to_delete = parent_.client_map_.find(host_);
     if (client_to_delete != parent_.client_map_.end()) {
       parent_.dispatcher_.deferredDelete(std::move(redis_client_));
@@ -449,6 +539,27 @@ void InstanceImpl::ThreadLocalActiveClient::onEvent(Network::ConnectionEvent eve
   }
 }
 
+void InstanceImpl::ThreadLocalActiveClient::enableTracking(int64_t client_id) {
+  tracking_ = true;
+  if (redis_client_->makeRequest(InvalidationListener::trackingRequest(client_id),
+                                 tracking_callbacks_) == nullptr) {
+    tracking_ = false;
+  }
+}
+
+void InstanceImpl::ThreadLocalActiveClient::TrackingCallbacks::onResponse(
+    Common::Redis::RespValuePtr&& value) {
+  if (value->type() != Common::Redis::RespType::Error) {
+    return;
+  }
+  ENVOY_LOG_MISC(debug, "redis near cache: CLIENT TRACKING rejected by {}: {}",
+                 parent_.host_->address()->asString(), value->asString());
+  // Reads sent after the command were not tracked.
+  parent_.tracking_ = false;
+  parent_.tracking_failed_ = true;
+  parent_.parent_.near_cache_->flush(parent_.host_);
+}
+
 InstanceImpl::PendingRequest::PendingRequest(InstanceImpl::ThreadLocalPool& parent,
                                              RespVariant&& incoming_request,
                                              PoolCallbacks& pool_callbacks,
@@ -462,6 +573,7 @@ InstanceImpl::PendingRequest::~PendingRequest() {
   if (request_handler_) {
     request_handler_->cancel();
     request_handler_ = nullptr;
+    completeFill(nullptr);
     // If we have to cancel the request on the client, then we'll treat this as failure for pool
     // callback
     pool_callbacks_.onFailure();
@@ -470,12 +582,14 @@ InstanceImpl::PendingRequest::~PendingRequest() {
 
 void InstanceImpl::PendingRequest::onResponse(Common::Redis::RespValuePtr&& response) {
   request_handler_ = nullptr;
+  completeFill(response.get());
   pool_callbacks_.onResponse(std::move(response));
   parent_.onRequestCompleted();
 }
 
 void InstanceImpl::PendingRequest::onFailure() {
   request_handler_ = nullptr;
+  completeFill(nullptr);
   pool_callbacks_.onFailure();
   parent_.refresh_manager_->onFailure(parent_.cluster_name_);
   parent_.onRequestCompleted();
@@ -484,6 +598,8 @@ void InstanceImpl::PendingRequest::onFailure() {
 void InstanceImpl::PendingRequest::onRedirection(Common::Redis::RespValuePtr&& value,
                                                  const std::string& host_address,
                                                  bool ask_redirection) {
+  // The redirected request is not sent on a tracked connection.
+  completeFill(nullptr);
   if (!parent_.dns_cache_) {
     doRedirection(std::move(value), host_address, ask_redirection);
     return;
@@ -571,9 +687,20 @@ void InstanceImpl::PendingRequest::doRedirection(Common::Redis::RespValuePtr&& v
   }
 }
 
+void InstanceImpl::PendingRequest::completeFill(const Common::Redis::RespValue* response) {
+  if (!fill_) {
+    return;
+  }
+  fill_ = false;
+  const Common::Redis::RespValue& request = getRequest(incoming_request_);
+  parent_.near_cache_->completeFill(request.asArray()[1].asString(), fill_generation_, host_,
+                                    request, response);
+}
+
 void InstanceImpl::PendingRequest::cancel() {
   request_handler_->cancel();
   request_handler_ = nullptr;
+  completeFill(nullptr);
   parent_.onRequestCompleted();
 }
 
@@ -28,6 +28,7 @@
 #include "source/extensions/filters/network/common/redis/codec_impl.h"
 #include "source/extensions/filters/network/common/redis/utility.h"
 #include "source/extensions/filters/network/redis_proxy/conn_pool.h"
+#include "source/extensions/filters/network/redis_proxy/near_cache_impl.h"
 
 #include "absl/container/node_hash_map.h"
 
@@ -53,6 +54,7 @@ class DoNothingPoolCallbacks : public PoolCallbacks {
 public:
   void onResponse(Common::Redis::RespValuePtr&&) override{};
   void onFailure() override{};
+  bool acceptsRawResponse() const override { return true; }
 };
 
 class InstanceImpl : public Instance, public std::enable_shared_from_this<InstanceImpl> {
@@ -70,6 +72,8 @@ public:
   Common::Redis::Client::PoolRequest*
   makeRequest(const std::string& key, RespVariant&& request, PoolCallbacks& callbacks,
               Common::Redis::Client::Transaction& transaction) override;
+  Common::Redis::RespValuePtr lookupCached(const std::string& key,
+                                           const Common::Redis::RespValue& request) override;
   /**
    * Makes a redis request based on IP address and TCP port of the upstream host (e.g.,
    * moved/ask cluster redirection). This is now only kept mostly for testing.
@@ -93,16 +97,41 @@ private:
   struct ThreadLocalPool;
 
   struct ThreadLocalActiveClient : public Network::ConnectionCallbacks {
-    ThreadLocalActiveClient(ThreadLocalPool& parent) : parent_(parent) {}
+    ThreadLocalActiveClient(ThreadLocalPool& parent)
+        : parent_(parent), tracking_callbacks_(*this) {}
 
     // Network::ConnectionCallbacks
     void onEvent(Network::ConnectionEvent event) override;
     void onAboveWriteBufferHighWatermark() override {}
     void onBelowWriteBufferLowWatermark() override {}
 
+    /**
+     * Enables client tracking on the connection, redirecting invalidation messages to the
+     * invalidation listener of the host.
+     */
+    void enableTracking(int64_t client_id);
+
+    // Handles the reply to the CLIENT TRACKING command.
+    struct TrackingCallbacks : public Common::Redis::Client::ClientCallbacks {
+      TrackingCallbacks(ThreadLocalActiveClient& parent) : parent_(parent) {}
+
+      // Common::Redis::Client::ClientCallbacks
+      void onResponse(Common::Redis::RespValuePtr&& value) override;
+      void onFailure() override {}
+      void onRedirection(Common::Redis::RespValuePtr&&, const std::string&, bool) override {}
+      bool acceptsRawResponse() const override { return false; }
+
+      ThreadLocalActiveClient& parent_;
+    };
+
     ThreadLocalPool& parent_;
     Upstream::HostConstSharedPtr host_;
     Common::Redis::Client::ClientPtr redis_client_;
+    TrackingCallbacks tracking_callbacks_;
+    // Whether the reads on the connection are tracked, i.e. their responses may be cached.
+    bool tracking_{};
+    // Set if the host rejected CLIENT TRACKING, in which case it is not attempted again.
+    bool tracking_failed_{};
   };
 
   using ThreadLocalActiveClientPtr = std::unique_ptr<ThreadLocalActiveClient>;
@@ -121,6 +150,7 @@ private:
     void onFailure() override;
     void onRedirection(Common::Redis::RespValuePtr&& value, const std::string& host_address,
                        bool ask_redirection) override;
+    bool acceptsRawResponse() const override { return pool_callbacks_.acceptsRawResponse(); }
 
     // PoolRequest
     void cancel() override;
@@ -132,6 +162,7 @@ private:
     std::string formatAddress(const Envoy::Network::Address::Ip& ip);
     void doRedirection(Common::Redis::RespValuePtr&& value, const std::string& host_address,
                        bool ask_redirection);
+    void completeFill(const Common::Redis::RespValue* response);
 
     ThreadLocalPool& parent_;
     const RespVariant incoming_request_;
@@ -142,10 +173,14 @@ private:
     bool ask_redirection_;
     Extensions::Common::DynamicForwardProxy::DnsCache::LoadDnsCacheEntryHandlePtr
         cache_load_handle_;
+    // Set if the response is to be inserted into the near cache.
+    bool fill_{};
+    uint64_t fill_generation_{};
   };
 
   struct ThreadLocalPool : public ThreadLocal::ThreadLocalObject,
                            public Upstream::ClusterUpdateCallbacks,
+                           public InvalidationListener::Callbacks,
                            public Logger::Loggable<Logger::Id::redis> {
     ThreadLocalPool(std::shared_ptr<InstanceImpl> parent, Event::Dispatcher& dispatcher,
                     std::string cluster_name,
@@ -158,6 +193,9 @@ private:
     Common::Redis::Client::PoolRequest*
     makeRequestToHost(const std::string& host_address, const Common::Redis::RespValue& request,
                       Common::Redis::Client::ClientCallbacks& callbacks);
+    Common::Redis::RespValuePtr lookupCached(const std::string& key,
+                                             const Common::Redis::RespValue& request);
+    bool ensureTracking(ThreadLocalActiveClient& client);
 
     void onClusterAddOrUpdateNonVirtual(absl::string_view cluster_name,
                                         Upstream::ThreadLocalClusterCommand& get_cluster);
@@ -172,6 +210,10 @@ private:
     }
     void onClusterRemoval(const std::string& cluster_name) override;
 
+    // InvalidationListener::Callbacks
+    void onListenerReady(const Upstream::HostConstSharedPtr& host, int64_t client_id) override;
+    void onListenerClosed(const Upstream::HostConstSharedPtr& host) override;
+
     void onRequestCompleted();
 
     std::weak_ptr<InstanceImpl> parent_;
@@ -204,6 +246,12 @@ private:
     Common::Redis::RedisCommandStatsSharedPtr redis_command_stats_;
     RedisClusterStats redis_cluster_stats_;
     const Extensions::Common::Redis::ClusterRefreshManagerSharedPtr refresh_manager_;
+    const NearCacheConfigConstSharedPtr near_cache_config_;
+    absl::optional<NearCacheStats> near_cache_stats_;
+    NearCachePtr near_cache_;
+    // Declared after near_cache_, which the listeners refer to.
+    absl::node_hash_map<Upstream::HostConstSharedPtr, InvalidationListenerPtr>
+        invalidation_listeners_;
   };
 
   const std::string cluster_name_;
@@ -217,6 +265,8 @@ private:
   RedisClusterStats redis_cluster_stats_;
   const Extensions::Common::Redis::ClusterRefreshManagerSharedPtr refresh_manager_;
   const Extensions::Common::DynamicForwardProxy::DnsCacheSharedPtr dns_cache_{nullptr};
+  NearCacheConfigConstSharedPtr near_cache_config_;
+  absl::optional<NearCacheStats> near_cache_stats_;
 };
 
 } // namespace ConnPool
@@ -0,0 +1,409 @@
+#include "source/extensions/filters/network/redis_proxy/near_cache_impl.h"
+
+#include <algorithm>
+
+#include "source/common/common/assert.h"
+#include "source/common/common/macros.h"
+#include "source/common/common/thread.h"
+#include "source/common/protobuf/utility.h"
+#include "source/extensions/filters/network/common/redis/utility.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace ConnPool {
+namespace {
+
+constexpr uint32_t DefaultMaxEntries = 10000;
+constexpr absl::string_view InvalidationChannel = "__redis__:invalidate";
+
+// Read-only single key commands whose response only depends on the value stored at the key, and
+// that are therefore invalidated by the server whenever that key is modified.
+const absl::flat_hash_set<std::string>& cacheableCommands() {
+  CONSTRUCT_ON_FIRST_USE(absl::flat_hash_set<std::string>, "bitcount", "bitpos", "geodist",
+                         "geohash", "geopos", "get", "getbit", "getrange", "hexists", "hget",
+                         "hgetall", "hkeys", "hlen", "hmget", "hstrlen", "hvals", "lindex", "llen",
+                         "lrange", "scard", "sismember", "smembers", "strlen", "type", "zcard",
+                         "zcount", "zlexcount", "zrange", "zrangebylex", "zrangebyscore", "zrank",
+                         "zrevrange", "zrevrangebylex", "zrevrangebyscore", "zrevrank", "zscore");
+}
+
+Common::Redis::RespValue makeCommand(const std::vector<std::string>& args) {
+  std::vector<Common::Redis::RespValue> values(args.size());
+  for (uint64_t i = 0; i < args.size(); i++) {
+    values[i].type(Common::Redis::RespType::BulkString);
+    values[i].asString() = args[i];
+  }
+  Common::Redis::RespValue command;
+  command.type(Common::Redis::RespType::Array);
+  command.asArray().swap(values);
+  return command;
+}
+
+bool isErrorResponse(const Common::Redis::RespValue& response) {
+  if (response.type() == Common::Redis::RespType::Raw) {
+    const Buffer::Instance& raw = response.asRaw();
+    return raw.length() > 0 && raw.peekInt<char>() == '-';
+  }
+  return response.type() == Common::Redis::RespType::Error;
+}
+
+bool isBulkString(const Common::Redis::RespValue& value, absl::string_view expected) {
+  return (value.type() == Common::Redis::RespType::BulkString ||
+          value.type() == Common::Redis::RespType::SimpleString) &&
+         value.asString() == expected;
+}
+
+} // namespace
+
+NearCacheConfig::NearCacheConfig(
+    const envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::NearCache& config)
+    : max_entries_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entries, DefaultMaxEntries)),
+      ttl_(config.has_ttl() ? absl::make_optional(std::chrono::milliseconds(
+                                  DurationUtil::durationToMilliseconds(config.ttl())))
+                            : absl::nullopt) {
+  if (config.commands().empty()) {
+    commands_.insert("get");
+  }
+  for (const std::string& command : config.commands()) {
+    std::string lower = absl::AsciiStrToLower(command);
+    if (!cacheableCommands().contains(lower)) {
+      throw EnvoyException(fmt::format("redis near cache: command '{}' cannot be cached", command));
+    }
+    commands_.insert(std::move(lower));
+  }
+}
+
+bool NearCacheConfig::cacheable(const Common::Redis::RespValue& request) const {
+  if (request.type() != Common::Redis::RespType::Array || request.asArray().size() < 2) {
+    return false;
+  }
+  const Common::Redis::RespValue& command = request.asArray()[0];
+  if (command.type() != Common::Redis::RespType::BulkString) {
+    return false;
+  }
+  return commands_.contains(absl::AsciiStrToLower(command.asString()));
+}
+
+NearCache::NearCache(const NearCacheConfig& config, NearCacheStats& stats,
+                     TimeSource& time_source)
+    : config_(config), stats_(stats), time_source_(time_source) {}
+
+NearCache::~NearCache() { clear(); }
+
+std::string NearCache::signature(const Common::Redis::RespValue& request) {
+  ASSERT(signature_buffer_.length() == 0);
+  encoder_.encode(request, signature_buffer_);
+  std::string result = signature_buffer_.toString();
+  signature_buffer_.drain(signature_buffer_.length());
+  return result;
+}
+
+Common::Redis::RespValuePtr NearCache::lookup(const std::string& key,
+                                              const Common::Redis::RespValue& request) {
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    stats_.miss_.inc();
+    return nullptr;
+  }
+
+  const std::string request_signature = signature(request);
+  std::vector<Response>& responses = it->second->responses_;
+  for (auto response = responses.begin(); response != responses.end(); ++response) {
+    if (response->signature_ != request_signature) {
+      continue;
+    }
+    if (config_.ttl().has_value() &&
+        time_source_.monotonicTime() - response->inserted_ >= config_.ttl().value()) {
+      responses.erase(response);
+      if (responses.empty()) {
+        erase(it->second);
+      }
+      break;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    stats_.hit_.inc();
+    return std::make_unique<Common::Redis::RespValue>(response->value_);
+  }
+
+  stats_.miss_.inc();
+  return nullptr;
+}
+
+uint64_t NearCache::startFill(const std::string& key, const Upstream::HostConstSharedPtr& host) {
+  pending_fills_[key].outstanding_++;
+  return generations_[host.get()];
+}
+
+void NearCache::completeFill(const std::string& key, uint64_t generation,
+                             const Upstream::HostConstSharedPtr& host,
+                             const Common::Redis::RespValue& request,
+                             const Common::Redis::RespValue* response) {
+  auto pending = pending_fills_.find(key);
+  ASSERT(pending != pending_fills_.end());
+  const bool invalidated = pending->second.invalidated_;
+  if (--pending->second.outstanding_ == 0) {
+    pending_fills_.erase(pending);
+  }
+
+  if (response == nullptr || isErrorResponse(*response)) {
+    return;
+  }
+  // The key may have changed, or invalidations for the host may have been missed, since the
+  // request was sent.
+  auto current_generation = generations_.find(host.get());
+  if (invalidated || current_generation == generations_.end() ||
+      current_generation->second != generation) {
+    stats_.fill_skipped_.inc();
+    return;
+  }
+
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    lru_.push_front({key, {}});
+    it = index_.emplace(key, lru_.begin()).first;
+    stats_.entries_.inc();
+  } else {
+    lru_.splice(lru_.begin(), lru_, it->second);
+  }
+
+  std::string request_signature = signature(request);
+  std::vector<Response>& responses = it->second->responses_;
+  for (auto existing = responses.begin(); existing != responses.end(); ++existing) {
+    if (existing->signature_ == request_signature) {
+      responses.erase(existing);
+      break;
+    }
+  }
+  responses.push_back({std::move(request_signature), *response, host,
+                       time_source_.monotonicTime()});
+  stats_.fill_.inc();
+
+  while (index_.size() > config_.maxEntries()) {
+    erase(std::prev(lru_.end()));
+    stats_.eviction_.inc();
+  }
+}
+
+void NearCache::invalidate(absl::string_view key) {
+  const std::string key_string(key);
+  auto pending = pending_fills_.find(key_string);
+  if (pending != pending_fills_.end()) {
+    pending->second.invalidated_ = true;
+  }
+  auto it = index_.find(key_string);
+  if (it != index_.end()) {
+    erase(it->second);
+    stats_.invalidation_.inc();
+  }
+}
+
+void NearCache::flush(const Upstream::HostConstSharedPtr& host) {
+  auto generation = generations_.find(host.get());
+  if (generation == generations_.end()) {
+    return;
+  }
+  generation->second++;
+
+  for (auto entry = lru_.begin(); entry != lru_.end();) {
+    auto current = entry++;
+    std::vector<Response>& responses = current->responses_;
+    responses.erase(std::remove_if(responses.begin(), responses.end(),
+                                   [&host](const Response& response) {
+                                     return response.host_ == host;
+                                   }),
+                    responses.end());
+    if (responses.empty()) {
+      erase(current);
+    }
+  }
+  stats_.flush_.inc();
+}
+
+void NearCache::removeHost(const Upstream::HostConstSharedPtr& host) {
+  flush(host);
+  // Fills still in flight to the host find no generation and are skipped.
+  generations_.erase(host.get());
+}
+
+void NearCache::clear() {
+  stats_.entries_.sub(index_.size());
+  index_.clear();
+  lru_.clear();
+  for (auto& generation : generations_) {
+    generation.second++;
+  }
+}
+
+void NearCache::erase(EntryList::iterator entry) {
+  index_.erase(entry->key_);
+  lru_.erase(entry);
+  stats_.entries_.dec();
+}
+
+InvalidationListener::InvalidationListener(Upstream::HostConstSharedPtr host,
+                                           Event::Dispatcher& dispatcher, NearCache& cache,
+                                           Callbacks& callbacks, const std::string& auth_username,
+                                           const std::string& auth_password)
+    : host_(std::move(host)), dispatcher_(dispatcher), cache_(cache), callbacks_(callbacks),
+      auth_username_(auth_username), auth_password_(auth_password),
+      reconnect_timer_(dispatcher.createTimer([this]() -> void { connect(); })) {
+  connect();
+}
+
+InvalidationListener::~InvalidationListener() {
+  reconnect_timer_->disableTimer();
+  close();
+}
+
+absl::optional<int64_t> InvalidationListener::clientId() const {
+  if (state_ != State::Subscribed) {
+    return absl::nullopt;
+  }
+  return client_id_;
+}
+
+Common::Redis::RespValue InvalidationListener::trackingRequest(int64_t client_id) {
+  return makeCommand({"CLIENT", "TRACKING", "on", "REDIRECT", absl::StrCat(client_id)});
+}
+
+void InvalidationListener::connect() {
+  ASSERT(connection_ == nullptr);
+  connection_ = host_->createConnection(dispatcher_, nullptr, nullptr).connection_;
+  connection_->addConnectionCallbacks(*this);
+  connection_->addReadFilter(Network::ReadFilterSharedPtr{new UpstreamReadFilter(*this)});
+  decoder_ = std::make_unique<Common::Redis::DecoderImpl>(*this);
+  connection_->connect();
+  connection_->noDelay(true);
+
+  Buffer::OwnedImpl request;
+  if (!auth_username_.empty()) {
+    encoder_.encode(Common::Redis::Utility::AuthRequest(auth_username_, auth_password_), request);
+    state_ = State::Authenticating;
+  } else if (!auth_password_.empty()) {
+    encoder_.encode(Common::Redis::Utility::AuthRequest(auth_password_), request);
+    state_ = State::Authenticating;
+  } else {
+    state_ = State::ReadingClientId;
+  }
+  encoder_.encode(makeCommand({"CLIENT", "ID"}), request);
+  encoder_.encode(makeCommand({"SUBSCRIBE", std::string(InvalidationChannel)}), request);
+  connection_->write(request, false);
+}
+
+void InvalidationListener::close() {
+  if (connection_ != nullptr) {
+    closing_ = true;
+    connection_->close(Network::ConnectionCloseType::NoFlush);
+    closing_ = false;
+  }
+}
+
+void InvalidationListener::onEvent(Network::ConnectionEvent event) {
+  if (event != Network::ConnectionEvent::RemoteClose &&
+      event != Network::ConnectionEvent::LocalClose) {
+    return;
+  }
+
+  ENVOY_LOG(debug, "redis near cache: invalidation connection to {} closed",
+            host_->address()->asString());
+  dispatcher_.deferredDelete(std::move(connection_));
+  const bool was_subscribed = state_ == State::Subscribed;
+  state_ = State::Connecting;
+  if (!closing_) {
+    if (was_subscribed) {
+      callbacks_.onListenerClosed(host_);
+    }
+    reconnect_timer_->enableTimer(ReconnectDelay);
+  }
+}
+
+void InvalidationListener::onData(Buffer::Instance& data) {
+  TRY_NEEDS_AUDIT { decoder_->decode(data); }
+  END_TRY
+  catch (Common::Redis::ProtocolError&) {
+    ENVOY_LOG(debug, "redis near cache: protocol error on invalidation connection to {}",
+              host_->address()->asString());
+    data.drain(data.length());
+    connection_->close(Network::ConnectionCloseType::NoFlush);
+  }
+}
+
+void InvalidationListener::onRespValue(Common::Redis::RespValuePtr&& value) {
+  if (connection_ == nullptr || connection_->state() != Network::Connection::State::Open) {
+    return;
+  }
+
+  switch (state_) {
+  case State::Connecting:
+  case State::Authenticating:
+    if (value->type() == Common::Redis::RespType::Error) {
+      ENVOY_LOG(debug, "redis near cache: authentication to {} failed: {}",
+                host_->address()->asString(), value->asString());
+      connection_->close(Network::ConnectionCloseType::NoFlush);
+      return;
+    }
+    state_ = State::ReadingClientId;
+    return;
+  case State::ReadingClientId:
+    if (value->type() != Common::Redis::RespType::Integer) {
+      ENVOY_LOG(debug, "redis near cache: unexpected CLIENT ID reply from {}: {}",
+                host_->address()->asString(), value->toString());
+      connection_->close(Network::ConnectionCloseType::NoFlush);
+      return;
+    }
+    client_id_ = value->asInteger();
+    state_ = State::Subscribing;
+    return;
+  case State::Subscribing:
+    if (value->type() != Common::Redis::RespType::Array || value->asArray().size() != 3 ||
+        !isBulkString(value->asArray()[0], "subscribe")) {
+      ENVOY_LOG(debug, "redis near cache: unexpected SUBSCRIBE reply from {}: {}",
+                host_->address()->asString(), value->toString());
+      connection_->close(Network::ConnectionCloseType::NoFlush);
+      return;
+    }
+    state_ = State::Subscribed;
+    ENVOY_LOG(debug, "redis near cache: listening for invalidations from {} as client {}",
+              host_->address()->asString(), client_id_);
+    callbacks_.onListenerReady(host_, client_id_);
+    return;
+  case State::Subscribed:
+    if (value->type() == Common::Redis::RespType::Array && value->asArray().size() == 3 &&
+        isBulkString(value->asArray()[0], "message") &&
+        isBulkString(value->asArray()[1], InvalidationChannel)) {
+      onInvalidationMessage(value->asArray()[2]);
+    }
+    return;
+  }
+  PANIC_DUE_TO_CORRUPT_ENUM;
+}
+
+void InvalidationListener::onInvalidationMessage(const Common::Redis::RespValue& payload) {
+  switch (payload.type()) {
+  case Common::Redis::RespType::Array:
+    for (const Common::Redis::RespValue& key : payload.asArray()) {
+      if (key.type() == Common::Redis::RespType::BulkString) {
+        cache_.invalidate(key.asString());
+      }
+    }
+    return;
+  case Common::Redis::RespType::BulkString:
+    cache_.invalidate(payload.asString());
+    return;
+  default:
+    // A null payload is sent when the server flushes its databases.
+    cache_.flush(host_);
+    return;
+  }
+}
+
+} // namespace ConnPool
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/extensions/filters/network/redis_proxy/v3/redis_proxy.pb.h"
+#include "envoy/network/connection.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/upstream/upstream.h"
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/common/logger.h"
+#include "source/common/network/filter_impl.h"
+#include "source/extensions/filters/network/common/redis/codec_impl.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace ConnPool {
+
+/**
+ * All redis near cache stats. @see stats_macros.h
+ */
+#define ALL_REDIS_NEAR_CACHE_STATS(COUNTER, GAUGE)                                                 \
+  COUNTER(hit)                                                                                     \
+  COUNTER(miss)                                                                                    \
+  COUNTER(fill)                                                                                    \
+  COUNTER(fill_skipped)                                                                            \
+  COUNTER(invalidation)                                                                            \
+  COUNTER(eviction)                                                                                \
+  COUNTER(flush)                                                                                   \
+  GAUGE(entries, Accumulate)
+
+/**
+ * Struct definition for all redis near cache stats. @see stats_macros.h
+ */
+struct NearCacheStats {
+  ALL_REDIS_NEAR_CACHE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * Immutable near cache settings, shared by all workers.
+ */
+class NearCacheConfig {
+public:
+  NearCacheConfig(
+      const envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::NearCache& config);
+
+  /**
+   * @return whether the response to a request may be cached.
+   */
+  bool cacheable(const Common::Redis::RespValue& request) const;
+
+  uint32_t maxEntries() const { return max_entries_; }
+  absl::optional<std::chrono::milliseconds> ttl() const { return ttl_; }
+
+private:
+  const uint32_t max_entries_;
+  const absl::optional<std::chrono::milliseconds> ttl_;
+  absl::flat_hash_set<std::string> commands_;
+};
+
+using NearCacheConfigConstSharedPtr = std::shared_ptr<const NearCacheConfig>;
+
+/**
+ * A per worker LRU of responses to read-only requests, keyed by the request key. An entry is
+ * removed when the upstream that served it reports the key as modified, when the connection it was
+ * read on or the invalidation connection to that upstream is lost, or when it is evicted.
+ *
+ * Filling is split in two so that an invalidation that arrives while a read is in flight prevents
+ * the possibly stale response from being cached: startFill() is called when the request is sent
+ * and completeFill() once its response arrives.
+ */
+class NearCache : Logger::Loggable<Logger::Id::redis> {
+public:
+  NearCache(const NearCacheConfig& config, NearCacheStats& stats, TimeSource& time_source);
+  ~NearCache();
+
+  /**
+   * @return a copy of the cached response to a request, or nullptr on a miss.
+   */
+  Common::Redis::RespValuePtr lookup(const std::string& key,
+                                     const Common::Redis::RespValue& request);
+
+  /**
+   * Records that a cacheable request is about to be sent to a host.
+   * @return the fill generation of the host, to be passed to completeFill().
+   */
+  uint64_t startFill(const std::string& key, const Upstream::HostConstSharedPtr& host);
+
+  /**
+   * Completes a fill started by startFill().
+   * @param response supplies the response, or nullptr if the request failed.
+   */
+  void completeFill(const std::string& key, uint64_t generation,
+                    const Upstream::HostConstSharedPtr& host,
+                    const Common::Redis::RespValue& request,
+                    const Common::Redis::RespValue* response);
+
+  /**
+   * Removes a key that an upstream reported as modified.
+   */
+  void invalidate(absl::string_view key);
+
+  /**
+   * Removes all entries read from a host and discards the fills in flight to it.
+   */
+  void flush(const Upstream::HostConstSharedPtr& host);
+
+  /**
+   * Flushes a host that is no longer part of the cluster and forgets about it.
+   */
+  void removeHost(const Upstream::HostConstSharedPtr& host);
+
+  /**
+   * Removes all entries.
+   */
+  void clear();
+
+  uint64_t size() const { return index_.size(); }
+
+private:
+  struct Response {
+    std::string signature_;
+    Common::Redis::RespValue value_;
+    Upstream::HostConstSharedPtr host_;
+    MonotonicTime inserted_;
+  };
+
+  struct Entry {
+    std::string key_;
+    std::vector<Response> responses_;
+  };
+
+  struct PendingFill {
+    uint32_t outstanding_{};
+    bool invalidated_{};
+  };
+
+  using EntryList = std::list<Entry>;
+
+  std::string signature(const Common::Redis::RespValue& request);
+  void erase(EntryList::iterator entry);
+
+  const NearCacheConfig& config_;
+  NearCacheStats& stats_;
+  TimeSource& time_source_;
+  Common::Redis::EncoderImpl encoder_;
+  Buffer::OwnedImpl signature_buffer_;
+  // Most recently used entries first.
+  EntryList lru_;
+  absl::flat_hash_map<std::string, EntryList::iterator> index_;
+  absl::flat_hash_map<std::string, PendingFill> pending_fills_;
+  absl::flat_hash_map<const Upstream::HostDescription*, uint64_t> generations_;
+};
+
+using NearCachePtr = std::unique_ptr<NearCache>;
+
+/**
+ * A connection to one upstream host that receives invalidation messages for the keys read through
+ * the worker's data connection to that host. It subscribes to the __redis__:invalidate channel,
+ * and its client ID is used as the REDIRECT target of CLIENT TRACKING on the data connection. The
+ * connection is re-established after a delay if it is lost.
+ */
+class InvalidationListener : public Common::Redis::DecoderCallbacks,
+                             public Network::ConnectionCallbacks,
+                             public Logger::Loggable<Logger::Id::redis> {
+public:
+  class Callbacks {
+  public:
+    virtual ~Callbacks() = default;
+
+    /**
+     * Called once the listener is subscribed and data connections may enable tracking.
+     * @param host supplies the upstream host.
+     * @param client_id supplies the client ID to redirect invalidation messages to.
+     */
+    virtual void onListenerReady(const Upstream::HostConstSharedPtr& host, int64_t client_id) PURE;
+
+    /**
+     * Called when the listener connection is lost. Invalidations may have been missed, so
+     * tracking must be enabled again once the listener is ready.
+     * @param host supplies the upstream host.
+     */
+    virtual void onListenerClosed(const Upstream::HostConstSharedPtr& host) PURE;
+  };
+
+  InvalidationListener(Upstream::HostConstSharedPtr host, Event::Dispatcher& dispatcher,
+                       NearCache& cache, Callbacks& callbacks, const std::string& auth_username,
+                       const std::string& auth_password);
+  ~InvalidationListener() override;
+
+  /**
+   * @return the client ID of the listener connection, if it is subscribed.
+   */
+  absl::optional<int64_t> clientId() const;
+
+  /**
+   * @return the command that enables tracking on a data connection, redirecting invalidation
+   *         messages to the listener with the given client ID.
+   */
+  static Common::Redis::RespValue trackingRequest(int64_t client_id);
+
+  // Common::Redis::DecoderCallbacks
+  void onRespValue(Common::Redis::RespValuePtr&& value) override;
+
+  // Network::ConnectionCallbacks
+  void onEvent(Network::ConnectionEvent event) override;
+  void onAboveWriteBufferHighWatermark() override {}
+  void onBelowWriteBufferLowWatermark() override {}
+
+  static constexpr std::chrono::milliseconds ReconnectDelay{1000};
+
+private:
+  struct UpstreamReadFilter : public Network::ReadFilterBaseImpl {
+    UpstreamReadFilter(InvalidationListener& parent) : parent_(parent) {}
+
+    // Network::ReadFilter
+    Network::FilterStatus onData(Buffer::Instance& data, bool) override {
+      parent_.onData(data);
+      return Network::FilterStatus::StopIteration;
+    }
+
+    InvalidationListener& parent_;
+  };
+
+  enum class State { Connecting, Authenticating, ReadingClientId, Subscribing, Subscribed };
+
+  void connect();
+  void close();
+  void onData(Buffer::Instance& data);
+  void onInvalidationMessage(const Common::Redis::RespValue& payload);
+
+  const Upstream::HostConstSharedPtr host_;
+  Event::Dispatcher& dispatcher_;
+  NearCache& cache_;
+  Callbacks& callbacks_;
+  const std::string auth_username_;
+  const std::string auth_password_;
+  Network::ClientConnectionPtr connection_;
+  std::unique_ptr<Common::Redis::DecoderImpl> decoder_;
+  Common::Redis::EncoderImpl encoder_;
+  Event::TimerPtr reconnect_timer_;
+  State state_{State::Connecting};
+  int64_t client_id_{};
+  bool closing_{};
+};
+
+using InvalidationListenerPtr = std::unique_ptr<InvalidationListener>;
+
+} // namespace ConnPool
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
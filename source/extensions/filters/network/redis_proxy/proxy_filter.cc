@@ -190,7 +190,13 @@ void ProxyFilter::onResponse(PendingRequest& request, Common::Redis::RespValuePt
   // The response we got might not be in order, so flush out what we can. (A new response may
   // unlock several out of order responses).
   while (!pending_requests_.empty() && pending_requests_.front().pending_response_) {
-    encoder_->encode(*pending_requests_.front().pending_response_, encoder_buffer_);
+    Common::Redis::RespValue& response = *pending_requests_.front().pending_response_;
+    if (response.type() == Common::Redis::RespType::Raw) {
+      // The reply is still in its upstream encoding, so its slices can be moved as is.
+      encoder_buffer_.move(response.asRaw());
+    } else {
+      encoder_->encode(response, encoder_buffer_);
+    }
     pending_requests_.pop_front();
   }
 
@@ -169,6 +169,10 @@ DnsFilterEnvoyConfig::DnsFilterEnvoyConfig(
     resolver_timeout_ = std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(
         client_config, resolver_timeout, DEFAULT_RESOLVER_TIMEOUT.count()));
     max_pending_lookups_ = client_config.max_pending_lookups();
+    if (client_config.has_response_cache()) {
+      response_cache_ = std::make_unique<DnsResponseCache>(
+          client_config.response_cache(), api_.timeSource(), root_scope_, config.stat_prefix());
+    }
   } else {
     // In case client_config doesn't exist, create default DNS resolver factory and save it.
     dns_resolver_factory_ = &Network::createDefaultDnsResolverFactory(typed_dns_resolver_config_);
@@ -247,11 +251,21 @@ DnsFilter::DnsFilter(Network::UdpReadFilterCallbacks& callbacks,
     }
 
     incrementExternalQueryTypeCount(query->type_);
+    std::chrono::seconds ttl = getDomainTTL(query->name_);
+    const DnsResponseCache* response_cache = config_->responseCache();
+    if (response_cache != nullptr && !iplist.empty()) {
+      // Answer with the TTL of the cached response, so that the answers served from the cache
+      // never outlive the ones returned by the resolver. A TTL of 0 is honoured: the answer is
+      // not cached.
+      ttl = response_cache->positiveTtl(context->resolved_ttl_.value_or(ttl));
+    }
     for (const auto& ip : iplist) {
       incrementExternalQueryTypeAnswerCount(query->type_);
-      const std::chrono::seconds ttl = getDomainTTL(query->name_);
       message_parser_.storeDnsAnswerRecord(context, *query, ttl, std::move(ip));
     }
+    if (response_cache != nullptr) {
+      cacheResponse(context, *query, ttl);
+    }
     sendDnsResponse(std::move(context));
   };
 
@@ -335,6 +349,10 @@ DnsLookupResponseCode DnsFilter::getResponseForQuery(DnsQueryContextPtr& context
     // Forwarding queries is enabled if the configuration contains a client configuration
     // for the dns_filter.
     if (forward_queries) {
+      if (resolveFromResponseCache(context, *query)) {
+        return DnsLookupResponseCode::Success;
+      }
+
       ENVOY_LOG(debug, "resolving name [{}] via external resolvers", query->name_);
       resolver_->resolveExternalQuery(std::move(context), query.get());
 
@@ -349,6 +367,50 @@ DnsLookupResponseCode DnsFilter::getResponseForQuery(DnsQueryContextPtr& context
   return DnsLookupResponseCode::Success;
 }
 
+bool DnsFilter::resolveFromResponseCache(DnsQueryContextPtr& context,
+                                         const DnsQueryRecord& query) {
+  DnsResponseCache* response_cache = config_->responseCache();
+  // Only the responses to the queries supported by the external resolver are cached.
+  if (response_cache == nullptr ||
+      (query.type_ != DNS_RECORD_TYPE_A && query.type_ != DNS_RECORD_TYPE_AAAA)) {
+    return false;
+  }
+
+  auto result = response_cache->lookup(query);
+  if (!result.has_value()) {
+    return false;
+  }
+
+  ENVOY_LOG(debug, "answering query for [{}] from the response cache", query.name_);
+  if (result->response_->answer_count_ == 0) {
+    config_->stats().unanswered_queries_.inc();
+  }
+  context->cached_response_ = std::move(result->response_);
+  context->cached_response_ttl_ = result->ttl_;
+  return true;
+}
+
+void DnsFilter::cacheResponse(const DnsQueryContextPtr& context, const DnsQueryRecord& query,
+                              std::chrono::seconds ttl) {
+  // Only cache what the resolver answered. Failed resolutions, and queries that were not sent
+  // because there were too many pending lookups, are answered without being cached.
+  if (!context->in_callback_ ||
+      context->resolution_status_ != Network::DnsResolver::ResolutionStatus::Success ||
+      (query.type_ != DNS_RECORD_TYPE_A && query.type_ != DNS_RECORD_TYPE_AAAA)) {
+    return;
+  }
+
+  DnsResponseCache* response_cache = config_->responseCache();
+  DnsCachedResponseConstSharedPtr response = message_parser_.buildCachedResponse(context, query);
+  const std::chrono::seconds cache_ttl =
+      response->answer_count_ == 0 ? response_cache->negativeTtl() : ttl;
+  if (cache_ttl.count() == 0) {
+    // The resolver doesn't allow the answer to be reused.
+    return;
+  }
+  response_cache->insert(query, std::move(response), cache_ttl);
+}
+
 bool DnsFilter::resolveViaConfiguredHosts(DnsQueryContextPtr& context,
                                           const DnsQueryRecord& query) {
   switch (query.type_) {
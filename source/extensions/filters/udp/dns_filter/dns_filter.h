@@ -11,6 +11,7 @@
 #include "source/common/network/utility.h"
 #include "source/extensions/filters/udp/dns_filter/dns_filter_resolver.h"
 #include "source/extensions/filters/udp/dns_filter/dns_parser.h"
+#include "source/extensions/filters/udp/dns_filter/dns_response_cache.h"
 
 #include "absl/container/flat_hash_set.h"
 
@@ -100,6 +101,7 @@ public:
   const TrieLookupTable<DnsVirtualDomainConfigSharedPtr>& getDnsTrie() const {
     return dns_lookup_trie_;
   }
+  DnsResponseCache* responseCache() const { return response_cache_.get(); }
 
 private:
   static DnsFilterStats generateStats(const std::string& stat_prefix, Stats::Scope& scope) {
@@ -132,6 +134,7 @@ private:
   uint64_t max_pending_lookups_;
   envoy::config::core::v3::TypedExtensionConfig typed_dns_resolver_config_;
   Network::DnsResolverFactory* dns_resolver_factory_;
+  DnsResponseCachePtr response_cache_;
 };
 
 using DnsFilterEnvoyConfigSharedPtr = std::shared_ptr<const DnsFilterEnvoyConfig>;
@@ -234,6 +237,25 @@ private:
    */
   bool resolveViaConfiguredHosts(DnsQueryContextPtr& context, const DnsQueryRecord& query);
 
+  /**
+   * @brief Answers the supplied query from the response cache
+   *
+   * @param context object containing the query context
+   * @param query query object containing the name to be resolved
+   * @return bool true if a cached response to the query was found
+   */
+  bool resolveFromResponseCache(DnsQueryContextPtr& context, const DnsQueryRecord& query);
+
+  /**
+   * @brief Caches the response of the external resolver to the supplied query
+   *
+   * @param context object containing the query context and the answers to the query
+   * @param query query object containing the resolved name
+   * @param ttl the TTL of the answers to the query
+   */
+  void cacheResponse(const DnsQueryContextPtr& context, const DnsQueryRecord& query,
+                     std::chrono::seconds ttl);
+
   /**
    * @brief Increment the counter for the given query type for external queries
    *
@@ -86,7 +86,6 @@ void DnsFilterResolver::resolveExternalQuery(DnsQueryContextPtr context,
                        ctx.query_context->resolution_status_ = status;
                        ctx.resolver_status = DnsFilterResolverStatus::Complete;
 
-                       // C-ares doesn't expose the TTL in the data available here.
                        if (status == Network::DnsResolver::ResolutionStatus::Success) {
                          ctx.resolved_hosts.reserve(response.size());
                          for (const auto& resp : response) {
@@ -96,6 +95,10 @@ void DnsFilterResolver::resolveExternalQuery(DnsQueryContextPtr context,
                                      addrinfo.address_->ip()->addressAsString(),
                                      ctx.query_rec->name_);
                            ctx.resolved_hosts.emplace_back(std::move(addrinfo.address_));
+                           if (ctx.resolved_hosts.size() == 1 ||
+                               addrinfo.ttl_ < *ctx.query_context->resolved_ttl_) {
+                             ctx.query_context->resolved_ttl_ = addrinfo.ttl_;
+                           }
                          }
                        }
                        // Invoke the filter callback notifying it of resolved addresses
@@ -454,6 +454,11 @@ void DnsMessageParser::setResponseCode(DnsQueryContextPtr& context,
 
 void DnsMessageParser::buildResponseBuffer(DnsQueryContextPtr& query_context,
                                            Buffer::OwnedImpl& buffer) {
+  if (query_context->cached_response_ != nullptr) {
+    buildCachedResponseBuffer(query_context, buffer);
+    return;
+  }
+
   // Each response must have DNS flags, which spans 4 bytes. Account for them immediately so
   // that we can adjust the number of returned answers to remain under the limit
   size_t total_buffer_size = sizeof(DnsHeaderFlags);
@@ -554,6 +559,16 @@ void DnsMessageParser::buildResponseBuffer(DnsQueryContextPtr& query_context,
                       serialized_authority_rrs, serialized_additional_rrs);
 
   // Build the response buffer for transmission to the client
+  writeResponseHeader(query_context, buffer);
+
+  // write the queries and answers
+  buffer.move(query_buffer);
+  buffer.move(answer_buffer);
+  buffer.move(addl_rec_buffer);
+}
+
+void DnsMessageParser::writeResponseHeader(const DnsQueryContextPtr& query_context,
+                                           Buffer::OwnedImpl& buffer) {
   buffer.writeBEInt<uint16_t>(query_context->response_header_.id);
 
   uint16_t flags;
@@ -564,11 +579,76 @@ void DnsMessageParser::buildResponseBuffer(DnsQueryContextPtr& query_context,
   buffer.writeBEInt<uint16_t>(query_context->response_header_.answers);
   buffer.writeBEInt<uint16_t>(query_context->response_header_.authority_rrs);
   buffer.writeBEInt<uint16_t>(query_context->response_header_.additional_rrs);
+}
 
-  // write the queries and answers
+DnsCachedResponseConstSharedPtr
+DnsMessageParser::buildCachedResponse(const DnsQueryContextPtr& query_context,
+                                      const DnsQueryRecord& query_rec) {
+  auto response = std::make_shared<DnsCachedResponse>();
+
+  // Keep the answers that a response built by buildResponseBuffer() would carry. The query record
+  // takes as many bytes as the name, type and class of an answer record.
+  uint64_t total_buffer_size = sizeof(DnsHeaderFlags);
+  const auto range = query_context->answers_.equal_range(query_rec.name_);
+  for (auto it = range.first; it != range.second; ++it) {
+    DnsAnswerRecord& answer = *it->second;
+    if (answer.type_ != query_rec.type_) {
+      continue;
+    }
+    Buffer::OwnedImpl serialized_name;
+    Buffer::OwnedImpl serialized_answer;
+    if (!answer.serializeName(serialized_name) || !answer.serialize(serialized_answer)) {
+      ENVOY_LOG(debug, "Unable to serialize answer record for {}", query_rec.name_);
+      continue;
+    }
+    if (response->answer_count_ == 0) {
+      total_buffer_size += serialized_name.length() + 2 * sizeof(uint16_t);
+    }
+    total_buffer_size += serialized_answer.length();
+    if (total_buffer_size > MAX_DNS_RESPONSE_SIZE) {
+      break;
+    }
+    // The TTL follows the name, type and class of the record.
+    response->ttl_offsets_.push_back(response->answers_.size() + serialized_name.length() +
+                                     2 * sizeof(uint16_t));
+    response->answers_.append(serialized_answer.toString());
+    if (++response->answer_count_ == MAX_RETURNED_RECORDS) {
+      break;
+    }
+  }
+
+  response->response_code_ =
+      response->answer_count_ == 0 ? DNS_RESPONSE_CODE_NAME_ERROR : DNS_RESPONSE_CODE_NO_ERROR;
+  return response;
+}
+
+void DnsMessageParser::buildCachedResponseBuffer(DnsQueryContextPtr& query_context,
+                                                 Buffer::OwnedImpl& buffer) {
+  const DnsCachedResponse& cached_response = *query_context->cached_response_;
+  ENVOY_LOG(trace, "Building cached response for query ID [{}]", query_context->id_);
+
+  // The parser only accepts queries with a single question.
+  ASSERT(query_context->queries_.size() == 1);
+  Buffer::OwnedImpl query_buffer;
+  uint16_t serialized_queries = 0;
+  if (query_context->queries_.front()->serialize(query_buffer)) {
+    serialized_queries = 1;
+  }
+
+  query_context->response_code_ = cached_response.response_code_;
+  setDnsResponseFlags(query_context, serialized_queries, cached_response.answer_count_,
+                      0 /* authority_rrs */, 0 /* additional_rrs */);
+  writeResponseHeader(query_context, buffer);
   buffer.move(query_buffer);
-  buffer.move(answer_buffer);
-  buffer.move(addl_rec_buffer);
+
+  // Copy the cached answers, replacing the TTLs with the time left before the response expires.
+  std::string answers = cached_response.answers_;
+  const uint32_t ttl = htonl(static_cast<uint32_t>(query_context->cached_response_ttl_.count()));
+  for (const uint64_t offset : cached_response.ttl_offsets_) {
+    ASSERT(offset + sizeof(ttl) <= answers.size());
+    safeMemcpyUnsafeDst(&answers[offset], &ttl);
+  }
+  buffer.add(answers);
 }
 
 } // namespace DnsFilter
@@ -13,6 +13,8 @@
 #include "source/common/stats/timespan_impl.h"
 #include "source/extensions/filters/udp/dns_filter/dns_filter_constants.h"
 
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace UdpFilters {
@@ -166,6 +168,21 @@ PACKED_STRUCT(struct DnsHeader {
   uint16_t additional_rrs;
 });
 
+/**
+ * The response to a query kept by the DNS filter's response cache. The answer records are kept in
+ * wire form so that a cached response is sent without building and serializing the records again.
+ */
+struct DnsCachedResponse {
+  uint16_t response_code_{};
+  uint16_t answer_count_{};
+  // The serialized answer records.
+  std::string answers_;
+  // The offset in answers_ of the TTL of each answer record.
+  std::vector<uint64_t> ttl_offsets_;
+};
+
+using DnsCachedResponseConstSharedPtr = std::shared_ptr<const DnsCachedResponse>;
+
 /**
  * DnsQueryContext contains all the data necessary for responding to a query from a given client.
  */
@@ -192,6 +209,11 @@ public:
   DnsAnswerMap answers_;
   DnsAnswerMap additional_;
   bool in_callback_;
+  // The lowest TTL of the addresses returned by the external resolver, unset if it returned none.
+  absl::optional<std::chrono::seconds> resolved_ttl_;
+  // Set when the query is answered from the response cache, with the TTL left on the response.
+  DnsCachedResponseConstSharedPtr cached_response_;
+  std::chrono::seconds cached_response_ttl_{};
 
   /**
    * @param context the query context for which we are querying the response code
@@ -226,6 +248,16 @@ public:
    */
   void buildResponseBuffer(DnsQueryContextPtr& query_context, Buffer::OwnedImpl& buffer);
 
+  /**
+   * @brief serializes the answers to a query so that they can be kept in the response cache
+   *
+   * @param query_context the query context holding the answers to the query
+   * @param query_rec the query whose answers are serialized
+   * @return DnsCachedResponseConstSharedPtr the response in wire form
+   */
+  DnsCachedResponseConstSharedPtr buildCachedResponse(const DnsQueryContextPtr& query_context,
+                                                      const DnsQueryRecord& query_rec);
+
   /**
    * @brief parse a single query record from a client request
    *
@@ -354,6 +386,20 @@ private:
                            const uint16_t answers, const uint16_t authority_rrs,
                            const uint16_t additional_rrs);
 
+  /**
+   * @brief builds the response to a query answered from the response cache, copying the cached
+   * answer records and rewriting their TTLs
+   *
+   * @param query_context the query context holding the cached response
+   * @param buffer the buffer receiving the response sent to the client
+   */
+  void buildCachedResponseBuffer(DnsQueryContextPtr& query_context, Buffer::OwnedImpl& buffer);
+
+  /**
+   * @brief writes the DNS header of the response sent to a client
+   */
+  void writeResponseHeader(const DnsQueryContextPtr& query_context, Buffer::OwnedImpl& buffer);
+
   /**
    * @brief Extracts a DNS query name from a buffer
    *
@@ -0,0 +1,101 @@
+#include "source/extensions/filters/udp/dns_filter/dns_response_cache.h"
+
+#include "source/common/common/lock_guard.h"
+#include "source/common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace DnsFilter {
+
+static constexpr uint32_t DEFAULT_MAX_ENTRIES = 1024;
+static constexpr uint64_t DEFAULT_MAX_TTL_MS = 300000;
+static constexpr uint64_t DEFAULT_NEGATIVE_TTL_MS = 30000;
+
+DnsResponseCache::DnsResponseCache(
+    const envoy::extensions::filters::udp::dns_filter::v3::DnsFilterConfig::ResponseCacheConfig&
+        config,
+    TimeSource& time_source, Stats::Scope& scope, const std::string& stat_prefix)
+    : time_source_(time_source), stats_(generateStats(stat_prefix, scope)),
+      max_entries_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entries, DEFAULT_MAX_ENTRIES)),
+      max_ttl_(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::milliseconds(
+          PROTOBUF_GET_MS_OR_DEFAULT(config, max_ttl, DEFAULT_MAX_TTL_MS)))),
+      negative_ttl_(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::milliseconds(
+          PROTOBUF_GET_MS_OR_DEFAULT(config, negative_ttl, DEFAULT_NEGATIVE_TTL_MS)))) {}
+
+DnsResponseCacheStats DnsResponseCache::generateStats(const std::string& stat_prefix,
+                                                      Stats::Scope& scope) {
+  const auto final_prefix = absl::StrCat("dns_filter.", stat_prefix, ".response_cache");
+  return {ALL_DNS_RESPONSE_CACHE_STATS(POOL_COUNTER_PREFIX(scope, final_prefix),
+                                       POOL_GAUGE_PREFIX(scope, final_prefix))};
+}
+
+absl::optional<DnsCacheLookupResult> DnsResponseCache::lookup(const DnsQueryRecord& query) {
+  const MonotonicTime now = time_source_.monotonicTime();
+  Thread::LockGuard lock(mutex_);
+  auto it = entries_.find(Key{query.name_, query.type_, query.class_});
+  if (it == entries_.end()) {
+    stats_.misses_.inc();
+    return absl::nullopt;
+  }
+  if (it->second.expires_at_ <= now) {
+    ENVOY_LOG(trace, "cached response for [{}] expired", query.name_);
+    erase(it);
+    stats_.misses_.inc();
+    return absl::nullopt;
+  }
+
+  Entry& entry = it->second;
+  lru_.splice(lru_.begin(), lru_, entry.lru_position_);
+  if (entry.response_->answer_count_ == 0) {
+    stats_.negative_hits_.inc();
+  } else {
+    stats_.hits_.inc();
+  }
+  // Round up so that a response is never served with a TTL of zero.
+  const auto ttl = std::chrono::ceil<std::chrono::seconds>(entry.expires_at_ - now);
+  return DnsCacheLookupResult{entry.response_, ttl};
+}
+
+void DnsResponseCache::insert(const DnsQueryRecord& query,
+                              DnsCachedResponseConstSharedPtr response, std::chrono::seconds ttl) {
+  if (ttl.count() <= 0) {
+    return;
+  }
+
+  const MonotonicTime expires_at = time_source_.monotonicTime() + ttl;
+  Thread::LockGuard lock(mutex_);
+  Key key{query.name_, query.type_, query.class_};
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    // Another worker resolved the same query in the meantime. Keep the latest response.
+    it->second.response_ = std::move(response);
+    it->second.expires_at_ = expires_at;
+    lru_.splice(lru_.begin(), lru_, it->second.lru_position_);
+    return;
+  }
+
+  if (entries_.size() >= max_entries_) {
+    auto victim = entries_.find(lru_.back());
+    ASSERT(victim != entries_.end());
+    ENVOY_LOG(trace, "evicting cached response for [{}]", std::get<0>(victim->first));
+    erase(victim);
+    stats_.evictions_.inc();
+  }
+
+  lru_.push_front(key);
+  entries_.emplace(std::move(key), Entry{std::move(response), expires_at, lru_.begin()});
+  stats_.insertions_.inc();
+  stats_.entries_.inc();
+}
+
+void DnsResponseCache::erase(absl::flat_hash_map<Key, Entry>::iterator it) {
+  lru_.erase(it->second.lru_position_);
+  entries_.erase(it);
+  stats_.entries_.dec();
+}
+
+} // namespace DnsFilter
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <tuple>
+
+#include "envoy/common/time.h"
+#include "envoy/extensions/filters/udp/dns_filter/v3/dns_filter.pb.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "source/common/common/logger.h"
+#include "source/common/common/thread.h"
+#include "source/extensions/filters/udp/dns_filter/dns_parser.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace DnsFilter {
+
+/**
+ * All DNS filter response cache stats. @see stats_macros.h
+ */
+#define ALL_DNS_RESPONSE_CACHE_STATS(COUNTER, GAUGE)                                               \
+  COUNTER(hits)                                                                                    \
+  COUNTER(negative_hits)                                                                           \
+  COUNTER(misses)                                                                                  \
+  COUNTER(insertions)                                                                              \
+  COUNTER(evictions)                                                                               \
+  GAUGE(entries, NeverImport)
+
+/**
+ * Struct definition for all DNS filter response cache stats. @see stats_macros.h
+ */
+struct DnsResponseCacheStats {
+  ALL_DNS_RESPONSE_CACHE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * A response found in the cache, with the TTL left before it expires.
+ */
+struct DnsCacheLookupResult {
+  DnsCachedResponseConstSharedPtr response_;
+  std::chrono::seconds ttl_;
+};
+
+/**
+ * A bounded LRU cache of the responses to queries resolved by external resolvers, keyed by the
+ * query name, type and class. It is owned by the filter config and shared by all workers.
+ */
+class DnsResponseCache : Logger::Loggable<Logger::Id::filter> {
+public:
+  DnsResponseCache(
+      const envoy::extensions::filters::udp::dns_filter::v3::DnsFilterConfig::ResponseCacheConfig&
+          config,
+      TimeSource& time_source, Stats::Scope& scope, const std::string& stat_prefix);
+
+  /**
+   * @return the cached response to the query, if there is one that has not expired.
+   */
+  absl::optional<DnsCacheLookupResult> lookup(const DnsQueryRecord& query);
+
+  /**
+   * Caches the response to a query for the supplied TTL, evicting the least recently used
+   * response if the cache is full. A response with a TTL of zero is not cached.
+   */
+  void insert(const DnsQueryRecord& query, DnsCachedResponseConstSharedPtr response,
+              std::chrono::seconds ttl);
+
+  /**
+   * @return the TTL of a response with addresses whose lowest TTL is resolved_ttl.
+   */
+  std::chrono::seconds positiveTtl(std::chrono::seconds resolved_ttl) const {
+    return std::min(resolved_ttl, max_ttl_);
+  }
+
+  /**
+   * @return the TTL of a response without addresses.
+   */
+  std::chrono::seconds negativeTtl() const { return negative_ttl_; }
+
+  const DnsResponseCacheStats& stats() const { return stats_; }
+
+private:
+  using Key = std::tuple<std::string, uint16_t, uint16_t>;
+
+  struct Entry {
+    DnsCachedResponseConstSharedPtr response_;
+    MonotonicTime expires_at_;
+    std::list<Key>::iterator lru_position_;
+  };
+
+  static DnsResponseCacheStats generateStats(const std::string& stat_prefix, Stats::Scope& scope);
+  void erase(absl::flat_hash_map<Key, Entry>::iterator it) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  TimeSource& time_source_;
+  DnsResponseCacheStats stats_;
+  const uint32_t max_entries_;
+  const std::chrono::seconds max_ttl_;
+  const std::chrono::seconds negative_ttl_;
+  Thread::MutexBasicLockable mutex_;
+  absl::flat_hash_map<Key, Entry> entries_ ABSL_GUARDED_BY(mutex_);
+  // Most recently used first.
+  std::list<Key> lru_ ABSL_GUARDED_BY(mutex_);
+};
+
+using DnsResponseCachePtr = std::unique_ptr<DnsResponseCache>;
+
+} // namespace DnsFilter
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -1,6 +1,8 @@
 #include "source/extensions/filters/udp/udp_proxy/config.h"
 
+#include "source/common/config/utility.h"
 #include "source/common/formatter/substitution_format_string.h"
+#include "source/common/network/udp_packet_writer_handler_impl.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -96,7 +98,7 @@ UdpProxyFilterConfigImpl::UdpProxyFilterConfigImpl(
       use_per_packet_load_balancing_(config.use_per_packet_load_balancing()),
       stats_(generateStats(config.stat_prefix(), context.scope())),
       // Default prefer_gro to true for upstream client traffic.
-      upstream_socket_config_(config.upstream_socket_config(), true),
+      upstream_socket_config_(config.upstream_socket_config(), true), scope_(context.scope()),
       random_generator_(context.serverFactoryContext().api().randomGenerator()) {
   if (use_per_packet_load_balancing_ && config.has_tunneling_config()) {
     throw EnvoyException(
@@ -134,6 +136,18 @@ UdpProxyFilterConfigImpl::UdpProxyFilterConfigImpl(
     tunneling_config_ = std::make_unique<TunnelingConfigImpl>(config.tunneling_config(), context);
   }
 
+  if (config.has_upstream_udp_packet_writer_config()) {
+    auto& factory_factory =
+        Config::Utility::getAndCheckFactory<Network::UdpPacketWriterFactoryFactory>(
+            config.upstream_udp_packet_writer_config());
+    upstream_writer_factory_ =
+        factory_factory.createUdpPacketWriterFactory(config.upstream_udp_packet_writer_config());
+  }
+  // A writer extension may not be supported by this build, in which case it creates no factory.
+  if (upstream_writer_factory_ == nullptr) {
+    upstream_writer_factory_ = std::make_unique<Network::UdpDefaultWriterFactory>();
+  }
+
   if (config.has_access_log_options()) {
     flush_access_log_on_tunnel_connected_ =
         config.access_log_options().flush_access_log_on_tunnel_connected();
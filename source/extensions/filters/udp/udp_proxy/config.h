@@ -142,6 +142,10 @@ public:
   const Network::ResolvedUdpSocketConfig& upstreamSocketConfig() const override {
     return upstream_socket_config_;
   }
+  Network::UdpPacketWriterPtr
+  createUpstreamPacketWriter(Network::IoHandle& io_handle) const override {
+    return upstream_writer_factory_->createUdpPacketWriter(io_handle, scope_);
+  }
   const std::vector<AccessLog::InstanceSharedPtr>& sessionAccessLogs() const override {
     return session_access_logs_;
   }
@@ -185,6 +189,8 @@ private:
   std::unique_ptr<const HashPolicyImpl> hash_policy_;
   mutable UdpProxyDownstreamStats stats_;
   const Network::ResolvedUdpSocketConfig upstream_socket_config_;
+  Network::UdpPacketWriterFactoryPtr upstream_writer_factory_;
+  Stats::Scope& scope_;
   std::vector<AccessLog::InstanceSharedPtr> session_access_logs_;
   std::vector<AccessLog::InstanceSharedPtr> proxy_access_logs_;
   UdpTunnelingConfigPtr tunneling_config_;
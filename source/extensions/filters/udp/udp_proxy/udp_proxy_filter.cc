@@ -39,6 +39,25 @@ UdpProxyFilter::~UdpProxyFilter() {
   }
 }
 
+void UdpProxyFilter::scheduleUpstreamFlush(UdpActiveSession& session) {
+  if (upstream_flush_cb_ == nullptr) {
+    upstream_flush_cb_ = read_callbacks_->udpListener().dispatcher().createSchedulableCallback(
+        [this]() { flushUpstream(); });
+  }
+  sessions_pending_upstream_flush_.insert(&session);
+  if (!upstream_flush_cb_->enabled()) {
+    upstream_flush_cb_->scheduleCallbackCurrentIteration();
+  }
+}
+
+void UdpProxyFilter::flushUpstream() {
+  const auto sessions = std::move(sessions_pending_upstream_flush_);
+  sessions_pending_upstream_flush_.clear();
+  for (UdpActiveSession* session : sessions) {
+    session->flushUpstream();
+  }
+}
+
 void UdpProxyFilter::onClusterAddOrUpdate(absl::string_view cluster_name,
                                           Upstream::ThreadLocalClusterCommand& get_cluster) {
   ENVOY_LOG(debug, "udp proxy: attaching to cluster {}", cluster_name);
@@ -300,6 +319,13 @@ UdpProxyFilter::UdpActiveSession::UdpActiveSession(
     : ActiveSession(cluster, std::move(addresses), std::move(host)),
       use_original_src_ip_(cluster.filter_.config_->usingOriginalSrcIp()) {}
 
+UdpProxyFilter::UdpActiveSession::~UdpActiveSession() {
+  if (writer_ != nullptr && writer_->isBatchMode()) {
+    cluster_.filter_.sessions_pending_upstream_flush_.erase(this);
+    flushUpstream();
+  }
+}
+
 UdpProxyFilter::ActiveSession::~ActiveSession() {
   ENVOY_BUG(on_session_complete_called_, "onSessionComplete() not called");
 }
@@ -391,6 +417,25 @@ void UdpProxyFilter::UdpActiveSession::onIdleTimer() {
   cluster_.removeSession(this);
 }
 
+void UdpProxyFilter::UdpActiveSession::onWriteReady() {
+  writer_->setWritable();
+  udp_socket_->ioHandle().enableFileEvents(Event::FileReadyType::Read);
+  if (writer_->isBatchMode()) {
+    flushUpstream();
+  }
+}
+
+void UdpProxyFilter::UdpActiveSession::flushUpstream() {
+  const Api::IoCallUint64Result rc = writer_->flush();
+  if (!rc.ok()) {
+    cluster_.cluster_stats_.sess_tx_errors_.inc();
+    if (writer_->isWriteBlocked()) {
+      udp_socket_->ioHandle().enableFileEvents(Event::FileReadyType::Read |
+                                               Event::FileReadyType::Write);
+    }
+  }
+}
+
 void UdpProxyFilter::UdpActiveSession::onReadReady() {
   resetIdleTimer();
 
@@ -496,12 +541,24 @@ void UdpProxyFilter::UdpActiveSession::writeUpstream(Network::UdpRecvData& data)
             tx_buffer_length, addresses_.peer_->asStringView(), addresses_.local_->asStringView(),
             host_->address()->asStringView());
 
+  if (writer_->isWriteBlocked()) {
+    // The socket buffer is full. Drop the datagram until the socket becomes writable again.
+    cluster_.cluster_stats_.sess_tx_errors_.inc();
+    return;
+  }
+
   const Network::Address::Ip* local_ip = use_original_src_ip_ ? addresses_.peer_->ip() : nullptr;
-  Api::IoCallUint64Result rc = Network::Utility::writeToSocket(
-      udp_socket_->ioHandle(), *data.buffer_, local_ip, *host_->address());
+  Api::IoCallUint64Result rc = writer_->writePacket(*data.buffer_, local_ip, *host_->address());
+  if (writer_->isBatchMode()) {
+    cluster_.filter_.scheduleUpstreamFlush(*this);
+  }
 
   if (!rc.ok()) {
     cluster_.cluster_stats_.sess_tx_errors_.inc();
+    if (writer_->isWriteBlocked()) {
+      udp_socket_->ioHandle().enableFileEvents(Event::FileReadyType::Read |
+                                               Event::FileReadyType::Write);
+    }
   } else {
     cluster_.cluster_stats_.sess_tx_datagrams_.inc();
     cluster_.cluster_.info()->trafficStats()->upstream_cx_tx_bytes_total_.add(tx_buffer_length);
@@ -558,10 +615,18 @@ void UdpProxyFilter::UdpActiveSession::createUdpSocket(const Upstream::HostConst
   // NOTE: The socket call can only fail due to memory/fd exhaustion. No local ephemeral port
   //       is bound until the first packet is sent to the upstream host.
   udp_socket_ = cluster_.filter_.createUdpSocket(host);
+  writer_ = cluster_.filter_.config_->createUpstreamPacketWriter(udp_socket_->ioHandle());
   udp_socket_->ioHandle().initializeFileEvent(
       cluster_.filter_.read_callbacks_->udpListener().dispatcher(),
-      [this](uint32_t) { onReadReady(); }, Event::PlatformDefaultTriggerType,
-      Event::FileReadyType::Read);
+      [this](uint32_t events) {
+        if (events & Event::FileReadyType::Write) {
+          onWriteReady();
+        }
+        if (events & Event::FileReadyType::Read) {
+          onReadReady();
+        }
+      },
+      Event::PlatformDefaultTriggerType, Event::FileReadyType::Read);
 
   ENVOY_LOG(debug, "creating new session: downstream={} local={} upstream={}",
             addresses_.peer_->asStringView(), addresses_.local_->asStringView(),
@@ -3,10 +3,12 @@
 #include "envoy/access_log/access_log.h"
 #include "envoy/config/accesslog/v3/accesslog.pb.h"
 #include "envoy/event/file_event.h"
+#include "envoy/event/schedulable_cb.h"
 #include "envoy/event/timer.h"
 #include "envoy/extensions/filters/udp/udp_proxy/v3/udp_proxy.pb.h"
 #include "envoy/http/header_evaluator.h"
 #include "envoy/network/filter.h"
+#include "envoy/network/udp_packet_writer_handler.h"
 #include "envoy/stream_info/stream_info.h"
 #include "envoy/stream_info/uint32_accessor.h"
 #include "envoy/upstream/cluster_manager.h"
@@ -129,6 +131,8 @@ public:
   virtual UdpProxyDownstreamStats& stats() const PURE;
   virtual TimeSource& timeSource() const PURE;
   virtual const Network::ResolvedUdpSocketConfig& upstreamSocketConfig() const PURE;
+  virtual Network::UdpPacketWriterPtr
+  createUpstreamPacketWriter(Network::IoHandle& io_handle) const PURE;
   virtual const std::vector<AccessLog::InstanceSharedPtr>& sessionAccessLogs() const PURE;
   virtual const std::vector<AccessLog::InstanceSharedPtr>& proxyAccessLogs() const PURE;
   virtual const FilterChainFactory& sessionFilterFactory() const PURE;
@@ -626,7 +630,12 @@ private:
   public:
     UdpActiveSession(ClusterInfo& parent, Network::UdpRecvData::LocalPeerAddresses&& addresses,
                      const Upstream::HostConstSharedPtr& host);
-    ~UdpActiveSession() override = default;
+    ~UdpActiveSession() override;
+
+    /**
+     * Sends the datagrams buffered by a batching upstream writer.
+     */
+    void flushUpstream();
 
     // ActiveSession
     bool createUpstream() override;
@@ -653,12 +662,15 @@ private:
 
   private:
     void onReadReady();
+    void onWriteReady();
     void createUdpSocket(const Upstream::HostConstSharedPtr& host);
 
     // The socket is used for writing packets to the selected upstream host as well as receiving
     // packets from the upstream host. Note that a a local ephemeral port is bound on the first
     // write to the upstream host.
     Network::SocketPtr udp_socket_;
+    // Writes to udp_socket_, so it must be destroyed first.
+    Network::UdpPacketWriterPtr writer_;
     // The socket has been connected to avoid port exhaustion.
     bool connected_{};
     const bool use_original_src_ip_;
@@ -858,6 +870,8 @@ private:
   }
 
   void fillProxyStreamInfo();
+  void scheduleUpstreamFlush(UdpActiveSession& session);
+  void flushUpstream();
 
   // Upstream::ClusterUpdateCallbacks
   void onClusterAddOrUpdate(absl::string_view cluster_name,
@@ -866,6 +880,10 @@ private:
 
   const UdpProxyFilterConfigSharedPtr config_;
   const Upstream::ClusterUpdateCallbacksHandlePtr cluster_update_callbacks_;
+  // Sessions with datagrams buffered by a batching upstream writer, sent at the end of the current
+  // event loop iteration. Must outlive the sessions, which remove themselves on destruction.
+  absl::flat_hash_set<UdpActiveSession*> sessions_pending_upstream_flush_;
+  Event::SchedulableCallbackPtr upstream_flush_cb_;
   // Map for looking up cluster info with its name.
   absl::flat_hash_map<std::string, ClusterInfoPtr> cluster_infos_;
 
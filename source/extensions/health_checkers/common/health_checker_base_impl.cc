@@ -3,14 +3,22 @@
 #include "envoy/config/core/v3/address.pb.h"
 #include "envoy/config/core/v3/health_check.pb.h"
 #include "envoy/data/core/v3/health_check_event.pb.h"
+#include "envoy/singleton/manager.h"
 #include "envoy/stats/scope.h"
 
 #include "source/common/network/utility.h"
+#include "source/common/protobuf/utility.h"
 #include "source/common/router/router.h"
+#include "source/common/stats/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
 
 namespace Envoy {
 namespace Upstream {
 
+SINGLETON_MANAGER_REGISTRATION(shared_health_check_session_registry);
+
 HealthCheckerImplBase::HealthCheckerImplBase(const Cluster& cluster,
                                              const envoy::config::core::v3::HealthCheck& config,
                                              Event::Dispatcher& dispatcher,
@@ -83,6 +91,34 @@ HealthCheckerImplBase::~HealthCheckerImplBase() {
   }
 }
 
+void HealthCheckerImplBase::initSharedSessions(
+    const envoy::config::core::v3::HealthCheck& config,
+    Server::Configuration::HealthCheckerFactoryContext& context) {
+  ASSERT(active_sessions_.empty());
+  if (!config.share_across_clusters()) {
+    return;
+  }
+
+  Server::Configuration::ServerFactoryContext& server_context = context.serverFactoryContext();
+  shared_session_registry_ = server_context.singletonManager().getTyped<SharedSessionRegistry>(
+      SINGLETON_MANAGER_REGISTERED_NAME(shared_health_check_session_registry), [&server_context] {
+        return std::make_shared<SharedSessionRegistry>(server_context.serverScope());
+      });
+  shared_session_config_hash_ = absl::StrCat(MessageUtil::hash(config));
+}
+
+std::string HealthCheckerImplBase::sharedSessionKey(const Host& host) const {
+  return absl::StrCat(shared_session_config_hash_, "/", host.healthCheckAddress()->asString());
+}
+
+std::string HealthCheckerImplBase::sharedSessionStatPrefix(const Host& host) const {
+  // Dots would split the address into several stat name segments.
+  return absl::StrCat(
+      absl::StrReplaceAll(Stats::Utility::sanitizeStatsName(host.healthCheckAddress()->asString()),
+                          {{".", "_"}}),
+      ".", shared_session_config_hash_);
+}
+
 void HealthCheckerImplBase::decHealthy() { stats_.healthy_.sub(1); }
 
 void HealthCheckerImplBase::decDegraded() { stats_.degraded_.sub(1); }
@@ -251,6 +287,23 @@ HealthCheckerImplBase::ActiveHealthCheckSession::ActiveHealthCheckSession(
   }
 }
 
+void HealthCheckerImplBase::ActiveHealthCheckSession::start() {
+  if (parent_.shared_session_registry_ != nullptr) {
+    shared_subscription_ =
+        parent_.shared_session_registry_->subscribe(
+            parent_.sharedSessionKey(*host_), parent_.sharedSessionStatPrefix(*host_), *this);
+    if (!shared_subscription_->leader()) {
+      // Followers never probe. If the shared session already has a result, replay it from the
+      // interval timer rather than inline, as we are in the middle of a cluster membership update.
+      if (shared_subscription_->lastResult().has_value()) {
+        interval_timer_->enableTimer(std::chrono::milliseconds(0));
+      }
+      return;
+    }
+  }
+  onInitialInterval();
+}
+
 HealthCheckerImplBase::ActiveHealthCheckSession::~ActiveHealthCheckSession() {
   // Make sure onDeferredDeleteBase() has been called. We should not reference our parent at this
   // point since we may have been deferred deleted.
@@ -259,7 +312,9 @@ HealthCheckerImplBase::ActiveHealthCheckSession::~ActiveHealthCheckSession() {
 
 void HealthCheckerImplBase::ActiveHealthCheckSession::onDeferredDeleteBase() {
   // The session is about to be deferred deleted. Make sure all timers are gone and any
-  // implementation specific state is destroyed.
+  // implementation specific state is destroyed. Leaving a shared session first may hand probing
+  // over to another cluster's session.
+  shared_subscription_.reset();
   interval_timer_.reset();
   timeout_timer_.reset();
   if (!host_->healthFlagGet(Host::HealthFlag::FAILED_ACTIVE_HC)) {
@@ -277,6 +332,25 @@ void HealthCheckerImplBase::ActiveHealthCheckSession::onDeferredDeleteBase() {
 }
 
 void HealthCheckerImplBase::ActiveHealthCheckSession::handleSuccess(bool degraded) {
+  const HealthTransition changed_state = applySuccess(degraded);
+  const std::chrono::milliseconds interval = publishSharedResult(
+      SharedHealthCheckResult{true, degraded, envoy::data::core::v3::ACTIVE, false},
+      parent_.interval(HealthState::Healthy, changed_state));
+
+  // It's possible that the shared result fan out caused this session to be deferred deleted.
+  if (timeout_timer_ != nullptr) {
+    timeout_timer_->disableTimer();
+  }
+  if (interval_timer_ != nullptr) {
+    interval_timer_->enableTimer(interval);
+  }
+}
+
+void HealthCheckerImplBase::ActiveHealthCheckSession::onHostUpdated() {
+  parent_.runCallbacks(host_, HealthTransition::Changed);
+}
+
+HealthTransition HealthCheckerImplBase::ActiveHealthCheckSession::applySuccess(bool degraded) {
   // If we are healthy, reset the # of unhealthy to zero.
   num_unhealthy_ = 0;
 
@@ -332,9 +406,7 @@ void HealthCheckerImplBase::ActiveHealthCheckSession::handleSuccess(bool degrade
   parent_.stats_.success_.inc();
   first_check_ = false;
   parent_.runCallbacks(host_, changed_state);
-
-  timeout_timer_->disableTimer();
-  interval_timer_->enableTimer(parent_.interval(HealthState::Healthy, changed_state));
+  return changed_state;
 }
 
 namespace {
@@ -396,16 +468,51 @@ HealthTransition HealthCheckerImplBase::ActiveHealthCheckSession::setUnhealthy(
 void HealthCheckerImplBase::ActiveHealthCheckSession::handleFailure(
     envoy::data::core::v3::HealthCheckFailureType type, bool retriable) {
   HealthTransition changed_state = setUnhealthy(type, retriable);
-  // It's possible that the previous call caused this session to be deferred deleted.
+  const std::chrono::milliseconds interval =
+      publishSharedResult(SharedHealthCheckResult{false, false, type, retriable},
+                          parent_.interval(HealthState::Unhealthy, changed_state));
+
+  // It's possible that the previous calls caused this session to be deferred deleted.
   if (timeout_timer_ != nullptr) {
     timeout_timer_->disableTimer();
   }
 
   if (interval_timer_ != nullptr) {
-    interval_timer_->enableTimer(parent_.interval(HealthState::Unhealthy, changed_state));
+    interval_timer_->enableTimer(interval);
   }
 }
 
+std::chrono::milliseconds HealthCheckerImplBase::ActiveHealthCheckSession::publishSharedResult(
+    const SharedHealthCheckResult& result, std::chrono::milliseconds interval) {
+  if (shared_subscription_ == nullptr || !shared_subscription_->leader()) {
+    return interval;
+  }
+  // The shared session probes as often as the most demanding subscribed cluster would have.
+  const absl::optional<std::chrono::milliseconds> follower_interval =
+      shared_subscription_->publish(result);
+  return follower_interval.has_value() ? std::min(interval, *follower_interval) : interval;
+}
+
+void HealthCheckerImplBase::ActiveHealthCheckSession::onSharedLeadership() {
+  // Take over probing on this session's own schedule. Probing inline could start a connection
+  // while our own health checker is being torn down.
+  const HealthState state = host_->healthFlagGet(Host::HealthFlag::FAILED_ACTIVE_HC)
+                                ? HealthState::Unhealthy
+                                : HealthState::Healthy;
+  interval_timer_->enableTimer(parent_.interval(state, HealthTransition::Unchanged));
+}
+
+std::chrono::milliseconds HealthCheckerImplBase::ActiveHealthCheckSession::onSharedResult(
+    const SharedHealthCheckResult& result) {
+  // A replay of an earlier result may still be pending.
+  interval_timer_->disableTimer();
+  if (result.healthy_) {
+    return parent_.interval(HealthState::Healthy, applySuccess(result.degraded_));
+  }
+  return parent_.interval(HealthState::Unhealthy,
+                          setUnhealthy(result.failure_type_, result.retriable_));
+}
+
 HealthTransition
 HealthCheckerImplBase::ActiveHealthCheckSession::clearPendingFlag(HealthTransition changed_state) {
   if (host_->healthFlagGet(Host::HealthFlag::PENDING_ACTIVE_HC)) {
@@ -419,6 +526,13 @@ HealthCheckerImplBase::ActiveHealthCheckSession::clearPendingFlag(HealthTransiti
 }
 
 void HealthCheckerImplBase::ActiveHealthCheckSession::onIntervalBase() {
+  if (sharedFollower()) {
+    // A follower's interval timer only fires to replay the shared session's last result.
+    if (shared_subscription_->lastResult().has_value()) {
+      onSharedResult(shared_subscription_->lastResult().value());
+    }
+    return;
+  }
   onInterval();
   timeout_timer_->enableTimer(parent_.timeout_);
   parent_.stats_.attempt_.inc();
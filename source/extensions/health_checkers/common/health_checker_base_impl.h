@@ -7,6 +7,7 @@
 #include "envoy/data/core/v3/health_check_event.pb.h"
 #include "envoy/event/timer.h"
 #include "envoy/runtime/runtime.h"
+#include "envoy/server/health_checker_config.h"
 #include "envoy/stats/scope.h"
 #include "envoy/type/matcher/string.pb.h"
 #include "envoy/upstream/health_checker.h"
@@ -14,6 +15,7 @@
 #include "source/common/common/logger.h"
 #include "source/common/common/matchers.h"
 #include "source/common/network/transport_socket_options_impl.h"
+#include "source/extensions/health_checkers/common/shared_session_registry.h"
 
 namespace Envoy {
 namespace Upstream {
@@ -55,20 +57,31 @@ public:
     return transport_socket_match_metadata_;
   }
 
+  /**
+   * Subscribes the sessions of this health checker to shared sessions if the config sets
+   * share_across_clusters. Must be called before start().
+   */
+  void initSharedSessions(const envoy::config::core::v3::HealthCheck& config,
+                          Server::Configuration::HealthCheckerFactoryContext& context);
+
 protected:
-  class ActiveHealthCheckSession : public Event::DeferredDeletable {
+  class ActiveHealthCheckSession : public Event::DeferredDeletable,
+                                   public SharedHealthCheckSubscriber {
   public:
     ~ActiveHealthCheckSession() override;
     HealthTransition setUnhealthy(envoy::data::core::v3::HealthCheckFailureType type,
                                   bool retriable);
     void onDeferredDeleteBase();
-    void start() { onInitialInterval(); }
+    void start();
 
   protected:
     ActiveHealthCheckSession(HealthCheckerImplBase& parent, HostSharedPtr host);
 
     void handleSuccess(bool degraded = false);
     void handleFailure(envoy::data::core::v3::HealthCheckFailureType type, bool retriable = false);
+    // Reports the host as changed, without changing its health, so that the cluster rebuilds its
+    // host sets and load balancers see e.g. metadata written by the health checker.
+    void onHostUpdated();
 
     HostSharedPtr host_;
 
@@ -77,6 +90,14 @@ protected:
     // been health checked.
     // Returns the changed state to use following the flag update.
     HealthTransition clearPendingFlag(HealthTransition changed_state);
+    HealthTransition applySuccess(bool degraded);
+    // Fans a result out to the followers if this session leads a shared session. Returns the
+    // interval until the next probe.
+    std::chrono::milliseconds publishSharedResult(const SharedHealthCheckResult& result,
+                                                  std::chrono::milliseconds interval);
+    bool sharedFollower() const {
+      return shared_subscription_ != nullptr && !shared_subscription_->leader();
+    }
     virtual void onInterval() PURE;
     void onIntervalBase();
     virtual void onTimeout() PURE;
@@ -84,6 +105,10 @@ protected:
     virtual void onDeferredDelete() PURE;
     void onInitialInterval();
 
+    // SharedHealthCheckSubscriber
+    void onSharedLeadership() override;
+    std::chrono::milliseconds onSharedResult(const SharedHealthCheckResult& result) override;
+
     HealthCheckerImplBase& parent_;
     Event::TimerPtr interval_timer_;
     Event::TimerPtr timeout_timer_;
@@ -91,6 +116,7 @@ protected:
     uint32_t num_healthy_{};
     bool first_check_{true};
     TimeSource& time_source_;
+    SharedSessionRegistry::SubscriptionPtr shared_subscription_;
   };
 
   using ActiveHealthCheckSessionPtr = std::unique_ptr<ActiveHealthCheckSession>;
@@ -139,6 +165,8 @@ private:
                                                std::chrono::milliseconds interval_jitter) const;
   void onClusterMemberUpdate(const HostVector& hosts_added, const HostVector& hosts_removed);
   void runCallbacks(HostSharedPtr host, HealthTransition changed_state);
+  std::string sharedSessionKey(const Host& host) const;
+  std::string sharedSessionStatPrefix(const Host& host) const;
   void setUnhealthyCrossThread(const HostSharedPtr& host,
                                HealthCheckHostMonitor::UnhealthyType type);
   static std::shared_ptr<const Network::TransportSocketOptionsImpl>
@@ -160,6 +188,9 @@ private:
   const std::shared_ptr<const Network::TransportSocketOptionsImpl> transport_socket_options_;
   const MetadataConstSharedPtr transport_socket_match_metadata_;
   const Common::CallbackHandlePtr member_update_cb_;
+  SharedSessionRegistrySharedPtr shared_session_registry_;
+  // Identifies the health check configuration within shared session keys.
+  std::string shared_session_config_hash_;
 };
 
 } // namespace Upstream
@@ -0,0 +1,112 @@
+#include "source/extensions/health_checkers/common/shared_session_registry.h"
+
+#include <algorithm>
+
+#include "source/common/common/assert.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Upstream {
+
+namespace {
+
+SharedHealthCheckStats generateStats(Stats::Scope& scope) {
+  const std::string prefix("health_check.shared.");
+  return {ALL_SHARED_HEALTH_CHECK_STATS(POOL_COUNTER_PREFIX(scope, prefix),
+                                        POOL_GAUGE_PREFIX(scope, prefix))};
+}
+
+SharedHealthCheckSessionStats generateSessionStats(Stats::Scope& scope) {
+  return {ALL_SHARED_HEALTH_CHECK_SESSION_STATS(POOL_COUNTER(scope), POOL_GAUGE(scope))};
+}
+
+} // namespace
+
+SharedSessionRegistry::Entry::Entry(const std::string& key, Stats::ScopeSharedPtr&& scope)
+    : key_(key), scope_(std::move(scope)), stats_(generateSessionStats(*scope_)) {}
+
+SharedSessionRegistry::SharedSessionRegistry(Stats::Scope& scope)
+    : scope_(scope), stats_(generateStats(scope)) {}
+
+SharedSessionRegistry::Subscription::~Subscription() { registry_.unsubscribe(entry_, subscriber_); }
+
+absl::optional<std::chrono::milliseconds>
+SharedSessionRegistry::Subscription::publish(const SharedHealthCheckResult& result) {
+  ASSERT(leader());
+  // Nothing after this call may touch members, as the fan out may destroy this subscription.
+  return registry_.publish(entry_, result);
+}
+
+SharedSessionRegistry::SubscriptionPtr
+SharedSessionRegistry::subscribe(const std::string& key, absl::string_view stat_prefix,
+                                 SharedHealthCheckSubscriber& subscriber) {
+  EntrySharedPtr& entry = entries_[key];
+  if (entry == nullptr) {
+    entry = std::make_shared<Entry>(
+        key, scope_.createScope(absl::StrCat("health_check.shared.", stat_prefix, ".")));
+    stats_.sessions_.inc();
+  }
+
+  if (entry->leader_ == nullptr) {
+    entry->leader_ = &subscriber;
+  } else {
+    entry->followers_.push_back(&subscriber);
+    entry->follower_set_.insert(&subscriber);
+  }
+  stats_.subscribers_.inc();
+  entry->stats_.subscribers_.inc();
+  return SubscriptionPtr{new Subscription(*this, entry, subscriber)};
+}
+
+absl::optional<std::chrono::milliseconds>
+SharedSessionRegistry::publish(EntrySharedPtr entry, const SharedHealthCheckResult& result) {
+  entry->last_result_ = result;
+
+  // Followers run host status callbacks of their cluster, which may add or remove subscriptions
+  // of this entry. Iterate a snapshot and skip followers that have gone away in the meantime.
+  const std::vector<SharedHealthCheckSubscriber*> followers = entry->followers_;
+  absl::optional<std::chrono::milliseconds> interval;
+  for (SharedHealthCheckSubscriber* follower : followers) {
+    if (!entry->follower_set_.contains(follower)) {
+      continue;
+    }
+    const std::chrono::milliseconds follower_interval = follower->onSharedResult(result);
+    interval = interval.has_value() ? std::min(*interval, follower_interval) : follower_interval;
+    stats_.fanout_.inc();
+    entry->stats_.fanout_.inc();
+  }
+  return interval;
+}
+
+void SharedSessionRegistry::unsubscribe(const EntrySharedPtr& entry,
+                                        SharedHealthCheckSubscriber& subscriber) {
+  stats_.subscribers_.dec();
+  entry->stats_.subscribers_.dec();
+  if (entry->leader_ == &subscriber) {
+    entry->leader_ = nullptr;
+    if (!entry->followers_.empty()) {
+      SharedHealthCheckSubscriber* next = entry->followers_.front();
+      entry->followers_.erase(entry->followers_.begin());
+      entry->follower_set_.erase(next);
+      entry->leader_ = next;
+      stats_.leader_handoff_.inc();
+      entry->stats_.leader_handoff_.inc();
+      next->onSharedLeadership();
+    }
+  } else {
+    entry->follower_set_.erase(&subscriber);
+    auto it = std::find(entry->followers_.begin(), entry->followers_.end(), &subscriber);
+    ASSERT(it != entry->followers_.end());
+    entry->followers_.erase(it);
+  }
+
+  if (entry->leader_ == nullptr) {
+    ASSERT(entry->followers_.empty());
+    entries_.erase(entry->key_);
+    stats_.sessions_.dec();
+  }
+}
+
+} // namespace Upstream
+} // namespace Envoy
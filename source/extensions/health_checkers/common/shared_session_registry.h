@@ -0,0 +1,162 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/data/core/v3/health_check_event.pb.h"
+#include "envoy/singleton/instance.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * All shared health check session stats. @see stats_macros.h
+ */
+#define ALL_SHARED_HEALTH_CHECK_STATS(COUNTER, GAUGE)                                              \
+  COUNTER(fanout)                                                                                  \
+  COUNTER(leader_handoff)                                                                          \
+  GAUGE(sessions, NeverImport)                                                                     \
+  GAUGE(subscribers, NeverImport)
+
+/**
+ * Definition of all shared health check session stats. @see stats_macros.h
+ */
+struct SharedHealthCheckStats {
+  ALL_SHARED_HEALTH_CHECK_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * Stats of a single shared health check session. @see stats_macros.h
+ */
+#define ALL_SHARED_HEALTH_CHECK_SESSION_STATS(COUNTER, GAUGE)                                      \
+  COUNTER(fanout)                                                                                  \
+  COUNTER(leader_handoff)                                                                          \
+  GAUGE(subscribers, NeverImport)
+
+/**
+ * Definition of the stats of a single shared health check session. @see stats_macros.h
+ */
+struct SharedHealthCheckSessionStats {
+  ALL_SHARED_HEALTH_CHECK_SESSION_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * The outcome of one probe of a shared session.
+ */
+struct SharedHealthCheckResult {
+  bool healthy_{};
+  bool degraded_{};
+  envoy::data::core::v3::HealthCheckFailureType failure_type_{};
+  bool retriable_{};
+};
+
+/**
+ * A health check session subscribed to a shared session.
+ */
+class SharedHealthCheckSubscriber {
+public:
+  virtual ~SharedHealthCheckSubscriber() = default;
+
+  /**
+   * Called when the subscriber takes over probing because the previous leader went away.
+   */
+  virtual void onSharedLeadership() PURE;
+
+  /**
+   * Called on every follower with the result of each probe sent by the leader.
+   * @return the interval after which the follower would have probed its host again.
+   */
+  virtual std::chrono::milliseconds onSharedResult(const SharedHealthCheckResult& result) PURE;
+};
+
+/**
+ * Tracks the health check sessions of all clusters that opted into sharing, keyed by health check
+ * address and configuration. The first session subscribed to a key is the leader and is the only
+ * one that probes; its results are fanned out to the other (follower) sessions. Only accessed from
+ * the main thread.
+ */
+class SharedSessionRegistry : public Singleton::Instance {
+private:
+  struct Entry {
+    Entry(const std::string& key, Stats::ScopeSharedPtr&& scope);
+
+    const std::string key_;
+    // Scope of the stats of this shared session, removed with it.
+    const Stats::ScopeSharedPtr scope_;
+    SharedHealthCheckSessionStats stats_;
+    SharedHealthCheckSubscriber* leader_{};
+    // Followers in subscription order, which is also the order of leader promotion.
+    std::vector<SharedHealthCheckSubscriber*> followers_;
+    absl::flat_hash_set<SharedHealthCheckSubscriber*> follower_set_;
+    absl::optional<SharedHealthCheckResult> last_result_;
+  };
+  using EntrySharedPtr = std::shared_ptr<Entry>;
+
+public:
+  explicit SharedSessionRegistry(Stats::Scope& scope);
+
+  /**
+   * A session's membership in a shared session. Unsubscribes when destroyed.
+   */
+  class Subscription {
+  public:
+    ~Subscription();
+
+    bool leader() const { return entry_->leader_ == &subscriber_; }
+    const absl::optional<SharedHealthCheckResult>& lastResult() const {
+      return entry_->last_result_;
+    }
+
+    /**
+     * Fans a probe result out to all followers. Must only be called by the leader. The caller's
+     * session may be destroyed by host status callbacks run during the fan out.
+     * @return the shortest interval requested by any follower, if there are followers.
+     */
+    absl::optional<std::chrono::milliseconds> publish(const SharedHealthCheckResult& result);
+
+  private:
+    friend class SharedSessionRegistry;
+
+    Subscription(SharedSessionRegistry& registry, EntrySharedPtr entry,
+                 SharedHealthCheckSubscriber& subscriber)
+        : registry_(registry), entry_(std::move(entry)), subscriber_(subscriber) {}
+
+    SharedSessionRegistry& registry_;
+    const EntrySharedPtr entry_;
+    SharedHealthCheckSubscriber& subscriber_;
+  };
+  using SubscriptionPtr = std::unique_ptr<Subscription>;
+
+  /**
+   * Subscribes a session to the shared session of a key, creating it if needed.
+   * @param key identifies the shared session.
+   * @param stat_prefix the stats of a new shared session are rooted at
+   *        health_check.shared.<stat_prefix>.
+   */
+  SubscriptionPtr subscribe(const std::string& key, absl::string_view stat_prefix,
+                            SharedHealthCheckSubscriber& subscriber);
+
+  const SharedHealthCheckStats& stats() const { return stats_; }
+
+private:
+  absl::optional<std::chrono::milliseconds> publish(EntrySharedPtr entry,
+                                                    const SharedHealthCheckResult& result);
+  void unsubscribe(const EntrySharedPtr& entry, SharedHealthCheckSubscriber& subscriber);
+
+  Stats::Scope& scope_;
+  absl::flat_hash_map<std::string, EntrySharedPtr> entries_;
+  SharedHealthCheckStats stats_;
+};
+
+using SharedSessionRegistrySharedPtr = std::shared_ptr<SharedSessionRegistry>;
+
+} // namespace Upstream
+} // namespace Envoy
@@ -48,9 +48,11 @@ getMethod(const envoy::config::core::v3::RequestMethod config_method) {
 Upstream::HealthCheckerSharedPtr HttpHealthCheckerFactory::createCustomHealthChecker(
     const envoy::config::core::v3::HealthCheck& config,
     Server::Configuration::HealthCheckerFactoryContext& context) {
-  return std::make_shared<ProdHttpHealthCheckerImpl>(
+  auto health_checker = std::make_shared<ProdHttpHealthCheckerImpl>(
       context.cluster(), config, context.mainThreadDispatcher(), context.runtime(),
       context.api().randomGenerator(), context.eventLogger());
+  health_checker->initSharedSessions(config, context);
+  return health_checker;
 }
 
 REGISTER_FACTORY(HttpHealthCheckerFactory, Server::Configuration::CustomHealthCheckerFactory);
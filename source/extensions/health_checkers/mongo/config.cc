@@ -0,0 +1,33 @@
+#include "source/extensions/health_checkers/mongo/config.h"
+
+#include "envoy/config/core/v3/health_check.pb.h"
+#include "envoy/registry/registry.h"
+
+#include "source/common/config/utility.h"
+#include "source/extensions/health_checkers/mongo/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HealthCheckers {
+namespace MongoHealthChecker {
+
+Upstream::HealthCheckerSharedPtr MongoHealthCheckerFactory::createCustomHealthChecker(
+    const envoy::config::core::v3::HealthCheck& config,
+    Server::Configuration::HealthCheckerFactoryContext& context) {
+  auto health_checker = std::make_shared<MongoHealthChecker>(
+      context.cluster(), config,
+      getMongoHealthCheckConfig(config, context.messageValidationVisitor()),
+      context.mainThreadDispatcher(), context.runtime(), context.eventLogger(), context.api());
+  health_checker->initSharedSessions(config, context);
+  return health_checker;
+};
+
+/**
+ * Static registration for the mongo custom health checker. @see RegisterFactory.
+ */
+REGISTER_FACTORY(MongoHealthCheckerFactory, Server::Configuration::CustomHealthCheckerFactory);
+
+} // namespace MongoHealthChecker
+} // namespace HealthCheckers
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "envoy/config/core/v3/health_check.pb.h"
+#include "envoy/extensions/health_checkers/mongo/v3/mongo.pb.h"
+#include "envoy/extensions/health_checkers/mongo/v3/mongo.pb.validate.h"
+#include "envoy/server/health_checker_config.h"
+
+#include "source/extensions/health_checkers/mongo/mongo.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HealthCheckers {
+namespace MongoHealthChecker {
+
+/**
+ * Config registration for the mongo health checker.
+ */
+class MongoHealthCheckerFactory : public Server::Configuration::CustomHealthCheckerFactory {
+public:
+  Upstream::HealthCheckerSharedPtr
+  createCustomHealthChecker(const envoy::config::core::v3::HealthCheck& config,
+                            Server::Configuration::HealthCheckerFactoryContext& context) override;
+
+  std::string name() const override { return "envoy.health_checkers.mongo"; }
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return ProtobufTypes::MessagePtr{new envoy::extensions::health_checkers::mongo::v3::Mongo()};
+  }
+};
+
+DECLARE_FACTORY(MongoHealthCheckerFactory);
+
+} // namespace MongoHealthChecker
+} // namespace HealthCheckers
+} // namespace Extensions
+} // namespace Envoy
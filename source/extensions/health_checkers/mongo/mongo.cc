@@ -0,0 +1,320 @@
+#include "source/extensions/health_checkers/mongo/mongo.h"
+
+#include "envoy/config/core/v3/base.pb.h"
+#include "envoy/config/core/v3/health_check.pb.h"
+#include "envoy/data/core/v3/health_check_event.pb.h"
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/config/well_known_names.h"
+#include "source/common/protobuf/utility.h"
+#include "source/common/upstream/host_utility.h"
+#include "source/extensions/filters/network/mongo_proxy/bson_impl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HealthCheckers {
+namespace MongoHealthChecker {
+
+namespace Bson = NetworkFilters::MongoProxy::Bson;
+using NetworkFilters::MongoProxy::MsgMessageImpl;
+using NetworkFilters::MongoProxy::MsgMessagePtr;
+
+namespace {
+
+bool fieldIsTrue(const Bson::Document& document, const std::string& name) {
+  const Bson::Field* field = document.find(name);
+  if (field == nullptr) {
+    return false;
+  }
+  switch (field->type()) {
+  case Bson::Field::Type::Boolean:
+    return field->asBoolean();
+  case Bson::Field::Type::Double:
+    return field->asDouble() == 1.0;
+  case Bson::Field::Type::Int32:
+    return field->asInt32() == 1;
+  case Bson::Field::Type::Int64:
+    return field->asInt64() == 1;
+  default:
+    return false;
+  }
+}
+
+} // namespace
+
+MongoHealthChecker::MongoHealthChecker(
+    const Upstream::Cluster& cluster, const envoy::config::core::v3::HealthCheck& config,
+    const envoy::extensions::health_checkers::mongo::v3::Mongo& mongo_config,
+    Event::Dispatcher& dispatcher, Runtime::Loader& runtime,
+    Upstream::HealthCheckEventLoggerPtr&& event_logger, Api::Api& api)
+    : HealthCheckerImplBase(cluster, config, dispatcher, runtime, api.randomGenerator(),
+                            std::move(event_logger)),
+      expected_role_(mongo_config.expected_role()),
+      database_(mongo_config.database().empty() ? "admin" : mongo_config.database()),
+      max_staleness_(mongo_config.has_max_staleness()
+                         ? absl::make_optional(std::chrono::milliseconds(
+                               DurationUtil::durationToMilliseconds(mongo_config.max_staleness())))
+                         : absl::nullopt),
+      publish_host_metadata_(mongo_config.publish_host_metadata()),
+      time_source_(dispatcher.timeSource()),
+      mongo_stats_(generateMongoStats(cluster.info()->statsScope())) {}
+
+MongoHealthCheckerStats MongoHealthChecker::generateMongoStats(Stats::Scope& scope) {
+  std::string prefix("health_check.mongo.");
+  return {ALL_MONGO_HEALTH_CHECKER_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
+}
+
+HelloResult MongoHealthChecker::parseHelloReply(const Bson::Document& reply) {
+  HelloResult result;
+  result.ok_ = fieldIsTrue(reply, "ok");
+  // Servers older than 4.4.2 only report the legacy "ismaster" field.
+  if (fieldIsTrue(reply, "isWritablePrimary") || fieldIsTrue(reply, "ismaster")) {
+    result.role_ = Role::Primary;
+  } else if (fieldIsTrue(reply, "secondary")) {
+    result.role_ = Role::Secondary;
+  } else if (fieldIsTrue(reply, "arbiterOnly")) {
+    result.role_ = Role::Arbiter;
+  }
+
+  const Bson::Field* set_name = reply.find("setName", Bson::Field::Type::String);
+  if (set_name != nullptr) {
+    result.set_name_ = set_name->asString();
+  }
+
+  const Bson::Field* last_write = reply.find("lastWrite", Bson::Field::Type::Document);
+  if (last_write != nullptr) {
+    const Bson::Field* last_write_date =
+        last_write->asDocument().find("lastWriteDate", Bson::Field::Type::Datetime);
+    if (last_write_date != nullptr) {
+      result.last_write_date_ms_ = last_write_date->asDatetime();
+    }
+  }
+  return result;
+}
+
+absl::string_view MongoHealthChecker::roleName(Role role) {
+  switch (role) {
+  case Role::Primary:
+    return "primary";
+  case Role::Secondary:
+    return "secondary";
+  case Role::Arbiter:
+    return "arbiter";
+  case Role::Other:
+    return "other";
+  }
+  PANIC_DUE_TO_CORRUPT_ENUM;
+}
+
+MongoHealthChecker::MongoActiveHealthCheckSession::~MongoActiveHealthCheckSession() {
+  ASSERT(client_ == nullptr);
+}
+
+void MongoHealthChecker::MongoActiveHealthCheckSession::onDeferredDelete() {
+  if (client_) {
+    closeClient();
+  }
+}
+
+void MongoHealthChecker::MongoActiveHealthCheckSession::closeClient() {
+  expect_close_ = true;
+  outstanding_request_id_ = 0;
+  client_->close(Network::ConnectionCloseType::Abort);
+}
+
+void MongoHealthChecker::MongoActiveHealthCheckSession::onInterval() {
+  if (!client_) {
+    client_ =
+        host_
+            ->createHealthCheckConnection(parent_.dispatcher_, parent_.transportSocketOptions(),
+                                          parent_.transportSocketMatchMetadata().get())
+            .connection_;
+    session_callbacks_ = std::make_shared<MongoSessionCallbacks>(*this);
+    client_->addConnectionCallbacks(*session_callbacks_);
+    client_->addReadFilter(session_callbacks_);
+    decoder_ = std::make_unique<NetworkFilters::MongoProxy::DecoderImpl>(*this);
+
+    expect_close_ = false;
+    client_->connect();
+    client_->noDelay(true);
+  }
+
+  outstanding_request_id_ = next_request_id_++;
+  if (next_request_id_ <= 0) {
+    next_request_id_ = 1;
+  }
+
+  MsgMessageImpl hello(outstanding_request_id_, 0);
+  hello.body(Bson::DocumentImpl::create()->addInt32("hello", 1)->addString(
+      "$db", std::string(parent_.database_)));
+
+  Buffer::OwnedImpl data;
+  NetworkFilters::MongoProxy::EncoderImpl encoder(data);
+  encoder.encodeMsg(hello);
+  client_->write(data, false);
+}
+
+void MongoHealthChecker::MongoActiveHealthCheckSession::onTimeout() {
+  ENVOY_CONN_LOG(debug, "hc mongo connection timeout, health_flags={}, health_check_address={}",
+                 *client_, Upstream::HostUtility::healthFlagsToString(*host_),
+                 host_->healthCheckAddress()->asString());
+  closeClient();
+}
+
+void MongoHealthChecker::MongoActiveHealthCheckSession::onEvent(Network::ConnectionEvent event) {
+  if (event == Network::ConnectionEvent::RemoteClose ||
+      event == Network::ConnectionEvent::LocalClose) {
+    if (!expect_close_) {
+      ENVOY_CONN_LOG(debug, "hc mongo connection unexpected closed, health_check_address={}",
+                     *client_, host_->healthCheckAddress()->asString());
+      handleFailure(envoy::data::core::v3::NETWORK);
+    }
+    outstanding_request_id_ = 0;
+    parent_.dispatcher_.deferredDelete(std::move(client_));
+  }
+}
+
+void MongoHealthChecker::MongoActiveHealthCheckSession::onData(Buffer::Instance& data) {
+  TRY_NEEDS_AUDIT { decoder_->onData(data); }
+  END_TRY
+  catch (EnvoyException& e) {
+    ENVOY_CONN_LOG(debug, "hc mongo decoding error: {}", *client_, e.what());
+    parent_.mongo_stats_.decoding_error_.inc();
+    data.drain(data.length());
+    closeClient();
+    handleFailure(envoy::data::core::v3::ACTIVE);
+  }
+}
+
+void MongoHealthChecker::MongoActiveHealthCheckSession::decodeMsg(MsgMessagePtr&& message) {
+  if (outstanding_request_id_ == 0 || message->responseTo() != outstanding_request_id_) {
+    // A reply to a hello that already timed out; the next interval sends a new one.
+    ENVOY_LOG(debug, "hc mongo ignoring reply to request {}", message->responseTo());
+    return;
+  }
+  outstanding_request_id_ = 0;
+  onHelloResult(parseHelloReply(*message->body()));
+
+  if (client_ && !parent_.reuse_connection_) {
+    closeClient();
+  }
+}
+
+void MongoHealthChecker::MongoActiveHealthCheckSession::onHelloResult(const HelloResult& result) {
+  using MongoConfig = envoy::extensions::health_checkers::mongo::v3::Mongo;
+
+  absl::optional<std::chrono::milliseconds> staleness;
+  if (result.last_write_date_ms_.has_value()) {
+    const int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                               parent_.time_source_.systemTime().time_since_epoch())
+                               .count();
+    staleness =
+        std::chrono::milliseconds(std::max<int64_t>(0, now_ms - *result.last_write_date_ms_));
+  }
+
+  if (parent_.publish_host_metadata_) {
+    publishHostMetadata(result, staleness);
+  }
+
+  if (!result.ok_) {
+    parent_.mongo_stats_.command_failure_.inc();
+    handleFailure(envoy::data::core::v3::ACTIVE);
+    return;
+  }
+
+  bool role_matches = false;
+  switch (parent_.expected_role_) {
+  case MongoConfig::PRIMARY_OR_SECONDARY:
+    role_matches = result.role_ == Role::Primary || result.role_ == Role::Secondary;
+    break;
+  case MongoConfig::PRIMARY:
+    role_matches = result.role_ == Role::Primary;
+    break;
+  case MongoConfig::SECONDARY:
+    role_matches = result.role_ == Role::Secondary;
+    break;
+  default:
+    PANIC_DUE_TO_CORRUPT_ENUM;
+  }
+  if (!role_matches) {
+    ENVOY_LOG(debug, "hc mongo host {} reported role {}", host_->address()->asString(),
+              roleName(result.role_));
+    parent_.mongo_stats_.role_mismatch_.inc();
+    handleFailure(envoy::data::core::v3::ACTIVE);
+    return;
+  }
+
+  if (result.role_ == Role::Secondary && parent_.max_staleness_.has_value() &&
+      staleness.has_value() && *staleness > *parent_.max_staleness_) {
+    ENVOY_LOG(debug, "hc mongo secondary {} is {}ms stale", host_->address()->asString(),
+              staleness->count());
+    parent_.mongo_stats_.staleness_exceeded_.inc();
+    handleFailure(envoy::data::core::v3::ACTIVE);
+    return;
+  }
+
+  handleSuccess(false);
+}
+
+bool MongoHealthChecker::MongoActiveHealthCheckSession::shouldPublishHostMetadata(
+    const HelloResult& result, absl::optional<std::chrono::milliseconds> staleness) const {
+  if (published_metadata_ == nullptr || host_->metadata() != published_metadata_ ||
+      result.role_ != published_role_ || result.set_name_ != published_set_name_ ||
+      staleness.has_value() != published_staleness_.has_value()) {
+    return true;
+  }
+  if (!staleness.has_value()) {
+    return false;
+  }
+  const auto& max_staleness = parent_.max_staleness_;
+  if (max_staleness.has_value() &&
+      (*staleness > *max_staleness) != (*published_staleness_ > *max_staleness)) {
+    return true;
+  }
+  const std::chrono::milliseconds drift = *staleness > *published_staleness_
+                                              ? *staleness - *published_staleness_
+                                              : *published_staleness_ - *staleness;
+  return drift >= StalenessPublishGranularity;
+}
+
+void MongoHealthChecker::MongoActiveHealthCheckSession::publishHostMetadata(
+    const HelloResult& result, absl::optional<std::chrono::milliseconds> staleness) {
+  if (!shouldPublishHostMetadata(result, staleness)) {
+    return;
+  }
+
+  // The subset load balancer only rebuilds its subsets when the host sets are updated, so the
+  // host is reported as updated when a value it can select hosts on changes.
+  const bool update_host = published_metadata_ == nullptr || result.role_ != published_role_ ||
+                           result.set_name_ != published_set_name_;
+
+  Upstream::MetadataConstSharedPtr current = host_->metadata();
+  auto metadata = std::make_shared<envoy::config::core::v3::Metadata>();
+  if (current != nullptr) {
+    *metadata = *current;
+  }
+
+  auto& fields = *(*metadata->mutable_filter_metadata())[Config::MetadataFilters::get().ENVOY_LB]
+                      .mutable_fields();
+  fields["mongo_role"].set_string_value(std::string(roleName(result.role_)));
+  fields["mongo_set_name"].set_string_value(result.set_name_);
+  if (staleness.has_value()) {
+    fields["mongo_last_write_staleness_ms"].set_number_value(staleness->count());
+  } else {
+    fields.erase("mongo_last_write_staleness_ms");
+  }
+
+  host_->metadata(metadata);
+  published_metadata_ = std::move(metadata);
+  published_role_ = result.role_;
+  published_set_name_ = result.set_name_;
+  published_staleness_ = staleness;
+  if (update_host) {
+    onHostUpdated();
+  }
+}
+
+} // namespace MongoHealthChecker
+} // namespace HealthCheckers
+} // namespace Extensions
+} // namespace Envoy
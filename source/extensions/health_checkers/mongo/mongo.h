@@ -0,0 +1,183 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "envoy/api/api.h"
+#include "envoy/config/core/v3/health_check.pb.h"
+#include "envoy/data/core/v3/health_check_event.pb.h"
+#include "envoy/extensions/health_checkers/mongo/v3/mongo.pb.h"
+#include "envoy/network/filter.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "source/common/common/macros.h"
+#include "source/common/network/filter_impl.h"
+#include "source/extensions/filters/network/mongo_proxy/codec_impl.h"
+#include "source/extensions/health_checkers/common/health_checker_base_impl.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HealthCheckers {
+namespace MongoHealthChecker {
+
+/**
+ * All mongo health checker stats. @see stats_macros.h
+ */
+#define ALL_MONGO_HEALTH_CHECKER_STATS(COUNTER)                                                    \
+  COUNTER(command_failure)                                                                         \
+  COUNTER(decoding_error)                                                                          \
+  COUNTER(role_mismatch)                                                                           \
+  COUNTER(staleness_exceeded)
+
+/**
+ * Definition of all mongo health checker stats. @see stats_macros.h
+ */
+struct MongoHealthCheckerStats {
+  ALL_MONGO_HEALTH_CHECKER_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * The role a member reports in its hello reply.
+ */
+enum class Role { Primary, Secondary, Arbiter, Other };
+
+/**
+ * The subset of a hello reply the health checker acts on.
+ */
+struct HelloResult {
+  bool ok_{};
+  Role role_{Role::Other};
+  std::string set_name_;
+  // Milliseconds since the epoch, if the member reported lastWrite.lastWriteDate.
+  absl::optional<int64_t> last_write_date_ms_;
+};
+
+/**
+ * MongoDB health checker implementation. Sends an OP_MSG hello over a (by default) persistent
+ * connection and checks the reported replica set role and replication staleness.
+ */
+class MongoHealthChecker : public Upstream::HealthCheckerImplBase {
+public:
+  MongoHealthChecker(const Upstream::Cluster& cluster,
+                     const envoy::config::core::v3::HealthCheck& config,
+                     const envoy::extensions::health_checkers::mongo::v3::Mongo& mongo_config,
+                     Event::Dispatcher& dispatcher, Runtime::Loader& runtime,
+                     Upstream::HealthCheckEventLoggerPtr&& event_logger, Api::Api& api);
+
+  /**
+   * Extracts the fields the health checker uses from a hello reply body.
+   */
+  static HelloResult parseHelloReply(const NetworkFilters::MongoProxy::Bson::Document& reply);
+
+  /**
+   * @return the metadata value used for a role.
+   */
+  static absl::string_view roleName(Role role);
+
+
+  // The published staleness is only updated once it drifts by this much, so that the host metadata
+  // isn't rewritten on every check.
+  static constexpr std::chrono::milliseconds StalenessPublishGranularity{1000};
+
+protected:
+  envoy::data::core::v3::HealthCheckerType healthCheckerType() const override {
+    return envoy::data::core::v3::MONGO;
+  }
+
+private:
+  friend class MongoHealthCheckerTest;
+
+  struct MongoActiveHealthCheckSession;
+
+  struct MongoSessionCallbacks : public Network::ConnectionCallbacks,
+                                 public Network::ReadFilterBaseImpl {
+    MongoSessionCallbacks(MongoActiveHealthCheckSession& parent) : parent_(parent) {}
+
+    // Network::ConnectionCallbacks
+    void onEvent(Network::ConnectionEvent event) override { parent_.onEvent(event); }
+    void onAboveWriteBufferHighWatermark() override {}
+    void onBelowWriteBufferLowWatermark() override {}
+
+    // Network::ReadFilter
+    Network::FilterStatus onData(Buffer::Instance& data, bool) override {
+      parent_.onData(data);
+      return Network::FilterStatus::StopIteration;
+    }
+
+    MongoActiveHealthCheckSession& parent_;
+  };
+
+  struct MongoActiveHealthCheckSession : public ActiveHealthCheckSession,
+                                         public NetworkFilters::MongoProxy::DecoderCallbacks {
+    MongoActiveHealthCheckSession(MongoHealthChecker& parent, const Upstream::HostSharedPtr& host)
+        : ActiveHealthCheckSession(parent, host), parent_(parent) {}
+    ~MongoActiveHealthCheckSession() override;
+
+    void onData(Buffer::Instance& data);
+    void onEvent(Network::ConnectionEvent event);
+
+    // ActiveHealthCheckSession
+    void onInterval() override;
+    void onTimeout() override;
+    void onDeferredDelete() final;
+
+    // NetworkFilters::MongoProxy::DecoderCallbacks
+    void decodeGetMore(NetworkFilters::MongoProxy::GetMoreMessagePtr&&) override {}
+    void decodeInsert(NetworkFilters::MongoProxy::InsertMessagePtr&&) override {}
+    void decodeKillCursors(NetworkFilters::MongoProxy::KillCursorsMessagePtr&&) override {}
+    void decodeQuery(NetworkFilters::MongoProxy::QueryMessagePtr&&) override {}
+    void decodeReply(NetworkFilters::MongoProxy::ReplyMessagePtr&&) override {}
+    void decodeCommand(NetworkFilters::MongoProxy::CommandMessagePtr&&) override {}
+    void decodeCommandReply(NetworkFilters::MongoProxy::CommandReplyMessagePtr&&) override {}
+    void decodeMsg(NetworkFilters::MongoProxy::MsgMessagePtr&& message) override;
+
+    void closeClient();
+    void onHelloResult(const HelloResult& result);
+    void publishHostMetadata(const HelloResult& result,
+                             absl::optional<std::chrono::milliseconds> staleness);
+    bool shouldPublishHostMetadata(const HelloResult& result,
+                                   absl::optional<std::chrono::milliseconds> staleness) const;
+
+    MongoHealthChecker& parent_;
+    Network::ClientConnectionPtr client_;
+    std::shared_ptr<MongoSessionCallbacks> session_callbacks_;
+    std::unique_ptr<NetworkFilters::MongoProxy::DecoderImpl> decoder_;
+    int32_t next_request_id_{1};
+    // The request ID of the outstanding hello, or 0 if none is outstanding.
+    int32_t outstanding_request_id_{};
+    // The host metadata last published by this session, and the values it was published with. The
+    // metadata is published again if the host's metadata was replaced since.
+    Upstream::MetadataConstSharedPtr published_metadata_;
+    Role published_role_{Role::Other};
+    std::string published_set_name_;
+    absl::optional<std::chrono::milliseconds> published_staleness_;
+    // If true, stream close was initiated by us, not e.g. remote close or TCP reset.
+    // In this case healthcheck status already reported, only state cleanup required.
+    bool expect_close_{};
+  };
+
+  using MongoActiveHealthCheckSessionPtr = std::unique_ptr<MongoActiveHealthCheckSession>;
+
+  // HealthCheckerImplBase
+  ActiveHealthCheckSessionPtr makeSession(Upstream::HostSharedPtr host) override {
+    return std::make_unique<MongoActiveHealthCheckSession>(*this, host);
+  }
+
+  MongoHealthCheckerStats generateMongoStats(Stats::Scope& scope);
+
+  const envoy::extensions::health_checkers::mongo::v3::Mongo::Role expected_role_;
+  const std::string database_;
+  const absl::optional<std::chrono::milliseconds> max_staleness_;
+  const bool publish_host_metadata_;
+  TimeSource& time_source_;
+  MongoHealthCheckerStats mongo_stats_;
+};
+
+} // namespace MongoHealthChecker
+} // namespace HealthCheckers
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "envoy/config/core/v3/health_check.pb.h"
+#include "envoy/extensions/health_checkers/mongo/v3/mongo.pb.h"
+#include "envoy/extensions/health_checkers/mongo/v3/mongo.pb.validate.h"
+
+#include "source/common/config/utility.h"
+#include "source/common/protobuf/protobuf.h"
+#include "source/common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HealthCheckers {
+namespace MongoHealthChecker {
+
+namespace {
+
+static const envoy::extensions::health_checkers::mongo::v3::Mongo
+getMongoHealthCheckConfig(const envoy::config::core::v3::HealthCheck& health_check_config,
+                          ProtobufMessage::ValidationVisitor& validation_visitor) {
+  ProtobufTypes::MessagePtr config =
+      ProtobufTypes::MessagePtr{new envoy::extensions::health_checkers::mongo::v3::Mongo()};
+  Envoy::Config::Utility::translateOpaqueConfig(
+      health_check_config.custom_health_check().typed_config(), validation_visitor, *config);
+  return MessageUtil::downcastAndValidate<
+      const envoy::extensions::health_checkers::mongo::v3::Mongo&>(*config, validation_visitor);
+}
+
+} // namespace
+} // namespace MongoHealthChecker
+} // namespace HealthCheckers
+} // namespace Extensions
+} // namespace Envoy
@@ -102,12 +102,14 @@ private:
     bool enableCommandStats() const override { return false; }
     bool connectionRateLimitEnabled() const override { return false; }
     uint32_t connectionRateLimitPerSec() const override { return 0; }
+    bool enableReplyPassthrough() const override { return false; }
 
     // Extensions::NetworkFilters::Common::Redis::Client::ClientCallbacks
     void onResponse(NetworkFilters::Common::Redis::RespValuePtr&& value) override;
     void onFailure() override;
     void onRedirection(NetworkFilters::Common::Redis::RespValuePtr&&, const std::string&,
                        bool) override;
+    bool acceptsRawResponse() const override { return false; }
 
     // Network::ConnectionCallbacks
     void onEvent(Network::ConnectionEvent event) override;
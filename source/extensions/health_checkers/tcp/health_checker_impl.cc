@@ -35,9 +35,11 @@ namespace Upstream {
 Upstream::HealthCheckerSharedPtr TcpHealthCheckerFactory::createCustomHealthChecker(
     const envoy::config::core::v3::HealthCheck& config,
     Server::Configuration::HealthCheckerFactoryContext& context) {
-  return std::make_shared<TcpHealthCheckerImpl>(
+  auto health_checker = std::make_shared<TcpHealthCheckerImpl>(
       context.cluster(), config, context.mainThreadDispatcher(), context.runtime(),
       context.api().randomGenerator(), context.eventLogger());
+  health_checker->initSharedSessions(config, context);
+  return health_checker;
 }
 
 REGISTER_FACTORY(TcpHealthCheckerFactory, Server::Configuration::CustomHealthCheckerFactory);
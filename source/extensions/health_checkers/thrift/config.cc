@@ -15,11 +15,13 @@ namespace ThriftHealthChecker {
 Upstream::HealthCheckerSharedPtr ThriftHealthCheckerFactory::createCustomHealthChecker(
     const envoy::config::core::v3::HealthCheck& config,
     Server::Configuration::HealthCheckerFactoryContext& context) {
-  return std::make_shared<ThriftHealthChecker>(
+  auto health_checker = std::make_shared<ThriftHealthChecker>(
       context.cluster(), config,
       getThriftHealthCheckConfig(config, context.messageValidationVisitor()),
       context.mainThreadDispatcher(), context.runtime(), context.eventLogger(), context.api(),
       ClientFactoryImpl::instance_);
+  health_checker->initSharedSessions(config, context);
+  return health_checker;
 };
 
 /**
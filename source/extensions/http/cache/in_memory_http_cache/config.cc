@@ -0,0 +1,79 @@
+#include <memory>
+#include <string>
+
+#include "envoy/extensions/http/cache/in_memory_http_cache/v3/in_memory_http_cache.pb.h"
+#include "envoy/extensions/http/cache/in_memory_http_cache/v3/in_memory_http_cache.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "source/extensions/filters/http/cache/http_cache.h"
+#include "source/extensions/http/cache/in_memory_http_cache/in_memory_http_cache.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace InMemoryHttpCache {
+namespace {
+
+/**
+ * A singleton that looks up InMemoryHttpCaches by their config, so that cache filters with equal
+ * configs share the same cache.
+ */
+class CacheSingleton : public Envoy::Singleton::Instance {
+public:
+  std::shared_ptr<InMemoryHttpCache> get(const ConfigProto& config, Stats::Scope& stats_scope) {
+    std::shared_ptr<InMemoryHttpCache> cache;
+    absl::MutexLock lock(&mu_);
+    auto it = caches_.find(config);
+    if (it != caches_.end()) {
+      cache = it->second.lock();
+    }
+    if (!cache) {
+      cache = std::make_shared<InMemoryHttpCache>(config, stats_scope);
+      caches_[config] = cache;
+    }
+    return cache;
+  }
+
+private:
+  absl::Mutex mu_;
+  // We keep weak_ptr here so the caches, and the responses they hold, are released once no
+  // cache filter uses them.
+  absl::flat_hash_map<ConfigProto, std::weak_ptr<InMemoryHttpCache>, MessageUtil, MessageUtil>
+      caches_ ABSL_GUARDED_BY(mu_);
+};
+
+SINGLETON_MANAGER_REGISTRATION(in_memory_http_cache_singleton);
+
+class InMemoryHttpCacheFactory : public HttpCacheFactory {
+public:
+  // From UntypedFactory
+  std::string name() const override { return std::string{InMemoryHttpCache::name()}; }
+  // From TypedFactory
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return std::make_unique<ConfigProto>();
+  }
+  // From HttpCacheFactory
+  std::shared_ptr<HttpCache>
+  getCache(const envoy::extensions::filters::http::cache::v3::CacheConfig& filter_config,
+           Server::Configuration::FactoryContext& context) override {
+    const auto config = MessageUtil::anyConvertAndValidate<ConfigProto>(
+        filter_config.typed_config(), context.messageValidationVisitor());
+    // The singleton is pinned so that it keeps track of the caches while no filter is created.
+    std::shared_ptr<CacheSingleton> caches =
+        context.serverFactoryContext().singletonManager().getTyped<CacheSingleton>(
+            SINGLETON_MANAGER_REGISTERED_NAME(in_memory_http_cache_singleton),
+            [] { return std::make_shared<CacheSingleton>(); }, true);
+    // The cache may outlive the listener of the filter, so its stats are in the server scope.
+    return caches->get(config, context.serverFactoryContext().scope());
+  }
+};
+
+static Registry::RegisterFactory<InMemoryHttpCacheFactory, HttpCacheFactory> register_;
+
+} // namespace
+} // namespace InMemoryHttpCache
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
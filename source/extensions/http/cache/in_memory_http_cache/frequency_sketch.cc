@@ -0,0 +1,98 @@
+#include "source/extensions/http/cache/in_memory_http_cache/frequency_sketch.h"
+
+#include <algorithm>
+#include <array>
+
+#include "absl/numeric/bits.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace InMemoryHttpCache {
+namespace {
+
+constexpr std::array<uint64_t, 4> Seeds = {0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL,
+                                           0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL};
+// The lowest bit of each counter, and every bit but the highest one of each counter.
+constexpr uint64_t OneMask = 0x1111111111111111ULL;
+constexpr uint64_t ResetMask = 0x7777777777777777ULL;
+constexpr uint64_t MinCapacity = 16;
+constexpr uint64_t MaxCapacity = uint64_t(1) << 30;
+
+// Mixes the bits of a hash so that keys whose hashes differ in few bits use different counters.
+uint64_t spread(uint64_t hash) {
+  hash = (hash ^ (hash >> 33)) * 0xff51afd7ed558ccdULL;
+  hash = (hash ^ (hash >> 33)) * 0xc4ceb9fe1a85ec53ULL;
+  return hash ^ (hash >> 33);
+}
+
+} // namespace
+
+void FrequencySketch::ensureCapacity(uint64_t capacity) {
+  capacity = std::clamp(capacity, MinCapacity, MaxCapacity);
+  const uint64_t size = absl::bit_ceil(capacity);
+  if (table_.size() >= size) {
+    return;
+  }
+  table_.assign(size, 0);
+  sample_size_ = 10 * capacity;
+  additions_ = 0;
+}
+
+void FrequencySketch::increment(uint64_t hash) {
+  if (table_.empty()) {
+    ensureCapacity(MinCapacity);
+  }
+  hash = spread(hash);
+  // The 4 counters of a key are at the same offset in groups of 4 counters of their words.
+  const uint32_t start = (hash & 3) << 2;
+  bool added = false;
+  for (uint32_t depth = 0; depth < Seeds.size(); ++depth) {
+    uint64_t& word = table_[indexOf(hash, depth)];
+    const uint32_t shift = (start + depth) << 2;
+    if (((word >> shift) & 0xf) != 0xf) {
+      word += uint64_t(1) << shift;
+      added = true;
+    }
+  }
+  if (added && ++additions_ >= sample_size_) {
+    halve();
+  }
+}
+
+uint32_t FrequencySketch::frequency(uint64_t hash) const {
+  if (table_.empty()) {
+    return 0;
+  }
+  hash = spread(hash);
+  const uint32_t start = (hash & 3) << 2;
+  uint32_t frequency = 0xf;
+  for (uint32_t depth = 0; depth < Seeds.size(); ++depth) {
+    const uint32_t shift = (start + depth) << 2;
+    frequency = std::min(frequency, uint32_t((table_[indexOf(hash, depth)] >> shift) & 0xf));
+  }
+  return frequency;
+}
+
+uint64_t FrequencySketch::indexOf(uint64_t hash, uint32_t depth) const {
+  hash = (hash + Seeds[depth]) * Seeds[depth];
+  hash += hash >> 32;
+  return hash & (table_.size() - 1);
+}
+
+void FrequencySketch::halve() {
+  uint64_t odd_counters = 0;
+  for (uint64_t& word : table_) {
+    odd_counters += absl::popcount(word & OneMask);
+    word = (word >> 1) & ResetMask;
+  }
+  // Halving an odd counter drops half an access, and an access is recorded in 4 counters.
+  additions_ = (additions_ - (odd_counters >> 2)) >> 1;
+}
+
+} // namespace InMemoryHttpCache
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
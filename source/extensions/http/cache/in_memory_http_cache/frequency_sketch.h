@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace InMemoryHttpCache {
+
+/**
+ * A count-min sketch of 4 bit counters which estimates how often keys were accessed recently, for
+ * the TinyLFU admission policy. Once the number of recorded accesses reaches ten times the
+ * capacity, all counters are halved, so that old accesses count less than recent ones.
+ *
+ * Not thread safe.
+ */
+class FrequencySketch {
+public:
+  /**
+   * Sizes the sketch for the supplied number of entries. The sketch never shrinks, and the
+   * counters are cleared when it grows.
+   */
+  void ensureCapacity(uint64_t capacity);
+
+  /**
+   * Records an access to the key with the supplied hash.
+   */
+  void increment(uint64_t hash);
+
+  /**
+   * @return the estimated number of recent accesses to the key with the supplied hash, at most 15.
+   */
+  uint32_t frequency(uint64_t hash) const;
+
+private:
+  uint64_t indexOf(uint64_t hash, uint32_t depth) const;
+  void halve();
+
+  // Each word holds 16 counters. A key has a counter in 4 different words.
+  std::vector<uint64_t> table_;
+  uint64_t sample_size_{};
+  uint64_t additions_{};
+};
+
+} // namespace InMemoryHttpCache
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,511 @@
+#include "source/extensions/http/cache/in_memory_http_cache/in_memory_http_cache.h"
+
+#include <algorithm>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/http/header_map_impl.h"
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace InMemoryHttpCache {
+namespace {
+
+constexpr uint64_t DefaultMaxCacheSizeBytes = 256 * 1024 * 1024;
+constexpr uint32_t DefaultShardCount = 32;
+// An estimate of the memory used by a cached response besides its key, headers, body and
+// trailers.
+constexpr uint64_t EntryOverheadBytes = 512;
+
+// Returns a Key with the vary header added to custom_fields.
+// It is an error to call this with headers that don't include vary.
+// Returns nullopt if the vary headers in the response are not
+// compatible with the VaryAllowList in the LookupRequest.
+absl::optional<Key> variedRequestKey(const LookupRequest& request,
+                                     const Http::ResponseHeaderMap& response_headers) {
+  absl::btree_set<absl::string_view> vary_header_values =
+      VaryHeaderUtils::getVaryValues(response_headers);
+  ASSERT(!vary_header_values.empty());
+  const absl::optional<std::string> vary_identifier = VaryHeaderUtils::createVaryIdentifier(
+      request.varyAllowList(), vary_header_values, request.requestHeaders());
+  if (!vary_identifier.has_value()) {
+    return absl::nullopt;
+  }
+  Key varied_request_key = request.key();
+  varied_request_key.add_custom_fields(vary_identifier.value());
+  return varied_request_key;
+}
+
+uint64_t entrySize(const Key& key, const CachedResponse& response) {
+  return EntryOverheadBytes + key.ByteSizeLong() + response.response_headers_->byteSize() +
+         (response.body_ ? response.body_->length() : 0) +
+         (response.trailers_ ? response.trailers_->byteSize() : 0);
+}
+
+CachedResponse copyResponse(const CachedResponse& response) {
+  return CachedResponse{
+      Http::createHeaderMap<Http::ResponseHeaderMapImpl>(*response.response_headers_),
+      response.metadata_, response.body_,
+      response.trailers_ ? Http::createHeaderMap<Http::ResponseTrailerMapImpl>(*response.trailers_)
+                         : nullptr};
+}
+
+// A part of a cached body referenced by a response buffer, which keeps the body alive until the
+// buffer is drained.
+class BodyFragment : public Buffer::BufferFragment {
+public:
+  BodyFragment(std::shared_ptr<const Buffer::Instance> body, const void* data, size_t size)
+      : body_(std::move(body)), data_(data), size_(size) {}
+
+  // Buffer::BufferFragment
+  const void* data() const override { return data_; }
+  size_t size() const override { return size_; }
+  void done() override { delete this; }
+
+private:
+  const std::shared_ptr<const Buffer::Instance> body_;
+  const void* const data_;
+  const size_t size_;
+};
+
+class InMemoryLookupContext : public LookupContext {
+public:
+  InMemoryLookupContext(InMemoryHttpCache& cache, LookupRequest&& request)
+      : cache_(cache), request_(std::move(request)) {}
+
+  void getHeaders(LookupHeadersCallback&& cb) override {
+    absl::optional<CachedResponse> response = cache_.lookup(request_);
+    if (!response.has_value()) {
+      cb(LookupResult{});
+      return;
+    }
+    body_ = std::move(response->body_);
+    trailers_ = std::move(response->trailers_);
+    cb(request_.makeLookupResult(std::move(response->response_headers_),
+                                 std::move(response->metadata_), body_ ? body_->length() : 0,
+                                 trailers_ != nullptr));
+  }
+
+  void getBody(const AdjustedByteRange& range, LookupBodyCallback&& cb) override {
+    ASSERT(body_ != nullptr);
+    ASSERT(range.end() <= body_->length(), "Attempt to read past end of body.");
+    // The response references the slices of the cached body rather than copying them.
+    auto buffer = std::make_unique<Buffer::OwnedImpl>();
+    uint64_t offset = 0;
+    for (const Buffer::RawSlice& slice : body_->getRawSlices()) {
+      const uint64_t begin = std::max(offset, range.begin());
+      const uint64_t end = std::min(offset + slice.len_, range.end());
+      if (begin < end) {
+        auto* fragment = new BodyFragment(
+            body_, static_cast<const uint8_t*>(slice.mem_) + (begin - offset), end - begin);
+        buffer->addBufferFragment(*fragment);
+      }
+      offset += slice.len_;
+      if (offset >= range.end()) {
+        break;
+      }
+    }
+    cb(std::move(buffer));
+  }
+
+  void getTrailers(LookupTrailersCallback&& cb) override {
+    ASSERT(trailers_);
+    cb(std::move(trailers_));
+  }
+
+  const LookupRequest& request() const { return request_; }
+  void onDestroy() override {}
+
+private:
+  InMemoryHttpCache& cache_;
+  const LookupRequest request_;
+  std::shared_ptr<const Buffer::Instance> body_;
+  Http::ResponseTrailerMapPtr trailers_;
+};
+
+class InMemoryInsertContext : public InsertContext {
+public:
+  InMemoryInsertContext(LookupContext& lookup_context, InMemoryHttpCache& cache)
+      : key_(dynamic_cast<InMemoryLookupContext&>(lookup_context).request().key()),
+        request_headers_(
+            dynamic_cast<InMemoryLookupContext&>(lookup_context).request().requestHeaders()),
+        vary_allow_list_(
+            dynamic_cast<InMemoryLookupContext&>(lookup_context).request().varyAllowList()),
+        cache_(cache) {}
+
+  void insertHeaders(const Http::ResponseHeaderMap& response_headers,
+                     const ResponseMetadata& metadata, InsertCallback insert_success,
+                     bool end_stream) override {
+    ASSERT(!committed_);
+    response_headers_ = Http::createHeaderMap<Http::ResponseHeaderMapImpl>(response_headers);
+    metadata_ = metadata;
+    if (end_stream) {
+      insert_success(commit());
+    } else {
+      insert_success(true);
+    }
+  }
+
+  void insertBody(const Buffer::Instance& chunk, InsertCallback ready_for_next_chunk,
+                  bool end_stream) override {
+    ASSERT(!committed_);
+    ASSERT(ready_for_next_chunk || end_stream);
+
+    body_->add(chunk);
+    if (body_->length() > cache_.maxEntrySize()) {
+      // Stop buffering a response that is too large to be cached.
+      ready_for_next_chunk(false);
+    } else if (end_stream) {
+      ready_for_next_chunk(commit());
+    } else {
+      ready_for_next_chunk(true);
+    }
+  }
+
+  void insertTrailers(const Http::ResponseTrailerMap& trailers,
+                      InsertCallback insert_complete) override {
+    ASSERT(!committed_);
+    trailers_ = Http::createHeaderMap<Http::ResponseTrailerMapImpl>(trailers);
+    insert_complete(commit());
+  }
+
+  void onDestroy() override {}
+
+private:
+  bool commit() {
+    committed_ = true;
+    const bool has_vary = VaryHeaderUtils::hasVary(*response_headers_);
+    CachedResponse response{std::move(response_headers_), std::move(metadata_), std::move(body_),
+                            std::move(trailers_)};
+    if (has_vary) {
+      return cache_.varyInsert(key_, std::move(response), request_headers_, vary_allow_list_);
+    } else {
+      return cache_.insert(key_, std::move(response));
+    }
+  }
+
+  Key key_;
+  const Http::RequestHeaderMap& request_headers_;
+  const VaryAllowList& vary_allow_list_;
+  Http::ResponseHeaderMapPtr response_headers_;
+  ResponseMetadata metadata_;
+  InMemoryHttpCache& cache_;
+  std::shared_ptr<Buffer::OwnedImpl> body_ = std::make_shared<Buffer::OwnedImpl>();
+  bool committed_ = false;
+  Http::ResponseTrailerMapPtr trailers_;
+};
+
+} // namespace
+
+CacheShard::CacheShard(uint64_t capacity, InMemoryHttpCacheStats& stats)
+    : stats_(stats), window_capacity_(capacity / 100), main_capacity_(capacity - window_capacity_),
+      protected_capacity_(main_capacity_ / 5 * 4) {}
+
+CacheShard::~CacheShard() {
+  absl::MutexLock lock(&mutex_);
+  stats_.size_bytes_.sub(window_bytes_ + probation_bytes_ + protected_bytes_);
+  stats_.size_count_.sub(entries_.size());
+}
+
+absl::optional<CachedResponse> CacheShard::lookup(const Key& key, uint64_t hash) {
+  absl::MutexLock lock(&mutex_);
+  sketch_.increment(hash);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return absl::nullopt;
+  }
+  onAccess(it->second);
+  return copyResponse(it->second.response_);
+}
+
+bool CacheShard::insert(const Key& key, uint64_t hash, CachedResponse&& response, bool replace) {
+  const uint64_t size = entrySize(key, response);
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    if (!replace) {
+      return true;
+    }
+    if (size > main_capacity_) {
+      remove(it->second);
+      return false;
+    }
+    it->second.response_ = std::move(response);
+    resize(it->second, size);
+    stats_.insertions_.inc();
+    evict();
+    return true;
+  }
+  if (size > main_capacity_) {
+    return false;
+  }
+
+  it = entries_.try_emplace(key).first;
+  Entry& entry = it->second;
+  entry.key_ = &it->first;
+  entry.hash_ = hash;
+  entry.size_ = size;
+  entry.response_ = std::move(response);
+  entry.queue_ = Queue::Window;
+  window_.push_front(&entry);
+  entry.position_ = window_.begin();
+  window_bytes_ += size;
+  stats_.insertions_.inc();
+  stats_.size_bytes_.add(size);
+  stats_.size_count_.inc();
+  sketch_.ensureCapacity(entries_.size());
+  evict();
+  return true;
+}
+
+bool CacheShard::updateHeaders(const Key& key, const Http::ResponseHeaderMap& response_headers,
+                               const ResponseMetadata& metadata) {
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return false;
+  }
+  Entry& entry = it->second;
+  applyHeaderUpdate(response_headers, *entry.response_.response_headers_);
+  entry.response_.metadata_ = metadata;
+  resize(entry, entrySize(key, entry.response_));
+  evict();
+  return true;
+}
+
+std::list<CacheShard::Entry*>& CacheShard::queue(Queue queue) {
+  switch (queue) {
+  case Queue::Window:
+    return window_;
+  case Queue::Probation:
+    return probation_;
+  case Queue::Protected:
+    return protected_;
+  }
+  PANIC_DUE_TO_CORRUPT_ENUM;
+}
+
+uint64_t& CacheShard::queueBytes(Queue queue) {
+  switch (queue) {
+  case Queue::Window:
+    return window_bytes_;
+  case Queue::Probation:
+    return probation_bytes_;
+  case Queue::Protected:
+    return protected_bytes_;
+  }
+  PANIC_DUE_TO_CORRUPT_ENUM;
+}
+
+void CacheShard::moveTo(Entry& entry, Queue to) {
+  std::list<Entry*>& from = queue(entry.queue_);
+  queueBytes(entry.queue_) -= entry.size_;
+  queue(to).splice(queue(to).begin(), from, entry.position_);
+  queueBytes(to) += entry.size_;
+  entry.queue_ = to;
+}
+
+void CacheShard::resize(Entry& entry, uint64_t size) {
+  queueBytes(entry.queue_) -= entry.size_;
+  queueBytes(entry.queue_) += size;
+  stats_.size_bytes_.sub(entry.size_);
+  stats_.size_bytes_.add(size);
+  entry.size_ = size;
+}
+
+void CacheShard::remove(Entry& entry) {
+  queue(entry.queue_).erase(entry.position_);
+  queueBytes(entry.queue_) -= entry.size_;
+  stats_.size_bytes_.sub(entry.size_);
+  stats_.size_count_.dec();
+  entries_.erase(entries_.find(*entry.key_));
+}
+
+void CacheShard::onAccess(Entry& entry) {
+  switch (entry.queue_) {
+  case Queue::Window:
+  case Queue::Protected:
+    queue(entry.queue_).splice(queue(entry.queue_).begin(), queue(entry.queue_), entry.position_);
+    return;
+  case Queue::Probation:
+    // A response requested again while on probation is protected, which may demote the least
+    // recently used protected responses to probation.
+    moveTo(entry, Queue::Protected);
+    while (protected_bytes_ > protected_capacity_ && protected_.size() > 1) {
+      moveTo(*protected_.back(), Queue::Probation);
+    }
+    return;
+  }
+}
+
+void CacheShard::evict() {
+  // Responses that leave the window are candidates for the main space.
+  while (window_bytes_ > window_capacity_) {
+    Entry* candidate = window_.back();
+    moveTo(*candidate, Queue::Probation);
+    admit(candidate);
+  }
+  admit(nullptr);
+}
+
+void CacheShard::admit(Entry* candidate) {
+  while (probation_bytes_ + protected_bytes_ > main_capacity_) {
+    // The candidate is the most recently used response on probation, so it is only the victim if
+    // it is alone there.
+    Entry* victim = probation_.empty() ? nullptr : probation_.back();
+    if (victim == nullptr || (victim == candidate && !protected_.empty())) {
+      victim = protected_.back();
+    }
+    if (candidate != nullptr && victim != candidate &&
+        sketch_.frequency(candidate->hash_) <= sketch_.frequency(victim->hash_)) {
+      // The main space was within its capacity before the candidate entered it.
+      remove(*candidate);
+      stats_.admission_rejections_.inc();
+      return;
+    }
+    if (victim == candidate) {
+      candidate = nullptr;
+    }
+    remove(*victim);
+    stats_.evictions_.inc();
+  }
+}
+
+InMemoryHttpCache::InMemoryHttpCache(const ConfigProto& config, Stats::Scope& scope)
+    : config_(config), stats_(generateStats(config.stat_prefix(), scope)) {
+  const uint64_t max_cache_size =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_cache_size_bytes, DefaultMaxCacheSizeBytes);
+  const uint32_t shard_count =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, shard_count, DefaultShardCount);
+  shards_.reserve(shard_count);
+  for (uint32_t i = 0; i < shard_count; ++i) {
+    shards_.push_back(std::make_unique<CacheShard>(max_cache_size / shard_count, stats_));
+  }
+  max_entry_size_ = std::min(
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_individual_cache_entry_size_bytes, UINT64_MAX),
+      shards_.front()->maxEntrySize());
+  stats_.size_limit_bytes_.set(max_cache_size);
+}
+
+InMemoryHttpCacheStats InMemoryHttpCache::generateStats(const std::string& stat_prefix,
+                                                        Stats::Scope& scope) {
+  const std::string final_prefix =
+      stat_prefix.empty() ? "in_memory_http_cache." : absl::StrCat("in_memory_http_cache.",
+                                                                   stat_prefix, ".");
+  return {ALL_IN_MEMORY_HTTP_CACHE_STATS(POOL_COUNTER_PREFIX(scope, final_prefix),
+                                         POOL_GAUGE_PREFIX(scope, final_prefix))};
+}
+
+LookupContextPtr InMemoryHttpCache::makeLookupContext(LookupRequest&& request,
+                                                      Http::StreamDecoderFilterCallbacks&) {
+  return std::make_unique<InMemoryLookupContext>(*this, std::move(request));
+}
+
+InsertContextPtr InMemoryHttpCache::makeInsertContext(LookupContextPtr&& lookup_context,
+                                                      Http::StreamEncoderFilterCallbacks&) {
+  ASSERT(lookup_context != nullptr);
+  return std::make_unique<InMemoryInsertContext>(*lookup_context, *this);
+}
+
+void InMemoryHttpCache::updateHeaders(const LookupContext& lookup_context,
+                                      const Http::ResponseHeaderMap& response_headers,
+                                      const ResponseMetadata& metadata,
+                                      std::function<void(bool)> on_complete) {
+  const LookupRequest& request =
+      static_cast<const InMemoryLookupContext&>(lookup_context).request();
+  const uint64_t hash = stableHashKey(request.key());
+  absl::optional<CachedResponse> cached = shard(hash).lookup(request.key(), hash);
+  if (!cached.has_value()) {
+    on_complete(false);
+    return;
+  }
+  if (!VaryHeaderUtils::hasVary(*cached->response_headers_)) {
+    on_complete(shard(hash).updateHeaders(request.key(), response_headers, metadata));
+    return;
+  }
+  const absl::optional<Key> varied_key = variedRequestKey(request, *cached->response_headers_);
+  if (!varied_key.has_value()) {
+    on_complete(false);
+    return;
+  }
+  on_complete(shard(stableHashKey(varied_key.value()))
+                  .updateHeaders(varied_key.value(), response_headers, metadata));
+}
+
+CacheInfo InMemoryHttpCache::cacheInfo() const {
+  CacheInfo cache_info;
+  cache_info.name_ = name();
+  cache_info.supports_range_requests_ = true;
+  return cache_info;
+}
+
+absl::optional<CachedResponse> InMemoryHttpCache::lookup(const LookupRequest& request) {
+  const uint64_t hash = stableHashKey(request.key());
+  absl::optional<CachedResponse> response = shard(hash).lookup(request.key(), hash);
+  if (response.has_value() && VaryHeaderUtils::hasVary(*response->response_headers_)) {
+    // The response only flags that the responses to the request are varied.
+    const absl::optional<Key> varied_key = variedRequestKey(request, *response->response_headers_);
+    if (varied_key.has_value()) {
+      const uint64_t varied_hash = stableHashKey(varied_key.value());
+      response = shard(varied_hash).lookup(varied_key.value(), varied_hash);
+    } else {
+      response.reset();
+    }
+  }
+  if (response.has_value()) {
+    stats_.hits_.inc();
+  } else {
+    stats_.misses_.inc();
+  }
+  return response;
+}
+
+bool InMemoryHttpCache::insert(const Key& key, CachedResponse&& response) {
+  if (entrySize(key, response) > max_entry_size_) {
+    return false;
+  }
+  const uint64_t hash = stableHashKey(key);
+  return shard(hash).insert(key, hash, std::move(response), true);
+}
+
+bool InMemoryHttpCache::varyInsert(const Key& request_key, CachedResponse&& response,
+                                   const Http::RequestHeaderMap& request_headers,
+                                   const VaryAllowList& vary_allow_list) {
+  absl::btree_set<absl::string_view> vary_header_values =
+      VaryHeaderUtils::getVaryValues(*response.response_headers_);
+  ASSERT(!vary_header_values.empty());
+
+  // Insert the varied response.
+  Key varied_request_key = request_key;
+  const absl::optional<std::string> vary_identifier =
+      VaryHeaderUtils::createVaryIdentifier(vary_allow_list, vary_header_values, request_headers);
+  if (!vary_identifier.has_value()) {
+    // Skip the insert if we are unable to create a vary key.
+    return false;
+  }
+  varied_request_key.add_custom_fields(vary_identifier.value());
+  // The vary header values reference the headers of the response.
+  std::string vary_header = absl::StrJoin(vary_header_values, ",");
+  if (!insert(varied_request_key, std::move(response))) {
+    return false;
+  }
+
+  // Add a special entry to flag that this request generates varied responses, unless there is
+  // one already.
+  Http::ResponseHeaderMapPtr vary_only_map =
+      Http::createHeaderMap<Http::ResponseHeaderMapImpl>({});
+  vary_only_map->setCopy(Http::CustomHeaders::get().Vary, vary_header);
+  const uint64_t hash = stableHashKey(request_key);
+  return shard(hash).insert(request_key, hash, CachedResponse{std::move(vary_only_map), {}, {}, {}},
+                            false);
+}
+
+} // namespace InMemoryHttpCache
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
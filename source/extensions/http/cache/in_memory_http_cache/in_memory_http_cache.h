@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "envoy/extensions/http/cache/in_memory_http_cache/v3/in_memory_http_cache.pb.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "source/common/protobuf/utility.h"
+#include "source/extensions/filters/http/cache/http_cache.h"
+#include "source/extensions/http/cache/in_memory_http_cache/frequency_sketch.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace InMemoryHttpCache {
+
+using ConfigProto =
+    envoy::extensions::http::cache::in_memory_http_cache::v3::InMemoryHttpCacheConfig;
+
+/**
+ * All in-memory HTTP cache stats. @see stats_macros.h
+ */
+#define ALL_IN_MEMORY_HTTP_CACHE_STATS(COUNTER, GAUGE)                                             \
+  COUNTER(hits)                                                                                    \
+  COUNTER(misses)                                                                                  \
+  COUNTER(insertions)                                                                              \
+  COUNTER(evictions)                                                                               \
+  COUNTER(admission_rejections)                                                                    \
+  GAUGE(size_bytes, NeverImport)                                                                   \
+  GAUGE(size_count, NeverImport)                                                                   \
+  GAUGE(size_limit_bytes, NeverImport)
+
+/**
+ * Struct definition for all in-memory HTTP cache stats. @see stats_macros.h
+ */
+struct InMemoryHttpCacheStats {
+  ALL_IN_MEMORY_HTTP_CACHE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * A response as stored in the cache. The body is immutable once cached, and is shared with the
+ * lookups that serve it, so that it is never copied.
+ */
+struct CachedResponse {
+  Http::ResponseHeaderMapPtr response_headers_;
+  ResponseMetadata metadata_;
+  std::shared_ptr<const Buffer::Instance> body_;
+  Http::ResponseTrailerMapPtr trailers_;
+};
+
+/**
+ * A part of the cache with its own lock and byte budget. Responses are admitted and evicted with
+ * the W-TinyLFU policy: new responses enter a small LRU window, and a response that leaves the
+ * window only replaces the response that would be evicted from the main space if it was requested
+ * more often recently. The main space is a segmented LRU, in which responses requested again
+ * are protected from eviction by responses requested once.
+ */
+class CacheShard {
+public:
+  CacheShard(uint64_t capacity, InMemoryHttpCacheStats& stats);
+  ~CacheShard();
+
+  /**
+   * Records a request for the key, and returns a copy of the cached response if there is one.
+   */
+  absl::optional<CachedResponse> lookup(const Key& key, uint64_t hash);
+
+  /**
+   * Caches a response, replacing the cached response of the key if replace is true.
+   * @return false if the response is larger than the shard.
+   */
+  bool insert(const Key& key, uint64_t hash, CachedResponse&& response, bool replace);
+
+  /**
+   * Updates the headers and metadata of a cached response.
+   * @return false if no response is cached for the key.
+   */
+  bool updateHeaders(const Key& key, const Http::ResponseHeaderMap& response_headers,
+                     const ResponseMetadata& metadata);
+
+  /**
+   * @return the largest response the shard can hold, in bytes.
+   */
+  uint64_t maxEntrySize() const { return main_capacity_; }
+
+private:
+  enum class Queue { Window, Probation, Protected };
+
+  struct Entry {
+    const Key* key_;
+    uint64_t hash_;
+    uint64_t size_;
+    CachedResponse response_;
+    Queue queue_;
+    std::list<Entry*>::iterator position_;
+  };
+
+  std::list<Entry*>& queue(Queue queue) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  uint64_t& queueBytes(Queue queue) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void moveTo(Entry& entry, Queue queue) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void resize(Entry& entry, uint64_t size) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void remove(Entry& entry) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void onAccess(Entry& entry) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void evict() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void admit(Entry* candidate) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  InMemoryHttpCacheStats& stats_;
+  const uint64_t window_capacity_;
+  const uint64_t main_capacity_;
+  const uint64_t protected_capacity_;
+  absl::Mutex mutex_;
+  absl::node_hash_map<Key, Entry, MessageUtil, MessageUtil> entries_ ABSL_GUARDED_BY(mutex_);
+  // Most recently used first.
+  std::list<Entry*> window_ ABSL_GUARDED_BY(mutex_);
+  std::list<Entry*> probation_ ABSL_GUARDED_BY(mutex_);
+  std::list<Entry*> protected_ ABSL_GUARDED_BY(mutex_);
+  uint64_t window_bytes_ ABSL_GUARDED_BY(mutex_){};
+  uint64_t probation_bytes_ ABSL_GUARDED_BY(mutex_){};
+  uint64_t protected_bytes_ ABSL_GUARDED_BY(mutex_){};
+  FrequencySketch sketch_ ABSL_GUARDED_BY(mutex_);
+};
+
+/**
+ * A bounded cache of responses in memory, shared by all workers. Keys are spread over shards so
+ * that workers rarely wait for each other.
+ */
+class InMemoryHttpCache : public HttpCache {
+public:
+  InMemoryHttpCache(const ConfigProto& config, Stats::Scope& scope);
+
+  // HttpCache
+  LookupContextPtr makeLookupContext(LookupRequest&& request,
+                                     Http::StreamDecoderFilterCallbacks& callbacks) override;
+  InsertContextPtr makeInsertContext(LookupContextPtr&& lookup_context,
+                                     Http::StreamEncoderFilterCallbacks& callbacks) override;
+  void updateHeaders(const LookupContext& lookup_context,
+                     const Http::ResponseHeaderMap& response_headers,
+                     const ResponseMetadata& metadata,
+                     std::function<void(bool)> on_complete) override;
+  CacheInfo cacheInfo() const override;
+
+  absl::optional<CachedResponse> lookup(const LookupRequest& request);
+  bool insert(const Key& key, CachedResponse&& response);
+
+  // Inserts a response that has been varied on certain headers.
+  bool varyInsert(const Key& request_key, CachedResponse&& response,
+                  const Http::RequestHeaderMap& request_headers,
+                  const VaryAllowList& vary_allow_list);
+
+  // The largest response that can be cached, in bytes.
+  uint64_t maxEntrySize() const { return max_entry_size_; }
+
+  const ConfigProto& config() const { return config_; }
+  const InMemoryHttpCacheStats& stats() const { return stats_; }
+
+  static absl::string_view name() { return "envoy.extensions.http.cache.in_memory_http_cache"; }
+
+private:
+  static InMemoryHttpCacheStats generateStats(const std::string& stat_prefix, Stats::Scope& scope);
+  CacheShard& shard(uint64_t hash) { return *shards_[hash % shards_.size()]; }
+
+  const ConfigProto config_;
+  InMemoryHttpCacheStats stats_;
+  std::vector<std::unique_ptr<CacheShard>> shards_;
+  uint64_t max_entry_size_;
+};
+
+} // namespace InMemoryHttpCache
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -10,35 +10,7 @@ namespace Http {
 namespace HeaderValidators {
 namespace EnvoyDefault {
 
-// Header value character table.
-// From RFC 9110, https://www.rfc-editor.org/rfc/rfc9110.html#section-5.5:
-//
-// SPELLCHECKER(off)
-// header-field   = field-name ":" OWS field-value OWS
-// field-value    = *field-content
-// field-content  = field-vchar
-//                  [ 1*( SP / HTAB / field-vchar ) field-vchar ]
-// field-vchar    = VCHAR / obs-text
-// obs-text       = %x80-FF
-//
-// VCHAR          =  %x21-7E
-//                   ; visible (printing) characters
-// SPELLCHECKER(on)
-inline constexpr std::array<uint32_t, 8> kGenericHeaderValueCharTable = {
-    // control characters
-    0b00000000010000000000000000000000,
-    // !"#$%&'()*+,-./0123456789:;<=>?
-    0b11111111111111111111111111111111,
-    //@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\]^_
-    0b11111111111111111111111111111111,
-    //`abcdefghijklmnopqrstuvwxyz{|}~
-    0b11111111111111111111111111111110,
-    // extended ascii
-    0b11111111111111111111111111111111,
-    0b11111111111111111111111111111111,
-    0b11111111111111111111111111111111,
-    0b11111111111111111111111111111111,
-};
+using ::Envoy::Http::kGenericHeaderValueCharTable;
 
 // :method header character table.
 // From RFC 9110: https://www.rfc-editor.org/rfc/rfc9110.html#section-9.1
@@ -26,6 +26,8 @@ std::from_chars_result fromChars(const absl::string_view string_value, IntType&
 } // namespace
 
 using ::envoy::extensions::http::header_validators::envoy_default::v3::HeaderValidatorConfig;
+using ::Envoy::Http::CharLookupTable;
+using ::Envoy::Http::findFirstCharNotInTable;
 using ::Envoy::Http::HeaderString;
 using ::Envoy::Http::PathUtil;
 using ::Envoy::Http::Protocol;
@@ -99,10 +101,8 @@ HeaderValidator::validateMethodHeader(const HeaderString& value) {
   if (config_.restrict_http_methods()) {
     is_valid = kHttpMethodRegistry.contains(method);
   } else {
-    is_valid = !method.empty();
-    for (auto iter = method.begin(); iter != method.end() && is_valid; ++iter) {
-      is_valid &= testCharInTable(kMethodHeaderCharTable, *iter);
-    }
+    is_valid = !method.empty() &&
+               findFirstCharNotInTable<kMethodHeaderCharTable>(method) == absl::string_view::npos;
   }
 
   if (!is_valid) {
@@ -193,29 +193,20 @@ HeaderValidator::validateGenericHeaderName(const HeaderString& name) {
 
   const bool reject_header_names_with_underscores =
       config_.headers_with_underscores_action() == HeaderValidatorConfig::REJECT_REQUEST;
-  bool is_valid = true;
-  bool reject_due_to_underscore = false;
-  char c = '\0';
-
-  for (auto iter = key_string_view.begin();
-       iter != key_string_view.end() && is_valid && !reject_due_to_underscore; ++iter) {
-    c = *iter;
-    if (c != '_') {
-      is_valid &= testCharInTable(::Envoy::Http::kGenericHeaderNameCharTable, c);
-    } else {
-      reject_due_to_underscore = reject_header_names_with_underscores;
-    }
-  }
+  const size_t invalid_char =
+      findFirstCharNotInTable<::Envoy::Http::kGenericHeaderNameCharTable>(key_string_view);
 
-  if (!is_valid) {
+  // An underscore before the first invalid character takes precedence.
+  if (reject_header_names_with_underscores &&
+      key_string_view.substr(0, invalid_char).find('_') != absl::string_view::npos) {
+    stats_.incRequestsRejectedWithUnderscoresInHeaders();
     return {HeaderEntryValidationResult::Action::Reject,
-            UhvResponseCodeDetail::get().InvalidNameCharacters};
+            UhvResponseCodeDetail::get().InvalidUnderscore};
   }
 
-  if (reject_due_to_underscore) {
-    stats_.incRequestsRejectedWithUnderscoresInHeaders();
+  if (invalid_char != absl::string_view::npos) {
     return {HeaderEntryValidationResult::Action::Reject,
-            UhvResponseCodeDetail::get().InvalidUnderscore};
+            UhvResponseCodeDetail::get().InvalidNameCharacters};
   }
 
   return HeaderEntryValidationResult::success();
@@ -237,13 +228,8 @@ HeaderValidator::validateGenericHeaderValue(const HeaderString& value) {
   // VCHAR          =  %x21-7E
   //                   ; visible (printing) characters
   const auto& value_string_view = value.getStringView();
-  bool is_valid = true;
-
-  for (auto iter = value_string_view.begin(); iter != value_string_view.end() && is_valid; ++iter) {
-    is_valid &= testCharInTable(kGenericHeaderValueCharTable, *iter);
-  }
-
-  if (!is_valid) {
+  if (findFirstCharNotInTable<kGenericHeaderValueCharTable>(value_string_view) !=
+      absl::string_view::npos) {
     return {HeaderValueValidationResult::Action::Reject,
             UhvResponseCodeDetail::get().InvalidValueCharacters};
   }
@@ -390,13 +376,17 @@ HeaderValidator::validateHostHeaderRegName(absl::string_view host) {
 
 HeaderValidator::HeaderValueValidationResult
 HeaderValidator::validatePathHeaderCharacters(const HeaderString& value) {
-  return validatePathHeaderCharacterSet(value, kPathHeaderCharTable,
-                                        ::Envoy::Http::kUriQueryAndFragmentCharTable);
+  static_assert(!testCharInTable(kPathHeaderCharTable, '?') &&
+                !testCharInTable(kPathHeaderCharTable, '#'));
+  static constexpr CharLookupTable kPathChars{kPathHeaderCharTable};
+  static constexpr CharLookupTable kQueryAndFragmentChars{
+      ::Envoy::Http::kUriQueryAndFragmentCharTable};
+  return validatePathHeaderCharacterSet(value, kPathChars, kQueryAndFragmentChars);
 }
 
 HeaderValidator::HeaderValueValidationResult HeaderValidator::validatePathHeaderCharacterSet(
-    const HeaderString& value, const std::array<uint32_t, 8>& allowed_path_chracters,
-    const std::array<uint32_t, 8>& allowed_query_fragment_characters) {
+    const HeaderString& value, const CharLookupTable& allowed_path_chracters,
+    const CharLookupTable& allowed_query_fragment_characters) {
   static const HeaderValueValidationResult bad_path_result{
       HeaderValueValidationResult::Action::Reject, UhvResponseCodeDetail::get().InvalidUrl};
   const auto& path = value.getStringView();
@@ -404,49 +394,41 @@ HeaderValidator::HeaderValueValidationResult HeaderValidator::validatePathHeader
     return bad_path_result;
   }
 
-  auto iter = path.begin();
-  auto end = path.end();
-
-  // Validate the path component of the URI
-  for (; iter != end; ++iter) {
-    if (*iter == '?' || *iter == '#') {
-      // This is the start of the query or fragment portion of the path which uses a different
-      // character table.
-      break;
-    }
-
-    if (!testCharInTable(allowed_path_chracters, *iter)) {
-      return bad_path_result;
-    }
+  // Validate the path component of the URI. The path character tables do not include '?' and '#',
+  // so the first character that is not in the table is either invalid or the start of the query or
+  // fragment portion of the path, which uses a different character table.
+  size_t index = findFirstCharNotInTable(allowed_path_chracters, path);
+  if (index == absl::string_view::npos) {
+    return HeaderValueValidationResult::success();
+  }
+  if (path[index] != '?' && path[index] != '#') {
+    return bad_path_result;
   }
 
-  if (iter != end && *iter == '?') {
+  if (path[index] == '?') {
     // Validate the query component of the URI
-    ++iter;
-    for (; iter != end; ++iter) {
-      if (*iter == '#') {
-        break;
-      }
-
-      if (!testCharInTable(allowed_query_fragment_characters, *iter)) {
-        return bad_path_result;
-      }
+    const size_t query_start = index + 1;
+    index = path.find('#', query_start);
+    const absl::string_view query =
+        path.substr(query_start, index == absl::string_view::npos ? index : index - query_start);
+    if (findFirstCharNotInTable(allowed_query_fragment_characters, query) !=
+        absl::string_view::npos) {
+      return bad_path_result;
+    }
+    if (index == absl::string_view::npos) {
+      return HeaderValueValidationResult::success();
     }
   }
 
-  if (iter != end) {
-    ASSERT(*iter == '#');
-    if (!config_.strip_fragment_from_path()) {
-      return {HeaderValueValidationResult::Action::Reject,
-              UhvResponseCodeDetail::get().FragmentInUrlPath};
-    }
-    // Validate the fragment component of the URI
-    ++iter;
-    for (; iter != end; ++iter) {
-      if (!testCharInTable(allowed_query_fragment_characters, *iter)) {
-        return bad_path_result;
-      }
-    }
+  ASSERT(path[index] == '#');
+  if (!config_.strip_fragment_from_path()) {
+    return {HeaderValueValidationResult::Action::Reject,
+            UhvResponseCodeDetail::get().FragmentInUrlPath};
+  }
+  // Validate the fragment component of the URI
+  if (findFirstCharNotInTable(allowed_query_fragment_characters, path.substr(index + 1)) !=
+      absl::string_view::npos) {
+    return bad_path_result;
   }
 
   return HeaderValueValidationResult::success();
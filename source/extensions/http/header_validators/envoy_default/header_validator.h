@@ -5,6 +5,7 @@
 #include "envoy/extensions/http/header_validators/envoy_default/v3/header_validator.pb.h"
 #include "envoy/http/header_validator.h"
 
+#include "source/common/http/character_set_validation.h"
 #include "source/common/http/headers.h"
 #include "source/extensions/http/header_validators/envoy_default/config_overrides.h"
 #include "source/extensions/http/header_validators/envoy_default/path_normalizer.h"
@@ -168,10 +169,10 @@ protected:
   /*
    * Validate the :path pseudo header using specific allowed character set.
    */
-  HeaderValueValidationResult
-  validatePathHeaderCharacterSet(const ::Envoy::Http::HeaderString& value,
-                                 const std::array<uint32_t, 8>& allowed_path_chracters,
-                                 const std::array<uint32_t, 8>& allowed_query_fragment_characters);
+  HeaderValueValidationResult validatePathHeaderCharacterSet(
+      const ::Envoy::Http::HeaderString& value,
+      const ::Envoy::Http::CharLookupTable& allowed_path_chracters,
+      const ::Envoy::Http::CharLookupTable& allowed_query_fragment_characters);
 
   // URL-encode additional characters in URL path. This method is called iff
   // `envoy.uhv.allow_non_compliant_characters_in_path` is true.
@@ -17,9 +17,11 @@ namespace HeaderValidators {
 namespace EnvoyDefault {
 
 using ::envoy::extensions::http::header_validators::envoy_default::v3::HeaderValidatorConfig;
+using ::Envoy::Http::CharLookupTable;
 using ::Envoy::Http::HeaderString;
 using ::Envoy::Http::Protocol;
 using ::Envoy::Http::RequestHeaderMap;
+using ::Envoy::Http::testCharInTable;
 using ::Envoy::Http::UhvResponseCodeDetail;
 using ValidationResult = ::Envoy::Http::HeaderValidator::ValidationResult;
 using Http1ResponseCodeDetail = ::Envoy::Http::Http1ResponseCodeDetail;
@@ -97,9 +99,15 @@ Http1HeaderValidator::validatePathHeaderWithAdditionalCharacters(
       0b00000000000000000000000000000000,
       0b00000000000000000000000000000000,
   };
+  static_assert(!testCharInTable(kPathHeaderCharTableWithAdditionalCharacters, '?') &&
+                !testCharInTable(kPathHeaderCharTableWithAdditionalCharacters, '#'));
+  static constexpr CharLookupTable kPathCharsWithAdditionalCharacters{
+      kPathHeaderCharTableWithAdditionalCharacters};
+  static constexpr CharLookupTable kQueryAndFragmentCharsWithAdditionalCharacters{
+      kQueryAndFragmentCharTableWithAdditionalCharacters};
   return HeaderValidator::validatePathHeaderCharacterSet(
-      path_header_value, kPathHeaderCharTableWithAdditionalCharacters,
-      kQueryAndFragmentCharTableWithAdditionalCharacters);
+      path_header_value, kPathCharsWithAdditionalCharacters,
+      kQueryAndFragmentCharsWithAdditionalCharacters);
 }
 
 HeaderValidator::HeaderEntryValidationResult
@@ -21,6 +21,7 @@ namespace HeaderValidators {
 namespace EnvoyDefault {
 
 using ::envoy::extensions::http::header_validators::envoy_default::v3::HeaderValidatorConfig;
+using ::Envoy::Http::CharLookupTable;
 using ::Envoy::Http::HeaderString;
 using ::Envoy::Http::HeaderUtility;
 using ::Envoy::Http::Protocol;
@@ -152,9 +153,15 @@ Http2HeaderValidator::validatePathHeaderWithAdditionalCharactersHttp2(
       0b11111111111111111111111111111111,
       0b11111111111111111111111111111111,
   };
+  static_assert(!testCharInTable(kPathHeaderCharTableWithAdditionalCharacters, '?') &&
+                !testCharInTable(kPathHeaderCharTableWithAdditionalCharacters, '#'));
+  static constexpr CharLookupTable kPathCharsWithAdditionalCharacters{
+      kPathHeaderCharTableWithAdditionalCharacters};
+  static constexpr CharLookupTable kQueryAndFragmentCharsWithAdditionalCharacters{
+      kQueryAndFragmentCharTableWithAdditionalCharacters};
   return HeaderValidator::validatePathHeaderCharacterSet(
-      path_header_value, kPathHeaderCharTableWithAdditionalCharacters,
-      kQueryAndFragmentCharTableWithAdditionalCharacters);
+      path_header_value, kPathCharsWithAdditionalCharacters,
+      kQueryAndFragmentCharsWithAdditionalCharacters);
 }
 
 HeaderValidator::HeaderValueValidationResult
@@ -200,9 +207,15 @@ Http2HeaderValidator::validatePathHeaderWithAdditionalCharactersHttp3(
       0b00000000000000000000000000000000,
       0b00000000000000000000000000000000,
   };
+  static_assert(!testCharInTable(kPathHeaderCharTableWithAdditionalCharacters, '?') &&
+                !testCharInTable(kPathHeaderCharTableWithAdditionalCharacters, '#'));
+  static constexpr CharLookupTable kPathCharsWithAdditionalCharacters{
+      kPathHeaderCharTableWithAdditionalCharacters};
+  static constexpr CharLookupTable kQueryAndFragmentCharsWithAdditionalCharacters{
+      kQueryAndFragmentCharTableWithAdditionalCharacters};
   return HeaderValidator::validatePathHeaderCharacterSet(
-      path_header_value, kPathHeaderCharTableWithAdditionalCharacters,
-      kQueryAndFragmentCharTableWithAdditionalCharacters);
+      path_header_value, kPathCharsWithAdditionalCharacters,
+      kQueryAndFragmentCharsWithAdditionalCharacters);
 }
 
 ValidationResult
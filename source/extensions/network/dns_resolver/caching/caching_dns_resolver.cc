@@ -0,0 +1,322 @@
+#include "source/extensions/network/dns_resolver/caching/caching_dns_resolver.h"
+
+#include <algorithm>
+
+#include "envoy/common/exception.h"
+#include "envoy/network/dns_resolver.h"
+
+#include "source/common/protobuf/message_validator_impl.h"
+#include "source/common/protobuf/utility.h"
+#include "source/common/stats/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Network {
+
+namespace {
+// A popular name is refreshed in the background when it is looked up during the last
+// 1 / PREFETCH_WINDOW_DIVISOR of its TTL.
+constexpr int64_t PREFETCH_WINDOW_DIVISOR = 10;
+} // namespace
+
+DnsAnswerCache::NameStats::NameStats(DnsAnswerCache& parent, const std::string& dns_name)
+    : parent_(parent), dns_name_(dns_name),
+      // Dots would split the name over several levels of the stats tree.
+      scope_(parent.scope_->createScope(absl::StrCat(
+          "names.", Stats::Utility::sanitizeStatsName(absl::StrReplaceAll(dns_name, {{".", "_"}})),
+          "."))),
+      stats_{ALL_CACHING_DNS_RESOLVER_NAME_STATS(POOL_COUNTER(*scope_))} {}
+
+DnsAnswerCache::NameStats::~NameStats() { parent_.name_stats_.erase(dns_name_); }
+
+DnsAnswerCache::DnsAnswerCache(
+    const envoy::extensions::network::dns_resolver::caching::v3::CachingDnsResolverConfig& config,
+    Event::Dispatcher& dispatcher, Api::Api& api)
+    : time_source_(dispatcher.timeSource()),
+      scope_(api.rootScope().createScope(absl::StrCat("dns.cache.", config.stat_prefix(), "."))),
+      stats_(generateStats(*scope_)),
+      max_entries_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entries, 1024)),
+      min_ttl_(PROTOBUF_GET_SECONDS_OR_DEFAULT(config, min_ttl, 0)),
+      max_ttl_(PROTOBUF_GET_SECONDS_OR_DEFAULT(config, max_ttl, 300)),
+      negative_ttl_(PROTOBUF_GET_SECONDS_OR_DEFAULT(config, negative_ttl, 5)),
+      prefetch_min_hits_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, prefetch_min_hits, 2)) {
+  if (min_ttl_ > max_ttl_) {
+    throwEnvoyExceptionOrPanic(
+        fmt::format("caching DNS resolver: min_ttl ({}s) is larger than max_ttl ({}s)",
+                    min_ttl_.count(), max_ttl_.count()));
+  }
+  Network::DnsResolverFactory& factory =
+      Network::DnsResolverFactory::createFactory(config.typed_dns_resolver_config());
+  resolver_ = factory.createDnsResolver(dispatcher, api, config.typed_dns_resolver_config());
+}
+
+DnsAnswerCache::~DnsAnswerCache() {
+  for (auto& resolution : resolutions_) {
+    if (resolution.second->active_query_ != nullptr) {
+      resolution.second->active_query_->cancel(ActiveDnsQuery::CancelReason::QueryAbandoned);
+    }
+  }
+  stats_.pending_resolutions_.sub(resolutions_.size());
+  stats_.entries_.sub(entries_.size());
+}
+
+CachingDnsResolverStats DnsAnswerCache::generateStats(Stats::Scope& scope) {
+  return {ALL_CACHING_DNS_RESOLVER_STATS(POOL_COUNTER(scope), POOL_GAUGE(scope))};
+}
+
+DnsAnswerCache::NameStatsSharedPtr DnsAnswerCache::nameStats(const std::string& dns_name) {
+  auto it = name_stats_.find(dns_name);
+  if (it != name_stats_.end()) {
+    NameStatsSharedPtr name_stats = it->second.lock();
+    ASSERT(name_stats != nullptr);
+    return name_stats;
+  }
+  auto name_stats = std::make_shared<NameStats>(*this, dns_name);
+  name_stats_.emplace(dns_name, name_stats);
+  return name_stats;
+}
+
+ActiveDnsQuery* DnsAnswerCache::resolve(const std::string& dns_name,
+                                        DnsLookupFamily dns_lookup_family,
+                                        DnsResolver::ResolveCb callback,
+                                        const CachingDnsResolver& owner) {
+  // The callbacks may destroy the last resolver sharing this cache.
+  DnsAnswerCacheSharedPtr self = shared_from_this();
+  const Key key{dns_name, dns_lookup_family};
+
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    Entry& entry = it->second;
+    const MonotonicTime now = time_source_.monotonicTime();
+    if (now < entry.expires_at_) {
+      lru_.splice(lru_.begin(), lru_, entry.lru_position_);
+      entry.hits_++;
+      stats_.hits_.inc();
+      entry.name_stats_->stats_.hits_.inc();
+      const DnsResolver::ResolutionStatus status = entry.status_;
+      if (status == DnsResolver::ResolutionStatus::Failure) {
+        stats_.negative_hits_.inc();
+      }
+      std::list<DnsResponse> responses = withRemainingTtl(
+          entry.responses_,
+          std::chrono::ceil<std::chrono::seconds>(entry.expires_at_ - now));
+      ENVOY_LOG(debug, "cache hit for [{}]", dns_name);
+      // The prefetch may replace the entry if the wrapped resolver answers inline.
+      maybePrefetch(key, entry, now);
+      callback(status, std::move(responses));
+      return nullptr;
+    }
+    erase(it);
+  }
+
+  stats_.misses_.inc();
+  auto resolution_it = resolutions_.find(key);
+  if (resolution_it != resolutions_.end()) {
+    ENVOY_LOG(debug, "coalescing query for [{}]", dns_name);
+    stats_.coalesced_.inc();
+    Resolution& resolution = *resolution_it->second;
+    resolution.name_stats_->stats_.misses_.inc();
+    resolution.queries_.push_back(std::make_unique<PendingQuery>(std::move(callback), owner));
+    return resolution.queries_.back().get();
+  }
+
+  ENVOY_LOG(debug, "cache miss for [{}]", dns_name);
+  Resolution& resolution = createResolution(key);
+  resolution.name_stats_->stats_.misses_.inc();
+  resolution.queries_.push_back(std::make_unique<PendingQuery>(std::move(callback), owner));
+  PendingQuery* query = resolution.queries_.back().get();
+  return startResolution(key) ? query : nullptr;
+}
+
+void DnsAnswerCache::cancelQueries(const CachingDnsResolver& owner) {
+  for (auto& resolution : resolutions_) {
+    for (auto& query : resolution.second->queries_) {
+      if (&query->owner_ == &owner) {
+        query->cancelled_ = true;
+      }
+    }
+  }
+}
+
+void DnsAnswerCache::resetNetworking() {
+  while (!entries_.empty()) {
+    erase(entries_.begin());
+  }
+  resolver_->resetNetworking();
+}
+
+DnsAnswerCache::Resolution& DnsAnswerCache::createResolution(const Key& key) {
+  ASSERT(!resolutions_.contains(key));
+  stats_.pending_resolutions_.inc();
+  auto resolution = std::make_unique<Resolution>(next_resolution_id_++, nameStats(key.first));
+  Resolution& ref = *resolution;
+  resolutions_.emplace(key, std::move(resolution));
+  return ref;
+}
+
+bool DnsAnswerCache::startResolution(const Key& key) {
+  const uint64_t id = resolutions_.at(key)->id_;
+  ActiveDnsQuery* active_query = resolver_->resolve(
+      key.first, key.second,
+      [this, key, id](DnsResolver::ResolutionStatus status, std::list<DnsResponse>&& responses) {
+        onResolution(key, id, status, std::move(responses));
+      });
+  // The wrapped resolver may have answered inline, in which case the resolution is gone or was
+  // replaced by one started from a callback.
+  auto it = resolutions_.find(key);
+  if (it == resolutions_.end() || it->second->id_ != id) {
+    return false;
+  }
+  ASSERT(active_query != nullptr);
+  it->second->active_query_ = active_query;
+  return true;
+}
+
+void DnsAnswerCache::onResolution(const Key& key, uint64_t id,
+                                  DnsResolver::ResolutionStatus status,
+                                  std::list<DnsResponse>&& responses) {
+  DnsAnswerCacheSharedPtr self = shared_from_this();
+  auto it = resolutions_.find(key);
+  ASSERT(it != resolutions_.end() && it->second->id_ == id);
+  ResolutionPtr resolution = std::move(it->second);
+  resolutions_.erase(it);
+  stats_.pending_resolutions_.dec();
+
+  ENVOY_LOG(debug, "resolution for [{}] completed with status {}", key.first,
+            static_cast<int>(status));
+  insert(key, status, responses, resolution->name_stats_);
+
+  for (auto& query : resolution->queries_) {
+    if (!query->cancelled_) {
+      query->callback_(status, std::list<DnsResponse>(responses));
+    }
+  }
+}
+
+void DnsAnswerCache::maybePrefetch(const Key& key, Entry& entry, MonotonicTime now) {
+  if (prefetch_min_hits_ == 0 || entry.hits_ < prefetch_min_hits_ ||
+      resolutions_.contains(key)) {
+    return;
+  }
+  const auto window =
+      std::chrono::duration_cast<MonotonicTime::duration>(entry.ttl_) / PREFETCH_WINDOW_DIVISOR;
+  if (entry.expires_at_ - now > window) {
+    return;
+  }
+  ENVOY_LOG(debug, "prefetching [{}]", key.first);
+  stats_.prefetches_.inc();
+  entry.name_stats_->stats_.prefetches_.inc();
+  createResolution(key);
+  startResolution(key);
+}
+
+void DnsAnswerCache::insert(const Key& key, DnsResolver::ResolutionStatus status,
+                            const std::list<DnsResponse>& responses,
+                            NameStatsSharedPtr name_stats) {
+  auto existing = entries_.find(key);
+  if (existing != entries_.end()) {
+    erase(existing);
+  }
+  const std::chrono::seconds ttl = cacheTtl(status, responses);
+  if (ttl.count() == 0) {
+    return;
+  }
+  while (entries_.size() >= max_entries_) {
+    stats_.evictions_.inc();
+    erase(entries_.find(lru_.back()));
+  }
+
+  lru_.push_front(key);
+  Entry& entry = entries_[key];
+  entry.status_ = status;
+  entry.responses_ = responses;
+  entry.expires_at_ = time_source_.monotonicTime() + ttl;
+  entry.ttl_ = ttl;
+  entry.lru_position_ = lru_.begin();
+  entry.name_stats_ = std::move(name_stats);
+  stats_.entries_.inc();
+}
+
+void DnsAnswerCache::erase(absl::flat_hash_map<Key, Entry>::iterator it) {
+  ASSERT(it != entries_.end());
+  lru_.erase(it->second.lru_position_);
+  entries_.erase(it);
+  stats_.entries_.dec();
+}
+
+std::chrono::seconds DnsAnswerCache::cacheTtl(DnsResolver::ResolutionStatus status,
+                                              const std::list<DnsResponse>& responses) const {
+  if (status == DnsResolver::ResolutionStatus::Failure || responses.empty()) {
+    return negative_ttl_;
+  }
+  std::chrono::seconds ttl = max_ttl_;
+  for (const auto& response : responses) {
+    ttl = std::min(ttl, response.addrInfo().ttl_);
+  }
+  return std::max(ttl, min_ttl_);
+}
+
+std::list<DnsResponse> DnsAnswerCache::withRemainingTtl(const std::list<DnsResponse>& responses,
+                                                        std::chrono::seconds ttl) {
+  std::list<DnsResponse> result;
+  for (const auto& response : responses) {
+    result.emplace_back(response.addrInfo().address_, ttl);
+  }
+  return result;
+}
+
+// Caching DNS resolver factory. The caches are shared by the resolvers created with the same
+// configuration on the same dispatcher.
+class CachingDnsResolverFactory : public DnsResolverFactory,
+                                  public Logger::Loggable<Logger::Id::dns> {
+public:
+  std::string name() const override { return {"envoy.network.dns_resolver.caching"}; }
+
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return ProtobufTypes::MessagePtr{
+        new envoy::extensions::network::dns_resolver::caching::v3::CachingDnsResolverConfig()};
+  }
+
+  DnsResolverSharedPtr
+  createDnsResolver(Event::Dispatcher& dispatcher, Api::Api& api,
+                    const envoy::config::core::v3::TypedExtensionConfig& typed_dns_resolver_config)
+      const override {
+    envoy::extensions::network::dns_resolver::caching::v3::CachingDnsResolverConfig config;
+    MessageUtil::unpackTo(typed_dns_resolver_config.typed_config(), config);
+    MessageUtil::validate(config, ProtobufMessage::getStrictValidationVisitor());
+
+    const CacheKey key{&dispatcher, MessageUtil::hash(config)};
+    DnsAnswerCacheSharedPtr cache;
+    {
+      absl::MutexLock lock(&mutex_);
+      auto it = caches_.find(key);
+      if (it != caches_.end()) {
+        cache = it->second.lock();
+      }
+    }
+    if (cache == nullptr) {
+      // Created outside of the lock as the wrapped resolver may be a caching resolver too.
+      cache = std::make_shared<DnsAnswerCache>(config, dispatcher, api);
+      absl::MutexLock lock(&mutex_);
+      absl::erase_if(caches_, [](const auto& entry) { return entry.second.expired(); });
+      caches_[key] = cache;
+    }
+    return std::make_shared<CachingDnsResolver>(std::move(cache));
+  }
+
+private:
+  using CacheKey = std::pair<const Event::Dispatcher*, std::size_t>;
+
+  mutable absl::Mutex mutex_;
+  mutable absl::flat_hash_map<CacheKey, std::weak_ptr<DnsAnswerCache>>
+      caches_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Register the CachingDnsResolverFactory
+REGISTER_FACTORY(CachingDnsResolverFactory, DnsResolverFactory);
+
+} // namespace Network
+} // namespace Envoy
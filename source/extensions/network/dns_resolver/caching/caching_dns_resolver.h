@@ -0,0 +1,206 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "envoy/api/api.h"
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/extensions/network/dns_resolver/caching/v3/caching_dns_resolver.pb.h"
+#include "envoy/network/dns.h"
+#include "envoy/registry/registry.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "source/common/common/logger.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * All caching DNS resolver stats. @see stats_macros.h
+ */
+#define ALL_CACHING_DNS_RESOLVER_STATS(COUNTER, GAUGE)                                             \
+  COUNTER(hits)                                                                                    \
+  COUNTER(negative_hits)                                                                           \
+  COUNTER(misses)                                                                                  \
+  COUNTER(coalesced)                                                                               \
+  COUNTER(prefetches)                                                                              \
+  COUNTER(evictions)                                                                               \
+  GAUGE(entries, NeverImport)                                                                      \
+  GAUGE(pending_resolutions, NeverImport)
+
+/**
+ * Struct definition for all caching DNS resolver stats. @see stats_macros.h
+ */
+struct CachingDnsResolverStats {
+  ALL_CACHING_DNS_RESOLVER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * Stats kept for every name in the cache. @see stats_macros.h
+ */
+#define ALL_CACHING_DNS_RESOLVER_NAME_STATS(COUNTER)                                               \
+  COUNTER(hits)                                                                                    \
+  COUNTER(misses)                                                                                  \
+  COUNTER(prefetches)
+
+/**
+ * Struct definition for the stats of a name. @see stats_macros.h
+ */
+struct CachingDnsResolverNameStats {
+  ALL_CACHING_DNS_RESOLVER_NAME_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+class CachingDnsResolver;
+
+/**
+ * A TTL-respecting cache of the answers of a wrapped resolver. It is shared by all the caching
+ * resolvers created with the same configuration on the same dispatcher, so all calls and callbacks
+ * happen on the thread that owns that dispatcher.
+ */
+class DnsAnswerCache : public std::enable_shared_from_this<DnsAnswerCache>,
+                       protected Logger::Loggable<Logger::Id::dns> {
+public:
+  DnsAnswerCache(
+      const envoy::extensions::network::dns_resolver::caching::v3::CachingDnsResolverConfig& config,
+      Event::Dispatcher& dispatcher, Api::Api& api);
+  ~DnsAnswerCache();
+
+  /**
+   * Resolves a name from the cache, or with the wrapped resolver on a miss. Answers found in the
+   * cache are delivered before the call returns.
+   * @param owner supplies the resolver the query is made for. @see cancelQueries().
+   */
+  ActiveDnsQuery* resolve(const std::string& dns_name, DnsLookupFamily dns_lookup_family,
+                          DnsResolver::ResolveCb callback, const CachingDnsResolver& owner);
+
+  /**
+   * Cancels the outstanding queries of a resolver that is going away.
+   */
+  void cancelQueries(const CachingDnsResolver& owner);
+
+  /**
+   * Resets the networking of the wrapped resolver and forgets the cached answers, which may not
+   * be valid on the new network.
+   */
+  void resetNetworking();
+
+  const CachingDnsResolverStats& stats() const { return stats_; }
+
+private:
+  using Key = std::pair<std::string, DnsLookupFamily>;
+
+  struct NameStats {
+    NameStats(DnsAnswerCache& parent, const std::string& dns_name);
+    ~NameStats();
+
+    DnsAnswerCache& parent_;
+    const std::string dns_name_;
+    Stats::ScopeSharedPtr scope_;
+    CachingDnsResolverNameStats stats_;
+  };
+  using NameStatsSharedPtr = std::shared_ptr<NameStats>;
+
+  struct Entry {
+    DnsResolver::ResolutionStatus status_;
+    std::list<DnsResponse> responses_;
+    MonotonicTime expires_at_;
+    std::chrono::seconds ttl_;
+    uint64_t hits_{};
+    std::list<Key>::iterator lru_position_;
+    NameStatsSharedPtr name_stats_;
+  };
+
+  class PendingQuery : public ActiveDnsQuery {
+  public:
+    PendingQuery(DnsResolver::ResolveCb callback, const CachingDnsResolver& owner)
+        : callback_(std::move(callback)), owner_(owner) {}
+
+    // ActiveDnsQuery
+    void cancel(CancelReason) override { cancelled_ = true; }
+
+    DnsResolver::ResolveCb callback_;
+    const CachingDnsResolver& owner_;
+    bool cancelled_{};
+  };
+  using PendingQueryPtr = std::unique_ptr<PendingQuery>;
+
+  // A query of the wrapped resolver, shared by all the queries for the same name and family that
+  // miss the cache while it is outstanding. A prefetch starts out without queries.
+  struct Resolution {
+    Resolution(uint64_t id, NameStatsSharedPtr name_stats)
+        : id_(id), name_stats_(std::move(name_stats)) {}
+
+    const uint64_t id_;
+    NameStatsSharedPtr name_stats_;
+    ActiveDnsQuery* active_query_{};
+    std::list<PendingQueryPtr> queries_;
+  };
+  using ResolutionPtr = std::unique_ptr<Resolution>;
+
+  static CachingDnsResolverStats generateStats(Stats::Scope& scope);
+  NameStatsSharedPtr nameStats(const std::string& dns_name);
+  Resolution& createResolution(const Key& key);
+  // Starts the query of the wrapped resolver. Returns false if it completed inline.
+  bool startResolution(const Key& key);
+  void onResolution(const Key& key, uint64_t id, DnsResolver::ResolutionStatus status,
+                    std::list<DnsResponse>&& responses);
+  void maybePrefetch(const Key& key, Entry& entry, MonotonicTime now);
+  void insert(const Key& key, DnsResolver::ResolutionStatus status,
+              const std::list<DnsResponse>& responses, NameStatsSharedPtr name_stats);
+  void erase(absl::flat_hash_map<Key, Entry>::iterator it);
+  std::chrono::seconds cacheTtl(DnsResolver::ResolutionStatus status,
+                                const std::list<DnsResponse>& responses) const;
+  static std::list<DnsResponse> withRemainingTtl(const std::list<DnsResponse>& responses,
+                                                 std::chrono::seconds ttl);
+
+  TimeSource& time_source_;
+  Stats::ScopeSharedPtr scope_;
+  CachingDnsResolverStats stats_;
+  const uint32_t max_entries_;
+  const std::chrono::seconds min_ttl_;
+  const std::chrono::seconds max_ttl_;
+  const std::chrono::seconds negative_ttl_;
+  const uint32_t prefetch_min_hits_;
+  DnsResolverSharedPtr resolver_;
+  // Must outlive the entries and resolutions, whose name stats remove themselves from it.
+  absl::flat_hash_map<std::string, std::weak_ptr<NameStats>> name_stats_;
+  absl::flat_hash_map<Key, Entry> entries_;
+  // Most recently used first.
+  std::list<Key> lru_;
+  absl::flat_hash_map<Key, ResolutionPtr> resolutions_;
+  uint64_t next_resolution_id_{};
+};
+
+using DnsAnswerCacheSharedPtr = std::shared_ptr<DnsAnswerCache>;
+
+/**
+ * Implementation of DnsResolver that answers from a DnsAnswerCache.
+ */
+class CachingDnsResolver : public DnsResolver {
+public:
+  CachingDnsResolver(DnsAnswerCacheSharedPtr cache) : cache_(std::move(cache)) {}
+  ~CachingDnsResolver() override { cache_->cancelQueries(*this); }
+
+  // Network::DnsResolver
+  ActiveDnsQuery* resolve(const std::string& dns_name, DnsLookupFamily dns_lookup_family,
+                          ResolveCb callback) override {
+    return cache_->resolve(dns_name, dns_lookup_family, std::move(callback), *this);
+  }
+  void resetNetworking() override { cache_->resetNetworking(); }
+
+private:
+  const DnsAnswerCacheSharedPtr cache_;
+};
+
+DECLARE_FACTORY(CachingDnsResolverFactory);
+
+} // namespace Network
+} // namespace Envoy
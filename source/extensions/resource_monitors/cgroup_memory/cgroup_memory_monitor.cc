@@ -0,0 +1,111 @@
+#include "source/extensions/resource_monitors/cgroup_memory/cgroup_memory_monitor.h"
+
+#include <algorithm>
+
+#include "envoy/common/exception.h"
+#include "envoy/extensions/resource_monitors/cgroup_memory/v3/cgroup_memory.pb.h"
+
+#include "source/common/common/logger.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace CgroupMemoryMonitor {
+
+namespace {
+
+absl::StatusOr<uint64_t> parseBytes(absl::string_view value, absl::string_view name) {
+  uint64_t bytes;
+  if (!absl::SimpleAtoi(absl::StripAsciiWhitespace(value), &bytes)) {
+    return absl::InvalidArgumentError(absl::StrCat("failed to parse cgroup ", name));
+  }
+  return bytes;
+}
+
+} // namespace
+
+CgroupMemoryMonitor::CgroupMemoryMonitor(
+    const envoy::extensions::resource_monitors::cgroup_memory::v3::CgroupMemoryConfig& config)
+    : reader_(config.cgroup_path()), max_memory_(config.max_memory_bytes()),
+      exclude_inactive_file_(config.exclude_inactive_file()) {}
+
+void CgroupMemoryMonitor::updateResourceUsage(Server::ResourceUpdateCallbacks& callbacks) {
+  const absl::StatusOr<uint64_t> used = usedMemory();
+  if (!used.ok()) {
+    callbacks.onFailure(EnvoyException(std::string(used.status().message())));
+    return;
+  }
+  const absl::StatusOr<uint64_t> limit = memoryLimit();
+  if (!limit.ok()) {
+    callbacks.onFailure(EnvoyException(std::string(limit.status().message())));
+    return;
+  }
+
+  Server::ResourceUsage usage;
+  usage.resource_pressure_ = *used / static_cast<double>(*limit);
+
+  ENVOY_LOG_MISC(trace, "CgroupMemoryMonitor: used={}, limit={}, pressure={}", *used, *limit,
+                 usage.resource_pressure_);
+
+  callbacks.onSuccess(usage);
+}
+
+absl::StatusOr<uint64_t> CgroupMemoryMonitor::usedMemory() const {
+  const absl::StatusOr<std::string> current = reader_.read("memory.current");
+  if (!current.ok()) {
+    return current.status();
+  }
+  absl::StatusOr<uint64_t> used = parseBytes(*current, "memory.current");
+  if (!used.ok() || !exclude_inactive_file_) {
+    return used;
+  }
+
+  const absl::StatusOr<std::string> stat = reader_.read("memory.stat");
+  if (!stat.ok()) {
+    return stat.status();
+  }
+  for (absl::string_view line : absl::StrSplit(*stat, '\n', absl::SkipEmpty())) {
+    const std::pair<absl::string_view, absl::string_view> field = absl::StrSplit(line, ' ');
+    if (field.first == "inactive_file") {
+      const absl::StatusOr<uint64_t> inactive_file = parseBytes(field.second, "inactive_file");
+      if (!inactive_file.ok()) {
+        return inactive_file.status();
+      }
+      // The counters are not read atomically, so the inactive pages may outgrow the charged ones.
+      return *used - std::min(*used, *inactive_file);
+    }
+  }
+  return absl::InvalidArgumentError("cgroup memory.stat has no inactive_file");
+}
+
+absl::StatusOr<uint64_t> CgroupMemoryMonitor::memoryLimit() const {
+  const absl::StatusOr<std::string> max = reader_.read("memory.max");
+  if (!max.ok()) {
+    return max.status();
+  }
+  if (absl::StripAsciiWhitespace(*max) == "max") {
+    if (max_memory_ == 0) {
+      return absl::InvalidArgumentError(
+          "cgroup has no memory limit, and max_memory_bytes is not set");
+    }
+    return max_memory_;
+  }
+  const absl::StatusOr<uint64_t> limit = parseBytes(*max, "memory.max");
+  if (!limit.ok()) {
+    return limit;
+  }
+  if (*limit == 0) {
+    return absl::InvalidArgumentError("cgroup memory.max is 0");
+  }
+  return max_memory_ == 0 ? *limit : std::min(*limit, max_memory_);
+}
+
+} // namespace CgroupMemoryMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
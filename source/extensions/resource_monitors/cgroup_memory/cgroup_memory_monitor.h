@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "envoy/extensions/resource_monitors/cgroup_memory/v3/cgroup_memory.pb.h"
+#include "envoy/server/resource_monitor.h"
+
+#include "source/extensions/resource_monitors/common/cgroup_file_reader.h"
+
+#include "absl/status/statusor.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace CgroupMemoryMonitor {
+
+/**
+ * Memory monitor of a cgroup v2, whose pressure is the memory charged to the cgroup divided by its
+ * limit. The cgroup files are read on every update, since the limit of a container may change.
+ */
+class CgroupMemoryMonitor : public Server::ResourceMonitor {
+public:
+  explicit CgroupMemoryMonitor(
+      const envoy::extensions::resource_monitors::cgroup_memory::v3::CgroupMemoryConfig& config);
+
+  // Server::ResourceMonitor
+  void updateResourceUsage(Server::ResourceUpdateCallbacks& callbacks) override;
+
+private:
+  absl::StatusOr<uint64_t> usedMemory() const;
+  absl::StatusOr<uint64_t> memoryLimit() const;
+
+  const Common::CgroupFileReader reader_;
+  const uint64_t max_memory_;
+  const bool exclude_inactive_file_;
+};
+
+} // namespace CgroupMemoryMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,30 @@
+#include "source/extensions/resource_monitors/common/cgroup_file_reader.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace Common {
+
+CgroupFileReader::CgroupFileReader(absl::string_view cgroup_path)
+    : cgroup_path_(cgroup_path.empty() ? DefaultCgroupPath : cgroup_path) {}
+
+absl::StatusOr<std::string> CgroupFileReader::read(absl::string_view name) const {
+  const std::string path = absl::StrCat(cgroup_path_, "/", name);
+  std::ifstream file(path);
+  if (file.fail()) {
+    return absl::InvalidArgumentError(absl::StrCat("unable to read cgroup file: ", path));
+  }
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+} // namespace Common
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
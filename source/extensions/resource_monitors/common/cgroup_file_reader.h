@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace Common {
+
+/**
+ * Reads the interface files of a cgroup v2. The files are read directly rather than through
+ * Filesystem::Instance, which doesn't allow reading from /sys.
+ */
+class CgroupFileReader {
+public:
+  // The cgroup of the container when Envoy runs in its own cgroup namespace.
+  static constexpr absl::string_view DefaultCgroupPath = "/sys/fs/cgroup";
+
+  /**
+   * @param cgroup_path the directory of the cgroup, or empty for DefaultCgroupPath.
+   */
+  explicit CgroupFileReader(absl::string_view cgroup_path);
+
+  /**
+   * @return the contents of the interface file with the given name, e.g. "memory.current".
+   */
+  absl::StatusOr<std::string> read(absl::string_view name) const;
+
+private:
+  const std::string cgroup_path_;
+};
+
+} // namespace Common
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
@@ -66,6 +66,35 @@ private:
   const std::string name_;
 };
 
+template <class ConfigProto>
+class WorkerFactoryBase : public Server::Configuration::WorkerResourceMonitorFactory {
+public:
+  Server::WorkerResourceMonitorPtr createWorkerResourceMonitor(
+      const Protobuf::Message& config,
+      Server::Configuration::ResourceMonitorFactoryContext& context) override {
+    return createWorkerResourceMonitorFromProtoTyped(
+        MessageUtil::downcastAndValidate<const ConfigProto&>(config,
+                                                             context.messageValidationVisitor()),
+        context);
+  }
+
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return std::make_unique<ConfigProto>();
+  }
+
+  std::string name() const override { return name_; }
+
+protected:
+  WorkerFactoryBase(const std::string& name) : name_(name) {}
+
+private:
+  virtual Server::WorkerResourceMonitorPtr createWorkerResourceMonitorFromProtoTyped(
+      const ConfigProto& config,
+      Server::Configuration::ResourceMonitorFactoryContext& context) PURE;
+
+  const std::string name_;
+};
+
 } // namespace Common
 } // namespace ResourceMonitors
 } // namespace Extensions
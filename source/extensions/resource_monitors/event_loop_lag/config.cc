@@ -0,0 +1,29 @@
+#include "source/extensions/resource_monitors/event_loop_lag/config.h"
+
+#include "envoy/extensions/resource_monitors/event_loop_lag/v3/event_loop_lag.pb.h"
+#include "envoy/extensions/resource_monitors/event_loop_lag/v3/event_loop_lag.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "source/extensions/resource_monitors/event_loop_lag/event_loop_lag_monitor.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopLagMonitor {
+
+Server::WorkerResourceMonitorPtr
+EventLoopLagMonitorFactory::createWorkerResourceMonitorFromProtoTyped(
+    const envoy::extensions::resource_monitors::event_loop_lag::v3::EventLoopLagConfig& config,
+    Server::Configuration::ResourceMonitorFactoryContext& /*unused_context*/) {
+  return std::make_unique<EventLoopLagMonitor>(config);
+}
+
+/**
+ * Static registration for the event loop lag resource monitor factory. @see RegistryFactory.
+ */
+REGISTER_FACTORY(EventLoopLagMonitorFactory, Server::Configuration::WorkerResourceMonitorFactory);
+
+} // namespace EventLoopLagMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "envoy/extensions/resource_monitors/event_loop_lag/v3/event_loop_lag.pb.h"
+#include "envoy/extensions/resource_monitors/event_loop_lag/v3/event_loop_lag.pb.validate.h"
+#include "envoy/server/resource_monitor_config.h"
+
+#include "source/extensions/resource_monitors/common/factory_base.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopLagMonitor {
+
+class EventLoopLagMonitorFactory
+    : public Common::WorkerFactoryBase<
+          envoy::extensions::resource_monitors::event_loop_lag::v3::EventLoopLagConfig> {
+public:
+  EventLoopLagMonitorFactory() : WorkerFactoryBase("envoy.resource_monitors.event_loop_lag") {}
+
+private:
+  Server::WorkerResourceMonitorPtr createWorkerResourceMonitorFromProtoTyped(
+      const envoy::extensions::resource_monitors::event_loop_lag::v3::EventLoopLagConfig& config,
+      Server::Configuration::ResourceMonitorFactoryContext& context) override;
+};
+
+} // namespace EventLoopLagMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
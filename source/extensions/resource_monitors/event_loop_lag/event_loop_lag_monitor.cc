@@ -0,0 +1,29 @@
+#include "source/extensions/resource_monitors/event_loop_lag/event_loop_lag_monitor.h"
+
+#include <algorithm>
+
+#include "source/common/protobuf/protobuf.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopLagMonitor {
+
+EventLoopLagMonitor::EventLoopLagMonitor(
+    const envoy::extensions::resource_monitors::event_loop_lag::v3::EventLoopLagConfig& config)
+    // A max lag under a microsecond is rounded up, so that the pressure is always defined.
+    : max_lag_(std::max<int64_t>(
+          1, Protobuf::util::TimeUtil::DurationToMicroseconds(config.max_lag()))) {}
+
+void EventLoopLagMonitor::initializeWorker(Event::Dispatcher& dispatcher) {
+  dispatcher.enableLoopLagTracking();
+}
+
+double EventLoopLagMonitor::workerPressure(Event::Dispatcher& dispatcher) {
+  return static_cast<double>(dispatcher.loopLag().count()) / max_lag_.count();
+}
+
+} // namespace EventLoopLagMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
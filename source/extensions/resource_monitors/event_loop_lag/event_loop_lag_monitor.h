@@ -0,0 +1,34 @@
+#pragma once
+
+#include <chrono>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/extensions/resource_monitors/event_loop_lag/v3/event_loop_lag.pb.h"
+#include "envoy/server/resource_monitor.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopLagMonitor {
+
+/**
+ * Worker resource monitor whose pressure is the lag of the event loop of each thread divided by
+ * the configured maximum lag. The lag is tracked by the dispatcher, so reading it doesn't block.
+ */
+class EventLoopLagMonitor : public Server::WorkerResourceMonitor {
+public:
+  explicit EventLoopLagMonitor(
+      const envoy::extensions::resource_monitors::event_loop_lag::v3::EventLoopLagConfig& config);
+
+  // Server::WorkerResourceMonitor
+  void initializeWorker(Event::Dispatcher& dispatcher) override;
+  double workerPressure(Event::Dispatcher& dispatcher) override;
+
+private:
+  const std::chrono::microseconds max_lag_;
+};
+
+} // namespace EventLoopLagMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
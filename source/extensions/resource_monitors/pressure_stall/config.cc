@@ -0,0 +1,29 @@
+#include "source/extensions/resource_monitors/pressure_stall/config.h"
+
+#include "envoy/extensions/resource_monitors/pressure_stall/v3/pressure_stall.pb.h"
+#include "envoy/extensions/resource_monitors/pressure_stall/v3/pressure_stall.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "source/common/protobuf/utility.h"
+#include "source/extensions/resource_monitors/pressure_stall/pressure_stall_monitor.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace PressureStallMonitor {
+
+Server::ResourceMonitorPtr PressureStallMonitorFactory::createResourceMonitorFromProtoTyped(
+    const envoy::extensions::resource_monitors::pressure_stall::v3::PressureStallConfig& config,
+    Server::Configuration::ResourceMonitorFactoryContext& /*unused_context*/) {
+  return std::make_unique<PressureStallMonitor>(config);
+}
+
+/**
+ * Static registration for the pressure stall resource monitor factory. @see RegistryFactory.
+ */
+REGISTER_FACTORY(PressureStallMonitorFactory, Server::Configuration::ResourceMonitorFactory);
+
+} // namespace PressureStallMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
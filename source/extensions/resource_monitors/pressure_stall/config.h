@@ -0,0 +1,29 @@
+#pragma once
+
+#include "envoy/extensions/resource_monitors/pressure_stall/v3/pressure_stall.pb.h"
+#include "envoy/extensions/resource_monitors/pressure_stall/v3/pressure_stall.pb.validate.h"
+#include "envoy/server/resource_monitor_config.h"
+
+#include "source/extensions/resource_monitors/common/factory_base.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace PressureStallMonitor {
+
+class PressureStallMonitorFactory
+    : public Common::FactoryBase<
+          envoy::extensions::resource_monitors::pressure_stall::v3::PressureStallConfig> {
+public:
+  PressureStallMonitorFactory() : FactoryBase("envoy.resource_monitors.pressure_stall") {}
+
+private:
+  Server::ResourceMonitorPtr createResourceMonitorFromProtoTyped(
+      const envoy::extensions::resource_monitors::pressure_stall::v3::PressureStallConfig& config,
+      Server::Configuration::ResourceMonitorFactoryContext& context) override;
+};
+
+} // namespace PressureStallMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
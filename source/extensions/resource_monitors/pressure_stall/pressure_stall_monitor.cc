@@ -0,0 +1,112 @@
+#include "source/extensions/resource_monitors/pressure_stall/pressure_stall_monitor.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "envoy/common/exception.h"
+#include "envoy/extensions/resource_monitors/pressure_stall/v3/pressure_stall.pb.h"
+
+#include "source/common/common/assert.h"
+#include "source/common/common/logger.h"
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace PressureStallMonitor {
+
+namespace {
+
+using PressureStallConfig =
+    envoy::extensions::resource_monitors::pressure_stall::v3::PressureStallConfig;
+
+std::string pressureFilename(PressureStallConfig::Resource resource) {
+  switch (resource) {
+    PANIC_ON_PROTO_ENUM_SENTINEL_VALUES;
+  case PressureStallConfig::MEMORY:
+    return "memory.pressure";
+  case PressureStallConfig::CPU:
+    return "cpu.pressure";
+  case PressureStallConfig::IO:
+    return "io.pressure";
+  }
+  PANIC_DUE_TO_CORRUPT_ENUM;
+}
+
+std::string stallTypeName(PressureStallConfig::StallType stall_type) {
+  return stall_type == PressureStallConfig::FULL ? "full" : "some";
+}
+
+std::string windowName(PressureStallConfig::Window window) {
+  switch (window) {
+    PANIC_ON_PROTO_ENUM_SENTINEL_VALUES;
+  case PressureStallConfig::AVG10:
+    return "avg10";
+  case PressureStallConfig::AVG60:
+    return "avg60";
+  case PressureStallConfig::AVG300:
+    return "avg300";
+  }
+  PANIC_DUE_TO_CORRUPT_ENUM;
+}
+
+} // namespace
+
+PressureStallMonitor::PressureStallMonitor(const PressureStallConfig& config)
+    : reader_(config.cgroup_path()), filename_(pressureFilename(config.resource())),
+      stall_type_(stallTypeName(config.stall_type())), window_(windowName(config.window())) {}
+
+void PressureStallMonitor::updateResourceUsage(Server::ResourceUpdateCallbacks& callbacks) {
+  const absl::StatusOr<std::string> contents = reader_.read(filename_);
+  if (!contents.ok()) {
+    callbacks.onFailure(EnvoyException(std::string(contents.status().message())));
+    return;
+  }
+  const absl::StatusOr<double> pressure = parsePressure(*contents, stall_type_, window_);
+  if (!pressure.ok()) {
+    callbacks.onFailure(
+        EnvoyException(absl::StrCat(filename_, ": ", pressure.status().message())));
+    return;
+  }
+
+  Server::ResourceUsage usage;
+  usage.resource_pressure_ = *pressure;
+
+  ENVOY_LOG_MISC(trace, "PressureStallMonitor: {} {} {}={}", filename_, stall_type_, window_,
+                 usage.resource_pressure_);
+
+  callbacks.onSuccess(usage);
+}
+
+absl::StatusOr<double> PressureStallMonitor::parsePressure(absl::string_view contents,
+                                                           absl::string_view stall_type,
+                                                           absl::string_view window) {
+  for (absl::string_view line : absl::StrSplit(contents, '\n', absl::SkipEmpty())) {
+    const std::vector<absl::string_view> fields = absl::StrSplit(line, ' ', absl::SkipEmpty());
+    if (fields.empty() || fields[0] != stall_type) {
+      continue;
+    }
+    for (auto field = fields.begin() + 1; field != fields.end(); ++field) {
+      const std::pair<absl::string_view, absl::string_view> average = absl::StrSplit(*field, '=');
+      if (average.first != window) {
+        continue;
+      }
+      double percentage;
+      if (!absl::SimpleAtod(average.second, &percentage) || percentage < 0) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("failed to parse ", stall_type, " ", window));
+      }
+      return std::min(percentage / 100, 1.0);
+    }
+    return absl::InvalidArgumentError(absl::StrCat("no ", window, " for ", stall_type, " stalls"));
+  }
+  return absl::InvalidArgumentError(absl::StrCat("no ", stall_type, " stalls"));
+}
+
+} // namespace PressureStallMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
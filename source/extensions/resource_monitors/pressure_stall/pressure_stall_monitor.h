@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+
+#include "envoy/extensions/resource_monitors/pressure_stall/v3/pressure_stall.pb.h"
+#include "envoy/server/resource_monitor.h"
+
+#include "source/extensions/resource_monitors/common/cgroup_file_reader.h"
+
+#include "absl/status/statusor.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace PressureStallMonitor {
+
+/**
+ * Monitor of the pressure stall information of a resource of a cgroup v2, whose pressure is the
+ * share of time in which the tasks of the cgroup were stalled waiting for the resource.
+ */
+class PressureStallMonitor : public Server::ResourceMonitor {
+public:
+  explicit PressureStallMonitor(
+      const envoy::extensions::resource_monitors::pressure_stall::v3::PressureStallConfig& config);
+
+  // Server::ResourceMonitor
+  void updateResourceUsage(Server::ResourceUpdateCallbacks& callbacks) override;
+
+  /**
+   * Parses the share of stalled time from the contents of a PSI file, e.g.
+   * "some avg10=1.50 avg60=0.80 avg300=0.20 total=123456".
+   * @param contents the contents of the file.
+   * @param stall_type "some" or "full".
+   * @param window "avg10", "avg60" or "avg300".
+   * @return the share of stalled time, in [0..1].
+   */
+  static absl::StatusOr<double> parsePressure(absl::string_view contents,
+                                              absl::string_view stall_type,
+                                              absl::string_view window);
+
+private:
+  const Common::CgroupFileReader reader_;
+  const std::string filename_;
+  const std::string stall_type_;
+  const std::string window_;
+};
+
+} // namespace PressureStallMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
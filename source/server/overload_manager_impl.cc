@@ -167,17 +167,45 @@ parseTimerMinimums(const ProtobufWkt::Any& typed_config,
 } // namespace
 
 /**
- * Thread-local copy of the state of each configured overload action.
+ * Thread-local copy of the state of each configured overload action. The triggers on worker
+ * resources are evaluated here, for the thread of the dispatcher only.
  */
 class ThreadLocalOverloadStateImpl : public ThreadLocalOverloadState {
 public:
-  explicit ThreadLocalOverloadStateImpl(
+  ThreadLocalOverloadStateImpl(
       const NamedOverloadActionSymbolTable& action_symbol_table,
       std::shared_ptr<absl::node_hash_map<OverloadProactiveResourceName, ProactiveResource>>&
-          proactive_resources)
+          proactive_resources,
+      Event::Dispatcher& dispatcher, const OverloadManagerImpl& manager)
       : action_symbol_table_(action_symbol_table),
         actions_(action_symbol_table.size(), OverloadActionState(UnitFloat::min())),
-        proactive_resources_(proactive_resources) {}
+        proactive_resources_(proactive_resources), dispatcher_(dispatcher),
+        worker_resources_(manager.worker_resources_),
+        worker_loadshed_probabilities_(manager.loadshed_points_.size(), 0.0f) {
+    for (const auto& resource : worker_resources_) {
+      resource.monitor_->initializeWorker(dispatcher_);
+      WorkerTriggers& triggers = worker_triggers_.emplace_back(makeGauge(
+          manager.stats_scope_, resource.name_, absl::StrCat(dispatcher_.name(), ".pressure"),
+          Stats::Gauge::ImportMode::NeverImport));
+      for (const auto& [action, trigger_config] : resource.action_triggers_) {
+        triggers.action_triggers_.emplace_back(action, createTriggerFromConfig(trigger_config));
+      }
+      for (const auto& [point, trigger_config] : resource.loadshed_point_triggers_) {
+        triggers.loadshed_point_triggers_.emplace_back(point,
+                                                       createTriggerFromConfig(trigger_config));
+      }
+    }
+    for (const auto action : manager.worker_actions_) {
+      global_worker_action_states_.emplace(action, OverloadActionState::inactive());
+      std::vector<const OverloadActionCb*>& callbacks = worker_action_callbacks_[action];
+      auto [callbacks_start, callbacks_end] = manager.action_to_callbacks_.equal_range(action);
+      for (auto it = callbacks_start; it != callbacks_end; ++it) {
+        if (&it->second.dispatcher_ == &dispatcher_) {
+          callbacks.push_back(&it->second.callback_);
+        }
+      }
+    }
+  }
 
   const OverloadActionState& getState(const std::string& action) override {
     if (const auto symbol = action_symbol_table_.lookup(action); symbol != absl::nullopt) {
@@ -187,9 +215,43 @@ public:
   }
 
   void setState(NamedOverloadActionSymbolTable::Symbol action, OverloadActionState state) {
+    if (auto it = global_worker_action_states_.find(action);
+        it != global_worker_action_states_.end()) {
+      it->second = state;
+      updateWorkerActionState(action);
+      return;
+    }
     actions_[action.index()] = state;
   }
 
+  // Evaluates the worker resources for this thread, and updates the state of the actions and load
+  // shed points they trigger.
+  void updateWorkerResources() {
+    std::fill(worker_loadshed_probabilities_.begin(), worker_loadshed_probabilities_.end(), 0.0f);
+    for (size_t i = 0; i < worker_triggers_.size(); ++i) {
+      WorkerTriggers& triggers = worker_triggers_[i];
+      const double pressure = worker_resources_[i].monitor_->workerPressure(dispatcher_);
+      triggers.pressure_gauge_.set(pressure * 100); // convert to percent
+      for (auto& action_trigger : triggers.action_triggers_) {
+        action_trigger.second->updateValue(pressure);
+      }
+      for (auto& [point, trigger] : triggers.loadshed_point_triggers_) {
+        trigger->updateValue(pressure);
+        worker_loadshed_probabilities_[point] = std::max(
+            worker_loadshed_probabilities_[point], trigger->actionState().value().value());
+      }
+    }
+    for (const auto& action_state : global_worker_action_states_) {
+      updateWorkerActionState(action_state.first);
+    }
+  }
+
+  // Returns the probability to shed load at the load shed point with the given index, according
+  // to the worker resources of this thread.
+  float workerLoadShedProbability(size_t point) const {
+    return worker_loadshed_probabilities_[point];
+  }
+
   bool tryAllocateResource(OverloadProactiveResourceName resource_name,
                            int64_t increment) override {
     const auto proactive_resource = proactive_resources_->find(resource_name);
@@ -229,11 +291,53 @@ public:
   }
 
 private:
+  // The triggers on a worker resource, for this thread.
+  struct WorkerTriggers {
+    explicit WorkerTriggers(Stats::Gauge& pressure_gauge) : pressure_gauge_(pressure_gauge) {}
+
+    Stats::Gauge& pressure_gauge_;
+    std::vector<std::pair<NamedOverloadActionSymbolTable::Symbol, TriggerPtr>> action_triggers_;
+    std::vector<std::pair<size_t, TriggerPtr>> loadshed_point_triggers_;
+  };
+
+  // Computes the state of an action triggered by worker resources as the maximum of its state
+  // on the global resources and of its triggers on this thread, and runs the callbacks of this
+  // thread if the state changed.
+  void updateWorkerActionState(NamedOverloadActionSymbolTable::Symbol action) {
+    OverloadActionState state = global_worker_action_states_.at(action);
+    for (const auto& triggers : worker_triggers_) {
+      for (const auto& [trigger_action, trigger] : triggers.action_triggers_) {
+        if (trigger_action == action && trigger->actionState().value() > state.value()) {
+          state = trigger->actionState();
+        }
+      }
+    }
+    if (state.value() == actions_[action.index()].value()) {
+      return;
+    }
+    actions_[action.index()] = state;
+    for (const OverloadActionCb* callback : worker_action_callbacks_[action]) {
+      (*callback)(state);
+    }
+  }
+
   static const OverloadActionState always_inactive_;
   const NamedOverloadActionSymbolTable& action_symbol_table_;
   std::vector<OverloadActionState> actions_;
   std::shared_ptr<absl::node_hash_map<OverloadProactiveResourceName, ProactiveResource>>
       proactive_resources_;
+  Event::Dispatcher& dispatcher_;
+  const std::vector<OverloadManagerImpl::WorkerResource>& worker_resources_;
+  // The triggers of each worker resource, in the order of worker_resources_.
+  std::vector<WorkerTriggers> worker_triggers_;
+  // The state of the actions triggered by worker resources according to the global resources.
+  absl::flat_hash_map<NamedOverloadActionSymbolTable::Symbol, OverloadActionState>
+      global_worker_action_states_;
+  // The callbacks registered with the dispatcher of this thread for the actions triggered by
+  // worker resources.
+  absl::flat_hash_map<NamedOverloadActionSymbolTable::Symbol, std::vector<const OverloadActionCb*>>
+      worker_action_callbacks_;
+  std::vector<float> worker_loadshed_probabilities_;
 };
 
 const OverloadActionState ThreadLocalOverloadStateImpl::always_inactive_{UnitFloat::min()};
@@ -350,8 +454,19 @@ void LoadShedPointImpl::updateProbabilityShedLoad() {
   scale_percent_.set(100 * max_unit_float);
 }
 
+void LoadShedPointImpl::setWorkerState(
+    ThreadLocal::TypedSlot<ThreadLocalOverloadStateImpl>& worker_state, size_t index) {
+  worker_state_ = &worker_state;
+  worker_index_ = index;
+}
+
 bool LoadShedPointImpl::shouldShedLoad() {
   float unit_float_probability_shed_load = probability_shed_load_.load();
+  if (worker_state_ != nullptr && worker_state_->currentThreadRegistered()) {
+    unit_float_probability_shed_load =
+        std::max(unit_float_probability_shed_load,
+                 (*worker_state_)->workerLoadShedProbability(worker_index_));
+  }
   // This should be ok as we're using unit float which saturates at 1.0f.
   if (unit_float_probability_shed_load == 1.0f) {
     return true;
@@ -365,7 +480,8 @@ OverloadManagerImpl::OverloadManagerImpl(Event::Dispatcher& dispatcher, Stats::S
                                          const envoy::config::overload::v3::OverloadManager& config,
                                          ProtobufMessage::ValidationVisitor& validation_visitor,
                                          Api::Api& api, const Server::Options& options)
-    : dispatcher_(dispatcher), time_source_(api.timeSource()), tls_(slot_allocator),
+    : dispatcher_(dispatcher), stats_scope_(stats_scope), time_source_(api.timeSource()),
+      tls_(slot_allocator),
       refresh_interval_(
           std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(config, refresh_interval, 1000))),
       refresh_interval_delays_(makeHistogram(stats_scope, "refresh_interval_delay",
@@ -400,6 +516,16 @@ OverloadManagerImpl::OverloadManagerImpl(Event::Dispatcher& dispatcher, Stats::S
           proactive_resources_
               ->try_emplace(proactive_resource_it->second, name, std::move(monitor), stats_scope)
               .second;
+    } else if (auto* worker_factory =
+                   Config::Utility::getFactory<Configuration::WorkerResourceMonitorFactory>(
+                       resource);
+               worker_factory != nullptr) {
+      ENVOY_LOG(debug, "Adding worker resource monitor for {}", name);
+      auto config =
+          Config::Utility::translateToFactoryConfig(resource, validation_visitor, *worker_factory);
+      auto monitor = worker_factory->createWorkerResourceMonitor(*config, context);
+      result = !resources_.contains(name) && findWorkerResource(name) == nullptr;
+      worker_resources_.emplace_back(name, std::move(monitor));
     } else {
       ENVOY_LOG(debug, "Adding resource monitor for {}", name);
       auto& factory =
@@ -407,7 +533,8 @@ OverloadManagerImpl::OverloadManagerImpl(Event::Dispatcher& dispatcher, Stats::S
       auto config =
           Config::Utility::translateToFactoryConfig(resource, validation_visitor, factory);
       auto monitor = factory.createResourceMonitor(*config, context);
-      result = resources_.try_emplace(name, name, std::move(monitor), *this, stats_scope).second;
+      result = findWorkerResource(name) == nullptr &&
+               resources_.try_emplace(name, name, std::move(monitor), *this, stats_scope).second;
     }
     if (!result) {
       throw EnvoyException(absl::StrCat("Duplicate resource monitor ", name));
@@ -455,6 +582,12 @@ OverloadManagerImpl::OverloadManagerImpl(Event::Dispatcher& dispatcher, Stats::S
 
     for (const auto& trigger : action.triggers()) {
       const std::string& resource = trigger.name();
+      if (WorkerResource* worker_resource = findWorkerResource(resource);
+          worker_resource != nullptr) {
+        worker_resource->action_triggers_.emplace_back(symbol, trigger);
+        worker_actions_.insert(symbol);
+        continue;
+      }
       auto proactive_resource_it =
           OverloadProactiveResources::get().proactive_action_name_to_resource_.find(resource);
 
@@ -470,8 +603,14 @@ OverloadManagerImpl::OverloadManagerImpl(Event::Dispatcher& dispatcher, Stats::S
 
   // Validate the trigger resources for Load shedPoints.
   for (const auto& point : config.loadshed_points()) {
+    const size_t index = loadshed_points_.size();
+    bool has_worker_trigger = false;
     for (const auto& trigger : point.triggers()) {
-      if (!resources_.contains(trigger.name())) {
+      if (WorkerResource* worker_resource = findWorkerResource(trigger.name());
+          worker_resource != nullptr) {
+        worker_resource->loadshed_point_triggers_.emplace_back(index, trigger);
+        has_worker_trigger = true;
+      } else if (!resources_.contains(trigger.name())) {
         throw EnvoyException(fmt::format("Unknown trigger resource {} for loadshed point {}",
                                          trigger.name(), point.name()));
       }
@@ -484,19 +623,29 @@ OverloadManagerImpl::OverloadManagerImpl(Event::Dispatcher& dispatcher, Stats::S
     if (!result.second) {
       throw EnvoyException(absl::StrCat("Duplicate loadshed point ", point.name()));
     }
+    if (has_worker_trigger) {
+      result.first->second->setWorkerState(tls_, index);
+    }
   }
 }
 
+OverloadManagerImpl::WorkerResource*
+OverloadManagerImpl::findWorkerResource(absl::string_view name) {
+  auto it = std::find_if(worker_resources_.begin(), worker_resources_.end(),
+                         [name](const WorkerResource& resource) { return resource.name_ == name; });
+  return it != worker_resources_.end() ? &*it : nullptr;
+}
+
 void OverloadManagerImpl::start() {
   ASSERT(!started_);
   started_ = true;
 
-  tls_.set([this](Event::Dispatcher&) {
+  tls_.set([this](Event::Dispatcher& dispatcher) {
     return std::make_shared<ThreadLocalOverloadStateImpl>(action_symbol_table_,
-                                                          proactive_resources_);
+                                                          proactive_resources_, dispatcher, *this);
   });
 
-  if (resources_.empty()) {
+  if (resources_.empty() && worker_resources_.empty()) {
     return;
   }
 
@@ -513,6 +662,12 @@ void OverloadManagerImpl::start() {
       resource.second.update(flush_epoch_);
     }
 
+    if (!worker_resources_.empty()) {
+      tls_.runOnAllThreads([](OptRef<ThreadLocalOverloadStateImpl> overload_state) {
+        overload_state->updateWorkerResources();
+      });
+    }
+
     // Record delay.
     auto now = time_source_.monotonicTime();
     std::chrono::milliseconds delay =
@@ -609,6 +764,11 @@ void OverloadManagerImpl::updateResourcePressure(const std::string& resource, do
       // causes the action to have value B, B would have been the result for whichever order the
       // updates to resources 1 and 2 came in.
       state_updates_to_flush_.insert_or_assign(action, state);
+      if (worker_actions_.contains(action)) {
+        // The callbacks of actions triggered by worker resources are run by the thread local
+        // state, once it combined this state with the one of the worker resources.
+        return;
+      }
       auto [callbacks_start, callbacks_end] = action_to_callbacks_.equal_range(action);
       std::for_each(callbacks_start, callbacks_end, [&](ActionToCallbackMap::value_type& cb_entry) {
         callbacks_to_flush_.insert_or_assign(&cb_entry.second, state);
@@ -18,6 +18,7 @@
 #include "source/common/common/logger.h"
 #include "source/common/event/scaled_range_timer_manager_impl.h"
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/node_hash_map.h"
 #include "absl/container/node_hash_set.h"
 
@@ -59,6 +60,8 @@ private:
   Stats::Gauge& scale_percent_gauge_;
 };
 
+class ThreadLocalOverloadStateImpl;
+
 /**
  * Implement a LoadShedPoint which is a particular point in the connection /
  * request lifecycle where we can either abort or continue the given work.
@@ -81,6 +84,16 @@ public:
    */
   void updateResource(absl::string_view resource_name, double resource_utilization);
 
+  /**
+   * Makes the LoadShedPoint also shed load with the probability computed by the triggers on worker
+   * resources of the thread it is called on.
+   * @param worker_state - the thread local overload state, which evaluates the triggers on worker
+   *  resources.
+   * @param index - the index of the LoadShedPoint in the thread local overload state.
+   */
+  void setWorkerState(ThreadLocal::TypedSlot<ThreadLocalOverloadStateImpl>& worker_state,
+                      size_t index);
+
 private:
   using TriggerPtr = std::unique_ptr<Trigger>;
 
@@ -89,6 +102,8 @@ private:
 
   absl::flat_hash_map<std::string, TriggerPtr> triggers_;
   std::atomic<float> probability_shed_load_{0};
+  ThreadLocal::TypedSlot<ThreadLocalOverloadStateImpl>* worker_state_{};
+  size_t worker_index_{};
   Stats::Gauge& scale_percent_;
   Random::RandomGenerator& random_generator_;
 };
@@ -140,8 +155,6 @@ private:
   std::vector<std::string> names_;
 };
 
-class ThreadLocalOverloadStateImpl;
-
 class OverloadManagerImpl : Logger::Loggable<Logger::Id::main>, public OverloadManager {
 public:
   OverloadManagerImpl(Event::Dispatcher& dispatcher, Stats::Scope& stats_scope,
@@ -166,6 +179,8 @@ protected:
       const Event::ScaledTimerTypeMapConstSharedPtr& timer_minimums) const;
 
 private:
+  friend class ThreadLocalOverloadStateImpl;
+
   using FlushEpochId = uint64_t;
   class Resource : public ResourceUpdateCallbacks {
   public:
@@ -189,6 +204,21 @@ private:
     Stats::Counter& skipped_updates_counter_;
   };
 
+  // A resource whose pressure is evaluated by each thread, along with the triggers on it. The
+  // actions and the load shed points with such triggers have a state that differs per thread.
+  struct WorkerResource {
+    WorkerResource(const std::string& name, WorkerResourceMonitorPtr monitor)
+        : name_(name), monitor_(std::move(monitor)) {}
+
+    std::string name_;
+    WorkerResourceMonitorPtr monitor_;
+    std::vector<std::pair<NamedOverloadActionSymbolTable::Symbol,
+                          envoy::config::overload::v3::Trigger>>
+        action_triggers_;
+    // The triggers of the load shed points, by index of the load shed point.
+    std::vector<std::pair<size_t, envoy::config::overload::v3::Trigger>> loadshed_point_triggers_;
+  };
+
   struct ActionCallback {
     ActionCallback(Event::Dispatcher& dispatcher, OverloadActionCb callback)
         : dispatcher_(dispatcher), callback_(callback) {}
@@ -196,6 +226,7 @@ private:
     OverloadActionCb callback_;
   };
 
+  WorkerResource* findWorkerResource(absl::string_view name);
   void updateResourcePressure(const std::string& resource, double pressure,
                               FlushEpochId flush_epoch);
   // Flushes any enqueued action state updates to all worker threads.
@@ -203,6 +234,7 @@ private:
 
   bool started_{false};
   Event::Dispatcher& dispatcher_;
+  Stats::Scope& stats_scope_;
   TimeSource& time_source_;
   ThreadLocal::TypedSlot<ThreadLocalOverloadStateImpl> tls_;
   NamedOverloadActionSymbolTable action_symbol_table_;
@@ -216,8 +248,12 @@ private:
   absl::node_hash_map<std::string, Resource> resources_;
   std::shared_ptr<absl::node_hash_map<OverloadProactiveResourceName, ProactiveResource>>
       proactive_resources_;
+  std::vector<WorkerResource> worker_resources_;
 
   absl::node_hash_map<NamedOverloadActionSymbolTable::Symbol, OverloadAction> actions_;
+  // The actions triggered by worker resources, whose callbacks are run by the thread local
+  // overload state of their dispatcher.
+  absl::flat_hash_set<NamedOverloadActionSymbolTable::Symbol> worker_actions_;
 
   absl::flat_hash_map<std::string, std::unique_ptr<LoadShedPointImpl>> loadshed_points_;
 
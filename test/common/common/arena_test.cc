@@ -0,0 +1,86 @@
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "source/common/common/arena.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace {
+
+class TestObject : public ArenaAllocated {
+public:
+  explicit TestObject(int& destroyed) : destroyed_(destroyed) {}
+  ~TestObject() { ++destroyed_; }
+
+  int& destroyed_;
+  char data_[100];
+};
+
+TEST(ArenaTest, AllocatesNothingUntilUsed) {
+  Arena arena;
+  EXPECT_EQ(0, arena.blockCount());
+}
+
+TEST(ArenaTest, AllocationsAreAlignedAndDisjoint) {
+  Arena arena;
+  std::vector<char*> allocations;
+  for (size_t size = 1; size < 300; ++size) {
+    char* allocation = static_cast<char*>(arena.allocate(size, size % 2 == 0 ? 8 : 1));
+    if (size % 2 == 0) {
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(allocation) % 8);
+    }
+    memset(allocation, size, size);
+    allocations.push_back(allocation);
+  }
+  for (size_t size = 1; size < 300; ++size) {
+    const char* allocation = allocations[size - 1];
+    for (size_t i = 0; i < size; ++i) {
+      ASSERT_EQ(static_cast<char>(size), allocation[i]);
+    }
+  }
+  EXPECT_LT(1, arena.blockCount());
+}
+
+TEST(ArenaTest, LargeAllocationsDoNotWasteCurrentBlock) {
+  Arena arena;
+  char* small = static_cast<char*>(arena.allocate(16));
+  EXPECT_EQ(1, arena.blockCount());
+  memset(arena.allocate(Arena::BlockSize * 2), 0, Arena::BlockSize * 2);
+  EXPECT_EQ(2, arena.blockCount());
+  // The next small allocation still comes from the first block.
+  EXPECT_EQ(small + 16, arena.allocate(16));
+  EXPECT_EQ(2, arena.blockCount());
+}
+
+TEST(ArenaTest, RecyclesBlocksOnThread) {
+  {
+    Arena arena;
+    arena.allocate(16);
+  }
+  const uint64_t free_blocks = Arena::freeBlockCount();
+  EXPECT_LT(0, free_blocks);
+  {
+    Arena arena;
+    arena.allocate(16);
+    EXPECT_EQ(free_blocks - 1, Arena::freeBlockCount());
+  }
+  EXPECT_EQ(free_blocks, Arena::freeBlockCount());
+}
+
+TEST(ArenaAllocatedTest, DeletesObjectsFromArenaAndHeap) {
+  int destroyed = 0;
+  Arena arena;
+  {
+    std::unique_ptr<TestObject> from_arena(new (arena) TestObject(destroyed));
+    std::unique_ptr<TestObject> from_heap(new TestObject(destroyed));
+    EXPECT_EQ(1, arena.blockCount());
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(from_arena.get()) % alignof(std::max_align_t));
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(from_heap.get()) % alignof(std::max_align_t));
+  }
+  EXPECT_EQ(2, destroyed);
+}
+
+} // namespace
+} // namespace Envoy
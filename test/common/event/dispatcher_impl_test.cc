@@ -534,6 +534,25 @@ TEST(DispatcherThreadDeletedImplTest, DispatcherThreadDeletedAtNextCycle) {
   dispatcher->run(Event::Dispatcher::RunType::NonBlock);
 }
 
+TEST(DispatcherLoopLagTest, TracksSlowIterations) {
+  Api::ApiPtr api(Api::createApiForTest());
+  DispatcherPtr dispatcher(api->allocateDispatcher("test_thread"));
+  dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(std::chrono::microseconds(0), dispatcher->loopLag());
+
+  dispatcher->enableLoopLagTracking();
+  // Enabling the tracking again doesn't register more watchers.
+  dispatcher->enableLoopLagTracking();
+  // Each run of the loop measures the duration of the previous one, which runs a slow callback.
+  for (int i = 0; i < 6; ++i) {
+    dispatcher->post([]() { absl::SleepFor(absl::Milliseconds(20)); });
+    dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+  }
+  // The lag averages 5 iterations of at least 20ms: 20ms * (1 - (7/8)^5) > 9ms.
+  EXPECT_GT(dispatcher->loopLag(), std::chrono::milliseconds(9));
+  EXPECT_LT(dispatcher->loopLag(), std::chrono::seconds(10));
+}
+
 class DispatcherShutdownTest : public testing::Test {
 protected:
   DispatcherShutdownTest()
@@ -0,0 +1,90 @@
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "source/common/http/character_set_validation.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+
+// Headers of a browser request, with a long cookie and user agent.
+static const std::vector<std::pair<std::string, std::string>>& browserRequestHeaders() {
+  static const auto* headers = new std::vector<std::pair<std::string, std::string>>{
+      {"host", "www.example.com"},
+      {"user-agent", "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) "
+                     "Chrome/120.0.0.0 Safari/537.36"},
+      {"accept", "text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,"
+                 "image/apng,*/*;q=0.8,application/signed-exchange;v=b3;q=0.7"},
+      {"accept-encoding", "gzip, deflate, br"},
+      {"accept-language", "en-US,en;q=0.9,de;q=0.8"},
+      {"cache-control", "max-age=0"},
+      {"cookie", "session_id=3f2a9c1e7b5d4a8f9e0c1b2a3d4e5f60; _ga=GA1.2.1234567890.1700000000; "
+                 "_gid=GA1.2.987654321.1700000000; preferences=%7B%22theme%22%3A%22dark%22%7D; "
+                 "csrftoken=Zm9vYmFyYmF6cXV4cXV1eGNvcmdlZ3JhdWx0Z2FycGx5d2FsZG8"},
+      {"referer", "https://www.example.com/catalog/shelves/shelf_42?sort=title&page=3"},
+      {"sec-ch-ua", "\"Not_A Brand\";v=\"8\", \"Chromium\";v=\"120\""},
+      {"sec-fetch-dest", "document"},
+      {"sec-fetch-mode", "navigate"},
+      {"upgrade-insecure-requests", "1"},
+      {"x-forwarded-for", "203.0.113.195, 198.51.100.17"},
+      {"x-request-id", "0d7a4a3e-3c1f-4b9a-8a55-7d1c9f0e2b6a"},
+  };
+  return *headers;
+}
+
+static bool allCharsInTableOneByOne(const std::array<uint32_t, 8>& table,
+                                    absl::string_view value) {
+  for (const char c : value) {
+    if (!testCharInTable(table, c)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Validates the names and values of the request headers one character at a time.
+static void bmValidateHeadersOneByOne(benchmark::State& state) {
+  const auto& headers = browserRequestHeaders();
+  for (auto _ : state) { // NOLINT
+    for (const auto& [name, value] : headers) {
+      benchmark::DoNotOptimize(allCharsInTableOneByOne(kGenericHeaderNameCharTable, name));
+      benchmark::DoNotOptimize(allCharsInTableOneByOne(kGenericHeaderValueCharTable, value));
+    }
+  }
+}
+BENCHMARK(bmValidateHeadersOneByOne);
+
+// Validates the names and values of the request headers in blocks of characters.
+static void bmValidateHeaders(benchmark::State& state) {
+  const auto& headers = browserRequestHeaders();
+  for (auto _ : state) { // NOLINT
+    for (const auto& [name, value] : headers) {
+      benchmark::DoNotOptimize(findFirstCharNotInTable<kGenericHeaderNameCharTable>(name));
+      benchmark::DoNotOptimize(findFirstCharNotInTable<kGenericHeaderValueCharTable>(value));
+    }
+  }
+}
+BENCHMARK(bmValidateHeaders);
+
+// Validates a query string of the given length one character at a time.
+static void bmValidateQueryOneByOne(benchmark::State& state) {
+  const std::string query(state.range(0), 'q');
+  for (auto _ : state) { // NOLINT
+    benchmark::DoNotOptimize(allCharsInTableOneByOne(kUriQueryAndFragmentCharTable, query));
+  }
+}
+BENCHMARK(bmValidateQueryOneByOne)->RangeMultiplier(4)->Range(8, 2048);
+
+// Validates a query string of the given length in blocks of characters.
+static void bmValidateQuery(benchmark::State& state) {
+  const std::string query(state.range(0), 'q');
+  for (auto _ : state) { // NOLINT
+    benchmark::DoNotOptimize(findFirstCharNotInTable<kUriQueryAndFragmentCharTable>(query));
+  }
+}
+BENCHMARK(bmValidateQuery)->RangeMultiplier(4)->Range(8, 2048);
+
+} // namespace Http
+} // namespace Envoy
@@ -1,5 +1,6 @@
 #include "source/common/http/character_set_validation.h"
 
+#include "absl/strings/str_cat.h"
 #include "gtest/gtest.h"
 
 namespace Envoy {
@@ -33,5 +34,44 @@ TEST(CharacterSetValidationTest, Test) {
   }
 }
 
+size_t findFirstCharNotInTableOneByOne(const std::array<uint32_t, 8>& table,
+                                        absl::string_view value) {
+  for (size_t index = 0; index < value.size(); ++index) {
+    if (!testCharInTable(table, value[index])) {
+      return index;
+    }
+  }
+  return absl::string_view::npos;
+}
+
+// Compares with a lookup of one character at a time for every character, at every position of
+// values long enough to be validated in blocks of 16 and 32 characters.
+TEST(CharacterSetValidationTest, FindFirstCharNotInTable) {
+  for (size_t size = 0; size < 80; ++size) {
+    EXPECT_EQ(absl::string_view::npos,
+              findFirstCharNotInTable<kGenericHeaderNameCharTable>(std::string(size, 'a')));
+    for (size_t position = 0; position < size; ++position) {
+      for (unsigned c = 0; c < 256; ++c) {
+        std::string value(size, 'a');
+        value[position] = static_cast<char>(c);
+        ASSERT_EQ(findFirstCharNotInTableOneByOne(kGenericHeaderNameCharTable, value),
+                  findFirstCharNotInTable<kGenericHeaderNameCharTable>(value));
+        ASSERT_EQ(findFirstCharNotInTableOneByOne(kGenericHeaderValueCharTable, value),
+                  findFirstCharNotInTable<kGenericHeaderValueCharTable>(value));
+      }
+    }
+  }
+}
+
+TEST(CharacterSetValidationTest, FindFirstCharNotInTableOfLongValue) {
+  const std::string value =
+      absl::StrCat(std::string(40, 'a'), "\r\n", std::string(20, '\xff'), "\x7f");
+  EXPECT_EQ(40, findFirstCharNotInTable<kGenericHeaderValueCharTable>(value));
+  EXPECT_EQ(20, findFirstCharNotInTable<kGenericHeaderValueCharTable>(value.substr(42)));
+  EXPECT_EQ(absl::string_view::npos,
+            findFirstCharNotInTable<kGenericHeaderValueCharTable>(value.substr(42, 20)));
+  EXPECT_EQ(0, findFirstCharNotInTable<kGenericHeaderNameCharTable>(value.substr(42)));
+}
+
 } // namespace Http
 } // namespace Envoy
@@ -0,0 +1,116 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// The heap bytes per stream are only reported when Envoy is built with tcmalloc.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "source/common/common/arena.h"
+#include "source/common/http/filter_manager.h"
+#include "source/common/memory/stats.h"
+#include "source/common/stream_info/filter_state_impl.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/local_reply/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Http {
+namespace {
+
+constexpr int FilterCount = 8;
+
+class FilterChainFactoryImpl : public FilterChainFactory {
+public:
+  FilterChainFactoryImpl() {
+    for (int i = 0; i < FilterCount; ++i) {
+      filters_.push_back(std::make_shared<NiceMock<MockStreamFilter>>());
+    }
+  }
+
+  // Http::FilterChainFactory
+  bool createFilterChain(FilterChainManager& manager, bool,
+                         const FilterChainOptions&) const override {
+    for (const auto& filter : filters_) {
+      FilterFactoryCb factory = [filter](FilterChainFactoryCallbacks& callbacks) {
+        callbacks.addStreamFilter(filter);
+      };
+      manager.applyFilterFactoryCb({}, factory);
+    }
+    return true;
+  }
+  bool createUpgradeFilterChain(absl::string_view, const UpgradeMap*,
+                                FilterChainManager&) const override {
+    return false;
+  }
+
+private:
+  // The filters are shared by the streams, so that the benchmark measures the filter manager.
+  std::vector<std::shared_ptr<NiceMock<MockStreamFilter>>> filters_;
+};
+
+// Runs a header only request through a chain of filters, with and without a stream arena, and
+// reports the heap bytes held by a stream before it is destroyed and the p99 latency of a stream.
+static void bmHeaderOnlyRequest(benchmark::State& state) {
+  const bool use_arena = state.range(0) != 0;
+  NiceMock<MockFilterManagerCallbacks> filter_manager_callbacks;
+  NiceMock<Event::MockDispatcher> dispatcher;
+  NiceMock<Network::MockConnection> connection;
+  FilterChainFactoryImpl filter_factory;
+  NiceMock<LocalReply::MockLocalReply> local_reply;
+  NiceMock<MockTimeSystem> time_source;
+  StreamInfo::FilterStateSharedPtr filter_state =
+      std::make_shared<StreamInfo::FilterStateImpl>(StreamInfo::FilterState::LifeSpan::Connection);
+  TestRequestHeaderMapImpl request_headers{
+      {":authority", "host"}, {":path", "/"}, {":method", "GET"}};
+  ON_CALL(filter_manager_callbacks, requestHeaders())
+      .WillByDefault(testing::Return(makeOptRef<RequestHeaderMap>(request_headers)));
+
+  std::vector<uint64_t> latencies;
+  uint64_t heap_bytes = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    const auto start = std::chrono::steady_clock::now();
+    const uint64_t allocated_before = Memory::Stats::totalCurrentlyAllocated();
+    {
+      Arena arena;
+      DownstreamFilterManager filter_manager(
+          filter_manager_callbacks, dispatcher, connection, 0, nullptr, true, 10000,
+          filter_factory, local_reply, Protocol::Http2, time_source, filter_state,
+          StreamInfo::FilterState::LifeSpan::Connection);
+      if (use_arena) {
+        filter_manager.setArena(arena);
+      }
+      filter_manager.createFilterChain();
+      filter_manager.requestHeadersInitialized();
+      filter_manager.decodeHeaders(request_headers, true);
+      heap_bytes += Memory::Stats::totalCurrentlyAllocated() - allocated_before;
+      filter_manager.destroyFilters();
+    }
+    latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start)
+                            .count());
+  }
+
+  if (!latencies.empty()) {
+    const size_t p99 = latencies.size() * 99 / 100;
+    std::nth_element(latencies.begin(), latencies.begin() + p99, latencies.end());
+    state.counters["p99_ns"] = latencies[p99];
+    state.counters["heap_bytes_per_stream"] = heap_bytes / latencies.size();
+  }
+}
+BENCHMARK(bmHeaderOnlyRequest)->ArgName("arena")->Arg(0)->Arg(1);
+
+} // namespace
+} // namespace Http
+} // namespace Envoy
@@ -83,6 +83,45 @@ public:
       std::make_shared<StreamInfo::FilterStateImpl>(StreamInfo::FilterState::LifeSpan::Connection);
 };
 
+// Filter wrappers are allocated from the arena of the stream, if it has one.
+TEST_F(FilterManagerTest, AllocatesFiltersFromArena) {
+  Arena arena;
+  initialize();
+  filter_manager_->setArena(arena);
+
+  auto decoder_filter = std::make_shared<NiceMock<MockStreamDecoderFilter>>();
+  auto stream_filter = std::make_shared<NiceMock<MockStreamFilter>>();
+
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillOnce(Invoke([&](FilterChainManager& manager) -> bool {
+        auto decoder_factory = createDecoderFilterFactoryCb(decoder_filter);
+        manager.applyFilterFactoryCb({}, decoder_factory);
+        auto stream_factory = createStreamFilterFactoryCb(stream_filter);
+        manager.applyFilterFactoryCb({}, stream_factory);
+        return true;
+      }));
+  filter_manager_->createFilterChain();
+  EXPECT_EQ(1, arena.blockCount());
+
+  RequestHeaderMapPtr request_headers{
+      new TestRequestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}}};
+  ON_CALL(filter_manager_callbacks_, requestHeaders())
+      .WillByDefault(Return(makeOptRef(*request_headers)));
+
+  EXPECT_CALL(*decoder_filter, decodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::Continue));
+  EXPECT_CALL(*stream_filter, decodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::StopIteration));
+  filter_manager_->requestHeadersInitialized();
+  filter_manager_->decodeHeaders(*request_headers, true);
+
+  EXPECT_CALL(*decoder_filter, onDestroy());
+  EXPECT_CALL(*stream_filter, onDestroy());
+  filter_manager_->destroyFilters();
+  // The filter manager must not outlive the arena.
+  filter_manager_.reset();
+}
+
 TEST_F(FilterManagerTest, RequestHeadersOrResponseHeadersAccess) {
   initialize();
 
@@ -267,6 +267,51 @@ BENCHMARK_DEFINE_F(FilterChainBenchmarkFixture, FilterChainFindTest)
     }
   }
 }
+
+// Updates one of the filter chains matching on server names at a time, like a control plane
+// does when a tenant is added or changed, and builds the filter chain manager of each update from
+// the previous one.
+BENCHMARK_DEFINE_F(FilterChainBenchmarkFixture, FilterChainManagerIncrementalBuildTest)
+(::benchmark::State& state) {
+  if (benchmark::skipExpensiveBenchmarks() && state.range(0) > 64) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+
+  std::vector<envoy::config::listener::v3::FilterChain> filter_chain_messages(state.range(0));
+  std::vector<const envoy::config::listener::v3::FilterChain*> filter_chains;
+  for (int i = 0; i < state.range(0); i++) {
+    auto& filter_chain_match = *filter_chain_messages[i].mutable_filter_chain_match();
+    filter_chain_match.mutable_destination_port()->set_value(10000);
+    filter_chain_match.add_server_names(absl::StrCat("tenant-", i, ".example.com"));
+    filter_chain_match.set_transport_protocol("tls");
+    filter_chains.push_back(&filter_chain_messages[i]);
+  }
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  std::vector<Network::Address::InstanceConstSharedPtr> addresses;
+  addresses.emplace_back(std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1", 1234));
+  auto filter_chain_manager =
+      std::make_unique<FilterChainManagerImpl>(addresses, factory_context, init_manager_);
+  filter_chain_manager->addFilterChains(nullptr, filter_chains, nullptr, dummy_builder_,
+                                        *filter_chain_manager);
+
+  int update = 0;
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    state.PauseTiming();
+    auto& filter_chain_match =
+        *filter_chain_messages[update++ % state.range(0)].mutable_filter_chain_match();
+    filter_chain_match.clear_application_protocols();
+    filter_chain_match.add_application_protocols(absl::StrCat("h", update));
+    state.ResumeTiming();
+    auto new_filter_chain_manager = std::make_unique<FilterChainManagerImpl>(
+        addresses, factory_context, init_manager_, *filter_chain_manager);
+    new_filter_chain_manager->addFilterChains(nullptr, filter_chains, nullptr, dummy_builder_,
+                                              *new_filter_chain_manager);
+    filter_chain_manager = std::move(new_filter_chain_manager);
+  }
+}
+
 BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainManagerBuildTest)
     ->Ranges({
         // scale of the chains
@@ -279,6 +324,12 @@ BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainFindTest)
         {1, 4096},
     })
     ->Unit(::benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainManagerIncrementalBuildTest)
+    ->Ranges({
+        // scale of the chains, up to the tens of thousands of tenants of a large edge listener
+        {1, 65536},
+    })
+    ->Unit(::benchmark::kMillisecond);
 
 /*
 clang-format off
@@ -29,6 +29,7 @@
 #include "test/server/utility.h"
 #include "test/test_common/environment.h"
 #include "test/test_common/registry.h"
+#include "test/test_common/test_runtime.h"
 #include "test/test_common/simulated_time_system.h"
 #include "test/test_common/threadsafe_singleton_injector.h"
 #include "test/test_common/utility.h"
@@ -256,6 +257,92 @@ TEST_P(FilterChainManagerImplTest, DuplicateContextsAreNotBuilt) {
       nullptr, filter_chain_factory_builder_, new_filter_chain_manager);
 }
 
+// Adds filter chains matching on server names to a new filter chain manager that takes the
+// filter chains of the current one, and makes it the current one.
+class FilterChainManagerImplSubtreeTest : public FilterChainManagerImplTest {
+public:
+  void SetUp() override {
+    FilterChainManagerImplTest::SetUp();
+    ON_CALL(filter_chain_factory_builder_, buildFilterChain(_, _))
+        .WillByDefault([](const envoy::config::listener::v3::FilterChain&,
+                          FilterChainFactoryContextCreator&) {
+          return std::make_shared<Network::MockFilterChain>();
+        });
+    for (const char* server_name : {"foo.example.com", "bar.example.com", "*.com"}) {
+      envoy::config::listener::v3::FilterChain filter_chain = filter_chain_template_;
+      filter_chain.set_name(server_name);
+      filter_chain.mutable_filter_chain_match()->add_server_names(server_name);
+      filter_chain_messages_.push_back(std::move(filter_chain));
+    }
+  }
+
+  void updateFilterChains() {
+    std::vector<const envoy::config::listener::v3::FilterChain*> filter_chains;
+    for (const auto& filter_chain : filter_chain_messages_) {
+      filter_chains.push_back(&filter_chain);
+    }
+    auto new_filter_chain_manager = std::make_unique<FilterChainManagerImpl>(
+        addresses_, parent_context_, init_manager_, *filter_chain_manager_);
+    new_filter_chain_manager->addFilterChains(nullptr, filter_chains, nullptr,
+                                              filter_chain_factory_builder_,
+                                              *new_filter_chain_manager);
+    filter_chain_manager_ = std::move(new_filter_chain_manager);
+  }
+
+  const Network::FilterChain* findFilterChainByServerName(const std::string& server_name) {
+    return findFilterChainHelper(10000, "127.0.0.1", server_name, "tls", {}, "8.8.8.8", 111);
+  }
+
+  // Changes a filter chain, and checks that only the lookups for its server name are updated.
+  void changeFilterChainAndVerify() {
+    updateFilterChains();
+    const Network::FilterChain* foo = findFilterChainByServerName("foo.example.com");
+    const Network::FilterChain* bar = findFilterChainByServerName("bar.example.com");
+    const Network::FilterChain* wildcard = findFilterChainByServerName("baz.example.com");
+    ASSERT_NE(foo, nullptr);
+    ASSERT_NE(bar, nullptr);
+    ASSERT_NE(wildcard, nullptr);
+
+    filter_chain_messages_[1].mutable_filter_chain_match()->add_application_protocols("h2");
+    EXPECT_CALL(filter_chain_factory_builder_, buildFilterChain(_, _));
+    updateFilterChains();
+    EXPECT_EQ(foo, findFilterChainByServerName("foo.example.com"));
+    EXPECT_EQ(wildcard, findFilterChainByServerName("baz.example.com"));
+    // The changed filter chain only matches connections negotiating h2 now.
+    EXPECT_EQ(nullptr, findFilterChainByServerName("bar.example.com"));
+    const Network::FilterChain* new_bar =
+        findFilterChainHelper(10000, "127.0.0.1", "bar.example.com", "tls", {"h2"}, "8.8.8.8", 111);
+    ASSERT_NE(new_bar, nullptr);
+    EXPECT_NE(bar, new_bar);
+  }
+
+  std::vector<envoy::config::listener::v3::FilterChain> filter_chain_messages_;
+};
+
+TEST_P(FilterChainManagerImplSubtreeTest, UpdatesChangedServerNameSubtrees) {
+  changeFilterChainAndVerify();
+}
+
+TEST_P(FilterChainManagerImplSubtreeTest, UpdatesServerNameSubtreesWithoutSharing) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues(
+      {{"envoy.reloadable_features.share_filter_chain_lookup_subtrees", "false"}});
+  changeFilterChainAndVerify();
+}
+
+// The subtree of a removed filter chain is removed from the lookup tree, so that its server name
+// falls back to the wildcard filter chain.
+TEST_P(FilterChainManagerImplSubtreeTest, RemovesServerNameSubtrees) {
+  updateFilterChains();
+  const Network::FilterChain* foo = findFilterChainByServerName("foo.example.com");
+  const Network::FilterChain* wildcard = findFilterChainByServerName("baz.example.com");
+  ASSERT_NE(foo, wildcard);
+  filter_chain_messages_.erase(filter_chain_messages_.begin());
+  updateFilterChains();
+  EXPECT_EQ(wildcard, findFilterChainByServerName("foo.example.com"));
+  EXPECT_NE(nullptr, findFilterChainByServerName("bar.example.com"));
+}
+
 TEST_P(FilterChainManagerImplTest, CreatedFilterChainFactoryContextHasIndependentDrainClose) {
   std::vector<envoy::config::listener::v3::FilterChain> filter_chain_messages;
   for (int i = 0; i < 3; i++) {
@@ -287,6 +374,8 @@ TEST_P(FilterChainManagerImplTest, CreatedFilterChainFactoryContextHasIndependen
 }
 
 INSTANTIATE_TEST_SUITE_P(Matcher, FilterChainManagerImplTest, ::testing::Values(true, false));
+// The lookup tree is only built without a matcher.
+INSTANTIATE_TEST_SUITE_P(NoMatcher, FilterChainManagerImplSubtreeTest, ::testing::Values(false));
 
 } // namespace Server
 } // namespace Envoy
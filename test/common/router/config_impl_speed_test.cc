@@ -6,6 +6,7 @@
 
 #include "test/mocks/server/instance.h"
 #include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/test_runtime.h"
 #include "test/test_common/utility.h"
 
 #include "benchmark/benchmark.h"
@@ -35,6 +36,17 @@ static Http::TestRequestHeaderMapImpl genRequestHeaders(int route_num) {
       {"x-forwarded-proto", "http"}};
 }
 
+/**
+ * Generates a request with the path and tenant header:
+ * - /shelves/shelf_x/route_x
+ * - x-tenant: tenant_x
+ */
+static Http::TestRequestHeaderMapImpl genTenantRequestHeaders(int route_num) {
+  Http::TestRequestHeaderMapImpl headers = genRequestHeaders(route_num);
+  headers.addCopy("x-tenant", absl::StrCat("tenant_", route_num));
+  return headers;
+}
+
 /**
  * Generates the route config for the type of matcher being tested.
  */
@@ -59,7 +71,7 @@ static RouteConfiguration genRouteConfig(benchmark::State& state,
       break;
     }
     case RouteMatch::PathSpecifierCase::kPath: {
-      match->set_prefix(absl::StrCat("/shelves/shelf_", i, "/route_", i));
+      match->set_path(absl::StrCat("/shelves/shelf_", i, "/route_", i));
       break;
     }
     case RouteMatch::PathSpecifierCase::kSafeRegex: {
@@ -76,9 +88,48 @@ static RouteConfiguration genRouteConfig(benchmark::State& state,
   return route_config;
 }
 
+/**
+ * Generates a route config that cycles through exact path, prefix and regex matchers, all of them
+ * with a tenant header condition. Every hundredth route shares the path of the last route, but only
+ * the last route matches the tenant header of the request.
+ */
+static RouteConfiguration genMixedRouteConfig(benchmark::State& state) {
+  RouteConfiguration route_config;
+  VirtualHost* v_host = route_config.add_virtual_hosts();
+  v_host->set_name("default");
+  v_host->add_domains("*");
+
+  const int last_route_num = state.range(0) - 1;
+  for (int i = 0; i < state.range(0); ++i) {
+    Route* route = v_host->add_routes();
+    route->mutable_direct_response()->set_status(200);
+    RouteMatch* match = route->mutable_match();
+
+    const int path_num = i % 100 == 0 ? last_route_num : i;
+    switch (i % 3) {
+    case 0:
+      match->set_path(absl::StrCat("/shelves/shelf_", path_num, "/route_", path_num));
+      break;
+    case 1:
+      match->set_prefix(absl::StrCat("/shelves/shelf_", path_num, "/"));
+      break;
+    default:
+      match->mutable_safe_regex()->set_regex(
+          absl::StrCat("^/shelves/[^\\\\/]+/route_", path_num, "$"));
+      break;
+    }
+
+    auto* header = match->add_headers();
+    header->set_name("x-tenant");
+    header->mutable_string_match()->set_exact(absl::StrCat("tenant_", i));
+  }
+
+  return route_config;
+}
+
 /**
  * Measure the speed of doing a route match against a route table of varying sizes.
- * Why? Currently, route matching is linear in first-to-win ordering.
+ * Why? Route matching is in first-to-win ordering, which the route dispatch table has to keep.
  *
  * We construct the first `n - 1` items in the route table so they are not
  * matched by the incoming request. Only the last route will be matched.
@@ -104,6 +155,29 @@ static void bmRouteTableSize(benchmark::State& state, RouteMatch::PathSpecifierC
   }
 }
 
+/**
+ * Measure the speed of matching the last route of a large route table with mixed path matchers and
+ * header conditions, with and without the route dispatch table.
+ */
+static void bmMixedRouteTableSize(benchmark::State& state, bool dispatch_table) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.route_dispatch_table",
+                               dispatch_table ? "true" : "false"}});
+
+  Api::ApiPtr api = Api::createApiForTest();
+  NiceMock<Server::Configuration::MockServerFactoryContext> factory_context;
+  NiceMock<Envoy::StreamInfo::MockStreamInfo> stream_info;
+  ON_CALL(factory_context, api()).WillByDefault(ReturnRef(*api));
+
+  ConfigImpl config(genMixedRouteConfig(state), factory_context,
+                    ProtobufMessage::getNullValidationVisitor(), true);
+  const Http::TestRequestHeaderMapImpl headers = genTenantRequestHeaders(state.range(0) - 1);
+
+  for (auto _ : state) { // NOLINT
+    RELEASE_ASSERT(config.route(headers, stream_info, 0) != nullptr, "");
+  }
+}
+
 /**
  * Benchmark a route table with path prefix matchers in the form of:
  * - /shelves/shelf_1/...
@@ -136,9 +210,26 @@ static void bmRouteTableSizeWithRegexMatch(benchmark::State& state) {
   bmRouteTableSize(state, RouteMatch::PathSpecifierCase::kSafeRegex);
 }
 
+/**
+ * Benchmark a route table with exact path, prefix and regex matchers in turn, each with a header
+ * condition, using the route dispatch table.
+ */
+static void bmMixedRouteTableSizeWithDispatchTable(benchmark::State& state) {
+  bmMixedRouteTableSize(state, true);
+}
+
+/**
+ * Benchmark the same route table, evaluating the routes one by one.
+ */
+static void bmMixedRouteTableSizeWithoutDispatchTable(benchmark::State& state) {
+  bmMixedRouteTableSize(state, false);
+}
+
 BENCHMARK(bmRouteTableSizeWithPathPrefixMatch)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
 BENCHMARK(bmRouteTableSizeWithExactPathMatch)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
 BENCHMARK(bmRouteTableSizeWithRegexMatch)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
+BENCHMARK(bmMixedRouteTableSizeWithDispatchTable)->RangeMultiplier(4)->Ranges({{16, 1 << 14}});
+BENCHMARK(bmMixedRouteTableSizeWithoutDispatchTable)->RangeMultiplier(4)->Ranges({{16, 1 << 14}});
 
 } // namespace
 } // namespace Router
@@ -8677,6 +8677,122 @@ virtual_hosts:
   }
 }
 
+// Verifies that routes are selected in configuration order with and without the dispatch table.
+TEST_F(RouteMatcherTest, DispatchTableKeepsFirstMatch) {
+  const std::string yaml = R"EOF(
+virtual_hosts:
+- name: dispatch
+  domains: ["*"]
+  routes:
+  - match:
+      prefix: "/"
+      headers:
+      - name: x-debug
+        present_match: true
+    route: { cluster: debug }
+  - match: { path: "/foo" }
+    route: { cluster: exact }
+  - match:
+      safe_regex: { regex: "/fo+" }
+    route: { cluster: regex }
+  - match: { prefix: "/CASE/", case_sensitive: false }
+    route: { cluster: case-insensitive }
+  - match: { path_separated_prefix: "/foo/bar" }
+    route: { cluster: path-separated }
+  - match:
+      prefix: "/foo/"
+      query_parameters:
+      - name: debug
+        present_match: true
+    route: { cluster: query }
+  - match: { prefix: "/foo/" }
+    route: { cluster: prefix }
+  - match:
+      safe_regex: { regex: "/[a-z]+/baz" }
+    route: { cluster: regex-late }
+  )EOF";
+
+  factory_context_.cluster_manager_.initializeClusters(
+      {"debug", "exact", "regex", "case-insensitive", "path-separated", "query", "prefix",
+       "regex-late"},
+      {});
+
+  for (const std::string enabled : {"true", "false"}) {
+    mergeValues({{"envoy.reloadable_features.route_dispatch_table", enabled}});
+    TestConfigImpl config(parseRouteConfigurationFromYaml(yaml), factory_context_, true);
+
+    const auto cluster = [&config](const std::string& path) -> std::string {
+      auto route = config.route(genHeaders("dispatch.com", path, "GET"), 0);
+      return route != nullptr ? route->routeEntry()->clusterName() : "";
+    };
+
+    EXPECT_EQ("exact", cluster("/foo"));
+    EXPECT_EQ("exact", cluster("/foo?bar=baz"));
+    EXPECT_EQ("regex", cluster("/fooo"));
+    EXPECT_EQ("case-insensitive", cluster("/case/foo"));
+    EXPECT_EQ("case-insensitive", cluster("/CaSe/foo"));
+    EXPECT_EQ("path-separated", cluster("/foo/bar"));
+    EXPECT_EQ("path-separated", cluster("/foo/bar/baz?debug=1"));
+    EXPECT_EQ("query", cluster("/foo/barn?debug=1"));
+    EXPECT_EQ("prefix", cluster("/foo/barn"));
+    EXPECT_EQ("prefix", cluster("/foo/baz"));
+    EXPECT_EQ("regex-late", cluster("/bar/baz"));
+    EXPECT_EQ("", cluster("/bar"));
+
+    Http::TestRequestHeaderMapImpl headers = genHeaders("dispatch.com", "/foo", "GET");
+    headers.addCopy("x-debug", "true");
+    EXPECT_EQ("debug", config.route(headers, 0)->routeEntry()->clusterName());
+  }
+}
+
+// A regex engine that only matches the regex itself, to tell it apart from RE2.
+class LiteralRegexEngine : public Regex::Engine {
+public:
+  class Matcher : public Regex::CompiledMatcher {
+  public:
+    explicit Matcher(const std::string& regex) : regex_(regex) {}
+
+    // Regex::CompiledMatcher
+    bool match(absl::string_view value) const override { return value == regex_; }
+    std::string replaceAll(absl::string_view value, absl::string_view substitution) const override {
+      return value == regex_ ? std::string(substitution) : std::string(value);
+    }
+
+  private:
+    const std::string regex_;
+  };
+
+  // Regex::Engine
+  Regex::CompiledMatcherPtr matcher(const std::string& regex) const override {
+    return std::make_unique<Matcher>(regex);
+  }
+};
+
+// Verifies that the dispatch table does not index regexes of an engine other than RE2.
+TEST_F(RouteMatcherTest, DispatchTableOtherRegexEngine) {
+  StackedScopedInjectableLoader<Regex::Engine> engine(std::make_unique<LiteralRegexEngine>());
+  const std::string yaml = R"EOF(
+virtual_hosts:
+- name: dispatch
+  domains: ["*"]
+  routes:
+  - match:
+      safe_regex: { regex: "/a+" }
+    route: { cluster: regex }
+  - match: { prefix: "/" }
+    route: { cluster: default }
+  )EOF";
+
+  factory_context_.cluster_manager_.initializeClusters({"regex", "default"}, {});
+  TestConfigImpl config(parseRouteConfigurationFromYaml(yaml), factory_context_, true);
+
+  // RE2 would not match the literal path, and would match the repetition.
+  EXPECT_EQ("regex",
+            config.route(genHeaders("dispatch.com", "/a+", "GET"), 0)->routeEntry()->clusterName());
+  EXPECT_EQ("default",
+            config.route(genHeaders("dispatch.com", "/aa", "GET"), 0)->routeEntry()->clusterName());
+}
+
 TEST_F(RouteMatcherTest, PathSeparatedPrefixMatch) {
 
   const std::string yaml = R"EOF(
@@ -0,0 +1,118 @@
+#include <atomic>
+#include <limits>
+#include <thread>
+
+#include "source/common/stats/fixed_bucket_histogram.h"
+#include "source/common/stats/histogram_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Stats {
+
+class FixedBucketHistogramTest : public testing::Test {
+protected:
+  FixedBucketHistogramTest() : fixed_(hist_alloc()), direct_(hist_alloc()) {}
+  ~FixedBucketHistogramTest() override {
+    hist_free(fixed_);
+    hist_free(direct_);
+  }
+
+  void record(uint64_t value) {
+    histogram_.recordValue(value);
+    hist_insert_intscale(direct_, value, 0, 1);
+  }
+
+  FixedBucketHistogram histogram_;
+  histogram_t* fixed_;
+  histogram_t* direct_;
+};
+
+TEST_F(FixedBucketHistogramTest, BucketLayout) {
+  uint32_t decade;
+  uint32_t index;
+
+  FixedBucketHistogram::bucketFor(0, decade, index);
+  EXPECT_EQ(0, decade);
+  EXPECT_EQ(0, index);
+
+  FixedBucketHistogram::bucketFor(99, decade, index);
+  EXPECT_EQ(0, decade);
+  EXPECT_EQ(99, index);
+
+  FixedBucketHistogram::bucketFor(100, decade, index);
+  EXPECT_EQ(1, decade);
+  EXPECT_EQ(0, index);
+
+  FixedBucketHistogram::bucketFor(1234, decade, index);
+  EXPECT_EQ(2, decade);
+  EXPECT_EQ(2, index);
+  EXPECT_EQ(1200, FixedBucketHistogram::bucketLowerBound(decade, index));
+
+  FixedBucketHistogram::bucketFor(std::numeric_limits<uint64_t>::max(), decade, index);
+  EXPECT_EQ(FixedBucketHistogram::NumDecades - 1, decade);
+  EXPECT_EQ(8, index);
+}
+
+// Draining into a circllhist yields the same quantiles as inserting directly.
+TEST_F(FixedBucketHistogramTest, MatchesCircllhist) {
+  for (uint64_t value : {0, 1, 7, 42, 99, 100, 101, 999, 1000, 1234, 56789, 1000000}) {
+    record(value);
+  }
+  for (uint64_t i = 0; i < 1000; ++i) {
+    record(i * 37);
+  }
+
+  EXPECT_EQ(1012, histogram_.drainTo(fixed_));
+  EXPECT_EQ(hist_sample_count(direct_), hist_sample_count(fixed_));
+
+  HistogramStatisticsImpl fixed_stats(fixed_);
+  HistogramStatisticsImpl direct_stats(direct_);
+  EXPECT_EQ(direct_stats.quantileSummary(), fixed_stats.quantileSummary());
+  EXPECT_EQ(direct_stats.bucketSummary(), fixed_stats.bucketSummary());
+  EXPECT_DOUBLE_EQ(direct_stats.sampleSum(), fixed_stats.sampleSum());
+}
+
+// Draining resets the counts, and decades are only allocated when used.
+TEST_F(FixedBucketHistogramTest, DrainResets) {
+  EXPECT_EQ(0, histogram_.allocatedDecades());
+  histogram_.recordValue(5);
+  histogram_.recordValue(5000);
+  EXPECT_EQ(2, histogram_.allocatedDecades());
+
+  EXPECT_EQ(2, histogram_.drainTo(fixed_));
+  EXPECT_EQ(0, histogram_.drainTo(fixed_));
+  EXPECT_EQ(2, hist_sample_count(fixed_));
+  EXPECT_EQ(2, histogram_.allocatedDecades());
+}
+
+// Values beyond INT64_MAX are scaled rather than passed to circllhist directly.
+TEST_F(FixedBucketHistogramTest, LargeValues) {
+  histogram_.recordValue(std::numeric_limits<uint64_t>::max());
+  EXPECT_EQ(1, histogram_.drainTo(fixed_));
+  HistogramStatisticsImpl stats(fixed_);
+  EXPECT_GE(stats.computedQuantiles().back(), 1.8e19);
+}
+
+// Counts recorded concurrently with a drain are never lost or double counted.
+TEST_F(FixedBucketHistogramTest, ConcurrentDrain) {
+  constexpr uint64_t NumValues = 100000;
+  std::atomic<bool> done{false};
+  std::thread recorder([this, &done]() {
+    for (uint64_t i = 0; i < NumValues; ++i) {
+      histogram_.recordValue(i % 5000);
+    }
+    done = true;
+  });
+  uint64_t drained = 0;
+  while (!done) {
+    drained += histogram_.drainTo(fixed_);
+  }
+  recorder.join();
+  drained += histogram_.drainTo(fixed_);
+  EXPECT_EQ(NumValues, drained);
+  EXPECT_EQ(NumValues, hist_sample_count(fixed_));
+}
+
+} // namespace Stats
+} // namespace Envoy
@@ -54,6 +54,29 @@ public:
     }
   }
 
+  void initHistograms(bool lock_free) {
+    store_.setLockFreeHistograms(lock_free);
+    Stats::Scope& scope = *store_.rootScope();
+    for (auto& stat_name_storage : stat_names_) {
+      histograms_.push_back(&scope.histogramFromStatName(stat_name_storage->statName(),
+                                                         Stats::Histogram::Unit::Milliseconds));
+    }
+  }
+
+  void recordHistograms(uint64_t iteration) {
+    for (uint64_t i = 0; i < histograms_.size(); ++i) {
+      histograms_[i]->recordValue(i * iteration);
+    }
+  }
+
+  void mergeHistograms() {
+    bool merged = false;
+    store_.mergeHistograms([&merged]() { merged = true; });
+    while (!merged) {
+      dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+    }
+  }
+
   void initThreading() {
     if (!Envoy::Event::Libevent::Global::initialized()) {
       Envoy::Event::Libevent::Global::initialize();
@@ -80,6 +103,7 @@ private:
   Api::ApiPtr api_;
   envoy::config::metrics::v3::StatsConfig stats_config_;
   std::vector<std::unique_ptr<Stats::StatNameManagedStorage>> stat_names_;
+  std::vector<Stats::Histogram*> histograms_;
 };
 
 } // namespace Envoy
@@ -134,5 +158,37 @@ static void BM_StatsWithTlsAndRejectionsWithoutDot(benchmark::State& state) {
 }
 BENCHMARK(BM_StatsWithTlsAndRejectionsWithoutDot);
 
+// Compares recording into the default swapped circllhist TLS histograms (state.range(0) == 0)
+// against lock-free fixed-bucket TLS histograms (state.range(0) == 1).
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_HistogramRecord(benchmark::State& state) {
+  Envoy::ThreadLocalStorePerf context;
+  context.initThreading();
+  context.initHistograms(state.range(0) == 1);
+
+  uint64_t iteration = 0;
+  for (auto _ : state) { // NOLINT
+    context.recordHistograms(++iteration);
+  }
+}
+BENCHMARK(BM_HistogramRecord)->Arg(0)->Arg(1);
+
+// Measures a record followed by a full merge, which for the default mode includes the post to
+// every thread to swap the TLS buffers, and for the lock-free mode drains the atomic buckets
+// directly from the main thread.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_HistogramRecordAndMerge(benchmark::State& state) {
+  Envoy::ThreadLocalStorePerf context;
+  context.initThreading();
+  context.initHistograms(state.range(0) == 1);
+
+  uint64_t iteration = 0;
+  for (auto _ : state) { // NOLINT
+    context.recordHistograms(++iteration);
+    context.mergeHistograms();
+  }
+}
+BENCHMARK(BM_HistogramRecordAndMerge)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
 // TODO(jmarantz): add multi-threaded variant of this test, that aggressively
 // looks up stats in multiple threads to try to trigger contention issues.
@@ -1668,6 +1668,46 @@ TEST_F(HistogramTest, MultiHistogramMultipleMerges) {
   EXPECT_EQ(2, validateMerge());
 }
 
+// Lock-free TLS histograms are drained without a buffer swap, and produce the same summaries as
+// the default recording mode.
+TEST_F(HistogramTest, LockFreeMultiHistogramMultipleMerges) {
+  store_->setLockFreeHistograms(true);
+  Histogram& h1 = scope_.histogramFromString("h1", Histogram::Unit::Unspecified);
+  Histogram& h2 = scope_.histogramFromString("h2", Histogram::Unit::Unspecified);
+
+  expectCallAndAccumulate(h1, 1);
+  expectCallAndAccumulate(h1, 150);
+  EXPECT_EQ(2, validateMerge());
+
+  expectCallAndAccumulate(h2, 1234);
+  expectCallAndAccumulate(h2, 9876543);
+  EXPECT_EQ(2, validateMerge());
+
+  expectCallAndAccumulate(h1, 2);
+  expectCallAndAccumulate(h2, 3);
+  EXPECT_EQ(2, validateMerge());
+
+  EXPECT_EQ(2, validateMerge());
+}
+
+// Lock-free TLS histograms are merged on the main thread after mergeHistograms() returns.
+TEST_F(HistogramTest, LockFreeMergeCompletesAfterReturning) {
+  store_->setLockFreeHistograms(true);
+  Histogram& h1 = scope_.histogramFromString("h1", Histogram::Unit::Unspecified);
+  expectCallAndAccumulate(h1, 1);
+
+  Event::PostCb post_cb;
+  EXPECT_CALL(main_thread_dispatcher_, post(_)).WillOnce([&post_cb](Event::PostCb cb) {
+    post_cb = std::move(cb);
+  });
+  bool merge_called = false;
+  store_->mergeHistograms([&merge_called]() -> void { merge_called = true; });
+  EXPECT_FALSE(merge_called);
+
+  post_cb();
+  EXPECT_TRUE(merge_called);
+}
+
 TEST_F(HistogramTest, BasicScopeHistogramMerge) {
   ScopeSharedPtr scope1 = store_->createScope("scope1.");
 
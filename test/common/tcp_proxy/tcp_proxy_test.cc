@@ -27,10 +27,12 @@
 #include "test/common/tcp_proxy/tcp_proxy_test_base.h"
 #include "test/common/upstream/utility.h"
 #include "test/mocks/buffer/mocks.h"
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/server/factory_context.h"
 #include "test/mocks/server/instance.h"
+#include "test/mocks/server/overload_manager.h"
 #include "test/mocks/ssl/mocks.h"
 #include "test/mocks/stream_info/mocks.h"
 #include "test/mocks/tcp/mocks.h"
@@ -923,6 +925,90 @@ TEST_F(TcpProxyTest, IdleTimeoutWithOutstandingDataFlushed) {
   idle_timer->invokeCallback();
 }
 
+// Tests that the connection shedder closes the connection while the overload action is active.
+TEST_F(TcpProxyTest, ConnectionShedding) {
+  envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy config =
+      accessLogConfig("%RESPONSE_FLAGS%");
+  config.mutable_connection_shedding();
+  Event::MockTimer* shed_timer =
+      new Event::MockTimer(&factory_context_.server_factory_context_.thread_local_.dispatcher_);
+  setup(1, config);
+
+  EXPECT_CALL(*shed_timer, enableTimer(std::chrono::milliseconds(1000), _));
+  raiseEventUpstreamConnected(0);
+
+  // Nothing is shed while the action is inactive.
+  EXPECT_CALL(*shed_timer, enableTimer(std::chrono::milliseconds(1000), _));
+  shed_timer->invokeCallback();
+  EXPECT_EQ(0U, config_->stats().downstream_cx_overload_shed_.value());
+
+  const Server::OverloadActionState saturated = Server::OverloadActionState::saturated();
+  ON_CALL(factory_context_.server_factory_context_.overload_manager_.overload_state_,
+          getState(Server::OverloadActionNames::get().ShedTcpProxyConnections))
+      .WillByDefault(ReturnRef(saturated));
+  EXPECT_CALL(*upstream_connections_.at(0), close(Network::ConnectionCloseType::NoFlush, _));
+  EXPECT_CALL(filter_callbacks_.connection_,
+              close(Network::ConnectionCloseType::NoFlush,
+                    StreamInfo::LocalCloseReasons::get().TcpSessionShedByOverloadManager));
+  EXPECT_CALL(*shed_timer, disableTimer());
+  EXPECT_CALL(*shed_timer, enableTimer(_, _)).Times(0);
+  shed_timer->invokeCallback();
+  EXPECT_EQ(1U, config_->stats().downstream_cx_overload_shed_.value());
+
+  filter_.reset();
+  EXPECT_EQ(access_log_data_, "OM");
+}
+
+// Tests that the bytes written to the downstream connection are tracked until they are sent.
+TEST_F(TcpProxyTest, ConnectionSheddingTracksBufferedBytes) {
+  envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy config = defaultConfig();
+  config.mutable_connection_shedding();
+  config.mutable_idle_timeout()->set_seconds(0);
+  setup(1, config);
+  raiseEventUpstreamConnected(0);
+
+  Buffer::OwnedImpl buffer("hello");
+  upstream_callbacks_->onUpstreamData(buffer, false);
+  EXPECT_EQ(5U, filter_->bufferedBytes());
+
+  // Bytes sent to the upstream connection don't count.
+  buffer.add("hello2");
+  filter_->onData(buffer, false);
+  EXPECT_EQ(5U, filter_->bufferedBytes());
+
+  filter_callbacks_.connection_.raiseBytesSentCallbacks(3);
+  EXPECT_EQ(2U, filter_->bufferedBytes());
+  filter_callbacks_.connection_.raiseBytesSentCallbacks(3);
+  EXPECT_EQ(0U, filter_->bufferedBytes());
+}
+
+// Tests that the activity of the connection is recorded without an idle timeout.
+TEST_F(TcpProxyTest, ConnectionSheddingTracksActivity) {
+  envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy config = defaultConfig();
+  config.mutable_connection_shedding();
+  config.mutable_idle_timeout()->set_seconds(0);
+  setup(1, config);
+
+  const MonotonicTime connected_time(std::chrono::seconds(10));
+  ON_CALL(filter_callbacks_.connection_.dispatcher_, approximateMonotonicTime())
+      .WillByDefault(Return(connected_time));
+  raiseEventUpstreamConnected(0);
+  EXPECT_EQ(connected_time, filter_->lastActivityTime());
+
+  const MonotonicTime data_time(std::chrono::seconds(20));
+  ON_CALL(filter_callbacks_.connection_.dispatcher_, approximateMonotonicTime())
+      .WillByDefault(Return(data_time));
+  Buffer::OwnedImpl buffer("hello");
+  filter_->onData(buffer, false);
+  EXPECT_EQ(data_time, filter_->lastActivityTime());
+
+  const MonotonicTime sent_time(std::chrono::seconds(30));
+  ON_CALL(filter_callbacks_.connection_.dispatcher_, approximateMonotonicTime())
+      .WillByDefault(Return(sent_time));
+  upstream_connections_.at(0)->raiseBytesSentCallbacks(5);
+  EXPECT_EQ(sent_time, filter_->lastActivityTime());
+}
+
 // Test that Upstream and Downstream Bytes are metered.
 // Checks that %UPSTREAM_WIRE_BYTES_SENT%, %UPSTREAM_WIRE_BYTES_RECEIVED%,
 //  %DOWNSTREAM_WIRE_BYTES_SENT%, and %DOWNSTREAM_WIRE_BYTES_RECEIVED% are
@@ -1494,6 +1580,153 @@ TEST_F(TcpProxyTest, UpstreamStartSecureTransport) {
   filter_->startUpstreamSecureTransport();
 }
 
+class FakeShedderEntry : public ConnectionShedder::Entry {
+public:
+  FakeShedderEntry(ConnectionShedder& shedder, MonotonicTime last_activity_time,
+                   uint64_t buffered_bytes)
+      : shedder_(shedder), last_activity_time_(last_activity_time),
+        buffered_bytes_(buffered_bytes) {
+    shedder_.add(*this);
+  }
+
+  // ConnectionShedder::Entry
+  MonotonicTime lastActivityTime() const override { return last_activity_time_; }
+  uint64_t bufferedBytes() const override { return buffered_bytes_; }
+  void shed() override {
+    shed_ = true;
+    shedder_.remove(*this);
+  }
+
+  ConnectionShedder& shedder_;
+  const MonotonicTime last_activity_time_;
+  const uint64_t buffered_bytes_;
+  bool shed_{};
+};
+
+class ConnectionShedderTest : public testing::Test {
+public:
+  ConnectionShedderTest() {
+    envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy config;
+    config.set_stat_prefix("name");
+    shared_config_ = std::make_shared<Config::SharedConfig>(config, factory_context_);
+    ON_CALL(overload_manager_.overload_state_,
+            getState(Server::OverloadActionNames::get().ShedTcpProxyConnections))
+        .WillByDefault(ReturnRef(action_state_));
+    ON_CALL(dispatcher_, approximateMonotonicTime()).WillByDefault(Return(now_));
+  }
+
+  void initialize(const std::string& yaml) {
+    envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy::ConnectionShedding config;
+    TestUtility::loadFromYaml(yaml, config);
+    timer_ = new Event::MockTimer(&dispatcher_);
+    shedder_ = std::make_unique<ConnectionShedder>(config, shared_config_, overload_manager_,
+                                                   dispatcher_);
+  }
+
+  void setActionValue(float value) {
+    action_state_ = Server::OverloadActionState(UnitFloat(value));
+  }
+
+  uint64_t shedCount() { return shared_config_->stats().downstream_cx_overload_shed_.value(); }
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context_;
+  Config::SharedConfigSharedPtr shared_config_;
+  NiceMock<Server::MockOverloadManager> overload_manager_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  Event::MockTimer* timer_{};
+  std::unique_ptr<ConnectionShedder> shedder_;
+  Server::OverloadActionState action_state_{Server::OverloadActionState::inactive()};
+  const MonotonicTime now_{std::chrono::seconds(100)};
+};
+
+TEST_F(ConnectionShedderTest, ShedsLongestIdleFirst) {
+  initialize(R"EOF(
+interval: 2s
+max_connections_per_interval: 2
+)EOF");
+  EXPECT_CALL(*timer_, enableTimer(std::chrono::milliseconds(2000), _));
+  FakeShedderEntry entry1(*shedder_, now_ - std::chrono::seconds(10), 0);
+  FakeShedderEntry entry2(*shedder_, now_ - std::chrono::seconds(30), 0);
+  FakeShedderEntry entry3(*shedder_, now_ - std::chrono::seconds(20), 0);
+
+  setActionValue(1);
+  EXPECT_CALL(*timer_, enableTimer(std::chrono::milliseconds(2000), _));
+  timer_->invokeCallback();
+  EXPECT_FALSE(entry1.shed_);
+  EXPECT_TRUE(entry2.shed_);
+  EXPECT_TRUE(entry3.shed_);
+  EXPECT_EQ(2U, shedCount());
+}
+
+TEST_F(ConnectionShedderTest, ShedsLargestBufferedFirst) {
+  initialize(R"EOF(
+order: LARGEST_BUFFERED
+max_connections_per_interval: 1
+)EOF");
+  EXPECT_CALL(*timer_, enableTimer(std::chrono::milliseconds(1000), _));
+  FakeShedderEntry entry1(*shedder_, now_ - std::chrono::seconds(30), 10);
+  FakeShedderEntry entry2(*shedder_, now_, 1000);
+  FakeShedderEntry entry3(*shedder_, now_ - std::chrono::seconds(10), 100);
+
+  setActionValue(1);
+  EXPECT_CALL(*timer_, enableTimer(std::chrono::milliseconds(1000), _));
+  timer_->invokeCallback();
+  EXPECT_FALSE(entry1.shed_);
+  EXPECT_TRUE(entry2.shed_);
+  EXPECT_FALSE(entry3.shed_);
+  EXPECT_EQ(1U, shedCount());
+}
+
+// Below saturation, the number of connections shed per interval is scaled by the action value.
+TEST_F(ConnectionShedderTest, ScalesWithActionValue) {
+  initialize(R"EOF(
+max_connections_per_interval: 10
+)EOF");
+  std::vector<std::unique_ptr<FakeShedderEntry>> entries;
+  for (int i = 0; i < 5; ++i) {
+    entries.push_back(std::make_unique<FakeShedderEntry>(*shedder_, now_, 0));
+  }
+
+  timer_->invokeCallback();
+  EXPECT_EQ(0U, shedCount());
+
+  setActionValue(0.25);
+  timer_->invokeCallback();
+  EXPECT_EQ(3U, shedCount());
+
+  setActionValue(1);
+  EXPECT_CALL(*timer_, disableTimer());
+  EXPECT_CALL(*timer_, enableTimer(_, _)).Times(0);
+  timer_->invokeCallback();
+  EXPECT_EQ(5U, shedCount());
+}
+
+TEST_F(ConnectionShedderTest, SkipsRecentlyActiveConnections) {
+  initialize(R"EOF(
+min_idle_time: 5s
+)EOF");
+  FakeShedderEntry entry1(*shedder_, now_ - std::chrono::seconds(1), 0);
+  FakeShedderEntry entry2(*shedder_, now_ - std::chrono::seconds(5), 0);
+
+  setActionValue(1);
+  timer_->invokeCallback();
+  EXPECT_FALSE(entry1.shed_);
+  EXPECT_TRUE(entry2.shed_);
+  EXPECT_EQ(1U, shedCount());
+}
+
+// The timer only runs while there are connections to shed.
+TEST_F(ConnectionShedderTest, DisablesTimerWithoutConnections) {
+  initialize("{}");
+  EXPECT_FALSE(timer_->enabled());
+  {
+    FakeShedderEntry entry(*shedder_, now_, 0);
+    EXPECT_TRUE(timer_->enabled());
+    shedder_->remove(entry);
+    EXPECT_FALSE(timer_->enabled());
+  }
+}
+
 TEST(PerConnectionCluster, ObjectFactory) {
   const std::string name = "envoy.tcp_proxy.cluster";
   auto* factory =
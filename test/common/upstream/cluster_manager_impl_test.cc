@@ -147,7 +147,7 @@ public:
   void shutdownAll() override {}
   std::shared_ptr<Config::GrpcMux>
   create(std::unique_ptr<Grpc::RawAsyncClient>&&, Event::Dispatcher&, Random::RandomGenerator&,
-         Stats::Scope&, const envoy::config::core::v3::ApiConfigSource&,
+         Thread::ThreadFactory&, Stats::Scope&, const envoy::config::core::v3::ApiConfigSource&,
          const LocalInfo::LocalInfo&, std::unique_ptr<Config::CustomConfigValidators>&&,
          BackOffStrategyPtr&&, OptRef<Config::XdsConfigTracker>,
          OptRef<Config::XdsResourcesDelegate>, bool) override {
@@ -603,6 +603,136 @@ TEST_F(ODCDTest, TestMainThreadDiscoveryInProgressDetection) {
       odcds_handle_->requestOnDemandClusterDiscovery("cluster_foo", std::move(cb2), timeout_);
 }
 
+class ODCDIdleEvictionTest : public ODCDTest {
+public:
+  void SetUp() override {
+    Bootstrap bootstrap = defaultConfig();
+    bootstrap.mutable_cluster_manager()->mutable_on_demand_cluster_idle_timeout()->set_seconds(60);
+    create(bootstrap);
+    odcds_ = MockOdCdsApi::create();
+    odcds_handle_ = cluster_manager_->createOdCdsApiHandle(odcds_);
+  }
+
+  uint64_t onDemandClusters() {
+    return factory_.stats_
+        .gauge("cluster_manager.on_demand_clusters", Stats::Gauge::ImportMode::NeverImport)
+        .value();
+  }
+
+  uint64_t evicted() {
+    return factory_.stats_.counter("cluster_manager.on_demand_cluster_evicted").value();
+  }
+};
+
+// Check that an on-demand cluster is only evicted once it has seen no traffic for the idle timeout,
+// that clusters added otherwise are left alone, and that an evicted cluster is discovered again.
+TEST_F(ODCDIdleEvictionTest, EvictsIdleCluster) {
+  auto cb = createCallback(ClusterDiscoveryStatus::Available);
+  EXPECT_CALL(*odcds_, updateOnDemand("cluster_foo")).Times(2);
+  auto handle =
+      odcds_handle_->requestOnDemandClusterDiscovery("cluster_foo", std::move(cb), timeout_);
+  Event::MockTimer* idle_timer = new NiceMock<Event::MockTimer>(&factory_.dispatcher_);
+  EXPECT_CALL(*idle_timer, enableTimer(std::chrono::milliseconds(60000), _)).Times(2);
+  cluster_manager_->addOrUpdateCluster(defaultStaticCluster("cluster_foo"), "version1");
+  cluster_manager_->addOrUpdateCluster(defaultStaticCluster("cluster_bar"), "version1");
+  EXPECT_EQ(callback_call_count_, 1);
+  EXPECT_EQ(1, onDemandClusters());
+  handle.reset();
+
+  // New connections since the previous scan keep the cluster around.
+  cluster_manager_->getThreadLocalCluster("cluster_foo")
+      ->info()
+      ->trafficStats()
+      ->upstream_cx_total_.inc();
+  time_system_.advanceTimeWait(std::chrono::seconds(60));
+  idle_timer->invokeCallback();
+  EXPECT_NE(nullptr, cluster_manager_->getThreadLocalCluster("cluster_foo"));
+  EXPECT_EQ(0, evicted());
+
+  EXPECT_CALL(*odcds_, removeOnDemand("cluster_foo"));
+  time_system_.advanceTimeWait(std::chrono::seconds(60));
+  idle_timer->invokeCallback();
+  EXPECT_EQ(nullptr, cluster_manager_->getThreadLocalCluster("cluster_foo"));
+  EXPECT_NE(nullptr, cluster_manager_->getThreadLocalCluster("cluster_bar"));
+  EXPECT_EQ(1, evicted());
+  EXPECT_EQ(0, onDemandClusters());
+  EXPECT_EQ(1, factory_.stats_.counter("cluster_manager.cluster_removed").value());
+
+  cb = createCallback();
+  handle = odcds_handle_->requestOnDemandClusterDiscovery("cluster_foo", std::move(cb), timeout_);
+  EXPECT_EQ(callback_call_count_, 1);
+}
+
+// Check that a cluster the management server pushes again after its eviction is tracked and evicted
+// like a requested one.
+TEST_F(ODCDIdleEvictionTest, EvictsPushedCluster) {
+  auto cb = createCallback(ClusterDiscoveryStatus::Available);
+  EXPECT_CALL(*odcds_, updateOnDemand("cluster_foo"));
+  auto handle =
+      odcds_handle_->requestOnDemandClusterDiscovery("cluster_foo", std::move(cb), timeout_);
+  Event::MockTimer* idle_timer = new NiceMock<Event::MockTimer>(&factory_.dispatcher_);
+  cluster_manager_->notifyOnDemandCluster("cluster_foo", odcds_);
+  cluster_manager_->addOrUpdateCluster(defaultStaticCluster("cluster_foo"), "version1");
+  EXPECT_EQ(callback_call_count_, 1);
+  handle.reset();
+
+  EXPECT_CALL(*odcds_, removeOnDemand("cluster_foo")).Times(2);
+  time_system_.advanceTimeWait(std::chrono::seconds(60));
+  idle_timer->invokeCallback();
+  EXPECT_EQ(nullptr, cluster_manager_->getThreadLocalCluster("cluster_foo"));
+  EXPECT_EQ(1, evicted());
+
+  // The push is not a result of a discovery, but the cluster still comes from the on-demand CDS.
+  cluster_manager_->notifyOnDemandCluster("cluster_foo", odcds_);
+  cluster_manager_->addOrUpdateCluster(defaultStaticCluster("cluster_foo"), "version2");
+  EXPECT_NE(nullptr, cluster_manager_->getThreadLocalCluster("cluster_foo"));
+  EXPECT_EQ(1, onDemandClusters());
+  EXPECT_TRUE(idle_timer->enabled());
+
+  time_system_.advanceTimeWait(std::chrono::seconds(60));
+  idle_timer->invokeCallback();
+  EXPECT_EQ(nullptr, cluster_manager_->getThreadLocalCluster("cluster_foo"));
+  EXPECT_EQ(2, evicted());
+  EXPECT_EQ(0, onDemandClusters());
+}
+
+// Check that an on-demand push that doesn't update the cluster doesn't mark a later update of it
+// as on-demand.
+TEST_F(ODCDIdleEvictionTest, IgnoresBlockedPush) {
+  envoy::config::cluster::v3::Cluster cluster = defaultStaticCluster("cluster_foo");
+  EXPECT_TRUE(cluster_manager_->addOrUpdateCluster(cluster, "version1"));
+
+  cluster_manager_->notifyOnDemandCluster("cluster_foo", odcds_);
+  EXPECT_FALSE(cluster_manager_->addOrUpdateCluster(cluster, "version1"));
+
+  cluster.mutable_connect_timeout()->set_seconds(5);
+  EXPECT_TRUE(cluster_manager_->addOrUpdateCluster(cluster, "version2"));
+  EXPECT_NE(nullptr, cluster_manager_->getThreadLocalCluster("cluster_foo"));
+  EXPECT_EQ(0, onDemandClusters());
+}
+
+// Check that clusters with in-flight connections are not evicted.
+TEST_F(ODCDIdleEvictionTest, KeepsActiveCluster) {
+  auto cb = createCallback(ClusterDiscoveryStatus::Available);
+  EXPECT_CALL(*odcds_, updateOnDemand("cluster_foo"));
+  auto handle =
+      odcds_handle_->requestOnDemandClusterDiscovery("cluster_foo", std::move(cb), timeout_);
+  Event::MockTimer* idle_timer = new NiceMock<Event::MockTimer>(&factory_.dispatcher_);
+  cluster_manager_->addOrUpdateCluster(defaultStaticCluster("cluster_foo"), "version1");
+
+  cluster_manager_->getThreadLocalCluster("cluster_foo")
+      ->info()
+      ->trafficStats()
+      ->upstream_cx_active_.inc();
+  for (int i = 0; i < 3; ++i) {
+    time_system_.advanceTimeWait(std::chrono::seconds(60));
+    idle_timer->invokeCallback();
+  }
+  EXPECT_NE(nullptr, cluster_manager_->getThreadLocalCluster("cluster_foo"));
+  EXPECT_EQ(0, evicted());
+  EXPECT_EQ(1, onDemandClusters());
+}
+
 class AlpnSocketFactory : public Network::RawBufferSocketFactory {
 public:
   bool supportsAlpn() const override { return true; }
@@ -4873,8 +5003,10 @@ public:
     added_or_updated_ = true;
   }
   bool requiredForAds() const override { return required_for_ads_; }
+  std::vector<HostSetDeltaTracker>& postedHostSets() override { return posted_host_sets_; }
 
   NiceMock<MockClusterMockPrioritySet> cluster_;
+  std::vector<HostSetDeltaTracker> posted_host_sets_;
   bool added_or_updated_{};
   bool required_for_ads_{};
 };
@@ -34,6 +34,7 @@
 #include "test/mocks/protobuf/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/server/factory_context.h"
+#include "test/mocks/server/health_checker_factory_context.h"
 #include "test/mocks/upstream/cluster_info.h"
 #include "test/mocks/upstream/cluster_priority_set.h"
 #include "test/mocks/upstream/health_check_event_logger.h"
@@ -4220,6 +4221,84 @@ TEST_F(TcpHealthCheckerImplTest, Success) {
   read_filter_->onData(response, false);
 }
 
+// Two clusters with the same health check config and endpoint share a single probe, and the
+// second cluster takes over probing when the first one's host goes away.
+TEST_F(TcpHealthCheckerImplTest, SharedAcrossClusters) {
+  InSequence s;
+
+  const std::string yaml = R"EOF(
+    timeout: 1s
+    interval: 1s
+    unhealthy_threshold: 2
+    healthy_threshold: 2
+    share_across_clusters: true
+    tcp_health_check:
+      send:
+        text: "01"
+      receive:
+      - text: "02"
+    )EOF";
+  const envoy::config::core::v3::HealthCheck config = parseHealthCheckFromV3Yaml(yaml);
+  NiceMock<Server::Configuration::MockHealthCheckerFactoryContext> context;
+
+  allocHealthChecker(yaml);
+  health_checker_->initSharedSessions(config, context);
+  auto other_cluster = std::make_shared<NiceMock<MockClusterMockPrioritySet>>();
+  auto other_checker = std::make_shared<TcpHealthCheckerImpl>(*other_cluster, config, dispatcher_,
+                                                              runtime_, random_, nullptr);
+  other_checker->initSharedSessions(config, context);
+
+  cluster_->prioritySet().getMockHostSet(0)->hosts_ = {
+      makeTestHost(cluster_->info_, "tcp://127.0.0.1:80", simTime())};
+  other_cluster->prioritySet().getMockHostSet(0)->hosts_ = {
+      makeTestHost(other_cluster->info_, "tcp://127.0.0.1:80", simTime())};
+
+  expectSessionCreate();
+  expectClientCreate();
+  EXPECT_CALL(*connection_, write(_, _));
+  EXPECT_CALL(*timeout_timer_, enableTimer(_, _));
+  health_checker_->start();
+
+  // The second cluster's session follows the first and does not connect on its own.
+  Event::MockTimer* other_interval_timer = new Event::MockTimer(&dispatcher_);
+  Event::MockTimer* other_timeout_timer = new Event::MockTimer(&dispatcher_);
+  other_checker->start();
+  EXPECT_FALSE(other_interval_timer->enabled_);
+
+  connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  // The result is applied to both clusters' hosts.
+  EXPECT_CALL(*other_interval_timer, disableTimer());
+  EXPECT_CALL(*timeout_timer_, disableTimer());
+  EXPECT_CALL(*interval_timer_, enableTimer(_, _));
+  Buffer::OwnedImpl response;
+  addUint8(response, 2);
+  read_filter_->onData(response, false);
+
+  EXPECT_EQ(1UL, cluster_->info_->stats_store_.counter("health_check.attempt").value());
+  EXPECT_EQ(1UL, cluster_->info_->stats_store_.counter("health_check.success").value());
+  EXPECT_EQ(0UL, other_cluster->info_->stats_store_.counter("health_check.attempt").value());
+  EXPECT_EQ(1UL, other_cluster->info_->stats_store_.counter("health_check.success").value());
+  EXPECT_EQ(1UL, TestUtility::findCounter(context.server_context_.store_,
+                                          "health_check.shared.fanout")
+                     ->value());
+
+  // Removing the leading cluster's host hands probing over to the other cluster.
+  EXPECT_CALL(*other_interval_timer, enableTimer(_, _));
+  HostVector removed{cluster_->prioritySet().getMockHostSet(0)->hosts_.back()};
+  cluster_->prioritySet().getMockHostSet(0)->hosts_.clear();
+  cluster_->prioritySet().getMockHostSet(0)->runCallbacks({}, removed);
+  EXPECT_EQ(1UL, TestUtility::findCounter(context.server_context_.store_,
+                                          "health_check.shared.leader_handoff")
+                     ->value());
+
+  expectClientCreate();
+  EXPECT_CALL(*connection_, write(_, _));
+  EXPECT_CALL(*other_timeout_timer, enableTimer(_, _));
+  other_interval_timer->invokeCallback();
+  EXPECT_EQ(1UL, other_cluster->info_->stats_store_.counter("health_check.attempt").value());
+}
+
 // Tests that a successful healthcheck will disconnect the client when reuse_connection is false.
 TEST_F(TcpHealthCheckerImplTest, DataWithoutReusingConnection) {
   InSequence s;
@@ -2771,6 +2771,106 @@ TEST_P(RoundRobinLoadBalancerTest, SlowStartNoWaitMinWeightPercent35) {
   EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
 }
 
+// Tests for load balancers over a real priority set, updated with the deltas the cluster manager
+// sends to workers.
+class EdfLoadBalancerDeltaTest : public Event::TestUsingSimulatedTime, public testing::Test {
+protected:
+  EdfLoadBalancerDeltaTest()
+      : stat_names_(stats_store_.symbolTable()), stats_(stat_names_, *stats_store_.rootScope()) {
+    priority_set_.getOrCreateHostSet(0);
+  }
+
+  // Updates priority 0 with hosts, all of them healthy. Returns whether the update had a delta.
+  bool update(const HostVector& hosts) {
+    auto params = updateHostsParams(std::make_shared<const HostVector>(hosts),
+                                    HostsPerLocalityImpl::empty(),
+                                    std::make_shared<const HealthyHostVector>(hosts),
+                                    HostsPerLocalityImpl::empty());
+    params.delta = tracker_.update(params);
+    const bool has_delta = params.delta != nullptr;
+    priority_set_.updateHosts(0, std::move(params), {}, {}, {}, absl::nullopt, absl::nullopt);
+    return has_delta;
+  }
+
+  absl::flat_hash_map<HostConstSharedPtr, uint32_t> pick(LoadBalancer& lb, uint32_t picks) {
+    absl::flat_hash_map<HostConstSharedPtr, uint32_t> counts;
+    for (uint32_t i = 0; i < picks; ++i) {
+      ++counts[lb.chooseHost(nullptr)];
+    }
+    return counts;
+  }
+
+  HostSharedPtr makeHost(uint32_t index, uint32_t weight) {
+    return makeTestHost(info_, fmt::format("tcp://127.0.0.{}:80", index), simTime(), weight);
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+  ClusterLbStatNames stat_names_;
+  ClusterLbStats stats_;
+  NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<Random::MockRandomGenerator> random_;
+  PrioritySetImpl priority_set_;
+  HostSetDeltaTracker tracker_;
+  std::shared_ptr<MockClusterInfo> info_{new NiceMock<MockClusterInfo>()};
+  envoy::config::cluster::v3::Cluster::CommonLbConfig common_config_;
+};
+
+// A removed host is no longer scheduled, and an added host is scheduled with its weight.
+TEST_F(EdfLoadBalancerDeltaTest, RoundRobinWeighted) {
+  HostSharedPtr host1 = makeHost(1, 1);
+  HostSharedPtr host2 = makeHost(2, 2);
+  HostSharedPtr host3 = makeHost(3, 3);
+  HostSharedPtr host4 = makeHost(4, 3);
+  update({host1, host2, host3});
+  RoundRobinLoadBalancer lb(priority_set_, nullptr, stats_, runtime_, random_, common_config_,
+                            absl::nullopt, simTime());
+  pick(lb, 5);
+
+  EXPECT_TRUE(update({host1, host2, host4}));
+  auto counts = pick(lb, 60);
+  EXPECT_EQ(0, counts[host3]);
+  EXPECT_NEAR(10, counts[host1], 1);
+  EXPECT_NEAR(20, counts[host2], 1);
+  EXPECT_NEAR(30, counts[host4], 1);
+}
+
+// Adding a host with a different weight to equally weighted hosts switches to weighted picks.
+TEST_F(EdfLoadBalancerDeltaTest, RoundRobinUnweightedToWeighted) {
+  HostSharedPtr host1 = makeHost(1, 1);
+  HostSharedPtr host2 = makeHost(2, 1);
+  HostSharedPtr host3 = makeHost(3, 1);
+  HostSharedPtr host4 = makeHost(4, 1);
+  HostSharedPtr host5 = makeHost(5, 6);
+  update({host1, host2, host3, host4});
+  RoundRobinLoadBalancer lb(priority_set_, nullptr, stats_, runtime_, random_, common_config_,
+                            absl::nullopt, simTime());
+  auto counts = pick(lb, 4);
+  EXPECT_EQ(1, counts[host1]);
+  EXPECT_EQ(1, counts[host4]);
+
+  EXPECT_TRUE(update({host1, host2, host3, host5}));
+  counts = pick(lb, 90);
+  EXPECT_EQ(0, counts[host4]);
+  EXPECT_NEAR(60, counts[host5], 1);
+  EXPECT_NEAR(10, counts[host1], 1);
+}
+
+TEST_F(EdfLoadBalancerDeltaTest, LeastRequestWeighted) {
+  HostSharedPtr host1 = makeHost(1, 1);
+  HostSharedPtr host2 = makeHost(2, 3);
+  HostSharedPtr host3 = makeHost(3, 3);
+  update({host1, host2, host3});
+  LeastRequestLoadBalancer lb(priority_set_, nullptr, stats_, runtime_, random_, common_config_,
+                              absl::nullopt, simTime());
+  pick(lb, 3);
+
+  EXPECT_TRUE(update({host1, host2}));
+  auto counts = pick(lb, 40);
+  EXPECT_EQ(0, counts[host3]);
+  EXPECT_NEAR(10, counts[host1], 1);
+  EXPECT_NEAR(30, counts[host2], 1);
+}
+
 class LeastRequestLoadBalancerTest : public LoadBalancerTestBase {
 public:
   LeastRequestLoadBalancer lb_{
@@ -17,6 +17,7 @@ namespace {
 
 using ::testing::ElementsAre;
 using ::testing::InSequence;
+using ::testing::Invoke;
 using ::testing::UnorderedElementsAre;
 
 class OdCdsApiImplTest : public testing::Test {
@@ -134,6 +135,36 @@ TEST_F(OdCdsApiImplTest, OnDemandUpdateIsRequestedAfterInitialFetch) {
   odcds_->updateOnDemand("another_cluster");
 }
 
+// Check that the interest in a cluster is withdrawn after receiving the initial response.
+TEST_F(OdCdsApiImplTest, OnDemandRemovalIsRequestedAfterInitialFetch) {
+  InSequence s;
+
+  odcds_->updateOnDemand("fake_cluster");
+  envoy::config::cluster::v3::Cluster cluster;
+  cluster.set_name("fake_cluster");
+  const auto decoded_resources = TestUtility::decodeResources({cluster});
+  ASSERT_TRUE(odcds_callbacks_->onConfigUpdate(decoded_resources.refvec_, {}, "0").ok());
+  EXPECT_CALL(*cm_.subscription_factory_.subscription_,
+              requestOnDemandRemoval(UnorderedElementsAre("fake_cluster")));
+  odcds_->removeOnDemand("fake_cluster");
+}
+
+// Check that a removed cluster name is dropped from the awaiting list.
+TEST_F(OdCdsApiImplTest, OnDemandRemovalDropsAwaitingName) {
+  InSequence s;
+
+  odcds_->updateOnDemand("fake_cluster");
+  odcds_->updateOnDemand("another_cluster_1");
+  odcds_->updateOnDemand("another_cluster_2");
+  EXPECT_CALL(*cm_.subscription_factory_.subscription_, requestOnDemandRemoval(_)).Times(0);
+  odcds_->removeOnDemand("another_cluster_1");
+
+  EXPECT_CALL(*cm_.subscription_factory_.subscription_,
+              requestOnDemandUpdate(UnorderedElementsAre("another_cluster_2")));
+  odcds_callbacks_->onConfigUpdateFailed(Envoy::Config::ConfigUpdateFailureReason::FetchTimedout,
+                                         nullptr);
+}
+
 // Check that we report an error when we received a duplicated cluster.
 TEST_F(OdCdsApiImplTest, ValidateDuplicateClusters) {
   InSequence s;
@@ -158,6 +189,26 @@ TEST_F(OdCdsApiImplTest, NotifierGetsUsed) {
   ASSERT_TRUE(odcds_callbacks_->onConfigUpdate({}, removed, "").ok());
 }
 
+// Check that notifier learns about every received cluster before it is added to the cluster
+// manager, including the ones that were not requested.
+TEST_F(OdCdsApiImplTest, NotifierGetsReceivedClusters) {
+  InSequence s;
+
+  odcds_->updateOnDemand("cluster");
+  envoy::config::cluster::v3::Cluster cluster;
+  cluster.set_name("cluster");
+  envoy::config::cluster::v3::Cluster pushed_cluster;
+  pushed_cluster.set_name("pushed_cluster");
+  const auto decoded_resources = TestUtility::decodeResources({cluster, pushed_cluster});
+  EXPECT_CALL(notifier_, notifyOnDemandCluster("cluster", _))
+      .WillOnce(Invoke([this](absl::string_view, OdCdsApiWeakPtr odcds) {
+        EXPECT_EQ(odcds_, odcds.lock());
+      }));
+  EXPECT_CALL(notifier_, notifyOnDemandCluster("pushed_cluster", _));
+  EXPECT_CALL(cm_, addOrUpdateCluster(_, _)).Times(2);
+  ASSERT_TRUE(odcds_callbacks_->onConfigUpdate(decoded_resources.refvec_, {}, "0").ok());
+}
+
 // Check that notifier won't be used for a requested cluster that did
 // not appear in the response.
 TEST_F(OdCdsApiImplTest, NotifierNotUsed) {
@@ -3684,6 +3684,84 @@ TEST(PrioritySet, MainPrioritySetTest) {
   EXPECT_EQ(nullptr, priority_set.mutableHostMapForTest().get());
 }
 
+// Test that the delta tracker only returns deltas that are cheaper to apply than a rebuild.
+TEST(HostSetDeltaTracker, Delta) {
+  std::shared_ptr<MockClusterInfo> info{new NiceMock<MockClusterInfo>()};
+  NiceMock<MockTimeSystem> time_source;
+  HostVector hosts;
+  for (uint32_t i = 0; i < 8; ++i) {
+    hosts.push_back(makeTestHost(info, fmt::format("tcp://127.0.0.{}:80", i + 1), time_source));
+  }
+  const auto params = [](const HostVector& hosts) {
+    return updateHostsParams(std::make_shared<const HostVector>(hosts),
+                             HostsPerLocalityImpl::empty(),
+                             std::make_shared<const HealthyHostVector>(hosts),
+                             HostsPerLocalityImpl::empty());
+  };
+
+  HostSetDeltaTracker tracker;
+  // Nothing to compare the first update with.
+  EXPECT_EQ(nullptr, tracker.update(params({hosts[0], hosts[1], hosts[2], hosts[3]})));
+
+  // Replacing one host.
+  {
+    const auto delta = tracker.update(params({hosts[0], hosts[1], hosts[2], hosts[4]}));
+    ASSERT_NE(nullptr, delta);
+    EXPECT_EQ(HostVector({hosts[4]}), delta->hosts_added_);
+    EXPECT_EQ(HostVector({hosts[3]}), delta->hosts_removed_);
+    EXPECT_EQ(HostVector({hosts[4]}), delta->healthy_hosts_added_);
+    EXPECT_EQ(HostVector({hosts[3]}), delta->healthy_hosts_removed_);
+    EXPECT_TRUE(delta->degraded_hosts_added_.empty());
+    EXPECT_TRUE(delta->degraded_hosts_removed_.empty());
+  }
+
+  // A weight changed in place is not visible in the membership, so no delta is possible.
+  hosts[0]->weight(5);
+  EXPECT_EQ(nullptr, tracker.update(params({hosts[0], hosts[1], hosts[2], hosts[4]})));
+  EXPECT_NE(nullptr, tracker.update(params({hosts[0], hosts[1], hosts[2], hosts[4]})));
+
+  // Replacing most hosts is cheaper as a rebuild.
+  EXPECT_EQ(nullptr, tracker.update(params({hosts[0], hosts[5], hosts[6], hosts[7]})));
+}
+
+// Test that a host set only exposes a delta during the callbacks of an update, and only if the
+// delta was computed against the lists the host set held.
+TEST(HostSetDeltaTracker, HostSetUpdateDelta) {
+  PrioritySetImpl priority_set;
+  const HostSet& host_set = priority_set.getOrCreateHostSet(0);
+  std::shared_ptr<MockClusterInfo> info{new NiceMock<MockClusterInfo>()};
+  NiceMock<MockTimeSystem> time_source;
+  HostSharedPtr host1 = makeTestHost(info, "tcp://127.0.0.1:80", time_source);
+  HostSharedPtr host2 = makeTestHost(info, "tcp://127.0.0.2:80", time_source);
+  HostSharedPtr host3 = makeTestHost(info, "tcp://127.0.0.3:80", time_source);
+
+  bool saw_delta = false;
+  auto priority_update_cb = priority_set.addPriorityUpdateCb(
+      [&](uint32_t, const HostVector&, const HostVector&) -> void {
+        saw_delta = host_set.updateDelta() != nullptr;
+      });
+  const auto update = [&](HostSetDeltaTracker& tracker, const HostVector& hosts) {
+    auto params = updateHostsParams(std::make_shared<const HostVector>(hosts),
+                                    HostsPerLocalityImpl::empty());
+    params.delta = tracker.update(params);
+    priority_set.updateHosts(0, std::move(params), {}, {}, {}, absl::nullopt, absl::nullopt);
+  };
+
+  HostSetDeltaTracker tracker;
+  update(tracker, {host1, host2});
+  EXPECT_FALSE(saw_delta);
+  update(tracker, {host1, host2, host3});
+  EXPECT_TRUE(saw_delta);
+  EXPECT_EQ(nullptr, host_set.updateDelta());
+
+  // A delta against lists the host set never held is ignored.
+  HostSetDeltaTracker other_tracker;
+  other_tracker.update(updateHostsParams(std::make_shared<const HostVector>(HostVector{host1}),
+                                         HostsPerLocalityImpl::empty()));
+  update(other_tracker, {host1, host3});
+  EXPECT_FALSE(saw_delta);
+}
+
 class ClusterInfoImplTest : public testing::Test {
 public:
   ClusterInfoImplTest() { ON_CALL(server_context_, api()).WillByDefault(ReturnRef(*api_)); }
@@ -13,6 +13,7 @@
 #include "source/common/config/protobuf_link_hacks.h"
 #include "source/common/config/utility.h"
 #include "source/common/singleton/manager_impl.h"
+#include "source/common/upstream/load_balancer_impl.h"
 #include "source/extensions/clusters/eds/eds.h"
 #include "source/extensions/config_subscription/grpc/grpc_mux_impl.h"
 #include "source/extensions/config_subscription/grpc/grpc_subscription_impl.h"
@@ -90,6 +91,11 @@ public:
     cluster_->initialize([this] { initialized_ = true; });
     EXPECT_CALL(*async_client_, startRaw(_, _, _, _)).WillOnce(testing::Return(&async_stream_));
     subscription_->start({"fare"});
+
+    worker_priority_set_.getOrCreateHostSet(1);
+    worker_lb_ = std::make_unique<RoundRobinLoadBalancer>(
+        worker_priority_set_, nullptr, lb_stats_, runtime_, random_, common_lb_config_,
+        absl::nullopt, server_context_.api_.timeSource());
   }
 
   void resetCluster(const std::string& yaml_config, Cluster::InitializePhase initialize_phase) {
@@ -114,7 +120,17 @@ public:
   void priorityAndLocalityWeightedHelper(bool ignore_unknown_dynamic_fields, size_t num_hosts,
                                          bool healthy) {
     state_.PauseTiming();
+    auto response = buildResponse(ignore_unknown_dynamic_fields, num_hosts, healthy);
+    state_.ResumeTiming();
+    deliver(std::move(response), num_hosts);
+  }
 
+  // Builds an EDS response with num_hosts hosts in a single locality at priority 1. If weighted,
+  // hosts get differing weights. If replace_first_host, the first host has a different address
+  // than in a response built without it.
+  std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse>
+  buildResponse(bool ignore_unknown_dynamic_fields, size_t num_hosts, bool healthy,
+                bool weighted = false, bool replace_first_host = false) {
     envoy::config::endpoint::v3::ClusterLoadAssignment cluster_load_assignment;
     cluster_load_assignment.set_cluster_name("fare");
 
@@ -135,9 +151,16 @@ public:
       } else {
         lb_endpoint->set_health_status(envoy::config::core::v3::UNHEALTHY);
       }
+      if (weighted) {
+        lb_endpoint->mutable_load_balancing_weight()->set_value(1 + i % 3);
+      }
       auto* socket_address =
           lb_endpoint->mutable_endpoint()->mutable_address()->mutable_socket_address();
-      socket_address->set_address("10.0.1." + std::to_string(i / 60000));
+      if (replace_first_host && i == 0) {
+        socket_address->set_address("10.0.2.0");
+      } else {
+        socket_address->set_address("10.0.1." + std::to_string(i / 60000));
+      }
       socket_address->set_port_value((port + i) % 60000);
     }
 
@@ -149,7 +172,11 @@ public:
     response->set_version_info(fmt::format("version-{}", version_++));
     auto* resource = response->mutable_resources()->Add();
     resource->PackFrom(cluster_load_assignment);
-    state_.ResumeTiming();
+    return response;
+  }
+
+  void deliver(std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse>&& response,
+               size_t num_hosts) {
     if (use_unified_mux_) {
       dynamic_cast<Config::XdsMux::GrpcMuxSotw&>(*grpc_mux_)
           .grpcStreamForTest()
@@ -163,6 +190,26 @@ public:
            num_hosts);
   }
 
+  // Builds the update the cluster manager posts to workers for the current priority 1 hosts of the
+  // cluster, with or without the delta against the previously posted update.
+  PrioritySet::UpdateHostsParams workerUpdate(bool use_delta) {
+    const HostSet& host_set = *cluster_->prioritySet().hostSetsPerPriority()[1];
+    PrioritySet::UpdateHostsParams params = HostSetImpl::updateHostsParams(host_set);
+    HostSetDeltaConstSharedPtr delta = posted_host_set_.update(params);
+    if (use_delta) {
+      params.delta = std::move(delta);
+    }
+    return params;
+  }
+
+  // Applies an update the way a worker does, refreshing the worker load balancer.
+  void applyOnWorker(PrioritySet::UpdateHostsParams&& params) {
+    worker_priority_set_.updateHosts(
+        1, std::move(params),
+        cluster_->prioritySet().hostSetsPerPriority()[1]->localityWeights(), {}, {},
+        absl::nullopt, absl::nullopt);
+  }
+
   NiceMock<Server::Configuration::MockServerFactoryContext> server_context_;
   Stats::TestUtil::TestStore& stats_ = server_context_.store_;
 
@@ -189,6 +236,13 @@ public:
   Config::GrpcMuxSharedPtr grpc_mux_;
   Config::GrpcSubscriptionImplPtr subscription_;
   NiceMock<AccessLog::MockAccessLogManager> access_log_manager_;
+  ClusterLbStatNames lb_stat_names_{stats_.symbolTable()};
+  ClusterLbStats lb_stats_{lb_stat_names_, scope_};
+  NiceMock<Runtime::MockLoader> runtime_;
+  envoy::config::cluster::v3::Cluster::CommonLbConfig common_lb_config_;
+  HostSetDeltaTracker posted_host_set_;
+  PrioritySetImpl worker_priority_set_;
+  std::unique_ptr<RoundRobinLoadBalancer> worker_lb_;
 };
 
 } // namespace Upstream
@@ -241,3 +295,32 @@ static void healthOnlyUpdate(State& state) {
 }
 
 BENCHMARK(healthOnlyUpdate)->Ranges({{1, 100000}, {false, true}})->Unit(benchmark::kMillisecond);
+
+// Measures only the cost for a worker to apply an update that replaces a single host of a weighted
+// cluster, with and without the delta the cluster manager sends along with the host lists.
+static void singleHostWorkerUpdate(State& state) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Context logging_state(spdlog::level::warn,
+                                       Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock, false);
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    state.PauseTiming();
+    auto speed_test = std::make_unique<Envoy::Upstream::EdsSpeedTest>(state, false);
+    uint32_t endpoints = skipExpensiveBenchmarks() ? 1 : state.range(0);
+
+    speed_test->deliver(speed_test->buildResponse(true, endpoints, true, true), endpoints);
+    speed_test->applyOnWorker(speed_test->workerUpdate(state.range(1)));
+    speed_test->deliver(speed_test->buildResponse(true, endpoints, true, true, true), endpoints);
+    auto params = speed_test->workerUpdate(state.range(1));
+    state.ResumeTiming();
+
+    speed_test->applyOnWorker(std::move(params));
+
+    state.PauseTiming();
+    speed_test.reset();
+    state.ResumeTiming();
+  }
+}
+
+BENCHMARK(singleHostWorkerUpdate)
+    ->Ranges({{1, 100000}, {false, true}})
+    ->Unit(benchmark::kMicrosecond);
@@ -1,8 +1,10 @@
 #include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/hex.h"
+#include "source/common/stats/isolated_store_impl.h"
 #include "source/extensions/compression/gzip/compressor/config.h"
 #include "source/extensions/compression/gzip/compressor/zlib_compressor_impl.h"
 
+#include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/utility.h"
 
 #include "absl/container/fixed_array.h"
@@ -150,8 +152,10 @@ TEST_P(ZlibCompressorImplFactoryTest, CreateCompressorTest) {
                        strategy, compression_level);
   }
   TestUtility::loadFromJson(json, gzip);
+  testing::NiceMock<ThreadLocal::MockInstance> tls;
+  Stats::IsolatedStoreImpl store;
   Envoy::Compression::Compressor::CompressorPtr compressor =
-      GzipCompressorFactory(gzip).createCompressor();
+      GzipCompressorFactory(gzip, tls, *store.rootScope()).createCompressor();
   // Check the created compressor produces valid output.
   TestUtility::feedBufferWithRandomCharacters(buffer, 4096);
   compressor->compress(buffer, Envoy::Compression::Compressor::State::Flush);
@@ -257,6 +261,106 @@ TEST_F(ZlibCompressorImplTest, CompressWithNotCommonParams) {
   expectValidFinishedBuffer(accumulation_buffer, input_size);
 }
 
+// Exercises resetting the compressor, both after a finished stream and in the middle of one.
+TEST_F(ZlibCompressorImplTest, CompressAfterReset) {
+  Buffer::OwnedImpl buffer;
+
+  ZlibCompressorImplTester compressor;
+  compressor.init(ZlibCompressorImpl::CompressionLevel::Standard,
+                  ZlibCompressorImpl::CompressionStrategy::Standard, gzip_window_bits,
+                  memory_level);
+  TestUtility::feedBufferWithRandomCharacters(buffer, 4096);
+  compressor.finish(buffer);
+  const std::string first_output = buffer.toString();
+  drainBuffer(buffer);
+
+  ASSERT_TRUE(compressor.reset());
+  TestUtility::feedBufferWithRandomCharacters(buffer, 4096);
+  compressor.compressThenFlush(buffer);
+  drainBuffer(buffer);
+
+  // The same input compresses to the same output as in the first stream.
+  ASSERT_TRUE(compressor.reset());
+  TestUtility::feedBufferWithRandomCharacters(buffer, 4096);
+  compressor.finish(buffer);
+  expectValidFinishedBuffer(buffer, 4096);
+  EXPECT_EQ(first_output, buffer.toString());
+}
+
+class GzipCompressorFactoryPoolTest : public testing::Test {
+protected:
+  std::unique_ptr<GzipCompressorFactory> makeFactory(uint32_t context_pool_size) {
+    envoy::extensions::compression::gzip::compressor::v3::Gzip gzip;
+    gzip.mutable_context_pool_size()->set_value(context_pool_size);
+    return std::make_unique<GzipCompressorFactory>(gzip, tls_, *store_.rootScope());
+  }
+
+  uint64_t counter(const std::string& name) {
+    return TestUtility::findCounter(store_, "gzip.compressor_context_pool." + name)->value();
+  }
+
+  static std::string compressAll(Envoy::Compression::Compressor::Compressor& compressor,
+                                 uint32_t input_size) {
+    Buffer::OwnedImpl buffer;
+    TestUtility::feedBufferWithRandomCharacters(buffer, input_size);
+    compressor.compress(buffer, Envoy::Compression::Compressor::State::Finish);
+    expectValidFinishedBuffer(buffer, input_size);
+    return buffer.toString();
+  }
+
+  testing::NiceMock<ThreadLocal::MockInstance> tls_;
+  Stats::IsolatedStoreImpl store_;
+};
+
+// Streams reuse the contexts of finished streams, and compress as new contexts do.
+TEST_F(GzipCompressorFactoryPoolTest, ReusesContexts) {
+  auto factory = makeFactory(4);
+  const std::string expected_output = compressAll(*makeFactory(0)->createCompressor(), 1024);
+
+  EXPECT_EQ(expected_output, compressAll(*factory->createCompressor(), 1024));
+  EXPECT_EQ(0, counter("hits"));
+  EXPECT_EQ(1, counter("misses"));
+  EXPECT_EQ(expected_output, compressAll(*factory->createCompressor(), 1024));
+  EXPECT_EQ(1, counter("hits"));
+  EXPECT_EQ(1, counter("misses"));
+
+  // A context released in the middle of a stream is reset as well.
+  {
+    Envoy::Compression::Compressor::CompressorPtr compressor = factory->createCompressor();
+    Buffer::OwnedImpl buffer;
+    TestUtility::feedBufferWithRandomCharacters(buffer, 512);
+    compressor->compress(buffer, Envoy::Compression::Compressor::State::Flush);
+  }
+  EXPECT_EQ(expected_output, compressAll(*factory->createCompressor(), 1024));
+  EXPECT_EQ(3, counter("hits"));
+  EXPECT_EQ(1, counter("misses"));
+}
+
+// The pool of a worker keeps no more idle contexts than configured.
+TEST_F(GzipCompressorFactoryPoolTest, BoundsIdleContexts) {
+  auto factory = makeFactory(1);
+  {
+    auto first = factory->createCompressor();
+    auto second = factory->createCompressor();
+  }
+  EXPECT_EQ(0, counter("hits"));
+  EXPECT_EQ(2, counter("misses"));
+  {
+    auto first = factory->createCompressor();
+    auto second = factory->createCompressor();
+  }
+  EXPECT_EQ(1, counter("hits"));
+  EXPECT_EQ(3, counter("misses"));
+}
+
+// Contexts released after the factory was destroyed are destroyed with their stream.
+TEST_F(GzipCompressorFactoryPoolTest, OutlivesFactory) {
+  auto factory = makeFactory(1);
+  Envoy::Compression::Compressor::CompressorPtr compressor = factory->createCompressor();
+  factory.reset();
+  compressAll(*compressor, 1024);
+}
+
 } // namespace
 } // namespace Compressor
 } // namespace Gzip
@@ -2,8 +2,10 @@
 #include "source/common/common/hex.h"
 #include "source/common/stats/isolated_store_impl.h"
 #include "source/extensions/compression/gzip/compressor/zlib_compressor_impl.h"
+#include "source/extensions/compression/gzip/decompressor/config.h"
 #include "source/extensions/compression/gzip/decompressor/zlib_decompressor_impl.h"
 
+#include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/utility.h"
 
 #include "gtest/gtest.h"
@@ -57,6 +59,21 @@ protected:
     ASSERT_EQ(0, decompressor.decompression_error_);
   }
 
+  // Compresses random text of the given size, and returns the text and the compressed text.
+  static std::pair<std::string, std::string> compressRandomText(uint64_t size) {
+    Buffer::OwnedImpl buffer;
+    TestUtility::feedBufferWithRandomCharacters(buffer, size);
+    const std::string text = buffer.toString();
+    Extensions::Compression::Gzip::Compressor::ZlibCompressorImpl compressor;
+    compressor.init(
+        Extensions::Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionLevel::Standard,
+        Extensions::Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionStrategy::
+            Standard,
+        gzip_window_bits, memory_level);
+    compressor.compress(buffer, Envoy::Compression::Compressor::State::Finish);
+    return {text, buffer.toString()};
+  }
+
   static constexpr int64_t gzip_window_bits{31};
   static constexpr int64_t memory_level{8};
   static constexpr uint64_t default_input_size{796};
@@ -326,6 +343,63 @@ TEST_F(ZlibDecompressorImplTest, CompressDecompressOfMultipleSlices) {
   EXPECT_EQ(original_text, decompressed_text);
 }
 
+// Exercises resetting the decompressor after a failed decompression.
+TEST_F(ZlibDecompressorImplTest, DecompressAfterReset) {
+  Buffer::OwnedImpl buffer;
+  ZlibDecompressorImpl decompressor{stats_scope_, "test.", 4096, 100};
+  decompressor.init(gzip_window_bits);
+
+  Buffer::OwnedImpl garbage;
+  TestUtility::feedBufferWithRandomCharacters(garbage, 128);
+  decompressor.decompress(garbage, buffer);
+  ASSERT_GT(0, decompressor.decompression_error_);
+
+  ASSERT_TRUE(decompressor.reset());
+  EXPECT_EQ(0, decompressor.decompression_error_);
+  auto [text, compressed] = compressRandomText(4096);
+  drainBuffer(buffer);
+  decompressor.decompress(Buffer::OwnedImpl(compressed), buffer);
+  EXPECT_EQ(text, buffer.toString());
+  EXPECT_EQ(0, decompressor.decompression_error_);
+}
+
+// Streams reuse the contexts of finished streams with the same stats prefix.
+TEST_F(ZlibDecompressorImplTest, FactoryReusesContexts) {
+  testing::NiceMock<ThreadLocal::MockInstance> tls;
+  envoy::extensions::compression::gzip::decompressor::v3::Gzip gzip;
+  gzip.mutable_context_pool_size()->set_value(2);
+  GzipDecompressorFactory factory(gzip, stats_scope_, tls);
+  auto counter = [this](const std::string& name) {
+    return TestUtility::findCounter(stats_store_, "gzip.decompressor_context_pool." + name)
+        ->value();
+  };
+  auto decompress = [&factory](const std::string& stats_prefix, const std::string& input) {
+    Buffer::OwnedImpl output;
+    factory.createDecompressor(stats_prefix)->decompress(Buffer::OwnedImpl(input), output);
+    return output.toString();
+  };
+
+  auto [text, compressed] = compressRandomText(4096);
+  EXPECT_EQ(text, decompress("a.", compressed));
+  EXPECT_EQ(text, decompress("a.", compressed));
+  EXPECT_EQ(1, counter("hits"));
+  EXPECT_EQ(1, counter("misses"));
+
+  // A context is not reused for another stats prefix.
+  EXPECT_EQ(text, decompress("b.", compressed));
+  EXPECT_EQ(1, counter("hits"));
+  EXPECT_EQ(2, counter("misses"));
+
+  // A context is reused after a failed decompression.
+  Buffer::OwnedImpl garbage;
+  TestUtility::feedBufferWithRandomCharacters(garbage, 128);
+  decompress("a.", garbage.toString());
+  EXPECT_EQ(1, stats_store_.counterFromString("a.zlib_data_error").value());
+  EXPECT_EQ(text, decompress("a.", compressed));
+  EXPECT_EQ(3, counter("hits"));
+  EXPECT_EQ(2, counter("misses"));
+}
+
 class ZlibDecompressorStatsTest : public testing::Test {
 protected:
   void chargeErrorStats(const int result) { decompressor_.chargeErrorStats(result); }
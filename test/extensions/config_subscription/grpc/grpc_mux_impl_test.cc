@@ -1,4 +1,5 @@
 #include <memory>
+#include <queue>
 
 #include "envoy/config/endpoint/v3/endpoint.pb.h"
 #include "envoy/config/endpoint/v3/endpoint.pb.validate.h"
@@ -30,6 +31,7 @@
 #include "test/test_common/test_time.h"
 #include "test/test_common/utility.h"
 
+#include "absl/synchronization/mutex.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -47,6 +49,32 @@ namespace Envoy {
 namespace Config {
 namespace {
 
+// Collects the callbacks posted to a dispatcher by the resource decode pool.
+class PostedCallbacks {
+public:
+  explicit PostedCallbacks(NiceMock<Event::MockDispatcher>& dispatcher) {
+    ON_CALL(dispatcher, post(_)).WillByDefault(Invoke([this](Event::PostCb callback) {
+      absl::MutexLock lock(&mutex_);
+      callbacks_.push(std::move(callback));
+    }));
+  }
+
+  // Waits for a callback to be posted.
+  Event::PostCb take() {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(this, &PostedCallbacks::posted));
+    Event::PostCb callback = std::move(callbacks_.front());
+    callbacks_.pop();
+    return callback;
+  }
+
+private:
+  bool posted() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) { return !callbacks_.empty(); }
+
+  absl::Mutex mutex_;
+  std::queue<Event::PostCb> callbacks_ ABSL_GUARDED_BY(mutex_);
+};
+
 // We test some mux specific stuff below, other unit test coverage for singleton use of GrpcMuxImpl
 // is provided in [grpc_]subscription_impl_test.cc.
 class GrpcMuxImplTestBase : public testing::Test {
@@ -75,7 +103,7 @@ public:
         /*rate_limit_settings_=*/custom_rate_limit_settings,
         /*scope_=*/*stats_.rootScope(),
         /*config_validators_=*/std::move(config_validators_),
-        /*xds_resources_delegate_=*/XdsResourcesDelegateOptRef(),
+        /*xds_resources_delegate_=*/xds_resources_delegate_,
         /*xds_config_tracker_=*/XdsConfigTrackerOptRef(),
         /*backoff_strategy_=*/
         std::make_unique<JitteredExponentialBackOffStrategy>(
@@ -83,7 +111,9 @@ public:
             random_),
         /*target_xds_authority_=*/"",
         /*eds_resources_cache_=*/std::unique_ptr<MockEdsResourcesCache>(eds_resources_cache_)};
-    grpc_mux_ = std::make_unique<GrpcMuxImpl>(grpc_mux_context, true);
+    grpc_mux_ = std::make_unique<GrpcMuxImpl>(
+        grpc_mux_context, true,
+        ResourceDecodePool::get(Thread::threadFactoryForTest(), resource_decoding_threads_));
   }
 
   void expectSendMessage(const std::string& type_url,
@@ -125,6 +155,8 @@ public:
   Stats::Gauge& control_plane_connected_state_;
   Stats::Gauge& control_plane_pending_requests_;
   MockEdsResourcesCache* eds_resources_cache_{nullptr};
+  uint32_t resource_decoding_threads_{};
+  XdsResourcesDelegateOptRef xds_resources_delegate_;
 };
 
 class GrpcMuxImplTest : public GrpcMuxImplTestBase {
@@ -406,6 +438,148 @@ TEST_F(GrpcMuxImplTest, TypeUrlMismatch) {
   expectSendMessage("foo", {}, "");
 }
 
+// Validate that responses whose resources are decoded off the main thread are applied in the order
+// they were received.
+TEST_F(GrpcMuxImplTest, DecodesResourcesOffMainThread) {
+  resource_decoding_threads_ = 2;
+  setup();
+  PostedCallbacks posted_callbacks(dispatcher_);
+  InSequence s;
+  OpaqueResourceDecoderSharedPtr resource_decoder(
+      std::make_shared<TestUtility::TestOpaqueResourceDecoderImpl<
+          envoy::config::endpoint::v3::ClusterLoadAssignment>>("cluster_name"));
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  auto foo_sub = grpc_mux_->addWatch(type_url, {"x", "y"}, callbacks_, resource_decoder, {});
+  EXPECT_CALL(*async_client_, startRaw(_, _, _, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {"x", "y"}, "", true);
+  grpc_mux_->start();
+
+  testing::MockFunction<void(const std::string&)> check;
+  for (const std::string version : {"1", "2"}) {
+    EXPECT_CALL(check, Call(version));
+    EXPECT_CALL(callbacks_, onConfigUpdate(_, version))
+        .WillOnce(Invoke([](const std::vector<DecodedResourceRef>& resources, const std::string&) {
+          EXPECT_EQ(2, resources.size());
+          EXPECT_EQ("x", resources[0].get().name());
+          EXPECT_EQ("y", resources[1].get().name());
+          return absl::OkStatus();
+        }));
+    expectSendMessage(type_url, {"x", "y"}, version, false, version);
+  }
+
+  // The second response waits for the first one to be applied.
+  for (const std::string version : {"1", "2"}) {
+    auto response = std::make_unique<envoy::service::discovery::v3::DiscoveryResponse>();
+    response->set_type_url(type_url);
+    response->set_version_info(version);
+    response->set_nonce(version);
+    for (const std::string name : {"x", "y"}) {
+      envoy::config::endpoint::v3::ClusterLoadAssignment load_assignment;
+      load_assignment.set_cluster_name(name);
+      response->add_resources()->PackFrom(load_assignment);
+    }
+    grpc_mux_->grpcStreamForTest().onReceiveMessage(std::move(response));
+  }
+  check.Call("1");
+  posted_callbacks.take()();
+  check.Call("2");
+  posted_callbacks.take()();
+
+  expectSendMessage(type_url, {}, "2");
+}
+
+TEST_F(GrpcMuxImplTest, RejectsResourcesDecodedOffMainThread) {
+  resource_decoding_threads_ = 1;
+  setup();
+  PostedCallbacks posted_callbacks(dispatcher_);
+  InSequence s;
+  auto foo_sub = grpc_mux_->addWatch("foo", {"x", "y"}, callbacks_, resource_decoder_, {});
+  EXPECT_CALL(*async_client_, startRaw(_, _, _, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage("foo", {"x", "y"}, "", true);
+  grpc_mux_->start();
+
+  auto invalid_response = std::make_unique<envoy::service::discovery::v3::DiscoveryResponse>();
+  invalid_response->set_type_url("foo");
+  invalid_response->set_version_info("foo-version");
+  invalid_response->mutable_resources()->Add()->set_type_url("bar");
+  const std::string error =
+      fmt::format("bar does not match the message-wide type URL foo in DiscoveryResponse {}",
+                  invalid_response->DebugString());
+  EXPECT_CALL(callbacks_, onConfigUpdateFailed(ConfigUpdateFailureReason::UpdateRejected, _))
+      .WillOnce(Invoke([&error](ConfigUpdateFailureReason, const EnvoyException* e) {
+        EXPECT_EQ(error, e->what());
+      }));
+  expectSendMessage("foo", {"x", "y"}, "", false, "", Grpc::Status::WellKnownGrpcStatus::Internal,
+                    error);
+  grpc_mux_->grpcStreamForTest().onReceiveMessage(std::move(invalid_response));
+  posted_callbacks.take()();
+
+  expectSendMessage("foo", {}, "");
+}
+
+// Validate that the responses received on a stream that was closed before their resources were
+// decoded are dropped.
+TEST_F(GrpcMuxImplTest, DropsResponsesDecodedAfterStreamClosed) {
+  resource_decoding_threads_ = 1;
+  setup();
+  PostedCallbacks posted_callbacks(dispatcher_);
+  auto foo_sub = grpc_mux_->addWatch("foo", {"x"}, callbacks_, resource_decoder_, {});
+  EXPECT_CALL(*async_client_, startRaw(_, _, _, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage("foo", {"x"}, "", true);
+  grpc_mux_->start();
+
+  auto response = std::make_unique<envoy::service::discovery::v3::DiscoveryResponse>();
+  response->set_type_url("foo");
+  response->set_version_info("1");
+  grpc_mux_->grpcStreamForTest().onReceiveMessage(std::move(response));
+  Event::PostCb decoded = posted_callbacks.take();
+
+  EXPECT_CALL(callbacks_, onConfigUpdateFailed(ConfigUpdateFailureReason::ConnectionFailure, _));
+  grpc_mux_->grpcStreamForTest().onRemoteClose(Grpc::Status::WellKnownGrpcStatus::Canceled, "");
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, _)).Times(0);
+  decoded();
+}
+
+// Validate that the config persisted by the xDS resources delegate is loaded once it is watched, if
+// the delegate loads it on startup.
+TEST_F(GrpcMuxImplTest, LoadsDelegateConfigOnStartup) {
+  NiceMock<MockXdsResourcesDelegate> xds_resources_delegate;
+  ON_CALL(xds_resources_delegate, loadOnStartup()).WillByDefault(Return(true));
+  xds_resources_delegate_ = xds_resources_delegate;
+  auto* load_from_delegate_cb = new Event::MockSchedulableCallback(&dispatcher_);
+  setup();
+
+  OpaqueResourceDecoderSharedPtr resource_decoder(
+      std::make_shared<TestUtility::TestOpaqueResourceDecoderImpl<
+          envoy::config::endpoint::v3::ClusterLoadAssignment>>("cluster_name"));
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  EXPECT_CALL(*load_from_delegate_cb, scheduleCallbackCurrentIteration());
+  auto foo_sub = grpc_mux_->addWatch(type_url, {"x"}, callbacks_, resource_decoder, {});
+
+  envoy::config::endpoint::v3::ClusterLoadAssignment load_assignment;
+  load_assignment.set_cluster_name("x");
+  envoy::service::discovery::v3::Resource resource;
+  resource.set_name("x");
+  resource.set_version("1");
+  resource.mutable_resource()->PackFrom(load_assignment);
+  EXPECT_CALL(xds_resources_delegate, getResources(_, absl::flat_hash_set<std::string>{"x"}))
+      .WillOnce(Return(std::vector<envoy::service::discovery::v3::Resource>{resource}));
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, "1"))
+      .WillOnce(Invoke([](const std::vector<DecodedResourceRef>& resources, const std::string&) {
+        EXPECT_EQ(1, resources.size());
+        EXPECT_EQ("x", resources[0].get().name());
+        return absl::OkStatus();
+      }));
+  load_from_delegate_cb->invokeCallback();
+
+  // The persisted config isn't loaded again if connecting to the xDS server fails.
+  EXPECT_CALL(*async_client_, startRaw(_, _, _, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {"x"}, "1", true);
+  grpc_mux_->start();
+  EXPECT_CALL(callbacks_, onConfigUpdateFailed(ConfigUpdateFailureReason::ConnectionFailure, _));
+  grpc_mux_->grpcStreamForTest().onRemoteClose(Grpc::Status::WellKnownGrpcStatus::Canceled, "");
+}
+
 TEST_F(GrpcMuxImplTest, RpcErrorMessageTruncated) {
   setup();
   auto invalid_response = std::make_unique<envoy::service::discovery::v3::DiscoveryResponse>();
@@ -1359,6 +1533,8 @@ TEST_F(NullGrpcMuxImplTest, PauseMultipleArgsImplemented) {
 TEST_F(NullGrpcMuxImplTest, RequestOnDemandNotImplemented) {
   EXPECT_ENVOY_BUG(null_mux_.requestOnDemandUpdate("type_url", {"for_update"}),
                    "unexpected request for on demand update");
+  EXPECT_ENVOY_BUG(null_mux_.requestOnDemandRemoval("type_url", {"for_removal"}),
+                   "unexpected request for on demand removal");
 }
 
 TEST_F(NullGrpcMuxImplTest, AddWatchRaisesException) {
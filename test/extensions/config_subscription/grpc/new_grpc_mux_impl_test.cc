@@ -556,6 +556,24 @@ TEST_P(NewGrpcMuxImplTest, RequestOnDemandUpdate) {
   expectSendMessage("foo", {}, {"x", "y"});
 }
 
+TEST_P(NewGrpcMuxImplTest, RequestOnDemandRemoval) {
+  setup();
+
+  auto foo_sub = grpc_mux_->addWatch("foo", {"x"}, callbacks_, resource_decoder_, {});
+  EXPECT_CALL(*async_client_, startRaw(_, _, _, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage("foo", {"x"}, {});
+  grpc_mux_->start();
+
+  expectSendMessage("foo", {"z"}, {});
+  grpc_mux_->requestOnDemandUpdate("foo", {"z"});
+
+  // Only the on-demand name is withdrawn, the watched one stays subscribed.
+  expectSendMessage("foo", {}, {"z"});
+  grpc_mux_->requestOnDemandRemoval("foo", {"z"});
+
+  expectSendMessage("foo", {}, {"x"});
+}
+
 TEST_P(NewGrpcMuxImplTest, Shutdown) {
   setup();
   InSequence s;
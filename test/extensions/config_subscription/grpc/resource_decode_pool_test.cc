@@ -0,0 +1,136 @@
+#include <memory>
+#include <string>
+
+#include "envoy/config/endpoint/v3/endpoint.pb.h"
+#include "envoy/config/endpoint/v3/endpoint.pb.validate.h"
+#include "envoy/service/discovery/v3/discovery.pb.h"
+
+#include "source/extensions/config_subscription/grpc/resource_decode_pool.h"
+
+#include "test/test_common/resources.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::HasSubstr;
+
+namespace Envoy {
+namespace Config {
+namespace {
+
+class ResourceDecodePoolTest : public testing::Test {
+public:
+  std::shared_ptr<envoy::service::discovery::v3::DiscoveryResponse> makeResponse(int count) {
+    auto response = std::make_shared<envoy::service::discovery::v3::DiscoveryResponse>();
+    response->set_type_url(Config::TypeUrl::get().ClusterLoadAssignment);
+    response->set_version_info("1");
+    for (int i = 0; i < count; ++i) {
+      envoy::config::endpoint::v3::ClusterLoadAssignment load_assignment;
+      load_assignment.set_cluster_name(absl::StrCat("cluster_", i));
+      response->add_resources()->PackFrom(load_assignment);
+    }
+    return response;
+  }
+
+  // Decodes the response on the pool, and runs the dispatcher until the result is posted.
+  DecodedDiscoveryResponse decode(
+      std::shared_ptr<const envoy::service::discovery::v3::DiscoveryResponse> response) {
+    DecodedDiscoveryResponse result;
+    ResourceDecodeHandlePtr handle =
+        pool_->decode(std::move(response), resource_decoder_, *dispatcher_,
+                      [&](DecodedDiscoveryResponse&& decoded) {
+                        result = std::move(decoded);
+                        dispatcher_->exit();
+                      });
+    dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit);
+    return result;
+  }
+
+  Api::ApiPtr api_ = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher_ = api_->allocateDispatcher("test_thread");
+  ResourceDecodePoolSharedPtr pool_ = ResourceDecodePool::get(api_->threadFactory(), 2);
+  OpaqueResourceDecoderSharedPtr resource_decoder_ =
+      std::make_shared<TestUtility::TestOpaqueResourceDecoderImpl<
+          envoy::config::endpoint::v3::ClusterLoadAssignment>>("cluster_name");
+};
+
+TEST_F(ResourceDecodePoolTest, DecodesResourcesInOrder) {
+  const int count = 3 * ResourceDecodePool::ChunkSize + 1;
+  DecodedDiscoveryResponse decoded = decode(makeResponse(count));
+  EXPECT_FALSE(decoded.error_.has_value());
+  ASSERT_EQ(count, decoded.resources_.size());
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(absl::StrCat("cluster_", i), decoded.resources_[i]->name());
+    EXPECT_EQ("1", decoded.resources_[i]->version());
+  }
+}
+
+TEST_F(ResourceDecodePoolTest, DecodesEmptyResponse) {
+  DecodedDiscoveryResponse decoded = decode(makeResponse(0));
+  EXPECT_FALSE(decoded.error_.has_value());
+  EXPECT_TRUE(decoded.resources_.empty());
+}
+
+// The response is rejected with the error of its first invalid resource, whichever chunk decodes
+// first.
+TEST_F(ResourceDecodePoolTest, ReportsFirstInvalidResource) {
+  auto response = makeResponse(3 * ResourceDecodePool::ChunkSize);
+  response->mutable_resources(ResourceDecodePool::ChunkSize + 1)->set_type_url("bar");
+  response->mutable_resources(2 * ResourceDecodePool::ChunkSize + 1)->set_type_url("baz");
+  DecodedDiscoveryResponse decoded = decode(response);
+  ASSERT_TRUE(decoded.error_.has_value());
+  EXPECT_THAT(decoded.error_.value(),
+              HasSubstr("bar does not match the message-wide type URL "
+                        "type.googleapis.com/envoy.config.endpoint.v3.ClusterLoadAssignment"));
+  EXPECT_TRUE(decoded.resources_.empty());
+}
+
+TEST_F(ResourceDecodePoolTest, DoesNotRunCallbackOnceCancelled) {
+  bool called = false;
+  ResourceDecodeHandlePtr handle =
+      pool_->decode(makeResponse(2 * ResourceDecodePool::ChunkSize), resource_decoder_,
+                    *dispatcher_, [&](DecodedDiscoveryResponse&&) { called = true; });
+  handle.reset();
+  // Joins the pool threads, so that the result is posted by now if it was before cancelling.
+  pool_.reset();
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_FALSE(called);
+}
+
+TEST_F(ResourceDecodePoolTest, SharesPoolsWithSameThreadCount) {
+  EXPECT_EQ(pool_, ResourceDecodePool::get(api_->threadFactory(), 2));
+  ResourceDecodePoolSharedPtr other_pool = ResourceDecodePool::get(api_->threadFactory(), 3);
+  EXPECT_NE(pool_, other_pool);
+  EXPECT_EQ(2, pool_->threadCount());
+  EXPECT_EQ(3, other_pool->threadCount());
+  EXPECT_EQ(nullptr, ResourceDecodePool::get(api_->threadFactory(), 0));
+}
+
+// Records the names of the threads it creates.
+class RecordingThreadFactory : public Thread::ThreadFactory {
+public:
+  // Thread::ThreadFactory
+  Thread::ThreadPtr createThread(std::function<void()> thread_routine,
+                                 Thread::OptionsOptConstRef options) override {
+    names_.push_back(options.has_value() ? options->name_ : "");
+    return Thread::threadFactoryForTest().createThread(std::move(thread_routine), options);
+  }
+  Thread::ThreadId currentThreadId() override {
+    return Thread::threadFactoryForTest().currentThreadId();
+  }
+
+  std::vector<std::string> names_;
+};
+
+TEST_F(ResourceDecodePoolTest, CreatesNamedThreadsWithThreadFactory) {
+  RecordingThreadFactory thread_factory;
+  ResourceDecodePoolSharedPtr pool = ResourceDecodePool::get(thread_factory, 5);
+  EXPECT_THAT(thread_factory.names_,
+              testing::ElementsAre("xds_decode:0", "xds_decode:1", "xds_decode:2", "xds_decode:3",
+                                   "xds_decode:4"));
+}
+
+} // namespace
+} // namespace Config
+} // namespace Envoy
@@ -43,6 +43,8 @@ public:
     failed_resource_names_.push_back(resource_name);
   }
 
+  bool loadOnStartup() const override { return false; }
+
   std::vector<envoy::service::discovery::v3::Resource>
   getResources(const Config::XdsSourceId& /*source_id*/,
                const absl::flat_hash_set<std::string>& resource_names) const override {
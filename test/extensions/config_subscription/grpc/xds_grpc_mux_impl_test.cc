@@ -1286,6 +1286,8 @@ TEST_F(NullGrpcMuxImplTest, PauseMultipleArgsImplemented) {
 TEST_F(NullGrpcMuxImplTest, RequestOnDemandNotImplemented) {
   EXPECT_ENVOY_BUG(null_mux_->requestOnDemandUpdate("type_url", {"for_update"}),
                    "unexpected request for on demand update");
+  EXPECT_ENVOY_BUG(null_mux_->requestOnDemandRemoval("type_url", {"for_removal"}),
+                   "unexpected request for on demand removal");
 }
 
 TEST_F(NullGrpcMuxImplTest, AddWatchRaisesException) {
@@ -14,6 +14,8 @@ TEST(Coverage, LookupStatusToString) {
   EXPECT_EQ(lookupStatusToString(LookupStatus::Unknown), "Unknown");
   EXPECT_EQ(lookupStatusToString(LookupStatus::CacheHit), "CacheHit");
   EXPECT_EQ(lookupStatusToString(LookupStatus::CacheMiss), "CacheMiss");
+  EXPECT_EQ(lookupStatusToString(LookupStatus::CollapsedCacheMiss), "CollapsedCacheMiss");
+  EXPECT_EQ(lookupStatusToString(LookupStatus::CollapsedValidation), "CollapsedValidation");
   EXPECT_EQ(lookupStatusToString(LookupStatus::StaleHitWithSuccessfulValidation),
             "StaleHitWithSuccessfulValidation");
   EXPECT_EQ(lookupStatusToString(LookupStatus::StaleHitWithFailedValidation),
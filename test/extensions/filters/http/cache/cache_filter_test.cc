@@ -32,7 +32,7 @@ protected:
   CacheFilterSharedPtr makeFilter(std::shared_ptr<HttpCache> cache, bool auto_destroy = true) {
     std::shared_ptr<CacheFilter> filter(
         new CacheFilter(config_, /*stats_prefix=*/"", context_.scope(),
-                        context_.server_factory_context_.timeSource(), cache),
+                        context_.server_factory_context_.timeSource(), cache, fill_registry_),
         [auto_destroy](CacheFilter* f) {
           if (auto_destroy) {
             f->onDestroy();
@@ -163,6 +163,7 @@ protected:
 
   std::shared_ptr<SimpleHttpCache> simple_cache_ = std::make_shared<SimpleHttpCache>();
   envoy::extensions::filters::http::cache::v3::CacheConfig config_;
+  CacheFillRegistrySharedPtr fill_registry_;
   std::shared_ptr<StreamInfo::FilterState> filter_state_ =
       std::make_shared<StreamInfo::FilterStateImpl>(StreamInfo::FilterState::LifeSpan::FilterChain);
   NiceMock<Server::Configuration::MockFactoryContext> context_;
@@ -1198,6 +1199,258 @@ TEST(LookupStatusTest, ResolveLookupStatusReturnsCorrectStatuses) {
       LookupStatus::CacheHit);
   EXPECT_EQ(CacheFilter::resolveLookupStatus(CacheEntryStatus::LookupError, FilterState::Destroyed),
             LookupStatus::LookupError);
+  EXPECT_EQ(CacheFilter::resolveLookupStatus(CacheEntryStatus::Unusable,
+                                             FilterState::NotServingFromCache),
+            LookupStatus::CacheMiss);
+}
+
+class RequestCollapsingTest : public CacheFilterTest {
+protected:
+  void SetUp() override {
+    CacheFilterTest::SetUp();
+    config_.mutable_request_collapsing_timeout()->set_seconds(5);
+    fill_registry_ = std::make_shared<CacheFillRegistry>();
+    ON_CALL(waiter_callbacks_, dispatcher()).WillByDefault(::testing::ReturnRef(*dispatcher_));
+    ON_CALL(waiter_callbacks_.stream_info_, filterState())
+        .WillByDefault(::testing::ReturnRef(filter_state_));
+  }
+
+  // Starts a request that misses the cache while the filler fetches the response, and waits for
+  // it.
+  CacheFilterSharedPtr startWaiter() {
+    CacheFilterSharedPtr waiter = makeFilter(simple_cache_);
+    waiter->setDecoderFilterCallbacks(waiter_callbacks_);
+    EXPECT_EQ(waiter->decodeHeaders(request_headers_, true),
+              Http::FilterHeadersStatus::StopAllIterationAndWatermark);
+    EXPECT_CALL(waiter_callbacks_, continueDecoding).Times(0);
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+    ::testing::Mock::VerifyAndClearExpectations(&waiter_callbacks_);
+    return waiter;
+  }
+
+  // Caches a response with an etag, and lets it become stale.
+  void insertStaleResponse(const std::string& body) {
+    response_headers_.setReferenceKey(Http::CustomHeaders::get().Etag, etag_);
+    response_headers_.setContentLength(body.size());
+    {
+      CacheFilterSharedPtr filter = makeFilter(simple_cache_);
+      testDecodeRequestMiss(filter);
+      Buffer::OwnedImpl buffer(body);
+      filter->encodeHeaders(response_headers_, false);
+      filter->encodeData(buffer, true);
+      dispatcher_->run(Event::Dispatcher::RunType::Block);
+    }
+    // The response headers have "max-age=3600".
+    time_source_.advanceTimeWait(std::chrono::seconds(3601));
+  }
+
+  // Starts a request that finds the stale response and validates it, on a copy of the request
+  // headers so that the waiters don't send conditional requests.
+  CacheFilterSharedPtr startValidator(Http::TestRequestHeaderMapImpl& validator_request_headers) {
+    validator_request_headers = request_headers_;
+    CacheFilterSharedPtr validator = makeFilter(simple_cache_);
+    EXPECT_EQ(validator->decodeHeaders(validator_request_headers, true),
+              Http::FilterHeadersStatus::StopAllIterationAndWatermark);
+    EXPECT_CALL(decoder_callbacks_, continueDecoding);
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+    ::testing::Mock::VerifyAndClearExpectations(&decoder_callbacks_);
+    EXPECT_THAT(validator_request_headers,
+                IsSupersetOfHeaders(Http::TestRequestHeaderMapImpl{{"if-none-match", etag_}}));
+    return validator;
+  }
+
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> waiter_callbacks_;
+  const std::string etag_ = "abc123";
+};
+
+TEST_F(RequestCollapsingTest, WaiterServesFillerResponse) {
+  request_headers_.setHost("WaiterServesFillerResponse");
+  CacheFilterSharedPtr filler = makeFilter(simple_cache_);
+  testDecodeRequestMiss(filler);
+  EXPECT_EQ(1, fill_registry_->size());
+  CacheFilterSharedPtr waiter = startWaiter();
+
+  EXPECT_CALL(waiter_callbacks_, encodeHeaders_(IsSupersetOfHeaders(response_headers_), false));
+  EXPECT_EQ(filler->encodeHeaders(response_headers_, false), Http::FilterHeadersStatus::Continue);
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  ::testing::Mock::VerifyAndClearExpectations(&waiter_callbacks_);
+
+  // Body chunks are served as they arrive.
+  Buffer::OwnedImpl chunk1("abc");
+  EXPECT_CALL(waiter_callbacks_, encodeData(testing::Property(&Buffer::Instance::toString,
+                                                              testing::Eq("abc")),
+                                             false));
+  EXPECT_EQ(filler->encodeData(chunk1, false), Http::FilterDataStatus::Continue);
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  ::testing::Mock::VerifyAndClearExpectations(&waiter_callbacks_);
+
+  Buffer::OwnedImpl chunk2("def");
+  EXPECT_CALL(waiter_callbacks_, encodeData(testing::Property(&Buffer::Instance::toString,
+                                                              testing::Eq("def")),
+                                             true));
+  EXPECT_EQ(filler->encodeData(chunk2, true), Http::FilterDataStatus::Continue);
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  ::testing::Mock::VerifyAndClearExpectations(&waiter_callbacks_);
+  EXPECT_EQ(0, fill_registry_->size());
+
+  waiter->onStreamComplete();
+  EXPECT_THAT(lookupStatus(), IsOkAndHolds(LookupStatus::CollapsedCacheMiss));
+  EXPECT_THAT(insertStatus(), IsOkAndHolds(InsertStatus::NoInsertCacheHit));
+}
+
+TEST_F(RequestCollapsingTest, LateWaiterCatchesUp) {
+  request_headers_.setHost("LateWaiterCatchesUp");
+  CacheFilterSharedPtr filler = makeFilter(simple_cache_);
+  testDecodeRequestMiss(filler);
+  filler->encodeHeaders(response_headers_, false);
+  Buffer::OwnedImpl chunk("abc");
+  filler->encodeData(chunk, false);
+
+  // The headers and body that arrived before the request waited are served when it joins.
+  EXPECT_CALL(waiter_callbacks_, encodeHeaders_(IsSupersetOfHeaders(response_headers_), false));
+  EXPECT_CALL(waiter_callbacks_, encodeData(testing::Property(&Buffer::Instance::toString,
+                                                              testing::Eq("abc")),
+                                             false));
+  CacheFilterSharedPtr waiter = startWaiter();
+
+  Http::TestResponseTrailerMapImpl trailers{{"foo", "bar"}};
+  EXPECT_CALL(waiter_callbacks_, encodeTrailers_(IsSupersetOfHeaders(trailers)));
+  filler->encodeTrailers(trailers);
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+}
+
+TEST_F(RequestCollapsingTest, WaiterGoesUpstreamOnTimeout) {
+  request_headers_.setHost("WaiterGoesUpstreamOnTimeout");
+  CacheFilterSharedPtr filler = makeFilter(simple_cache_);
+  testDecodeRequestMiss(filler);
+  CacheFilterSharedPtr waiter = startWaiter();
+
+  EXPECT_CALL(waiter_callbacks_, continueDecoding);
+  time_source_.advanceTimeWait(std::chrono::seconds(5));
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  ::testing::Mock::VerifyAndClearExpectations(&waiter_callbacks_);
+
+  // The response arriving later is not served to the request that went upstream.
+  EXPECT_CALL(waiter_callbacks_, encodeHeaders_).Times(0);
+  filler->encodeHeaders(response_headers_, true);
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+}
+
+TEST_F(RequestCollapsingTest, WaiterGoesUpstreamIfResponseIsNotCacheable) {
+  request_headers_.setHost("WaiterGoesUpstreamIfResponseIsNotCacheable");
+  CacheFilterSharedPtr filler = makeFilter(simple_cache_);
+  testDecodeRequestMiss(filler);
+  CacheFilterSharedPtr waiter = startWaiter();
+
+  response_headers_.setReferenceKey(Http::CustomHeaders::get().CacheControl, "private");
+  EXPECT_CALL(waiter_callbacks_, encodeHeaders_).Times(0);
+  EXPECT_CALL(waiter_callbacks_, continueDecoding);
+  filler->encodeHeaders(response_headers_, true);
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  ::testing::Mock::VerifyAndClearExpectations(&waiter_callbacks_);
+
+  waiter->onStreamComplete();
+  EXPECT_THAT(lookupStatus(), IsOkAndHolds(LookupStatus::CacheMiss));
+}
+
+TEST_F(RequestCollapsingTest, WaiterIsResetIfFillerIsResetDuringBody) {
+  request_headers_.setHost("WaiterIsResetIfFillerIsResetDuringBody");
+  CacheFilterSharedPtr filler = makeFilter(simple_cache_, /*auto_destroy=*/false);
+  testDecodeRequestMiss(filler);
+  CacheFilterSharedPtr waiter = startWaiter();
+
+  EXPECT_CALL(waiter_callbacks_, encodeHeaders_(IsSupersetOfHeaders(response_headers_), false));
+  filler->encodeHeaders(response_headers_, false);
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+
+  EXPECT_CALL(waiter_callbacks_, resetStream);
+  filler->onDestroy();
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+}
+
+TEST_F(RequestCollapsingTest, RequestWithNoStoreDoesNotFill) {
+  request_headers_.setHost("RequestWithNoStoreDoesNotFill");
+  request_headers_.setReferenceKey(Http::CustomHeaders::get().CacheControl, "no-store");
+  CacheFilterSharedPtr filter = makeFilter(simple_cache_);
+  testDecodeRequestMiss(filter);
+  EXPECT_EQ(0, fill_registry_->size());
+}
+
+TEST_F(RequestCollapsingTest, WaiterServesValidatedStaleResponse) {
+  request_headers_.setHost("WaiterServesValidatedStaleResponse");
+  const std::string body = "abc";
+  insertStaleResponse(body);
+  Http::TestRequestHeaderMapImpl validator_request_headers;
+  CacheFilterSharedPtr validator = startValidator(validator_request_headers);
+  EXPECT_EQ(1, fill_registry_->size());
+  CacheFilterSharedPtr waiter = startWaiter();
+
+  // The waiter is served the stale response that the validator validated, with its updated date.
+  const std::string not_modified_date = formatter_.now(time_source_);
+  Http::TestResponseHeaderMapImpl not_modified_response_headers = {{":status", "304"},
+                                                                   {"date", not_modified_date}};
+  Http::TestResponseHeaderMapImpl validated_response_headers = response_headers_;
+  validated_response_headers.setDate(not_modified_date);
+  EXPECT_CALL(waiter_callbacks_,
+              encodeHeaders_(IsSupersetOfHeaders(validated_response_headers), false));
+  EXPECT_CALL(waiter_callbacks_, encodeData(testing::Property(&Buffer::Instance::toString,
+                                                              testing::Eq(body)),
+                                             true));
+  EXPECT_CALL(waiter_callbacks_, continueDecoding).Times(0);
+  EXPECT_EQ(validator->encodeHeaders(not_modified_response_headers, true),
+            Http::FilterHeadersStatus::StopIteration);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  ::testing::Mock::VerifyAndClearExpectations(&waiter_callbacks_);
+  EXPECT_EQ(0, fill_registry_->size());
+
+  waiter->onStreamComplete();
+  EXPECT_THAT(lookupStatus(), IsOkAndHolds(LookupStatus::CollapsedValidation));
+}
+
+TEST_F(RequestCollapsingTest, WaiterValidatesStaleResponseOnTimeout) {
+  request_headers_.setHost("WaiterValidatesStaleResponseOnTimeout");
+  insertStaleResponse("abc");
+  Http::TestRequestHeaderMapImpl validator_request_headers;
+  CacheFilterSharedPtr validator = startValidator(validator_request_headers);
+  CacheFilterSharedPtr waiter = startWaiter();
+
+  EXPECT_CALL(waiter_callbacks_, continueDecoding);
+  time_source_.advanceTimeWait(std::chrono::seconds(5));
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  ::testing::Mock::VerifyAndClearExpectations(&waiter_callbacks_);
+  EXPECT_THAT(request_headers_,
+              IsSupersetOfHeaders(Http::TestRequestHeaderMapImpl{{"if-none-match", etag_}}));
+}
+
+TEST_F(RequestCollapsingTest, FillIsNotOfferedPastMaxBodyBytes) {
+  request_headers_.setHost("FillIsNotOfferedPastMaxBodyBytes");
+  fill_registry_ = std::make_shared<CacheFillRegistry>(/*max_body_bytes=*/4);
+  CacheFilterSharedPtr filler = makeFilter(simple_cache_);
+  testDecodeRequestMiss(filler);
+  CacheFilterSharedPtr waiter = startWaiter();
+
+  EXPECT_CALL(waiter_callbacks_, encodeHeaders_(IsSupersetOfHeaders(response_headers_), false));
+  EXPECT_CALL(waiter_callbacks_, encodeData(testing::Property(&Buffer::Instance::toString,
+                                                              testing::Eq("abcde")),
+                                             false));
+  filler->encodeHeaders(response_headers_, false);
+  Buffer::OwnedImpl chunk1("abcde");
+  filler->encodeData(chunk1, false);
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  ::testing::Mock::VerifyAndClearExpectations(&waiter_callbacks_);
+
+  // New requests for the key fetch the response themselves.
+  EXPECT_EQ(0, fill_registry_->size());
+  CacheFilterSharedPtr late_request = makeFilter(simple_cache_);
+  testDecodeRequestMiss(late_request);
+
+  // The request that waited for the fill is still served all of it.
+  EXPECT_CALL(waiter_callbacks_, encodeData(testing::Property(&Buffer::Instance::toString,
+                                                              testing::Eq("f")),
+                                             true));
+  Buffer::OwnedImpl chunk2("f");
+  filler->encodeData(chunk2, true);
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
 }
 
 // A new type alias for a different type of tests that use the exact same class
@@ -11,6 +11,7 @@
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/stats/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 
 #include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
@@ -427,6 +428,39 @@ BENCHMARK(compressChunks1024WithGzip)
     ->UseManualTime()
     ->Unit(benchmark::kMillisecond);
 
+// Generates a JSON array of objects, the size of a typical API response.
+static std::string generateJsonResponse(uint64_t size) {
+  std::string response = "[";
+  for (uint64_t i = 0; response.size() < size; ++i) {
+    absl::StrAppend(&response, i == 0 ? "" : ",", R"({"id":)", i, R"(,"name":"item-)", i,
+                    R"(","enabled":true,"tags":["a","b"]})");
+  }
+  response.resize(size - 1);
+  response.push_back(']');
+  return response;
+}
+
+// Compresses small responses, for which initializing the compressor takes about as long as
+// compressing, with a compressor created per stream (pool size 0) or drawn from a pool.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void compressSmallResponsesWithGzip(benchmark::State& state) {
+  testing::NiceMock<ThreadLocal::MockInstance> tls;
+  Stats::IsolatedStoreImpl stats;
+  envoy::extensions::compression::gzip::compressor::v3::Gzip gzip;
+  gzip.mutable_context_pool_size()->set_value(state.range(0));
+  Compression::Gzip::Compressor::GzipCompressorFactory factory(gzip, tls, *stats.rootScope());
+  const std::string response = generateJsonResponse(state.range(1));
+
+  for (auto _ : state) { // NOLINT
+    Buffer::OwnedImpl buffer(response);
+    factory.createCompressor()->compress(buffer, Envoy::Compression::Compressor::State::Finish);
+    benchmark::DoNotOptimize(buffer.length());
+  }
+}
+BENCHMARK(compressSmallResponsesWithGzip)
+    ->ArgsProduct({{0, 16}, {512, 2048, 8192}})
+    ->Unit(benchmark::kMicrosecond);
+
 static constexpr CompressionParams zstd_compression_params[] = {
     // level1 + default
     {1, 0, 0, 0},
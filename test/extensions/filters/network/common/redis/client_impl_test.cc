@@ -192,6 +192,7 @@ class ConfigBufferSizeGTSingleRequest : public Config {
   ReadPolicy readPolicy() const override { return ReadPolicy::Primary; }
   bool connectionRateLimitEnabled() const override { return false; }
   uint32_t connectionRateLimitPerSec() const override { return 0; }
+  bool enableReplyPassthrough() const override { return false; }
 };
 
 TEST_F(RedisClientImplTest, BatchWithTimerFiring) {
@@ -353,6 +354,7 @@ class ConfigEnableCommandStats : public Config {
   bool enableCommandStats() const override { return true; }
   bool connectionRateLimitEnabled() const override { return false; }
   uint32_t connectionRateLimitPerSec() const override { return 0; }
+  bool enableReplyPassthrough() const override { return false; }
 };
 
 void initializeRedisSimpleCommand(Common::Redis::RespValue* request, std::string command_name,
@@ -741,6 +743,7 @@ class ConfigOutlierDisabled : public Config {
   bool enableCommandStats() const override { return false; }
   bool connectionRateLimitEnabled() const override { return false; }
   uint32_t connectionRateLimitPerSec() const override { return 0; }
+  bool enableReplyPassthrough() const override { return false; }
 };
 
 TEST_F(RedisClientImplTest, OutlierDisabled) {
@@ -1206,6 +1209,98 @@ TEST_F(RedisClientImplTest, RemoveFailedHost) {
   upstream_connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
 }
 
+TEST_F(RedisClientImplTest, ReplyPassthrough) {
+  InSequence s;
+
+  auto settings = createConnPoolSettings();
+  settings.set_enable_reply_passthrough(true);
+  setup(std::make_unique<ConfigImpl>(settings));
+
+  Common::Redis::RespValue request1;
+  MockClientCallbacks callbacks1;
+  EXPECT_CALL(callbacks1, acceptsRawResponse()).WillOnce(Return(true));
+  EXPECT_CALL(*encoder_, encode(Ref(request1), _));
+  EXPECT_CALL(*flush_timer_, enabled()).WillOnce(Return(false));
+  PoolRequest* handle1 = client_->makeRequest(request1, callbacks1);
+  EXPECT_NE(nullptr, handle1);
+
+  Common::Redis::RespValue request2;
+  MockClientCallbacks callbacks2;
+  EXPECT_CALL(callbacks2, acceptsRawResponse()).WillOnce(Return(true));
+  EXPECT_CALL(*encoder_, encode(Ref(request2), _));
+  EXPECT_CALL(*flush_timer_, enabled()).WillOnce(Return(false));
+  PoolRequest* handle2 = client_->makeRequest(request2, callbacks2);
+  EXPECT_NE(nullptr, handle2);
+
+  Common::Redis::RespValue request3;
+  MockClientCallbacks callbacks3;
+  EXPECT_CALL(callbacks3, acceptsRawResponse()).WillOnce(Return(false));
+  EXPECT_CALL(*encoder_, encode(Ref(request3), _));
+  EXPECT_CALL(*flush_timer_, enabled()).WillOnce(Return(false));
+  PoolRequest* handle3 = client_->makeRequest(request3, callbacks3);
+  EXPECT_NE(nullptr, handle3);
+
+  onConnected();
+
+  // A partial reply is left in the connection buffer.
+  Buffer::OwnedImpl fake_data("*2\r\n$3\r\nf");
+  upstream_read_filter_->onData(fake_data, false);
+  EXPECT_EQ(10, fake_data.length());
+
+  // The first reply is handed over undecoded, the error reply and the reply for a callback that
+  // does not accept raw responses go through the decoder.
+  fake_data.add("oo\r\n$-1\r\n-ERR bad\r\n:1\r\n");
+  EXPECT_CALL(callbacks1, onResponse_(_)).WillOnce(Invoke([](RespValuePtr& value) {
+    ASSERT_EQ(RespType::Raw, value->type());
+    EXPECT_EQ("*2\r\n$3\r\nfoo\r\n$-1\r\n", value->asRaw().toString());
+  }));
+  EXPECT_CALL(*connect_or_op_timer_, enableTimer(_, _));
+  EXPECT_CALL(host_->outlier_detector_,
+              putResult(Upstream::Outlier::Result::ExtOriginRequestSuccess, _));
+  EXPECT_CALL(*decoder_, decode(_)).WillOnce(Invoke([&](Buffer::Instance& data) -> void {
+    EXPECT_EQ("-ERR bad\r\n", data.toString());
+    callbacks_->onRespValue(Utility::makeError("ERR bad"));
+  }));
+  EXPECT_CALL(callbacks2, onResponse_(_));
+  EXPECT_CALL(*connect_or_op_timer_, enableTimer(_, _));
+  EXPECT_CALL(host_->outlier_detector_,
+              putResult(Upstream::Outlier::Result::ExtOriginRequestSuccess, _));
+  EXPECT_CALL(*decoder_, decode(_)).WillOnce(Invoke([&](Buffer::Instance& data) -> void {
+    EXPECT_EQ(":1\r\n", data.toString());
+    RespValuePtr response3(new RespValue());
+    response3->type(RespType::Integer);
+    response3->asInteger() = 1;
+    callbacks_->onRespValue(std::move(response3));
+  }));
+  EXPECT_CALL(callbacks3, onResponse_(_));
+  EXPECT_CALL(*connect_or_op_timer_, disableTimer());
+  EXPECT_CALL(host_->outlier_detector_,
+              putResult(Upstream::Outlier::Result::ExtOriginRequestSuccess, _));
+  upstream_read_filter_->onData(fake_data, false);
+  EXPECT_EQ(0, fake_data.length());
+
+  EXPECT_CALL(*connect_or_op_timer_, disableTimer());
+  client_->close();
+}
+
+TEST_F(RedisClientImplTest, ReplyPassthroughUnexpectedReply) {
+  InSequence s;
+
+  auto settings = createConnPoolSettings();
+  settings.set_enable_reply_passthrough(true);
+  setup(std::make_unique<ConfigImpl>(settings));
+
+  Buffer::OwnedImpl fake_data("+OK\r\n");
+  EXPECT_CALL(host_->outlier_detector_,
+              putResult(Upstream::Outlier::Result::ExtOriginRequestFailed, _));
+  EXPECT_CALL(*upstream_connection_, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(*connect_or_op_timer_, disableTimer());
+  upstream_read_filter_->onData(fake_data, false);
+
+  EXPECT_EQ(1UL, host_->cluster_.traffic_stats_->upstream_cx_protocol_error_.value());
+  EXPECT_EQ(1UL, host_->stats_.rq_error_.value());
+}
+
 TEST(RedisClientFactoryImplTest, Basic) {
   ClientFactoryImpl factory;
   Upstream::MockHost::MockCreateConnectionData conn_info;
@@ -214,6 +214,32 @@ TEST_F(RedisRespValueTest, CompositeArrayTest) {
   validateIterator(empty, {});
 }
 
+TEST_F(RedisRespValueTest, RawTest) {
+  RespValue value1;
+  value1.type(RespType::Raw);
+  value1.asRaw().add("+OK\r\n");
+  EXPECT_EQ("raw(5 bytes)", value1.toString());
+
+  RespValue value2;
+  value2.type(RespType::Raw);
+  value2.asRaw().add("+OK\r\n");
+  RespValue value3;
+  value3.type(RespType::Raw);
+  value3.asRaw().add(":1\r\n");
+  EXPECT_TRUE(value1 == value2);
+  EXPECT_FALSE(value1 == value3);
+
+  // Copies own their bytes.
+  RespValue copy = value1;
+  copy.asRaw().drain(1);
+  EXPECT_EQ(5, value1.asRaw().length());
+  RespValue copy_assign;
+  copy_assign = value1;
+  EXPECT_TRUE(value1 == copy_assign);
+
+  verifyMoves(value1);
+}
+
 class RedisEncoderDecoderImplTest : public testing::Test, public DecoderCallbacks {
 public:
   RedisEncoderDecoderImplTest() : decoder_(*this) {}
@@ -396,6 +422,15 @@ TEST_F(RedisEncoderDecoderImplTest, NestedArray) {
   EXPECT_EQ(value, *decoded_values_[0]);
 }
 
+TEST_F(RedisEncoderDecoderImplTest, Raw) {
+  RespValue value;
+  value.type(RespType::Raw);
+  value.asRaw().add("*1\r\n$3\r\nfoo\r\n");
+  encoder_.encode(value, buffer_);
+  EXPECT_EQ("*1\r\n$3\r\nfoo\r\n", buffer_.toString());
+  EXPECT_EQ(13, value.asRaw().length());
+}
+
 TEST_F(RedisEncoderDecoderImplTest, NullArray) {
   buffer_.add("*-1\r\n");
   decoder_.decode(buffer_);
@@ -427,6 +462,79 @@ TEST_F(RedisEncoderDecoderImplTest, InvalidBulkStringExpectLF) {
   EXPECT_THROW(decoder_.decode(buffer_), ProtocolError);
 }
 
+class RespFrameScannerTest : public testing::Test {
+public:
+  // Feeds the input one byte at a time and returns the frame length reported once it completes.
+  uint64_t scanByteByByte(const std::string& input) {
+    Buffer::OwnedImpl buffer;
+    for (uint64_t i = 0; i < input.size(); i++) {
+      buffer.add(input.substr(i, 1));
+      const uint64_t frame_length = scanner_.scan(buffer);
+      if (frame_length > 0) {
+        return frame_length;
+      }
+    }
+    return 0;
+  }
+
+  RespFrameScanner scanner_;
+};
+
+TEST_F(RespFrameScannerTest, SingleValues) {
+  for (const std::string& frame : {"+OK\r\n", "-ERR bad\r\n", ":-123\r\n", "$-1\r\n", "$0\r\n\r\n",
+                                   "$4\r\na\r\nb\r\n", "*-1\r\n", "*0\r\n"}) {
+    Buffer::OwnedImpl buffer(frame + "+next\r\n");
+    EXPECT_EQ(frame.size(), scanner_.scan(buffer)) << frame;
+    EXPECT_EQ(frame.size(), scanByteByByte(frame)) << frame;
+  }
+}
+
+TEST_F(RespFrameScannerTest, NestedArray) {
+  const std::string frame = "*3\r\n*2\r\n$3\r\nfoo\r\n:1\r\n*0\r\n$-1\r\n";
+  Buffer::OwnedImpl buffer(frame + ":2\r\n");
+  EXPECT_EQ(frame.size(), scanner_.scan(buffer));
+  EXPECT_EQ(frame.size(), scanByteByByte(frame));
+
+  // The scanner resets after a complete frame, so the next one can be scanned.
+  buffer.drain(frame.size());
+  EXPECT_EQ(4, scanner_.scan(buffer));
+}
+
+TEST_F(RespFrameScannerTest, MatchesDecoder) {
+  RespValue value;
+  value.type(RespType::Array);
+  value.asArray().resize(100);
+  for (uint64_t i = 0; i < value.asArray().size(); i++) {
+    value.asArray()[i].type(RespType::BulkString);
+    value.asArray()[i].asString() = std::string(i * 10, 'x');
+  }
+  EncoderImpl encoder;
+  Buffer::OwnedImpl buffer;
+  encoder.encode(value, buffer);
+  const uint64_t length = buffer.length();
+  encoder.encode(value, buffer);
+  EXPECT_EQ(length, scanner_.scan(buffer));
+}
+
+TEST_F(RespFrameScannerTest, InvalidType) {
+  Buffer::OwnedImpl buffer("^");
+  EXPECT_THROW(scanner_.scan(buffer), ProtocolError);
+}
+
+TEST_F(RespFrameScannerTest, InvalidInteger) {
+  Buffer::OwnedImpl buffer(":-a\r\n");
+  EXPECT_THROW(scanner_.scan(buffer), ProtocolError);
+  Buffer::OwnedImpl too_long("$123456789012345678901\r\n");
+  EXPECT_THROW(scanner_.scan(too_long), ProtocolError);
+  Buffer::OwnedImpl empty("*\r\n");
+  EXPECT_THROW(scanner_.scan(empty), ProtocolError);
+}
+
+TEST_F(RespFrameScannerTest, InvalidBulkStringExpectCRLF) {
+  Buffer::OwnedImpl buffer("$1\r\nab\r\n");
+  EXPECT_THROW(scanner_.scan(buffer), ProtocolError);
+}
+
 } // namespace Redis
 } // namespace Common
 } // namespace NetworkFilters
@@ -109,6 +109,7 @@ public:
   MOCK_METHOD(void, onRedirection_,
               (Common::Redis::RespValuePtr & value, const std::string& host_address,
                bool ask_redirection));
+  MOCK_METHOD(bool, acceptsRawResponse, (), (const));
 };
 
 } // namespace Client
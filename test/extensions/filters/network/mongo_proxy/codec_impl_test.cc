@@ -6,6 +6,7 @@
 #include "source/extensions/filters/network/mongo_proxy/codec_impl.h"
 
 #include "test/test_common/printers.h"
+#include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -30,6 +31,7 @@ public:
   void decodeCommandReply(CommandReplyMessagePtr&& message) override {
     decodeCommandReply_(message);
   }
+  void decodeMsg(MsgMessagePtr&& message) override { decodeMsg_(message); }
 
   MOCK_METHOD(void, decodeGetMore_, (GetMoreMessagePtr & message));
   MOCK_METHOD(void, decodeInsert_, (InsertMessagePtr & message));
@@ -38,6 +40,7 @@ public:
   MOCK_METHOD(void, decodeReply_, (ReplyMessagePtr & message));
   MOCK_METHOD(void, decodeCommand_, (CommandMessagePtr & message));
   MOCK_METHOD(void, decodeCommandReply_, (CommandReplyMessagePtr & message));
+  MOCK_METHOD(void, decodeMsg_, (MsgMessagePtr & message));
 };
 
 class MongoCodecImplTest : public testing::Test {
@@ -443,6 +446,123 @@ TEST_F(MongoCodecImplTest, CommandReply) {
   decoder_.onData(output_);
 }
 
+TEST_F(MongoCodecImplTest, MsgEqual) {
+  {
+    MsgMessageImpl m1(0, 0);
+    MsgMessageImpl m2(1, 1);
+    EXPECT_FALSE(m1 == m2);
+  }
+
+  {
+    MsgMessageImpl m1(0, 0);
+    m1.body(Bson::DocumentImpl::create()->addInt32("hello", 1));
+    MsgMessageImpl m2(0, 0);
+    m2.body(Bson::DocumentImpl::create()->addInt32("hello", 2));
+    EXPECT_FALSE(m1 == m2);
+  }
+
+  {
+    MsgMessageImpl m1(0, 0);
+    m1.body(Bson::DocumentImpl::create());
+    m1.documentSequences().push_back({"documents", {Bson::DocumentImpl::create()}});
+    MsgMessageImpl m2(0, 0);
+    m2.body(Bson::DocumentImpl::create());
+    m2.documentSequences().push_back({"updates", {Bson::DocumentImpl::create()}});
+    EXPECT_FALSE(m1 == m2);
+  }
+}
+
+TEST_F(MongoCodecImplTest, Msg) {
+  MsgMessageImpl msg(17, 27);
+  msg.flags(MsgMessage::Flags::ExhaustAllowed);
+  msg.body(Bson::DocumentImpl::create()->addInt32("insert", 1)->addString("$db", "test"));
+  msg.documentSequences().push_back(
+      {"documents",
+       {Bson::DocumentImpl::create()->addString("hello", "world"),
+        Bson::DocumentImpl::create()->addInt64("answer", 42)}});
+
+  EXPECT_NO_THROW(Json::Factory::loadFromString(msg.toString(true)));
+  EXPECT_NO_THROW(Json::Factory::loadFromString(msg.toString(false)));
+
+  encoder_.encodeMsg(msg);
+  EXPECT_CALL(callbacks_, decodeMsg_(Pointee(Eq(msg))));
+  decoder_.onData(output_);
+  EXPECT_EQ(0, output_.length());
+}
+
+// A trailing checksum is consumed but not validated.
+TEST_F(MongoCodecImplTest, MsgWithChecksum) {
+  MsgMessageImpl msg(1, 0);
+  msg.body(Bson::DocumentImpl::create()->addInt32("hello", 1));
+  encoder_.encodeMsg(msg);
+
+  // Patch in the checksum flag and length, then append a checksum.
+  Buffer::OwnedImpl patched;
+  Bson::BufferHelper::writeInt32(patched, output_.length() + 4);
+  output_.drain(4);
+  patched.add(output_.linearize(12), 12);
+  output_.drain(12);
+  Bson::BufferHelper::writeInt32(patched, MsgMessage::Flags::ChecksumPresent);
+  output_.drain(4);
+  patched.move(output_);
+  Bson::BufferHelper::writeInt32(patched, 0x12345678);
+
+  msg.flags(MsgMessage::Flags::ChecksumPresent);
+  EXPECT_CALL(callbacks_, decodeMsg_(Pointee(Eq(msg))));
+  decoder_.onData(patched);
+  EXPECT_EQ(0, patched.length());
+}
+
+TEST_F(MongoCodecImplTest, MsgInvalid) {
+  {
+    MsgMessageImpl msg(0, 0);
+    EXPECT_THROW(encoder_.encodeMsg(msg), EnvoyException);
+    msg.body(Bson::DocumentImpl::create());
+    msg.flags(MsgMessage::Flags::ChecksumPresent);
+    EXPECT_THROW(encoder_.encodeMsg(msg), EnvoyException);
+  }
+
+  {
+    // Unknown section kind.
+    Buffer::OwnedImpl data;
+    Bson::BufferHelper::writeInt32(data, 16 + 4 + 1);
+    Bson::BufferHelper::writeInt32(data, 1);
+    Bson::BufferHelper::writeInt32(data, 0);
+    Bson::BufferHelper::writeInt32(data, static_cast<int32_t>(Message::OpCode::Msg));
+    Bson::BufferHelper::writeInt32(data, 0);
+    data.writeByte(5);
+    EXPECT_THROW_WITH_MESSAGE(decoder_.onData(data), EnvoyException,
+                              "invalid mongo msg section kind 5");
+  }
+
+  {
+    // No body section.
+    Buffer::OwnedImpl data;
+    Bson::BufferHelper::writeInt32(data, 16 + 4);
+    Bson::BufferHelper::writeInt32(data, 1);
+    Bson::BufferHelper::writeInt32(data, 0);
+    Bson::BufferHelper::writeInt32(data, static_cast<int32_t>(Message::OpCode::Msg));
+    Bson::BufferHelper::writeInt32(data, 0);
+    EXPECT_THROW_WITH_MESSAGE(decoder_.onData(data), EnvoyException,
+                              "mongo msg message has no body section");
+  }
+
+  {
+    // The body section runs into the checksum.
+    Bson::DocumentSharedPtr body = Bson::DocumentImpl::create()->addInt32("hello", 1);
+    Buffer::OwnedImpl data;
+    Bson::BufferHelper::writeInt32(data, 16 + 4 + 1 + body->byteSize());
+    Bson::BufferHelper::writeInt32(data, 1);
+    Bson::BufferHelper::writeInt32(data, 0);
+    Bson::BufferHelper::writeInt32(data, static_cast<int32_t>(Message::OpCode::Msg));
+    Bson::BufferHelper::writeInt32(data, MsgMessage::Flags::ChecksumPresent);
+    data.writeByte(0);
+    body->encode(data);
+    EXPECT_THROW_WITH_MESSAGE(decoder_.onData(data), EnvoyException,
+                              "mongo msg sections overrun the message");
+  }
+}
+
 } // namespace MongoProxy
 } // namespace NetworkFilters
 } // namespace Extensions
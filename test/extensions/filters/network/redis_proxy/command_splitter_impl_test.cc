@@ -18,6 +18,7 @@
 #include "test/test_common/simulated_time_system.h"
 
 using testing::_;
+using testing::ByMove;
 using testing::DoAll;
 using testing::InSequence;
 using testing::NiceMock;
@@ -390,6 +391,28 @@ INSTANTIATE_TEST_SUITE_P(RedisSingleServerRequestTest, RedisSingleServerRequestT
 INSTANTIATE_TEST_SUITE_P(RedisSimpleRequestCommandHandlerMixedCaseTests,
                          RedisSingleServerRequestTest, testing::Values("INCR", "inCrBY"));
 
+TEST_F(RedisSingleServerRequestTest, NearCacheHit) {
+  InSequence s;
+
+  Common::Redis::RespValuePtr request{new Common::Redis::RespValue()};
+  makeBulkStringArray(*request, {"get", "hello"});
+
+  Common::Redis::RespValue response;
+  response.type(Common::Redis::RespType::BulkString);
+  response.asString() = "world";
+
+  EXPECT_CALL(callbacks_, connectionAllowed()).WillOnce(Return(true));
+  EXPECT_CALL(*conn_pool_, lookupCached("hello", _))
+      .WillOnce(Return(ByMove(std::make_unique<Common::Redis::RespValue>(response))));
+  EXPECT_CALL(*conn_pool_, makeRequest_(_, _, _)).Times(0);
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&response)));
+  handle_ = splitter_.makeRequest(std::move(request), callbacks_, dispatcher_, stream_info_);
+  EXPECT_EQ(nullptr, handle_);
+
+  EXPECT_EQ(1UL, store_.counter("redis.foo.command.get.total").value());
+  EXPECT_EQ(1UL, store_.counter("redis.foo.command.get.success").value());
+};
+
 TEST_F(RedisSingleServerRequestTest, PingSuccess) {
   InSequence s;
 
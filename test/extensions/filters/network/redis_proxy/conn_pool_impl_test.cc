@@ -18,6 +18,7 @@
 #include "test/extensions/filters/network/common/redis/test_utils.h"
 #include "test/extensions/filters/network/redis_proxy/mocks.h"
 #include "test/mocks/api/mocks.h"
+#include "test/mocks/network/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
 #include "test/mocks/upstream/cluster.h"
 #include "test/mocks/upstream/cluster_manager.h"
@@ -93,11 +94,15 @@ public:
         std::make_shared<NiceMock<Extensions::Common::Redis::MockClusterRefreshManager>>();
     auto redis_command_stats =
         Common::Redis::RedisCommandStats::createRedisCommandStats(store_.symbolTable());
-    std::shared_ptr<InstanceImpl> conn_pool_impl = std::make_shared<InstanceImpl>(
-        cluster_name_, cm_, *this, tls_,
-        Common::Redis::Client::createConnPoolSettings(20, hashtagging, true, max_unknown_conns,
-                                                      read_policy_, redis_cx_rate_limit_per_sec),
-        api_, store_.rootScope(), redis_command_stats, cluster_refresh_manager_, dns_cache);
+    auto settings = Common::Redis::Client::createConnPoolSettings(
+        20, hashtagging, true, max_unknown_conns, read_policy_, redis_cx_rate_limit_per_sec);
+    if (near_cache_) {
+      settings.mutable_near_cache();
+    }
+    std::shared_ptr<InstanceImpl> conn_pool_impl =
+        std::make_shared<InstanceImpl>(cluster_name_, cm_, *this, tls_, settings, api_,
+                                       store_.rootScope(), redis_command_stats,
+                                       cluster_refresh_manager_, dns_cache);
     conn_pool_impl->init();
     // Set the authentication password for this connection pool.
     conn_pool_impl->tls_->getTyped<InstanceImpl::ThreadLocalPool>().auth_username_ = auth_username_;
@@ -332,6 +337,7 @@ public:
   std::shared_ptr<NiceMock<Extensions::Common::Redis::MockClusterRefreshManager>>
       cluster_refresh_manager_;
   Common::Redis::Client::NoOpTransaction transaction_;
+  bool near_cache_{};
 };
 
 TEST_F(RedisConnPoolImplTest, Basic) {
@@ -1622,6 +1628,82 @@ TEST_F(RedisConnPoolImplTest, MakeRequestAndRedirectFollowedByDelete) {
   tls_.shutdownThread();
 }
 
+TEST_F(RedisConnPoolImplTest, NearCache) {
+  near_cache_ = true;
+  setup();
+
+  auto makeGet = [](const std::string& key) {
+    auto value = std::make_shared<Common::Redis::RespValue>();
+    std::vector<Common::Redis::RespValue> args(2);
+    args[0].type(Common::Redis::RespType::BulkString);
+    args[0].asString() = "get";
+    args[1].type(Common::Redis::RespType::BulkString);
+    args[1].asString() = key;
+    value->type(Common::Redis::RespType::Array);
+    value->asArray().swap(args);
+    return value;
+  };
+  auto bulkString = [](const std::string& string) {
+    auto value = std::make_unique<Common::Redis::RespValue>();
+    value->type(Common::Redis::RespType::BulkString);
+    value->asString() = string;
+    return value;
+  };
+
+  auto& host = cm_.thread_local_cluster_.lb_.host_;
+  EXPECT_CALL(*host, address()).WillRepeatedly(Return(test_address_));
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(_)).WillRepeatedly(Return(host));
+  Common::Redis::Client::MockClient* client = new NiceMock<Common::Redis::Client::MockClient>();
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(client));
+
+  // The first cacheable read opens the invalidation connection. Reads are not cached until the
+  // data connection is tracked.
+  auto* listener_connection = new NiceMock<Network::MockClientConnection>();
+  Network::ReadFilterSharedPtr listener_read_filter;
+  Upstream::MockHost::MockCreateConnectionData conn_info;
+  conn_info.connection_ = listener_connection;
+  EXPECT_CALL(*host, createConnection_(_, _)).WillOnce(Return(conn_info));
+  EXPECT_CALL(*listener_connection, addReadFilter(_)).WillOnce(SaveArg<0>(&listener_read_filter));
+
+  Common::Redis::RespValueSharedPtr value = makeGet("foo");
+  Common::Redis::Client::MockPoolRequest active_request;
+  MockPoolCallbacks callbacks;
+  EXPECT_CALL(*client, makeRequest_(Ref(*value), _)).WillOnce(Return(&active_request));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", value, callbacks, transaction_));
+  EXPECT_CALL(callbacks, onResponse_(_));
+  client->client_callbacks_.back()->onResponse(bulkString("bar"));
+  EXPECT_EQ(nullptr, conn_pool_->lookupCached("foo", *value));
+
+  // Tracking is enabled once the listener is subscribed.
+  Common::Redis::Client::MockPoolRequest tracking_request;
+  EXPECT_CALL(*client, makeRequest_(Eq(InvalidationListener::trackingRequest(42)), _))
+      .WillOnce(Return(&tracking_request));
+  Buffer::OwnedImpl listener_data(
+      ":42\r\n*3\r\n$9\r\nsubscribe\r\n$20\r\n__redis__:invalidate\r\n:1\r\n");
+  listener_read_filter->onData(listener_data, false);
+  client->client_callbacks_.back()->onResponse(bulkString("OK"));
+
+  value = makeGet("foo");
+  EXPECT_CALL(*client, makeRequest_(Ref(*value), _)).WillOnce(Return(&active_request));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", value, callbacks, transaction_));
+  EXPECT_CALL(callbacks, onResponse_(_));
+  client->client_callbacks_.back()->onResponse(bulkString("bar"));
+
+  Common::Redis::RespValuePtr cached = conn_pool_->lookupCached("foo", *makeGet("foo"));
+  ASSERT_NE(nullptr, cached);
+  EXPECT_EQ(*bulkString("bar"), *cached);
+  EXPECT_EQ(nullptr, conn_pool_->lookupCached("foo", *makeGet("other")));
+
+  // An invalidation message removes the entry.
+  listener_data.add(
+      "*3\r\n$7\r\nmessage\r\n$20\r\n__redis__:invalidate\r\n*1\r\n$3\r\nfoo\r\n");
+  listener_read_filter->onData(listener_data, false);
+  EXPECT_EQ(nullptr, conn_pool_->lookupCached("foo", *makeGet("foo")));
+
+  EXPECT_CALL(*client, close());
+  tls_.shutdownThread();
+}
+
 } // namespace ConnPool
 } // namespace RedisProxy
 } // namespace NetworkFilters
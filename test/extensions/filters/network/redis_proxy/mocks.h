@@ -77,6 +77,7 @@ public:
 
   MOCK_METHOD(void, onResponse_, (Common::Redis::RespValuePtr & value));
   MOCK_METHOD(void, onFailure_, ());
+  MOCK_METHOD(bool, acceptsRawResponse, (), (const));
 };
 
 class MockInstance : public Instance {
@@ -92,6 +93,8 @@ public:
 
   MOCK_METHOD(Common::Redis::Client::PoolRequest*, makeRequest_,
               (const std::string& hash_key, RespVariant& request, PoolCallbacks& callbacks));
+  MOCK_METHOD(Common::Redis::RespValuePtr, lookupCached,
+              (const std::string& key, const Common::Redis::RespValue& request));
   MOCK_METHOD(bool, onRedirection, ());
 };
 } // namespace ConnPool
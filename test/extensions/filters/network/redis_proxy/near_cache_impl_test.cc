@@ -0,0 +1,405 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/extensions/filters/network/redis_proxy/v3/redis_proxy.pb.h"
+
+#include "source/common/common/fmt.h"
+#include "source/common/network/utility.h"
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/filters/network/redis_proxy/near_cache_impl.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/upstream/host.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::SaveArg;
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace ConnPool {
+
+class RedisNearCacheTest : public testing::Test {
+public:
+  RedisNearCacheTest()
+      : stats_{ALL_REDIS_NEAR_CACHE_STATS(POOL_COUNTER_PREFIX(*store_.rootScope(), "near_cache."),
+                                          POOL_GAUGE_PREFIX(*store_.rootScope(), "near_cache."))} {
+    setup("");
+  }
+
+  void setup(const std::string& yaml) {
+    envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::NearCache proto;
+    if (!yaml.empty()) {
+      TestUtility::loadFromYaml(yaml, proto);
+    }
+    cache_.reset();
+    config_ = std::make_unique<NearCacheConfig>(proto);
+    cache_ = std::make_unique<NearCache>(*config_, stats_, time_system_);
+  }
+
+  static Common::Redis::RespValue makeValue(const std::vector<std::string>& strings) {
+    std::vector<Common::Redis::RespValue> values(strings.size());
+    for (uint64_t i = 0; i < strings.size(); i++) {
+      values[i].type(Common::Redis::RespType::BulkString);
+      values[i].asString() = strings[i];
+    }
+    Common::Redis::RespValue value;
+    value.type(Common::Redis::RespType::Array);
+    value.asArray().swap(values);
+    return value;
+  }
+
+  static Common::Redis::RespValue bulkString(const std::string& string) {
+    Common::Redis::RespValue value;
+    value.type(Common::Redis::RespType::BulkString);
+    value.asString() = string;
+    return value;
+  }
+
+  void fill(const Common::Redis::RespValue& request, const Common::Redis::RespValue& response,
+            const Upstream::HostConstSharedPtr& host) {
+    const std::string& key = request.asArray()[1].asString();
+    const uint64_t generation = cache_->startFill(key, host);
+    cache_->completeFill(key, generation, host, request, &response);
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Stats::IsolatedStoreImpl store_;
+  NearCacheStats stats_;
+  std::unique_ptr<NearCacheConfig> config_;
+  std::unique_ptr<NearCache> cache_;
+  std::shared_ptr<NiceMock<Upstream::MockHost>> host_{new NiceMock<Upstream::MockHost>()};
+  std::shared_ptr<NiceMock<Upstream::MockHost>> other_host_{new NiceMock<Upstream::MockHost>()};
+};
+
+TEST_F(RedisNearCacheTest, DefaultCommands) {
+  EXPECT_TRUE(config_->cacheable(makeValue({"get", "foo"})));
+  EXPECT_TRUE(config_->cacheable(makeValue({"GET", "foo"})));
+  EXPECT_FALSE(config_->cacheable(makeValue({"get"})));
+  EXPECT_FALSE(config_->cacheable(makeValue({"hget", "foo", "bar"})));
+  EXPECT_FALSE(config_->cacheable(makeValue({"set", "foo", "bar"})));
+  EXPECT_EQ(10000, config_->maxEntries());
+  EXPECT_FALSE(config_->ttl().has_value());
+}
+
+TEST_F(RedisNearCacheTest, RejectsUncacheableCommands) {
+  EXPECT_THROW_WITH_MESSAGE(setup("commands: [get, incr]"), EnvoyException,
+                            "redis near cache: command 'incr' cannot be cached");
+}
+
+TEST_F(RedisNearCacheTest, HitAndMiss) {
+  setup("commands: [GET, hget]");
+  const Common::Redis::RespValue get = makeValue({"get", "foo"});
+  const Common::Redis::RespValue hget_a = makeValue({"hget", "foo", "a"});
+  const Common::Redis::RespValue hget_b = makeValue({"hget", "foo", "b"});
+  EXPECT_TRUE(config_->cacheable(hget_a));
+
+  EXPECT_EQ(nullptr, cache_->lookup("foo", get));
+  fill(get, bulkString("bar"), host_);
+  fill(hget_a, bulkString("1"), host_);
+
+  Common::Redis::RespValuePtr cached = cache_->lookup("foo", get);
+  ASSERT_NE(nullptr, cached);
+  EXPECT_EQ(bulkString("bar"), *cached);
+  cached = cache_->lookup("foo", hget_a);
+  ASSERT_NE(nullptr, cached);
+  EXPECT_EQ(bulkString("1"), *cached);
+  EXPECT_EQ(nullptr, cache_->lookup("foo", hget_b));
+
+  EXPECT_EQ(1, cache_->size());
+  EXPECT_EQ(2UL, store_.counter("near_cache.hit").value());
+  EXPECT_EQ(2UL, store_.counter("near_cache.miss").value());
+  EXPECT_EQ(2UL, store_.counter("near_cache.fill").value());
+  EXPECT_EQ(1UL, store_.gauge("near_cache.entries", Stats::Gauge::ImportMode::Accumulate).value());
+}
+
+TEST_F(RedisNearCacheTest, ErrorsAndFailuresNotCached) {
+  const Common::Redis::RespValue get = makeValue({"get", "foo"});
+  Common::Redis::RespValue error;
+  error.type(Common::Redis::RespType::Error);
+  error.asString() = "WRONGTYPE";
+  fill(get, error, host_);
+
+  Common::Redis::RespValue raw_error;
+  raw_error.type(Common::Redis::RespType::Raw);
+  raw_error.asRaw().add("-WRONGTYPE\r\n");
+  fill(get, raw_error, host_);
+
+  const uint64_t generation = cache_->startFill("foo", host_);
+  cache_->completeFill("foo", generation, host_, get, nullptr);
+
+  EXPECT_EQ(nullptr, cache_->lookup("foo", get));
+  EXPECT_EQ(0UL, store_.counter("near_cache.fill").value());
+}
+
+TEST_F(RedisNearCacheTest, RawResponse) {
+  const Common::Redis::RespValue get = makeValue({"get", "foo"});
+  Common::Redis::RespValue raw;
+  raw.type(Common::Redis::RespType::Raw);
+  raw.asRaw().add("$3\r\nbar\r\n");
+  fill(get, raw, host_);
+
+  Common::Redis::RespValuePtr cached = cache_->lookup("foo", get);
+  ASSERT_NE(nullptr, cached);
+  EXPECT_EQ(raw, *cached);
+}
+
+TEST_F(RedisNearCacheTest, Invalidate) {
+  const Common::Redis::RespValue get = makeValue({"get", "foo"});
+  fill(get, bulkString("bar"), host_);
+  cache_->invalidate("other");
+  cache_->invalidate("foo");
+  EXPECT_EQ(nullptr, cache_->lookup("foo", get));
+  EXPECT_EQ(0, cache_->size());
+  EXPECT_EQ(1UL, store_.counter("near_cache.invalidation").value());
+  EXPECT_EQ(0UL, store_.gauge("near_cache.entries", Stats::Gauge::ImportMode::Accumulate).value());
+}
+
+// A response read before an invalidation that arrived while it was in flight is not cached.
+TEST_F(RedisNearCacheTest, InvalidationDuringFill) {
+  const Common::Redis::RespValue get = makeValue({"get", "foo"});
+  const uint64_t first = cache_->startFill("foo", host_);
+  const uint64_t second = cache_->startFill("foo", host_);
+  cache_->invalidate("foo");
+  const Common::Redis::RespValue response = bulkString("bar");
+  cache_->completeFill("foo", first, host_, get, &response);
+  cache_->completeFill("foo", second, host_, get, &response);
+  EXPECT_EQ(nullptr, cache_->lookup("foo", get));
+  EXPECT_EQ(2UL, store_.counter("near_cache.fill_skipped").value());
+
+  // Once no fills are in flight, the key can be cached again.
+  fill(get, response, host_);
+  EXPECT_NE(nullptr, cache_->lookup("foo", get));
+}
+
+TEST_F(RedisNearCacheTest, Flush) {
+  const Common::Redis::RespValue get_foo = makeValue({"get", "foo"});
+  const Common::Redis::RespValue get_bar = makeValue({"get", "bar"});
+  fill(get_foo, bulkString("1"), host_);
+  fill(get_bar, bulkString("2"), other_host_);
+
+  const Common::Redis::RespValue get_baz = makeValue({"get", "baz"});
+  const uint64_t generation = cache_->startFill("baz", host_);
+  cache_->flush(host_);
+  const Common::Redis::RespValue response = bulkString("3");
+  cache_->completeFill("baz", generation, host_, get_baz, &response);
+
+  EXPECT_EQ(nullptr, cache_->lookup("foo", get_foo));
+  EXPECT_EQ(nullptr, cache_->lookup("baz", get_baz));
+  EXPECT_NE(nullptr, cache_->lookup("bar", get_bar));
+  EXPECT_EQ(1UL, store_.counter("near_cache.flush").value());
+  EXPECT_EQ(1UL, store_.counter("near_cache.fill_skipped").value());
+}
+
+TEST_F(RedisNearCacheTest, RemoveHost) {
+  const Common::Redis::RespValue get = makeValue({"get", "foo"});
+  fill(get, bulkString("1"), host_);
+  const uint64_t generation = cache_->startFill("foo", host_);
+  cache_->removeHost(host_);
+  const Common::Redis::RespValue response = bulkString("2");
+  cache_->completeFill("foo", generation, host_, get, &response);
+  EXPECT_EQ(nullptr, cache_->lookup("foo", get));
+}
+
+TEST_F(RedisNearCacheTest, LruEviction) {
+  setup("max_entries: 2");
+  const Common::Redis::RespValue get_a = makeValue({"get", "a"});
+  const Common::Redis::RespValue get_b = makeValue({"get", "b"});
+  const Common::Redis::RespValue get_c = makeValue({"get", "c"});
+  fill(get_a, bulkString("1"), host_);
+  fill(get_b, bulkString("2"), host_);
+  // Touch "a" so that "b" is the least recently used entry.
+  EXPECT_NE(nullptr, cache_->lookup("a", get_a));
+  fill(get_c, bulkString("3"), host_);
+
+  EXPECT_EQ(2, cache_->size());
+  EXPECT_NE(nullptr, cache_->lookup("a", get_a));
+  EXPECT_EQ(nullptr, cache_->lookup("b", get_b));
+  EXPECT_NE(nullptr, cache_->lookup("c", get_c));
+  EXPECT_EQ(1UL, store_.counter("near_cache.eviction").value());
+}
+
+TEST_F(RedisNearCacheTest, Ttl) {
+  setup("ttl: 1s");
+  const Common::Redis::RespValue get = makeValue({"get", "foo"});
+  fill(get, bulkString("bar"), host_);
+  time_system_.advanceTimeWait(std::chrono::milliseconds(999));
+  EXPECT_NE(nullptr, cache_->lookup("foo", get));
+  time_system_.advanceTimeWait(std::chrono::milliseconds(1));
+  EXPECT_EQ(nullptr, cache_->lookup("foo", get));
+  EXPECT_EQ(0, cache_->size());
+}
+
+TEST_F(RedisNearCacheTest, Clear) {
+  fill(makeValue({"get", "foo"}), bulkString("bar"), host_);
+  const Common::Redis::RespValue get = makeValue({"get", "baz"});
+  const uint64_t generation = cache_->startFill("baz", host_);
+  cache_->clear();
+  const Common::Redis::RespValue response = bulkString("1");
+  cache_->completeFill("baz", generation, host_, get, &response);
+  EXPECT_EQ(0, cache_->size());
+  EXPECT_EQ(0UL, store_.gauge("near_cache.entries", Stats::Gauge::ImportMode::Accumulate).value());
+}
+
+class MockInvalidationListenerCallbacks : public InvalidationListener::Callbacks {
+public:
+  MOCK_METHOD(void, onListenerReady, (const Upstream::HostConstSharedPtr& host, int64_t client_id));
+  MOCK_METHOD(void, onListenerClosed, (const Upstream::HostConstSharedPtr& host));
+};
+
+class RedisInvalidationListenerTest : public RedisNearCacheTest {
+public:
+  RedisInvalidationListenerTest() {
+    ON_CALL(*host_, address())
+        .WillByDefault(Return(Network::Utility::resolveUrl("tcp://127.0.0.1:6379")));
+  }
+
+  void expectConnect(const std::string& expected_write) {
+    upstream_connection_ = new NiceMock<Network::MockClientConnection>();
+    Upstream::MockHost::MockCreateConnectionData conn_info;
+    conn_info.connection_ = upstream_connection_;
+    EXPECT_CALL(*host_, createConnection_(_, _)).WillOnce(Return(conn_info));
+    EXPECT_CALL(*upstream_connection_, addReadFilter(_))
+        .WillOnce(SaveArg<0>(&upstream_read_filter_));
+    EXPECT_CALL(*upstream_connection_, connect());
+    EXPECT_CALL(*upstream_connection_, write(_, false))
+        .WillOnce(Invoke([expected_write](Buffer::Instance& data, bool) -> void {
+          EXPECT_EQ(expected_write, data.toString());
+          data.drain(data.length());
+        }));
+  }
+
+  void create(const std::string& username = "", const std::string& password = "") {
+    reconnect_timer_ = new Event::MockTimer(&dispatcher_);
+    listener_ = std::make_unique<InvalidationListener>(host_, dispatcher_, *cache_, callbacks_,
+                                                       username, password);
+  }
+
+  void onData(const std::string& data) {
+    Buffer::OwnedImpl buffer(data);
+    upstream_read_filter_->onData(buffer, false);
+  }
+
+  void subscribe(int64_t client_id) {
+    EXPECT_CALL(callbacks_, onListenerReady(_, client_id));
+    onData(fmt::format(":{}\r\n", client_id));
+    onData(SubscribeReply);
+    EXPECT_EQ(client_id, listener_->clientId());
+  }
+
+  static constexpr absl::string_view Handshake =
+      "*2\r\n$6\r\nCLIENT\r\n$2\r\nID\r\n"
+      "*2\r\n$9\r\nSUBSCRIBE\r\n$20\r\n__redis__:invalidate\r\n";
+  static constexpr absl::string_view SubscribeReply =
+      "*3\r\n$9\r\nsubscribe\r\n$20\r\n__redis__:invalidate\r\n:1\r\n";
+
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  Event::MockTimer* reconnect_timer_{};
+  NiceMock<Network::MockClientConnection>* upstream_connection_{};
+  Network::ReadFilterSharedPtr upstream_read_filter_;
+  MockInvalidationListenerCallbacks callbacks_;
+  InvalidationListenerPtr listener_;
+};
+
+TEST_F(RedisInvalidationListenerTest, TrackingRequest) {
+  Buffer::OwnedImpl buffer;
+  Common::Redis::EncoderImpl encoder;
+  encoder.encode(InvalidationListener::trackingRequest(42), buffer);
+  EXPECT_EQ("*5\r\n$6\r\nCLIENT\r\n$8\r\nTRACKING\r\n$2\r\non\r\n$8\r\nREDIRECT\r\n$2\r\n42\r\n",
+            buffer.toString());
+}
+
+TEST_F(RedisInvalidationListenerTest, Invalidations) {
+  expectConnect(std::string(Handshake));
+  create();
+  EXPECT_FALSE(listener_->clientId().has_value());
+  subscribe(42);
+
+  const Common::Redis::RespValue get_foo = makeValue({"get", "foo"});
+  const Common::Redis::RespValue get_bar = makeValue({"get", "bar"});
+  const Common::Redis::RespValue get_baz = makeValue({"get", "baz"});
+  fill(get_foo, bulkString("1"), host_);
+  fill(get_bar, bulkString("2"), host_);
+  fill(get_baz, bulkString("3"), host_);
+
+  // Messages on other channels are ignored.
+  onData("*3\r\n$7\r\nmessage\r\n$5\r\nother\r\n*1\r\n$3\r\nfoo\r\n");
+  EXPECT_NE(nullptr, cache_->lookup("foo", get_foo));
+
+  onData("*3\r\n$7\r\nmessage\r\n$20\r\n__redis__:invalidate\r\n*2\r\n$3\r\nfoo\r\n$3\r\nbar\r\n");
+  EXPECT_EQ(nullptr, cache_->lookup("foo", get_foo));
+  EXPECT_EQ(nullptr, cache_->lookup("bar", get_bar));
+  EXPECT_NE(nullptr, cache_->lookup("baz", get_baz));
+
+  // A null payload is sent when the server's databases are flushed.
+  onData("*3\r\n$7\r\nmessage\r\n$20\r\n__redis__:invalidate\r\n$-1\r\n");
+  EXPECT_EQ(nullptr, cache_->lookup("baz", get_baz));
+
+  EXPECT_CALL(callbacks_, onListenerClosed(_)).Times(0);
+  listener_.reset();
+}
+
+TEST_F(RedisInvalidationListenerTest, Auth) {
+  expectConnect(absl::StrCat("*3\r\n$4\r\nAUTH\r\n$4\r\nuser\r\n$4\r\npass\r\n", Handshake));
+  create("user", "pass");
+  onData("+OK\r\n");
+  subscribe(7);
+}
+
+TEST_F(RedisInvalidationListenerTest, AuthFailure) {
+  expectConnect(absl::StrCat("*2\r\n$4\r\nAUTH\r\n$4\r\npass\r\n", Handshake));
+  create("", "pass");
+  EXPECT_CALL(callbacks_, onListenerReady(_, _)).Times(0);
+  EXPECT_CALL(callbacks_, onListenerClosed(_)).Times(0);
+  EXPECT_CALL(*reconnect_timer_, enableTimer(InvalidationListener::ReconnectDelay, _));
+  onData("-WRONGPASS invalid password\r\n");
+  EXPECT_FALSE(listener_->clientId().has_value());
+}
+
+TEST_F(RedisInvalidationListenerTest, UnexpectedReply) {
+  expectConnect(std::string(Handshake));
+  create();
+  EXPECT_CALL(*reconnect_timer_, enableTimer(InvalidationListener::ReconnectDelay, _));
+  onData("-ERR unknown command\r\n");
+  EXPECT_FALSE(listener_->clientId().has_value());
+}
+
+TEST_F(RedisInvalidationListenerTest, ProtocolError) {
+  expectConnect(std::string(Handshake));
+  create();
+  EXPECT_CALL(*reconnect_timer_, enableTimer(InvalidationListener::ReconnectDelay, _));
+  onData("?\r\n");
+}
+
+TEST_F(RedisInvalidationListenerTest, Reconnect) {
+  expectConnect(std::string(Handshake));
+  create();
+  subscribe(42);
+
+  EXPECT_CALL(callbacks_, onListenerClosed(_));
+  EXPECT_CALL(*reconnect_timer_, enableTimer(InvalidationListener::ReconnectDelay, _));
+  upstream_connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_FALSE(listener_->clientId().has_value());
+
+  expectConnect(std::string(Handshake));
+  reconnect_timer_->invokeCallback();
+  subscribe(43);
+}
+
+} // namespace ConnPool
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -362,6 +362,35 @@ TEST_F(RedisProxyFilterTestWithTwoCallbacks, OutOfOrderResponseDownstreamDisconn
   filter_callbacks_.connection_.raiseEvent(Network::ConnectionEvent::RemoteClose);
 }
 
+TEST_F(RedisProxyFilterTestWithTwoCallbacks, RawResponse) {
+  InSequence s;
+
+  Buffer::OwnedImpl fake_data;
+  EXPECT_CALL(*decoder_, decode(Ref(fake_data)))
+      .WillOnce(Invoke(this, &RedisProxyFilterTestWithTwoCallbacks::decodeHelper));
+  EXPECT_EQ(Network::FilterStatus::Continue, filter_->onData(fake_data, false));
+
+  // A raw response is moved to the connection without going through the encoder.
+  Common::Redis::RespValuePtr response2(new Common::Redis::RespValue());
+  response2->type(Common::Redis::RespType::Raw);
+  response2->asRaw().add("$3\r\nbar\r\n");
+  request_callbacks2_->onResponse(std::move(response2));
+
+  Common::Redis::RespValuePtr response1(new Common::Redis::RespValue());
+  EXPECT_CALL(*encoder_, encode(Ref(*response1), _))
+      .WillOnce(Invoke([](const Common::Redis::RespValue&, Buffer::Instance& out) -> void {
+        out.add("+OK\r\n");
+      }));
+  EXPECT_CALL(filter_callbacks_.connection_, write(_, _))
+      .WillOnce(Invoke([](Buffer::Instance& data, bool) -> void {
+        EXPECT_EQ("+OK\r\n$3\r\nbar\r\n", data.toString());
+        data.drain(data.length());
+      }));
+  request_callbacks1_->onResponse(std::move(response1));
+
+  EXPECT_EQ(0UL, config_->stats_.downstream_rq_active_.value());
+}
+
 TEST_F(RedisProxyFilterTest, DownstreamDisconnectWithActive) {
   InSequence s;
 
@@ -220,6 +220,34 @@ server_config:
             - "10.0.0.1"
 )EOF";
 
+  const std::string forward_query_on_with_cache_config = R"EOF(
+stat_prefix: "my_prefix"
+client_config:
+  resolver_timeout: 1s
+  typed_dns_resolver_config:
+    name: envoy.network.dns_resolver.cares
+    typed_config:
+      "@type": type.googleapis.com/envoy.extensions.network.dns_resolver.cares.v3.CaresDnsResolverConfig
+      resolvers:
+      - socket_address:
+          address: "1.1.1.1"
+          port_value: 53
+  max_pending_lookups: 256
+  response_cache:
+    max_entries: 1
+    max_ttl: 30s
+    negative_ttl: 10s
+server_config:
+  inline_dns_table:
+    external_retry_count: 0
+    virtual_domains:
+      - name: "www.foo1.com"
+        endpoint:
+          address_list:
+            address:
+            - "10.0.0.1"
+)EOF";
+
   static constexpr absl::string_view external_dns_table_config = R"EOF(
 stat_prefix: "my_prefix"
 client_config:
@@ -1071,6 +1099,211 @@ TEST_F(DnsFilterTest, ExternalResolutionExceedMaxPendingLookups) {
   EXPECT_EQ(1, config_->stats().unanswered_queries_.value());
 }
 
+TEST_F(DnsFilterTest, ExternalResolutionResponseCached) {
+  const std::string expected_address("130.207.244.251");
+  const std::string domain("www.foobaz.com");
+  setup(forward_query_on_with_cache_config);
+
+  const std::string query =
+      Utils::buildQueryForDomain(domain, DNS_RECORD_TYPE_A, DNS_RECORD_CLASS_IN);
+  ASSERT_FALSE(query.empty());
+
+  Network::DnsResolver::ResolveCb resolve_cb;
+  EXPECT_CALL(*resolver_, resolve(domain, _, _))
+      .WillOnce(DoAll(SaveArg<2>(&resolve_cb), Return(&resolver_->active_query_)));
+  sendQueryFromClient("10.0.0.1:1000", query);
+
+  // The resolved TTL is capped to the max_ttl of the cache.
+  resolve_cb(Network::DnsResolver::ResolutionStatus::Success,
+             TestUtility::makeDnsResponse({expected_address}, std::chrono::seconds(60)));
+  response_ctx_ = ResponseValidator::createResponseContext(udp_response_, counters_);
+  EXPECT_TRUE(response_ctx_->parse_status_);
+  EXPECT_EQ(DNS_RESPONSE_CODE_NO_ERROR, response_ctx_->getQueryResponseCode());
+  ASSERT_EQ(1, response_ctx_->answers_.size());
+  EXPECT_EQ(30, response_ctx_->answers_.begin()->second->ttl_.count());
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(resolver_.get()));
+
+  // The same query is answered from the cache with the TTL left.
+  simTime().advanceTimeWait(std::chrono::seconds(10));
+  EXPECT_CALL(*resolver_, resolve(_, _, _)).Times(0);
+  sendQueryFromClient("10.0.0.2:1000", query);
+
+  response_ctx_ = ResponseValidator::createResponseContext(udp_response_, counters_);
+  EXPECT_TRUE(response_ctx_->parse_status_);
+  EXPECT_EQ(DNS_RESPONSE_CODE_NO_ERROR, response_ctx_->getQueryResponseCode());
+  ASSERT_EQ(1, response_ctx_->answers_.size());
+  std::list<std::string> expected{expected_address};
+  for (const auto& answer : response_ctx_->answers_) {
+    EXPECT_EQ(answer.first, domain);
+    EXPECT_EQ(20, answer.second->ttl_.count());
+    Utils::verifyAddress(expected, answer.second);
+  }
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(resolver_.get()));
+
+  // Once the cached response expires, the query is resolved again.
+  simTime().advanceTimeWait(std::chrono::seconds(21));
+  EXPECT_CALL(*resolver_, resolve(domain, _, _)).WillOnce(Return(&resolver_->active_query_));
+  sendQueryFromClient("10.0.0.1:1000", query);
+
+  // Validate stats
+  const auto& cache_stats = config_->responseCache()->stats();
+  EXPECT_EQ(1, cache_stats.hits_.value());
+  EXPECT_EQ(0, cache_stats.negative_hits_.value());
+  EXPECT_EQ(2, cache_stats.misses_.value());
+  EXPECT_EQ(1, cache_stats.insertions_.value());
+  EXPECT_EQ(0, cache_stats.entries_.value());
+  EXPECT_EQ(3, config_->stats().downstream_rx_queries_.value());
+  EXPECT_EQ(2, config_->stats().external_a_record_queries_.value());
+  EXPECT_EQ(1, config_->stats().external_a_record_answers_.value());
+
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(resolver_.get()));
+}
+
+TEST_F(DnsFilterTest, ExternalResolutionZeroTtlNotCached) {
+  const std::string expected_address("130.207.244.251");
+  const std::string domain("www.foobaz.com");
+  setup(forward_query_on_with_cache_config);
+
+  const std::string query =
+      Utils::buildQueryForDomain(domain, DNS_RECORD_TYPE_A, DNS_RECORD_CLASS_IN);
+  ASSERT_FALSE(query.empty());
+
+  Network::DnsResolver::ResolveCb resolve_cb;
+  EXPECT_CALL(*resolver_, resolve(domain, _, _))
+      .WillOnce(DoAll(SaveArg<2>(&resolve_cb), Return(&resolver_->active_query_)));
+  sendQueryFromClient("10.0.0.1:1000", query);
+
+  // A TTL of 0 from the resolver is passed on instead of the domain TTL.
+  resolve_cb(Network::DnsResolver::ResolutionStatus::Success,
+             TestUtility::makeDnsResponse({expected_address}, std::chrono::seconds(0)));
+  response_ctx_ = ResponseValidator::createResponseContext(udp_response_, counters_);
+  EXPECT_TRUE(response_ctx_->parse_status_);
+  EXPECT_EQ(DNS_RESPONSE_CODE_NO_ERROR, response_ctx_->getQueryResponseCode());
+  ASSERT_EQ(1, response_ctx_->answers_.size());
+  EXPECT_EQ(0, response_ctx_->answers_.begin()->second->ttl_.count());
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(resolver_.get()));
+
+  // The answer is not cached, so the next query is resolved again.
+  EXPECT_CALL(*resolver_, resolve(domain, _, _)).WillOnce(Return(&resolver_->active_query_));
+  sendQueryFromClient("10.0.0.1:1000", query);
+
+  const auto& cache_stats = config_->responseCache()->stats();
+  EXPECT_EQ(0, cache_stats.hits_.value());
+  EXPECT_EQ(2, cache_stats.misses_.value());
+  EXPECT_EQ(0, cache_stats.insertions_.value());
+
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(resolver_.get()));
+}
+
+TEST_F(DnsFilterTest, ExternalResolutionNegativeResponseCached) {
+  const std::string domain("www.foobaz.com");
+  setup(forward_query_on_with_cache_config);
+
+  const std::string query =
+      Utils::buildQueryForDomain(domain, DNS_RECORD_TYPE_AAAA, DNS_RECORD_CLASS_IN);
+  ASSERT_FALSE(query.empty());
+
+  Network::DnsResolver::ResolveCb resolve_cb;
+  EXPECT_CALL(*resolver_, resolve(domain, _, _))
+      .WillOnce(DoAll(SaveArg<2>(&resolve_cb), Return(&resolver_->active_query_)));
+  sendQueryFromClient("10.0.0.1:1000", query);
+  resolve_cb(Network::DnsResolver::ResolutionStatus::Success, {});
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(resolver_.get()));
+
+  // The absence of addresses is cached for the negative_ttl.
+  simTime().advanceTimeWait(std::chrono::seconds(5));
+  EXPECT_CALL(*resolver_, resolve(_, _, _)).Times(0);
+  sendQueryFromClient("10.0.0.1:1000", query);
+
+  response_ctx_ = ResponseValidator::createResponseContext(udp_response_, counters_);
+  EXPECT_TRUE(response_ctx_->parse_status_);
+  EXPECT_EQ(DNS_RESPONSE_CODE_NAME_ERROR, response_ctx_->getQueryResponseCode());
+  EXPECT_EQ(0, response_ctx_->answers_.size());
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(resolver_.get()));
+
+  simTime().advanceTimeWait(std::chrono::seconds(6));
+  EXPECT_CALL(*resolver_, resolve(domain, _, _)).WillOnce(Return(&resolver_->active_query_));
+  sendQueryFromClient("10.0.0.1:1000", query);
+
+  // Validate stats
+  const auto& cache_stats = config_->responseCache()->stats();
+  EXPECT_EQ(0, cache_stats.hits_.value());
+  EXPECT_EQ(1, cache_stats.negative_hits_.value());
+  EXPECT_EQ(2, cache_stats.misses_.value());
+  EXPECT_EQ(1, cache_stats.insertions_.value());
+  EXPECT_EQ(2, config_->stats().unanswered_queries_.value());
+
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(resolver_.get()));
+}
+
+TEST_F(DnsFilterTest, ExternalResolutionFailureNotCached) {
+  const std::string domain("www.foobaz.com");
+  setup(forward_query_on_with_cache_config);
+
+  const std::string query =
+      Utils::buildQueryForDomain(domain, DNS_RECORD_TYPE_A, DNS_RECORD_CLASS_IN);
+  ASSERT_FALSE(query.empty());
+
+  Network::DnsResolver::ResolveCb resolve_cb;
+  EXPECT_CALL(*resolver_, resolve(domain, _, _))
+      .WillOnce(DoAll(SaveArg<2>(&resolve_cb), Return(&resolver_->active_query_)));
+  sendQueryFromClient("10.0.0.1:1000", query);
+  resolve_cb(Network::DnsResolver::ResolutionStatus::Failure, {});
+
+  response_ctx_ = ResponseValidator::createResponseContext(udp_response_, counters_);
+  EXPECT_TRUE(response_ctx_->parse_status_);
+  EXPECT_EQ(DNS_RESPONSE_CODE_NAME_ERROR, response_ctx_->getQueryResponseCode());
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(resolver_.get()));
+
+  // A failed resolution is retried by the next query.
+  EXPECT_CALL(*resolver_, resolve(domain, _, _)).WillOnce(Return(&resolver_->active_query_));
+  sendQueryFromClient("10.0.0.1:1000", query);
+
+  const auto& cache_stats = config_->responseCache()->stats();
+  EXPECT_EQ(2, cache_stats.misses_.value());
+  EXPECT_EQ(0, cache_stats.insertions_.value());
+
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(resolver_.get()));
+}
+
+TEST_F(DnsFilterTest, ExternalResolutionCacheEvictsLeastRecentlyUsed) {
+  const std::string domain1("www.foobaz.com");
+  const std::string domain2("www.foobar.com");
+  setup(forward_query_on_with_cache_config);
+
+  const std::string query1 =
+      Utils::buildQueryForDomain(domain1, DNS_RECORD_TYPE_A, DNS_RECORD_CLASS_IN);
+  ASSERT_FALSE(query1.empty());
+  const std::string query2 =
+      Utils::buildQueryForDomain(domain2, DNS_RECORD_TYPE_A, DNS_RECORD_CLASS_IN);
+  ASSERT_FALSE(query2.empty());
+
+  Network::DnsResolver::ResolveCb resolve_cb;
+  EXPECT_CALL(*resolver_, resolve(domain1, _, _))
+      .WillOnce(DoAll(SaveArg<2>(&resolve_cb), Return(&resolver_->active_query_)));
+  sendQueryFromClient("10.0.0.1:1000", query1);
+  resolve_cb(Network::DnsResolver::ResolutionStatus::Success,
+             TestUtility::makeDnsResponse({"10.0.0.10"}));
+
+  // The cache holds a single entry, so caching the second name evicts the first.
+  EXPECT_CALL(*resolver_, resolve(domain2, _, _))
+      .WillOnce(DoAll(SaveArg<2>(&resolve_cb), Return(&resolver_->active_query_)));
+  sendQueryFromClient("10.0.0.1:1000", query2);
+  resolve_cb(Network::DnsResolver::ResolutionStatus::Success,
+             TestUtility::makeDnsResponse({"10.0.0.20"}));
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(resolver_.get()));
+
+  EXPECT_CALL(*resolver_, resolve(domain1, _, _)).WillOnce(Return(&resolver_->active_query_));
+  sendQueryFromClient("10.0.0.1:1000", query1);
+
+  const auto& cache_stats = config_->responseCache()->stats();
+  EXPECT_EQ(2, cache_stats.insertions_.value());
+  EXPECT_EQ(1, cache_stats.evictions_.value());
+  EXPECT_EQ(1, cache_stats.entries_.value());
+
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(resolver_.get()));
+}
+
 TEST_F(DnsFilterTest, ConsumeExternalJsonTableTest) {
   InSequence s;
 
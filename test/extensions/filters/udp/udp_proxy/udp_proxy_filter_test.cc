@@ -2,6 +2,7 @@
 #include "envoy/extensions/access_loggers/file/v3/file.pb.h"
 #include "envoy/extensions/filters/udp/udp_proxy/v3/udp_proxy.pb.h"
 #include "envoy/extensions/filters/udp/udp_proxy/v3/udp_proxy.pb.validate.h"
+#include "envoy/extensions/udp_packet_writer/v3/udp_gso_batch_writer_factory.pb.h"
 
 #include "source/common/api/os_sys_calls_impl.h"
 #include "source/common/common/hash.h"
@@ -17,6 +18,7 @@
 #include "test/extensions/filters/udp/udp_proxy/session_filters/drainer_filter.pb.h"
 #include "test/mocks/api/mocks.h"
 #include "test/mocks/http/stream_encoder.h"
+#include "test/mocks/network/mocks.h"
 #include "test/mocks/network/socket.h"
 #include "test/mocks/server/factory_context.h"
 #include "test/mocks/server/listener_factory_context.h"
@@ -26,6 +28,7 @@
 #include "test/mocks/upstream/host.h"
 #include "test/mocks/upstream/load_balancer_context.h"
 #include "test/mocks/upstream/thread_local_cluster.h"
+#include "test/test_common/registry.h"
 #include "test/test_common/threadsafe_singleton_injector.h"
 
 #include "gmock/gmock.h"
@@ -65,6 +68,38 @@ Api::IoCallUint64Result makeError(int sys_errno) {
   return {0, Network::IoSocketError::create(sys_errno)};
 }
 
+// Creates batch mode mock writers in place of the GSO batch writer.
+class TestUdpPacketWriterFactoryFactory : public Network::UdpPacketWriterFactoryFactory {
+public:
+  std::string name() const override { return "envoy.udp_packet_writer.gso"; }
+  Network::UdpPacketWriterFactoryPtr
+  createUdpPacketWriterFactory(const envoy::config::core::v3::TypedExtensionConfig&) override {
+    auto factory = std::make_unique<NiceMock<Network::MockUdpPacketWriterFactory>>();
+    ON_CALL(*factory, createUdpPacketWriter(_, _))
+        .WillByDefault(Invoke([this](Network::IoHandle&, Stats::Scope&) {
+          auto writer = std::make_unique<NiceMock<Network::MockUdpPacketWriter>>();
+          ON_CALL(*writer, isBatchMode()).WillByDefault(Return(true));
+          ON_CALL(*writer, writePacket(_, _, _))
+              .WillByDefault(
+                  Invoke([](const Buffer::Instance& buffer, const Network::Address::Ip*,
+                            const Network::Address::Instance&) -> Api::IoCallUint64Result {
+                    return makeNoError(buffer.length());
+                  }));
+          ON_CALL(*writer, flush()).WillByDefault(InvokeWithoutArgs([]() {
+            return makeNoError(0);
+          }));
+          writers_.push_back(writer.get());
+          return Network::UdpPacketWriterPtr{std::move(writer)};
+        }));
+    return factory;
+  }
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return std::make_unique<envoy::extensions::udp_packet_writer::v3::UdpGsoBatchWriterFactory>();
+  }
+
+  std::vector<Network::MockUdpPacketWriter*> writers_;
+};
+
 class UdpProxyFilterBase : public testing::Test {
 public:
   UdpProxyFilterBase() {
@@ -670,6 +705,102 @@ matcher:
   EXPECT_EQ(output_.back(), "fake_cluster 0 10 1 0 2");
 }
 
+// Verify that datagrams are dropped while the upstream socket is write blocked, and that writes
+// resume once the socket becomes writable.
+TEST_F(UdpProxyFilterTest, UpstreamWriteBlocked) {
+  InSequence s;
+
+  setup(readConfig(R"EOF(
+stat_prefix: foo
+matcher:
+  on_no_match:
+    action:
+      name: route
+      typed_config:
+        '@type': type.googleapis.com/envoy.extensions.filters.udp.udp_proxy.v3.Route
+        cluster: fake_cluster
+  )EOF"));
+
+  expectSessionCreate(upstream_address_);
+  test_sessions_[0].expectWriteToUpstream("hello", EAGAIN, nullptr, true);
+  EXPECT_CALL(*test_sessions_[0].socket_->io_handle_,
+              enableFileEvents(Event::FileReadyType::Read | Event::FileReadyType::Write));
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello");
+  EXPECT_EQ(1, TestUtility::findCounter(factory_context_.server_factory_context_.cluster_manager_
+                                            .thread_local_cluster_.cluster_.info_->stats_store_,
+                                        "udp.sess_tx_errors")
+                   ->value());
+
+  // The socket is still blocked, so the datagram is dropped without a write.
+  EXPECT_CALL(*test_sessions_[0].idle_timer_, enableTimer(config_->sessionTimeout(), nullptr));
+  EXPECT_CALL(*test_sessions_[0].socket_->io_handle_, sendmsg(_, _, _, _, _)).Times(0);
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello2");
+  EXPECT_EQ(2, TestUtility::findCounter(factory_context_.server_factory_context_.cluster_manager_
+                                            .thread_local_cluster_.cluster_.info_->stats_store_,
+                                        "udp.sess_tx_errors")
+                   ->value());
+
+  EXPECT_CALL(*test_sessions_[0].socket_->io_handle_,
+              enableFileEvents(Event::FileReadyType::Read));
+  test_sessions_[0].file_event_cb_(Event::FileReadyType::Write);
+
+  test_sessions_[0].expectWriteToUpstream("hello3");
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello3");
+  EXPECT_EQ(1, TestUtility::findCounter(factory_context_.server_factory_context_.cluster_manager_
+                                            .thread_local_cluster_.cluster_.info_->stats_store_,
+                                        "udp.sess_tx_datagrams")
+                   ->value());
+}
+
+// Verify that a batch mode upstream writer is flushed once per event loop iteration.
+TEST_F(UdpProxyFilterTest, BatchedUpstreamWrites) {
+  TestUdpPacketWriterFactoryFactory writer_factory;
+  Registry::InjectFactory<Network::UdpPacketWriterFactoryFactory> registration(writer_factory);
+
+  setup(readConfig(R"EOF(
+stat_prefix: foo
+matcher:
+  on_no_match:
+    action:
+      name: route
+      typed_config:
+        '@type': type.googleapis.com/envoy.extensions.filters.udp.udp_proxy.v3.Route
+        cluster: fake_cluster
+upstream_udp_packet_writer_config:
+  name: envoy.udp_packet_writer.gso
+  typed_config:
+    '@type': type.googleapis.com/envoy.extensions.udp_packet_writer.v3.UdpGsoBatchWriterFactory
+  )EOF"));
+
+  auto* flush_cb =
+      new NiceMock<Event::MockSchedulableCallback>(&callbacks_.udp_listener_.dispatcher_);
+  expectSessionCreate(upstream_address_);
+  EXPECT_CALL(*test_sessions_[0].idle_timer_, enableTimer(config_->sessionTimeout(), nullptr))
+      .Times(3);
+  EXPECT_CALL(*test_sessions_[0].socket_->io_handle_, connect(_));
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello");
+  ASSERT_EQ(1, writer_factory.writers_.size());
+  Network::MockUdpPacketWriter& writer = *writer_factory.writers_[0];
+
+  EXPECT_CALL(writer, writePacket(_, nullptr, _)).Times(2);
+  EXPECT_CALL(writer, flush()).Times(0);
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello");
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello");
+  EXPECT_TRUE(flush_cb->enabled_);
+  EXPECT_EQ(3, TestUtility::findCounter(factory_context_.server_factory_context_.cluster_manager_
+                                            .thread_local_cluster_.cluster_.info_->stats_store_,
+                                        "udp.sess_tx_datagrams")
+                   ->value());
+
+  EXPECT_CALL(writer, flush()).WillOnce(InvokeWithoutArgs([]() { return makeNoError(15); }));
+  flush_cb->invokeCallback();
+  testing::Mock::VerifyAndClearExpectations(&writer);
+
+  // Nothing is pending anymore, but the session still flushes its writer when it goes away.
+  EXPECT_CALL(writer, flush()).WillOnce(InvokeWithoutArgs([]() { return makeNoError(0); }));
+  filter_.reset();
+}
+
 // Verify upstream connect error handling.
 TEST_F(UdpProxyFilterTest, ConnectErrorHandling) {
   InSequence s;
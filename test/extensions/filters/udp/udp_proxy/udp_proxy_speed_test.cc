@@ -0,0 +1,158 @@
+// Benchmarks forwarding downstream datagrams of many sessions through the UDP proxy filter to a
+// real loopback upstream socket, with the default and the GSO batch upstream writers.
+
+#include "envoy/extensions/filters/udp/udp_proxy/v3/udp_proxy.pb.h"
+
+#include "source/common/api/os_sys_calls_impl.h"
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/network/utility.h"
+#include "source/extensions/filters/udp/udp_proxy/config.h"
+#include "source/extensions/filters/udp/udp_proxy/udp_proxy_filter.h"
+
+#include "test/benchmark/main.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/server/factory_context.h"
+#include "test/mocks/upstream/cluster_manager.h"
+#include "test/mocks/upstream/host.h"
+#include "test/mocks/upstream/thread_local_cluster.h"
+#include "test/test_common/network_utility.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+#include "gmock/gmock.h"
+
+using ::benchmark::State;
+using Envoy::benchmark::skipExpensiveBenchmarks;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace UdpProxy {
+namespace {
+
+constexpr uint64_t DatagramSize = 512;
+
+class UdpProxySpeedTest {
+public:
+  UdpProxySpeedTest(uint32_t sessions, bool gso)
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")) {
+    // The upstream socket is never read. Datagrams it cannot queue are dropped by the kernel.
+    auto upstream = Network::Test::bindFreeLoopbackPort(Network::Address::IpVersion::v4,
+                                                        Network::Socket::Type::Datagram);
+    upstream_address_ = upstream.first;
+    upstream_socket_ = std::move(upstream.second);
+
+    auto& cluster_manager = factory_context_.server_factory_context_.cluster_manager_;
+    cluster_manager.initializeThreadLocalClusters({"fake_cluster"});
+    ON_CALL(*cluster_manager.thread_local_cluster_.lb_.host_, address())
+        .WillByDefault(Return(upstream_address_));
+    ON_CALL(*cluster_manager.thread_local_cluster_.lb_.host_, coarseHealth())
+        .WillByDefault(Return(Upstream::Host::Health::Healthy));
+    cluster_manager.thread_local_cluster_.cluster_.info_->resetResourceManager(sessions, 0, 0, 0,
+                                                                               0);
+    ON_CALL(callbacks_.udp_listener_, dispatcher()).WillByDefault(ReturnRef(*dispatcher_));
+
+    envoy::extensions::filters::udp::udp_proxy::v3::UdpProxyConfig config;
+    TestUtility::loadFromYaml(R"EOF(
+stat_prefix: foo
+matcher:
+  on_no_match:
+    action:
+      name: route
+      typed_config:
+        '@type': type.googleapis.com/envoy.extensions.filters.udp.udp_proxy.v3.Route
+        cluster: fake_cluster
+    )EOF",
+                              config);
+    if (gso) {
+      TestUtility::loadFromYaml(R"EOF(
+name: envoy.udp_packet_writer.gso
+typed_config:
+  '@type': type.googleapis.com/envoy.extensions.udp_packet_writer.v3.UdpGsoBatchWriterFactory
+      )EOF",
+                                *config.mutable_upstream_udp_packet_writer_config());
+    }
+    config_ = std::make_shared<UdpProxyFilterConfigImpl>(factory_context_, config);
+    filter_ = std::make_unique<UdpProxyFilter>(callbacks_, config_);
+
+    local_address_ = Network::Utility::parseInternetAddressAndPort("10.0.0.2:80");
+    for (uint32_t i = 0; i < sessions; i++) {
+      peer_addresses_.push_back(Network::Utility::parseInternetAddressAndPort(
+          fmt::format("10.0.{}.{}:1000", i / 250, i % 250 + 1)));
+    }
+  }
+
+  ~UdpProxySpeedTest() {
+    filter_.reset();
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+
+  // Receives datagrams_per_session datagrams for each session, then runs the event loop once so
+  // that batched datagrams are flushed.
+  void forwardDatagrams(uint32_t datagrams_per_session) {
+    for (const auto& peer_address : peer_addresses_) {
+      for (uint32_t i = 0; i < datagrams_per_session; i++) {
+        Network::UdpRecvData data;
+        data.addresses_.peer_ = peer_address;
+        data.addresses_.local_ = local_address_;
+        data.buffer_ = std::make_unique<Buffer::OwnedImpl>(payload_);
+        filter_->onData(data);
+      }
+    }
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+
+private:
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context_;
+  NiceMock<Network::MockUdpReadFilterCallbacks> callbacks_;
+  Network::Address::InstanceConstSharedPtr upstream_address_;
+  Network::SocketPtr upstream_socket_;
+  UdpProxyFilterConfigSharedPtr config_;
+  std::unique_ptr<UdpProxyFilter> filter_;
+  Network::Address::InstanceConstSharedPtr local_address_;
+  std::vector<Network::Address::InstanceConstSharedPtr> peer_addresses_;
+  const std::string payload_ = std::string(DatagramSize, 'a');
+};
+
+// Forwards datagrams_per_session datagrams for each of sessions sessions per iteration. Reports
+// the forwarded datagrams per second.
+void forwardDatagrams(State& state, bool gso) {
+  // If we've been instructed to skip tests, only run with one session.
+  const uint32_t sessions = skipExpensiveBenchmarks() ? 1 : state.range(0);
+  const uint32_t datagrams_per_session = state.range(1);
+  if (gso && !Api::OsSysCallsSingleton::get().supportsUdpGso()) {
+    state.SkipWithError("UDP GSO is not supported");
+    return;
+  }
+
+  UdpProxySpeedTest test(sessions, gso);
+  // Create the sessions outside of the measurement.
+  test.forwardDatagrams(1);
+  for (auto _ : state) { // NOLINT
+    test.forwardDatagrams(datagrams_per_session);
+  }
+  state.SetItemsProcessed(state.iterations() * sessions * datagrams_per_session);
+}
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_UdpProxyDefaultWriter(State& state) { forwardDatagrams(state, false); }
+BENCHMARK(BM_UdpProxyDefaultWriter)
+    ->ArgsProduct({{1, 100, 1000}, {1, 8}})
+    ->Unit(::benchmark::kMicrosecond);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_UdpProxyGsoWriter(State& state) { forwardDatagrams(state, true); }
+BENCHMARK(BM_UdpProxyGsoWriter)
+    ->ArgsProduct({{1, 100, 1000}, {1, 8}})
+    ->Unit(::benchmark::kMicrosecond);
+
+} // namespace
+} // namespace UdpProxy
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,156 @@
+#include <chrono>
+
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/health_checkers/common/shared_session_registry.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::InSequence;
+using testing::Invoke;
+using testing::Return;
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+class MockSharedHealthCheckSubscriber : public SharedHealthCheckSubscriber {
+public:
+  MOCK_METHOD(void, onSharedLeadership, ());
+  MOCK_METHOD(std::chrono::milliseconds, onSharedResult, (const SharedHealthCheckResult& result));
+};
+
+class SharedSessionRegistryTest : public testing::Test {
+public:
+  uint64_t counter(const std::string& name) {
+    return store_.counterFromString("health_check.shared." + name).value();
+  }
+  uint64_t gauge(const std::string& name) {
+    return store_
+        .gaugeFromString("health_check.shared." + name, Stats::Gauge::ImportMode::NeverImport)
+        .value();
+  }
+
+  Stats::IsolatedStoreImpl store_;
+  SharedSessionRegistry registry_{*store_.rootScope()};
+  MockSharedHealthCheckSubscriber a_;
+  MockSharedHealthCheckSubscriber b_;
+  MockSharedHealthCheckSubscriber c_;
+};
+
+TEST_F(SharedSessionRegistryTest, LeaderFansOutToFollowers) {
+  auto sub_a = registry_.subscribe("key", "key", a_);
+  auto sub_b = registry_.subscribe("key", "key", b_);
+  auto sub_c = registry_.subscribe("key", "key", c_);
+  EXPECT_TRUE(sub_a->leader());
+  EXPECT_FALSE(sub_b->leader());
+  EXPECT_FALSE(sub_c->leader());
+  EXPECT_FALSE(sub_b->lastResult().has_value());
+  EXPECT_EQ(1, gauge("sessions"));
+  EXPECT_EQ(3, gauge("subscribers"));
+
+  SharedHealthCheckResult result{false, false, envoy::data::core::v3::NETWORK, false};
+  EXPECT_CALL(b_, onSharedResult(_)).WillOnce(Return(std::chrono::milliseconds(5000)));
+  EXPECT_CALL(c_, onSharedResult(_))
+      .WillOnce(Invoke([](const SharedHealthCheckResult& result) {
+        EXPECT_FALSE(result.healthy_);
+        EXPECT_EQ(envoy::data::core::v3::NETWORK, result.failure_type_);
+        return std::chrono::milliseconds(2000);
+      }));
+  EXPECT_EQ(std::chrono::milliseconds(2000), sub_a->publish(result).value());
+  EXPECT_EQ(2, counter("fanout"));
+  EXPECT_FALSE(sub_c->lastResult()->healthy_);
+}
+
+TEST_F(SharedSessionRegistryTest, DistinctKeys) {
+  auto sub_a = registry_.subscribe("key1", "key1", a_);
+  auto sub_b = registry_.subscribe("key2", "key2", b_);
+  EXPECT_TRUE(sub_a->leader());
+  EXPECT_TRUE(sub_b->leader());
+  EXPECT_EQ(2, gauge("sessions"));
+  EXPECT_FALSE(sub_a->publish(SharedHealthCheckResult{true, false, {}, false}).has_value());
+  EXPECT_EQ(0, counter("fanout"));
+
+  sub_a.reset();
+  sub_b.reset();
+  EXPECT_EQ(0, gauge("sessions"));
+  EXPECT_EQ(0, gauge("subscribers"));
+}
+
+TEST_F(SharedSessionRegistryTest, LeaderHandoff) {
+  InSequence s;
+  auto sub_a = registry_.subscribe("key", "key", a_);
+  auto sub_b = registry_.subscribe("key", "key", b_);
+  auto sub_c = registry_.subscribe("key", "key", c_);
+
+  // Followers are promoted in subscription order.
+  EXPECT_CALL(b_, onSharedLeadership());
+  sub_a.reset();
+  EXPECT_TRUE(sub_b->leader());
+  EXPECT_EQ(1, counter("leader_handoff"));
+
+  // Removing a follower does not change the leader.
+  sub_c.reset();
+  EXPECT_TRUE(sub_b->leader());
+  EXPECT_EQ(1, gauge("subscribers"));
+
+  // A new subscriber joins as a follower of the current leader.
+  auto sub_a2 = registry_.subscribe("key", "key", a_);
+  EXPECT_FALSE(sub_a2->leader());
+
+  sub_b.reset();
+  EXPECT_TRUE(sub_a2->leader());
+  sub_a2.reset();
+  EXPECT_EQ(0, gauge("sessions"));
+  EXPECT_EQ(2, counter("leader_handoff"));
+}
+
+// Each shared session has its own stats next to the aggregate ones.
+TEST_F(SharedSessionRegistryTest, PerSessionStats) {
+  auto sub_a = registry_.subscribe("key1", "10_0_0_1_80.1", a_);
+  auto sub_b = registry_.subscribe("key1", "10_0_0_1_80.1", b_);
+  auto sub_c = registry_.subscribe("key2", "10_0_0_2_80.1", c_);
+  EXPECT_EQ(2, gauge("10_0_0_1_80.1.subscribers"));
+  EXPECT_EQ(1, gauge("10_0_0_2_80.1.subscribers"));
+
+  EXPECT_CALL(b_, onSharedResult(_)).WillOnce(Return(std::chrono::milliseconds(1000)));
+  sub_a->publish(SharedHealthCheckResult{true, false, {}, false});
+  EXPECT_FALSE(sub_c->publish(SharedHealthCheckResult{true, false, {}, false}).has_value());
+  EXPECT_EQ(1, counter("10_0_0_1_80.1.fanout"));
+  EXPECT_EQ(0, counter("10_0_0_2_80.1.fanout"));
+
+  EXPECT_CALL(b_, onSharedLeadership());
+  sub_a.reset();
+  EXPECT_EQ(1, counter("10_0_0_1_80.1.leader_handoff"));
+  EXPECT_EQ(0, counter("10_0_0_2_80.1.leader_handoff"));
+  EXPECT_EQ(1, gauge("10_0_0_1_80.1.subscribers"));
+  EXPECT_EQ(1, counter("leader_handoff"));
+  EXPECT_EQ(2, gauge("subscribers"));
+
+  sub_b.reset();
+  sub_c.reset();
+  EXPECT_EQ(0, gauge("10_0_0_1_80.1.subscribers"));
+  EXPECT_EQ(0, gauge("10_0_0_2_80.1.subscribers"));
+}
+
+// A follower whose host status callbacks remove another follower during the fan out.
+TEST_F(SharedSessionRegistryTest, UnsubscribeDuringPublish) {
+  auto sub_a = registry_.subscribe("key", "key", a_);
+  auto sub_b = registry_.subscribe("key", "key", b_);
+  auto sub_c = registry_.subscribe("key", "key", c_);
+
+  EXPECT_CALL(b_, onSharedResult(_)).WillOnce(Invoke([&](const SharedHealthCheckResult&) {
+    sub_c.reset();
+    return std::chrono::milliseconds(1000);
+  }));
+  EXPECT_CALL(c_, onSharedResult(_)).Times(0);
+  EXPECT_EQ(std::chrono::milliseconds(1000),
+            sub_a->publish(SharedHealthCheckResult{true, false, {}, false}).value());
+  EXPECT_EQ(1, counter("fanout"));
+  EXPECT_EQ(2, gauge("subscribers"));
+}
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
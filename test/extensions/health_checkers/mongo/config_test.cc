@@ -0,0 +1,95 @@
+#include "source/common/upstream/health_checker_impl.h"
+#include "source/extensions/health_checkers/mongo/config.h"
+
+#include "test/common/upstream/utility.h"
+#include "test/mocks/server/factory_context.h"
+#include "test/mocks/server/health_checker_factory_context.h"
+#include "test/mocks/upstream/health_checker.h"
+#include "test/mocks/upstream/priority_set.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HealthCheckers {
+namespace MongoHealthChecker {
+namespace {
+
+using CustomMongoHealthChecker = Extensions::HealthCheckers::MongoHealthChecker::MongoHealthChecker;
+
+TEST(HealthCheckerFactoryTest, CreateMongo) {
+  const std::string yaml = R"EOF(
+    timeout: 1s
+    interval: 1s
+    no_traffic_interval: 5s
+    interval_jitter: 1s
+    unhealthy_threshold: 1
+    healthy_threshold: 1
+    custom_health_check:
+      name: mongo
+      typed_config:
+        "@type": type.googleapis.com/envoy.extensions.health_checkers.mongo.v3.Mongo
+        expected_role: PRIMARY
+        max_staleness: 30s
+    )EOF";
+
+  NiceMock<Server::Configuration::MockHealthCheckerFactoryContext> context;
+
+  MongoHealthCheckerFactory factory;
+  EXPECT_NE(
+      nullptr,
+      dynamic_cast<CustomMongoHealthChecker*>(
+          factory.createCustomHealthChecker(Upstream::parseHealthCheckFromV3Yaml(yaml), context)
+              .get()));
+}
+
+TEST(HealthCheckerFactoryTest, CreateMongoInvalidStaleness) {
+  const std::string yaml = R"EOF(
+    timeout: 1s
+    interval: 1s
+    no_traffic_interval: 5s
+    interval_jitter: 1s
+    unhealthy_threshold: 1
+    healthy_threshold: 1
+    custom_health_check:
+      name: mongo
+      typed_config:
+        "@type": type.googleapis.com/envoy.extensions.health_checkers.mongo.v3.Mongo
+        max_staleness: 0s
+    )EOF";
+
+  NiceMock<Server::Configuration::MockHealthCheckerFactoryContext> context;
+
+  MongoHealthCheckerFactory factory;
+  EXPECT_THROW(
+      factory.createCustomHealthChecker(Upstream::parseHealthCheckFromV3Yaml(yaml), context),
+      EnvoyException);
+}
+
+TEST(HealthCheckerFactoryTest, CreateMongoViaUpstreamHealthCheckerFactory) {
+  const std::string yaml = R"EOF(
+    timeout: 1s
+    interval: 1s
+    no_traffic_interval: 5s
+    interval_jitter: 1s
+    unhealthy_threshold: 1
+    healthy_threshold: 1
+    custom_health_check:
+      name: mongo
+      typed_config:
+        "@type": type.googleapis.com/envoy.extensions.health_checkers.mongo.v3.Mongo
+    )EOF";
+
+  NiceMock<Upstream::MockClusterMockPrioritySet> cluster;
+  NiceMock<Server::Configuration::MockServerFactoryContext> server_context;
+
+  EXPECT_NE(nullptr, dynamic_cast<CustomMongoHealthChecker*>(
+                         Upstream::HealthCheckerFactory::create(
+                             Upstream::parseHealthCheckFromV3Yaml(yaml), cluster, server_context)
+                             .value()
+                             .get()));
+}
+
+} // namespace
+} // namespace MongoHealthChecker
+} // namespace HealthCheckers
+} // namespace Extensions
+} // namespace Envoy
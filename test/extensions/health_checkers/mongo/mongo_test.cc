@@ -0,0 +1,456 @@
+#include <chrono>
+#include <memory>
+
+#include "envoy/api/api.h"
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/config/well_known_names.h"
+#include "source/extensions/filters/network/mongo_proxy/bson_impl.h"
+#include "source/extensions/filters/network/mongo_proxy/codec_impl.h"
+#include "source/extensions/health_checkers/mongo/mongo.h"
+#include "source/extensions/health_checkers/mongo/utility.h"
+
+#include "test/common/upstream/utility.h"
+#include "test/mocks/common.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/upstream/cluster_priority_set.h"
+#include "test/mocks/upstream/health_check_event_logger.h"
+#include "test/mocks/upstream/host.h"
+#include "test/mocks/upstream/host_set.h"
+#include "test/mocks/upstream/priority_set.h"
+#include "test/test_common/simulated_time_system.h"
+
+using testing::_;
+using testing::InSequence;
+using testing::NiceMock;
+using testing::Return;
+using testing::SaveArg;
+
+namespace Envoy {
+namespace Extensions {
+namespace HealthCheckers {
+namespace MongoHealthChecker {
+
+namespace Bson = NetworkFilters::MongoProxy::Bson;
+
+class MongoHealthCheckerTest : public Event::TestUsingSimulatedTime, public testing::Test {
+public:
+  MongoHealthCheckerTest()
+      : cluster_(new NiceMock<Upstream::MockClusterMockPrioritySet>()),
+        event_logger_(new Upstream::MockHealthCheckEventLogger()), api_(Api::createApiForTest()) {}
+
+  void setup(const std::string& mongo_yaml, bool reuse_connection = true) {
+    const std::string yaml = fmt::format(R"EOF(
+    timeout: 1s
+    interval: 1s
+    no_traffic_interval: 5s
+    interval_jitter: 1s
+    unhealthy_threshold: 1
+    healthy_threshold: 1
+    reuse_connection: {}
+    custom_health_check:
+      name: mongo
+      typed_config:
+        "@type": type.googleapis.com/envoy.extensions.health_checkers.mongo.v3.Mongo
+        {}
+    )EOF",
+                                         reuse_connection, mongo_yaml);
+
+    const auto& health_check_config = Upstream::parseHealthCheckFromV3Yaml(yaml);
+    const auto& mongo_config = getMongoHealthCheckConfig(
+        health_check_config, ProtobufMessage::getStrictValidationVisitor());
+
+    cluster_->prioritySet().getMockHostSet(0)->hosts_ = {
+        Upstream::makeTestHost(cluster_->info_, "tcp://127.0.0.1:80", simTime())};
+
+    health_checker_ = std::make_shared<MongoHealthChecker>(
+        *cluster_, health_check_config, mongo_config, dispatcher_, runtime_,
+        Upstream::HealthCheckEventLoggerPtr(event_logger_), *api_);
+  }
+
+  void expectSessionCreate() {
+    interval_timer_ = new Event::MockTimer(&dispatcher_);
+    timeout_timer_ = new Event::MockTimer(&dispatcher_);
+  }
+
+  void expectClientCreate() {
+    connection_ = new NiceMock<Network::MockClientConnection>();
+    EXPECT_CALL(dispatcher_, createClientConnection_(_, _, _, _)).WillOnce(Return(connection_));
+    EXPECT_CALL(*connection_, addReadFilter(_)).WillOnce(SaveArg<0>(&read_filter_));
+  }
+
+  // Records the request ID of the next hello written to the connection.
+  void expectHello() {
+    EXPECT_CALL(*connection_, write(_, _)).WillOnce([this](Buffer::Instance& data, bool) {
+      Bson::BufferHelper::removeInt32(data);
+      hello_request_id_ = Bson::BufferHelper::removeInt32(data);
+      data.drain(data.length());
+    });
+  }
+
+  void startHealthChecker() {
+    expectSessionCreate();
+    expectClientCreate();
+    expectHello();
+    EXPECT_CALL(*timeout_timer_, enableTimer(_, _));
+    health_checker_->start();
+    connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  }
+
+  void respond(Bson::DocumentSharedPtr&& body) {
+    NetworkFilters::MongoProxy::MsgMessageImpl reply(1000, hello_request_id_);
+    reply.body(std::move(body));
+    Buffer::OwnedImpl data;
+    NetworkFilters::MongoProxy::EncoderImpl encoder(data);
+    encoder.encodeMsg(reply);
+    read_filter_->onData(data, false);
+  }
+
+  int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               simTime().systemTime().time_since_epoch())
+        .count();
+  }
+
+  const Upstream::HostSharedPtr& host() {
+    return cluster_->prioritySet().getMockHostSet(0)->hosts_[0];
+  }
+
+  uint64_t counter(const std::string& name) {
+    return cluster_->info_->stats_store_.counter(name).value();
+  }
+
+  std::shared_ptr<Upstream::MockClusterMockPrioritySet> cluster_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  NiceMock<Runtime::MockLoader> runtime_;
+  Upstream::MockHealthCheckEventLogger* event_logger_{};
+  Api::ApiPtr api_;
+  Event::MockTimer* timeout_timer_{};
+  Event::MockTimer* interval_timer_{};
+  NiceMock<Network::MockClientConnection>* connection_{};
+  Network::ReadFilterSharedPtr read_filter_;
+  int32_t hello_request_id_{};
+  std::shared_ptr<MongoHealthChecker> health_checker_;
+};
+
+TEST(MongoHelloReplyTest, Parse) {
+  {
+    HelloResult result = MongoHealthChecker::parseHelloReply(
+        *Bson::DocumentImpl::create()->addBoolean("isWritablePrimary", true)->addDouble("ok", 1));
+    EXPECT_TRUE(result.ok_);
+    EXPECT_EQ(Role::Primary, result.role_);
+    EXPECT_FALSE(result.last_write_date_ms_.has_value());
+  }
+  {
+    // Legacy reply from a pre 4.4.2 server.
+    HelloResult result = MongoHealthChecker::parseHelloReply(
+        *Bson::DocumentImpl::create()->addBoolean("ismaster", true)->addInt32("ok", 1));
+    EXPECT_TRUE(result.ok_);
+    EXPECT_EQ(Role::Primary, result.role_);
+  }
+  {
+    HelloResult result = MongoHealthChecker::parseHelloReply(
+        *Bson::DocumentImpl::create()
+             ->addBoolean("isWritablePrimary", false)
+             ->addBoolean("secondary", true)
+             ->addString("setName", "rs0")
+             ->addDocument("lastWrite",
+                           Bson::DocumentImpl::create()->addDatetime("lastWriteDate", 12345))
+             ->addDouble("ok", 1));
+    EXPECT_EQ(Role::Secondary, result.role_);
+    EXPECT_EQ("rs0", result.set_name_);
+    EXPECT_EQ(12345, result.last_write_date_ms_.value());
+  }
+  {
+    HelloResult result = MongoHealthChecker::parseHelloReply(
+        *Bson::DocumentImpl::create()->addBoolean("arbiterOnly", true)->addDouble("ok", 1));
+    EXPECT_EQ(Role::Arbiter, result.role_);
+  }
+  {
+    HelloResult result = MongoHealthChecker::parseHelloReply(
+        *Bson::DocumentImpl::create()->addDouble("ok", 0)->addString("errmsg", "nope"));
+    EXPECT_FALSE(result.ok_);
+    EXPECT_EQ(Role::Other, result.role_);
+  }
+}
+
+TEST_F(MongoHealthCheckerTest, PrimarySuccess) {
+  InSequence s;
+  setup("expected_role: PRIMARY");
+  startHealthChecker();
+  EXPECT_EQ(1, hello_request_id_);
+
+  EXPECT_CALL(*timeout_timer_, disableTimer());
+  EXPECT_CALL(*interval_timer_, enableTimer(_, _));
+  respond(Bson::DocumentImpl::create()->addBoolean("isWritablePrimary", true)->addDouble("ok", 1));
+
+  EXPECT_EQ(1UL, counter("health_check.success"));
+  EXPECT_EQ(0UL, counter("health_check.failure"));
+  EXPECT_EQ(Upstream::Host::Health::Healthy, host()->coarseHealth());
+
+  EXPECT_CALL(*connection_, close(Network::ConnectionCloseType::Abort));
+  health_checker_.reset();
+}
+
+TEST_F(MongoHealthCheckerTest, DoNotReuseConnection) {
+  InSequence s;
+  setup("", false);
+  startHealthChecker();
+
+  EXPECT_CALL(*timeout_timer_, disableTimer());
+  EXPECT_CALL(*interval_timer_, enableTimer(_, _));
+  EXPECT_CALL(*connection_, close(Network::ConnectionCloseType::Abort));
+  respond(Bson::DocumentImpl::create()
+              ->addBoolean("isWritablePrimary", false)
+              ->addBoolean("secondary", true)
+              ->addDouble("ok", 1));
+
+  EXPECT_EQ(1UL, counter("health_check.success"));
+}
+
+TEST_F(MongoHealthCheckerTest, RoleMismatch) {
+  InSequence s;
+  setup("expected_role: PRIMARY");
+  startHealthChecker();
+
+  EXPECT_CALL(*event_logger_, logEjectUnhealthy(_, _, _));
+  EXPECT_CALL(*event_logger_, logUnhealthy(_, _, _, true));
+  EXPECT_CALL(*timeout_timer_, disableTimer());
+  EXPECT_CALL(*interval_timer_, enableTimer(_, _));
+  respond(Bson::DocumentImpl::create()
+              ->addBoolean("isWritablePrimary", false)
+              ->addBoolean("secondary", true)
+              ->addDouble("ok", 1));
+
+  EXPECT_EQ(1UL, counter("health_check.mongo.role_mismatch"));
+  EXPECT_EQ(1UL, counter("health_check.failure"));
+  EXPECT_EQ(Upstream::Host::Health::Unhealthy, host()->coarseHealth());
+
+  EXPECT_CALL(*connection_, close(Network::ConnectionCloseType::Abort));
+  health_checker_.reset();
+}
+
+TEST_F(MongoHealthCheckerTest, CommandFailure) {
+  InSequence s;
+  setup("");
+  startHealthChecker();
+
+  EXPECT_CALL(*event_logger_, logEjectUnhealthy(_, _, _));
+  EXPECT_CALL(*event_logger_, logUnhealthy(_, _, _, true));
+  EXPECT_CALL(*timeout_timer_, disableTimer());
+  EXPECT_CALL(*interval_timer_, enableTimer(_, _));
+  respond(Bson::DocumentImpl::create()->addDouble("ok", 0));
+
+  EXPECT_EQ(1UL, counter("health_check.mongo.command_failure"));
+
+  EXPECT_CALL(*connection_, close(Network::ConnectionCloseType::Abort));
+  health_checker_.reset();
+}
+
+TEST_F(MongoHealthCheckerTest, StalenessExceeded) {
+  InSequence s;
+  setup(R"EOF(
+        expected_role: SECONDARY
+        max_staleness: 10s)EOF");
+  startHealthChecker();
+
+  EXPECT_CALL(*event_logger_, logEjectUnhealthy(_, _, _));
+  EXPECT_CALL(*event_logger_, logUnhealthy(_, _, _, true));
+  EXPECT_CALL(*timeout_timer_, disableTimer());
+  EXPECT_CALL(*interval_timer_, enableTimer(_, _));
+  respond(Bson::DocumentImpl::create()
+              ->addBoolean("secondary", true)
+              ->addDocument("lastWrite", Bson::DocumentImpl::create()->addDatetime(
+                                             "lastWriteDate", nowMs() - 60000))
+              ->addDouble("ok", 1));
+
+  EXPECT_EQ(1UL, counter("health_check.mongo.staleness_exceeded"));
+
+  // A secondary within the bound passes on the next interval.
+  expectHello();
+  EXPECT_CALL(*timeout_timer_, enableTimer(_, _));
+  interval_timer_->invokeCallback();
+  EXPECT_EQ(2, hello_request_id_);
+
+  EXPECT_CALL(*event_logger_, logAddHealthy(_, _, false));
+  EXPECT_CALL(*timeout_timer_, disableTimer());
+  EXPECT_CALL(*interval_timer_, enableTimer(_, _));
+  respond(Bson::DocumentImpl::create()
+              ->addBoolean("secondary", true)
+              ->addDocument("lastWrite", Bson::DocumentImpl::create()->addDatetime(
+                                             "lastWriteDate", nowMs() - 1000))
+              ->addDouble("ok", 1));
+
+  EXPECT_EQ(1UL, counter("health_check.mongo.staleness_exceeded"));
+  EXPECT_EQ(Upstream::Host::Health::Healthy, host()->coarseHealth());
+
+  EXPECT_CALL(*connection_, close(Network::ConnectionCloseType::Abort));
+  health_checker_.reset();
+}
+
+TEST_F(MongoHealthCheckerTest, PublishHostMetadata) {
+  InSequence s;
+  setup("publish_host_metadata: true");
+  startHealthChecker();
+
+  EXPECT_CALL(*timeout_timer_, disableTimer());
+  EXPECT_CALL(*interval_timer_, enableTimer(_, _));
+  respond(Bson::DocumentImpl::create()
+              ->addBoolean("secondary", true)
+              ->addString("setName", "rs0")
+              ->addDocument("lastWrite", Bson::DocumentImpl::create()->addDatetime(
+                                             "lastWriteDate", nowMs() - 250))
+              ->addDouble("ok", 1));
+
+  const auto& fields =
+      host()->metadata()->filter_metadata().at(Config::MetadataFilters::get().ENVOY_LB).fields();
+  EXPECT_EQ("secondary", fields.at("mongo_role").string_value());
+  EXPECT_EQ("rs0", fields.at("mongo_set_name").string_value());
+  EXPECT_EQ(250, fields.at("mongo_last_write_staleness_ms").number_value());
+
+  EXPECT_CALL(*connection_, close(Network::ConnectionCloseType::Abort));
+  health_checker_.reset();
+}
+
+// The host metadata is only rewritten when the role changes or the staleness drifts, and the host
+// is only reported as updated when the role or replica set name changes.
+TEST_F(MongoHealthCheckerTest, PublishHostMetadataOnlyOnChange) {
+  InSequence s;
+  setup("publish_host_metadata: true");
+  uint32_t host_updates = 0;
+  health_checker_->addHostCheckCompleteCb(
+      [&host_updates](Upstream::HostSharedPtr, Upstream::HealthTransition changed_state) {
+        if (changed_state == Upstream::HealthTransition::Changed) {
+          ++host_updates;
+        }
+      });
+  startHealthChecker();
+
+  const auto respond_secondary = [this](int64_t staleness_ms) {
+    EXPECT_CALL(*timeout_timer_, disableTimer());
+    EXPECT_CALL(*interval_timer_, enableTimer(_, _));
+    respond(Bson::DocumentImpl::create()
+                ->addBoolean("secondary", true)
+                ->addString("setName", "rs0")
+                ->addDocument("lastWrite", Bson::DocumentImpl::create()->addDatetime(
+                                               "lastWriteDate", nowMs() - staleness_ms))
+                ->addDouble("ok", 1));
+  };
+  const auto next_interval = [this]() {
+    expectHello();
+    EXPECT_CALL(*timeout_timer_, enableTimer(_, _));
+    interval_timer_->invokeCallback();
+  };
+  const auto staleness = [this]() {
+    return host()
+        ->metadata()
+        ->filter_metadata()
+        .at(Config::MetadataFilters::get().ENVOY_LB)
+        .fields()
+        .at("mongo_last_write_staleness_ms")
+        .number_value();
+  };
+
+  respond_secondary(250);
+  const Upstream::MetadataConstSharedPtr published = host()->metadata();
+  EXPECT_EQ(250, staleness());
+  EXPECT_LE(1, host_updates);
+  host_updates = 0;
+
+  // Less than a second of drift keeps the published metadata.
+  next_interval();
+  respond_secondary(750);
+  EXPECT_EQ(published, host()->metadata());
+
+  next_interval();
+  respond_secondary(1250);
+  EXPECT_NE(published, host()->metadata());
+  EXPECT_EQ(1250, staleness());
+  EXPECT_EQ(0, host_updates);
+
+  // A role change is published right away.
+  next_interval();
+  EXPECT_CALL(*timeout_timer_, disableTimer());
+  EXPECT_CALL(*interval_timer_, enableTimer(_, _));
+  respond(Bson::DocumentImpl::create()
+              ->addBoolean("isWritablePrimary", true)
+              ->addString("setName", "rs0")
+              ->addDouble("ok", 1));
+  const auto& fields =
+      host()->metadata()->filter_metadata().at(Config::MetadataFilters::get().ENVOY_LB).fields();
+  EXPECT_EQ("primary", fields.at("mongo_role").string_value());
+  EXPECT_EQ(0, fields.count("mongo_last_write_staleness_ms"));
+  EXPECT_EQ(1, host_updates);
+
+  EXPECT_CALL(*connection_, close(Network::ConnectionCloseType::Abort));
+  health_checker_.reset();
+}
+
+// A reply to a hello that already timed out is ignored.
+TEST_F(MongoHealthCheckerTest, StaleReplyIgnored) {
+  InSequence s;
+  setup("");
+  startHealthChecker();
+
+  hello_request_id_ = 42;
+  respond(Bson::DocumentImpl::create()->addBoolean("isWritablePrimary", true)->addDouble("ok", 1));
+  EXPECT_EQ(0UL, counter("health_check.success"));
+
+  EXPECT_CALL(*connection_, close(Network::ConnectionCloseType::Abort));
+  health_checker_.reset();
+}
+
+TEST_F(MongoHealthCheckerTest, DecodingError) {
+  InSequence s;
+  setup("");
+  startHealthChecker();
+
+  // An OP_MSG with an unknown section kind.
+  Buffer::OwnedImpl data;
+  Bson::BufferHelper::writeInt32(data, 21);
+  Bson::BufferHelper::writeInt32(data, 1000);
+  Bson::BufferHelper::writeInt32(data, hello_request_id_);
+  Bson::BufferHelper::writeInt32(data, 2013);
+  Bson::BufferHelper::writeInt32(data, 0);
+  data.writeByte<uint8_t>(5);
+
+  EXPECT_CALL(*connection_, close(Network::ConnectionCloseType::Abort));
+  EXPECT_CALL(*event_logger_, logEjectUnhealthy(_, _, _));
+  EXPECT_CALL(*event_logger_, logUnhealthy(_, _, _, true));
+  EXPECT_CALL(*timeout_timer_, disableTimer());
+  EXPECT_CALL(*interval_timer_, enableTimer(_, _));
+  read_filter_->onData(data, false);
+
+  EXPECT_EQ(1UL, counter("health_check.mongo.decoding_error"));
+  EXPECT_EQ(0UL, data.length());
+}
+
+TEST_F(MongoHealthCheckerTest, TimeoutThenRemoteClose) {
+  InSequence s;
+  setup("");
+  startHealthChecker();
+
+  EXPECT_CALL(*connection_, close(Network::ConnectionCloseType::Abort));
+  EXPECT_CALL(*event_logger_, logEjectUnhealthy(_, _, _));
+  EXPECT_CALL(*event_logger_, logUnhealthy(_, _, _, true));
+  EXPECT_CALL(*timeout_timer_, disableTimer());
+  EXPECT_CALL(*interval_timer_, enableTimer(_, _));
+  timeout_timer_->invokeCallback();
+  EXPECT_EQ(1UL, counter("health_check.network_failure"));
+
+  expectClientCreate();
+  EXPECT_CALL(*connection_, write(_, _));
+  EXPECT_CALL(*timeout_timer_, enableTimer(_, _));
+  interval_timer_->invokeCallback();
+
+  EXPECT_CALL(*timeout_timer_, disableTimer());
+  EXPECT_CALL(*interval_timer_, enableTimer(_, _));
+  connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_EQ(2UL, counter("health_check.network_failure"));
+}
+
+} // namespace MongoHealthChecker
+} // namespace HealthCheckers
+} // namespace Extensions
+} // namespace Envoy
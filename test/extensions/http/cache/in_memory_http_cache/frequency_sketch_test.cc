@@ -0,0 +1,63 @@
+#include "source/extensions/http/cache/in_memory_http_cache/frequency_sketch.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace InMemoryHttpCache {
+namespace {
+
+constexpr uint64_t Hash = 0x1234567890abcdef;
+
+TEST(FrequencySketchTest, CountsAccesses) {
+  FrequencySketch sketch;
+  EXPECT_EQ(0, sketch.frequency(Hash));
+  sketch.ensureCapacity(1024);
+  for (int i = 0; i < 3; ++i) {
+    sketch.increment(Hash);
+  }
+  EXPECT_EQ(3, sketch.frequency(Hash));
+  EXPECT_EQ(0, sketch.frequency(Hash + 1));
+}
+
+TEST(FrequencySketchTest, CountersSaturate) {
+  FrequencySketch sketch;
+  sketch.ensureCapacity(1024);
+  for (int i = 0; i < 20; ++i) {
+    sketch.increment(Hash);
+  }
+  EXPECT_EQ(15, sketch.frequency(Hash));
+}
+
+TEST(FrequencySketchTest, GrowingClearsCounters) {
+  FrequencySketch sketch;
+  sketch.ensureCapacity(1024);
+  sketch.increment(Hash);
+  // A capacity the sketch already has keeps the counters.
+  sketch.ensureCapacity(100);
+  EXPECT_EQ(1, sketch.frequency(Hash));
+  sketch.ensureCapacity(4096);
+  EXPECT_EQ(0, sketch.frequency(Hash));
+}
+
+TEST(FrequencySketchTest, HalvesCountersAfterSample) {
+  FrequencySketch sketch;
+  sketch.ensureCapacity(1024);
+  for (int i = 0; i < 15; ++i) {
+    sketch.increment(Hash);
+  }
+  // The sample size is ten times the capacity.
+  for (uint64_t i = 0; i < 10 * 1024; ++i) {
+    sketch.increment(i);
+  }
+  EXPECT_EQ(7, sketch.frequency(Hash));
+}
+
+} // namespace
+} // namespace InMemoryHttpCache
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
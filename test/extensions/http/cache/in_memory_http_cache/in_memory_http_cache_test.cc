@@ -0,0 +1,213 @@
+#include "envoy/registry/registry.h"
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/http/header_map_impl.h"
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/http/cache/in_memory_http_cache/in_memory_http_cache.h"
+
+#include "test/extensions/filters/http/cache/http_cache_implementation_test_common.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/server/factory_context.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace InMemoryHttpCache {
+namespace {
+
+class InMemoryHttpCacheTestDelegate : public HttpCacheTestDelegate {
+public:
+  std::shared_ptr<HttpCache> cache() override { return cache_; }
+  bool validationEnabled() const override { return true; }
+
+private:
+  Stats::IsolatedStoreImpl store_;
+  std::shared_ptr<InMemoryHttpCache> cache_ =
+      std::make_shared<InMemoryHttpCache>(ConfigProto(), *store_.rootScope());
+};
+
+INSTANTIATE_TEST_SUITE_P(InMemoryHttpCacheTest, HttpCacheImplementationTest,
+                         testing::Values(std::make_unique<InMemoryHttpCacheTestDelegate>),
+                         [](const testing::TestParamInfo<HttpCacheImplementationTest::ParamType>&) {
+                           return "InMemoryHttpCache";
+                         });
+
+// Each response takes about 10KB, so the main space of a shard holds 9 of them and its window
+// none.
+constexpr uint64_t ShardCapacity = 100000;
+constexpr uint64_t BodySize = 10000;
+
+class CacheShardTest : public testing::Test {
+protected:
+  static Key makeKey(absl::string_view path) {
+    Key key;
+    key.set_host("example.com");
+    key.set_path(std::string(path));
+    return key;
+  }
+
+  static CachedResponse makeResponse(uint64_t body_size) {
+    return {
+        Http::createHeaderMap<Http::ResponseHeaderMapImpl>({{Http::Headers::get().Status, "200"}}),
+        {},
+        std::make_shared<Buffer::OwnedImpl>(std::string(body_size, 'a')),
+        nullptr};
+  }
+
+  bool lookup(absl::string_view path) {
+    const Key key = makeKey(path);
+    return shard_.lookup(key, stableHashKey(key)).has_value();
+  }
+
+  // Inserts a response after a lookup missed it, as the cache filter does.
+  bool insert(absl::string_view path, uint64_t body_size = BodySize) {
+    EXPECT_FALSE(lookup(path));
+    const Key key = makeKey(path);
+    return shard_.insert(key, stableHashKey(key), makeResponse(body_size), true);
+  }
+
+  Stats::IsolatedStoreImpl store_;
+  InMemoryHttpCacheStats stats_{
+      ALL_IN_MEMORY_HTTP_CACHE_STATS(POOL_COUNTER_PREFIX(*store_.rootScope(), "cache."),
+                                     POOL_GAUGE_PREFIX(*store_.rootScope(), "cache."))};
+  CacheShard shard_{ShardCapacity, stats_};
+};
+
+TEST_F(CacheShardTest, StaysWithinByteBudget) {
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_TRUE(insert(absl::StrCat("/", i)));
+    EXPECT_LE(stats_.size_bytes_.value(), ShardCapacity);
+  }
+  EXPECT_EQ(9, stats_.size_count_.value());
+  EXPECT_EQ(50, stats_.insertions_.value());
+  EXPECT_EQ(41, stats_.evictions_.value() + stats_.admission_rejections_.value());
+}
+
+TEST_F(CacheShardTest, FrequentResponsesSurviveScan) {
+  for (int i = 0; i < 5; ++i) {
+    const std::string path = absl::StrCat("/hot/", i);
+    EXPECT_TRUE(insert(path));
+    EXPECT_TRUE(lookup(path));
+    EXPECT_TRUE(lookup(path));
+  }
+  // Responses requested once do not replace the responses requested more often.
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(insert(absl::StrCat("/scan/", i)));
+  }
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(lookup(absl::StrCat("/hot/", i)));
+  }
+  EXPECT_GT(stats_.admission_rejections_.value(), 0);
+}
+
+TEST_F(CacheShardTest, AdmitsResponseRequestedMoreOftenThanVictim) {
+  for (int i = 0; i < 9; ++i) {
+    EXPECT_TRUE(insert(absl::StrCat("/", i)));
+  }
+  EXPECT_EQ(0, stats_.evictions_.value());
+
+  EXPECT_FALSE(lookup("/popular"));
+  EXPECT_FALSE(lookup("/popular"));
+  EXPECT_TRUE(insert("/popular"));
+  EXPECT_TRUE(lookup("/popular"));
+  EXPECT_EQ(1, stats_.evictions_.value());
+  EXPECT_EQ(0, stats_.admission_rejections_.value());
+  EXPECT_EQ(9, stats_.size_count_.value());
+}
+
+TEST_F(CacheShardTest, ReplacesResponse) {
+  EXPECT_TRUE(insert("/a", 100));
+  const uint64_t size = stats_.size_bytes_.value();
+  const Key key = makeKey("/a");
+  EXPECT_TRUE(shard_.insert(key, stableHashKey(key), makeResponse(200), true));
+  EXPECT_EQ(1, stats_.size_count_.value());
+  EXPECT_EQ(size + 100, stats_.size_bytes_.value());
+
+  // A response is not replaced unless asked to.
+  EXPECT_TRUE(shard_.insert(key, stableHashKey(key), makeResponse(300), false));
+  EXPECT_EQ(size + 100, stats_.size_bytes_.value());
+}
+
+TEST_F(CacheShardTest, RejectsResponseLargerThanShard) {
+  EXPECT_FALSE(insert("/a", ShardCapacity));
+  EXPECT_EQ(0, stats_.size_count_.value());
+  EXPECT_EQ(0, stats_.size_bytes_.value());
+}
+
+TEST(InMemoryHttpCacheTest, ServesBodyWithoutCopies) {
+  Stats::IsolatedStoreImpl store;
+  InMemoryHttpCache cache(ConfigProto(), *store.rootScope());
+  testing::NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks;
+  envoy::extensions::filters::http::cache::v3::CacheConfig config;
+  VaryAllowList vary_allow_list(config.allowed_vary_headers());
+  Http::TestRequestHeaderMapImpl request_headers{
+      {":method", "GET"}, {":scheme", "https"}, {":authority", "example.com"}, {":path", "/a"}};
+
+  LookupRequest request(request_headers, SystemTime(), vary_allow_list);
+  auto body = std::make_shared<Buffer::OwnedImpl>("hello world");
+  const uint8_t* body_data = static_cast<const uint8_t*>(body->frontSlice().mem_);
+  ASSERT_TRUE(cache.insert(
+      request.key(),
+      {Http::createHeaderMap<Http::ResponseHeaderMapImpl>({{Http::Headers::get().Status, "200"}}),
+       {},
+       std::move(body),
+       nullptr}));
+
+  LookupContextPtr context = cache.makeLookupContext(
+      LookupRequest(request_headers, SystemTime(), vary_allow_list), decoder_callbacks);
+  context->getHeaders([](LookupResult&& result) { EXPECT_EQ(11, result.content_length_); });
+  bool called = false;
+  context->getBody(AdjustedByteRange(6, 11), [&](Buffer::InstancePtr&& data) {
+    called = true;
+    EXPECT_EQ("world", data->toString());
+    EXPECT_EQ(body_data + 6, data->frontSlice().mem_);
+  });
+  EXPECT_TRUE(called);
+  context->onDestroy();
+  EXPECT_EQ(1, cache.stats().hits_.value());
+  EXPECT_EQ(0, cache.stats().misses_.value());
+}
+
+TEST(InMemoryHttpCacheTest, RejectsResponseLargerThanMaxEntrySize) {
+  Stats::IsolatedStoreImpl store;
+  ConfigProto config;
+  config.mutable_max_individual_cache_entry_size_bytes()->set_value(1024);
+  InMemoryHttpCache cache(config, *store.rootScope());
+  Key key;
+  key.set_path("/a");
+  EXPECT_FALSE(cache.insert(
+      key, {Http::createHeaderMap<Http::ResponseHeaderMapImpl>({}),
+            {},
+            std::make_shared<Buffer::OwnedImpl>(std::string(1024, 'a')),
+            nullptr}));
+  EXPECT_EQ(0, cache.stats().insertions_.value());
+}
+
+TEST(Registration, GetFactory) {
+  HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
+      "envoy.extensions.http.cache.in_memory_http_cache.v3.InMemoryHttpCacheConfig");
+  ASSERT_NE(factory, nullptr);
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  envoy::extensions::filters::http::cache::v3::CacheConfig config;
+  ConfigProto cache_config;
+  config.mutable_typed_config()->PackFrom(cache_config);
+  std::shared_ptr<HttpCache> cache = factory->getCache(config, factory_context);
+  EXPECT_EQ(cache->cacheInfo().name_, "envoy.extensions.http.cache.in_memory_http_cache");
+
+  // Equal configs share a cache.
+  EXPECT_EQ(cache, factory->getCache(config, factory_context));
+  cache_config.set_stat_prefix("other");
+  config.mutable_typed_config()->PackFrom(cache_config);
+  EXPECT_NE(cache, factory->getCache(config, factory_context));
+}
+
+} // namespace
+} // namespace InMemoryHttpCache
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
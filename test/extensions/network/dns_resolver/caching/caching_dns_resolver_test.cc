@@ -0,0 +1,424 @@
+#include <chrono>
+#include <list>
+#include <string>
+
+#include "envoy/extensions/network/dns_resolver/caching/v3/caching_dns_resolver.pb.h"
+#include "envoy/extensions/network/dns_resolver/cares/v3/cares_dns_resolver.pb.h"
+
+#include "source/common/network/dns_resolver/dns_factory_util.h"
+#include "source/common/network/utility.h"
+#include "source/common/stats/isolated_store_impl.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/registry.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class CachingDnsResolverTest : public testing::Test {
+public:
+  CachingDnsResolverTest()
+      : api_(Api::createApiForTest(store_, time_system_)),
+        dispatcher_(api_->allocateDispatcher("test_thread")),
+        registered_dns_factory_(dns_resolver_factory_) {
+    ON_CALL(dns_resolver_factory_, createDnsResolver(_, _, _)).WillByDefault(Return(inner_));
+    config_.set_stat_prefix("test");
+    config_.mutable_max_ttl()->set_seconds(60);
+    auto* typed_dns_resolver_config = config_.mutable_typed_dns_resolver_config();
+    typed_dns_resolver_config->set_name(std::string(CaresDnsResolver));
+    envoy::extensions::network::dns_resolver::cares::v3::CaresDnsResolverConfig cares;
+    typed_dns_resolver_config->mutable_typed_config()->PackFrom(cares);
+  }
+
+  DnsResolverSharedPtr createResolver() {
+    envoy::config::core::v3::TypedExtensionConfig typed_dns_resolver_config;
+    typed_dns_resolver_config.set_name("envoy.network.dns_resolver.caching");
+    typed_dns_resolver_config.mutable_typed_config()->PackFrom(config_);
+    return createDnsResolverFactoryFromTypedConfig(typed_dns_resolver_config)
+        .createDnsResolver(*dispatcher_, *api_, typed_dns_resolver_config);
+  }
+
+  // Expects a query of the wrapped resolver and saves its callback.
+  void expectInnerResolve(const std::string& dns_name) {
+    EXPECT_CALL(*inner_, resolve(dns_name, DnsLookupFamily::V4Only, _))
+        .WillOnce(Invoke([this](const std::string&, DnsLookupFamily,
+                                DnsResolver::ResolveCb callback) -> ActiveDnsQuery* {
+          inner_callback_ = callback;
+          return &inner_->active_query_;
+        }));
+  }
+
+  static std::list<DnsResponse> makeResponse(const std::string& address,
+                                             std::chrono::seconds ttl) {
+    std::list<DnsResponse> response;
+    response.emplace_back(Utility::parseInternetAddress(address), ttl);
+    return response;
+  }
+
+  // Resolves a name that must be answered from the cache.
+  void resolveCached(const std::string& dns_name, DnsResolver::ResolutionStatus expected_status,
+                     const std::string& expected_address, std::chrono::seconds expected_ttl) {
+    bool called = false;
+    EXPECT_EQ(nullptr,
+              resolver_->resolve(dns_name, DnsLookupFamily::V4Only,
+                                 [&](DnsResolver::ResolutionStatus status,
+                                     std::list<DnsResponse>&& response) {
+                                   called = true;
+                                   EXPECT_EQ(expected_status, status);
+                                   if (expected_address.empty()) {
+                                     EXPECT_TRUE(response.empty());
+                                     return;
+                                   }
+                                   ASSERT_EQ(1, response.size());
+                                   EXPECT_EQ(expected_address,
+                                             response.front().addrInfo().address_->asString());
+                                   EXPECT_EQ(expected_ttl, response.front().addrInfo().ttl_);
+                                 }));
+    EXPECT_TRUE(called);
+  }
+
+  uint64_t counter(const std::string& name) {
+    return TestUtility::findCounter(store_, "dns.cache.test." + name)->value();
+  }
+
+  uint64_t gauge(const std::string& name) {
+    return TestUtility::findGauge(store_, "dns.cache.test." + name)->value();
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Stats::IsolatedStoreImpl store_;
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  std::shared_ptr<NiceMock<MockDnsResolver>> inner_{std::make_shared<NiceMock<MockDnsResolver>>()};
+  NiceMock<MockDnsResolverFactory> dns_resolver_factory_;
+  Registry::InjectFactory<DnsResolverFactory> registered_dns_factory_;
+  envoy::extensions::network::dns_resolver::caching::v3::CachingDnsResolverConfig config_;
+  DnsResolver::ResolveCb inner_callback_;
+  DnsResolverSharedPtr resolver_;
+};
+
+// A resolved name is answered from the cache with the remaining TTL until it expires.
+TEST_F(CachingDnsResolverTest, PositiveCaching) {
+  resolver_ = createResolver();
+
+  expectInnerResolve("foo.com");
+  bool called = false;
+  EXPECT_NE(nullptr, resolver_->resolve("foo.com", DnsLookupFamily::V4Only,
+                                        [&](DnsResolver::ResolutionStatus status,
+                                            std::list<DnsResponse>&& response) {
+                                          called = true;
+                                          EXPECT_EQ(DnsResolver::ResolutionStatus::Success,
+                                                    status);
+                                          EXPECT_EQ(1, response.size());
+                                        }));
+  EXPECT_EQ(1, gauge("pending_resolutions"));
+  inner_callback_(DnsResolver::ResolutionStatus::Success,
+                  makeResponse("10.0.0.1", std::chrono::seconds(30)));
+  EXPECT_TRUE(called);
+  EXPECT_EQ(0, gauge("pending_resolutions"));
+  EXPECT_EQ(1, gauge("entries"));
+
+  resolveCached("foo.com", DnsResolver::ResolutionStatus::Success, "10.0.0.1:0",
+                std::chrono::seconds(30));
+  time_system_.advanceTimeWait(std::chrono::seconds(10));
+  resolveCached("foo.com", DnsResolver::ResolutionStatus::Success, "10.0.0.1:0",
+                std::chrono::seconds(20));
+
+  EXPECT_EQ(1, counter("misses"));
+  EXPECT_EQ(2, counter("hits"));
+  EXPECT_EQ(1, counter("names.foo_com.misses"));
+  EXPECT_EQ(2, counter("names.foo_com.hits"));
+
+  // Once expired, the name is resolved again.
+  time_system_.advanceTimeWait(std::chrono::seconds(20));
+  expectInnerResolve("foo.com");
+  EXPECT_NE(nullptr,
+            resolver_->resolve("foo.com", DnsLookupFamily::V4Only,
+                               [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {}));
+  EXPECT_EQ(2, counter("misses"));
+  EXPECT_EQ(0, gauge("entries"));
+}
+
+// TTLs are clamped to the configured bounds.
+TEST_F(CachingDnsResolverTest, TtlBounds) {
+  config_.mutable_min_ttl()->set_seconds(5);
+  resolver_ = createResolver();
+
+  expectInnerResolve("short.com");
+  resolver_->resolve("short.com", DnsLookupFamily::V4Only,
+                     [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {});
+  inner_callback_(DnsResolver::ResolutionStatus::Success,
+                  makeResponse("10.0.0.1", std::chrono::seconds(1)));
+  resolveCached("short.com", DnsResolver::ResolutionStatus::Success, "10.0.0.1:0",
+                std::chrono::seconds(5));
+
+  expectInnerResolve("long.com");
+  resolver_->resolve("long.com", DnsLookupFamily::V4Only,
+                     [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {});
+  inner_callback_(DnsResolver::ResolutionStatus::Success,
+                  makeResponse("10.0.0.2", std::chrono::seconds(3600)));
+  resolveCached("long.com", DnsResolver::ResolutionStatus::Success, "10.0.0.2:0",
+                std::chrono::seconds(60));
+}
+
+// Failures and empty answers are cached for the negative TTL.
+TEST_F(CachingDnsResolverTest, NegativeCaching) {
+  config_.mutable_negative_ttl()->set_seconds(2);
+  resolver_ = createResolver();
+
+  expectInnerResolve("missing.com");
+  resolver_->resolve("missing.com", DnsLookupFamily::V4Only,
+                     [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {});
+  inner_callback_(DnsResolver::ResolutionStatus::Failure, {});
+
+  resolveCached("missing.com", DnsResolver::ResolutionStatus::Failure, "",
+                std::chrono::seconds(0));
+  EXPECT_EQ(1, counter("negative_hits"));
+
+  time_system_.advanceTimeWait(std::chrono::seconds(2));
+  expectInnerResolve("missing.com");
+  resolver_->resolve("missing.com", DnsLookupFamily::V4Only,
+                     [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {});
+  inner_callback_(DnsResolver::ResolutionStatus::Success, {});
+  resolveCached("missing.com", DnsResolver::ResolutionStatus::Success, "",
+                std::chrono::seconds(0));
+}
+
+// Negative caching can be disabled.
+TEST_F(CachingDnsResolverTest, NegativeCachingDisabled) {
+  config_.mutable_negative_ttl()->set_seconds(0);
+  resolver_ = createResolver();
+
+  expectInnerResolve("missing.com");
+  resolver_->resolve("missing.com", DnsLookupFamily::V4Only,
+                     [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {});
+  inner_callback_(DnsResolver::ResolutionStatus::Failure, {});
+  EXPECT_EQ(0, gauge("entries"));
+
+  expectInnerResolve("missing.com");
+  resolver_->resolve("missing.com", DnsLookupFamily::V4Only,
+                     [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {});
+}
+
+// Concurrent queries for the same name share a single query of the wrapped resolver.
+TEST_F(CachingDnsResolverTest, Coalescing) {
+  resolver_ = createResolver();
+
+  expectInnerResolve("foo.com");
+  int calls = 0;
+  auto callback = [&](DnsResolver::ResolutionStatus status, std::list<DnsResponse>&& response) {
+    calls++;
+    EXPECT_EQ(DnsResolver::ResolutionStatus::Success, status);
+    EXPECT_EQ(1, response.size());
+  };
+  ActiveDnsQuery* first = resolver_->resolve("foo.com", DnsLookupFamily::V4Only, callback);
+  ActiveDnsQuery* second = resolver_->resolve("foo.com", DnsLookupFamily::V4Only, callback);
+  ActiveDnsQuery* third = resolver_->resolve("foo.com", DnsLookupFamily::V4Only, callback);
+  EXPECT_NE(nullptr, first);
+  EXPECT_NE(nullptr, second);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(2, counter("coalesced"));
+
+  // Cancelling one query does not cancel the shared resolution.
+  EXPECT_CALL(inner_->active_query_, cancel(_)).Times(0);
+  third->cancel(ActiveDnsQuery::CancelReason::QueryAbandoned);
+  testing::Mock::VerifyAndClearExpectations(&inner_->active_query_);
+
+  // A different family is a different query.
+  EXPECT_CALL(*inner_, resolve("foo.com", DnsLookupFamily::V6Only, _))
+      .WillOnce(Return(&inner_->active_query_));
+  resolver_->resolve("foo.com", DnsLookupFamily::V6Only,
+                     [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {});
+
+  inner_callback_(DnsResolver::ResolutionStatus::Success,
+                  makeResponse("10.0.0.1", std::chrono::seconds(30)));
+  EXPECT_EQ(2, calls);
+}
+
+// The wrapped resolver may answer before its resolve() call returns.
+TEST_F(CachingDnsResolverTest, InlineAnswer) {
+  resolver_ = createResolver();
+
+  EXPECT_CALL(*inner_, resolve("foo.com", DnsLookupFamily::V4Only, _))
+      .WillOnce(Invoke([](const std::string&, DnsLookupFamily,
+                          DnsResolver::ResolveCb callback) -> ActiveDnsQuery* {
+        callback(DnsResolver::ResolutionStatus::Success,
+                 makeResponse("10.0.0.1", std::chrono::seconds(30)));
+        return nullptr;
+      }));
+  bool called = false;
+  EXPECT_EQ(nullptr,
+            resolver_->resolve("foo.com", DnsLookupFamily::V4Only,
+                               [&](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {
+                                 called = true;
+                               }));
+  EXPECT_TRUE(called);
+  EXPECT_EQ(0, gauge("pending_resolutions"));
+  resolveCached("foo.com", DnsResolver::ResolutionStatus::Success, "10.0.0.1:0",
+                std::chrono::seconds(30));
+}
+
+// A popular name is refreshed in the background during the last 10% of its TTL.
+TEST_F(CachingDnsResolverTest, Prefetch) {
+  resolver_ = createResolver();
+
+  expectInnerResolve("foo.com");
+  resolver_->resolve("foo.com", DnsLookupFamily::V4Only,
+                     [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {});
+  inner_callback_(DnsResolver::ResolutionStatus::Success,
+                  makeResponse("10.0.0.1", std::chrono::seconds(50)));
+
+  // Not in the prefetch window yet.
+  EXPECT_CALL(*inner_, resolve(_, _, _)).Times(0);
+  resolveCached("foo.com", DnsResolver::ResolutionStatus::Success, "10.0.0.1:0",
+                std::chrono::seconds(50));
+  testing::Mock::VerifyAndClearExpectations(inner_.get());
+
+  // In the prefetch window the cached answer is returned while the name is refreshed.
+  time_system_.advanceTimeWait(std::chrono::seconds(46));
+  expectInnerResolve("foo.com");
+  resolveCached("foo.com", DnsResolver::ResolutionStatus::Success, "10.0.0.1:0",
+                std::chrono::seconds(4));
+  EXPECT_EQ(1, counter("prefetches"));
+  EXPECT_EQ(1, counter("names.foo_com.prefetches"));
+
+  // Only one prefetch is started at a time.
+  resolveCached("foo.com", DnsResolver::ResolutionStatus::Success, "10.0.0.1:0",
+                std::chrono::seconds(4));
+  EXPECT_EQ(1, counter("prefetches"));
+
+  inner_callback_(DnsResolver::ResolutionStatus::Success,
+                  makeResponse("10.0.0.2", std::chrono::seconds(50)));
+  time_system_.advanceTimeWait(std::chrono::seconds(10));
+  resolveCached("foo.com", DnsResolver::ResolutionStatus::Success, "10.0.0.2:0",
+                std::chrono::seconds(40));
+  EXPECT_EQ(1, counter("misses"));
+}
+
+// Names that were not looked up often enough are not prefetched.
+TEST_F(CachingDnsResolverTest, PrefetchDisabled) {
+  config_.mutable_prefetch_min_hits()->set_value(0);
+  resolver_ = createResolver();
+
+  expectInnerResolve("foo.com");
+  resolver_->resolve("foo.com", DnsLookupFamily::V4Only,
+                     [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {});
+  inner_callback_(DnsResolver::ResolutionStatus::Success,
+                  makeResponse("10.0.0.1", std::chrono::seconds(50)));
+
+  time_system_.advanceTimeWait(std::chrono::seconds(46));
+  EXPECT_CALL(*inner_, resolve(_, _, _)).Times(0);
+  for (int i = 0; i < 3; i++) {
+    resolveCached("foo.com", DnsResolver::ResolutionStatus::Success, "10.0.0.1:0",
+                  std::chrono::seconds(4));
+  }
+  EXPECT_EQ(0, counter("prefetches"));
+}
+
+// The least recently used name is evicted when the cache is full.
+TEST_F(CachingDnsResolverTest, Eviction) {
+  config_.mutable_max_entries()->set_value(2);
+  resolver_ = createResolver();
+
+  for (const char* name : {"a.com", "b.com"}) {
+    expectInnerResolve(name);
+    resolver_->resolve(name, DnsLookupFamily::V4Only,
+                       [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {});
+    inner_callback_(DnsResolver::ResolutionStatus::Success,
+                    makeResponse("10.0.0.1", std::chrono::seconds(30)));
+  }
+  // Touch a.com so that b.com is the least recently used name.
+  resolveCached("a.com", DnsResolver::ResolutionStatus::Success, "10.0.0.1:0",
+                std::chrono::seconds(30));
+
+  expectInnerResolve("c.com");
+  resolver_->resolve("c.com", DnsLookupFamily::V4Only,
+                     [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {});
+  inner_callback_(DnsResolver::ResolutionStatus::Success,
+                  makeResponse("10.0.0.3", std::chrono::seconds(30)));
+  EXPECT_EQ(1, counter("evictions"));
+  EXPECT_EQ(2, gauge("entries"));
+
+  resolveCached("a.com", DnsResolver::ResolutionStatus::Success, "10.0.0.1:0",
+                std::chrono::seconds(30));
+  resolveCached("c.com", DnsResolver::ResolutionStatus::Success, "10.0.0.3:0",
+                std::chrono::seconds(30));
+  expectInnerResolve("b.com");
+  resolver_->resolve("b.com", DnsLookupFamily::V4Only,
+                     [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {});
+}
+
+// Resolvers created with the same configuration on the same dispatcher share the cache.
+TEST_F(CachingDnsResolverTest, SharedCache) {
+  EXPECT_CALL(dns_resolver_factory_, createDnsResolver(_, _, _)).WillOnce(Return(inner_));
+  resolver_ = createResolver();
+  DnsResolverSharedPtr other = createResolver();
+
+  expectInnerResolve("foo.com");
+  bool other_called = false;
+  other->resolve("foo.com", DnsLookupFamily::V4Only,
+                 [&](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {
+                   other_called = true;
+                 });
+  bool called = false;
+  resolver_->resolve("foo.com", DnsLookupFamily::V4Only,
+                     [&](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {
+                       called = true;
+                     });
+
+  // The queries of a destroyed resolver are not answered.
+  other.reset();
+  inner_callback_(DnsResolver::ResolutionStatus::Success,
+                  makeResponse("10.0.0.1", std::chrono::seconds(30)));
+  EXPECT_TRUE(called);
+  EXPECT_FALSE(other_called);
+  resolveCached("foo.com", DnsResolver::ResolutionStatus::Success, "10.0.0.1:0",
+                std::chrono::seconds(30));
+
+  // Destroying the last resolver cancels the outstanding resolutions.
+  expectInnerResolve("bar.com");
+  resolver_->resolve("bar.com", DnsLookupFamily::V4Only,
+                     [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {});
+  EXPECT_CALL(inner_->active_query_, cancel(ActiveDnsQuery::CancelReason::QueryAbandoned));
+  resolver_.reset();
+}
+
+// Resetting the networking forgets the cached answers.
+TEST_F(CachingDnsResolverTest, ResetNetworking) {
+  resolver_ = createResolver();
+
+  expectInnerResolve("foo.com");
+  resolver_->resolve("foo.com", DnsLookupFamily::V4Only,
+                     [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {});
+  inner_callback_(DnsResolver::ResolutionStatus::Success,
+                  makeResponse("10.0.0.1", std::chrono::seconds(30)));
+
+  EXPECT_CALL(*inner_, resetNetworking());
+  resolver_->resetNetworking();
+  EXPECT_EQ(0, gauge("entries"));
+  expectInnerResolve("foo.com");
+  resolver_->resolve("foo.com", DnsLookupFamily::V4Only,
+                     [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {});
+}
+
+TEST_F(CachingDnsResolverTest, InvalidTtlBounds) {
+  config_.mutable_min_ttl()->set_seconds(120);
+  EXPECT_THROW_WITH_MESSAGE(
+      createResolver(), EnvoyException,
+      "caching DNS resolver: min_ttl (120s) is larger than max_ttl (60s)");
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
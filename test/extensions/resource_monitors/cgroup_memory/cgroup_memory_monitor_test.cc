@@ -0,0 +1,135 @@
+#include "envoy/extensions/resource_monitors/cgroup_memory/v3/cgroup_memory.pb.h"
+
+#include "source/extensions/resource_monitors/cgroup_memory/cgroup_memory_monitor.h"
+
+#include "test/test_common/environment.h"
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/optional.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace CgroupMemoryMonitor {
+namespace {
+
+class ResourcePressure : public Server::ResourceUpdateCallbacks {
+public:
+  void onSuccess(const Server::ResourceUsage& usage) override {
+    pressure_ = usage.resource_pressure_;
+  }
+
+  void onFailure(const EnvoyException& error) override { error_ = error; }
+
+  bool hasPressure() const { return pressure_.has_value(); }
+  bool hasError() const { return error_.has_value(); }
+
+  double pressure() const { return *pressure_; }
+  std::string error() const { return error_->what(); }
+
+private:
+  absl::optional<double> pressure_;
+  absl::optional<EnvoyException> error_;
+};
+
+// The cgroup files are faked in a temporary directory.
+class CgroupMemoryMonitorTest : public testing::Test {
+protected:
+  CgroupMemoryMonitorTest() : cgroup_path_(TestEnvironment::temporaryPath("cgroup_memory")) {
+    TestEnvironment::createPath(cgroup_path_);
+    config_.set_cgroup_path(cgroup_path_);
+  }
+
+  ~CgroupMemoryMonitorTest() override { TestEnvironment::removePath(cgroup_path_); }
+
+  void writeCgroupFile(const std::string& name, const std::string& contents) {
+    TestEnvironment::writeStringToFileForTest(absl::StrCat(cgroup_path_, "/", name), contents,
+                                              true);
+  }
+
+  ResourcePressure updateResourceUsage() {
+    CgroupMemoryMonitor monitor(config_);
+    ResourcePressure resource;
+    monitor.updateResourceUsage(resource);
+    return resource;
+  }
+
+  const std::string cgroup_path_;
+  envoy::extensions::resource_monitors::cgroup_memory::v3::CgroupMemoryConfig config_;
+};
+
+TEST_F(CgroupMemoryMonitorTest, ComputesUsageAgainstCgroupLimit) {
+  writeCgroupFile("memory.current", "400\n");
+  writeCgroupFile("memory.max", "1000\n");
+  ResourcePressure resource = updateResourceUsage();
+  ASSERT_TRUE(resource.hasPressure());
+  EXPECT_FALSE(resource.hasError());
+  EXPECT_EQ(resource.pressure(), 0.4);
+}
+
+TEST_F(CgroupMemoryMonitorTest, UsesLowestLimit) {
+  writeCgroupFile("memory.current", "400\n");
+  writeCgroupFile("memory.max", "1000\n");
+  config_.set_max_memory_bytes(800);
+  EXPECT_EQ(updateResourceUsage().pressure(), 0.5);
+
+  config_.set_max_memory_bytes(2000);
+  EXPECT_EQ(updateResourceUsage().pressure(), 0.4);
+}
+
+TEST_F(CgroupMemoryMonitorTest, UsesConfiguredLimitWithoutCgroupLimit) {
+  writeCgroupFile("memory.current", "400\n");
+  writeCgroupFile("memory.max", "max\n");
+  ResourcePressure resource = updateResourceUsage();
+  ASSERT_TRUE(resource.hasError());
+  EXPECT_TRUE(absl::StrContains(resource.error(), "cgroup has no memory limit"));
+
+  config_.set_max_memory_bytes(800);
+  EXPECT_EQ(updateResourceUsage().pressure(), 0.5);
+}
+
+TEST_F(CgroupMemoryMonitorTest, ExcludesInactiveFilePages) {
+  writeCgroupFile("memory.current", "400\n");
+  writeCgroupFile("memory.max", "1000\n");
+  writeCgroupFile("memory.stat", "anon 100\nfile 300\nactive_file 100\ninactive_file 200\n");
+  config_.set_exclude_inactive_file(true);
+  EXPECT_EQ(updateResourceUsage().pressure(), 0.2);
+
+  writeCgroupFile("memory.stat", "inactive_file 500\n");
+  EXPECT_EQ(updateResourceUsage().pressure(), 0);
+
+  writeCgroupFile("memory.stat", "anon 100\n");
+  ResourcePressure resource = updateResourceUsage();
+  ASSERT_TRUE(resource.hasError());
+  EXPECT_TRUE(absl::StrContains(resource.error(), "memory.stat has no inactive_file"));
+}
+
+TEST_F(CgroupMemoryMonitorTest, ReportsParseError) {
+  writeCgroupFile("memory.current", "bad content\n");
+  writeCgroupFile("memory.max", "1000\n");
+  ResourcePressure resource = updateResourceUsage();
+  ASSERT_TRUE(resource.hasError());
+  EXPECT_TRUE(absl::StrContains(resource.error(), "failed to parse cgroup memory.current"));
+
+  writeCgroupFile("memory.current", "400\n");
+  writeCgroupFile("memory.max", "0\n");
+  resource = updateResourceUsage();
+  ASSERT_TRUE(resource.hasError());
+  EXPECT_TRUE(absl::StrContains(resource.error(), "cgroup memory.max is 0"));
+}
+
+TEST_F(CgroupMemoryMonitorTest, ReportsErrorOnFileRead) {
+  writeCgroupFile("memory.current", "400\n");
+  ResourcePressure resource = updateResourceUsage();
+  ASSERT_TRUE(resource.hasError());
+  EXPECT_TRUE(absl::StrContains(resource.error(), "unable to read cgroup file"));
+  EXPECT_TRUE(absl::StrContains(resource.error(), "memory.max"));
+}
+
+} // namespace
+} // namespace CgroupMemoryMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,53 @@
+#include "envoy/extensions/resource_monitors/event_loop_lag/v3/event_loop_lag.pb.h"
+#include "envoy/extensions/resource_monitors/event_loop_lag/v3/event_loop_lag.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "source/extensions/resource_monitors/event_loop_lag/config.h"
+#include "source/server/resource_monitor_config_impl.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/server/options.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopLagMonitor {
+namespace {
+
+class EventLoopLagMonitorFactoryTest : public testing::Test {
+protected:
+  Server::Configuration::WorkerResourceMonitorFactory* factory_ =
+      Registry::FactoryRegistry<Server::Configuration::WorkerResourceMonitorFactory>::getFactory(
+          "envoy.resource_monitors.event_loop_lag");
+  Event::MockDispatcher dispatcher_;
+  Api::ApiPtr api_ = Api::createApiForTest();
+  Server::MockOptions options_;
+  Server::Configuration::ResourceMonitorFactoryContextImpl context_{
+      dispatcher_, options_, *api_, ProtobufMessage::getStrictValidationVisitor()};
+};
+
+TEST_F(EventLoopLagMonitorFactoryTest, CreateMonitor) {
+  ASSERT_NE(factory_, nullptr);
+
+  envoy::extensions::resource_monitors::event_loop_lag::v3::EventLoopLagConfig config;
+  config.mutable_max_lag()->set_seconds(1);
+  auto monitor = factory_->createWorkerResourceMonitor(config, context_);
+  EXPECT_NE(monitor, nullptr);
+}
+
+TEST_F(EventLoopLagMonitorFactoryTest, RequiresMaxLag) {
+  ASSERT_NE(factory_, nullptr);
+
+  envoy::extensions::resource_monitors::event_loop_lag::v3::EventLoopLagConfig config;
+  EXPECT_THROW_WITH_REGEX(factory_->createWorkerResourceMonitor(config, context_),
+                          ProtoValidationException, "MaxLag: value is required");
+}
+
+} // namespace
+} // namespace EventLoopLagMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
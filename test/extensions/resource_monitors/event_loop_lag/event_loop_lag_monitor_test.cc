@@ -0,0 +1,60 @@
+#include <chrono>
+
+#include "envoy/extensions/resource_monitors/event_loop_lag/v3/event_loop_lag.pb.h"
+
+#include "source/extensions/resource_monitors/event_loop_lag/event_loop_lag_monitor.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopLagMonitor {
+namespace {
+
+envoy::extensions::resource_monitors::event_loop_lag::v3::EventLoopLagConfig
+makeConfig(int64_t max_lag_ms) {
+  envoy::extensions::resource_monitors::event_loop_lag::v3::EventLoopLagConfig config;
+  config.mutable_max_lag()->set_nanos(max_lag_ms * 1000000);
+  return config;
+}
+
+TEST(EventLoopLagMonitorTest, EnablesLagTrackingOfWorker) {
+  NiceMock<Event::MockDispatcher> dispatcher;
+  EventLoopLagMonitor monitor(makeConfig(100));
+  EXPECT_CALL(dispatcher, enableLoopLagTracking());
+  monitor.initializeWorker(dispatcher);
+}
+
+TEST(EventLoopLagMonitorTest, ComputesPressureOfEachWorker) {
+  NiceMock<Event::MockDispatcher> worker1;
+  NiceMock<Event::MockDispatcher> worker2;
+  EventLoopLagMonitor monitor(makeConfig(100));
+  EXPECT_CALL(worker1, loopLag()).WillRepeatedly(Return(std::chrono::milliseconds(25)));
+  EXPECT_CALL(worker2, loopLag()).WillRepeatedly(Return(std::chrono::milliseconds(150)));
+  EXPECT_DOUBLE_EQ(0.25, monitor.workerPressure(worker1));
+  // The pressure isn't capped, so that thresholds over 1 can be configured.
+  EXPECT_DOUBLE_EQ(1.5, monitor.workerPressure(worker2));
+}
+
+TEST(EventLoopLagMonitorTest, RoundsUpMaxLagUnderAMicrosecond) {
+  NiceMock<Event::MockDispatcher> dispatcher;
+  envoy::extensions::resource_monitors::event_loop_lag::v3::EventLoopLagConfig config;
+  config.mutable_max_lag()->set_nanos(1);
+  EventLoopLagMonitor monitor(config);
+  EXPECT_CALL(dispatcher, loopLag()).WillOnce(Return(std::chrono::microseconds(3)));
+  EXPECT_DOUBLE_EQ(3, monitor.workerPressure(dispatcher));
+}
+
+} // namespace
+} // namespace EventLoopLagMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,140 @@
+#include "envoy/extensions/resource_monitors/pressure_stall/v3/pressure_stall.pb.h"
+
+#include "source/extensions/resource_monitors/pressure_stall/pressure_stall_monitor.h"
+
+#include "test/test_common/environment.h"
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/optional.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace PressureStallMonitor {
+namespace {
+
+using PressureStallConfig =
+    envoy::extensions::resource_monitors::pressure_stall::v3::PressureStallConfig;
+
+class ResourcePressure : public Server::ResourceUpdateCallbacks {
+public:
+  void onSuccess(const Server::ResourceUsage& usage) override {
+    pressure_ = usage.resource_pressure_;
+  }
+
+  void onFailure(const EnvoyException& error) override { error_ = error; }
+
+  bool hasPressure() const { return pressure_.has_value(); }
+  bool hasError() const { return error_.has_value(); }
+
+  double pressure() const { return *pressure_; }
+  std::string error() const { return error_->what(); }
+
+private:
+  absl::optional<double> pressure_;
+  absl::optional<EnvoyException> error_;
+};
+
+constexpr absl::string_view MemoryPressure = "some avg10=12.50 avg60=6.00 avg300=1.00 total=123\n"
+                                             "full avg10=5.00 avg60=2.00 avg300=0.50 total=45\n";
+
+// The cgroup files are faked in a temporary directory.
+class PressureStallMonitorTest : public testing::Test {
+protected:
+  PressureStallMonitorTest() : cgroup_path_(TestEnvironment::temporaryPath("pressure_stall")) {
+    TestEnvironment::createPath(cgroup_path_);
+    config_.set_cgroup_path(cgroup_path_);
+  }
+
+  ~PressureStallMonitorTest() override { TestEnvironment::removePath(cgroup_path_); }
+
+  void writeCgroupFile(const std::string& name, absl::string_view contents) {
+    TestEnvironment::writeStringToFileForTest(absl::StrCat(cgroup_path_, "/", name),
+                                              std::string(contents), true);
+  }
+
+  ResourcePressure updateResourceUsage() {
+    PressureStallMonitor monitor(config_);
+    ResourcePressure resource;
+    monitor.updateResourceUsage(resource);
+    return resource;
+  }
+
+  const std::string cgroup_path_;
+  PressureStallConfig config_;
+};
+
+TEST_F(PressureStallMonitorTest, ReportsConfiguredStall) {
+  writeCgroupFile("memory.pressure", MemoryPressure);
+  ResourcePressure resource = updateResourceUsage();
+  ASSERT_TRUE(resource.hasPressure());
+  EXPECT_FALSE(resource.hasError());
+  EXPECT_DOUBLE_EQ(resource.pressure(), 0.125);
+
+  config_.set_window(PressureStallConfig::AVG60);
+  EXPECT_DOUBLE_EQ(updateResourceUsage().pressure(), 0.06);
+
+  config_.set_stall_type(PressureStallConfig::FULL);
+  config_.set_window(PressureStallConfig::AVG300);
+  EXPECT_DOUBLE_EQ(updateResourceUsage().pressure(), 0.005);
+}
+
+TEST_F(PressureStallMonitorTest, ReadsConfiguredResource) {
+  writeCgroupFile("memory.pressure", MemoryPressure);
+  writeCgroupFile("cpu.pressure", "some avg10=50.00 avg60=0.00 avg300=0.00 total=0\n");
+  writeCgroupFile("io.pressure", "some avg10=100.00 avg60=0.00 avg300=0.00 total=0\n");
+  config_.set_resource(PressureStallConfig::CPU);
+  EXPECT_DOUBLE_EQ(updateResourceUsage().pressure(), 0.5);
+
+  config_.set_resource(PressureStallConfig::IO);
+  EXPECT_DOUBLE_EQ(updateResourceUsage().pressure(), 1);
+}
+
+// Linux only reports the full CPU stall since 5.13.
+TEST_F(PressureStallMonitorTest, ReportsMissingStallType) {
+  writeCgroupFile("cpu.pressure", "some avg10=50.00 avg60=0.00 avg300=0.00 total=0\n");
+  config_.set_resource(PressureStallConfig::CPU);
+  config_.set_stall_type(PressureStallConfig::FULL);
+  ResourcePressure resource = updateResourceUsage();
+  ASSERT_TRUE(resource.hasError());
+  EXPECT_EQ(resource.error(), "cpu.pressure: no full stalls");
+}
+
+TEST_F(PressureStallMonitorTest, ReportsErrorOnFileRead) {
+  ResourcePressure resource = updateResourceUsage();
+  ASSERT_TRUE(resource.hasError());
+  EXPECT_TRUE(absl::StrContains(resource.error(), "unable to read cgroup file"));
+  EXPECT_TRUE(absl::StrContains(resource.error(), "memory.pressure"));
+}
+
+TEST(PressureStallMonitorParseTest, ParsesPressure) {
+  EXPECT_DOUBLE_EQ(PressureStallMonitor::parsePressure(MemoryPressure, "full", "avg10").value(),
+                   0.05);
+  // Rounding errors of the kernel are clamped.
+  EXPECT_DOUBLE_EQ(
+      PressureStallMonitor::parsePressure("some avg10=100.01 total=0", "some", "avg10").value(),
+      1);
+
+  EXPECT_EQ(PressureStallMonitor::parsePressure("", "some", "avg10").status().message(),
+            "no some stalls");
+  EXPECT_EQ(PressureStallMonitor::parsePressure("some avg60=1.00", "some", "avg10")
+                .status()
+                .message(),
+            "no avg10 for some stalls");
+  EXPECT_EQ(PressureStallMonitor::parsePressure("some avg10=abc", "some", "avg10")
+                .status()
+                .message(),
+            "failed to parse some avg10");
+  EXPECT_EQ(PressureStallMonitor::parsePressure("some avg10=-1.00", "some", "avg10")
+                .status()
+                .message(),
+            "failed to parse some avg10");
+}
+
+} // namespace
+} // namespace PressureStallMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
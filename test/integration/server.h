@@ -370,6 +370,7 @@ public:
   void initializeThreading(Event::Dispatcher&, ThreadLocal::Instance&) override {}
   void shutdownThreading() override {}
   void mergeHistograms(PostMergeCb cb) override { merge_cb_ = cb; }
+  void setLockFreeHistograms(bool) override {}
 
   void runMergeCallback() { merge_cb_(); }
 
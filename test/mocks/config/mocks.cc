@@ -61,5 +61,8 @@ MockContextProvider::MockContextProvider() {
 
 MockContextProvider::~MockContextProvider() = default;
 
+MockXdsResourcesDelegate::MockXdsResourcesDelegate() = default;
+MockXdsResourcesDelegate::~MockXdsResourcesDelegate() = default;
+
 } // namespace Config
 } // namespace Envoy
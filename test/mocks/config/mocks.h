@@ -6,6 +6,7 @@
 #include "envoy/config/grpc_mux.h"
 #include "envoy/config/subscription.h"
 #include "envoy/config/typed_config.h"
+#include "envoy/config/xds_resources_delegate.h"
 #include "envoy/service/discovery/v3/discovery.pb.h"
 
 #include "source/common/common/callback_impl.h"
@@ -72,6 +73,8 @@ public:
               (const absl::flat_hash_set<std::string>& update_to_these_names));
   MOCK_METHOD(void, requestOnDemandUpdate,
               (const absl::flat_hash_set<std::string>& add_these_names));
+  MOCK_METHOD(void, requestOnDemandRemoval,
+              (const absl::flat_hash_set<std::string>& remove_these_names));
 };
 
 class MockSubscriptionFactory : public SubscriptionFactory {
@@ -127,6 +130,9 @@ public:
   MOCK_METHOD(void, requestOnDemandUpdate,
               (const std::string& type_url,
                const absl::flat_hash_set<std::string>& add_these_names));
+  MOCK_METHOD(void, requestOnDemandRemoval,
+              (const std::string& type_url,
+               const absl::flat_hash_set<std::string>& remove_these_names));
 
   MOCK_METHOD(bool, paused, (const std::string& type_url), (const));
 
@@ -196,6 +202,23 @@ public:
   Common::CallbackManager<absl::string_view> update_cb_handler_;
 };
 
+class MockXdsResourcesDelegate : public XdsResourcesDelegate {
+public:
+  MockXdsResourcesDelegate();
+  ~MockXdsResourcesDelegate() override;
+
+  MOCK_METHOD(std::vector<envoy::service::discovery::v3::Resource>, getResources,
+              (const XdsSourceId& source_id,
+               const absl::flat_hash_set<std::string>& resource_names),
+              (const));
+  MOCK_METHOD(void, onConfigUpdated,
+              (const XdsSourceId& source_id, const std::vector<DecodedResourceRef>& resources));
+  MOCK_METHOD(void, onResourceLoadFailed,
+              (const XdsSourceId& source_id, const std::string& resource_name,
+               const absl::optional<EnvoyException>& exception));
+  MOCK_METHOD(bool, loadOnStartup, (), (const));
+};
+
 template <class FactoryCallback>
 class TestExtensionConfigProvider : public Config::ExtensionConfigProvider<FactoryCallback> {
 public:
@@ -118,6 +118,8 @@ public:
   MOCK_METHOD(void, registerWatchdog,
               (const Server::WatchDogSharedPtr&, std::chrono::milliseconds));
   MOCK_METHOD(void, initializeStats, (Stats::Scope&, const absl::optional<std::string>&));
+  MOCK_METHOD(void, enableLoopLagTracking, ());
+  MOCK_METHOD(std::chrono::microseconds, loopLag, (), (const));
   MOCK_METHOD(void, clearDeferredDeleteList, ());
   MOCK_METHOD(Network::ServerConnection*, createServerConnection_, ());
   MOCK_METHOD(Network::ClientConnection*, createClientConnection_,
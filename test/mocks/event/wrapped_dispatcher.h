@@ -31,6 +31,10 @@ public:
     impl_.initializeStats(scope, prefix);
   }
 
+  void enableLoopLagTracking() override { impl_.enableLoopLagTracking(); }
+
+  std::chrono::microseconds loopLag() const override { return impl_.loopLag(); }
+
   void clearDeferredDeleteList() override { impl_.clearDeferredDeleteList(); }
 
   Network::ServerConnectionPtr
@@ -51,6 +51,7 @@ public:
     overprovisioning_factor_ = overprovisioning_factor;
   }
   bool weightedPriorityHealth() const override { return weighted_priority_health_; }
+  const HostSetDelta* updateDelta() const override { return nullptr; }
 
   HostVector hosts_;
   HostVector healthy_hosts_;
@@ -14,6 +14,7 @@ public:
   ~MockMissingClusterNotifier() override;
 
   MOCK_METHOD(void, notifyMissingCluster, (absl::string_view name));
+  MOCK_METHOD(void, notifyOnDemandCluster, (absl::string_view name, OdCdsApiWeakPtr odcds));
 };
 
 } // namespace Upstream
@@ -22,6 +22,7 @@ public:
   ~MockOdCdsApi() override;
 
   MOCK_METHOD(void, updateOnDemand, (std::string cluster_name));
+  MOCK_METHOD(void, removeOnDemand, (std::string cluster_name));
 };
 
 } // namespace Upstream
@@ -22,6 +22,8 @@
 #include "test/test_common/test_runtime.h"
 #include "test/test_common/utility.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -171,6 +173,49 @@ public:
   const std::string name_;
 };
 
+class FakeWorkerResourceMonitor : public WorkerResourceMonitor {
+public:
+  void setPressure(Event::Dispatcher& dispatcher, double pressure) {
+    pressures_[&dispatcher] = pressure;
+  }
+
+  void initializeWorker(Event::Dispatcher& dispatcher) override {
+    initialized_.insert(&dispatcher);
+  }
+
+  double workerPressure(Event::Dispatcher& dispatcher) override {
+    EXPECT_TRUE(initialized_.contains(&dispatcher));
+    return pressures_[&dispatcher];
+  }
+
+private:
+  absl::flat_hash_set<Event::Dispatcher*> initialized_;
+  absl::flat_hash_map<Event::Dispatcher*, double> pressures_;
+};
+
+class FakeWorkerResourceMonitorFactory
+    : public Server::Configuration::WorkerResourceMonitorFactory {
+public:
+  FakeWorkerResourceMonitorFactory(const std::string& name) : name_(name) {}
+
+  Server::WorkerResourceMonitorPtr
+  createWorkerResourceMonitor(const Protobuf::Message&,
+                              Server::Configuration::ResourceMonitorFactoryContext&) override {
+    auto monitor = std::make_unique<FakeWorkerResourceMonitor>();
+    monitor_ = monitor.get();
+    return monitor;
+  }
+
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return ProtobufTypes::MessagePtr{new Envoy::ProtobufWkt::UInt32Value()};
+  }
+
+  std::string name() const override { return name_; }
+
+  FakeWorkerResourceMonitor* monitor_{nullptr}; // not owned
+  const std::string name_;
+};
+
 class TestOverloadManager : public OverloadManagerImpl {
 public:
   TestOverloadManager(Event::Dispatcher& dispatcher, Stats::Scope& stats_scope,
@@ -1123,6 +1168,121 @@ TEST_F(OverloadManagerLoadShedPointImplTest, LoadShedPointShouldUseCurrentReadin
   EXPECT_EQ(overload_action_states[0], UnitFloat(1));
 }
 
+class OverloadManagerWorkerResourceTest : public OverloadManagerImplTest {
+protected:
+  OverloadManagerWorkerResourceTest()
+      : worker_factory_("envoy.resource_monitors.fake_worker_resource"),
+        register_worker_factory_(worker_factory_) {}
+
+  FakeWorkerResourceMonitorFactory worker_factory_;
+  Registry::InjectFactory<Configuration::WorkerResourceMonitorFactory> register_worker_factory_;
+};
+
+constexpr char kWorkerResourceConfig[] = R"YAML(
+  refresh_interval:
+    seconds: 1
+  resource_monitors:
+    - name: envoy.resource_monitors.fake_resource1
+    - name: envoy.resource_monitors.fake_worker_resource
+  actions:
+    - name: envoy.overload_actions.stop_accepting_connections
+      triggers:
+        - name: envoy.resource_monitors.fake_resource1
+          threshold:
+            value: 0.9
+        - name: envoy.resource_monitors.fake_worker_resource
+          scaled:
+            scaling_threshold: 0.5
+            saturation_threshold: 0.9
+  loadshed_points:
+    - name: envoy.load_shed_points.tcp_listener_accept
+      triggers:
+        - name: envoy.resource_monitors.fake_worker_resource
+          threshold:
+            value: 0.9
+)YAML";
+
+TEST_F(OverloadManagerWorkerResourceTest, DuplicateResourceMonitor) {
+  const std::string config = R"EOF(
+    resource_monitors:
+      - name: envoy.resource_monitors.fake_worker_resource
+      - name: envoy.resource_monitors.fake_worker_resource
+  )EOF";
+
+  EXPECT_THROW_WITH_REGEX(createOverloadManager(config), EnvoyException,
+                          "Duplicate resource monitor .*");
+}
+
+TEST_F(OverloadManagerWorkerResourceTest, TriggersActionOnThreadOfWorker) {
+  setDispatcherExpectation();
+  auto manager(createOverloadManager(kWorkerResourceConfig));
+  Event::Dispatcher& worker_dispatcher = thread_local_.dispatcher_;
+  std::vector<UnitFloat> worker_states;
+  manager->registerForAction(
+      "envoy.overload_actions.stop_accepting_connections", worker_dispatcher,
+      [&](OverloadActionState state) { worker_states.push_back(state.value()); });
+  // Callbacks of another dispatcher aren't run by the thread local state of the worker.
+  manager->registerForAction("envoy.overload_actions.stop_accepting_connections", dispatcher_,
+                             [&](OverloadActionState) { FAIL(); });
+  manager->start();
+
+  const OverloadActionState& action_state = manager->getThreadLocalOverloadState().getState(
+      "envoy.overload_actions.stop_accepting_connections");
+  Stats::Gauge& pressure_gauge =
+      stats_.gauge("overload.envoy.resource_monitors.fake_worker_resource.test_thread.pressure",
+                   Stats::Gauge::ImportMode::NeverImport);
+
+  worker_factory_.monitor_->setPressure(worker_dispatcher, 0.7);
+  timer_cb_();
+  EXPECT_EQ(70, pressure_gauge.value());
+  EXPECT_FLOAT_EQ(0.5, action_state.value().value());
+  EXPECT_THAT(worker_states, testing::ElementsAre(UnitFloat(0.5)));
+
+  // The state doesn't change, so the callback isn't run again.
+  timer_cb_();
+  EXPECT_EQ(1, worker_states.size());
+
+  // The global resource saturates the action whatever the worker resource.
+  factory1_.monitor_->setPressure(0.95);
+  timer_cb_();
+  EXPECT_TRUE(action_state.isSaturated());
+  EXPECT_EQ(UnitFloat::max(), worker_states.back());
+
+  factory1_.monitor_->setPressure(0.5);
+  worker_factory_.monitor_->setPressure(worker_dispatcher, 0.2);
+  timer_cb_();
+  EXPECT_EQ(20, pressure_gauge.value());
+  EXPECT_EQ(UnitFloat::min(), action_state.value());
+  EXPECT_EQ(UnitFloat::min(), worker_states.back());
+
+  manager->stop();
+}
+
+TEST_F(OverloadManagerWorkerResourceTest, TriggersLoadShedPointOnThreadOfWorker) {
+  setDispatcherExpectation();
+  auto manager(createOverloadManager(kWorkerResourceConfig));
+  manager->start();
+
+  LoadShedPoint* point = manager->getLoadShedPoint("envoy.load_shed_points.tcp_listener_accept");
+  ASSERT_NE(point, nullptr);
+  EXPECT_FALSE(point->shouldShedLoad());
+
+  worker_factory_.monitor_->setPressure(thread_local_.dispatcher_, 0.95);
+  timer_cb_();
+  EXPECT_TRUE(point->shouldShedLoad());
+
+  // Threads without a thread local overload state only use the global resources.
+  thread_local_.registered_ = false;
+  EXPECT_FALSE(point->shouldShedLoad());
+  thread_local_.registered_ = true;
+
+  worker_factory_.monitor_->setPressure(thread_local_.dispatcher_, 0.5);
+  timer_cb_();
+  EXPECT_FALSE(point->shouldShedLoad());
+
+  manager->stop();
+}
+
 } // namespace
 } // namespace Server
 } // namespace Envoy